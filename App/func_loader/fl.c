@@ -27,153 +27,26 @@
  */
 
 #include "fl.h"
+#include "fl_frame.h"
 #include "fl_log.h"
 #include "fpbinject_version.h"
 
-/* External argparse support */
-#ifdef FL_USE_EXTERNAL_ARGPARSE
-#include FL_USE_EXTERNAL_ARGPARSE
-#define fl_argparse_init argparse_init
-#define fl_argparse_parse argparse_parse
-#define fl_argparse_usage argparse_usage
-#define fl_argparse_describe argparse_describe
-#define fl_argparse_help_cb argparse_help_cb
-#define fl_argparse_help_cb_no_exit argparse_help_cb_no_exit
-#else
-#include "argparse/argparse.h"
-#endif
-
 #include "fpb_inject.h"
 #include "fpb_trampoline.h"
 #include "fpb_debugmon.h"
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
 
-static uint16_t calc_crc16_base(uint16_t crc, const void* data, size_t len) {
-    static const uint16_t s_crc16_table[256] = {
-        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7, 0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD,
-        0xE1CE, 0xF1EF, 0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6, 0x9339, 0x8318, 0xB37B, 0xA35A,
-        0xD3BD, 0xC39C, 0xF3FF, 0xE3DE, 0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485, 0xA56A, 0xB54B,
-        0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D, 0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
-        0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC, 0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861,
-        0x2802, 0x3823, 0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B, 0x5AF5, 0x4AD4, 0x7AB7, 0x6A96,
-        0x1A71, 0x0A50, 0x3A33, 0x2A12, 0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A, 0x6CA6, 0x7C87,
-        0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41, 0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
-        0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70, 0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A,
-        0x9F59, 0x8F78, 0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F, 0x1080, 0x00A1, 0x30C2, 0x20E3,
-        0x5004, 0x4025, 0x7046, 0x6067, 0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E, 0x02B1, 0x1290,
-        0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256, 0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
-        0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405, 0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E,
-        0xC71D, 0xD73C, 0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634, 0xD94C, 0xC96D, 0xF90E, 0xE92F,
-        0x99C8, 0x89E9, 0xB98A, 0xA9AB, 0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3, 0xCB7D, 0xDB5C,
-        0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A, 0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
-        0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9, 0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83,
-        0x1CE0, 0x0CC1, 0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8, 0x6E17, 0x7E36, 0x4E55, 0x5E74,
-        0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
-    };
-
-    const uint8_t* ptr = data;
-    while (len--) {
-        crc = (crc << 8) ^ s_crc16_table[(crc >> 8) ^ *ptr++];
-    }
-    return crc;
-}
-
-static uint16_t calc_crc16(const void* data, size_t len) {
-    return calc_crc16_base(0xFFFF, data, len);
-}
-
-static int base64_to_bytes(const char* b64, uint8_t* out, size_t max) {
-    /* Base64 decoding table: ASCII -> 6-bit value, 255 = invalid, 64 = padding */
-    static const uint8_t s_b64_dec[128] = {
-        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, /* 0-15 */
-        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, /* 16-31 */
-        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 62,  255, 255, 255, 63,  /* 32-47: +,/ */
-        52,  53,  54,  55,  56,  57,  58,  59,  60,  61,  255, 255, 255, 64,  255, 255, /* 48-63: 0-9,= */
-        255, 0,   1,   2,   3,   4,   5,   6,   7,   8,   9,   10,  11,  12,  13,  14,  /* 64-79: A-O */
-        15,  16,  17,  18,  19,  20,  21,  22,  23,  24,  25,  255, 255, 255, 255, 255, /* 80-95: P-Z */
-        255, 26,  27,  28,  29,  30,  31,  32,  33,  34,  35,  36,  37,  38,  39,  40,  /* 96-111: a-o */
-        41,  42,  43,  44,  45,  46,  47,  48,  49,  50,  51,  255, 255, 255, 255, 255, /* 112-127: p-z */
-    };
-
-    if (!b64 || !out)
-        return -1;
-
-    size_t b64_len = strlen(b64);
-    if (b64_len == 0 || b64_len % 4 != 0)
-        return -1;
-
-    size_t out_len = (b64_len / 4) * 3;
-    /* Adjust for padding */
-    if (b64[b64_len - 1] == '=')
-        out_len--;
-    if (b64_len >= 2 && b64[b64_len - 2] == '=')
-        out_len--;
-
-    if (out_len > max)
-        return -1;
-
-    size_t i = 0, j = 0;
-    while (i < b64_len) {
-        uint8_t c0 = (uint8_t)b64[i];
-        uint8_t c1 = (uint8_t)b64[i + 1];
-        uint8_t c2 = (uint8_t)b64[i + 2];
-        uint8_t c3 = (uint8_t)b64[i + 3];
-
-        if (c0 >= 128 || c1 >= 128 || c2 >= 128 || c3 >= 128)
-            return -1;
-
-        uint8_t v0 = s_b64_dec[c0];
-        uint8_t v1 = s_b64_dec[c1];
-        uint8_t v2 = s_b64_dec[c2];
-        uint8_t v3 = s_b64_dec[c3];
-
-        if (v0 == 255 || v1 == 255 || (v2 == 255 && v2 != 64) || (v3 == 255 && v3 != 64))
-            return -1;
-
-        /* Decode 4 base64 chars -> up to 3 bytes */
-        out[j++] = (v0 << 2) | (v1 >> 4);
-        if (j < out_len && v2 != 64) {
-            out[j++] = ((v1 & 0x0F) << 4) | (v2 >> 2);
-            if (j < out_len && v3 != 64) {
-                out[j++] = ((v2 & 0x03) << 6) | v3;
-            }
-        }
-        i += 4;
-    }
-
-    return (int)out_len;
-}
-
-static int bytes_to_base64(const uint8_t* data, size_t len, char* out, size_t max) {
-    /* Base64 encoding table */
-    static const char s_b64_enc[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
-    if (!data || !out || max == 0)
-        return -1;
-
-    size_t out_len = ((len + 2) / 3) * 4;
-    if (out_len + 1 > max)
-        return -1;
-
-    size_t j = 0;
-    for (size_t i = 0; i < len; i += 3) {
-        uint8_t b0 = data[i];
-        uint8_t b1 = (i + 1 < len) ? data[i + 1] : 0;
-        uint8_t b2 = (i + 2 < len) ? data[i + 2] : 0;
-
-        out[j++] = s_b64_enc[b0 >> 2];
-        out[j++] = s_b64_enc[((b0 & 0x03) << 4) | (b1 >> 4)];
-        out[j++] = (i + 1 < len) ? s_b64_enc[((b1 & 0x0F) << 2) | (b2 >> 6)] : '=';
-        out[j++] = (i + 2 < len) ? s_b64_enc[b2 & 0x3F] : '=';
-    }
-    out[j] = '\0';
-
-    return (int)j;
-}
+/* slotstats reads the counters of the instrumented trampolines */
+#if defined(FPB_TRAMPOLINE_STATS) && !defined(FPB_NO_TRAMPOLINE)
+#define FL_SLOTSTATS 1
+#else
+#define FL_SLOTSTATS 0
+#endif
 
 void fl_init_default(fl_context_t* ctx) {
     memset(ctx, 0, sizeof(fl_context_t));
@@ -189,6 +62,10 @@ bool fl_is_inited(fl_context_t* ctx) {
     return ctx->is_inited;
 }
 
+void fl_quiescent(fl_context_t* ctx) {
+    ctx->grace_seq++;
+}
+
 static void fl_flush_dcache(fl_context_t* ctx, const void* addr, size_t len) {
     if (ctx->flush_dcache_cb) {
         ctx->flush_dcache_cb((uintptr_t)addr, (uintptr_t)addr + len);
@@ -223,16 +100,26 @@ static bool fl_check_addr_range(uintptr_t addr, size_t len) {
 typedef struct {
     const char* cmd;
     const char* data;
+    const uint8_t* bin; /* Raw --data from a binary frame (NULL = use base64 data) */
+    int bin_len;
     uintptr_t addr;
     uintptr_t orig;
     uintptr_t target;
-    int crc; /* -1 = no CRC provided */
+    uint32_t insn; /* --insn: ipatch instruction, objdump order; valid if has_insn */
+    int has_insn;
+    uint32_t crc; /* Valid if has_crc */
+    int has_crc;
+    int crc32; /* --crc32: CRCs are CRC-32 instead of CRC-16 */
+    int z;     /* --z: --data is LZ-compressed, or compress the response data */
     int len;
     int size;
     int comp;
     int all;
     int enable; /* -1 = not specified, 0 = disable, 1 = enable */
     int force;
+    int stage; /* --stage: record patch in the stage table, armed by commit */
+    int value; /* --value: memset fill byte, sample period (us), prof rate (Hz) */
+    int stream; /* --stream: read any length as base64 lines with SYNC markers */
     const char* path;
     const char* newpath;
     const char* mode;
@@ -244,14 +131,134 @@ typedef struct {
  */
 typedef int (*cmd_handler_t)(fl_context_t* ctx, const cmd_args_t* args);
 
+static void cmd_args_init(cmd_args_t* args) {
+    memset(args, 0, sizeof(*args));
+    args->len = 64;
+    args->enable = -1;
+}
+
+/**
+ * @brief  Decode --data payload into out
+ * @note   Binary frames carry raw bytes, text commands carry base64
+ * @return Decoded length, -1 on invalid data or overflow
+ */
+static int decode_data(const cmd_args_t* args, uint8_t* out, size_t max) {
+    if (args->bin) {
+        if ((size_t)args->bin_len > max)
+            return -1;
+        memcpy(out, args->bin, args->bin_len);
+        return args->bin_len;
+    }
+    if (!args->data)
+        return -1;
+    return fl_base64_decode(args->data, strlen(args->data), out, max);
+}
+
+/**
+ * @brief  Decode --data payload, inflating it with --z
+ * @note   Compressed data is decoded into buf and inflated into b64_buf
+ * @param  out Set to the raw bytes (buf or b64_buf)
+ * @return Raw length, -1 on invalid data or overflow
+ */
+static int load_data(fl_context_t* ctx, const cmd_args_t* args, const uint8_t** out) {
+    int n = decode_data(args, ctx->buf, FL_BUF_SIZE);
+    *out = ctx->buf;
+    if (n < 0 || !args->z)
+        return n;
+    *out = (const uint8_t*)ctx->b64_buf;
+    return fl_lz_decompress(ctx->buf, (size_t)n, (uint8_t*)ctx->b64_buf, FL_BUF_SIZE);
+}
+
+/**
+ * @brief  LZ-compress response data in place for --z (b64_buf as scratch)
+ * @return Compressed length, 0 without --z or if the data does not shrink
+ */
+static int pack_data(fl_context_t* ctx, const cmd_args_t* args, uint8_t* data, size_t len) {
+    if (!args->z)
+        return 0;
+    int n = fl_lz_compress(data, len, (uint8_t*)ctx->b64_buf, len - 1);
+    if (n <= 0)
+        return 0;
+    memcpy(data, ctx->b64_buf, (size_t)n);
+    return n;
+}
+
+/**
+ * @brief  Prepare a data payload for print_data()
+ * @note   Only the text transport needs base64 (into b64_buf)
+ * @return false if encoding failed
+ */
+static bool encode_data(fl_context_t* ctx, const uint8_t* data, size_t len) {
+    if (ctx->output_data_cb)
+        return true;
+    return fl_base64_encode(data, len, ctx->b64_buf, FL_B64_BUF_SIZE) >= 0;
+}
+
+static void print_data(fl_context_t* ctx, const uint8_t* data, size_t len) {
+    if (ctx->output_data_cb) {
+        ctx->output_data_cb(ctx->output_user, data, len);
+    } else {
+        fl_print_ref(ctx->b64_buf);
+    }
+}
+
+/* Hex digits of a CRC in responses ("0x%0*lX") */
+#define CRC_DIGITS(crc32) ((crc32) ? 8 : 4)
+
+/**
+ * @brief  Initial CRC value: CRC-16-CCITT starts at 0xFFFF, CRC-32 at 0 (zlib convention)
+ */
+static uint32_t crc_init(bool crc32) {
+    return crc32 ? 0 : 0xFFFF;
+}
+
+/**
+ * @brief  Update a request/response CRC, CRC-32 goes to crc32_cb if the port provides one
+ */
+static uint32_t crc_update(fl_context_t* ctx, bool crc32, uint32_t crc, const void* data, size_t len) {
+    if (!crc32)
+        return fl_crc16_update((uint16_t)crc, data, len);
+    if (ctx->crc32_cb)
+        return ctx->crc32_cb(crc, data, len);
+    return fl_crc32_update(crc, data, len);
+}
+
+/**
+ * @brief  CRC over a header of 32-bit words (addr/len, comp/orig/target), then data
+ */
+static uint32_t crc_header(fl_context_t* ctx, bool crc32, const uint32_t* words, size_t count) {
+    return crc_update(ctx, crc32, crc_init(crc32), words, count * sizeof(uint32_t));
+}
+
 /* ===========================
    COMMAND IMPLEMENTATIONS
    =========================== */
 
+/* Caps of the command layer itself; ports add transport caps in ctx->caps */
+#define FL_CAPS_BUILTIN \
+    (FL_CAP_UPLOAD_ACK | FL_CAP_CRC32 | FL_CAP_LZ | FL_CAP_HASH | FL_CAP_BATCH | FL_CAP_STAGE | FL_CAP_MEMCRC | \
+     FL_CAP_MEMOPS | FL_CAP_READV | FL_CAP_READ_STREAM | FL_CAP_IPATCH)
+
 static int cmd_ping(fl_context_t* ctx, const cmd_args_t* args) {
-    (void)ctx;
     (void)args;
-    fl_response(true, "PONG");
+    unsigned long caps = ctx->caps | FL_CAPS_BUILTIN;
+    if (ctx->grace_free)
+        caps |= FL_CAP_RETARGET;
+#if FL_USE_FILE
+    if (ctx->file_ctx.fs)
+        caps |= FL_CAP_DUMP;
+#endif
+#if FL_USE_SAMPLE
+    caps |= FL_CAP_SAMPLE;
+#endif
+#if FL_USE_PROF
+    if (ctx->prof_timer_cb)
+        caps |= FL_CAP_PROF;
+#endif
+#if FL_SLOTSTATS
+    caps |= FL_CAP_SLOTSTATS;
+#endif
+    fl_response(true, "PONG caps=0x%08lX", caps);
     return 0;
 }
 
@@ -267,7 +274,7 @@ static int cmd_echo(fl_context_t* ctx, const cmd_args_t* args) {
 
     if (data_str && len > 0) {
         /* Calculate CRC of the hex string (not decoded bytes) */
-        crc = calc_crc16(data_str, strlen(data_str));
+        crc = fl_crc16_update(0xFFFF, data_str, strlen(data_str));
     }
 
     fl_response(true, "ECHO %u Bytes, CRC 0x%04X", (unsigned)len, crc);
@@ -292,31 +299,46 @@ static int cmd_echoback(fl_context_t* ctx, const cmd_args_t* args) {
     }
 
     /* Base64 encode */
-    if (bytes_to_base64(ctx->buf, len, ctx->b64_buf, FL_B64_BUF_SIZE) < 0) {
+    if (!encode_data(ctx, ctx->buf, len)) {
         fl_response(false, "Base64 encode failed");
         return 0;
     }
 
     /* CRC over raw pattern bytes */
-    uint16_t crc = calc_crc16(ctx->buf, len);
+    uint32_t crc = crc_update(ctx, args->crc32, crc_init(args->crc32), ctx->buf, len);
 
     /* Output in parts to avoid buffer overflow */
-    fl_print("[FLOK] ECHOBACK %d bytes crc=0x%04X data=", len, (unsigned)crc);
-    fl_print_raw(ctx->b64_buf);
+    fl_print("[FLOK] ECHOBACK %d bytes crc=0x%0*lX data=", len, CRC_DIGITS(args->crc32), (unsigned long)crc);
+    print_data(ctx, ctx->buf, len);
     fl_print_raw("\n[FLEND]\n");
     return 0;
 }
 
+/**
+ * @brief  Size of the slot pool: the FPB code comparators, plus the extra
+ *         DebugMonitor redirects (DWT comparators) past them, dpatch only
+ */
+static uint32_t slot_count(void) {
+    uint32_t n = fpb_get_state()->num_code_comp;
+#ifndef FPB_NO_DEBUGMON
+    uint32_t redirects = fpb_debugmon_get_capacity();
+    if (redirects > n)
+        n = redirects;
+#endif
+    return n < FL_MAX_SLOTS ? n : FL_MAX_SLOTS;
+}
+
 static int cmd_info(fl_context_t* ctx, const cmd_args_t* args) {
     (void)args;
     const fpb_state_t* fpb = fpb_get_state();
     fpb_info_t fpb_info;
     uint32_t num_comps = fpb->num_code_comp;
+    uint32_t num_slots = slot_count();
     uint32_t active_count = 0;
     size_t total_used = 0;
 
     /* Count active slots and total code size */
-    for (uint32_t i = 0; i < num_comps && i < FL_MAX_SLOTS; i++) {
+    for (uint32_t i = 0; i < num_slots; i++) {
         if (ctx->slots[i].active) {
             active_count++;
             total_used += ctx->slots[i].code_size;
@@ -326,7 +348,7 @@ static int cmd_info(fl_context_t* ctx, const cmd_args_t* args) {
     fl_println("FPBInject " FPBINJECT_VERSION_STRING);
     fl_println("Build: " __DATE__ " " __TIME__);
     fl_println("Used: %u", (unsigned)total_used);
-    fl_println("Slots: %u/%u", (unsigned)active_count, (unsigned)num_comps);
+    fl_println("Slots: %u/%u", (unsigned)active_count, (unsigned)num_slots);
 
 #if FL_USE_FILE
     fl_println("FileTransfer: %s", ctx->file_ctx.fs ? "enabled" : "disabled");
@@ -351,7 +373,11 @@ static int cmd_info(fl_context_t* ctx, const cmd_args_t* args) {
             fpb_comp_info_t* comp = &fpb_info.comp[i];
             const char* mode_str = (comp->replace < 4) ? replace_mode_str[comp->replace] : "?";
 
-            if (slot->active) {
+            if (slot->active && slot->op == FL_OP_IPATCH) {
+                fl_println("Slot[%u]: 0x%08lX insn 0x%08lX (COMP=0x%08lX, %s, %s)", (unsigned)i,
+                           (unsigned long)slot->orig_addr, (unsigned long)slot->target_addr,
+                           (unsigned long)comp->comp_raw, mode_str, comp->enabled ? "on" : "off");
+            } else if (slot->active) {
                 fl_println("Slot[%u]: 0x%08lX -> 0x%08lX, %u bytes (COMP=0x%08lX, %s, %s)", (unsigned)i,
                            (unsigned long)slot->orig_addr, (unsigned long)slot->target_addr, (unsigned)slot->code_size,
                            (unsigned long)comp->comp_raw, mode_str, comp->enabled ? "on" : "off");
@@ -360,6 +386,17 @@ static int cmd_info(fl_context_t* ctx, const cmd_args_t* args) {
                            comp->enabled ? "on" : "off");
             }
         }
+
+        /* Slots past the FPB comparators only take DebugMonitor redirects */
+        for (uint32_t i = num_comps; i < num_slots; i++) {
+            fl_slot_state_t* slot = &ctx->slots[i];
+            if (slot->active) {
+                fl_println("Slot[%u]: 0x%08lX -> 0x%08lX, %u bytes (debugmon, on)", (unsigned)i,
+                           (unsigned long)slot->orig_addr, (unsigned long)slot->target_addr, (unsigned)slot->code_size);
+            } else {
+                fl_println("Slot[%u]: empty (debugmon)", (unsigned)i);
+            }
+        }
     } else {
         fl_println("FPB: not available");
     }
@@ -399,43 +436,46 @@ static int cmd_alloc(fl_context_t* ctx, const cmd_args_t* args) {
 }
 
 static int cmd_upload(fl_context_t* ctx, const cmd_args_t* args) {
-    if (!args->data) {
+    if (!args->data && !args->bin) {
         fl_response(false, "Missing --data");
         return -1;
     }
 
-    uint8_t* buf = ctx->buf;
-    bool verify = args->crc >= 0;
-
-    int n = base64_to_bytes(args->data, buf, FL_BUF_SIZE);
+    const uint8_t* buf;
+    int n = load_data(ctx, args, &buf);
     if (n < 0) {
-        fl_response(false, "Invalid base64 data");
+        fl_response(false, "Invalid %s data", args->z ? "compressed" : "base64");
         return 0;
     }
 
-    if (verify) {
+    /*
+     * Responses carry the chunk offset so the host can keep several chunks
+     * in flight and match acks out of its window (FL_CAP_UPLOAD_ACK).
+     * Chunks are idempotent: a retransmitted chunk just rewrites the same bytes.
+     */
+    unsigned long off = (unsigned long)args->addr;
+
+    if (args->has_crc) {
         /* CRC covers: offset(4B) + len(4B) + data payload */
-        uint32_t offset32 = (uint32_t)args->addr;
-        uint32_t len32 = (uint32_t)n;
-        uint16_t calc = 0xFFFF;
-        calc = calc_crc16_base(calc, &offset32, sizeof(offset32));
-        calc = calc_crc16_base(calc, &len32, sizeof(len32));
-        calc = calc_crc16_base(calc, buf, n);
-        if (calc != (uint16_t)args->crc) {
-            /* CRC mismatch - free last_alloc in dynamic mode to prevent leak */
-            if (ctx->last_alloc != 0 && ctx->free_cb) {
-                ctx->free_cb((void*)ctx->last_alloc);
-                ctx->last_alloc = 0;
-                ctx->last_alloc_size = 0;
-            }
-            fl_response(false, "CRC mismatch: 0x%04X != 0x%04X", (unsigned)args->crc, (unsigned)calc);
+        const uint32_t hdr[2] = {(uint32_t)args->addr, (uint32_t)n};
+        uint32_t calc = crc_header(ctx, args->crc32, hdr, 2);
+        calc = crc_update(ctx, args->crc32, calc, buf, n);
+        if (calc != args->crc) {
+            /* Keep last_alloc: the host retransmits this chunk, the next alloc frees it */
+            int w = CRC_DIGITS(args->crc32);
+            fl_response(false, "CRC mismatch off=0x%lX: 0x%0*lX != 0x%0*lX", off, w, (unsigned long)args->crc, w,
+                        (unsigned long)calc);
             return 0;
         }
     }
 
     /* Upload to last_alloc */
     if (ctx->last_alloc == 0) {
-        fl_response(false, "No allocation, call alloc first");
+        fl_response(false, "No allocation off=0x%lX, call alloc first", off);
+        return 0;
+    }
+    if (args->addr > ctx->last_alloc_size || (size_t)n > ctx->last_alloc_size - args->addr) {
+        fl_response(false, "Upload exceeds allocation: 0x%lX+%d > %u", off, n, (unsigned)ctx->last_alloc_size);
         return 0;
     }
     uint8_t* dest = (uint8_t*)(ctx->last_alloc + args->addr);
@@ -445,31 +485,76 @@ static int cmd_upload(fl_context_t* ctx, const cmd_args_t* args) {
     /* Flush data cache after upload to ensure code is visible to CPU */
     fl_flush_dcache(ctx, dest, n);
 
-    fl_response(true, "Uploaded %d bytes to 0x%lX", n, (unsigned long)dest);
+    fl_response(true, "Uploaded %d bytes off=0x%lX to 0x%lX", n, off, (unsigned long)dest);
     return 0;
 }
 
+/* A streamed read alternates between the halves of buf/b64_buf: a segment is read while
+ * the previous one is still queued in the TX ring. Multiple of 3, so lines have no padding. */
+#define READ_SEG_SIZE ((FL_BUF_SIZE - 1) / 6 * 3)
+#define READ_SEG_B64 (FL_B64_BUF_SIZE / 2)
+
+/**
+ * @brief  read --stream: any length, one base64 line per segment
+ * @note   The response CRC rolls on over the whole range, a "SYNC <off> crc=0x.." line
+ *         every FL_READ_SYNC_SIZE bytes (and at the end) lets the host verify what it has
+ *         and resume a broken transfer from the last SYNC offset. Each segment is copied
+ *         before it is CRCed and encoded, so live RAM cannot change between the two.
+ */
+static void read_stream(fl_context_t* ctx, const cmd_args_t* args, uint32_t crc) {
+    const uint8_t* src = (const uint8_t*)args->addr;
+    int len = args->len;
+    int w = CRC_DIGITS(args->crc32);
+    int sync = 0;
+
+    fl_print("[FLOK] READ %d bytes stream\n", len);
+    for (int off = 0, seg = 0; off < len; seg ^= 1) {
+        uint8_t* raw = ctx->buf + seg * READ_SEG_SIZE;
+        char* b64 = ctx->b64_buf + seg * READ_SEG_B64;
+        size_t n = (size_t)(len - off < READ_SEG_SIZE ? len - off : READ_SEG_SIZE);
+
+        if (off > 0 && ctx->yield_cb)
+            ctx->yield_cb();
+        fl_log_tx_wait(raw, READ_SEG_SIZE);
+        fl_log_tx_wait(b64, READ_SEG_B64);
+        memcpy(raw, src + off, n);
+        crc = crc_update(ctx, args->crc32, crc, raw, n);
+        if (ctx->output_data_cb) {
+            ctx->output_data_cb(ctx->output_user, raw, n);
+        } else {
+            fl_base64_encode(raw, n, b64, READ_SEG_B64);
+            fl_print_ref(b64);
+            fl_print_raw("\n");
+        }
+
+        off += (int)n;
+        if (off - sync >= FL_READ_SYNC_SIZE || off == len) {
+            fl_print("SYNC %d crc=0x%0*lX\n", off, w, (unsigned long)crc);
+            sync = off;
+        }
+    }
+    fl_print_raw("[FLEND]\n");
+}
+
 static int cmd_read(fl_context_t* ctx, const cmd_args_t* args) {
     uint8_t* buf = ctx->buf;
-    char* b64_buf = ctx->b64_buf;
     int len = args->len;
 
-    if (len <= 0 || (size_t)len > FL_BUF_SIZE) {
+    if (len <= 0 || (!args->stream && (size_t)len > FL_BUF_SIZE)) {
         fl_response(false, "Invalid length %d (max %d)", len, (int)FL_BUF_SIZE);
         return 0;
     }
 
-    /* Verify request CRC if provided: covers addr(4B) + len(4B) */
-    if (args->crc >= 0) {
-        uint32_t addr32 = (uint32_t)args->addr;
-        uint32_t len32 = (uint32_t)len;
-        uint16_t calc = 0xFFFF;
-        calc = calc_crc16_base(calc, &addr32, sizeof(addr32));
-        calc = calc_crc16_base(calc, &len32, sizeof(len32));
-        if (calc != (uint16_t)args->crc) {
-            fl_response(false, "Request CRC mismatch: 0x%04X != 0x%04X", (unsigned)args->crc, (unsigned)calc);
-            return 0;
-        }
+    /* CRCs cover: addr(4B) + len(4B), plus the data payload in the response */
+    const uint32_t hdr[2] = {(uint32_t)args->addr, (uint32_t)len};
+    uint32_t hdr_crc = crc_header(ctx, args->crc32, hdr, 2);
+    int w = CRC_DIGITS(args->crc32);
+
+    /* Verify request CRC if provided */
+    if (args->has_crc && hdr_crc != args->crc) {
+        fl_response(false, "Request CRC mismatch: 0x%0*lX != 0x%0*lX", w, (unsigned long)args->crc, w,
+                    (unsigned long)hdr_crc);
+        return 0;
     }
 
     if (!args->force && !fl_check_addr_range(args->addr, len)) {
@@ -478,168 +563,759 @@ static int cmd_read(fl_context_t* ctx, const cmd_args_t* args) {
         return 0;
     }
 
+    if (args->stream) {
+        read_stream(ctx, args, hdr_crc);
+        return 0;
+    }
+
     /* Read memory at the given address */
     const uint8_t* src = (const uint8_t*)args->addr;
     memcpy(buf, src, len);
 
+    /* The CRC covers the uncompressed data */
+    uint32_t resp_crc = crc_update(ctx, args->crc32, hdr_crc, buf, len);
+    int z = pack_data(ctx, args, buf, len);
+
     /* Base64 encode */
-    if (bytes_to_base64(buf, len, b64_buf, FL_B64_BUF_SIZE) < 0) {
+    if (!encode_data(ctx, buf, z ? z : len)) {
         fl_response(false, "Base64 encode failed");
         return 0;
     }
 
-    /* CRC-16 covers: addr(4B) + len(4B) + data payload */
-    uint32_t resp_addr32 = (uint32_t)args->addr;
-    uint32_t resp_len32 = (uint32_t)len;
-    uint16_t resp_crc = 0xFFFF;
-    resp_crc = calc_crc16_base(resp_crc, &resp_addr32, sizeof(resp_addr32));
-    resp_crc = calc_crc16_base(resp_crc, &resp_len32, sizeof(resp_len32));
-    resp_crc = calc_crc16_base(resp_crc, buf, len);
-
     /* Output in segments to avoid buffer overflow */
-    fl_print("[FLOK] READ %d bytes crc=0x%04X data=", len, (unsigned)resp_crc);
-    fl_print_raw(b64_buf);
+    fl_print("[FLOK] READ %d bytes crc=0x%0*lX ", len, w, (unsigned long)resp_crc);
+    if (z)
+        fl_print("z=%d ", z);
+    fl_print_raw("data=");
+    print_data(ctx, buf, z ? z : len);
     fl_print_raw("\n[FLEND]\n");
     return 0;
 }
 
-static int cmd_write(fl_context_t* ctx, const cmd_args_t* args) {
-    if (!args->data) {
-        fl_response(false, "Missing --data");
-        return -1;
+/**
+ * @brief  Decode an unsigned LEB128 varint (at most 5 bytes)
+ * @return Bytes consumed, 0 if truncated or too long
+ */
+static int get_varint(const uint8_t* p, int n, uint32_t* out) {
+    uint32_t v = 0;
+    for (int i = 0; i < n && i < 5; i++) {
+        v |= (uint32_t)(p[i] & 0x7F) << (7 * i);
+        if (!(p[i] & 0x80)) {
+            *out = v;
+            return i + 1;
+        }
     }
+    return 0;
+}
 
-    uint8_t* buf = ctx->buf;
-    bool verify = args->crc >= 0;
+/**
+ * @brief  Next readv range: varint gap after the previous range, varint len
+ * @param  addr In: end of the previous range, out: start of this one
+ * @return false on a truncated entry
+ */
+static bool readv_next(const uint8_t* list, int n, int* pos, uintptr_t* addr, uint32_t* len) {
+    uint32_t gap;
+    int k = get_varint(list + *pos, n - *pos, &gap);
+    int k2 = k ? get_varint(list + *pos + k, n - *pos - k, len) : 0;
+    if (k2 == 0)
+        return false;
+    *pos += k + k2;
+    *addr += gap;
+    return true;
+}
 
-    int n = base64_to_bytes(args->data, buf, FL_BUF_SIZE);
-    if (n < 0) {
-        fl_response(false, "Invalid base64 data");
+/**
+ * @brief  Scatter-gather read: several ranges in one response
+ * @note   --data lists ascending ranges from --addr as (gap, len) varint
+ *         pairs, gap counted from the end of the previous range: 2 bytes per
+ *         entry for a typical watch list. The list is decoded into b64_buf
+ *         (text) so buf is filled only once. CRCs cover addr(4B) +
+ *         list_len(4B) + the list, plus the gathered data in the response.
+ */
+static int cmd_readv(fl_context_t* ctx, const cmd_args_t* args) {
+    const uint8_t* list = args->bin;
+    int n = args->bin_len;
+    if (!list) {
+        if (!args->data) {
+            fl_response(false, "Missing --data");
+            return -1;
+        }
+        list = (const uint8_t*)ctx->b64_buf;
+        n = decode_data(args, (uint8_t*)ctx->b64_buf, FL_B64_BUF_SIZE);
+    }
+    if (n <= 0) {
+        fl_response(false, "Invalid range list");
         return 0;
     }
 
-    if (!args->force && !fl_check_addr_range(args->addr, n)) {
-        fl_response(false, "Invalid address range 0x%08lX+%d (use --force to override)", (unsigned long)args->addr, n);
+    const uint32_t hdr[2] = {(uint32_t)args->addr, (uint32_t)n};
+    uint32_t req_crc = crc_update(ctx, args->crc32, crc_header(ctx, args->crc32, hdr, 2), list, (size_t)n);
+    int w = CRC_DIGITS(args->crc32);
+
+    if (args->has_crc && req_crc != args->crc) {
+        fl_response(false, "Request CRC mismatch: 0x%0*lX != 0x%0*lX", w, (unsigned long)args->crc, w,
+                    (unsigned long)req_crc);
         return 0;
     }
 
-    if (verify) {
-        /* CRC covers: addr(4B) + len(4B) + data payload */
-        uint32_t addr32 = (uint32_t)args->addr;
-        uint32_t len32 = (uint32_t)n;
-        uint16_t calc = 0xFFFF;
-        calc = calc_crc16_base(calc, &addr32, sizeof(addr32));
-        calc = calc_crc16_base(calc, &len32, sizeof(len32));
-        calc = calc_crc16_base(calc, buf, n);
-        if (calc != (uint16_t)args->crc) {
-            fl_response(false, "CRC mismatch: 0x%04X != 0x%04X", (unsigned)args->crc, (unsigned)calc);
+    /* Validate every range before copying the first one */
+    int count = 0;
+    size_t total = 0;
+    uintptr_t addr = args->addr;
+    uint32_t len;
+    for (int pos = 0; pos < n; count++) {
+        if (!readv_next(list, n, &pos, &addr, &len)) {
+            fl_response(false, "Invalid range list");
             return 0;
         }
+        if (len == 0 || len > FL_BUF_SIZE - total) {
+            fl_response(false, "Invalid length of range %d (max %d in total)", count, (int)FL_BUF_SIZE);
+            return 0;
+        }
+        if (!args->force && !fl_check_addr_range(addr, len)) {
+            fl_response(false, "Invalid address range 0x%08lX+%lu (use --force to override)", (unsigned long)addr,
+                        (unsigned long)len);
+            return 0;
+        }
+        addr += len;
+        total += len;
     }
 
-    /* Write to the specified address */
-    uint8_t* dest = (uint8_t*)args->addr;
-    memcpy(dest, buf, n);
+    uint8_t* buf = ctx->buf;
+    addr = args->addr;
+    for (int pos = 0, out = 0; pos < n; out += (int)len) {
+        readv_next(list, n, &pos, &addr, &len);
+        memcpy(buf + out, (const uint8_t*)addr, len);
+        addr += len;
+    }
 
-    /* Flush data cache */
-    fl_flush_dcache(ctx, dest, n);
+    /* The CRC covers the uncompressed data; b64_buf (the list) is free from here */
+    uint32_t resp_crc = crc_update(ctx, args->crc32, req_crc, buf, total);
+    int z = pack_data(ctx, args, buf, total);
 
-    fl_response(true, "WRITE %d bytes to 0x%lX", n, (unsigned long)args->addr);
+    if (!encode_data(ctx, buf, z ? (size_t)z : total)) {
+        fl_response(false, "Base64 encode failed");
+        return 0;
+    }
+
+    fl_print("[FLOK] READV %d ranges %d bytes crc=0x%0*lX ", count, (int)total, w, (unsigned long)resp_crc);
+    if (z)
+        fl_print("z=%d ", z);
+    fl_print_raw("data=");
+    print_data(ctx, buf, z ? (size_t)z : total);
+    fl_print_raw("\n[FLEND]\n");
     return 0;
 }
 
 /**
- * @brief  Verify CRC for patch commands: covers comp(4B) + orig(4B) + target(4B)
- * @return true if CRC matches or no CRC provided (crc < 0)
+ * @brief  Per-block CRCs over a memory range, for delta uploads
+ * @note   Block CRCs start from the CRC init value (no header). The response
+ *         CRC covers addr(4B) + len(4B) + the packed little-endian CRC array.
  */
-static bool verify_patch_crc(int crc, uint32_t comp, uintptr_t orig, uintptr_t target) {
-    if (crc < 0)
-        return true;
-    uint32_t comp32 = comp;
-    uint32_t orig32 = (uint32_t)orig;
-    uint32_t target32 = (uint32_t)target;
-    uint16_t calc = 0xFFFF;
-    calc = calc_crc16_base(calc, &comp32, sizeof(comp32));
-    calc = calc_crc16_base(calc, &orig32, sizeof(orig32));
-    calc = calc_crc16_base(calc, &target32, sizeof(target32));
-    if (calc != (uint16_t)crc) {
-        fl_response(false, "CRC mismatch: 0x%04X != 0x%04X", (unsigned)crc, (unsigned)calc);
-        return false;
+static int cmd_hash(fl_context_t* ctx, const cmd_args_t* args) {
+    int len = args->len;
+    int bs = args->size ? args->size : FL_HASH_BLOCK_SIZE;
+    int width = args->crc32 ? 4 : 2;
+
+    if (len <= 0 || bs <= 0) {
+        fl_response(false, "Invalid length %d / block size %d", len, bs);
+        return 0;
     }
-    return true;
-}
 
-static int cmd_patch(fl_context_t* ctx, const cmd_args_t* args) {
-    if (args->orig == 0 || args->target == 0) {
-        fl_response(false, "Missing --orig/--target");
-        return -1;
+    /* Unsigned: len + bs - 1 overflows int for large lengths */
+    uint32_t blocks = ((uint32_t)len + (uint32_t)bs - 1) / (uint32_t)bs;
+    if (blocks > (uint32_t)(FL_BUF_SIZE / width)) {
+        fl_response(false, "Too many blocks %lu (max %d)", (unsigned long)blocks, (int)(FL_BUF_SIZE / width));
+        return 0;
     }
 
-    if (!verify_patch_crc(args->crc, args->comp, args->orig, args->target))
+    const uint32_t hdr[2] = {(uint32_t)args->addr, (uint32_t)len};
+    uint32_t hdr_crc = crc_header(ctx, args->crc32, hdr, 2);
+    int w = CRC_DIGITS(args->crc32);
+
+    if (args->has_crc && hdr_crc != args->crc) {
+        fl_response(false, "Request CRC mismatch: 0x%0*lX != 0x%0*lX", w, (unsigned long)args->crc, w,
+                    (unsigned long)hdr_crc);
         return 0;
+    }
 
-    if ((uint32_t)args->comp >= fpb_get_state()->num_code_comp || (uint32_t)args->comp >= FL_MAX_SLOTS) {
-        fl_response(false, "Invalid comp %lu", (unsigned long)args->comp);
+    if (!args->force && !fl_check_addr_range(args->addr, len)) {
+        fl_response(false, "Invalid address range 0x%08lX+%d (use --force to override)", (unsigned long)args->addr,
+                    len);
         return 0;
     }
 
-    fpb_result_t ret = fpb_set_patch(args->comp, args->orig, args->target);
-    if (ret != FPB_OK) {
-        fl_response(false, "fpb_set_patch failed: %d", ret);
+    const uint8_t* src = (const uint8_t*)args->addr;
+    uint8_t* out = ctx->buf;
+    for (uint32_t b = 0; b < blocks; b++) {
+        size_t off = (size_t)b * bs;
+        size_t n = (size_t)(len - off < (size_t)bs ? len - off : (size_t)bs);
+        uint32_t crc = crc_update(ctx, args->crc32, crc_init(args->crc32), src + off, n);
+        for (int i = 0; i < width; i++)
+            *out++ = (uint8_t)(crc >> (8 * i));
+    }
+
+    size_t n = (size_t)blocks * width;
+    uint32_t resp_crc = crc_update(ctx, args->crc32, hdr_crc, ctx->buf, n);
+    if (!encode_data(ctx, ctx->buf, n)) {
+        fl_response(false, "Base64 encode failed");
         return 0;
     }
 
-    /* Record slot state, transfer last_alloc ownership to slot */
-    ctx->slots[args->comp].active = true;
-    ctx->slots[args->comp].orig_addr = args->orig;
-    ctx->slots[args->comp].target_addr = args->target;
-    ctx->slots[args->comp].code_size = ctx->last_alloc_size;
-    ctx->slots[args->comp].alloc_addr = ctx->last_alloc;
-    ctx->last_alloc = 0; /* Ownership transferred */
-    ctx->last_alloc_size = 0;
+    fl_print("[FLOK] HASH %lu blocks bs=%d crc=0x%0*lX ", (unsigned long)blocks, bs, w, (unsigned long)resp_crc);
+    fl_print_raw("data=");
+    print_data(ctx, ctx->buf, n);
+    fl_print_raw("\n[FLEND]\n");
+    return 0;
+}
 
-    fl_response(true, "Patch %lu: 0x%08lX -> 0x%08lX", (unsigned long)args->comp, (unsigned long)args->orig,
-                (unsigned long)args->target);
+/**
+ * @brief  Check --len and one address range of a memory command
+ */
+static bool check_scan_range(const cmd_args_t* args, uintptr_t addr) {
+    if (args->len <= 0) {
+        fl_response(false, "Invalid length %d", args->len);
+        return false;
+    }
+
+    if (!args->force && !fl_check_addr_range(addr, (size_t)args->len)) {
+        fl_response(false, "Invalid address range 0x%08lX+%d (use --force to override)", (unsigned long)addr,
+                    args->len);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief  Bytes in the memory scan slice at off, yielding before every slice but the first
+ */
+static size_t scan_slice(fl_context_t* ctx, int len, int off) {
+    if (off > 0 && ctx->yield_cb)
+        ctx->yield_cb();
+    return (size_t)(len - off < FL_MEM_SLICE_SIZE ? len - off : FL_MEM_SLICE_SIZE);
+}
+
+/**
+ * @brief  CRC-32 over a memory range, to verify writes without reading back
+ */
+static int cmd_memcrc(fl_context_t* ctx, const cmd_args_t* args) {
+    if (!check_scan_range(args, args->addr))
+        return 0;
+
+    const uint8_t* src = (const uint8_t*)args->addr;
+    uint32_t crc = 0;
+    for (int off = 0; off < args->len; off += FL_MEM_SLICE_SIZE) {
+        size_t n = scan_slice(ctx, args->len, off);
+        crc = crc_update(ctx, true, crc, src + off, n);
+    }
+
+    fl_response(true, "MEMCRC 0x%08lX len=%d crc=0x%08lX", (unsigned long)args->addr, args->len, (unsigned long)crc);
     return 0;
 }
 
-static int cmd_tpatch(fl_context_t* ctx, const cmd_args_t* args) {
-    if (args->orig == 0 || args->target == 0) {
-        fl_response(false, "Missing --orig/--target");
+/**
+ * @brief  Compare two memory ranges (--addr and --target, --len bytes each)
+ */
+static int cmd_memcmp(fl_context_t* ctx, const cmd_args_t* args) {
+    if (args->target == 0) {
+        fl_response(false, "Missing --target");
         return -1;
     }
 
-#ifndef FPB_NO_TRAMPOLINE
-    if (!verify_patch_crc(args->crc, args->comp, args->orig, args->target))
+    if (!check_scan_range(args, args->addr) || !check_scan_range(args, args->target))
         return 0;
 
-    if ((uint32_t)args->comp >= FPB_TRAMPOLINE_COUNT || (uint32_t)args->comp >= FL_MAX_SLOTS) {
-        fl_response(false, "Invalid comp %lu (max %d)", (unsigned long)args->comp, FPB_TRAMPOLINE_COUNT - 1);
+    const uint8_t* a = (const uint8_t*)args->addr;
+    const uint8_t* b = (const uint8_t*)args->target;
+    for (int off = 0; off < args->len; off += FL_MEM_SLICE_SIZE) {
+        size_t n = scan_slice(ctx, args->len, off);
+        if (memcmp(a + off, b + off, n) == 0)
+            continue;
+
+        /* Locate the first differing byte inside the slice */
+        size_t i = 0;
+        while (a[off + i] == b[off + i])
+            i++;
+        fl_response(false, "MEMCMP differ at +0x%lX", (unsigned long)(off + i));
         return 0;
     }
 
-    /* Set trampoline target in RAM */
-    fpb_trampoline_set_target(args->comp, args->target);
+    fl_response(true, "MEMCMP %d bytes equal", args->len);
+    return 0;
+}
 
-    /* Get trampoline address in Flash */
-    uint32_t tramp_addr = fpb_trampoline_get_address(args->comp);
+/**
+ * @brief  Fill with aligned, unrolled word stores
+ * @note   newlib-nano's memset/memcpy are byte loops, and some peripheral RAMs
+ *         only take word accesses
+ */
+static void mem_fill(uint8_t* dst, uint8_t value, size_t n) {
+    while (n > 0 && ((uintptr_t)dst & 3)) {
+        *dst++ = value;
+        n--;
+    }
+
+    const uint32_t w = value * 0x01010101UL;
+    uint32_t* wp = (uint32_t*)dst;
+    for (; n >= 16; n -= 16, wp += 4) {
+        wp[0] = w;
+        wp[1] = w;
+        wp[2] = w;
+        wp[3] = w;
+    }
+    for (; n >= 4; n -= 4)
+        *wp++ = w;
+
+    dst = (uint8_t*)wp;
+    while (n-- > 0)
+        *dst++ = value;
+}
 
-    /* Use FPB to redirect original function to trampoline */
-    fpb_result_t ret = fpb_set_patch(args->comp, args->orig, tramp_addr);
-    if (ret != FPB_OK) {
-        fpb_trampoline_clear_target(args->comp);
-        fl_response(false, "fpb_set_patch failed: %d", ret);
-        return 0;
+/**
+ * @brief  Copy with unrolled word moves when src and dst share alignment
+ */
+static void mem_copy(uint8_t* dst, const uint8_t* src, size_t n) {
+    if (dst > src && dst < src + n) {
+        memmove(dst, src, n); /* Overlapping tail: copy backwards */
+        return;
     }
 
-    /* Record slot state, transfer last_alloc ownership to slot */
-    ctx->slots[args->comp].active = true;
-    ctx->slots[args->comp].orig_addr = args->orig;
-    ctx->slots[args->comp].target_addr = args->target;
-    ctx->slots[args->comp].code_size = ctx->last_alloc_size;
-    ctx->slots[args->comp].alloc_addr = ctx->last_alloc;
+    if ((((uintptr_t)dst ^ (uintptr_t)src) & 3) == 0) {
+        while (n > 0 && ((uintptr_t)dst & 3)) {
+            *dst++ = *src++;
+            n--;
+        }
+        uint32_t* wd = (uint32_t*)dst;
+        const uint32_t* ws = (const uint32_t*)src;
+        for (; n >= 16; n -= 16, wd += 4, ws += 4) {
+            wd[0] = ws[0];
+            wd[1] = ws[1];
+            wd[2] = ws[2];
+            wd[3] = ws[3];
+        }
+        for (; n >= 4; n -= 4)
+            *wd++ = *ws++;
+        dst = (uint8_t*)wd;
+        src = (const uint8_t*)ws;
+    }
+
+    while (n-- > 0)
+        *dst++ = *src++;
+}
+
+/**
+ * @brief  Fill --len bytes at --addr with --value
+ */
+static int cmd_memset(fl_context_t* ctx, const cmd_args_t* args) {
+    if (args->value < 0 || args->value > 0xFF) {
+        fl_response(false, "Invalid value %d", args->value);
+        return 0;
+    }
+
+    if (!check_scan_range(args, args->addr))
+        return 0;
+
+    uint8_t* dst = (uint8_t*)args->addr;
+    for (int off = 0; off < args->len; off += FL_MEM_SLICE_SIZE) {
+        size_t n = scan_slice(ctx, args->len, off);
+        mem_fill(dst + off, (uint8_t)args->value, n);
+    }
+    fl_flush_dcache(ctx, dst, args->len);
+
+    fl_response(true, "MEMSET 0x%08lX len=%d value=0x%02X", (unsigned long)args->addr, args->len, args->value);
+    return 0;
+}
+
+/**
+ * @brief  Copy --len bytes from --addr to --target (ranges may overlap)
+ */
+static int cmd_memcpy(fl_context_t* ctx, const cmd_args_t* args) {
+    if (args->target == 0) {
+        fl_response(false, "Missing --target");
+        return -1;
+    }
+
+    if (!check_scan_range(args, args->addr) || !check_scan_range(args, args->target))
+        return 0;
+
+    const uint8_t* src = (const uint8_t*)args->addr;
+    uint8_t* dst = (uint8_t*)args->target;
+    /* Overlapping with dst above src: move the slices back to front */
+    bool backward = dst > src && dst < src + args->len;
+    for (int done = 0; done < args->len; done += FL_MEM_SLICE_SIZE) {
+        size_t n = scan_slice(ctx, args->len, done);
+        size_t off = backward ? (size_t)args->len - done - n : (size_t)done;
+        mem_copy(dst + off, src + off, n);
+    }
+    fl_flush_dcache(ctx, dst, args->len);
+
+    fl_response(true, "MEMCPY 0x%08lX -> 0x%08lX len=%d", (unsigned long)args->addr, (unsigned long)args->target,
+                args->len);
+    return 0;
+}
+
+/**
+ * @brief  Find the first occurrence of the --data pattern in --len bytes at --addr
+ */
+static int cmd_memfind(fl_context_t* ctx, const cmd_args_t* args) {
+    if (!args->data && !args->bin) {
+        fl_response(false, "Missing --data");
+        return -1;
+    }
+
+    const uint8_t* pat;
+    int plen = load_data(ctx, args, &pat);
+    if (plen <= 0) {
+        fl_response(false, "Invalid %s data", args->z ? "compressed" : "base64");
+        return 0;
+    }
+
+    if (!check_scan_range(args, args->addr))
+        return 0;
+
+    const uint8_t* base = (const uint8_t*)args->addr;
+    int starts = args->len - plen + 1; /* Candidate start offsets */
+    for (int off = 0; off < starts; off += FL_MEM_SLICE_SIZE) {
+        size_t n = scan_slice(ctx, starts, off);
+        const uint8_t* p = base + off;
+        const uint8_t* end = p + n;
+        while ((p = memchr(p, pat[0], (size_t)(end - p))) != NULL) {
+            if (memcmp(p, pat, (size_t)plen) == 0) {
+                fl_response(true, "MEMFIND 0x%08lX", (unsigned long)(uintptr_t)p);
+                return 0;
+            }
+            p++;
+        }
+    }
+
+    fl_response(false, "MEMFIND not found");
+    return 0;
+}
+
+static int cmd_write(fl_context_t* ctx, const cmd_args_t* args) {
+    if (!args->data && !args->bin) {
+        fl_response(false, "Missing --data");
+        return -1;
+    }
+
+    const uint8_t* buf;
+    int n = load_data(ctx, args, &buf);
+    if (n < 0) {
+        fl_response(false, "Invalid %s data", args->z ? "compressed" : "base64");
+        return 0;
+    }
+
+    if (!args->force && !fl_check_addr_range(args->addr, n)) {
+        fl_response(false, "Invalid address range 0x%08lX+%d (use --force to override)", (unsigned long)args->addr, n);
+        return 0;
+    }
+
+    if (args->has_crc) {
+        /* CRC covers: addr(4B) + len(4B) + data payload */
+        const uint32_t hdr[2] = {(uint32_t)args->addr, (uint32_t)n};
+        uint32_t calc = crc_header(ctx, args->crc32, hdr, 2);
+        calc = crc_update(ctx, args->crc32, calc, buf, n);
+        if (calc != args->crc) {
+            int w = CRC_DIGITS(args->crc32);
+            fl_response(false, "CRC mismatch: 0x%0*lX != 0x%0*lX", w, (unsigned long)args->crc, w,
+                        (unsigned long)calc);
+            return 0;
+        }
+    }
+
+    /* Write to the specified address */
+    uint8_t* dest = (uint8_t*)args->addr;
+    memcpy(dest, buf, n);
+
+    /* Flush data cache */
+    fl_flush_dcache(ctx, dest, n);
+
+    fl_response(true, "WRITE %d bytes to 0x%lX", n, (unsigned long)args->addr);
+    return 0;
+}
+
+/**
+ * @brief  Verify --crc over a 3-word request header
+ * @return true if CRC matches or no CRC provided
+ */
+static bool verify_header_crc(fl_context_t* ctx, const cmd_args_t* args, const uint32_t hdr[3]) {
+    if (!args->has_crc)
+        return true;
+    uint32_t calc = crc_header(ctx, args->crc32, hdr, 3);
+    if (calc != args->crc) {
+        int w = CRC_DIGITS(args->crc32);
+        fl_response(false, "CRC mismatch: 0x%0*lX != 0x%0*lX", w, (unsigned long)args->crc, w, (unsigned long)calc);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief  Verify CRC for patch commands: covers comp(4B) + orig(4B) + target(4B)
+ * @return true if CRC matches or no CRC provided
+ */
+static bool verify_patch_crc(fl_context_t* ctx, const cmd_args_t* args) {
+    const uint32_t hdr[3] = {(uint32_t)args->comp, (uint32_t)args->orig, (uint32_t)args->target};
+    return verify_header_crc(ctx, args, hdr);
+}
+
+/**
+ * @brief  Free retired code whose grace period is over (two quiescent reports since retire)
+ */
+static void code_reclaim(fl_context_t* ctx) {
+    uint32_t seq = ctx->grace_seq;
+    for (uint32_t i = 0; i < FL_RETIRE_MAX; i++) {
+        fl_retired_t* r = &ctx->retired[i];
+        if (r->addr != 0 && seq - r->seq >= 2) {
+            ctx->free_cb((void*)r->addr);
+            r->addr = 0;
+        }
+    }
+}
+
+/**
+ * @brief  Make sure n more blocks can be retired before patched-in code is replaced
+ * @note   A full list only drains as quiescent states are reported: no entry is freed
+ *         early, the caller refuses the change and leaves the live patch in place.
+ * @return true if there is room (or no grace period is needed)
+ */
+static bool code_retire_reserve(fl_context_t* ctx, uint32_t n) {
+    if (n == 0 || !ctx->free_cb || !ctx->grace_free)
+        return true;
+
+    code_reclaim(ctx);
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < FL_RETIRE_MAX; i++) {
+        if (ctx->retired[i].addr != 0)
+            used++;
+    }
+    if (FL_RETIRE_MAX - used >= n)
+        return true;
+
+    fl_response(false, "Retire list full: %u/%d blocks wait for a grace period", (unsigned)used, FL_RETIRE_MAX);
+    return false;
+}
+
+/**
+ * @brief  Free code that is no longer patched in, after a grace period with grace_free
+ * @note   Callers reserve an entry with code_retire_reserve() first
+ */
+static void code_retire(fl_context_t* ctx, uintptr_t addr) {
+    if (addr == 0 || !ctx->free_cb)
+        return;
+
+    if (!ctx->grace_free) {
+        ctx->free_cb((void*)addr);
+        return;
+    }
+
+    code_reclaim(ctx);
+    for (uint32_t i = 0; i < FL_RETIRE_MAX; i++) {
+        fl_retired_t* r = &ctx->retired[i];
+        if (r->addr == 0) {
+            r->addr = addr;
+            r->seq = ctx->grace_seq;
+            return;
+        }
+    }
+    /* Not reserved: leaking the block is safe, freeing code that may still run is not */
+}
+
+/**
+ * @brief  Record a patch in a slot state, transferring last_alloc ownership to it
+ */
+static void slot_take_alloc(fl_context_t* ctx, fl_slot_state_t* slot, uint8_t op, uintptr_t orig, uintptr_t target) {
+    slot->active = true;
+    slot->op = op;
+    slot->orig_addr = orig;
+    slot->target_addr = target;
+    slot->code_size = ctx->last_alloc_size;
+    slot->alloc_addr = ctx->last_alloc;
     ctx->last_alloc = 0; /* Ownership transferred */
     ctx->last_alloc_size = 0;
+}
+
+/**
+ * @brief  Free a slot state's code allocation and clear it
+ */
+static void slot_release(fl_context_t* ctx, fl_slot_state_t* slot) {
+    code_retire(ctx, slot->alloc_addr);
+    memset(slot, 0, sizeof(*slot));
+}
+
+/**
+ * @brief  Clear a stage entry and free its code
+ * @param  armed Commit armed it before rolling back: it may have run, so wait for a grace period
+ */
+static void stage_release(fl_context_t* ctx, fl_stage_t* st, bool armed) {
+    if (armed)
+        code_retire(ctx, st->slot.alloc_addr);
+    else if (st->slot.alloc_addr != 0 && ctx->free_cb)
+        ctx->free_cb((void*)st->slot.alloc_addr);
+    memset(st, 0, sizeof(*st));
+}
+
+/**
+ * @brief  Disarm a comparator in every mode it may be armed in
+ */
+static void slot_disarm(uint32_t comp) {
+#ifndef FPB_NO_TRAMPOLINE
+    fpb_trampoline_clear_target(comp);
+#endif
+#ifndef FPB_NO_DEBUGMON
+    fpb_debugmon_clear_redirect(comp);
+#endif
+    fpb_clear_patch(comp);
+}
+
+/**
+ * @brief  Arm a comparator for a staged patch (op: FL_OP_PATCH/TPATCH/DPATCH/IPATCH)
+ * @return 0 on success, else the driver error code
+ */
+static int slot_arm(uint8_t op, uint32_t comp, uint32_t orig, uint32_t target) {
+    switch (op) {
+#ifndef FPB_NO_TRAMPOLINE
+        case FL_OP_TPATCH: {
+            fpb_trampoline_set_target(comp, target);
+            fpb_result_t ret = fpb_set_patch(comp, orig, fpb_trampoline_get_address(comp));
+            if (ret != FPB_OK) {
+                fpb_trampoline_clear_target(comp);
+            }
+            return ret;
+        }
+#endif
+#ifndef FPB_NO_DEBUGMON
+        case FL_OP_DPATCH:
+            return fpb_debugmon_set_redirect(comp, orig, target);
+#endif
+        case FL_OP_IPATCH:
+            return fpb_set_insn_patch(comp, orig, target);
+        default:
+            return fpb_set_patch(comp, orig, target);
+    }
+}
+
+/**
+ * @brief  Refuse a patch on a word an ipatch slot remaps, or an ipatch on a patched word
+ * @note   The ipatch comparator replaces the whole word: another comparator on it would
+ *         shadow it or be shadowed. Staged slots count too, or commit would arm both.
+ * @return true if no other slot, live or staged, conflicts
+ */
+static bool slot_word_free(fl_context_t* ctx, uint32_t comp, uint8_t op, uintptr_t addr) {
+    uint32_t word = (uint32_t)addr & ~3UL;
+    for (uint32_t i = 0; i < FL_MAX_SLOTS; i++) {
+        if (i == comp)
+            continue;
+        const fl_slot_state_t* live = &ctx->slots[i];
+        if (live->active && (op == FL_OP_IPATCH || live->op == FL_OP_IPATCH) && (live->orig_addr & ~3UL) == word) {
+            fl_response(false, "Slot %lu already patches 0x%08lX", (unsigned long)i, (unsigned long)live->orig_addr);
+            return false;
+        }
+        const fl_stage_t* st = &ctx->stage[i];
+        if (st->op != 0 && (op == FL_OP_IPATCH || st->op == FL_OP_IPATCH) && (st->slot.orig_addr & ~3UL) == word) {
+            fl_response(false, "Slot %lu stages 0x%08lX", (unsigned long)i, (unsigned long)st->slot.orig_addr);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief  --stage: record the patch in the stage table instead of arming it
+ */
+static int stage_patch(fl_context_t* ctx, uint8_t op, const cmd_args_t* args) {
+    fl_stage_t* st = &ctx->stage[args->comp];
+
+    /* Catch now what would fail at commit (dpatch is checked by the caller) */
+    if (op != FL_OP_DPATCH) {
+        fpb_result_t ret = fpb_check_patch(args->comp, args->orig);
+        if (ret != FPB_OK) {
+            fl_response(false, "fpb_set_patch failed: %d", ret);
+            return 0;
+        }
+    }
+
+    /* Re-staging a slot replaces (and frees) the previous entry */
+    stage_release(ctx, st, false);
+    st->op = op;
+    slot_take_alloc(ctx, &st->slot, op, args->orig, args->target);
+
+    fl_response(true, "Staged %lu: 0x%08lX -> 0x%08lX", (unsigned long)args->comp, (unsigned long)args->orig,
+                (unsigned long)args->target);
+    return 0;
+}
+
+static int cmd_patch(fl_context_t* ctx, const cmd_args_t* args) {
+    if (args->orig == 0 || args->target == 0) {
+        fl_response(false, "Missing --orig/--target");
+        return -1;
+    }
+
+    if (!verify_patch_crc(ctx, args))
+        return 0;
+
+    if ((uint32_t)args->comp >= fpb_get_state()->num_code_comp || (uint32_t)args->comp >= FL_MAX_SLOTS) {
+        fl_response(false, "Invalid comp %lu", (unsigned long)args->comp);
+        return 0;
+    }
+
+    if (!slot_word_free(ctx, args->comp, FL_OP_PATCH, args->orig))
+        return 0;
+
+    if (args->stage)
+        return stage_patch(ctx, FL_OP_PATCH, args);
+
+    fpb_result_t ret = fpb_set_patch(args->comp, args->orig, args->target);
+    if (ret != FPB_OK) {
+        fl_response(false, "fpb_set_patch failed: %d", ret);
+        return 0;
+    }
+
+    /* Record slot state, transfer last_alloc ownership to slot */
+    slot_take_alloc(ctx, &ctx->slots[args->comp], FL_OP_PATCH, args->orig, args->target);
+
+    fl_response(true, "Patch %lu: 0x%08lX -> 0x%08lX", (unsigned long)args->comp, (unsigned long)args->orig,
+                (unsigned long)args->target);
+    return 0;
+}
+
+static int cmd_tpatch(fl_context_t* ctx, const cmd_args_t* args) {
+    if (args->orig == 0 || args->target == 0) {
+        fl_response(false, "Missing --orig/--target");
+        return -1;
+    }
+
+#ifndef FPB_NO_TRAMPOLINE
+    if (!verify_patch_crc(ctx, args))
+        return 0;
+
+    if ((uint32_t)args->comp >= FPB_TRAMPOLINE_COUNT || (uint32_t)args->comp >= FL_MAX_SLOTS) {
+        fl_response(false, "Invalid comp %lu (max %d)", (unsigned long)args->comp, FPB_TRAMPOLINE_COUNT - 1);
+        return 0;
+    }
+
+    if (!slot_word_free(ctx, args->comp, FL_OP_TPATCH, args->orig))
+        return 0;
+
+    if (args->stage)
+        return stage_patch(ctx, FL_OP_TPATCH, args);
+
+    /* Set trampoline target in RAM */
+    fpb_trampoline_set_target(args->comp, args->target);
+
+    /* Get trampoline address in Flash */
+    uint32_t tramp_addr = fpb_trampoline_get_address(args->comp);
+
+    /* Use FPB to redirect original function to trampoline */
+    fpb_result_t ret = fpb_set_patch(args->comp, args->orig, tramp_addr);
+    if (ret != FPB_OK) {
+        fpb_trampoline_clear_target(args->comp);
+        fl_response(false, "fpb_set_patch failed: %d", ret);
+        return 0;
+    }
+
+    /* Record slot state, transfer last_alloc ownership to slot */
+    slot_take_alloc(ctx, &ctx->slots[args->comp], FL_OP_TPATCH, args->orig, args->target);
 
     fl_response(true, "Trampoline %lu: 0x%08lX -> tramp(0x%08lX) -> 0x%08lX", (unsigned long)args->comp,
                 (unsigned long)args->orig, (unsigned long)tramp_addr, (unsigned long)args->target);
@@ -657,14 +1333,21 @@ static int cmd_dpatch(fl_context_t* ctx, const cmd_args_t* args) {
     }
 
 #ifndef FPB_NO_DEBUGMON
-    if (!verify_patch_crc(args->crc, args->comp, args->orig, args->target))
+    if (!verify_patch_crc(ctx, args))
         return 0;
 
-    if ((uint32_t)args->comp >= FPB_DEBUGMON_MAX_REDIRECTS || (uint32_t)args->comp >= FL_MAX_SLOTS) {
-        fl_response(false, "Invalid comp %lu (max %d)", (unsigned long)args->comp, FPB_DEBUGMON_MAX_REDIRECTS - 1);
+    uint32_t num_redirects = fpb_debugmon_get_capacity();
+    if ((uint32_t)args->comp >= num_redirects || (uint32_t)args->comp >= FL_MAX_SLOTS) {
+        fl_response(false, "Invalid comp %lu (%u redirect slots)", (unsigned long)args->comp, (unsigned)num_redirects);
         return 0;
     }
 
+    if (!slot_word_free(ctx, args->comp, FL_OP_DPATCH, args->orig))
+        return 0;
+
+    if (args->stage)
+        return stage_patch(ctx, FL_OP_DPATCH, args);
+
     /* Initialize DebugMonitor if not already done */
     if (!fpb_debugmon_is_active()) {
         if (fpb_debugmon_init() != 0) {
@@ -681,13 +1364,7 @@ static int cmd_dpatch(fl_context_t* ctx, const cmd_args_t* args) {
     }
 
     /* Record slot state, transfer last_alloc ownership to slot */
-    ctx->slots[args->comp].active = true;
-    ctx->slots[args->comp].orig_addr = args->orig;
-    ctx->slots[args->comp].target_addr = args->target;
-    ctx->slots[args->comp].code_size = ctx->last_alloc_size;
-    ctx->slots[args->comp].alloc_addr = ctx->last_alloc;
-    ctx->last_alloc = 0; /* Ownership transferred */
-    ctx->last_alloc_size = 0;
+    slot_take_alloc(ctx, &ctx->slots[args->comp], FL_OP_DPATCH, args->orig, args->target);
 
     fl_response(true, "DebugMon %lu: 0x%08lX -> 0x%08lX", (unsigned long)args->comp, (unsigned long)args->orig,
                 (unsigned long)args->target);
@@ -698,97 +1375,610 @@ static int cmd_dpatch(fl_context_t* ctx, const cmd_args_t* args) {
     return 0;
 }
 
+/**
+ * @brief  Replace the instruction at --addr with --insn through the remap table
+ * @note   No trampoline and no RAM code: the function keeps running from Flash.
+ *         --insn is in objdump order (first halfword high for 32-bit instructions),
+ *         --crc covers comp(4B) + addr(4B) + insn(4B).
+ */
+static int cmd_ipatch(fl_context_t* ctx, const cmd_args_t* args) {
+    if (args->addr == 0 || !args->has_insn) {
+        fl_response(false, "Missing --addr/--insn");
+        return -1;
+    }
+
+    const uint32_t hdr[3] = {(uint32_t)args->comp, (uint32_t)args->addr, args->insn};
+    if (!verify_header_crc(ctx, args, hdr))
+        return 0;
+
+    if ((uint32_t)args->comp >= fpb_get_state()->num_code_comp || (uint32_t)args->comp >= FL_MAX_SLOTS) {
+        fl_response(false, "Invalid comp %lu", (unsigned long)args->comp);
+        return 0;
+    }
+
+    if (!fpb_get_state()->remap_supported) {
+        fl_response(false, "ipatch needs FPB remap (FPBv1)");
+        return 0;
+    }
+
+    /* Checked before the live slot is touched, so a bad instruction leaves it armed */
+    fpb_result_t ret = fpb_check_insn_patch(args->comp, args->addr, args->insn);
+    if (ret != FPB_OK) {
+        fl_response(false, "fpb_set_insn_patch failed: %d", ret);
+        return 0;
+    }
+
+    if (!slot_word_free(ctx, args->comp, FL_OP_IPATCH, args->addr))
+        return 0;
+
+    fl_slot_state_t ipatch = {
+        .active = true,
+        .orig_addr = (uint32_t)args->addr,
+        .target_addr = args->insn,
+        .op = FL_OP_IPATCH,
+    };
+
+    if (args->stage) {
+        fl_stage_t* st = &ctx->stage[args->comp];
+        stage_release(ctx, st, false);
+        st->op = FL_OP_IPATCH;
+        st->slot = ipatch;
+        fl_response(true, "Staged %lu: 0x%08lX insn 0x%08lX", (unsigned long)args->comp, (unsigned long)args->addr,
+                    (unsigned long)args->insn);
+        return 0;
+    }
+
+    /* Like commit: a slot being replaced is disarmed in whatever mode armed it, then freed */
+    fl_slot_state_t* slot = &ctx->slots[args->comp];
+    if (!code_retire_reserve(ctx, slot->alloc_addr != 0))
+        return 0;
+    if (slot->active)
+        slot_disarm(args->comp);
+    slot_release(ctx, slot);
+
+    ret = fpb_set_insn_patch(args->comp, args->addr, args->insn);
+    if (ret != FPB_OK) {
+        fl_response(false, "fpb_set_insn_patch failed: %d", ret);
+        return 0;
+    }
+
+    *slot = ipatch;
+
+    fl_response(true, "IPatch %lu: 0x%08lX insn 0x%08lX", (unsigned long)args->comp, (unsigned long)args->addr,
+                (unsigned long)args->insn);
+    return 0;
+}
+
+/**
+ * @brief  Point a live tpatch/dpatch slot at new code (last_alloc) without unpatching
+ * @note   The switch is one aligned word store, so every call enters either the old or
+ *         the new code; the old allocation is retired only after the store.
+ *         --mode tpatch|dpatch fails unless the slot is armed that way.
+ *         Needs grace_free: freed at once, the old code could still be running.
+ */
+static int cmd_retarget(fl_context_t* ctx, const cmd_args_t* args) {
+    if (args->target == 0) {
+        fl_response(false, "Missing --target");
+        return -1;
+    }
+
+    const char* mode = args->mode ? args->mode : "";
+    uint8_t want = 0;
+    if (strcmp(mode, "tpatch") == 0) {
+        want = FL_OP_TPATCH;
+    } else if (strcmp(mode, "dpatch") == 0) {
+        want = FL_OP_DPATCH;
+    } else if (mode[0] != '\0') {
+        fl_response(false, "Invalid mode '%s' (tpatch, dpatch)", mode);
+        return -1;
+    }
+
+    if (!verify_patch_crc(ctx, args))
+        return 0;
+
+    uint32_t comp = (uint32_t)args->comp;
+    if (comp >= FL_MAX_SLOTS || !ctx->slots[comp].active) {
+        fl_response(false, "Slot %lu not patched", (unsigned long)comp);
+        return 0;
+    }
+
+    fl_slot_state_t* slot = &ctx->slots[comp];
+
+    if (args->orig != 0 && (args->orig & ~1UL) != (slot->orig_addr & ~1UL)) {
+        fl_response(false, "Slot %lu patches 0x%08lX", (unsigned long)comp, (unsigned long)slot->orig_addr);
+        return 0;
+    }
+
+    if (want != 0 && want != slot->op) {
+        fl_response(false, "Slot %lu not armed by %s", (unsigned long)comp, mode);
+        return 0;
+    }
+
+    if (slot->op != FL_OP_TPATCH && slot->op != FL_OP_DPATCH) {
+        /* REMAP points straight at the code: no word to swap */
+        fl_response(false, "Slot %lu is not a tpatch/dpatch slot", (unsigned long)comp);
+        return 0;
+    }
+
+    if (!ctx->grace_free) {
+        fl_response(false, "Retarget needs grace periods (port reports no quiescent states)");
+        return 0;
+    }
+
+    /* The slot takes ownership of last_alloc: the target must lie in it */
+    uintptr_t target = args->target & ~(uintptr_t)1;
+    if (ctx->last_alloc == 0 || target < ctx->last_alloc || target - ctx->last_alloc >= ctx->last_alloc_size) {
+        fl_response(false, "Target 0x%08lX not in the last allocation", (unsigned long)args->target);
+        return 0;
+    }
+
+    if (!code_retire_reserve(ctx, slot->alloc_addr != 0))
+        return 0;
+
+    switch (slot->op) {
+#ifndef FPB_NO_TRAMPOLINE
+        case FL_OP_TPATCH:
+            fpb_trampoline_set_target(comp, args->target);
+            break;
+#endif
+#ifndef FPB_NO_DEBUGMON
+        case FL_OP_DPATCH:
+            if (fpb_debugmon_retarget(comp, args->target) != 0) {
+                fl_response(false, "fpb_debugmon_retarget failed");
+                return 0;
+            }
+            break;
+#endif
+        default:
+            fl_response(false, "Slot %lu is not a tpatch/dpatch slot", (unsigned long)comp);
+            return 0;
+    }
+
+    /* New calls enter the new code from here on: retire the old allocation */
+    uintptr_t old_alloc = slot->alloc_addr;
+    uint32_t old_target = slot->target_addr;
+    slot_take_alloc(ctx, slot, slot->op, slot->orig_addr, args->target);
+    code_retire(ctx, old_alloc);
+
+    fl_response(true, "Retarget %lu: 0x%08lX -> 0x%08lX (was 0x%08lX)", (unsigned long)comp,
+                (unsigned long)slot->orig_addr, (unsigned long)args->target, (unsigned long)old_target);
+    return 0;
+}
+
 static int cmd_unpatch(fl_context_t* ctx, const cmd_args_t* args) {
     uint32_t comp = (uint32_t)args->comp;
     bool all = args->all;
-    uint32_t num_comps = fpb_get_state()->num_code_comp;
+    uint32_t num_slots = slot_count();
     uint32_t start = all ? 0 : comp;
-    uint32_t end = all ? num_comps : comp + 1;
+    uint32_t end = all ? num_slots : comp + 1;
 
-    if (!all && (comp >= num_comps || comp >= FL_MAX_SLOTS)) {
+    if (!all && comp >= num_slots) {
         fl_response(false, "Invalid comp %lu", (unsigned long)comp);
         return 0;
     }
 
+    uint32_t retiring = 0;
+    for (uint32_t i = start; i < end && i < FL_MAX_SLOTS; i++) {
+        retiring += ctx->slots[i].alloc_addr != 0;
+    }
+    if (!code_retire_reserve(ctx, retiring))
+        return 0;
+
     uint32_t cleared = 0;
     for (uint32_t i = start; i < end && i < FL_MAX_SLOTS; i++) {
         if (ctx->slots[i].active || all) {
-#ifndef FPB_NO_TRAMPOLINE
-            fpb_trampoline_clear_target(i);
-#endif
+            slot_disarm(i);
+
+            /* Free slot's allocated memory if any, clear slot state */
+            slot_release(ctx, &ctx->slots[i]);
+            cleared++;
+        }
+    }
+
+    if (all) {
+        fl_response(true, "Cleared all %u slots, memory freed", (unsigned)cleared);
+    } else {
+        fl_response(true, "Cleared slot %lu", (unsigned long)comp);
+    }
+    return 0;
+}
+
+/**
+ * @brief  Drop every staged entry and free its code
+ * @param  armed_upto Last slot a failed commit armed, -1 = none
+ * @return Number of entries dropped
+ */
+static uint32_t stage_drop(fl_context_t* ctx, int armed_upto) {
+    uint32_t dropped = 0;
+    for (uint32_t i = 0; i < FL_MAX_SLOTS; i++) {
+        fl_stage_t* st = &ctx->stage[i];
+        if (st->op != 0) {
+            stage_release(ctx, st, (int)i <= armed_upto);
+            dropped++;
+        }
+    }
+    return dropped;
+}
+
+static int cmd_commit(fl_context_t* ctx, const cmd_args_t* args) {
+    (void)args;
+    uint32_t staged = 0;
+    uint32_t live_allocs = 0;
+    uint32_t staged_allocs = 0;
+    bool need_debugmon = false;
+    for (uint32_t i = 0; i < FL_MAX_SLOTS; i++) {
+        if (ctx->stage[i].op != 0) {
+            staged++;
+            live_allocs += ctx->slots[i].alloc_addr != 0;
+            staged_allocs += ctx->stage[i].slot.alloc_addr != 0;
+            need_debugmon |= ctx->stage[i].op == FL_OP_DPATCH;
+        }
+    }
+
+    if (staged == 0) {
+        fl_response(false, "Nothing staged");
+        return 0;
+    }
+
+    /* Success retires the replaced code, a rollback the staged code that was armed */
+    if (!code_retire_reserve(ctx, live_allocs > staged_allocs ? live_allocs : staged_allocs))
+        return 0;
+
 #ifndef FPB_NO_DEBUGMON
-            fpb_debugmon_clear_redirect(i);
+    /* DebugMonitor init is slow and logs: do it before masking interrupts */
+    if (need_debugmon && !fpb_debugmon_is_active() && fpb_debugmon_init() != 0) {
+        fl_response(false, "DebugMonitor init failed");
+        return 0;
+    }
+#else
+    (void)need_debugmon;
 #endif
-            fpb_clear_patch(i);
 
-            /* Free slot's allocated memory if any */
-            if (ctx->slots[i].alloc_addr != 0 && ctx->free_cb) {
-                ctx->free_cb((void*)ctx->slots[i].alloc_addr);
-            }
+    /* Arm all staged slots in one critical section, with a single DSB/ISB */
+    int failed = -1;
+    int err = 0;
+    uint32_t irq = ctx->irq_save_cb ? ctx->irq_save_cb() : 0;
+    fpb_begin_update();
+    for (uint32_t i = 0; i < FL_MAX_SLOTS && failed < 0; i++) {
+        const fl_stage_t* st = &ctx->stage[i];
+        if (st->op == 0)
+            continue;
+        if (ctx->slots[i].active)
+            slot_disarm(i);
+        err = slot_arm(st->op, i, st->slot.orig_addr, st->slot.target_addr);
+        if (err != 0)
+            failed = (int)i;
+    }
+    if (failed >= 0) {
+        /* All or nothing: re-arm the live patches of every slot touched so far */
+        for (uint32_t i = 0; i <= (uint32_t)failed; i++) {
+            const fl_slot_state_t* live = &ctx->slots[i];
+            if (ctx->stage[i].op == 0)
+                continue;
+            slot_disarm(i);
+            if (live->active)
+                slot_arm(live->op, i, live->orig_addr, live->target_addr);
+        }
+    }
+    fpb_end_update();
+    if (ctx->irq_restore_cb)
+        ctx->irq_restore_cb(irq);
+
+    if (failed >= 0) {
+        /* Live slots are as before: only the stage is dropped */
+        stage_drop(ctx, failed);
+        fl_response(false, "Commit slot %d failed: %d (rolled back)", failed, err);
+        return 0;
+    }
+
+    /* Free replaced code and install the staged slot states */
+    for (uint32_t i = 0; i < FL_MAX_SLOTS; i++) {
+        fl_stage_t* st = &ctx->stage[i];
+        if (st->op == 0)
+            continue;
+        slot_release(ctx, &ctx->slots[i]);
+        ctx->slots[i] = st->slot;
+        memset(st, 0, sizeof(*st));
+    }
+
+    fl_response(true, "Committed %u", (unsigned)staged);
+    return 0;
+}
+
+static int cmd_abort(fl_context_t* ctx, const cmd_args_t* args) {
+    (void)args;
+    fl_response(true, "Aborted %u", (unsigned)stage_drop(ctx, -1));
+    return 0;
+}
+
+static int cmd_enable(fl_context_t* ctx, const cmd_args_t* args) {
+    if (args->enable < 0) {
+        fl_response(false, "Missing --enable (0 or 1)");
+        return -1;
+    }
+
+    (void)ctx;
+    bool en = args->enable != 0;
+    bool all = args->all;
+    uint32_t comp = (uint32_t)args->comp;
+    uint32_t num_comps = fpb_get_state()->num_code_comp;
+    uint32_t start = all ? 0 : comp;
+    uint32_t end = all ? num_comps : comp + 1;
+
+    if (!all && (comp >= num_comps || comp >= FL_MAX_SLOTS)) {
+        fl_response(false, "Invalid comp %lu", (unsigned long)comp);
+        return 0;
+    }
+
+    uint32_t changed = 0;
+    for (uint32_t i = start; i < end && i < FL_MAX_SLOTS; i++) {
+        fpb_result_t ret = fpb_enable_patch(i, en);
+        if (ret == FPB_OK) {
+            changed++;
+        }
+    }
+
+    if (all) {
+        fl_response(true, "%s %u patches", en ? "Enabled" : "Disabled", (unsigned)changed);
+    } else {
+        fl_response(true, "%s patch %lu", en ? "Enabled" : "Disabled", (unsigned long)comp);
+    }
+    return 0;
+}
+
+__attribute__((noinline)) void fl_hello(void) {
+    fl_response(true, "HELLO from original fl_hello(%p) function!", (void*)fl_hello);
+}
+
+static int cmd_hello(fl_context_t* ctx, const cmd_args_t* args) {
+    (void)ctx;
+    (void)args;
+    fl_hello();
+    return 0;
+}
+
+/* Batch record: op(1) + len(2, LE) + the TLV payload of a frame with that op */
+#define BATCH_REC_HDR_SIZE 3
+
+static int exec_op(fl_context_t* ctx, uint8_t op, const uint8_t* payload, size_t len);
+
+/**
+ * @brief  Check if an op may run inside a batch
+ * @note   Commands that send data are excluded: text output references b64_buf,
+ *         which holds the records of a text batch. No nesting either.
+ */
+static bool batch_op_allowed(uint8_t op) {
+    return op != FL_OP_BATCH && op != FL_OP_ECHOBACK && op != FL_OP_READ && op != FL_OP_READV && op != FL_OP_HASH &&
+           op != FL_OP_FREAD;
+}
+
+/* Check if a TLV list carries tag (malformed lists are left to exec_op) */
+static bool tlv_has_tag(const uint8_t* p, size_t len, uint8_t tag) {
+    size_t pos = 0;
+    while (len - pos >= 3) {
+        if (p[pos] == tag)
+            return true;
+        pos += 3 + ((size_t)p[pos + 1] | ((size_t)p[pos + 2] << 8));
+        if (pos > len)
+            break;
+    }
+    return false;
+}
+
+static int cmd_batch(fl_context_t* ctx, const cmd_args_t* args) {
+    const uint8_t* rec = args->bin;
+    int len = args->bin_len;
+    if (!rec) {
+        /* Text: base64 records are decoded into b64_buf, buf stays free for the sub-commands */
+        rec = (const uint8_t*)ctx->b64_buf;
+        len = decode_data(args, (uint8_t*)ctx->b64_buf, FL_B64_BUF_SIZE);
+    }
+    if (len <= 0) {
+        fl_response(false, "Invalid batch data");
+        return -1;
+    }
+
+    /* Validate every record before running the first one */
+    int total = 0;
+    for (int pos = 0; pos < len; total++) {
+        size_t rlen = 0;
+        if (len - pos >= BATCH_REC_HDR_SIZE)
+            rlen = (size_t)rec[pos + 1] | ((size_t)rec[pos + 2] << 8);
+        if (len - pos < BATCH_REC_HDR_SIZE || rlen > (size_t)(len - pos - BATCH_REC_HDR_SIZE)) {
+            fl_response(false, "Truncated batch record %d", total);
+            return -1;
+        }
+        if (!batch_op_allowed(rec[pos])) {
+            fl_response(false, "Op 0x%02X not allowed in batch", (unsigned)rec[pos]);
+            return -1;
+        }
+        /* --z inflates into b64_buf, which a text batch still needs */
+        if (!args->bin && tlv_has_tag(rec + pos + BATCH_REC_HDR_SIZE, rlen, FL_TAG_Z)) {
+            fl_response(false, "--z not allowed in text batch");
+            return -1;
+        }
+        pos += BATCH_REC_HDR_SIZE + (int)rlen;
+    }
+
+    /* Stop at the first [FLERR] or failed handler */
+    int done = 0;
+    fl_log_batch(true);
+    for (int pos = 0; pos < len; done++) {
+        size_t rlen = (size_t)rec[pos + 1] | ((size_t)rec[pos + 2] << 8);
+        int ret = exec_op(ctx, rec[pos], rec + pos + BATCH_REC_HDR_SIZE, rlen);
+        if (ret < 0 || fl_log_batch_error())
+            break;
+        pos += BATCH_REC_HDR_SIZE + (int)rlen;
+    }
+    fl_log_batch(false);
+
+    fl_response(done == total, "BATCH %d/%d", done, total);
+    return 0;
+}
+
+/* ===========================
+   SAMPLER
+   =========================== */
+
+#if FL_USE_SAMPLE
+
+/**
+ * @brief  sample --mode add|start|stop|clear, status without --mode
+ * @note   add: --addr/--len probe (1..8 bytes), start: --value period in us
+ *         (0 or no timestamp_hz = every tick). Records stream as [FLSMP]
+ *         lines from fl_sample_poll(), see fl_sample.h.
+ */
+static int cmd_sample(fl_context_t* ctx, const cmd_args_t* args) {
+    fl_sample_t* s = &ctx->sample;
+    const char* mode = args->mode ? args->mode : "";
+
+    if (strcmp(mode, "add") == 0) {
+        if (s->running) {
+            fl_response(false, "Sampler running");
+            return 0;
+        }
+        if (!check_scan_range(args, args->addr))
+            return 0;
+        int idx = fl_sample_add(s, args->addr, (size_t)args->len);
+        if (idx < 0) {
+            fl_response(false, "Invalid probe (max %d, 1..%d bytes)", FL_SAMPLE_MAX_PROBES, FL_SAMPLE_PROBE_SIZE);
+            return 0;
+        }
+        fl_response(true, "SAMPLE probe=%d addr=0x%08lX len=%d", idx, (unsigned long)args->addr, args->len);
+    } else if (strcmp(mode, "start") == 0) {
+        if (s->count == 0) {
+            fl_response(false, "No probes");
+            return 0;
+        }
+        uint32_t period = 0;
+        if (args->value > 0)
+            period = (uint32_t)((uint64_t)(uint32_t)args->value * ctx->timestamp_hz / 1000000u);
+        fl_sample_start(ctx, period);
+        fl_response(true, "SAMPLE start probes=%u period=%lu hz=%lu", (unsigned)s->count, (unsigned long)period,
+                    (unsigned long)ctx->timestamp_hz);
+    } else if (strcmp(mode, "stop") == 0) {
+        fl_sample_stop(s);
+        fl_response(true, "SAMPLE stop records=%lu dropped=%lu", (unsigned long)s->records,
+                    (unsigned long)s->dropped);
+    } else if (strcmp(mode, "clear") == 0) {
+        fl_sample_clear(s);
+        fl_response(true, "SAMPLE clear");
+    } else if (mode[0] == '\0') {
+        fl_response(true, "SAMPLE %s probes=%u period=%lu hz=%lu records=%lu dropped=%lu",
+                    s->running ? "running" : "stopped", (unsigned)s->count, (unsigned long)s->period,
+                    (unsigned long)ctx->timestamp_hz, (unsigned long)s->records, (unsigned long)s->dropped);
+    } else {
+        fl_response(false, "Invalid mode '%s' (add/start/stop/clear)", mode);
+        return -1;
+    }
+    return 0;
+}
+
+#endif /* FL_USE_SAMPLE */
+
+/* ===========================
+   PROFILER
+   =========================== */
+
+#if FL_USE_PROF
 
-            /* Clear slot state */
-            ctx->slots[i].active = false;
-            ctx->slots[i].orig_addr = 0;
-            ctx->slots[i].target_addr = 0;
-            ctx->slots[i].code_size = 0;
-            ctx->slots[i].alloc_addr = 0;
-            cleared++;
-        }
-    }
+static void prof_status(const fl_prof_t* p) {
+    fl_response(true, "PROF %s hz=%lu samples=%lu overflow=%lu buckets=%lu", p->running ? "running" : "stopped",
+                (unsigned long)p->hz, (unsigned long)p->samples, (unsigned long)p->overflow, (unsigned long)p->used);
+}
 
-    if (all) {
-        fl_response(true, "Cleared all %u slots, memory freed", (unsigned)cleared);
+/**
+ * @brief  prof --mode start|stop|dump, status without --mode
+ * @note   start: --value sample rate in Hz (default FL_PROF_DEFAULT_HZ),
+ *         clears the previous profile. dump: one "0x<pc> <count>" line per
+ *         bucket, unsorted; the host maps PCs to functions.
+ */
+static int cmd_prof(fl_context_t* ctx, const cmd_args_t* args) {
+    fl_prof_t* p = &ctx->prof;
+    const char* mode = args->mode ? args->mode : "";
+
+    if (strcmp(mode, "start") == 0) {
+        if (!ctx->prof_timer_cb) {
+            fl_response(false, "No sample timer");
+            return 0;
+        }
+        uint32_t hz = args->value > 0 ? (uint32_t)args->value : FL_PROF_DEFAULT_HZ;
+        ctx->prof_timer_cb(0);
+        fl_prof_reset(p);
+        p->hz = hz;
+        p->running = true;
+        if (!ctx->prof_timer_cb(hz)) {
+            p->running = false;
+            fl_response(false, "Unsupported rate %lu Hz", (unsigned long)hz);
+            return 0;
+        }
+        fl_response(true, "PROF start hz=%lu slots=%u", (unsigned long)hz, (unsigned)FL_PROF_SLOTS);
+    } else if (strcmp(mode, "stop") == 0) {
+        if (ctx->prof_timer_cb)
+            ctx->prof_timer_cb(0);
+        p->running = false;
+        fl_response(true, "PROF stop samples=%lu", (unsigned long)p->samples);
+    } else if (strcmp(mode, "dump") == 0) {
+        for (uint32_t i = 0; i < FL_PROF_SLOTS; i++) {
+            const fl_prof_bucket_t* b = &p->buckets[i];
+            if (b->count != 0)
+                fl_println("0x%08lX %lu", (unsigned long)b->pc, (unsigned long)b->count);
+        }
+        prof_status(p);
+    } else if (mode[0] == '\0') {
+        prof_status(p);
     } else {
-        fl_response(true, "Cleared slot %lu", (unsigned long)comp);
+        fl_response(false, "Invalid mode '%s' (start/stop/dump)", mode);
+        return -1;
     }
     return 0;
 }
 
-static int cmd_enable(fl_context_t* ctx, const cmd_args_t* args) {
-    if (args->enable < 0) {
-        fl_response(false, "Missing --enable (0 or 1)");
-        return -1;
-    }
+#endif /* FL_USE_PROF */
 
+/* ===========================
+   TRAMPOLINE STATISTICS
+   =========================== */
+
+#if FL_SLOTSTATS
+
+/**
+ * @brief  slotstats: call and cycle counters of the trampolines, --mode reset
+ *         zeroes them
+ * @note   One line per slot that was called since its tpatch. Cycles are
+ *         DWT_CYCCNT core clocks from trampoline entry to the target's
+ *         return, so they include the accounting overhead.
+ */
+static int cmd_slotstats(fl_context_t* ctx, const cmd_args_t* args) {
     (void)ctx;
-    bool en = args->enable != 0;
-    bool all = args->all;
-    uint32_t comp = (uint32_t)args->comp;
-    uint32_t num_comps = fpb_get_state()->num_code_comp;
-    uint32_t start = all ? 0 : comp;
-    uint32_t end = all ? num_comps : comp + 1;
+    const char* mode = args->mode ? args->mode : "";
 
-    if (!all && (comp >= num_comps || comp >= FL_MAX_SLOTS)) {
-        fl_response(false, "Invalid comp %lu", (unsigned long)comp);
+    if (strcmp(mode, "reset") == 0) {
+        for (uint32_t i = 0; i < FPB_TRAMPOLINE_COUNT; i++)
+            fpb_trampoline_reset_stats(i);
+        fl_response(true, "SLOTSTATS reset");
         return 0;
     }
-
-    uint32_t changed = 0;
-    for (uint32_t i = start; i < end && i < FL_MAX_SLOTS; i++) {
-        fpb_result_t ret = fpb_enable_patch(i, en);
-        if (ret == FPB_OK) {
-            changed++;
-        }
+    if (mode[0] != '\0') {
+        fl_response(false, "Invalid mode '%s' (reset)", mode);
+        return -1;
     }
 
-    if (all) {
-        fl_response(true, "%s %u patches", en ? "Enabled" : "Disabled", (unsigned)changed);
-    } else {
-        fl_response(true, "%s patch %lu", en ? "Enabled" : "Disabled", (unsigned long)comp);
+    unsigned count = 0;
+    for (uint32_t i = 0; i < FPB_TRAMPOLINE_COUNT; i++) {
+        fpb_trampoline_stats_t st;
+        if (!fpb_trampoline_get_stats(i, &st) || st.calls == 0)
+            continue;
+        uint32_t avg = st.timed ? (uint32_t)(st.cycles / st.timed) : 0;
+        fl_println("Slot[%u]: calls=%lu timed=%lu avg=%lu max=%lu", (unsigned)i, (unsigned long)st.calls,
+                   (unsigned long)st.timed, (unsigned long)avg, (unsigned long)st.max);
+        count++;
     }
+    fl_response(true, "SLOTSTATS slots=%u", count);
     return 0;
 }
 
-__attribute__((noinline)) void fl_hello(void) {
-    fl_response(true, "HELLO from original fl_hello(%p) function!", (void*)fl_hello);
-}
-
-static int cmd_hello(fl_context_t* ctx, const cmd_args_t* args) {
-    (void)ctx;
-    (void)args;
-    fl_hello();
-    return 0;
-}
+#endif /* FL_SLOTSTATS */
 
 /* ===========================
    FILE TRANSFER COMMANDS
@@ -823,29 +2013,32 @@ static int cmd_fwrite(fl_context_t* ctx, const cmd_args_t* args) {
         return 0;
     }
 
-    if (!args->data) {
+    if (!args->data && !args->bin) {
         fl_response(false, "Missing data");
         return 0;
     }
 
-    /* Decode base64 data */
-    int n = base64_to_bytes(args->data, ctx->buf, FL_BUF_SIZE);
+    /* Decode base64 (and --z) data */
+    const uint8_t* data;
+    int n = load_data(ctx, args, &data);
     if (n < 0) {
-        fl_response(false, "Invalid base64 data");
+        fl_response(false, "Invalid %s data", args->z ? "compressed" : "base64");
         return 0;
     }
 
     /* Verify CRC if provided */
-    if (args->crc >= 0) {
-        uint16_t calc = calc_crc16(ctx->buf, n);
-        if (calc != (uint16_t)args->crc) {
-            fl_response(false, "CRC mismatch: 0x%04X != 0x%04X", (unsigned)args->crc, (unsigned)calc);
+    if (args->has_crc) {
+        uint32_t calc = crc_update(ctx, args->crc32, crc_init(args->crc32), data, n);
+        if (calc != args->crc) {
+            int w = CRC_DIGITS(args->crc32);
+            fl_response(false, "CRC mismatch: 0x%0*lX != 0x%0*lX", w, (unsigned long)args->crc, w,
+                        (unsigned long)calc);
             return 0;
         }
     }
 
     /* Write to file */
-    ssize_t written = fl_file_write(&ctx->file_ctx, ctx->buf, n);
+    ssize_t written = fl_file_write(&ctx->file_ctx, data, n);
     if (written < 0) {
         fl_response(false, "Write failed");
         return 0;
@@ -877,18 +2070,22 @@ static int cmd_fread(fl_context_t* ctx, const cmd_args_t* args) {
         return 0;
     }
 
+    /* Calculate CRC (of the uncompressed data) */
+    uint32_t crc = crc_update(ctx, args->crc32, crc_init(args->crc32), ctx->buf, nread);
+    int z = pack_data(ctx, args, ctx->buf, (size_t)nread);
+
     /* Encode to base64 */
-    if (bytes_to_base64(ctx->buf, nread, ctx->b64_buf, FL_B64_BUF_SIZE) < 0) {
+    if (!encode_data(ctx, ctx->buf, z ? (size_t)z : (size_t)nread)) {
         fl_response(false, "Base64 encode failed");
         return 0;
     }
 
-    /* Calculate CRC */
-    uint16_t crc = calc_crc16(ctx->buf, nread);
-
     /* Output in parts to avoid buffer overflow */
-    fl_print("[FLOK] FREAD %d bytes crc=0x%04X data=", (int)nread, (unsigned)crc);
-    fl_print_raw(ctx->b64_buf);
+    fl_print("[FLOK] FREAD %d bytes crc=0x%0*lX ", (int)nread, CRC_DIGITS(args->crc32), (unsigned long)crc);
+    if (z)
+        fl_print("z=%d ", z);
+    fl_print_raw("data=");
+    print_data(ctx, ctx->buf, z ? (size_t)z : (size_t)nread);
     fl_print_raw("\n[FLEND]\n");
     return 0;
 }
@@ -930,7 +2127,7 @@ static int cmd_fcrc(fl_context_t* ctx, const cmd_args_t* args) {
     }
 
     /* Calculate CRC of entire file (or specified size) */
-    uint16_t crc = 0xFFFF;
+    uint32_t crc = crc_init(args->crc32);
     off_t total_read = 0;
     off_t remaining = size > 0 ? size : LLONG_MAX;
 
@@ -949,8 +2146,8 @@ static int cmd_fcrc(fl_context_t* ctx, const cmd_args_t* args) {
             break; /* EOF */
         }
 
-        /* Update CRC incrementally (same algorithm as calc_crc16) */
-        crc = calc_crc16_base(crc, ctx->buf, nread);
+        /* Update CRC incrementally */
+        crc = crc_update(ctx, args->crc32, crc, ctx->buf, nread);
         total_read += nread;
         remaining -= nread;
     }
@@ -958,7 +2155,7 @@ static int cmd_fcrc(fl_context_t* ctx, const cmd_args_t* args) {
     /* Restore original position */
     fl_file_seek(&ctx->file_ctx, saved_pos, FL_SEEK_SET);
 
-    fl_response(true, "FCRC size=%ld crc=0x%04X", (long)total_read, (unsigned)crc);
+    fl_response(true, "FCRC size=%ld crc=0x%0*lX", (long)total_read, CRC_DIGITS(args->crc32), (unsigned long)crc);
     return 0;
 }
 
@@ -1108,6 +2305,100 @@ static int cmd_frename(fl_context_t* ctx, const cmd_args_t* args) {
     return 0;
 }
 
+#if FL_DUMP_BLOCK_SIZE * 2 > FL_BUF_SIZE
+#error "FL_DUMP_BLOCK_SIZE: two blocks must fit in FL_BUF_SIZE"
+#endif
+
+/**
+ * @brief  Append one --z dump record for a block: raw_len(2B LE) + stored_len(2B LE) + data
+ * @note   The block is LZ-compressed into the second half of buf, stored as is
+ *         (stored_len == raw_len) if it does not shrink
+ * @return Record length
+ */
+static size_t dump_record(fl_context_t* ctx, const uint8_t* raw, size_t n, uint8_t* out) {
+    uint8_t* z = ctx->buf + FL_DUMP_BLOCK_SIZE;
+    int zn = fl_lz_compress(raw, n, z, n - 1);
+    size_t stored = zn > 0 ? (size_t)zn : n;
+    out[0] = (uint8_t)(n & 0xFF);
+    out[1] = (uint8_t)(n >> 8);
+    out[2] = (uint8_t)(stored & 0xFF);
+    out[3] = (uint8_t)(stored >> 8);
+    memcpy(out + 4, zn > 0 ? z : raw, stored);
+    return 4 + stored;
+}
+
+/**
+ * @brief  Write a memory range to a file on the device
+ * @note   Uses its own file handle, so an open fopen/fread transfer is left alone.
+ *         Blocks are copied to buf before the CRC, so a live range is saved
+ *         consistently. With --z the records are staged in b64_buf and the file is
+ *         still written in whole FL_DUMP_BLOCK_SIZE blocks (except the last).
+ *         The CRC-32 covers the raw range, for checking the fetched file.
+ */
+static int cmd_dump(fl_context_t* ctx, const cmd_args_t* args) {
+    if (!ctx->file_ctx.fs) {
+        fl_response(false, "File context not initialized");
+        return 0;
+    }
+
+    if (!args->path) {
+        fl_response(false, "Missing path");
+        return 0;
+    }
+
+    if (!check_scan_range(args, args->addr))
+        return 0;
+
+    fl_file_ctx_t file = {.fs = ctx->file_ctx.fs};
+    if (fl_file_open(&file, args->path, "w") != 0) {
+        fl_response(false, "Failed to open: %s", args->path);
+        return 0;
+    }
+
+    const uint8_t* src = (const uint8_t*)args->addr;
+    uint8_t* stage = (uint8_t*)ctx->b64_buf;
+    size_t staged = 0;
+    size_t block = args->z ? FL_DUMP_BLOCK_SIZE : FL_BUF_SIZE / FL_DUMP_BLOCK_SIZE * FL_DUMP_BLOCK_SIZE;
+    uint32_t crc = 0;
+    long size = 0;
+    bool ok = true;
+
+    for (int off = 0; ok && off < args->len;) {
+        size_t n = (size_t)(args->len - off) < block ? (size_t)(args->len - off) : block;
+        if (off > 0 && ctx->yield_cb)
+            ctx->yield_cb();
+        memcpy(ctx->buf, src + off, n);
+        crc = crc_update(ctx, true, crc, ctx->buf, n);
+        off += (int)n;
+
+        if (!args->z) {
+            ok = fl_file_write(&file, ctx->buf, n) == (ssize_t)n;
+            size += (long)n;
+            continue;
+        }
+
+        staged += dump_record(ctx, ctx->buf, n, stage + staged);
+        while (ok && (staged >= FL_DUMP_BLOCK_SIZE || (off == args->len && staged > 0))) {
+            size_t w = staged < FL_DUMP_BLOCK_SIZE ? staged : FL_DUMP_BLOCK_SIZE;
+            ok = fl_file_write(&file, stage, w) == (ssize_t)w;
+            memmove(stage, stage + w, staged - w);
+            staged -= w;
+            size += (long)w;
+        }
+    }
+
+    if (fl_file_close(&file) != 0)
+        ok = false;
+    if (!ok) {
+        fl_response(false, "Write failed: %s", args->path);
+        return 0;
+    }
+
+    fl_response(true, "DUMP 0x%08lX len=%d crc=0x%08lX size=%ld%s path=%s", (unsigned long)args->addr, args->len,
+                (unsigned long)crc, size, args->z ? " z" : "", args->path);
+    return 0;
+}
+
 #endif /* FL_USE_FILE */
 
 /* ===========================
@@ -1119,80 +2410,286 @@ static int cmd_frename(fl_context_t* ctx, const cmd_args_t* args) {
  */
 typedef struct {
     const char* name;
+    uint8_t op; /* Binary frame opcode (FL_OP_*) */
     cmd_handler_t handler;
 } cmd_entry_t;
 
+/* Sorted by name: looked up with a binary search */
 /* clang-format off */
 static const cmd_entry_t s_cmd_table[] = {
-    /* Core commands */
-    { "ping",     cmd_ping     },
-    { "echo",     cmd_echo     },
-    { "echoback", cmd_echoback },
-    { "info",     cmd_info     },
-    { "alloc",    cmd_alloc    },
-    { "upload",   cmd_upload   },
-    { "read",     cmd_read     },
-    { "write",    cmd_write    },
-    { "patch",    cmd_patch    },
-    { "tpatch",   cmd_tpatch   },
-    { "dpatch",   cmd_dpatch   },
-    { "unpatch",  cmd_unpatch  },
-    { "enable",   cmd_enable   },
-    { "hello",    cmd_hello    },
+    { "abort",     FL_OP_ABORT,     cmd_abort     },
+    { "alloc",     FL_OP_ALLOC,     cmd_alloc     },
+    { "batch",     FL_OP_BATCH,     cmd_batch     },
+    { "commit",    FL_OP_COMMIT,    cmd_commit    },
+    { "dpatch",    FL_OP_DPATCH,    cmd_dpatch    },
+#if FL_USE_FILE
+    { "dump",      FL_OP_DUMP,      cmd_dump      },
+#endif
+    { "echo",      FL_OP_ECHO,      cmd_echo      },
+    { "echoback",  FL_OP_ECHOBACK,  cmd_echoback  },
+    { "enable",    FL_OP_ENABLE,    cmd_enable    },
 #if FL_USE_FILE
     /* File transfer commands */
-    { "fopen",    cmd_fopen    },
-    { "fwrite",   cmd_fwrite   },
-    { "fread",    cmd_fread    },
-    { "fclose",   cmd_fclose   },
-    { "fcrc",     cmd_fcrc     },
-    { "fseek",    cmd_fseek    },
-    { "fstat",    cmd_fstat    },
-    { "flist",    cmd_flist    },
-    { "fremove",  cmd_fremove  },
-    { "fmkdir",   cmd_fmkdir   },
-    { "frename",  cmd_frename  },
+    { "fclose",    FL_OP_FCLOSE,    cmd_fclose    },
+    { "fcrc",      FL_OP_FCRC,      cmd_fcrc      },
+    { "flist",     FL_OP_FLIST,     cmd_flist     },
+    { "fmkdir",    FL_OP_FMKDIR,    cmd_fmkdir    },
+    { "fopen",     FL_OP_FOPEN,     cmd_fopen     },
+    { "fread",     FL_OP_FREAD,     cmd_fread     },
+    { "fremove",   FL_OP_FREMOVE,   cmd_fremove   },
+    { "frename",   FL_OP_FRENAME,   cmd_frename   },
+    { "fseek",     FL_OP_FSEEK,     cmd_fseek     },
+    { "fstat",     FL_OP_FSTAT,     cmd_fstat     },
+    { "fwrite",    FL_OP_FWRITE,    cmd_fwrite    },
+#endif
+    { "hash",      FL_OP_HASH,      cmd_hash      },
+    { "hello",     FL_OP_HELLO,     cmd_hello     },
+    { "info",      FL_OP_INFO,      cmd_info      },
+    { "ipatch",    FL_OP_IPATCH,    cmd_ipatch    },
+    { "memcmp",    FL_OP_MEMCMP,    cmd_memcmp    },
+    { "memcpy",    FL_OP_MEMCPY,    cmd_memcpy    },
+    { "memcrc",    FL_OP_MEMCRC,    cmd_memcrc    },
+    { "memfind",   FL_OP_MEMFIND,   cmd_memfind   },
+    { "memset",    FL_OP_MEMSET,    cmd_memset    },
+    { "patch",     FL_OP_PATCH,     cmd_patch     },
+    { "ping",      FL_OP_PING,      cmd_ping      },
+#if FL_USE_PROF
+    { "prof",      FL_OP_PROF,      cmd_prof      },
+#endif
+    { "read",      FL_OP_READ,      cmd_read      },
+    { "readv",     FL_OP_READV,     cmd_readv     },
+    { "retarget",  FL_OP_RETARGET,  cmd_retarget  },
+#if FL_USE_SAMPLE
+    { "sample",    FL_OP_SAMPLE,    cmd_sample    },
+#endif
+#if FL_SLOTSTATS
+    { "slotstats", FL_OP_SLOTSTATS, cmd_slotstats },
 #endif
+    { "tpatch",    FL_OP_TPATCH,    cmd_tpatch    },
+    { "unpatch",   FL_OP_UNPATCH,   cmd_unpatch   },
+    { "upload",    FL_OP_UPLOAD,    cmd_upload    },
+    { "write",     FL_OP_WRITE,     cmd_write     },
 };
 /* clang-format on */
 
 #define CMD_TABLE_SIZE (sizeof(s_cmd_table) / sizeof(s_cmd_table[0]))
 
+/* ===========================
+   ARGUMENT TABLES
+   =========================== */
+
+typedef enum {
+    ARG_INT,
+    ARG_PTR,
+    ARG_STR,
+    ARG_BOOL,
+    ARG_CRC,  /* uint32_t, also sets has_crc */
+    ARG_INSN, /* uint32_t, also sets has_insn */
+    ARG_HELP, /* Text only: print the option list */
+} arg_type_t;
+
+/**
+ * @brief Text option -> cmd_args_t field mapping
+ */
+typedef struct {
+    const char* name; /* Long name, without "--" */
+    char short_name;  /* 0 = none */
+    uint8_t type;
+    uint16_t offset;
+    const char* help;
+} cmd_opt_t;
+
+/* Sorted by name: looked up with a binary search */
+/* clang-format off */
+static const cmd_opt_t s_cmd_opts[] = {
+    { "addr",    'a', ARG_PTR,  offsetof(cmd_args_t, addr),    "Address/offset (hex)"                 },
+    { "all",     0,   ARG_BOOL, offsetof(cmd_args_t, all),     "Clear all"                            },
+    { "cmd",     'c', ARG_STR,  offsetof(cmd_args_t, cmd),     "Command"                              },
+    { "comp",    0,   ARG_INT,  offsetof(cmd_args_t, comp),    "Comparator ID"                        },
+    { "crc",     'r', ARG_CRC,  offsetof(cmd_args_t, crc),     "CRC-16, or CRC-32 with --crc32 (hex)" },
+    { "crc32",   0,   ARG_BOOL, offsetof(cmd_args_t, crc32),   "Use CRC-32 for request/response CRCs" },
+    { "data",    'd', ARG_STR,  offsetof(cmd_args_t, data),    "Hex data"                             },
+    { "enable",  0,   ARG_INT,  offsetof(cmd_args_t, enable),  "Enable(1) or disable(0) patch"        },
+    { "force",   0,   ARG_BOOL, offsetof(cmd_args_t, force),   "Skip address range check"             },
+    { "help",    'h', ARG_HELP, 0,                             "Show this help message"               },
+    { "insn",    0,   ARG_INSN, offsetof(cmd_args_t, insn),    "ipatch instruction (hex)"             },
+    { "len",     'l', ARG_INT,  offsetof(cmd_args_t, len),     "Read length"                          },
+    { "mode",    'm', ARG_STR,  offsetof(cmd_args_t, mode),    "File mode (r/w/a) or command mode"    },
+    { "newpath", 0,   ARG_STR,  offsetof(cmd_args_t, newpath), "New file path"                        },
+    { "orig",    0,   ARG_PTR,  offsetof(cmd_args_t, orig),    "Original addr"                        },
+    { "path",    0,   ARG_STR,  offsetof(cmd_args_t, path),    "File path"                            },
+    { "size",    's', ARG_INT,  offsetof(cmd_args_t, size),    "Alloc size / hash block size"         },
+    { "stage",   0,   ARG_BOOL, offsetof(cmd_args_t, stage),   "Stage patch until commit"             },
+    { "stream",  0,   ARG_BOOL, offsetof(cmd_args_t, stream),  "Stream read of any length"            },
+    { "target",  0,   ARG_PTR,  offsetof(cmd_args_t, target),  "Target addr"                          },
+    { "value",   0,   ARG_INT,  offsetof(cmd_args_t, value),   "Fill byte, sample period, prof rate"  },
+    { "z",       0,   ARG_BOOL, offsetof(cmd_args_t, z),       "LZ-compressed --data / response data" },
+};
+/* clang-format on */
+
+#define CMD_OPTS_SIZE (sizeof(s_cmd_opts) / sizeof(s_cmd_opts[0]))
+
+/**
+ * @brief  Binary search a name-sorted table whose entries start with a name
+ * @param  name   Key, not necessarily NUL-terminated
+ * @param  len    Key length
+ * @param  stride sizeof(entry)
+ * @return Matching entry, or NULL
+ */
+static const void* table_lookup(const void* table, size_t count, size_t stride, const char* name, size_t len) {
+    size_t lo = 0;
+    size_t hi = count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const void* entry = (const uint8_t*)table + mid * stride;
+        const char* key = *(const char* const*)entry;
+        int c = strncmp(name, key, len);
+        if (c == 0 && key[len] != '\0')
+            c = -1; /* name is a strict prefix of key */
+        if (c == 0)
+            return entry;
+        if (c < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return NULL;
+}
+
+/**
+ * @brief  Store a decoded value into the field described by type/offset
+ */
+static void set_arg(cmd_args_t* args, uint8_t type, uint16_t offset, uint64_t u64, const char* str) {
+    void* field = (uint8_t*)args + offset;
+    switch (type) {
+        case ARG_INT:
+            *(int*)field = (int)(uint32_t)u64;
+            break;
+        case ARG_PTR:
+            *(uintptr_t*)field = (uintptr_t)u64;
+            break;
+        case ARG_CRC:
+            *(uint32_t*)field = (uint32_t)u64;
+            args->has_crc = 1;
+            break;
+        case ARG_INSN:
+            *(uint32_t*)field = (uint32_t)u64;
+            args->has_insn = 1;
+            break;
+        case ARG_STR:
+            *(const char**)field = str;
+            break;
+        case ARG_BOOL:
+            *(int*)field = 1;
+            break;
+        default:
+            break;
+    }
+}
+
+static void print_usage(void) {
+    fl_println("Usage: fl --cmd <command> [options]");
+    for (size_t i = 0; i < CMD_OPTS_SIZE; i++) {
+        const cmd_opt_t* opt = &s_cmd_opts[i];
+        if (opt->short_name) {
+            fl_println("  -%c, --%-8s %s", opt->short_name, opt->name, opt->help);
+        } else {
+            fl_println("      --%-8s %s", opt->name, opt->help);
+        }
+    }
+}
+
+/**
+ * @brief  Parse command line options into args
+ * @note   Single pass over argv (argv[0] is the program name). Accepts
+ *         "--name value", "--name=value", "-x value" and "-xvalue".
+ * @return 0 on success, -1 on error (response already sent)
+ */
+static int parse_cmd_args(int argc, const char** argv, cmd_args_t* args) {
+    cmd_args_init(args);
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* val = NULL;
+        const cmd_opt_t* opt = NULL;
+
+        if (arg[0] == '-' && arg[1] == '-') {
+            const char* name = arg + 2;
+            const char* eq = strchr(name, '=');
+            size_t len = eq ? (size_t)(eq - name) : strlen(name);
+            if (eq)
+                val = eq + 1;
+            opt = table_lookup(s_cmd_opts, CMD_OPTS_SIZE, sizeof(s_cmd_opts[0]), name, len);
+        } else if (arg[0] == '-' && arg[1] != '\0') {
+            for (size_t k = 0; k < CMD_OPTS_SIZE; k++) {
+                if (s_cmd_opts[k].short_name == arg[1]) {
+                    opt = &s_cmd_opts[k];
+                    break;
+                }
+            }
+            if (arg[2] != '\0')
+                val = arg + 2;
+        }
+
+        if (!opt) {
+            fl_response(false, "Invalid argument: %s", arg);
+            return -1;
+        }
+
+        if (opt->type == ARG_BOOL || opt->type == ARG_HELP) {
+            if (val) {
+                fl_response(false, "Invalid argument: %s", arg);
+                return -1;
+            }
+            if (opt->type == ARG_HELP)
+                print_usage();
+            else
+                set_arg(args, opt->type, opt->offset, 1, NULL);
+            continue;
+        }
+
+        if (!val) {
+            if (i + 1 >= argc) {
+                fl_response(false, "Missing value for %s", arg);
+                return -1;
+            }
+            val = argv[++i];
+        }
+
+        uint64_t u64 = 0;
+        if (opt->type != ARG_STR) {
+            char* end;
+            /* Unsigned parse also accepts "-1" (wraps, truncated back to int) */
+            u64 = (opt->type == ARG_INT) ? (uint64_t)strtol(val, &end, 0) : (uint64_t)strtoul(val, &end, 0);
+            if (end == val || *end != '\0') {
+                fl_response(false, "Invalid --%s: %s", opt->name, val);
+                return -1;
+            }
+        }
+        set_arg(args, opt->type, opt->offset, u64, val);
+    }
+    return 0;
+}
+
+/**
+ * @brief  Run a command handler
+ * @note   With a TX ring, the previous response may still reference buf/b64_buf:
+ *         wait until it is sent before the handler reuses them
+ */
+static int run_cmd(fl_context_t* ctx, const cmd_entry_t* entry, const cmd_args_t* args) {
+    fl_log_tx_wait(ctx, sizeof(*ctx));
+    if (ctx->grace_free)
+        code_reclaim(ctx);
+    return entry->handler(ctx, args);
+}
+
 int fl_exec_cmd(fl_context_t* ctx, int argc, const char** argv) {
     if (argc == 0)
         return -1;
 
-    cmd_args_t args = {0};
-    args.crc = -1;
-    args.len = 64;
-    args.enable = -1;
-
-    struct argparse_option opts[] = {
-        OPT_HELP(),
-        OPT_STRING('c', "cmd", &args.cmd, "Command", NULL, 0, 0),
-        OPT_INTEGER('s', "size", &args.size, "Alloc size", NULL, 0, 0),
-        OPT_POINTER('a', "addr", &args.addr, "Address/offset (hex)", NULL, 0, 0),
-        OPT_STRING('d', "data", &args.data, "Hex data", NULL, 0, 0),
-        OPT_INTEGER('r', "crc", &args.crc, "CRC-16 (hex)", NULL, 0, 0),
-        OPT_INTEGER('l', "len", &args.len, "Read length", NULL, 0, 0),
-        OPT_INTEGER(0, "comp", &args.comp, "Comparator ID", NULL, 0, 0),
-        OPT_POINTER(0, "orig", &args.orig, "Original addr", NULL, 0, 0),
-        OPT_POINTER(0, "target", &args.target, "Target addr", NULL, 0, 0),
-        OPT_BOOLEAN(0, "all", &args.all, "Clear all", NULL, 0, 0),
-        OPT_INTEGER(0, "enable", &args.enable, "Enable(1) or disable(0) patch", NULL, 0, 0),
-        OPT_BOOLEAN(0, "force", &args.force, "Skip address range check", NULL, 0, 0),
-        OPT_STRING(0, "path", &args.path, "File path", NULL, 0, 0),
-        OPT_STRING(0, "newpath", &args.newpath, "New file path", NULL, 0, 0),
-        OPT_STRING('m', "mode", &args.mode, "File mode (r/w/a)", NULL, 0, 0),
-        OPT_END(),
-    };
-
-    struct argparse ap;
-    fl_argparse_init(&ap, opts, NULL, 0);
-    if (fl_argparse_parse(&ap, argc, argv) > 0) {
-        fl_response(false, "Invalid arguments");
+    cmd_args_t args;
+    if (parse_cmd_args(argc, argv, &args) < 0)
         return -1;
-    }
 
     if (!args.cmd) {
         fl_println("Available commands:");
@@ -1203,13 +2700,273 @@ int fl_exec_cmd(fl_context_t* ctx, int argc, const char** argv) {
         return -1;
     }
 
-    /* Lookup command in dispatch table */
-    for (size_t i = 0; i < CMD_TABLE_SIZE; i++) {
-        if (strcmp(args.cmd, s_cmd_table[i].name) == 0) {
-            return s_cmd_table[i].handler(ctx, &args);
-        }
+    const cmd_entry_t* entry =
+        table_lookup(s_cmd_table, CMD_TABLE_SIZE, sizeof(s_cmd_table[0]), args.cmd, strlen(args.cmd));
+    if (entry) {
+        return run_cmd(ctx, entry, &args);
     }
 
     fl_response(false, "Unknown: %s", args.cmd);
     return -1;
 }
+
+/* ===========================
+   BINARY FRAME DISPATCH
+   =========================== */
+
+/**
+ * @brief Frame TLV tag -> cmd_args_t field mapping (FL_TAG_BIN handled separately)
+ */
+typedef struct {
+    uint8_t tag;
+    uint8_t type;
+    uint16_t offset;
+} frame_arg_t;
+
+/* clang-format off */
+static const frame_arg_t s_frame_args[] = {
+    { FL_TAG_SIZE,    ARG_INT,  offsetof(cmd_args_t, size)    },
+    { FL_TAG_ADDR,    ARG_PTR,  offsetof(cmd_args_t, addr)    },
+    { FL_TAG_DATA,    ARG_STR,  offsetof(cmd_args_t, data)    },
+    { FL_TAG_CRC,     ARG_CRC,  offsetof(cmd_args_t, crc)     },
+    { FL_TAG_LEN,     ARG_INT,  offsetof(cmd_args_t, len)     },
+    { FL_TAG_COMP,    ARG_INT,  offsetof(cmd_args_t, comp)    },
+    { FL_TAG_ORIG,    ARG_PTR,  offsetof(cmd_args_t, orig)    },
+    { FL_TAG_TARGET,  ARG_PTR,  offsetof(cmd_args_t, target)  },
+    { FL_TAG_ALL,     ARG_BOOL, offsetof(cmd_args_t, all)     },
+    { FL_TAG_ENABLE,  ARG_INT,  offsetof(cmd_args_t, enable)  },
+    { FL_TAG_FORCE,   ARG_BOOL, offsetof(cmd_args_t, force)   },
+    { FL_TAG_PATH,    ARG_STR,  offsetof(cmd_args_t, path)    },
+    { FL_TAG_NEWPATH, ARG_STR,  offsetof(cmd_args_t, newpath) },
+    { FL_TAG_MODE,    ARG_STR,  offsetof(cmd_args_t, mode)    },
+    { FL_TAG_CRC32,   ARG_BOOL, offsetof(cmd_args_t, crc32)   },
+    { FL_TAG_Z,       ARG_BOOL, offsetof(cmd_args_t, z)       },
+    { FL_TAG_STAGE,   ARG_BOOL, offsetof(cmd_args_t, stage)   },
+    { FL_TAG_VALUE,   ARG_INT,  offsetof(cmd_args_t, value)   },
+    { FL_TAG_STREAM,  ARG_BOOL, offsetof(cmd_args_t, stream)  },
+    { FL_TAG_INSN,    ARG_INSN, offsetof(cmd_args_t, insn)    },
+};
+/* clang-format on */
+
+static bool frame_set_arg(cmd_args_t* args, uint8_t tag, const uint8_t* val, size_t vlen) {
+    if (tag == FL_TAG_BIN) {
+        args->bin = val;
+        args->bin_len = (int)vlen;
+        return true;
+    }
+
+    for (size_t i = 0; i < sizeof(s_frame_args) / sizeof(s_frame_args[0]); i++) {
+        const frame_arg_t* fa = &s_frame_args[i];
+        if (fa->tag != tag)
+            continue;
+
+        uint64_t u64 = 0;
+        if (fa->type == ARG_INT || fa->type == ARG_PTR || fa->type == ARG_CRC || fa->type == ARG_INSN) {
+            /* 4-byte LE, pointers may also be 8-byte (64-bit hosts) */
+            if (vlen != 4 && !(vlen == 8 && fa->type == ARG_PTR))
+                return false;
+            for (size_t b = vlen; b > 0; b--) {
+                u64 = (u64 << 8) | val[b - 1];
+            }
+        } else if (fa->type == ARG_STR) {
+            /* Strings carry their NUL so they can be used in place */
+            if (vlen == 0 || val[vlen - 1] != '\0')
+                return false;
+        }
+
+        set_arg(args, fa->type, fa->offset, u64, (const char*)val);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief  Run an op with a TLV argument list (frame payload or batch record)
+ */
+static int exec_op(fl_context_t* ctx, uint8_t op, const uint8_t* payload, size_t len) {
+    const cmd_entry_t* entry = NULL;
+    for (size_t i = 0; i < CMD_TABLE_SIZE; i++) {
+        if (s_cmd_table[i].op == op) {
+            entry = &s_cmd_table[i];
+            break;
+        }
+    }
+
+    if (!entry) {
+        fl_response(false, "Unknown op 0x%02X", (unsigned)op);
+        return -1;
+    }
+
+    cmd_args_t args;
+    cmd_args_init(&args);
+    args.cmd = entry->name;
+
+    /* TLV: tag(1) + len(2, LE) + value */
+    size_t pos = 0;
+    while (pos < len) {
+        if (len - pos < 3) {
+            fl_response(false, "Truncated argument");
+            return -1;
+        }
+        uint8_t tag = payload[pos];
+        size_t vlen = (size_t)payload[pos + 1] | ((size_t)payload[pos + 2] << 8);
+        pos += 3;
+        if (vlen > len - pos) {
+            fl_response(false, "Truncated argument");
+            return -1;
+        }
+        if (!frame_set_arg(&args, tag, payload + pos, vlen)) {
+            fl_response(false, "Invalid argument tag 0x%02X", (unsigned)tag);
+            return -1;
+        }
+        pos += vlen;
+    }
+
+    return run_cmd(ctx, entry, &args);
+}
+
+int fl_exec_frame(fl_context_t* ctx, uint8_t op, uint8_t* payload, size_t len) {
+    return exec_op(ctx, op, payload, len);
+}
+
+/* ===========================
+   STREAMED DATA
+   =========================== */
+
+int fl_exec_data_begin(fl_context_t* ctx, int argc, const char** argv) {
+    fl_data_xfer_t* x = &ctx->xfer;
+    cmd_args_t args;
+
+    /* The header ends in "-d"/"--data", its value follows the line */
+    if (argc > 1 && (strcmp(argv[argc - 1], "-d") == 0 || strcmp(argv[argc - 1], "--data") == 0))
+        argc--;
+    if (parse_cmd_args(argc, argv, &args) < 0)
+        return -1;
+
+    bool upload = args.cmd && strcmp(args.cmd, "upload") == 0;
+    if (!upload && !(args.cmd && strcmp(args.cmd, "write") == 0)) {
+        fl_response(false, "Streamed data not supported: %s", args.cmd ? args.cmd : "(none)");
+        return -1;
+    }
+
+    /* Streamed data is decoded straight into place, chunked upload/write carry --z */
+    if (args.z) {
+        fl_response(false, "Streamed data does not support --z");
+        return -1;
+    }
+
+    if (args.len <= 0) {
+        fl_response(false, "Missing --len");
+        return -1;
+    }
+    size_t len = (size_t)args.len;
+
+    memset(x, 0, sizeof(*x));
+    if (upload) {
+        if (ctx->last_alloc == 0) {
+            fl_response(false, "No allocation off=0x%lX, call alloc first", (unsigned long)args.addr);
+            return -1;
+        }
+        if (args.addr > ctx->last_alloc_size || len > ctx->last_alloc_size - args.addr) {
+            fl_response(false, "Upload exceeds allocation: 0x%lX+%u > %u", (unsigned long)args.addr, (unsigned)len,
+                        (unsigned)ctx->last_alloc_size);
+            return -1;
+        }
+        x->dest = (uint8_t*)(ctx->last_alloc + args.addr);
+    } else {
+        if (!args.force && !fl_check_addr_range(args.addr, len)) {
+            fl_response(false, "Invalid address range 0x%08lX+%u (use --force to override)", (unsigned long)args.addr,
+                        (unsigned)len);
+            return -1;
+        }
+        x->dest = (uint8_t*)args.addr;
+    }
+
+    x->len = len;
+    x->addr = args.addr;
+    x->crc = args.crc;
+    x->has_crc = args.has_crc;
+    x->crc32 = args.crc32;
+    x->upload = upload;
+
+    /* CRC covers: addr/offset(4B) + len(4B) + data payload, same as the buffered path */
+    const uint32_t hdr[2] = {(uint32_t)args.addr, (uint32_t)len};
+    x->calc = crc_header(ctx, x->crc32, hdr, 2);
+    return 0;
+}
+
+void fl_exec_data_feed(fl_context_t* ctx, const char* b64, size_t len) {
+    fl_data_xfer_t* x = &ctx->xfer;
+
+    while (len > 0 && !x->error) {
+        /* Whole quads straight from the input: one decode and CRC call per run */
+        if (x->quad_len == 0 && len >= sizeof(x->quad) && !x->padded) {
+            size_t n = len & ~(sizeof(x->quad) - 1);
+            int out = fl_base64_decode(b64, n, x->dest + x->pos, x->len - x->pos);
+            if (out < 0) {
+                x->error = true;
+                break;
+            }
+            x->calc = crc_update(ctx, x->crc32, x->calc, x->dest + x->pos, (size_t)out);
+            x->pos += (size_t)out;
+            x->padded = (size_t)out < n / 4 * 3;
+            b64 += n;
+            len -= n;
+            continue;
+        }
+
+        len--;
+        x->quad[x->quad_len++] = (uint8_t)*b64++;
+        if (x->quad_len < sizeof(x->quad))
+            continue;
+        x->quad_len = 0;
+
+        uint8_t out[3];
+        int n = x->padded ? -1 : fl_base64_decode_quad(x->quad, out);
+        if (n < 0 || (size_t)n > x->len - x->pos) {
+            x->error = true;
+            break;
+        }
+
+        memcpy(x->dest + x->pos, out, n);
+        x->calc = crc_update(ctx, x->crc32, x->calc, out, n);
+        x->pos += n;
+        x->padded = n < 3;
+    }
+}
+
+int fl_exec_data_end(fl_context_t* ctx) {
+    fl_data_xfer_t* x = &ctx->xfer;
+
+    if (x->error || x->quad_len != 0) {
+        fl_response(false, "Invalid base64 data");
+        return -1;
+    }
+
+    if (x->pos != x->len) {
+        fl_response(false, "Length mismatch: %u != %u", (unsigned)x->pos, (unsigned)x->len);
+        return -1;
+    }
+
+    if (x->has_crc && x->calc != x->crc) {
+        int w = CRC_DIGITS(x->crc32);
+        if (x->upload) {
+            fl_response(false, "CRC mismatch off=0x%lX: 0x%0*lX != 0x%0*lX", (unsigned long)x->addr, w,
+                        (unsigned long)x->crc, w, (unsigned long)x->calc);
+        } else {
+            fl_response(false, "CRC mismatch: 0x%0*lX != 0x%0*lX", w, (unsigned long)x->crc, w,
+                        (unsigned long)x->calc);
+        }
+        return -1;
+    }
+
+    fl_flush_dcache(ctx, x->dest, x->len);
+
+    if (x->upload) {
+        fl_response(true, "Uploaded %d bytes off=0x%lX to 0x%lX", (int)x->len, (unsigned long)x->addr,
+                    (unsigned long)x->dest);
+    } else {
+        fl_response(true, "WRITE %d bytes to 0x%lX", (int)x->len, (unsigned long)x->addr);
+    }
+    return 0;
+}
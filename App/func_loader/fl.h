@@ -37,9 +37,19 @@ extern "C" {
 #include <stddef.h>
 #include <stdint.h>
 #include "fl_file.h"
+#include "fl_codec.h"
+#include "fl_sample.h"
+#include "fl_prof.h"
 
-/* Maximum slot count (FPB v1: 6, v2: 8) */
-#define FL_MAX_SLOTS 8
+/* Maximum slot count (FPB v1: 6, v2: 8, plus DWT comparators as DebugMonitor redirects) */
+#ifndef FL_MAX_SLOTS
+#define FL_MAX_SLOTS 12
+#endif
+
+/* Replaced patch allocations awaiting a grace period (see fl_quiescent) */
+#ifndef FL_RETIRE_MAX
+#define FL_RETIRE_MAX 8
+#endif
 
 /* Shared transfer buffer sizes */
 #ifndef FL_BUF_SIZE
@@ -49,11 +59,58 @@ extern "C" {
 /* Base64 output size: ceil(N/3)*4 + null terminator */
 #define FL_B64_BUF_SIZE ((FL_BUF_SIZE + 2) / 3 * 4 + 1)
 
+/* Default block size of the hash command */
+#ifndef FL_HASH_BLOCK_SIZE
+#define FL_HASH_BLOCK_SIZE 64
+#endif
+
+/* Bytes scanned by memory commands (memcrc, memset, ...) between yield_cb calls */
+#ifndef FL_MEM_SLICE_SIZE
+#define FL_MEM_SLICE_SIZE 4096
+#endif
+
+/* File write granularity of dump (SD/flash sector size), 2 blocks must fit in FL_BUF_SIZE */
+#ifndef FL_DUMP_BLOCK_SIZE
+#define FL_DUMP_BLOCK_SIZE 512
+#endif
+
+/* Bytes between SYNC markers of a streamed read (read --stream) */
+#ifndef FL_READ_SYNC_SIZE
+#define FL_READ_SYNC_SIZE 4096
+#endif
+
+/* Capability bits reported by ping (caps=0x...) */
+#define FL_CAP_FRAME (1UL << 0)      /* Binary frame transport (fl_frame.h) */
+#define FL_CAP_UPLOAD_ACK (1UL << 1) /* Upload responses carry off=, chunks may be pipelined */
+#define FL_CAP_STREAM_DATA (1UL << 2) /* upload/write with --len stream --data (fl_exec_data_*) */
+#define FL_CAP_CRC32 (1UL << 3)       /* --crc32 selects CRC-32 for request and response CRCs */
+#define FL_CAP_LZ (1UL << 4)          /* --z: LZ4-block data on upload/write/fwrite/read/fread */
+#define FL_CAP_HASH (1UL << 5)        /* hash: per-block CRCs over a range (delta upload) */
+#define FL_CAP_BATCH (1UL << 6)       /* batch: run several commands in one request */
+#define FL_CAP_STAGE (1UL << 7)       /* --stage on patch/tpatch/dpatch/ipatch, commit/abort */
+#define FL_CAP_MEMCRC (1UL << 8)      /* memcrc/memcmp: on-device range CRC-32 and compare */
+#define FL_CAP_MEMOPS (1UL << 9)      /* memset/memcpy/memfind: on-device fill, copy and search */
+#define FL_CAP_READV (1UL << 10)      /* readv: several (offset, len) ranges in one read response */
+#define FL_CAP_READ_STREAM (1UL << 11) /* read --stream: any length, base64 lines with SYNC markers */
+#define FL_CAP_DUMP (1UL << 12)        /* dump: memory range to a device file (set with a filesystem) */
+#define FL_CAP_SAMPLE (1UL << 13)      /* sample: periodic probe snapshots streamed as [FLSMP] lines */
+#define FL_CAP_PROF (1UL << 14)        /* prof: PC-sampling profiler (set with prof_timer_cb) */
+#define FL_CAP_SLOTSTATS (1UL << 15)   /* slotstats: trampoline call/cycle counters (FPB_TRAMPOLINE_STATS) */
+#define FL_CAP_RETARGET (1UL << 16)    /* retarget: move a tpatch/dpatch slot to new code (set with grace_free) */
+#define FL_CAP_IPATCH (1UL << 17)      /* ipatch: replace one Thumb instruction through the remap table */
+
 /* Callback types */
 typedef void (*fl_output_cb_t)(void* user, const char* str);
+typedef void (*fl_output_data_cb_t)(void* user, const uint8_t* data, size_t len);
 typedef void* (*fl_malloc_cb_t)(size_t size);
 typedef void (*fl_free_cb_t)(void* ptr);
 typedef void (*fl_flush_dcache_cb_t)(uintptr_t start, uintptr_t end);
+typedef uint32_t (*fl_crc32_cb_t)(uint32_t crc, const void* data, size_t len);
+typedef uint32_t (*fl_irq_save_cb_t)(void);
+typedef void (*fl_irq_restore_cb_t)(uint32_t state);
+typedef void (*fl_yield_cb_t)(void);
+typedef uint32_t (*fl_timestamp_cb_t)(void);
+typedef bool (*fl_prof_timer_cb_t)(uint32_t hz);
 
 /**
  * @brief Slot state for tracking injection info
@@ -61,11 +118,47 @@ typedef void (*fl_flush_dcache_cb_t)(uintptr_t start, uintptr_t end);
 typedef struct {
     bool active;          /* Slot is in use */
     uint32_t orig_addr;   /* Original function address */
-    uint32_t target_addr; /* Injected code address */
+    uint32_t target_addr; /* Injected code address (the instruction for FL_OP_IPATCH) */
     uint32_t code_size;   /* Injected code size */
     uintptr_t alloc_addr; /* Allocated memory address (for free on unpatch) */
+    uint8_t op;           /* FL_OP_PATCH/TPATCH/DPATCH/IPATCH that armed the slot */
 } fl_slot_state_t;
 
+/**
+ * @brief Patch staged with --stage, armed by commit
+ */
+typedef struct {
+    uint8_t op;           /* FL_OP_PATCH/TPATCH/DPATCH/IPATCH, 0 = nothing staged */
+    fl_slot_state_t slot; /* Slot state to install on commit */
+} fl_stage_t;
+
+/**
+ * @brief Patch code freed once a grace period has passed (see fl_quiescent)
+ */
+typedef struct {
+    uintptr_t addr; /* Allocation to free, 0 = unused */
+    uint32_t seq;   /* grace_seq when the code was retired */
+} fl_retired_t;
+
+/**
+ * @brief Streamed --data transfer state (see fl_exec_data_begin)
+ */
+typedef struct {
+    uint8_t* dest;    /* Destination start */
+    size_t len;       /* Expected payload length (--len) */
+    size_t pos;       /* Bytes decoded so far */
+    uintptr_t addr;   /* --addr as given (offset for upload) */
+    uint32_t crc;     /* Expected CRC (--crc) */
+    uint32_t calc;    /* Running CRC */
+    bool has_crc;     /* --crc given */
+    bool crc32;       /* CRC-32 instead of CRC-16 (--crc32) */
+    bool upload;      /* upload (into last_alloc) or write (absolute address) */
+    bool error;       /* Invalid base64 or overflow seen */
+    bool padded;      /* Padding seen, no more data allowed */
+    uint8_t quad_len; /* Pending base64 chars in quad */
+    uint8_t quad[4];
+} fl_data_xfer_t;
+
 /**
  * @brief Function loader context
  *
@@ -76,6 +169,12 @@ typedef struct fl_context_s {
     fl_output_cb_t output_cb;
     void* output_user;
 
+    /* Raw data output (optional, set by the transport while serving a binary frame) */
+    fl_output_data_cb_t output_data_cb;
+
+    /* Capability bits (FL_CAP_*) advertised by ping */
+    uint32_t caps;
+
     /* Memory callbacks (optional, for dynamic alloc) */
     fl_malloc_cb_t malloc_cb;
     fl_free_cb_t free_cb;
@@ -83,6 +182,26 @@ typedef struct fl_context_s {
     /* Cache flush callback (optional, for platforms with dcache) */
     fl_flush_dcache_cb_t flush_dcache_cb;
 
+    /* CRC-32 callback (optional, e.g. a hardware CRC unit), same contract as fl_crc32_update() */
+    fl_crc32_cb_t crc32_cb;
+
+    /* Interrupt mask callbacks (optional): commit arms all staged slots with interrupts masked */
+    fl_irq_save_cb_t irq_save_cb;
+    fl_irq_restore_cb_t irq_restore_cb;
+
+    /* Yield callback (optional): called between slices of long memory scans */
+    fl_yield_cb_t yield_cb;
+
+    /* Timestamp callback (optional): free-running 32-bit counter, e.g. DWT->CYCCNT */
+    fl_timestamp_cb_t timestamp_cb;
+    uint32_t timestamp_hz; /* timestamp_cb ticks per second, 0 = unknown */
+
+    /* Profiler timer callback (optional): runs an interrupt calling fl_prof_isr() at hz, 0 = stop */
+    fl_prof_timer_cb_t prof_timer_cb;
+
+    /* Grace-period reclamation (optional): set by ports that report quiescent states with fl_quiescent() */
+    bool grace_free;
+
     /* Internal state (managed by fl_init) */
     bool is_inited;         /* true after first fl_init() call */
     uintptr_t last_alloc;   /* Last dynamic allocation address */
@@ -91,6 +210,16 @@ typedef struct fl_context_s {
     /* Slot tracking */
     fl_slot_state_t slots[FL_MAX_SLOTS];
 
+    /* Shadow slot table filled by --stage, applied by commit */
+    fl_stage_t stage[FL_MAX_SLOTS];
+
+    /* Replaced code waiting for its grace period (grace_free) */
+    fl_retired_t retired[FL_RETIRE_MAX];
+    volatile uint32_t grace_seq; /* Quiescent states reported so far */
+
+    /* Streamed data transfer in progress */
+    fl_data_xfer_t xfer;
+
     /* Shared transfer buffers (used by upload/read/write/file commands) */
     uint8_t buf[FL_BUF_SIZE];
     char b64_buf[FL_B64_BUF_SIZE];
@@ -99,6 +228,16 @@ typedef struct fl_context_s {
     /* File transfer context (embedded, no dynamic allocation) */
     struct fl_file_ctx_s file_ctx;
 #endif
+
+#if FL_USE_SAMPLE
+    /* Variable sampler (sample command, fl_sample_poll) */
+    fl_sample_t sample;
+#endif
+
+#if FL_USE_PROF
+    /* PC-sampling profiler (prof command) */
+    fl_prof_t prof;
+#endif
 } fl_context_t;
 
 /**
@@ -116,12 +255,55 @@ void fl_init(fl_context_t* ctx);
  */
 bool fl_is_inited(fl_context_t* ctx);
 
+/**
+ * @brief Report a quiescent state: no task or interrupt is inside patch code
+ * @note  With grace_free, code replaced by unpatch, retarget or commit is not
+ *        freed at once: a task preempted inside it may still resume there.
+ *        It is freed by the first command after two more reports, so each
+ *        report may describe any moment since the previous one. Bare-metal
+ *        ports call this from the main loop; it is a single counter store and
+ *        may run in another thread than the commands.
+ */
+void fl_quiescent(fl_context_t* ctx);
+
 /**
  * @brief Execute command from argc/argv
  * @return 0 on success, -1 on error
  */
 int fl_exec_cmd(fl_context_t* ctx, int argc, const char** argv);
 
+/**
+ * @brief Execute a binary frame request (see fl_frame.h)
+ * @param op Command opcode (FL_OP_*)
+ * @param payload TLV argument list, string values are used in place
+ * @param len Payload length
+ * @return 0 on success, -1 on error
+ */
+int fl_exec_frame(fl_context_t* ctx, uint8_t op, uint8_t* payload, size_t len);
+
+/**
+ * @brief Start a streamed upload/write whose base64 --data follows the header
+ * @note  The header must carry --len (and --crc, if any) before --data.
+ *        Data is decoded straight into the destination by fl_exec_data_feed()
+ *        and verified by fl_exec_data_end(), so one command may carry any
+ *        amount of data regardless of the line buffer size.
+ *        A streamed write lands before its CRC is checked.
+ * @param argc/argv Command header, ending in "-d"/"--data" or without it
+ * @return 0 if the transfer started, -1 on error (response already sent)
+ */
+int fl_exec_data_begin(fl_context_t* ctx, int argc, const char** argv);
+
+/**
+ * @brief Feed base64 characters of a streamed transfer (any split is fine)
+ */
+void fl_exec_data_feed(fl_context_t* ctx, const char* b64, size_t len);
+
+/**
+ * @brief Finish a streamed transfer: check length and CRC, send the response
+ * @return 0 on success, -1 on error
+ */
+int fl_exec_data_end(fl_context_t* ctx);
+
 #ifdef __cplusplus
 }
 #endif
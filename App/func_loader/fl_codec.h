@@ -0,0 +1,106 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 VIFEX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file   fl_codec.h
+ * @brief  Base64 and CRC kernels used by the func_loader protocol
+ */
+
+#ifndef FL_CODEC_H
+#define FL_CODEC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * CRC-16 slicing-by-4: four bytes per table round (2 KB of tables).
+ * Set to 0 on parts where flash is tight to use the 512 B byte-wise table.
+ */
+#ifndef FL_CRC16_SLICE4
+#define FL_CRC16_SLICE4 1
+#endif
+
+/* CRC-32 slicing-by-4 (4 KB of tables), 0 = byte-wise 1 KB table */
+#ifndef FL_CRC32_SLICE4
+#define FL_CRC32_SLICE4 1
+#endif
+
+/* LZ compressor hash table: 2^bits 16-bit entries on the stack (8 = 512 B) */
+#ifndef FL_LZ_HASH_BITS
+#define FL_LZ_HASH_BITS 8
+#endif
+
+/**
+ * @brief  Update a CRC-16-CCITT (poly 0x1021, init 0xFFFF, no reflection)
+ * @note   Bit-exact with Tools/WebServer/utils/crc.py
+ */
+uint16_t fl_crc16_update(uint16_t crc, const void* data, size_t len);
+
+/**
+ * @brief  Update a CRC-32 (IEEE 802.3, reflected, poly 0xEDB88320)
+ * @param  crc Previous result, 0 to start
+ * @note   Same convention as zlib crc32(): fl_crc32_update(0, "123456789", 9) == 0xCBF43926
+ */
+uint32_t fl_crc32_update(uint32_t crc, const void* data, size_t len);
+
+/**
+ * @brief  Decode base64 text (length must be a multiple of 4)
+ * @return Decoded length, -1 on invalid input or if it exceeds max
+ */
+int fl_base64_decode(const char* b64, size_t len, uint8_t* out, size_t max);
+
+/**
+ * @brief  Decode one base64 quad
+ * @return Number of bytes written to out (1-3, fewer with padding), -1 if invalid
+ */
+int fl_base64_decode_quad(const uint8_t* q, uint8_t* out);
+
+/**
+ * @brief  Encode data as NUL-terminated base64
+ * @return Encoded length (without NUL), -1 if it does not fit in max
+ */
+int fl_base64_encode(const uint8_t* data, size_t len, char* out, size_t max);
+
+/**
+ * @brief  Compress data into an LZ4 block (no frame header)
+ * @note   Greedy single-probe matcher. Bit-exact with Tools/WebServer/utils/lz.py
+ * @param  len Input length, at most 65535
+ * @return Compressed length, -1 if it does not fit in max
+ */
+int fl_lz_compress(const uint8_t* in, size_t len, uint8_t* out, size_t max);
+
+/**
+ * @brief  Decompress an LZ4 block
+ * @return Decompressed length, -1 on malformed input or if it exceeds max
+ */
+int fl_lz_decompress(const uint8_t* in, size_t len, uint8_t* out, size_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FL_CODEC_H */
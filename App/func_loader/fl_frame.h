@@ -0,0 +1,124 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 VIFEX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file   fl_frame.h
+ * @brief  Binary frame transport definitions
+ *
+ * Frame layout (multi-byte fields little-endian):
+ *   [SOF 0xA5] [flags] [seq] [op] [len (2B)] [payload (len B)] [crc16 (2B)]
+ *
+ * The CRC-16-CCITT covers flags..payload. A frame is only recognized at the
+ * start of a line, so text commands and frames can be mixed on one link.
+ *
+ * Request payload is a list of TLV arguments: [tag] [len (2B)] [value].
+ * Integers are 4-byte little-endian (addresses may also be 8-byte), strings
+ * include the trailing NUL, booleans have an empty value.
+ *
+ * Responses reuse the request seq/op. Text output is carried verbatim in
+ * frames without FL_FRAME_F_DATA; raw payloads (read/fread/echoback data)
+ * are sent in FL_FRAME_F_DATA frames instead of base64. Every frame but the
+ * last one of a response has FL_FRAME_F_MORE set.
+ */
+
+#ifndef FL_FRAME_H
+#define FL_FRAME_H
+
+#define FL_FRAME_SOF 0xA5
+#define FL_FRAME_HDR_SIZE 6
+#define FL_FRAME_CRC_SIZE 2
+#define FL_FRAME_OVERHEAD (FL_FRAME_HDR_SIZE + FL_FRAME_CRC_SIZE)
+
+/* Frame flags */
+#define FL_FRAME_F_RESP 0x01 /* Device -> host */
+#define FL_FRAME_F_MORE 0x02 /* More frames of this response follow */
+#define FL_FRAME_F_DATA 0x04 /* Payload is raw data, not text */
+
+/* Argument tags */
+#define FL_TAG_SIZE 0x01
+#define FL_TAG_ADDR 0x02
+#define FL_TAG_DATA 0x03 /* String --data (e.g. echo hex) */
+#define FL_TAG_CRC 0x04
+#define FL_TAG_LEN 0x05
+#define FL_TAG_COMP 0x06
+#define FL_TAG_ORIG 0x07
+#define FL_TAG_TARGET 0x08
+#define FL_TAG_ALL 0x09
+#define FL_TAG_ENABLE 0x0A
+#define FL_TAG_FORCE 0x0B
+#define FL_TAG_PATH 0x0C
+#define FL_TAG_NEWPATH 0x0D
+#define FL_TAG_MODE 0x0E
+#define FL_TAG_BIN 0x0F /* Raw --data bytes (upload/write/fwrite) */
+#define FL_TAG_CRC32 0x10 /* --crc32 flag */
+#define FL_TAG_Z 0x11     /* --z flag */
+#define FL_TAG_STAGE 0x12 /* --stage flag */
+#define FL_TAG_VALUE 0x13 /* --value fill byte */
+#define FL_TAG_STREAM 0x14 /* --stream flag */
+#define FL_TAG_INSN 0x15   /* --insn instruction (ipatch) */
+
+/* Opcodes (stable, independent of dispatch table order) */
+#define FL_OP_PING 0x01
+#define FL_OP_ECHO 0x02
+#define FL_OP_ECHOBACK 0x03
+#define FL_OP_INFO 0x04
+#define FL_OP_ALLOC 0x05
+#define FL_OP_UPLOAD 0x06
+#define FL_OP_READ 0x07
+#define FL_OP_WRITE 0x08
+#define FL_OP_PATCH 0x09
+#define FL_OP_TPATCH 0x0A
+#define FL_OP_DPATCH 0x0B
+#define FL_OP_UNPATCH 0x0C
+#define FL_OP_ENABLE 0x0D
+#define FL_OP_HELLO 0x0E
+#define FL_OP_HASH 0x0F
+#define FL_OP_BATCH 0x10
+#define FL_OP_COMMIT 0x11
+#define FL_OP_ABORT 0x12
+#define FL_OP_MEMCRC 0x13
+#define FL_OP_MEMCMP 0x14
+#define FL_OP_MEMSET 0x15
+#define FL_OP_MEMCPY 0x16
+#define FL_OP_MEMFIND 0x17
+#define FL_OP_READV 0x18
+#define FL_OP_SAMPLE 0x19
+#define FL_OP_PROF 0x1A
+#define FL_OP_SLOTSTATS 0x1B
+#define FL_OP_RETARGET 0x1C
+#define FL_OP_IPATCH 0x1D
+
+#define FL_OP_FOPEN 0x20
+#define FL_OP_FWRITE 0x21
+#define FL_OP_FREAD 0x22
+#define FL_OP_FCLOSE 0x23
+#define FL_OP_FCRC 0x24
+#define FL_OP_FSEEK 0x25
+#define FL_OP_FSTAT 0x26
+#define FL_OP_FLIST 0x27
+#define FL_OP_FREMOVE 0x28
+#define FL_OP_FMKDIR 0x29
+#define FL_OP_FRENAME 0x2A
+#define FL_OP_DUMP 0x2B
+
+#endif /* FL_FRAME_H */
@@ -29,14 +29,45 @@
 #include "fl_log.h"
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
 #define PRINT_BUF_SIZE 256
 
+/* Queued TX segments (copied runs in the ring, or caller buffers by reference) */
+#ifndef FL_LOG_TX_SEGS
+#define FL_LOG_TX_SEGS 8
+#endif
+
 /* Global output callback */
 static fl_output_cb_t g_output_cb = NULL;
 static void* g_output_user = NULL;
 static char log_buf[PRINT_BUF_SIZE];
 
+/* Batch mode: sub-command responses share one [FLEND] */
+static bool s_batch;
+static bool s_batch_err;
+
+typedef struct {
+    const uint8_t* data;
+    size_t len;
+    bool ring; /* Points into the ring (else a caller buffer) */
+} tx_seg_t;
+
+/* TX ring state */
+static struct {
+    uint8_t* buf;
+    size_t size;
+    size_t head;       /* Ring write offset */
+    size_t tail;       /* Ring release offset */
+    size_t ring_segs;  /* Queued segments in the ring, 0 = ring empty */
+    size_t pending;    /* Queued bytes */
+    tx_seg_t segs[FL_LOG_TX_SEGS];
+    size_t seg_first;
+    size_t seg_count;
+    fl_log_tx_kick_cb_t kick_cb;
+    void* kick_user;
+} s_tx;
+
 void fl_log_init(fl_output_cb_t output_cb, void* output_user) {
     g_output_cb = output_cb;
     g_output_user = output_user;
@@ -50,7 +81,21 @@ void fl_response(bool ok, const char* fmt, ...) {
     vsnprintf(log_buf, sizeof(log_buf), fmt, args);
     va_end(args);
     fl_print_raw(log_buf);
-    fl_print_raw("\n[FLEND]\n");
+    if (s_batch) {
+        s_batch_err |= !ok;
+        fl_print_raw("\n");
+    } else {
+        fl_print_raw("\n[FLEND]\n");
+    }
+}
+
+void fl_log_batch(bool on) {
+    s_batch = on;
+    s_batch_err = false;
+}
+
+bool fl_log_batch_error(void) {
+    return s_batch_err;
 }
 
 void fl_print(const char* fmt, ...) {
@@ -77,3 +122,167 @@ void fl_print_raw(const char* str) {
         g_output_cb(g_output_user, str);
     }
 }
+
+void fl_print_ref(const char* str) {
+    if (g_output_cb == fl_log_tx_output) {
+        fl_log_tx_write_ref(str, strlen(str));
+    } else {
+        fl_print_raw(str);
+    }
+}
+
+/* ===========================
+   TX RING
+   =========================== */
+
+void fl_log_tx_init(uint8_t* ring, size_t size, fl_log_tx_kick_cb_t kick_cb, void* user) {
+    memset(&s_tx, 0, sizeof(s_tx));
+    if (ring && size > 0) {
+        s_tx.buf = ring;
+        s_tx.size = size;
+        s_tx.kick_cb = kick_cb;
+        s_tx.kick_user = user;
+    }
+}
+
+bool fl_log_tx_enabled(void) {
+    return s_tx.buf != NULL;
+}
+
+void fl_log_tx_output(void* user, const char* str) {
+    (void)user;
+    fl_log_tx_write(str, strlen(str));
+}
+
+void fl_log_tx_poll(void) {
+    if (s_tx.kick_cb && s_tx.seg_count > 0) {
+        s_tx.kick_cb(s_tx.kick_user);
+    }
+}
+
+static tx_seg_t* tx_seg_last(void) {
+    return &s_tx.segs[(s_tx.seg_first + s_tx.seg_count - 1) % FL_LOG_TX_SEGS];
+}
+
+/* Wait for a free segment slot */
+static tx_seg_t* tx_seg_push(void) {
+    while (s_tx.seg_count == FL_LOG_TX_SEGS) {
+        fl_log_tx_poll();
+    }
+    s_tx.seg_count++;
+    return tx_seg_last();
+}
+
+/* Contiguous free ring bytes at head */
+static size_t tx_ring_room(void) {
+    if (s_tx.ring_segs == 0) {
+        s_tx.head = 0;
+        s_tx.tail = 0;
+    }
+    if (s_tx.head == s_tx.size) {
+        s_tx.head = 0;
+    }
+    if (s_tx.head < s_tx.tail) {
+        return s_tx.tail - s_tx.head;
+    }
+    if (s_tx.head == s_tx.tail && s_tx.ring_segs > 0) {
+        return 0;
+    }
+    return s_tx.size - s_tx.head;
+}
+
+void fl_log_tx_write(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    while (len > 0) {
+        size_t n = tx_ring_room();
+        if (n == 0) {
+            fl_log_tx_poll();
+            continue;
+        }
+        if (n > len)
+            n = len;
+
+        uint8_t* dst = s_tx.buf + s_tx.head;
+        memcpy(dst, p, n);
+
+        /* Extend the last segment if it ends right here, else start one */
+        tx_seg_t* seg = s_tx.seg_count > 0 ? tx_seg_last() : NULL;
+        if (seg && seg->ring && seg->data + seg->len == dst) {
+            seg->len += n;
+        } else {
+            seg = tx_seg_push();
+            seg->data = dst;
+            seg->len = n;
+            seg->ring = true;
+            s_tx.ring_segs++;
+        }
+
+        s_tx.head += n;
+        s_tx.pending += n;
+        p += n;
+        len -= n;
+    }
+}
+
+void fl_log_tx_write_ref(const void* data, size_t len) {
+    if (len == 0)
+        return;
+    tx_seg_t* seg = tx_seg_push();
+    seg->data = (const uint8_t*)data;
+    seg->len = len;
+    seg->ring = false;
+    s_tx.pending += len;
+}
+
+void fl_log_tx_wait(const void* buf, size_t len) {
+    const uint8_t* start = (const uint8_t*)buf;
+    const uint8_t* end = start + len;
+    for (size_t i = 0; i < s_tx.seg_count;) {
+        const tx_seg_t* seg = &s_tx.segs[(s_tx.seg_first + i) % FL_LOG_TX_SEGS];
+        if (!seg->ring && seg->data < end && seg->data + seg->len > start) {
+            /* Drain until this segment is gone, then rescan */
+            fl_log_tx_poll();
+            i = 0;
+            continue;
+        }
+        i++;
+    }
+}
+
+size_t fl_log_tx_pending(void) {
+    return s_tx.pending;
+}
+
+const uint8_t* fl_log_tx_peek(size_t* len) {
+    if (s_tx.seg_count == 0) {
+        *len = 0;
+        return NULL;
+    }
+    const tx_seg_t* seg = &s_tx.segs[s_tx.seg_first];
+    *len = seg->len;
+    return seg->data;
+}
+
+void fl_log_tx_consume(size_t len) {
+    while (len > 0 && s_tx.seg_count > 0) {
+        tx_seg_t* seg = &s_tx.segs[s_tx.seg_first];
+        size_t n = len < seg->len ? len : seg->len;
+        seg->data += n;
+        seg->len -= n;
+        s_tx.pending -= n;
+        len -= n;
+
+        if (seg->ring) {
+            /* Ring bytes are released in order; the end of the ring is its start */
+            s_tx.tail = (size_t)(seg->data - s_tx.buf);
+            if (s_tx.tail == s_tx.size)
+                s_tx.tail = 0;
+        }
+        if (seg->len == 0) {
+            if (seg->ring)
+                s_tx.ring_segs--;
+            s_tx.seg_first = (s_tx.seg_first + 1) % FL_LOG_TX_SEGS;
+            s_tx.seg_count--;
+        }
+    }
+}
@@ -34,6 +34,8 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /* Callback types */
 typedef void (*fl_output_cb_t)(void* user, const char* str);
@@ -53,6 +55,17 @@ void fl_log_init(fl_output_cb_t output_cb, void* output_user);
  */
 void fl_response(bool ok, const char* fmt, ...);
 
+/**
+ * @brief Enter/leave batch mode: responses end with a newline instead of [FLEND]
+ * @param on true to start a batch (clears the error flag)
+ */
+void fl_log_batch(bool on);
+
+/**
+ * @brief Check if an [FLERR] response was sent since fl_log_batch(true)
+ */
+bool fl_log_batch_error(void);
+
 /**
  * @brief Print a message without OK/ERR prefix
  * @param fmt Printf-style format string
@@ -73,6 +86,82 @@ void fl_println(const char* fmt, ...);
  */
 void fl_print_raw(const char* str);
 
+/**
+ * @brief Print a string that stays unchanged until transmitted
+ * @note  Queued by reference when output goes to the TX ring, so the caller
+ *        must fl_log_tx_wait() before modifying str
+ * @param str String to output
+ */
+void fl_print_ref(const char* str);
+
+/* ===========================
+   TX RING
+   =========================== */
+
+/**
+ * @brief Drain the TX ring: send fl_log_tx_peek() spans and fl_log_tx_consume()
+ *        what has left the wire (or start a DMA and consume on the next call).
+ *        Called from fl_log_tx_poll() and, while the ring is full, in a loop,
+ *        so it must eventually make progress.
+ */
+typedef void (*fl_log_tx_kick_cb_t)(void* user);
+
+/**
+ * @brief Enable the TX ring: output is queued and drained asynchronously
+ *        instead of blocking the caller until sent
+ * @param ring Buffer for copied output, NULL/0 disables the ring
+ * @param size Ring size
+ * @param kick_cb Drain callback
+ * @param user User data for kick_cb
+ */
+void fl_log_tx_init(uint8_t* ring, size_t size, fl_log_tx_kick_cb_t kick_cb, void* user);
+
+/**
+ * @brief Check if the TX ring is enabled
+ */
+bool fl_log_tx_enabled(void);
+
+/**
+ * @brief Output callback that copies strings into the TX ring
+ */
+void fl_log_tx_output(void* user, const char* str);
+
+/**
+ * @brief Queue bytes by copy (waits for room when the ring is full)
+ */
+void fl_log_tx_write(const void* data, size_t len);
+
+/**
+ * @brief Queue bytes by reference, data must stay unchanged until sent
+ */
+void fl_log_tx_write_ref(const void* data, size_t len);
+
+/**
+ * @brief Wait until no queued reference points into [buf, buf + len)
+ * @note  Backpressure for command handlers before reusing an output buffer
+ */
+void fl_log_tx_wait(const void* buf, size_t len);
+
+/**
+ * @brief Number of queued bytes not yet consumed
+ */
+size_t fl_log_tx_pending(void);
+
+/**
+ * @brief Next contiguous span to transmit (*len = 0 if the queue is empty)
+ */
+const uint8_t* fl_log_tx_peek(size_t* len);
+
+/**
+ * @brief Release the first len bytes of the span returned by fl_log_tx_peek()
+ */
+void fl_log_tx_consume(size_t len);
+
+/**
+ * @brief Drain the TX ring (call from the main loop)
+ */
+void fl_log_tx_poll(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -48,6 +48,32 @@
 
 #define LED_PIN PC13
 
+/* Receive USART1 by circular DMA and hand spans to the stream layer in place */
+#ifndef FL_SERIAL_DMA_RX
+#if defined(__STM32F1__)
+#define FL_SERIAL_DMA_RX 1
+#else
+#define FL_SERIAL_DMA_RX 0
+#endif
+#endif
+
+#ifndef FL_SERIAL_DMA_RX_SIZE
+#define FL_SERIAL_DMA_RX_SIZE 512
+#endif
+
+/* Queue fl output in a TX ring sent by USART1 DMA, so responses don't block the loop */
+#ifndef FL_SERIAL_DMA_TX
+#define FL_SERIAL_DMA_TX FL_SERIAL_DMA_RX
+#endif
+
+#ifndef FL_SERIAL_TX_RING_SIZE
+#define FL_SERIAL_TX_RING_SIZE 512
+#endif
+
+#if FL_SERIAL_DMA_RX || FL_SERIAL_DMA_TX
+#include "usart_dma.h"
+#endif
+
 /* ==========================================================================
  * Memory Allocation Configuration
  * ========================================================================== */
@@ -100,6 +126,61 @@ static void print_alloc_info(void) {
  * Common Code
  * ========================================================================== */
 
+/* Interrupt mask callbacks (staged patch commit) */
+static uint32_t irq_save_cb(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+static void irq_restore_cb(uint32_t primask) {
+    __set_PRIMASK(primask);
+}
+
+/* DWT cycle counter as the timestamp of sample records */
+static uint32_t timestamp_cb(void) {
+    return DWT->CYCCNT;
+}
+
+static void timestamp_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+#if FL_USE_PROF
+/* TIM4 drives the profiler: its handler samples the stacked PC, so it replaces the weak one in timer.c */
+static fl_prof_t* s_prof;
+
+extern "C" void prof_timer_isr(const uint32_t* frame) {
+    TIM4->SR = (uint16_t)~TIM_IT_Update;
+    fl_prof_isr(s_prof, frame);
+}
+
+extern "C" __attribute__((naked)) void TIM4_IRQHandler(void) {
+    /* Same frame lookup as DebugMon_Handler: r0 = MSP or PSP per EXC_RETURN */
+    __asm volatile(
+        "tst lr, #4\n"
+        "ite eq\n"
+        "mrseq r0, msp\n"
+        "mrsne r0, psp\n"
+        "b prof_timer_isr\n");
+}
+
+static bool prof_timer_cb(uint32_t hz) {
+    if (hz == 0) {
+        Timer_SetEnable(TIM4, false);
+        return true;
+    }
+    /* Timer_SetInterrupt() takes whole microseconds; cap the interrupt load */
+    if (hz > 20000)
+        return false;
+    Timer_SetInterrupt(TIM4, 1000000 / hz, NULL);
+    Timer_SetEnable(TIM4, true);
+    return true;
+}
+#endif
+
 /* Serial callbacks */
 static int serial_read_cb(uint8_t* buf, size_t len) {
     size_t n = 0;
@@ -117,6 +198,44 @@ static int serial_available_cb(void) {
     return Serial.available();
 }
 
+#if FL_SERIAL_DMA_RX
+static uint8_t s_rx_dma_buf[FL_SERIAL_DMA_RX_SIZE];
+static USART_DMA_Rx_TypeDef s_rx_dma;
+
+static const uint8_t* serial_peek_cb(size_t* len) {
+    return USART_DMA_RxPeek(&s_rx_dma, len);
+}
+
+static void serial_consume_cb(size_t len) {
+    USART_DMA_RxConsume(&s_rx_dma, len);
+}
+#endif
+
+#if FL_SERIAL_DMA_TX
+static uint8_t s_tx_ring[FL_SERIAL_TX_RING_SIZE];
+static USART_DMA_Tx_TypeDef s_tx_dma;
+static size_t s_tx_dma_len;
+
+/* Release the finished DMA span and start the next one */
+static void serial_tx_kick(void* user) {
+    (void)user;
+    if (USART_DMA_TxBusy(&s_tx_dma)) {
+        return;
+    }
+    if (s_tx_dma_len > 0) {
+        fl_log_tx_consume(s_tx_dma_len);
+        s_tx_dma_len = 0;
+    }
+
+    size_t len;
+    const uint8_t* span = fl_log_tx_peek(&len);
+    if (len > 0) {
+        s_tx_dma_len = len > 0xFFFF ? 0xFFFF : len;
+        USART_DMA_TxStart(&s_tx_dma, span, (uint16_t)s_tx_dma_len);
+    }
+}
+#endif
+
 static void blink_led() {
     static uint32_t last_time = 0;
     static bool led_state = false;
@@ -125,6 +244,13 @@ static void blink_led() {
         return;
     }
 
+#if FL_SERIAL_DMA_TX
+    /* Serial.print would interleave with a response still being sent */
+    if (fl_log_tx_pending() > 0) {
+        return;
+    }
+#endif
+
     led_state = !led_state;
 
     String str = led_state ? "led on" : "led off";
@@ -155,17 +281,40 @@ void func_loader_run(void) {
     s_ctx.malloc_cb = malloc;
     s_ctx.free_cb = free;
 #endif
+    s_ctx.irq_save_cb = irq_save_cb;
+    s_ctx.irq_restore_cb = irq_restore_cb;
+    s_ctx.yield_cb = yield;
+    s_ctx.grace_free = true;
+    timestamp_init();
+    s_ctx.timestamp_cb = timestamp_cb;
+    s_ctx.timestamp_hz = SystemCoreClock;
+#if FL_USE_PROF
+    s_prof = &s_ctx.prof;
+    s_ctx.prof_timer_cb = prof_timer_cb;
+#endif
 
     static fl_stream_t s_stream;
     static const fl_serial_t s_serial = {
         .read_cb = serial_read_cb,
         .write_cb = serial_write_cb,
         .available_cb = serial_available_cb,
+#if FL_SERIAL_DMA_RX
+        .peek_cb = serial_peek_cb,
+        .consume_cb = serial_consume_cb,
+#endif
     };
 
+#if FL_SERIAL_DMA_RX
+    USART_DMA_RxInit(&s_rx_dma, USART1, s_rx_dma_buf, sizeof(s_rx_dma_buf));
+#endif
+
     /* Line buffer for stream processing */
     static char s_line_buf[512];
     fl_stream_init(&s_stream, &s_ctx, &s_serial, s_line_buf, sizeof(s_line_buf));
+#if FL_SERIAL_DMA_TX
+    USART_DMA_TxInit(&s_tx_dma, USART1);
+    fl_stream_tx_init(&s_stream, s_tx_ring, sizeof(s_tx_ring), serial_tx_kick, NULL);
+#endif
     fl_init(&s_ctx);
 
     printf("=====================================\n");
@@ -180,5 +329,7 @@ void func_loader_run(void) {
     for (;;) {
         fl_stream_process(&s_stream);
         blink_led();
+        /* Interrupts have returned and blink_led() too: nothing runs patch code here */
+        fl_quiescent(&s_ctx);
     }
 }
@@ -53,10 +53,13 @@
 #include "fl.h"
 #include <nuttx/config.h>
 #include <nuttx/cache.h>
+#include <nuttx/irq.h>
+#include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <unistd.h>
 
 #ifndef FL_NUTTX_BUF_SIZE
 #define FL_NUTTX_BUF_SIZE -1
@@ -66,6 +69,15 @@
 #define FL_NUTTX_LINE_SIZE 1024
 #endif
 
+/* Quiescent state reporting task (grace periods for replaced patch code), see nuttx_grace_task() */
+#ifndef FL_NUTTX_GRACE_TASK
+#define FL_NUTTX_GRACE_TASK 1
+#endif
+
+#ifndef FL_NUTTX_GRACE_PERIOD_MS
+#define FL_NUTTX_GRACE_PERIOD_MS 50
+#endif
+
 /* Include func_allocator for static buffer mode */
 #if FL_NUTTX_BUF_SIZE > 0
 #include "fl_allocator.h"
@@ -83,6 +95,58 @@ static void nuttx_flush_dcache_cb(uintptr_t start, uintptr_t end) {
     up_flush_dcache(start, end);
 }
 
+/* Interrupt mask callbacks (staged patch commit) */
+static uint32_t nuttx_irq_save_cb(void) {
+    return (uint32_t)enter_critical_section();
+}
+
+static void nuttx_irq_restore_cb(uint32_t state) {
+    leave_critical_section((irqstate_t)state);
+}
+
+/* Yield callback (long memory scans) */
+static void nuttx_yield_cb(void) {
+    sched_yield();
+}
+
+/* ==========================================================================
+ * Grace Periods
+ * ========================================================================== */
+
+#if FL_NUTTX_GRACE_TASK && !defined(CONFIG_SMP)
+static fl_context_t* s_grace_ctx;
+
+/*
+ * Reports quiescent states for fl_quiescent(). The task runs at
+ * SCHED_PRIORITY_MIN, so the scheduler only picks it when no higher priority
+ * task is ready. That proves no task is preempted inside patch code only if:
+ *   - no application task runs at SCHED_PRIORITY_MIN: one would share the
+ *     CPU with fl_grace and may lose it inside patch code (round-robin);
+ *   - patch code does not block or yield: a task waiting inside it looks
+ *     quiescent.
+ * Build with FL_NUTTX_GRACE_TASK=0 where this cannot be guaranteed: replaced
+ * code is then freed at once and retarget is not offered. Not used on SMP,
+ * where other CPUs keep running.
+ */
+static int nuttx_grace_task(int argc, char* argv[]) {
+    (void)argc;
+    (void)argv;
+    for (;;) {
+        fl_quiescent(s_grace_ctx);
+        usleep(FL_NUTTX_GRACE_PERIOD_MS * 1000);
+    }
+    return 0;
+}
+
+/* A separate task, unlike a pthread, outlives the fl command that starts it */
+static void nuttx_grace_init(fl_context_t* ctx) {
+    s_grace_ctx = ctx;
+    if (task_create("fl_grace", SCHED_PRIORITY_MIN, 1024, nuttx_grace_task, NULL) > 0) {
+        ctx->grace_free = true;
+    }
+}
+#endif
+
 /* ==========================================================================
  * Memory Allocation Configuration
  * ========================================================================== */
@@ -208,6 +272,9 @@ int main(int argc, char** argv) {
         fl_init_default(&ctx);
         ctx.output_cb = nuttx_output_cb;
         ctx.flush_dcache_cb = nuttx_flush_dcache_cb;
+        ctx.irq_save_cb = nuttx_irq_save_cb;
+        ctx.irq_restore_cb = nuttx_irq_restore_cb;
+        ctx.yield_cb = nuttx_yield_cb;
 
         /* Initialize allocator */
         nuttx_alloc_init();
@@ -226,6 +293,9 @@ int main(int argc, char** argv) {
         ctx.file_ctx.fs = fl_file_get_posix_ops();
 #endif
         fl_init(&ctx);
+#if FL_NUTTX_GRACE_TASK && !defined(CONFIG_SMP)
+        nuttx_grace_init(&ctx);
+#endif
     }
 
     return interactive_mode(&ctx, argc, argv);
@@ -0,0 +1,78 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 VIFEX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file   fl_prof.c
+ * @brief  Statistical PC-sampling profiler implementation
+ */
+
+#include "fl_prof.h"
+#include <string.h>
+
+#if FL_USE_PROF
+
+#define SLOT_MASK (FL_PROF_SLOTS - 1)
+
+/* Fibonacci hash of the halfword index: neighbouring PCs land far apart */
+static inline uint32_t pc_hash(uint32_t pc) {
+    return ((pc >> 1) * 0x9E3779B1u) >> (32 - FL_PROF_SLOTS_LOG2);
+}
+
+void fl_prof_reset(fl_prof_t* p) {
+    p->running = false;
+    p->samples = 0;
+    p->overflow = 0;
+    p->used = 0;
+    memset(p->buckets, 0, sizeof(p->buckets));
+}
+
+void fl_prof_record(fl_prof_t* p, uint32_t pc) {
+    if (!p->running) {
+        return;
+    }
+
+    pc &= ~1u;
+    p->samples++;
+    uint32_t i = pc_hash(pc);
+    for (uint32_t n = 0; n < FL_PROF_PROBES; n++, i = (i + 1) & SLOT_MASK) {
+        fl_prof_bucket_t* b = &p->buckets[i];
+        if (b->count == 0) {
+            b->pc = pc;
+            b->count = 1;
+            p->used++;
+            return;
+        }
+        if (b->pc == pc) {
+            b->count++;
+            return;
+        }
+    }
+    p->overflow++;
+}
+
+void fl_prof_isr(fl_prof_t* p, const uint32_t* frame) {
+    fl_prof_record(p, frame[FL_PROF_FRAME_PC]);
+}
+
+#endif /* FL_USE_PROF */
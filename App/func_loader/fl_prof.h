@@ -0,0 +1,112 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 VIFEX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file   fl_prof.h
+ * @brief  Statistical PC-sampling profiler (prof command)
+ *
+ * A periodic interrupt (SysTick or a spare timer, set up by the port through
+ * fl_context_t.prof_timer_cb) passes its exception stack frame to
+ * fl_prof_isr(), which counts the interrupted PC in a fixed-size hash
+ * histogram. The host reads the (pc, count) pairs with prof --mode dump and
+ * maps them to functions with the ELF symbol table.
+ *
+ * Buckets are never evicted: once the table (or the probe run of a PC) is
+ * full, further new PCs are counted in overflow only, so the dump stays a
+ * lower bound per PC and samples = sum(counts) + overflow.
+ */
+
+#ifndef FL_PROF_H
+#define FL_PROF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef FL_USE_PROF
+#define FL_USE_PROF 0
+#endif
+
+/* Histogram buckets, as a power of 2 */
+#ifndef FL_PROF_SLOTS_LOG2
+#define FL_PROF_SLOTS_LOG2 8
+#endif
+
+#define FL_PROF_SLOTS (1u << FL_PROF_SLOTS_LOG2)
+
+/* Buckets tried per PC (linear probing) before it counts as overflow */
+#ifndef FL_PROF_PROBES
+#define FL_PROF_PROBES 8
+#endif
+
+/* Default sample rate: prime, so it does not run in lockstep with 1 kHz tick work */
+#ifndef FL_PROF_DEFAULT_HZ
+#define FL_PROF_DEFAULT_HZ 997
+#endif
+
+/* Stacked PC word of the Cortex-M exception frame (STACK_PC in fpb_regs.h) */
+#define FL_PROF_FRAME_PC 6
+
+typedef struct {
+    uint32_t pc;
+    uint32_t count; /* 0 = free bucket */
+} fl_prof_bucket_t;
+
+/**
+ * @brief Profiler state (embedded in fl_context_t)
+ * @note  fl_prof_record() runs in the sampling interrupt; the main loop only
+ *        resets the table while sampling is stopped.
+ */
+typedef struct {
+    volatile bool running;
+    uint32_t hz;       /* Sample rate requested by the last start */
+    uint32_t samples;  /* PCs seen since the last reset */
+    uint32_t overflow; /* Samples of PCs that found no bucket */
+    uint32_t used;     /* Buckets in use */
+    fl_prof_bucket_t buckets[FL_PROF_SLOTS];
+} fl_prof_t;
+
+/**
+ * @brief Clear the histogram (profiler stopped)
+ */
+void fl_prof_reset(fl_prof_t* p);
+
+/**
+ * @brief Count one sample of pc (no-op while stopped)
+ */
+void fl_prof_record(fl_prof_t* p, uint32_t pc);
+
+/**
+ * @brief Sampling interrupt hook: count the PC of the stacked exception frame
+ * @param frame MSP or PSP at exception entry, as in fpb_debugmon_handler()
+ */
+void fl_prof_isr(fl_prof_t* p, const uint32_t* frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FL_PROF_H */
@@ -0,0 +1,220 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 VIFEX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file   fl_sample.c
+ * @brief  Periodic variable sampler implementation
+ */
+
+#include "fl_sample.h"
+#include "fl.h"
+#include "fl_log.h"
+#include <string.h>
+
+#if FL_USE_SAMPLE
+
+#define RING_MASK (FL_SAMPLE_RING_SIZE - 1)
+
+/* Orders ring accesses against the head/tail publish (single core: compiler only) */
+#define SAMPLE_BARRIER() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+/* Timestamp that separates key records, well inside the 32-bit wrap */
+#define KEY_TS_SPAN 0x40000000UL
+
+int fl_sample_add(fl_sample_t* s, uintptr_t addr, size_t len) {
+    if (s->count >= FL_SAMPLE_MAX_PROBES || len == 0 || len > FL_SAMPLE_PROBE_SIZE) {
+        return -1;
+    }
+    s->probes[s->count].addr = addr;
+    s->probes[s->count].len = (uint8_t)len;
+    s->head = s->tail;
+    return s->count++;
+}
+
+void fl_sample_clear(fl_sample_t* s) {
+    s->running = false;
+    s->count = 0;
+    s->head = s->tail;
+}
+
+void fl_sample_start(fl_context_t* ctx, uint32_t period) {
+    fl_sample_t* s = &ctx->sample;
+    s->running = false;
+    SAMPLE_BARRIER();
+
+    s->period = period;
+    s->ticks = 0;
+    s->due = ctx->timestamp_cb ? ctx->timestamp_cb() : 0;
+    s->key = true;
+    s->seq = 0;
+    s->since_key = 0;
+    s->records = 0;
+    s->dropped = 0;
+    s->head = s->tail;
+
+    SAMPLE_BARRIER();
+    s->running = true;
+}
+
+void fl_sample_stop(fl_sample_t* s) {
+    s->running = false;
+}
+
+/* Read a probe with one access where its size and alignment allow (no torn words) */
+static void probe_read(const fl_sample_probe_t* p, uint8_t* out) {
+    if (p->len == 4 && (p->addr & 3) == 0) {
+        uint32_t v = *(const volatile uint32_t*)p->addr;
+        memcpy(out, &v, 4);
+    } else if (p->len == 2 && (p->addr & 1) == 0) {
+        uint16_t v = *(const volatile uint16_t*)p->addr;
+        memcpy(out, &v, 2);
+    } else {
+        for (uint8_t i = 0; i < p->len; i++) {
+            out[i] = ((const volatile uint8_t*)p->addr)[i];
+        }
+    }
+}
+
+static size_t record_size(const fl_sample_t* s, uint8_t mask) {
+    size_t n = FL_SAMPLE_REC_HDR_SIZE;
+    for (uint8_t i = 0; i < s->count; i++) {
+        if (mask & (1u << i))
+            n += s->probes[i].len;
+    }
+    return n;
+}
+
+void fl_sample_tick(fl_context_t* ctx) {
+    fl_sample_t* s = &ctx->sample;
+    if (!s->running) {
+        return;
+    }
+
+    s->ticks++;
+    uint32_t now = ctx->timestamp_cb ? ctx->timestamp_cb() : s->ticks;
+    if (s->period != 0) {
+        if ((int32_t)(now - s->due) < 0)
+            return;
+        s->due += s->period;
+        /* Fell a whole period behind: skip the missed samples instead of bursting */
+        if ((int32_t)(now - s->due) >= 0)
+            s->due = now + s->period;
+    }
+
+    if (s->since_key >= FL_SAMPLE_KEY_INTERVAL || now - s->key_ts >= KEY_TS_SPAN)
+        s->key = true;
+
+    /* Changed values are packed behind the header, unchanged ones overwritten */
+    uint8_t rec[FL_SAMPLE_REC_MAX];
+    uint8_t mask = 0;
+    size_t n = FL_SAMPLE_REC_HDR_SIZE;
+    for (uint8_t i = 0; i < s->count; i++) {
+        const fl_sample_probe_t* p = &s->probes[i];
+        probe_read(p, rec + n);
+        if (s->key || memcmp(rec + n, s->last[i], p->len) != 0) {
+            mask |= (uint8_t)(1u << i);
+            n += p->len;
+        }
+    }
+    if (mask == 0) {
+        return;
+    }
+
+    rec[0] = s->seq++;
+    rec[1] = (uint8_t)now;
+    rec[2] = (uint8_t)(now >> 8);
+    rec[3] = (uint8_t)(now >> 16);
+    rec[4] = (uint8_t)(now >> 24);
+    rec[5] = mask;
+
+    uint32_t head = s->head;
+    if (FL_SAMPLE_RING_SIZE - (head - s->tail) < n) {
+        /* last[] keeps the values the host has, the key record resyncs it */
+        s->dropped++;
+        s->key = true;
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        s->ring[(head + i) & RING_MASK] = rec[i];
+    }
+    SAMPLE_BARRIER();
+    s->head = head + (uint32_t)n;
+    s->records++;
+
+    const uint8_t* v = rec + FL_SAMPLE_REC_HDR_SIZE;
+    for (uint8_t i = 0; i < s->count; i++) {
+        if (mask & (1u << i)) {
+            memcpy(s->last[i], v, s->probes[i].len);
+            v += s->probes[i].len;
+        }
+    }
+
+    if (s->key) {
+        s->key = false;
+        s->since_key = 0;
+        s->key_ts = now;
+    } else {
+        s->since_key++;
+    }
+}
+
+void fl_sample_drain(fl_context_t* ctx) {
+    fl_sample_t* s = &ctx->sample;
+    uint32_t tail = s->tail;
+    uint32_t head = s->head;
+    if (tail == head || fl_log_tx_pending() > FL_SAMPLE_LINE_SIZE * 2) {
+        return;
+    }
+    SAMPLE_BARRIER();
+
+    /* Whole records only: a lost line never splits one */
+    uint8_t line[FL_SAMPLE_LINE_SIZE];
+    size_t n = 0;
+    while (tail != head) {
+        size_t len = record_size(s, s->ring[(tail + 5) & RING_MASK]);
+        if (n + len > sizeof(line))
+            break;
+        for (size_t i = 0; i < len; i++) {
+            line[n + i] = s->ring[(tail + i) & RING_MASK];
+        }
+        n += len;
+        tail += (uint32_t)len;
+    }
+    SAMPLE_BARRIER();
+    s->tail = tail;
+
+    char b64[(FL_SAMPLE_LINE_SIZE + 2) / 3 * 4 + 1];
+    fl_base64_encode(line, n, b64, sizeof(b64));
+    fl_print_raw("[FLSMP] ");
+    fl_print_raw(b64);
+    fl_print_raw("\n");
+}
+
+void fl_sample_poll(fl_context_t* ctx) {
+    if (!ctx->sample.isr_tick) {
+        fl_sample_tick(ctx);
+    }
+    fl_sample_drain(ctx);
+}
+
+#endif /* FL_USE_SAMPLE */
@@ -0,0 +1,178 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 VIFEX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file   fl_sample.h
+ * @brief  Periodic variable sampler (sample command)
+ *
+ * The host registers up to FL_SAMPLE_MAX_PROBES (addr, len) probes and a
+ * period. fl_sample_tick() snapshots them (from the main loop or a timer
+ * interrupt) and appends a record to a ring when a value changed;
+ * fl_sample_drain() sends the ring from the main loop as text lines:
+ *
+ *   [FLSMP] <base64 of whole records>\n
+ *
+ * Record (multi-byte fields little-endian):
+ *   [seq (1B)] [ts (4B)] [mask (1B)] [value of each probe in mask, in order]
+ *
+ * seq counts every record, dropped ones included, so the host sees losses.
+ * ts is timestamp_cb() (e.g. DWT->CYCCNT), or the tick count without one.
+ * A record carries only the probes that changed, except a key record,
+ * which carries all of them: the first one, the one after a drop, one
+ * every FL_SAMPLE_KEY_INTERVAL records and one before ts could wrap
+ * unnoticed.
+ */
+
+#ifndef FL_SAMPLE_H
+#define FL_SAMPLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef FL_USE_SAMPLE
+#define FL_USE_SAMPLE 0
+#endif
+
+/* Probe count (one mask bit each) */
+#ifndef FL_SAMPLE_MAX_PROBES
+#define FL_SAMPLE_MAX_PROBES 8
+#endif
+
+/* Largest probe (a double / uint64_t) */
+#define FL_SAMPLE_PROBE_SIZE 8
+
+/* Record ring, a power of 2 */
+#ifndef FL_SAMPLE_RING_SIZE
+#define FL_SAMPLE_RING_SIZE 512
+#endif
+
+/* Record bytes per [FLSMP] line, a multiple of 3 keeps the base64 unpadded */
+#ifndef FL_SAMPLE_LINE_SIZE
+#define FL_SAMPLE_LINE_SIZE 96
+#endif
+
+/* Records between key records */
+#ifndef FL_SAMPLE_KEY_INTERVAL
+#define FL_SAMPLE_KEY_INTERVAL 64
+#endif
+
+#define FL_SAMPLE_REC_HDR_SIZE 6
+#define FL_SAMPLE_REC_MAX (FL_SAMPLE_REC_HDR_SIZE + FL_SAMPLE_MAX_PROBES * FL_SAMPLE_PROBE_SIZE)
+
+#if FL_SAMPLE_MAX_PROBES > 8
+#error "FL_SAMPLE_MAX_PROBES must fit the 8-bit record mask"
+#endif
+
+#if (FL_SAMPLE_RING_SIZE & (FL_SAMPLE_RING_SIZE - 1)) != 0 || FL_SAMPLE_RING_SIZE < FL_SAMPLE_REC_MAX
+#error "FL_SAMPLE_RING_SIZE must be a power of 2 that holds a full record"
+#endif
+
+#if FL_SAMPLE_LINE_SIZE < FL_SAMPLE_REC_MAX
+#error "FL_SAMPLE_LINE_SIZE must hold a full record"
+#endif
+
+typedef struct {
+    uintptr_t addr;
+    uint8_t len;
+} fl_sample_probe_t;
+
+/**
+ * @brief Sampler state (embedded in fl_context_t)
+ * @note  fl_sample_tick() is the only writer of head, fl_sample_drain() the
+ *        only writer of tail, so a timer interrupt may tick while the main
+ *        loop drains.
+ */
+typedef struct {
+    fl_sample_probe_t probes[FL_SAMPLE_MAX_PROBES];
+    uint8_t count; /* Registered probes */
+    volatile bool running;
+    bool isr_tick;     /* Set by the port when fl_sample_tick() runs from a timer */
+    bool key;          /* Next record is a key record */
+    uint8_t seq;
+    uint8_t since_key; /* Records since the last key record */
+    uint32_t period;   /* Timestamp ticks between samples, 0 = every tick */
+    uint32_t due;      /* Timestamp of the next sample */
+    uint32_t ticks;    /* fl_sample_tick() calls (timestamp without timestamp_cb) */
+    uint32_t key_ts;   /* Timestamp of the last key record */
+    uint32_t records;  /* Records queued */
+    uint32_t dropped;  /* Records lost to a full ring */
+    uint8_t last[FL_SAMPLE_MAX_PROBES][FL_SAMPLE_PROBE_SIZE]; /* Values last queued */
+    volatile uint32_t head; /* Free-running ring offsets */
+    volatile uint32_t tail;
+    uint8_t ring[FL_SAMPLE_RING_SIZE];
+} fl_sample_t;
+
+struct fl_context_s;
+
+/**
+ * @brief  Register a probe (sampler stopped); drops queued records
+ * @return Probe index, -1 if the table is full or len is not 1..FL_SAMPLE_PROBE_SIZE
+ */
+int fl_sample_add(fl_sample_t* s, uintptr_t addr, size_t len);
+
+/**
+ * @brief Remove all probes and queued records (stops the sampler)
+ */
+void fl_sample_clear(fl_sample_t* s);
+
+/**
+ * @brief Start sampling; the first record is a key record
+ * @param period Timestamp ticks between samples, 0 = every fl_sample_tick()
+ */
+void fl_sample_start(struct fl_context_s* ctx, uint32_t period);
+
+/**
+ * @brief Stop sampling, queued records are still drained
+ */
+void fl_sample_stop(fl_sample_t* s);
+
+/**
+ * @brief Snapshot the probes if the period elapsed, queue a record on change
+ * @note  Does no output: safe to call from a timer interrupt (set isr_tick)
+ */
+void fl_sample_tick(struct fl_context_s* ctx);
+
+/**
+ * @brief Send queued records as one [FLSMP] line (main loop only)
+ * @note  Skipped while the TX ring holds more than a line of earlier output,
+ *        so sampling never blocks the loop on the UART; records queue up
+ *        (or drop) on the device instead
+ */
+void fl_sample_drain(struct fl_context_s* ctx);
+
+/**
+ * @brief Main-loop hook: tick (unless isr_tick) and drain
+ * @note  Called by fl_stream_process()
+ */
+void fl_sample_poll(struct fl_context_s* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FL_SAMPLE_H */
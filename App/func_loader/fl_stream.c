@@ -28,16 +28,45 @@
 
 #include "fl_stream.h"
 #include "fl.h"
+#include "fl_frame.h"
+#include "fl_log.h"
 #include <string.h>
 
 #ifndef FL_MAX_ARGC
 #define FL_MAX_ARGC 16
 #endif
 
+/* Serial output, queued in the TX ring if enabled. By reference, data must stay unchanged until sent */
+static void stream_write(fl_stream_t* s, const void* data, size_t len, bool ref) {
+    if (fl_log_tx_enabled()) {
+        if (ref) {
+            fl_log_tx_write_ref(data, len);
+        } else {
+            fl_log_tx_write(data, len);
+        }
+    } else if (s->serial && s->serial->write_cb) {
+        s->serial->write_cb((const uint8_t*)data, len);
+    }
+}
+
 static void stream_output(void* user, const char* str) {
+    stream_write((fl_stream_t*)user, str, strlen(str), false);
+}
+
+/* Default TX ring drain: as much as write_cb takes without blocking */
+static void stream_tx_kick(void* user) {
     fl_stream_t* s = (fl_stream_t*)user;
-    if (s->serial && s->serial->write_cb) {
-        s->serial->write_cb((const uint8_t*)str, strlen(str));
+    if (!s->serial || !s->serial->write_cb) {
+        return;
+    }
+
+    size_t len;
+    const uint8_t* span;
+    while ((span = fl_log_tx_peek(&len)) != NULL && len > 0) {
+        int n = s->serial->write_cb(span, len);
+        if (n <= 0)
+            break;
+        fl_log_tx_consume((size_t)n);
     }
 }
 
@@ -48,9 +77,22 @@ void fl_stream_init(fl_stream_t* s, struct fl_context_s* ctx, const fl_serial_t*
     s->line_buf = line_buf;
     s->line_size = line_size;
     s->line_pos = 0;
+    s->rx_state = FL_STREAM_RX_LINE;
+    s->frame_len = 0;
+    s->tx_len = 0;
 
     ctx->output_cb = stream_output;
     ctx->output_user = s;
+    ctx->caps |= FL_CAP_FRAME | FL_CAP_STREAM_DATA;
+}
+
+void fl_stream_tx_init(fl_stream_t* s, uint8_t* ring, size_t size, fl_log_tx_kick_cb_t kick_cb, void* user) {
+    if (kick_cb) {
+        fl_log_tx_init(ring, size, kick_cb, user);
+    } else {
+        fl_log_tx_init(ring, size, stream_tx_kick, s);
+    }
+    s->ctx->output_cb = fl_log_tx_enabled() ? fl_log_tx_output : stream_output;
 }
 
 static int parse_line(char* line, const char** argv, int max_argc) {
@@ -93,33 +135,341 @@ int fl_stream_exec_line(fl_stream_t* s, char* line) {
     return 0;
 }
 
-void fl_stream_process(fl_stream_t* s) {
-    if (!s->serial || !s->serial->available_cb || !s->serial->read_cb) {
-        return;
+/* ===========================
+   BINARY FRAMES
+   =========================== */
+
+static void frame_send(fl_stream_t* s, uint8_t flags, const uint8_t* data, size_t len, bool ref) {
+    uint8_t hdr[FL_FRAME_HDR_SIZE];
+    hdr[0] = FL_FRAME_SOF;
+    hdr[1] = flags;
+    hdr[2] = s->tx_seq;
+    hdr[3] = s->tx_op;
+    hdr[4] = (uint8_t)(len & 0xFF);
+    hdr[5] = (uint8_t)(len >> 8);
+
+    uint16_t crc = fl_crc16_update(0xFFFF, hdr + 1, FL_FRAME_HDR_SIZE - 1);
+    crc = fl_crc16_update(crc, data, len);
+    uint8_t tail[FL_FRAME_CRC_SIZE] = {(uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8)};
+
+    stream_write(s, hdr, sizeof(hdr), false);
+    if (len > 0) {
+        stream_write(s, data, len, ref);
+    }
+    stream_write(s, tail, sizeof(tail), false);
+}
+
+static void frame_flush_text(fl_stream_t* s, uint8_t flags) {
+    frame_send(s, flags, s->tx_buf, s->tx_len, false);
+    s->tx_len = 0;
+}
+
+/* Text output while serving a frame: packed into tx_buf */
+static void frame_output(void* user, const char* str) {
+    fl_stream_t* s = (fl_stream_t*)user;
+    size_t len = strlen(str);
+    while (len > 0) {
+        if (s->tx_len == sizeof(s->tx_buf)) {
+            frame_flush_text(s, FL_FRAME_F_RESP | FL_FRAME_F_MORE);
+        }
+        size_t n = sizeof(s->tx_buf) - s->tx_len;
+        if (n > len)
+            n = len;
+        memcpy(s->tx_buf + s->tx_len, str, n);
+        s->tx_len += n;
+        str += n;
+        len -= n;
+    }
+}
+
+/* Raw data output while serving a frame: sent from the caller's buffer (by reference) */
+static void frame_output_data(void* user, const uint8_t* data, size_t len) {
+    fl_stream_t* s = (fl_stream_t*)user;
+    if (s->tx_len > 0) {
+        frame_flush_text(s, FL_FRAME_F_RESP | FL_FRAME_F_MORE);
+    }
+    while (len > 0) {
+        size_t n = len > 0xFFFF ? 0xFFFF : len;
+        frame_send(s, FL_FRAME_F_RESP | FL_FRAME_F_MORE | FL_FRAME_F_DATA, data, n, true);
+        data += n;
+        len -= n;
     }
+}
+
+/* Route all output of the current request into response frames */
+static void frame_begin(fl_stream_t* s, uint8_t seq, uint8_t op) {
+    s->tx_seq = seq;
+    s->tx_op = op;
+    s->tx_len = 0;
+    fl_log_init(frame_output, s);
+    s->ctx->output_data_cb = frame_output_data;
+    s->ctx->output_user = s;
+}
+
+static void frame_end(fl_stream_t* s) {
+    frame_flush_text(s, FL_FRAME_F_RESP);
+    s->ctx->output_data_cb = NULL;
+    fl_log_init(s->ctx->output_cb, s->ctx->output_user);
+}
+
+static void stream_exec_frame(fl_stream_t* s) {
+    struct fl_context_s* ctx = s->ctx;
+    uint8_t* frame = (uint8_t*)s->line_buf;
+    size_t plen = s->frame_len - FL_FRAME_OVERHEAD;
+    const uint8_t* tail = frame + FL_FRAME_HDR_SIZE + plen;
+    uint16_t rx_crc = (uint16_t)(tail[0] | (tail[1] << 8));
+    uint16_t crc = fl_crc16_update(0xFFFF, frame + 1, FL_FRAME_HDR_SIZE - 1 + plen);
+
+    frame_begin(s, frame[2], frame[3]);
+    if (crc != rx_crc) {
+        fl_response(false, "Frame CRC mismatch: 0x%04X != 0x%04X", (unsigned)rx_crc, (unsigned)crc);
+        s->rx_state = FL_STREAM_RX_DISCARD;
+    } else {
+        fl_exec_frame(ctx, frame[3], frame + FL_FRAME_HDR_SIZE, plen);
+        s->rx_state = FL_STREAM_RX_LINE;
+    }
+
+    frame_end(s);
+}
+
+static void stream_frame_byte(fl_stream_t* s, uint8_t c) {
+    uint8_t* frame = (uint8_t*)s->line_buf;
+    frame[s->line_pos++] = c;
+
+    if (s->line_pos == FL_FRAME_HDR_SIZE) {
+        s->frame_len = FL_FRAME_OVERHEAD + (size_t)(frame[4] | (frame[5] << 8));
+        if (s->frame_len > s->line_size) {
+            /* Cannot buffer it: reject and resync on the next newline */
+            frame_begin(s, frame[2], frame[3]);
+            fl_response(false, "Frame too large: %u > %u", (unsigned)s->frame_len, (unsigned)s->line_size);
+            frame_end(s);
+            s->rx_state = FL_STREAM_RX_DISCARD;
+            s->line_pos = 0;
+            return;
+        }
+    }
+
+    if (s->line_pos > FL_FRAME_HDR_SIZE - 1 && s->line_pos == s->frame_len) {
+        stream_exec_frame(s);
+        s->line_pos = 0;
+    }
+}
+
+/* ===========================
+   STREAMED DATA
+   =========================== */
+
+static bool token_is(const char* tok, size_t len, const char* str) {
+    return strlen(str) == len && memcmp(tok, str, len) == 0;
+}
+
+/**
+ * @brief  Check whether the line so far is an upload/write header ending in -d/--data
+ * @note   --len is required so the data can be decoded and checked as it arrives
+ */
+static bool stream_data_header(const fl_stream_t* s) {
+    const char* line = s->line_buf;
+    size_t end = s->line_pos;
+    const char* prev = NULL;
+    size_t prev_len = 0;
+    bool is_data_cmd = false;
+    bool has_len = false;
 
-    while (s->serial->available_cb() > 0) {
-        uint8_t c;
-        if (s->serial->read_cb(&c, 1) != 1)
+    for (size_t i = 0; i < end;) {
+        while (i < end && line[i] == ' ')
+            i++;
+        if (i == end)
             break;
+        const char* tok = line + i;
+        size_t tok_len = 0;
+        while (i < end && line[i] != ' ') {
+            i++;
+            tok_len++;
+        }
+
+        if (prev && (token_is(prev, prev_len, "-c") || token_is(prev, prev_len, "--cmd"))) {
+            is_data_cmd = token_is(tok, tok_len, "upload") || token_is(tok, tok_len, "write");
+        }
+        if (token_is(tok, tok_len, "-l") || token_is(tok, tok_len, "--len")) {
+            has_len = true;
+        }
+        prev = tok;
+        prev_len = tok_len;
+    }
+
+    return is_data_cmd && has_len && prev && (token_is(prev, prev_len, "-d") || token_is(prev, prev_len, "--data"));
+}
 
+static void stream_data_begin(fl_stream_t* s) {
+    static const char* argv[FL_MAX_ARGC];
+    s->line_buf[s->line_pos] = '\0';
+    int argc = parse_line(s->line_buf, argv, FL_MAX_ARGC);
+    s->line_pos = 0;
+    s->rx_state = fl_exec_data_begin(s->ctx, argc, argv) == 0 ? FL_STREAM_RX_DATA : FL_STREAM_RX_DISCARD;
+}
+
+/* ===========================
+   STREAM PROCESSING
+   =========================== */
+
+/**
+ * @brief  Length of the leading run that needs no per-byte handling
+ * @note   Stops at spaces, control characters and DEL: base64 and command
+ *         tokens are copied/decoded a whole run at a time
+ */
+static size_t span_run(const uint8_t* p, size_t n) {
+    size_t i = 0;
+    while (i < n && p[i] > ' ' && p[i] != 0x7F)
+        i++;
+    return i;
+}
+
+/**
+ * @brief  Offset of the first '\n' or '\r' (n if none)
+ */
+static size_t span_eol(const uint8_t* p, size_t n) {
+    const uint8_t* nl = memchr(p, '\n', n);
+    size_t end = nl ? (size_t)(nl - p) : n;
+    const uint8_t* cr = memchr(p, '\r', end);
+    return cr ? (size_t)(cr - p) : end;
+}
+
+static void stream_rx_byte(fl_stream_t* s, uint8_t c) {
+    if (s->rx_state == FL_STREAM_RX_FRAME) {
+        stream_frame_byte(s, c);
+        return;
+    }
+
+    if (s->rx_state == FL_STREAM_RX_DATA) {
         if (c == '\n' || c == '\r') {
-            if (s->line_pos > 0) {
-                s->line_buf[s->line_pos] = '\0';
-                fl_stream_exec_line(s, s->line_buf);
-                s->line_pos = 0;
-            }
-            continue;
+            fl_exec_data_end(s->ctx);
+            s->rx_state = FL_STREAM_RX_LINE;
+        } else if (c != ' ' && c != '\t') {
+            fl_exec_data_feed(s->ctx, (const char*)&c, 1);
         }
+        return;
+    }
 
-        if (c == '\b' || c == 0x7F) {
-            if (s->line_pos > 0)
-                s->line_pos--;
-            continue;
+    if (s->rx_state == FL_STREAM_RX_DISCARD) {
+        if (c == '\n' || c == '\r')
+            s->rx_state = FL_STREAM_RX_LINE;
+        return;
+    }
+
+    if (c == FL_FRAME_SOF && s->line_pos == 0 && s->serial && s->serial->write_cb) {
+        s->rx_state = FL_STREAM_RX_FRAME;
+        stream_frame_byte(s, c);
+        return;
+    }
+
+    if (c == '\n' || c == '\r') {
+        if (s->line_pos > 0) {
+            s->line_buf[s->line_pos] = '\0';
+            fl_stream_exec_line(s, s->line_buf);
+            s->line_pos = 0;
+        }
+        return;
+    }
+
+    if (c == ' ' && s->line_pos > 0 && stream_data_header(s)) {
+        stream_data_begin(s);
+        return;
+    }
+
+    if (c == '\b' || c == 0x7F) {
+        if (s->line_pos > 0)
+            s->line_pos--;
+        return;
+    }
+
+    if (s->line_pos < s->line_size - 1) {
+        s->line_buf[s->line_pos++] = c;
+    }
+}
+
+/**
+ * @brief  Consume the bulk part of a span in the current state
+ * @return Bytes consumed; 0 means the next byte needs stream_rx_byte()
+ */
+static size_t stream_rx_span(fl_stream_t* s, const uint8_t* p, size_t n) {
+    size_t run;
+
+    switch (s->rx_state) {
+        case FL_STREAM_RX_FRAME:
+            /* Header byte-wise (length check); payload up to the last byte,
+               which completes the frame in stream_frame_byte() */
+            if (s->line_pos < FL_FRAME_HDR_SIZE)
+                return 0;
+            run = s->frame_len - s->line_pos - 1;
+            if (run > n)
+                run = n;
+            memcpy(s->line_buf + s->line_pos, p, run);
+            s->line_pos += run;
+            return run;
+
+        case FL_STREAM_RX_DATA:
+            run = span_run(p, n);
+            if (run > 0)
+                fl_exec_data_feed(s->ctx, (const char*)p, run);
+            return run;
+
+        case FL_STREAM_RX_DISCARD:
+            return span_eol(p, n);
+
+        default:
+            /* The first byte of a line may start a frame */
+            if (s->line_pos == 0)
+                return 0;
+            run = span_run(p, n);
+            if (run > 0) {
+                size_t room = s->line_size - 1 - s->line_pos;
+                memcpy(s->line_buf + s->line_pos, p, run < room ? run : room);
+                s->line_pos += run < room ? run : room;
+            }
+            return run;
+    }
+}
+
+void fl_stream_feed(fl_stream_t* s, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        size_t n = stream_rx_span(s, data, len);
+        if (n == 0) {
+            stream_rx_byte(s, *data);
+            n = 1;
         }
+        data += n;
+        len -= n;
+    }
+}
 
-        if (s->line_pos < s->line_size - 1) {
-            s->line_buf[s->line_pos++] = c;
+void fl_stream_process(fl_stream_t* s) {
+    const fl_serial_t* serial = s->serial;
+    if (!serial) {
+        return;
+    }
+
+    if (serial->peek_cb && serial->consume_cb) {
+        size_t len;
+        const uint8_t* span;
+        while ((span = serial->peek_cb(&len)) != NULL && len > 0) {
+            fl_stream_feed(s, span, len);
+            serial->consume_cb(len);
+        }
+    } else if (serial->available_cb && serial->read_cb) {
+        uint8_t buf[FL_STREAM_RX_CHUNK];
+        while (serial->available_cb() > 0) {
+            int n = serial->read_cb(buf, sizeof(buf));
+            if (n <= 0)
+                break;
+            fl_stream_feed(s, buf, (size_t)n);
         }
     }
+
+#if FL_USE_SAMPLE
+    /* Sample records go out between commands, never inside a response */
+    fl_sample_poll(s->ctx);
+#endif
+
+    /* Drain responses queued in the TX ring */
+    fl_log_tx_poll();
 }
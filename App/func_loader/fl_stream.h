@@ -33,28 +33,70 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include "fl_log.h"
+
+/* Response frame buffer (text output is packed into frames of this size) */
+#ifndef FL_FRAME_TX_SIZE
+#define FL_FRAME_TX_SIZE 256
+#endif
+
+/* Stack buffer for read_cb when the port has no zero-copy RX */
+#ifndef FL_STREAM_RX_CHUNK
+#define FL_STREAM_RX_CHUNK 64
+#endif
 
 /* Serial callbacks */
 typedef int (*fl_serial_read_cb_t)(uint8_t* buf, size_t len);
 typedef int (*fl_serial_write_cb_t)(const uint8_t* buf, size_t len);
 typedef int (*fl_serial_available_cb_t)(void);
 
+/**
+ * @brief Zero-copy RX: next contiguous span of received bytes in the port's
+ *        RX (ring/DMA) buffer. Sets *len (0 = nothing pending); the span stays
+ *        valid until consumed.
+ */
+typedef const uint8_t* (*fl_serial_peek_cb_t)(size_t* len);
+
+/**
+ * @brief Release the first len bytes of the span returned by peek_cb
+ */
+typedef void (*fl_serial_consume_cb_t)(size_t len);
+
 typedef struct {
     fl_serial_read_cb_t read_cb;
     fl_serial_write_cb_t write_cb;
     fl_serial_available_cb_t available_cb;
+    fl_serial_peek_cb_t peek_cb;       /* Optional: used instead of read_cb when set with consume_cb */
+    fl_serial_consume_cb_t consume_cb; /* Optional */
 } fl_serial_t;
 
 struct fl_context_s;
 
+/* Receive state */
+typedef enum {
+    FL_STREAM_RX_LINE = 0, /* Text command line */
+    FL_STREAM_RX_FRAME,    /* Binary frame (buffered in line_buf) */
+    FL_STREAM_RX_DISCARD,  /* Drop input until newline (frame resync) */
+    FL_STREAM_RX_DATA,     /* Streamed base64 --data (fl_exec_data_feed) */
+} fl_stream_rx_state_t;
+
 typedef struct {
     struct fl_context_s* ctx;
     const fl_serial_t* serial;
     char* line_buf;
     size_t line_size;
     size_t line_pos;
+
+    /* Binary frame state */
+    uint8_t rx_state;       /* fl_stream_rx_state_t */
+    size_t frame_len;       /* Total size of the frame being received */
+    uint8_t tx_seq;         /* seq/op echoed in response frames */
+    uint8_t tx_op;
+    size_t tx_len;          /* Pending text bytes in tx_buf */
+    uint8_t tx_buf[FL_FRAME_TX_SIZE];
 } fl_stream_t;
 
 /**
@@ -63,11 +105,32 @@ typedef struct {
 void fl_stream_init(fl_stream_t* s, struct fl_context_s* ctx, const fl_serial_t* serial, char* line_buf,
                     size_t line_size);
 
+/**
+ * @brief Queue output in a TX ring instead of blocking in write_cb
+ * @note  Call after fl_stream_init() and before fl_init(). Responses are
+ *        drained by fl_stream_process(); data buffers (read/echoback/fread)
+ *        are queued by reference and the next command waits for them.
+ * @param ring TX ring buffer (text and frame headers are copied here)
+ * @param size Ring size
+ * @param kick_cb Drain callback (e.g. starts a TX DMA), NULL drains through
+ *        write_cb, which should then return without waiting for the UART
+ * @param user User data for kick_cb
+ */
+void fl_stream_tx_init(fl_stream_t* s, uint8_t* ring, size_t size, fl_log_tx_kick_cb_t kick_cb, void* user);
+
 /**
  * @brief Process incoming serial data
+ * @note  Drains peek_cb/consume_cb spans if the port provides them, otherwise
+ *        reads FL_STREAM_RX_CHUNK bytes at a time with read_cb, then runs
+ *        the sampler (fl_sample_poll) and drains the TX ring
  */
 void fl_stream_process(fl_stream_t* s);
 
+/**
+ * @brief Process received bytes pushed by the caller (e.g. from an RX callback)
+ */
+void fl_stream_feed(fl_stream_t* s, const uint8_t* data, size_t len);
+
 /**
  * @brief Parse line and execute
  */
@@ -0,0 +1,186 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 VIFEX
+ *
+ * Micro-benchmark for fl.c command parsing - compares the table-driven
+ * single-pass parser and sorted dispatch table against the per-call argparse
+ * option array and linear strcmp lookup they replaced.
+ *
+ * White-box: fl.c is included directly to reach its static parser.
+ */
+
+#include "../func_loader/fl.c"
+#include "argparse.h"
+#include <time.h>
+
+#define BENCH_ROUNDS 20000
+
+/* ============================================================================
+ * Reference parser (argparse, as previously in fl.c)
+ * ============================================================================ */
+
+static int ref_parse_cmd_args(int argc, const char** argv, cmd_args_t* args) {
+    cmd_args_init(args);
+    const char* crc_str = NULL;
+
+    struct argparse_option opts[] = {
+        OPT_HELP(),
+        OPT_STRING('c', "cmd", &args->cmd, "Command", NULL, 0, 0),
+        OPT_INTEGER('s', "size", &args->size, "Alloc size", NULL, 0, 0),
+        OPT_POINTER('a', "addr", &args->addr, "Address/offset (hex)", NULL, 0, 0),
+        OPT_STRING('d', "data", &args->data, "Hex data", NULL, 0, 0),
+        OPT_STRING('r', "crc", &crc_str, "CRC-16, or CRC-32 with --crc32 (hex)", NULL, 0, 0),
+        OPT_BOOLEAN(0, "crc32", &args->crc32, "Use CRC-32 for request/response CRCs", NULL, 0, 0),
+        OPT_INTEGER('l', "len", &args->len, "Read length", NULL, 0, 0),
+        OPT_INTEGER(0, "comp", &args->comp, "Comparator ID", NULL, 0, 0),
+        OPT_POINTER(0, "orig", &args->orig, "Original addr", NULL, 0, 0),
+        OPT_POINTER(0, "target", &args->target, "Target addr", NULL, 0, 0),
+        OPT_BOOLEAN(0, "all", &args->all, "Clear all", NULL, 0, 0),
+        OPT_INTEGER(0, "enable", &args->enable, "Enable(1) or disable(0) patch", NULL, 0, 0),
+        OPT_BOOLEAN(0, "force", &args->force, "Skip address range check", NULL, 0, 0),
+        OPT_STRING(0, "path", &args->path, "File path", NULL, 0, 0),
+        OPT_STRING(0, "newpath", &args->newpath, "New file path", NULL, 0, 0),
+        OPT_STRING('m', "mode", &args->mode, "File mode (r/w/a)", NULL, 0, 0),
+        OPT_END(),
+    };
+
+    struct argparse ap;
+    fl_argparse_init(&ap, opts, NULL, 0);
+    if (fl_argparse_parse(&ap, argc, argv) > 0)
+        return -1;
+
+    if (crc_str) {
+        char* end;
+        args->crc = (uint32_t)strtoul(crc_str, &end, 0);
+        args->has_crc = 1;
+        if (end == crc_str || *end != '\0')
+            return -1;
+    }
+    return 0;
+}
+
+static const cmd_entry_t* ref_lookup(const char* name) {
+    for (size_t i = 0; i < CMD_TABLE_SIZE; i++) {
+        if (strcmp(name, s_cmd_table[i].name) == 0)
+            return &s_cmd_table[i];
+    }
+    return NULL;
+}
+
+static const cmd_entry_t* new_lookup(const char* name) {
+    return table_lookup(s_cmd_table, CMD_TABLE_SIZE, sizeof(s_cmd_table[0]), name, strlen(name));
+}
+
+/* ============================================================================
+ * Timing
+ * ============================================================================ */
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+static uint64_t bench_now(void) {
+    return __rdtsc();
+}
+#else
+#define BENCH_UNIT "ns"
+static uint64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+static volatile uintptr_t s_sink;
+
+typedef struct {
+    const char* name;
+    int argc;
+    const char* argv[16];
+} bench_case_t;
+
+/* clang-format off */
+static const bench_case_t s_cases[] = {
+    { "ping",     3, { "fl", "--cmd", "ping" } },
+    { "read",     8, { "fl", "--cmd", "read", "--addr", "0x20001000", "--len", "256", "--crc32" } },
+    { "upload",   9, { "fl", "--cmd", "upload", "--addr", "0x400", "--data", "AAECAwQFBgcICQoLDA0ODw==",
+                       "--crc", "0xCBF43926" } },
+    { "tpatch",   9, { "fl", "-c", "tpatch", "--comp", "1", "--orig", "0x08001234", "--target", "0x20000101" } },
+    { "fwrite",   8, { "fl", "--cmd", "fwrite", "--data", "AAECAwQFBgcICQoLDA0ODw==", "--crc32", "--crc",
+                       "0x12345678" } },
+};
+/* clang-format on */
+
+#define BENCH_CASES (sizeof(s_cases) / sizeof(s_cases[0]))
+
+typedef int (*parse_fn_t)(int argc, const char** argv, cmd_args_t* args);
+typedef const cmd_entry_t* (*lookup_fn_t)(const char* name);
+
+/* Best-of-N cost of parse + command lookup for one command line */
+static uint64_t bench(const bench_case_t* bc, parse_fn_t parse, lookup_fn_t lookup) {
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        /* argparse rewrites argv in place: hand each call a fresh copy */
+        const char* argv[16];
+        memcpy(argv, bc->argv, sizeof(argv));
+        cmd_args_t args;
+        uint64_t t0 = bench_now();
+        parse(bc->argc, argv, &args);
+        s_sink += (uintptr_t)lookup(args.cmd);
+        uint64_t dt = bench_now() - t0;
+        if (dt < best)
+            best = dt;
+    }
+    return best;
+}
+
+/* ============================================================================
+ * Main
+ * ============================================================================ */
+
+static int verify(void) {
+    for (size_t i = 0; i < BENCH_CASES; i++) {
+        const bench_case_t* bc = &s_cases[i];
+        const char* argv[16];
+        cmd_args_t ref, cur;
+        memcpy(argv, bc->argv, sizeof(argv));
+        if (ref_parse_cmd_args(bc->argc, argv, &ref) != 0) {
+            printf("Parse failed: %s\n", bc->name);
+            return -1;
+        }
+        memcpy(argv, bc->argv, sizeof(argv));
+        if (parse_cmd_args(bc->argc, argv, &cur) != 0) {
+            printf("Parse failed: %s\n", bc->name);
+            return -1;
+        }
+        if (strcmp(ref.cmd, cur.cmd) != 0 || ref.addr != cur.addr || ref.orig != cur.orig ||
+            ref.target != cur.target || ref.crc != cur.crc || ref.has_crc != cur.has_crc ||
+            ref.crc32 != cur.crc32 || ref.len != cur.len || ref.comp != cur.comp || ref.data != cur.data ||
+            ref_lookup(ref.cmd) != new_lookup(cur.cmd)) {
+            printf("Parse mismatch: %s\n", bc->name);
+            return -1;
+        }
+    }
+
+    /* Every command must be reachable through the binary search */
+    for (size_t i = 0; i < CMD_TABLE_SIZE; i++) {
+        if (new_lookup(s_cmd_table[i].name) != &s_cmd_table[i]) {
+            printf("Command table not sorted at: %s\n", s_cmd_table[i].name);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(void) {
+    if (verify() != 0)
+        return 1;
+
+    printf("fl command parse + lookup benchmark (best of %d, %s per command)\n", BENCH_ROUNDS, BENCH_UNIT);
+    for (size_t i = 0; i < BENCH_CASES; i++) {
+        uint64_t r = bench(&s_cases[i], ref_parse_cmd_args, ref_lookup);
+        uint64_t n = bench(&s_cases[i], parse_cmd_args, new_lookup);
+        printf("%-8s ref %6llu   new %6llu   x%.2f\n", s_cases[i].name, (unsigned long long)r,
+               (unsigned long long)n, n ? (double)r / (double)n : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,279 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 VIFEX
+ *
+ * Micro-benchmark for fl_codec.c - compares the word-at-a-time kernels
+ * against the byte-at-a-time reference implementations they replaced.
+ */
+
+#include "fl_codec.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_BUF_SIZE 4096
+#define BENCH_ROUNDS 2000
+
+/* ============================================================================
+ * Reference kernels (byte-at-a-time, as previously in fl.c)
+ * ============================================================================ */
+
+static uint16_t s_ref_crc_table[256];
+
+static void ref_crc16_init(void) {
+    for (int i = 0; i < 256; i++) {
+        uint16_t crc = (uint16_t)(i << 8);
+        for (int b = 0; b < 8; b++)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        s_ref_crc_table[i] = crc;
+    }
+}
+
+static uint16_t ref_crc16_update(uint16_t crc, const void* data, size_t len) {
+    const uint8_t* ptr = data;
+    while (len--) {
+        crc = (uint16_t)((crc << 8) ^ s_ref_crc_table[(crc >> 8) ^ *ptr++]);
+    }
+    return crc;
+}
+
+static uint32_t s_ref_crc32_table[256];
+
+static void ref_crc32_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int b = 0; b < 8; b++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        s_ref_crc32_table[i] = crc;
+    }
+}
+
+static uint32_t ref_crc32_update(uint32_t crc, const void* data, size_t len) {
+    const uint8_t* ptr = data;
+    crc = ~crc;
+    while (len--) {
+        crc = (crc >> 8) ^ s_ref_crc32_table[(crc ^ *ptr++) & 0xFF];
+    }
+    return ~crc;
+}
+
+static int ref_b64_value(uint8_t c) {
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A';
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 26;
+    if (c >= '0' && c <= '9')
+        return c - '0' + 52;
+    if (c == '+')
+        return 62;
+    if (c == '/')
+        return 63;
+    if (c == '=')
+        return 64;
+    return 255;
+}
+
+static uint8_t s_ref_b64_dec[256];
+
+static void ref_b64_init(void) {
+    for (int i = 0; i < 256; i++)
+        s_ref_b64_dec[i] = (uint8_t)ref_b64_value((uint8_t)i);
+}
+
+static int ref_base64_decode(const char* b64, size_t b64_len, uint8_t* out, size_t max) {
+    if (b64_len == 0 || b64_len % 4 != 0)
+        return -1;
+
+    size_t out_len = (b64_len / 4) * 3;
+    if (b64[b64_len - 1] == '=')
+        out_len--;
+    if (b64[b64_len - 2] == '=')
+        out_len--;
+    if (out_len > max)
+        return -1;
+
+    size_t j = 0;
+    for (size_t i = 0; i < b64_len; i += 4) {
+        const uint8_t* q = (const uint8_t*)b64 + i;
+        uint8_t v0 = s_ref_b64_dec[q[0]];
+        uint8_t v1 = s_ref_b64_dec[q[1]];
+        uint8_t v2 = s_ref_b64_dec[q[2]];
+        uint8_t v3 = s_ref_b64_dec[q[3]];
+        if (v0 >= 64 || v1 >= 64 || v2 == 255 || v3 == 255 || (v2 == 64 && v3 != 64))
+            return -1;
+        if ((v2 == 64 || v3 == 64) && i + 4 < b64_len)
+            return -1;
+        out[j++] = (uint8_t)((v0 << 2) | (v1 >> 4));
+        if (v2 != 64)
+            out[j++] = (uint8_t)(((v1 & 0x0F) << 4) | (v2 >> 2));
+        if (v3 != 64)
+            out[j++] = (uint8_t)(((v2 & 0x03) << 6) | v3);
+    }
+    return (int)out_len;
+}
+
+static int ref_base64_encode(const uint8_t* data, size_t len, char* out, size_t max) {
+    static const char s_b64_enc[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    size_t out_len = ((len + 2) / 3) * 4;
+    if (out_len + 1 > max)
+        return -1;
+
+    size_t j = 0;
+    for (size_t i = 0; i < len; i += 3) {
+        uint8_t b0 = data[i];
+        uint8_t b1 = (i + 1 < len) ? data[i + 1] : 0;
+        uint8_t b2 = (i + 2 < len) ? data[i + 2] : 0;
+
+        out[j++] = s_b64_enc[b0 >> 2];
+        out[j++] = s_b64_enc[((b0 & 0x03) << 4) | (b1 >> 4)];
+        out[j++] = (i + 1 < len) ? s_b64_enc[((b1 & 0x0F) << 2) | (b2 >> 6)] : '=';
+        out[j++] = (i + 2 < len) ? s_b64_enc[b2 & 0x3F] : '=';
+    }
+    out[j] = '\0';
+    return (int)j;
+}
+
+/* ============================================================================
+ * Timing
+ * ============================================================================ */
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycle"
+static uint64_t bench_now(void) {
+    return __rdtsc();
+}
+#else
+#define BENCH_UNIT "ns"
+static uint64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+static volatile uint32_t s_sink;
+
+static uint8_t s_data[BENCH_BUF_SIZE];
+static char s_text[BENCH_BUF_SIZE / 3 * 4 + 8];
+static uint8_t s_decoded[BENCH_BUF_SIZE];
+
+typedef uint32_t (*bench_fn_t)(void);
+
+static uint32_t run_crc_ref(void) {
+    return ref_crc16_update(0xFFFF, s_data, sizeof(s_data));
+}
+
+static uint32_t run_crc_new(void) {
+    return fl_crc16_update(0xFFFF, s_data, sizeof(s_data));
+}
+
+static uint32_t run_crc32_ref(void) {
+    return ref_crc32_update(0, s_data, sizeof(s_data));
+}
+
+static uint32_t run_crc32_new(void) {
+    return fl_crc32_update(0, s_data, sizeof(s_data));
+}
+
+static uint32_t run_enc_ref(void) {
+    return (uint32_t)ref_base64_encode(s_data, sizeof(s_data), s_text, sizeof(s_text));
+}
+
+static uint32_t run_enc_new(void) {
+    return (uint32_t)fl_base64_encode(s_data, sizeof(s_data), s_text, sizeof(s_text));
+}
+
+static size_t s_text_len;
+
+static uint32_t run_dec_ref(void) {
+    return (uint32_t)ref_base64_decode(s_text, s_text_len, s_decoded, sizeof(s_decoded));
+}
+
+static uint32_t run_dec_new(void) {
+    return (uint32_t)fl_base64_decode(s_text, s_text_len, s_decoded, sizeof(s_decoded));
+}
+
+/* Best-of-N per-call cost, expressed in input bytes per time unit */
+static double bench(bench_fn_t fn, size_t bytes) {
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        uint64_t t0 = bench_now();
+        s_sink += fn();
+        uint64_t dt = bench_now() - t0;
+        if (dt < best)
+            best = dt;
+    }
+    return best ? (double)bytes / (double)best : 0.0;
+}
+
+static void report(const char* name, bench_fn_t ref, bench_fn_t cur, size_t bytes) {
+    double r = bench(ref, bytes);
+    double n = bench(cur, bytes);
+    printf("%-14s ref %6.3f B/%s   new %6.3f B/%s   x%.2f\n", name, r, BENCH_UNIT, n, BENCH_UNIT,
+           r > 0 ? n / r : 0.0);
+}
+
+/* ============================================================================
+ * Main
+ * ============================================================================ */
+
+static int verify(void) {
+    uint8_t ref_out[BENCH_BUF_SIZE];
+    char ref_text[sizeof(s_text)];
+
+    for (size_t len = 0; len <= 64; len++) {
+        for (size_t off = 0; off < 4; off++) {
+            if (ref_crc16_update(0xFFFF, s_data + off, len) != fl_crc16_update(0xFFFF, s_data + off, len) ||
+                ref_crc32_update(0, s_data + off, len) != fl_crc32_update(0, s_data + off, len)) {
+                printf("CRC mismatch: len=%zu off=%zu\n", len, off);
+                return -1;
+            }
+        }
+    }
+    if (run_crc_ref() != run_crc_new() || run_crc32_ref() != run_crc32_new()) {
+        printf("CRC mismatch on %d-byte buffer\n", BENCH_BUF_SIZE);
+        return -1;
+    }
+
+    for (size_t len = 1; len <= sizeof(s_data); len += (len < 64) ? 1 : 61) {
+        int n1 = ref_base64_encode(s_data, len, ref_text, sizeof(ref_text));
+        int n2 = fl_base64_encode(s_data, len, s_text, sizeof(s_text));
+        if (n1 != n2 || strcmp(ref_text, s_text) != 0) {
+            printf("Encode mismatch: len=%zu\n", len);
+            return -1;
+        }
+        int d1 = ref_base64_decode(s_text, (size_t)n2, ref_out, sizeof(ref_out));
+        int d2 = fl_base64_decode(s_text, (size_t)n2, s_decoded, sizeof(s_decoded));
+        if (d1 != d2 || d2 != (int)len || memcmp(ref_out, s_decoded, len) != 0) {
+            printf("Decode mismatch: len=%zu\n", len);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(void) {
+    ref_crc16_init();
+    ref_crc32_init();
+    ref_b64_init();
+
+    srand(12345);
+    for (size_t i = 0; i < sizeof(s_data); i++)
+        s_data[i] = (uint8_t)rand();
+
+    if (verify() != 0)
+        return 1;
+
+    s_text_len = (size_t)fl_base64_encode(s_data, sizeof(s_data), s_text, sizeof(s_text));
+
+    printf("fl_codec benchmark (%d-byte buffer, best of %d)\n", BENCH_BUF_SIZE, BENCH_ROUNDS);
+    report("crc16", run_crc_ref, run_crc_new, sizeof(s_data));
+    report("crc32", run_crc32_ref, run_crc32_new, sizeof(s_data));
+    report("base64 encode", run_enc_ref, run_enc_new, sizeof(s_data));
+    report("base64 decode", run_dec_ref, run_dec_new, s_text_len);
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 VIFEX
+ *
+ * Micro-benchmark for the DebugMonitor redirect handler - compares the
+ * direct-mapped lookup against the linear scan over every comparator it
+ * replaced. Host cycles only show the relative cost of the lookup: the
+ * exception entry/exit and DFSR accesses on target are not modelled.
+ *
+ * White-box: fpb_debugmon.c is included directly to reach its state.
+ */
+
+#include "../../Source/fpb_debugmon.c"
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_ROUNDS 20000
+#define BENCH_BATCH 64 /* Traps per timed run, to amortize the timer read */
+
+/* ============================================================================
+ * Reference handler (linear scan, as previously in fpb_debugmon.c)
+ * ============================================================================ */
+
+static void ref_handler(uint32_t* stack_frame) {
+    uint32_t dfsr = DFSR;
+    if (!(dfsr & DFSR_BKPT)) {
+        return;
+    }
+    DFSR = DFSR_BKPT;
+
+    uint32_t match_addr = stack_frame[STACK_PC] & ~1UL;
+    uint32_t redirect = 0;
+    for (uint8_t i = 0; i < g_debugmon_state.num_comp; i++) {
+        if (g_debugmon_state.redirects[i].original_addr == match_addr) {
+            redirect = g_debugmon_state.redirects[i].redirect_addr;
+            break;
+        }
+    }
+
+    if (redirect != 0) {
+        stack_frame[STACK_PC] = redirect;
+    }
+}
+
+/* ============================================================================
+ * Timing
+ * ============================================================================ */
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+static uint64_t bench_now(void) {
+    return __rdtsc();
+}
+#else
+#define BENCH_UNIT "ns"
+static uint64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+typedef void (*handler_fn_t)(uint32_t* stack_frame);
+
+/* Called through volatile pointers so neither handler is inlined into the loop */
+static handler_fn_t volatile s_ref = ref_handler;
+static handler_fn_t volatile s_new = fpb_debugmon_handler;
+
+#define BENCH_COMPS 8
+#define BENCH_ORIG(i) (0x08004000UL + (i)*0x120)
+#define BENCH_TARGET(i) (0x20008000UL + (i)*0x100)
+
+/* Best-of-N cost of one trap on the breakpoint of comparator comp */
+static uint64_t bench(handler_fn_t volatile* handler, uint8_t comp) {
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        uint64_t t0 = bench_now();
+        for (int b = 0; b < BENCH_BATCH; b++) {
+            uint32_t stack_frame[8] = {0, 0, 0, 0, 0, 0, BENCH_ORIG(comp), 0};
+            DFSR = DFSR_BKPT;
+            (*handler)(stack_frame);
+        }
+        uint64_t dt = bench_now() - t0;
+        if (dt < best)
+            best = dt;
+    }
+    return best / BENCH_BATCH;
+}
+
+/* ============================================================================
+ * Main
+ * ============================================================================ */
+
+static int verify(void) {
+    for (uint8_t i = 0; i < BENCH_COMPS; i++) {
+        uint32_t ref[8] = {0, 0, 0, 0, 0, 0, BENCH_ORIG(i), 0};
+        uint32_t cur[8] = {0, 0, 0, 0, 0, 0, BENCH_ORIG(i), 0};
+        DFSR = DFSR_BKPT;
+        ref_handler(ref);
+        DFSR = DFSR_BKPT;
+        fpb_debugmon_handler(cur);
+        if (ref[STACK_PC] != (BENCH_TARGET(i) | 1) || cur[STACK_PC] != ref[STACK_PC]) {
+            printf("Redirect mismatch: comp %u\n", i);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(void) {
+    fpb_mock_configure(BENCH_COMPS, 2);
+    if (fpb_debugmon_init() != 0) {
+        printf("fpb_debugmon_init failed\n");
+        return 1;
+    }
+    for (uint8_t i = 0; i < BENCH_COMPS; i++) {
+        fpb_debugmon_set_redirect(i, BENCH_ORIG(i), BENCH_TARGET(i));
+    }
+    if (verify() != 0)
+        return 1;
+
+    printf("fpb_debugmon handler benchmark (best of %d, %s per trap, %d redirects)\n", BENCH_ROUNDS, BENCH_UNIT,
+           BENCH_COMPS);
+    for (uint8_t i = 0; i < BENCH_COMPS; i++) {
+        uint64_t r = bench(&s_ref, i);
+        uint64_t n = bench(&s_new, i);
+        printf("comp %u   ref %6llu   new %6llu   x%.2f\n", i, (unsigned long long)r, (unsigned long long)n,
+               n ? (double)r / (double)n : 0.0);
+    }
+
+    fpb_debugmon_deinit();
+    return 0;
+}
@@ -24,6 +24,17 @@ uint32_t mock_dhcsr = 0;
 uint32_t mock_demcr = 0;
 uint32_t mock_dfsr = 0;
 
+/* Mock DWT registers */
+uint32_t mock_dwt_ctrl = 0;
+uint32_t mock_dwt_cyccnt = 0;
+uint32_t mock_dwt_comp[16] = {0};
+uint32_t mock_dwt_mask[16] = {0};
+uint32_t mock_dwt_function[16] = {0};
+
+/* Memory barrier counters */
+uint32_t mock_dsb_count = 0;
+uint32_t mock_isb_count = 0;
+
 /* Combined register that the code reads/writes */
 static uint32_t mock_fpb_ctrl_combined = 0;
 
@@ -58,6 +69,13 @@ void fpb_mock_reset(void) {
     mock_dhcsr = 0;
     mock_demcr = 0;
     mock_dfsr = 0;
+    mock_dwt_ctrl = 0;
+    mock_dwt_cyccnt = 0;
+    memset(mock_dwt_comp, 0, sizeof(mock_dwt_comp));
+    memset(mock_dwt_mask, 0, sizeof(mock_dwt_mask));
+    memset(mock_dwt_function, 0, sizeof(mock_dwt_function));
+    mock_dsb_count = 0;
+    mock_isb_count = 0;
 }
 
 void fpb_mock_configure(uint8_t num_code, uint8_t num_lit) {
@@ -72,6 +90,15 @@ void fpb_mock_configure(uint8_t num_code, uint8_t num_lit) {
     mock_fpb_remap = (1UL << 29);
 }
 
+void fpb_mock_configure_dwt(uint8_t num_comp) {
+    /* DWT_CTRL.NUMCOMP, bits [31:28] */
+    mock_dwt_ctrl = (mock_dwt_ctrl & 0x0FFFFFFFUL) | ((uint32_t)num_comp << 28);
+}
+
+uint32_t fpb_mock_code_word(uint32_t addr) {
+    return (addr & 0xFFFFUL) | (((addr + 2) & 0xFFFFUL) << 16);
+}
+
 void fpb_mock_set_dfsr(uint32_t value) {
     mock_dfsr = value;
 }
@@ -54,21 +54,38 @@ extern uint32_t mock_dhcsr;
 extern uint32_t mock_demcr;
 extern uint32_t mock_dfsr;
 
+/* Mock DWT registers for trampoline cycle accounting and debugmon redirects */
+extern uint32_t mock_dwt_ctrl;
+extern uint32_t mock_dwt_cyccnt;
+extern uint32_t mock_dwt_comp[16];
+extern uint32_t mock_dwt_mask[16];
+extern uint32_t mock_dwt_function[16];
+
+/* Code region reads: each halfword reads as the low 16 bits of its own address */
+uint32_t fpb_mock_code_word(uint32_t addr);
+
 /* Override memory barrier instructions (no-op on host) */
 #undef dsb
 #undef isb
 
+/* Barrier counters - defined in fpb_mock_regs.c, cleared by fpb_mock_reset() */
+extern uint32_t mock_dsb_count;
+extern uint32_t mock_isb_count;
+
 static inline void dsb(void) {
-    /* No-op on host */
+    /* No-op on host, counted */
+    mock_dsb_count++;
 }
 
 static inline void isb(void) {
-    /* No-op on host */
+    /* No-op on host, counted */
+    mock_isb_count++;
 }
 
 /* Mock control functions */
 void fpb_mock_reset(void);
 void fpb_mock_configure(uint8_t num_code, uint8_t num_lit);
+void fpb_mock_configure_dwt(uint8_t num_comp);
 
 /* Mock debug register control */
 void fpb_mock_set_dfsr(uint32_t value);
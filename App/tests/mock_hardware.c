@@ -78,6 +78,15 @@ void mock_serial_set_input(const char* data) {
     g_mock_serial.rx_pos = 0;
 }
 
+void mock_serial_set_input_bin(const uint8_t* data, size_t len) {
+    if (len > MOCK_SERIAL_BUF_SIZE) {
+        len = MOCK_SERIAL_BUF_SIZE;
+    }
+    memcpy(g_mock_serial.rx_buffer, data, len);
+    g_mock_serial.rx_len = len;
+    g_mock_serial.rx_pos = 0;
+}
+
 int mock_serial_read(uint8_t* buf, size_t len) {
     size_t available = g_mock_serial.rx_len - g_mock_serial.rx_pos;
     if (available == 0)
@@ -89,8 +98,23 @@ int mock_serial_read(uint8_t* buf, size_t len) {
     return (int)len;
 }
 
+const uint8_t* mock_serial_peek(size_t* len) {
+    *len = g_mock_serial.rx_len - g_mock_serial.rx_pos;
+    if (g_mock_serial.span_max && *len > g_mock_serial.span_max)
+        *len = g_mock_serial.span_max;
+    return (const uint8_t*)g_mock_serial.rx_buffer + g_mock_serial.rx_pos;
+}
+
+void mock_serial_consume(size_t len) {
+    g_mock_serial.rx_pos += len;
+}
+
 int mock_serial_write(const uint8_t* buf, size_t len) {
     size_t space = MOCK_SERIAL_BUF_SIZE - g_mock_serial.tx_len - 1;
+    if (g_mock_serial.tx_busy)
+        return 0;
+    if (g_mock_serial.tx_max && len > g_mock_serial.tx_max)
+        len = g_mock_serial.tx_max;
     if (len > space)
         len = space;
     memcpy(g_mock_serial.tx_buffer + g_mock_serial.tx_len, buf, len);
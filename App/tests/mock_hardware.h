@@ -77,13 +77,19 @@ typedef struct {
     size_t rx_len;
     char tx_buffer[MOCK_SERIAL_BUF_SIZE];
     size_t tx_len;
+    size_t span_max; /* mock_serial_peek span limit, 0 = all pending (models a ring wrap) */
+    size_t tx_max;   /* mock_serial_write limit per call, 0 = no limit */
+    bool tx_busy;    /* mock_serial_write accepts nothing (models a full TX FIFO) */
 } mock_serial_t;
 
 extern mock_serial_t g_mock_serial;
 
 void mock_serial_reset(void);
 void mock_serial_set_input(const char* data);
+void mock_serial_set_input_bin(const uint8_t* data, size_t len);
 int mock_serial_read(uint8_t* buf, size_t len);
+const uint8_t* mock_serial_peek(size_t* len);
+void mock_serial_consume(size_t len);
 int mock_serial_write(const uint8_t* buf, size_t len);
 int mock_serial_available(void);
 const char* mock_serial_get_output(void);
@@ -13,6 +13,11 @@
 #include "mock_hardware.h"
 #include "fpb_mock_regs.h"
 #include "fl.h"
+#include "fl_frame.h"
+#include "fl_log.h"
+#include "fpb_inject.h"
+#include "fpb_trampoline.h"
+#include "fpb_debugmon.h"
 #include <unistd.h>
 #include <sys/stat.h>
 
@@ -105,6 +110,8 @@ void test_loader_cmd_help(void) {
     /* --help prints usage but still requires --cmd, so returns -1 */
     /* Output should contain help text */
     TEST_ASSERT_EQUAL(-1, result);
+    TEST_ASSERT(mock_output_contains("-a, --addr"));
+    TEST_ASSERT(mock_output_contains("Missing --cmd"));
 }
 
 void test_loader_cmd_info(void) {
@@ -137,6 +144,87 @@ void test_loader_cmd_empty(void) {
     TEST_ASSERT_EQUAL(-1, result);
 }
 
+void test_loader_cmd_lookup_all(void) {
+    /* Every table entry must be reachable (the table is binary searched) */
+    static const char* const names[] = {
+        "abort",     "alloc",  "batch",   "commit", "dpatch", "dump",   "echo",    "echoback", "enable",
+        "fclose",    "fcrc",   "flist",   "fmkdir", "fopen",  "fread",  "fremove", "frename",  "fseek",
+        "fstat",     "fwrite", "hash",    "hello",  "info",   "ipatch", "memcmp",  "memcpy",   "memcrc",
+        "memfind",   "memset", "patch",   "ping",   "prof",   "read",   "readv",   "retarget", "sample",
+        "slotstats", "tpatch", "unpatch", "upload", "write",
+    };
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        setup_loader();
+        fl_init(&test_ctx);
+        const char* argv[] = {"fl", "--cmd", names[i]};
+        fl_exec_cmd(&test_ctx, 3, argv);
+        TEST_ASSERT(!mock_output_contains("Unknown:"));
+    }
+}
+
+void test_loader_cmd_option_forms(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* --name=value */
+    const char* argv1[] = {"fl", "--cmd=alloc", "--size=48"};
+    TEST_ASSERT_EQUAL(0, fl_exec_cmd(&test_ctx, 3, argv1));
+    TEST_ASSERT_EQUAL(48, test_ctx.last_alloc_size);
+
+    /* -xvalue */
+    const char* argv2[] = {"fl", "-calloc", "-s96"};
+    TEST_ASSERT_EQUAL(0, fl_exec_cmd(&test_ctx, 3, argv2));
+    TEST_ASSERT_EQUAL(96, test_ctx.last_alloc_size);
+}
+
+void test_loader_cmd_invalid_option(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    const char* argv1[] = {"fl", "--cmd", "ping", "--bogus"};
+    TEST_ASSERT_EQUAL(-1, fl_exec_cmd(&test_ctx, 4, argv1));
+    TEST_ASSERT(mock_output_contains("Invalid argument: --bogus"));
+
+    /* Long option prefixes are not abbreviations */
+    mock_output_reset();
+    const char* argv2[] = {"fl", "--cmd", "read", "--ad", "0x1000"};
+    TEST_ASSERT_EQUAL(-1, fl_exec_cmd(&test_ctx, 5, argv2));
+    TEST_ASSERT(mock_output_contains("Invalid argument: --ad"));
+
+    /* Positional arguments are rejected */
+    mock_output_reset();
+    const char* argv3[] = {"fl", "--cmd", "ping", "extra"};
+    TEST_ASSERT_EQUAL(-1, fl_exec_cmd(&test_ctx, 4, argv3));
+    TEST_ASSERT(mock_output_contains("Invalid argument: extra"));
+
+    /* Flags take no value */
+    mock_output_reset();
+    const char* argv4[] = {"fl", "--cmd", "unpatch", "--all=1"};
+    TEST_ASSERT_EQUAL(-1, fl_exec_cmd(&test_ctx, 4, argv4));
+    TEST_ASSERT(mock_output_contains("Invalid argument: --all=1"));
+
+    /* A trailing option needs its value */
+    mock_output_reset();
+    const char* argv5[] = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x08001000", "--target"};
+    TEST_ASSERT_EQUAL(-1, fl_exec_cmd(&test_ctx, 8, argv5));
+    TEST_ASSERT(mock_output_contains("[FLERR] Missing value for --target"));
+}
+
+void test_loader_cmd_invalid_number(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    const char* argv1[] = {"fl", "--cmd", "read", "--len", "16x"};
+    TEST_ASSERT_EQUAL(-1, fl_exec_cmd(&test_ctx, 5, argv1));
+    TEST_ASSERT(mock_output_contains("Invalid --len: 16x"));
+
+    mock_output_reset();
+    const char* argv2[] = {"fl", "--cmd", "read", "-a", "zz"};
+    TEST_ASSERT_EQUAL(-1, fl_exec_cmd(&test_ctx, 5, argv2));
+    TEST_ASSERT(mock_output_contains("Invalid --addr: zz"));
+}
+
 /* ============================================================================
  * fl_exec_cmd Tests - Slot Commands
  * ============================================================================ */
@@ -373,6 +461,35 @@ void test_loader_cmd_upload_with_data(void) {
     TEST_ASSERT_EQUAL(0, result);
 }
 
+void test_loader_cmd_upload_out_of_bounds(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uint8_t* code = (uint8_t*)test_ctx.last_alloc;
+    memset(code, 0, 64);
+
+    /* 4 bytes at offset 62 would run past the 64-byte allocation */
+    mock_output_reset();
+    const char* argv[] = {"fl", "--cmd", "upload", "--addr", "62", "--data", "AQIDBA=="};
+    fl_exec_cmd(&test_ctx, 7, argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] Upload exceeds allocation"));
+    TEST_ASSERT_EQUAL(0, code[62]);
+
+    mock_output_reset();
+    const char* far_argv[] = {"fl", "--cmd", "upload", "--addr", "0x10000", "--data", "AQIDBA=="};
+    fl_exec_cmd(&test_ctx, 7, far_argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] Upload exceeds allocation"));
+
+    /* The last 4 bytes still fit */
+    mock_output_reset();
+    const char* tail_argv[] = {"fl", "--cmd", "upload", "--addr", "60", "--data", "AQIDBA=="};
+    fl_exec_cmd(&test_ctx, 7, tail_argv);
+    TEST_ASSERT(mock_output_contains("[FLOK]"));
+    TEST_ASSERT_EQUAL(4, code[63]);
+}
+
 /* ============================================================================
  * Slot State Tests
  * ============================================================================ */
@@ -390,7 +507,7 @@ void test_loader_slot_state_initial(void) {
 }
 
 void test_loader_max_slots(void) {
-    TEST_ASSERT_EQUAL(8, FL_MAX_SLOTS); /* FPB v2 supports 8 slots */
+    TEST_ASSERT_EQUAL(12, FL_MAX_SLOTS); /* FPB v2: 8 slots, plus 4 DWT redirects */
 }
 
 /* ============================================================================
@@ -696,6 +813,104 @@ void test_loader_cmd_fcrc_no_file(void) {
     TEST_ASSERT(mock_output_contains("FLERR") || mock_output_contains("No file"));
 }
 
+/* Read a whole file into out, -1 on error */
+static long read_file(const char* path, uint8_t* out, size_t max) {
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return -1;
+    long n = (long)fread(out, 1, max, f);
+    fclose(f);
+    return n;
+}
+
+void test_loader_cmd_dump(void) {
+    setup_loader_with_file();
+
+    /* Half a compressible ramp, half pseudo-random: both record kinds with --z */
+    static uint8_t mem[3 * FL_DUMP_BLOCK_SIZE + 100];
+    for (size_t i = 0; i < sizeof(mem); i++)
+        mem[i] = i < sizeof(mem) / 2 ? (uint8_t)(i % 16) : (uint8_t)((i * 2654435761u) >> 13);
+
+    char path[64], addr[24], len[16], expect[96];
+    snprintf(path, sizeof(path), "/tmp/fl_test_dump_%d.bin", getpid());
+    snprintf(addr, sizeof(addr), "0x%lX", (unsigned long)(uintptr_t)mem);
+    snprintf(len, sizeof(len), "%u", (unsigned)sizeof(mem));
+    uint32_t crc = fl_crc32_update(0, mem, sizeof(mem));
+
+    /* An open transfer file is left alone */
+    char other[64];
+    snprintf(other, sizeof(other), "/tmp/fl_test_dump_other_%d.txt", getpid());
+    const char* open_argv[] = {"fl", "--cmd", "fopen", "--path", other, "--mode", "w"};
+    fl_exec_cmd(&test_ctx, 7, open_argv);
+
+    static uint8_t file[2 * sizeof(mem)];
+    const char* argv[] = {"fl", "--cmd", "dump", "--addr", addr, "--len", len, "--path", path, "--z"};
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 9, argv);
+    snprintf(expect, sizeof(expect), "[FLOK] DUMP 0x%08lX len=%u crc=0x%08lX size=%u path=",
+             (unsigned long)(uintptr_t)mem, (unsigned)sizeof(mem), (unsigned long)crc, (unsigned)sizeof(mem));
+    TEST_ASSERT(mock_output_contains(expect));
+    TEST_ASSERT_EQUAL(sizeof(mem), read_file(path, file, sizeof(file)));
+    TEST_ASSERT_EQUAL_MEMORY(mem, file, sizeof(mem));
+    TEST_ASSERT(test_ctx.file_ctx.fp != NULL);
+
+    /* --z: raw_len(2B) + stored_len(2B) + LZ block, or raw data if it did not shrink */
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 10, argv);
+    TEST_ASSERT(mock_output_contains(" z path="));
+    long size = read_file(path, file, sizeof(file));
+    TEST_ASSERT(size > 0 && size < (long)sizeof(mem));
+
+    static uint8_t out[sizeof(mem)];
+    size_t pos = 0, total = 0;
+    int stored = 0, packed = 0;
+    while (pos + 4 <= (size_t)size) {
+        size_t raw = file[pos] | (file[pos + 1] << 8);
+        size_t n = file[pos + 2] | (file[pos + 3] << 8);
+        pos += 4;
+        if (n == raw) {
+            memcpy(out + total, file + pos, n);
+            stored++;
+        } else {
+            TEST_ASSERT_EQUAL(raw, (size_t)fl_lz_decompress(file + pos, n, out + total, sizeof(out) - total));
+            packed++;
+        }
+        pos += n;
+        total += raw;
+    }
+    TEST_ASSERT_EQUAL((size_t)size, pos);
+    TEST_ASSERT_EQUAL(sizeof(mem), total);
+    TEST_ASSERT_EQUAL_MEMORY(mem, out, sizeof(mem));
+    TEST_ASSERT(stored > 0 && packed > 0);
+
+    mock_output_reset();
+    const char* no_path[] = {"fl", "--cmd", "dump", "--addr", addr, "--len", len};
+    fl_exec_cmd(&test_ctx, 7, no_path);
+    TEST_ASSERT(mock_output_contains("[FLERR] Missing path"));
+
+    const char* close_argv[] = {"fl", "--cmd", "fclose"};
+    fl_exec_cmd(&test_ctx, 3, close_argv);
+    unlink(path);
+    unlink(other);
+}
+
+void test_loader_cmd_dump_no_fs(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+    const char* argv[] = {"fl", "--cmd", "dump", "--addr", "0x1000", "--len", "4", "--path", "/tmp/x"};
+    fl_exec_cmd(&test_ctx, 9, argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] File context not initialized"));
+
+    /* The capability follows the filesystem */
+    mock_output_reset();
+    const char* ping[] = {"fl", "--cmd", "ping"};
+    fl_exec_cmd(&test_ctx, 3, ping);
+    TEST_ASSERT(!mock_output_contains("caps=0x0002B"));
+    setup_loader_with_file();
+    fl_exec_cmd(&test_ctx, 3, ping);
+    TEST_ASSERT(mock_output_contains("PONG caps=0x0002BFFA"));
+}
+
 void test_loader_cmd_flist(void) {
     setup_loader_with_file();
 
@@ -747,757 +962,2505 @@ void test_loader_cmd_upload_with_crc(void) {
     TEST_ASSERT(output != NULL);
 }
 
-void test_loader_cmd_tpatch_valid(void) {
+void test_loader_cmd_upload_ack_offset(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Allocate memory first */
     const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
     fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uintptr_t alloc_addr = test_ctx.last_alloc;
 
+    /* Corrupted chunk: error names the offset and keeps the allocation */
     mock_output_reset();
+    const char* bad_argv[] = {"fl", "--cmd", "upload", "--addr", "0x10", "--data", "AQIDBA==", "--crc", "0x0000"};
+    fl_exec_cmd(&test_ctx, 9, bad_argv);
+    TEST_ASSERT(mock_output_contains("CRC mismatch off=0x10"));
+    TEST_ASSERT_EQUAL(alloc_addr, test_ctx.last_alloc);
+
+    /* Retransmitted chunk lands in the same allocation and is acked by offset */
+    const uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+    uint32_t hdr[2] = {0x10, sizeof(data)};
+    uint16_t crc = fl_crc16_update(0xFFFF, hdr, sizeof(hdr));
+    crc = fl_crc16_update(crc, data, sizeof(data));
+    char crc_str[16];
+    snprintf(crc_str, sizeof(crc_str), "0x%04X", crc);
 
-    /* Try tpatch - may be disabled with FPB_NO_TRAMPOLINE */
-    const char* argv[] = {"fl", "--cmd", "tpatch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20002000"};
+    mock_output_reset();
+    const char* argv[] = {"fl", "--cmd", "upload", "--addr", "0x10", "--data", "AQIDBA==", "--crc", crc_str};
     fl_exec_cmd(&test_ctx, 9, argv);
-
-    /* Should either succeed or say trampoline disabled */
-    const char* output = mock_output_get();
-    TEST_ASSERT(output != NULL);
+    TEST_ASSERT(mock_output_contains("Uploaded 4 bytes off=0x10"));
+    TEST_ASSERT_EQUAL_MEMORY(data, (uint8_t*)alloc_addr + 0x10, sizeof(data));
 }
 
-void test_loader_cmd_dpatch_valid(void) {
+void test_loader_cmd_ping_caps(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Allocate memory first */
-    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
-    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    const char* argv[] = {"fl", "--cmd", "ping"};
+    fl_exec_cmd(&test_ctx, 3, argv);
+    TEST_ASSERT(mock_output_contains("PONG caps=0x0002AFFA"));
 
+    /* retarget follows grace periods */
     mock_output_reset();
-
-    /* Try dpatch - may be disabled with FPB_NO_DEBUGMON */
-    const char* argv[] = {"fl", "--cmd", "dpatch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20002000"};
-    fl_exec_cmd(&test_ctx, 9, argv);
-
-    /* Should either succeed or say debugmon disabled */
-    const char* output = mock_output_get();
-    TEST_ASSERT(output != NULL);
+    test_ctx.grace_free = true;
+    fl_exec_cmd(&test_ctx, 3, argv);
+    TEST_ASSERT(mock_output_contains("PONG caps=0x0003AFFA"));
 }
 
-void test_loader_cmd_run(void) {
+void test_loader_cmd_upload_crc32(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Allocate memory first */
     const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
     fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uintptr_t alloc_addr = test_ctx.last_alloc;
+
+    /* CRC-32 covers offset + len + data, like the CRC-16 */
+    const uint8_t data[] = {0x01, 0x02, 0x03, 0x04};
+    uint32_t hdr[2] = {0x10, sizeof(data)};
+    uint32_t crc = fl_crc32_update(0, hdr, sizeof(hdr));
+    crc = fl_crc32_update(crc, data, sizeof(data));
+    char crc_str[16];
+    snprintf(crc_str, sizeof(crc_str), "0x%08lX", (unsigned long)crc);
 
     mock_output_reset();
+    const char* argv[] = {"fl",     "--cmd",    "upload", "--addr", "0x10", "--data",
+                          "AQIDBA==", "--crc32", "--crc", crc_str};
+    fl_exec_cmd(&test_ctx, 10, argv);
+    TEST_ASSERT(mock_output_contains("Uploaded 4 bytes off=0x10"));
+    TEST_ASSERT_EQUAL_MEMORY(data, (uint8_t*)alloc_addr + 0x10, sizeof(data));
 
-    /* Try run command */
-    const char* argv[] = {"fl", "--cmd", "run", "--entry", "0"};
-    fl_exec_cmd(&test_ctx, 5, argv);
+    /* Same value checked as a CRC-16 fails, mismatch is printed with 8 digits in CRC-32 mode */
+    mock_output_reset();
+    const char* argv16[] = {"fl", "--cmd", "upload", "--addr", "0x10", "--data", "AQIDBA==", "--crc", crc_str};
+    fl_exec_cmd(&test_ctx, 9, argv16);
+    TEST_ASSERT(mock_output_contains("CRC mismatch off=0x10"));
 
-    /* May fail due to no valid code, but shouldn't crash */
-    const char* output = mock_output_get();
-    TEST_ASSERT(output != NULL);
+    mock_output_reset();
+    const char* bad_argv[] = {"fl",     "--cmd",    "upload", "--addr",    "0x10", "--data",
+                              "AQIDBA==", "--crc32", "--crc", "0xFFFFFFFF"};
+    fl_exec_cmd(&test_ctx, 10, bad_argv);
+    TEST_ASSERT(mock_output_contains("CRC mismatch off=0x10: 0xFFFFFFFF != 0x"));
 }
 
-void test_loader_cmd_read(void) {
+void test_loader_cmd_read_crc32(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Allocate memory first */
-    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
-    fl_exec_cmd(&test_ctx, 5, alloc_argv);
-
-    /* Write known data to allocated memory */
-    uintptr_t alloc_addr = test_ctx.last_alloc;
-    uint8_t* ptr = (uint8_t*)alloc_addr;
-    for (int i = 0; i < 16; i++) {
-        ptr[i] = (uint8_t)(0xA0 + i);
-    }
-
-    mock_output_reset();
+    static uint8_t src[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint32_t hdr[2] = {(uint32_t)(uintptr_t)src, sizeof(src)};
+    uint32_t req_crc = fl_crc32_update(0, hdr, sizeof(hdr));
+    uint32_t resp_crc = fl_crc32_update(req_crc, src, sizeof(src));
 
-    /* Read back via read command */
-    char addr_str[32];
-    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)alloc_addr);
-    const char* argv[] = {"fl", "--cmd", "read", "--addr", addr_str, "--len", "16"};
-    fl_exec_cmd(&test_ctx, 7, argv);
+    char addr_str[32], crc_str[16], expect[48];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)(uintptr_t)src);
+    snprintf(crc_str, sizeof(crc_str), "0x%lX", (unsigned long)req_crc);
+    snprintf(expect, sizeof(expect), "READ 8 bytes crc=0x%08lX", (unsigned long)resp_crc);
 
-    /* Should return FLOK with base64 data and CRC */
-    const char* output = mock_output_get();
-    TEST_ASSERT(output != NULL);
-    TEST_ASSERT(mock_output_contains("FLOK"));
-    TEST_ASSERT(mock_output_contains("READ 16 bytes"));
-    TEST_ASSERT(mock_output_contains("crc=0x"));
-    TEST_ASSERT(mock_output_contains("data="));
+    const char* argv[] = {"fl", "--cmd", "read", "--addr", addr_str, "--len", "8", "--force", "--crc32", "--crc",
+                          crc_str};
+    fl_exec_cmd(&test_ctx, 11, argv);
+    TEST_ASSERT(mock_output_contains(expect));
 }
 
-void test_loader_cmd_upload_invalid_data(void) {
+void test_loader_cmd_readv(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Allocate memory first */
-    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
-    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    static uint8_t mem[64];
+    for (size_t i = 0; i < sizeof(mem); i++)
+        mem[i] = (uint8_t)(0x40 + i);
 
-    mock_output_reset();
+    /* (gap, len) varints: [0, 2), [10, 16), [40, 44), gathered back to back */
+    uint8_t list[] = {0, 2, 8, 6, 24, 4};
+    const uint8_t gathered[12] = {0x40, 0x41, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F, 0x68, 0x69, 0x6A, 0x6B};
 
-    /* Upload invalid data (not valid hex or base64) */
-    const char* argv[] = {"fl", "--cmd", "upload", "--addr", "0", "--data", "ZZZZ!!!"};
-    fl_exec_cmd(&test_ctx, 7, argv);
+    uint32_t hdr[2] = {(uint32_t)(uintptr_t)mem, sizeof(list)};
+    uint32_t req_crc = fl_crc32_update(fl_crc32_update(0, hdr, sizeof(hdr)), list, sizeof(list));
+    uint32_t resp_crc = fl_crc32_update(req_crc, gathered, sizeof(gathered));
 
-    /* Should fail with invalid encoding error */
-    TEST_ASSERT(mock_output_contains("FLERR") || mock_output_contains("Invalid"));
+    char addr_str[32], list_b64[16], data_b64[24], crc_str[16], expect[96];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)(uintptr_t)mem);
+    fl_base64_encode(list, sizeof(list), list_b64, sizeof(list_b64));
+    fl_base64_encode(gathered, sizeof(gathered), data_b64, sizeof(data_b64));
+    snprintf(crc_str, sizeof(crc_str), "0x%lX", (unsigned long)req_crc);
+    snprintf(expect, sizeof(expect), "[FLOK] READV 3 ranges 12 bytes crc=0x%08lX data=%s", (unsigned long)resp_crc,
+             data_b64);
+
+    const char* argv[] = {"fl",   "--cmd",  "readv",   "--addr", addr_str, "--data",
+                          list_b64, "--force", "--crc32", "--crc", crc_str};
+    fl_exec_cmd(&test_ctx, 11, argv);
+    TEST_ASSERT(mock_output_contains(expect));
+
+    /* A request CRC over another list is rejected */
+    list[0] = 1;
+    fl_base64_encode(list, sizeof(list), list_b64, sizeof(list_b64));
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 11, argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] Request CRC mismatch"));
 }
 
-void test_loader_cmd_fwrite_hex_data(void) {
-    setup_loader_with_file();
+void test_loader_cmd_readv_invalid(void) {
+    setup_loader();
+    fl_init(&test_ctx);
 
-    char test_file[256];
-    snprintf(test_file, sizeof(test_file), "/tmp/fl_test_fwrite_hex_%d.txt", getpid());
+    static uint8_t mem[16];
+    char addr_str[32], list_b64[16];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)(uintptr_t)mem);
+    const char* argv[] = {"fl", "--cmd", "readv", "--addr", addr_str, "--data", list_b64, "--force"};
 
-    /* Open file */
-    const char* open_argv[] = {"fl", "--cmd", "fopen", "--path", test_file, "--mode", "w"};
-    fl_exec_cmd(&test_ctx, 7, open_argv);
+    /* Truncated varint */
+    const uint8_t truncated[] = {0, 0x80};
+    fl_base64_encode(truncated, sizeof(truncated), list_b64, sizeof(list_b64));
+    fl_exec_cmd(&test_ctx, 8, argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] Invalid range list"));
 
+    /* The ranges together must fit the transfer buffer */
+    const uint8_t oversized[] = {0, (uint8_t)(0x80 | (FL_BUF_SIZE & 0x7F)), (uint8_t)(FL_BUF_SIZE >> 7), 0, 1};
+    fl_base64_encode(oversized, sizeof(oversized), list_b64, sizeof(list_b64));
     mock_output_reset();
+    fl_exec_cmd(&test_ctx, 8, argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] Invalid length of range 1"));
 
-    /* Write base64 data (SGVsbG8= = "Hello") */
-    const char* argv[] = {"fl", "--cmd", "fwrite", "--data", "SGVsbG8="};
-    fl_exec_cmd(&test_ctx, 5, argv);
+    mock_output_reset();
+    TEST_ASSERT_EQUAL(-1, fl_exec_cmd(&test_ctx, 5, argv));
+    TEST_ASSERT(mock_output_contains("Missing --data"));
+}
+
+/* read --stream output, decoded line by line (too long for the mock output buffer) */
+static struct {
+    char line[FL_B64_BUF_SIZE];
+    size_t line_len;
+    uint8_t data[FL_READ_SYNC_SIZE + 1000];
+    size_t len;
+    uint32_t sync_off[4];
+    uint32_t sync_crc[4];
+    int syncs;
+    int end;
+} s_stream;
+
+static void stream_line(const char* line) {
+    unsigned long off, crc;
+    if (sscanf(line, "SYNC %lu crc=0x%lx", &off, &crc) == 2) {
+        s_stream.sync_off[s_stream.syncs & 3] = (uint32_t)off;
+        s_stream.sync_crc[s_stream.syncs & 3] = (uint32_t)crc;
+        s_stream.syncs++;
+    } else if (strcmp(line, "[FLEND]") == 0) {
+        s_stream.end = 1;
+    } else if (line[0] != '[') {
+        int n = fl_base64_decode(line, strlen(line), s_stream.data + s_stream.len,
+                                 sizeof(s_stream.data) - s_stream.len);
+        if (n > 0)
+            s_stream.len += (size_t)n;
+    }
+}
 
-    TEST_ASSERT(mock_output_contains("FWRITE") || mock_output_contains("FLOK"));
+static void stream_output_cb(void* user, const char* str) {
+    mock_output_cb(user, str);
+    for (; *str; str++) {
+        if (*str == '\n') {
+            s_stream.line[s_stream.line_len] = '\0';
+            stream_line(s_stream.line);
+            s_stream.line_len = 0;
+        } else if (s_stream.line_len < sizeof(s_stream.line) - 1) {
+            s_stream.line[s_stream.line_len++] = *str;
+        }
+    }
+}
 
-    /* Close file */
-    const char* close_argv[] = {"fl", "--cmd", "fclose"};
-    fl_exec_cmd(&test_ctx, 3, close_argv);
+static void stream_output_data_cb(void* user, const uint8_t* data, size_t len) {
+    (void)user;
+    memcpy(s_stream.data + s_stream.len, data, len);
+    s_stream.len += len;
+}
 
-    /* Cleanup */
-    unlink(test_file);
+static uint32_t s_stream_yields;
+
+static void stream_yield(void) {
+    s_stream_yields++;
 }
 
-void test_loader_cmd_fwrite_with_crc(void) {
-    setup_loader_with_file();
+void test_loader_cmd_read_stream(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+    fl_log_init(stream_output_cb, NULL);
+    test_ctx.yield_cb = stream_yield;
+    memset(&s_stream, 0, sizeof(s_stream));
+    s_stream_yields = 0;
 
-    char test_file[256];
-    snprintf(test_file, sizeof(test_file), "/tmp/fl_test_fwrite_crc_%d.txt", getpid());
+    /* Longer than the transfer buffer and past one SYNC interval */
+    static uint8_t mem[FL_READ_SYNC_SIZE + 1000];
+    for (size_t i = 0; i < sizeof(mem); i++)
+        mem[i] = (uint8_t)(i * 13 + (i >> 8));
+    uint32_t hdr[2] = {(uint32_t)(uintptr_t)mem, sizeof(mem)};
+    uint32_t req_crc = fl_crc32_update(0, hdr, sizeof(hdr));
 
-    /* Open file */
-    const char* open_argv[] = {"fl", "--cmd", "fopen", "--path", test_file, "--mode", "w"};
-    fl_exec_cmd(&test_ctx, 7, open_argv);
+    char addr_str[32], len_str[16], crc_str[16], expect[48];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)(uintptr_t)mem);
+    snprintf(len_str, sizeof(len_str), "%u", (unsigned)sizeof(mem));
+    snprintf(crc_str, sizeof(crc_str), "0x%lX", (unsigned long)req_crc);
+    snprintf(expect, sizeof(expect), "[FLOK] READ %u bytes stream\n", (unsigned)sizeof(mem));
 
-    mock_output_reset();
+    const char* argv[] = {"fl",      "--cmd",   "read",  "--addr", addr_str, "--len",
+                          len_str, "--stream", "--crc32", "--crc", crc_str};
+    fl_exec_cmd(&test_ctx, 11, argv);
+    TEST_ASSERT(strncmp(mock_output_get(), expect, strlen(expect)) == 0);
+    TEST_ASSERT_EQUAL(1, s_stream.end);
+    TEST_ASSERT_EQUAL(sizeof(mem), s_stream.len);
+    TEST_ASSERT_EQUAL_MEMORY(mem, s_stream.data, sizeof(mem));
 
-    /* Write data with CRC (SGVsbG8= = "Hello") */
-    const char* argv[] = {"fl", "--cmd", "fwrite", "--data", "SGVsbG8=", "--crc", "0x1234"};
-    fl_exec_cmd(&test_ctx, 7, argv);
+    /* One SYNC past the interval, one at the end; each CRC rolls on from the request CRC */
+    TEST_ASSERT_EQUAL(2, s_stream.syncs);
+    TEST_ASSERT(s_stream.sync_off[0] >= FL_READ_SYNC_SIZE && s_stream.sync_off[0] < sizeof(mem));
+    TEST_ASSERT_EQUAL(fl_crc32_update(req_crc, mem, s_stream.sync_off[0]), s_stream.sync_crc[0]);
+    TEST_ASSERT_EQUAL(sizeof(mem), s_stream.sync_off[1]);
+    TEST_ASSERT_EQUAL(fl_crc32_update(req_crc, mem, sizeof(mem)), s_stream.sync_crc[1]);
+    TEST_ASSERT(s_stream_yields > 0);
 
-    /* May fail CRC check, just verify no crash */
-    const char* output = mock_output_get();
-    TEST_ASSERT(output != NULL);
+    /* Binary frames carry the segments as raw data */
+    memset(&s_stream, 0, sizeof(s_stream));
+    test_ctx.output_data_cb = stream_output_data_cb;
+    fl_exec_cmd(&test_ctx, 11, argv);
+    test_ctx.output_data_cb = NULL;
+    TEST_ASSERT_EQUAL(1, s_stream.end);
+    TEST_ASSERT_EQUAL(2, s_stream.syncs);
+    TEST_ASSERT_EQUAL_MEMORY(mem, s_stream.data, sizeof(mem));
 
-    /* Close file */
-    const char* close_argv[] = {"fl", "--cmd", "fclose"};
-    fl_exec_cmd(&test_ctx, 3, close_argv);
+    /* Without --stream the length is still bounded by the transfer buffer */
+    fl_log_init(mock_output_cb, NULL);
+    mock_output_reset();
+    const char* plain[] = {"fl", "--cmd", "read", "--addr", addr_str, "--len", len_str};
+    fl_exec_cmd(&test_ctx, 7, plain);
+    TEST_ASSERT(mock_output_contains("[FLERR] Invalid length"));
+}
 
-    /* Cleanup */
-    unlink(test_file);
+/* Compressible pattern: a short ramp repeated, then a zero run */
+static void fill_lz_pattern(uint8_t* buf, size_t len) {
+    for (size_t i = 0; i < len; i++)
+        buf[i] = (i < len / 2) ? (uint8_t)(i % 16) : 0;
 }
 
-void test_loader_cmd_fread_large(void) {
-    setup_loader_with_file();
+void test_loader_cmd_upload_z(void) {
+    setup_loader();
+    fl_init(&test_ctx);
 
-    char test_file[256];
-    snprintf(test_file, sizeof(test_file), "/tmp/fl_test_fread_large_%d.txt", getpid());
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "256"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
 
-    /* Create a file with content */
-    FILE* f = fopen(test_file, "w");
-    if (f) {
-        for (int i = 0; i < 100; i++) {
-            fprintf(f, "Line %d of test data\n", i);
-        }
-        fclose(f);
-    }
+    uint8_t raw[200], z[200];
+    char b64[300], crc_str[16];
+    fill_lz_pattern(raw, sizeof(raw));
+    int zn = fl_lz_compress(raw, sizeof(raw), z, sizeof(z));
+    TEST_ASSERT(zn > 0 && zn < (int)sizeof(raw));
+    TEST_ASSERT(fl_base64_encode(z, (size_t)zn, b64, sizeof(b64)) > 0);
 
-    /* Open file for reading */
-    const char* open_argv[] = {"fl", "--cmd", "fopen", "--path", test_file, "--mode", "r"};
-    fl_exec_cmd(&test_ctx, 7, open_argv);
+    /* CRC covers the uncompressed data */
+    const uint32_t hdr[2] = {0, sizeof(raw)};
+    uint16_t crc = fl_crc16_update(0xFFFF, hdr, sizeof(hdr));
+    crc = fl_crc16_update(crc, raw, sizeof(raw));
+    snprintf(crc_str, sizeof(crc_str), "0x%04X", crc);
 
     mock_output_reset();
+    const char* argv[] = {"fl", "--cmd", "upload", "--addr", "0", "--data", b64, "--z", "--crc", crc_str};
+    fl_exec_cmd(&test_ctx, 10, argv);
 
-    /* Read data without specifying len (should use default) */
-    const char* argv[] = {"fl", "--cmd", "fread"};
-    fl_exec_cmd(&test_ctx, 3, argv);
+    TEST_ASSERT(mock_output_contains("[FLOK]"));
+    TEST_ASSERT(mock_output_contains("200 bytes"));
+    TEST_ASSERT_EQUAL_MEMORY(raw, (const void*)test_ctx.last_alloc, sizeof(raw));
+}
 
-    TEST_ASSERT(mock_output_contains("FREAD") || mock_output_contains("FLOK"));
+void test_loader_cmd_upload_z_invalid(void) {
+    setup_loader();
+    fl_init(&test_ctx);
 
-    /* Close file */
-    const char* close_argv[] = {"fl", "--cmd", "fclose"};
-    fl_exec_cmd(&test_ctx, 3, close_argv);
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    mock_output_reset();
 
-    /* Cleanup */
-    unlink(test_file);
+    /* Valid base64, but the token promises 15+ literals that are not there */
+    const char* argv[] = {"fl", "--cmd", "upload", "--addr", "0", "--data", "8A==", "--z"};
+    fl_exec_cmd(&test_ctx, 8, argv);
+
+    TEST_ASSERT(mock_output_contains("Invalid compressed data"));
 }
 
-void test_loader_cmd_fclose_no_file(void) {
-    setup_loader_with_file();
+void test_loader_cmd_write_z(void) {
+    setup_loader();
+    fl_init(&test_ctx);
 
-    /* Try to close without opening */
-    const char* argv[] = {"fl", "--cmd", "fclose"};
-    fl_exec_cmd(&test_ctx, 3, argv);
+    static uint8_t dst[128];
+    uint8_t raw[128], z[128];
+    char b64[200], addr_str[32];
+    fill_lz_pattern(raw, sizeof(raw));
+    memset(dst, 0xFF, sizeof(dst));
+    int zn = fl_lz_compress(raw, sizeof(raw), z, sizeof(z));
+    TEST_ASSERT(zn > 0);
+    fl_base64_encode(z, (size_t)zn, b64, sizeof(b64));
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)(uintptr_t)dst);
 
-    /* Should report error or succeed gracefully */
-    const char* output = mock_output_get();
-    TEST_ASSERT(output != NULL);
+    const char* argv[] = {"fl", "--cmd", "write", "--addr", addr_str, "--data", b64, "--z", "--force"};
+    fl_exec_cmd(&test_ctx, 9, argv);
+
+    TEST_ASSERT(mock_output_contains("[FLOK]"));
+    TEST_ASSERT_EQUAL_MEMORY(raw, dst, sizeof(raw));
 }
 
-void test_loader_cmd_fseek_no_file(void) {
-    setup_loader_with_file();
+/* Extract and decode "data=<base64>" from the mock output */
+static int read_output_data(uint8_t* out, size_t max) {
+    const char* p = strstr(mock_output_get(), "data=");
+    if (!p)
+        return -1;
+    p += 5;
+    size_t n = strcspn(p, " \r\n");
+    return fl_base64_decode(p, n, out, max);
+}
 
-    /* Try to seek without opening */
-    const char* argv[] = {"fl", "--cmd", "fseek", "--addr", "0x10"};
-    fl_exec_cmd(&test_ctx, 5, argv);
+void test_loader_cmd_read_z(void) {
+    setup_loader();
+    fl_init(&test_ctx);
 
-    TEST_ASSERT(mock_output_contains("FLERR") || mock_output_contains("No file"));
-}
+    static uint8_t src[256];
+    fill_lz_pattern(src, sizeof(src));
+    const uint32_t hdr[2] = {(uint32_t)(uintptr_t)src, sizeof(src)};
+    uint16_t crc = fl_crc16_update(0xFFFF, hdr, sizeof(hdr));
+    crc = fl_crc16_update(crc, src, sizeof(src));
 
-void test_loader_cmd_fstat_no_path(void) {
-    setup_loader_with_file();
+    char addr_str[32], expect[48];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)(uintptr_t)src);
+    snprintf(expect, sizeof(expect), "READ 256 bytes crc=0x%04X z=", crc);
 
-    /* Try fstat without path */
-    const char* argv[] = {"fl", "--cmd", "fstat"};
+    const char* argv[] = {"fl", "--cmd", "read", "--addr", addr_str, "--len", "256", "--force", "--z"};
+    fl_exec_cmd(&test_ctx, 9, argv);
+
+    /* Response CRC is over the uncompressed bytes */
+    TEST_ASSERT(mock_output_contains(expect));
+
+    uint8_t z[256], raw[256];
+    int zn = read_output_data(z, sizeof(z));
+    TEST_ASSERT(zn > 0 && zn < (int)sizeof(src));
+    TEST_ASSERT_EQUAL(sizeof(src), fl_lz_decompress(z, (size_t)zn, raw, sizeof(raw)));
+    TEST_ASSERT_EQUAL_MEMORY(src, raw, sizeof(src));
+}
+
+void test_loader_cmd_read_z_incompressible(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    static uint8_t src[16] = {0x3A, 0x91, 0x07, 0xC4, 0x5E, 0xB2, 0x68, 0x1F,
+                              0xD3, 0x40, 0x8C, 0x27, 0xF9, 0x65, 0x0B, 0xAE};
+    char addr_str[32];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)(uintptr_t)src);
+
+    const char* argv[] = {"fl", "--cmd", "read", "--addr", addr_str, "--len", "16", "--force", "--z"};
+    fl_exec_cmd(&test_ctx, 9, argv);
+
+    /* Falls back to raw data without z= */
+    TEST_ASSERT(mock_output_contains("READ 16 bytes"));
+    TEST_ASSERT(!mock_output_contains("z="));
+
+    uint8_t raw[16];
+    TEST_ASSERT_EQUAL(16, read_output_data(raw, sizeof(raw)));
+    TEST_ASSERT_EQUAL_MEMORY(src, raw, sizeof(src));
+}
+
+void test_loader_cmd_fwrite_fread_z(void) {
+    setup_loader_with_file();
+
+    char test_file[256];
+    snprintf(test_file, sizeof(test_file), "/tmp/fl_test_fz_%d.bin", getpid());
+
+    uint8_t raw[200], z[200];
+    char b64[300];
+    fill_lz_pattern(raw, sizeof(raw));
+    int zn = fl_lz_compress(raw, sizeof(raw), z, sizeof(z));
+    TEST_ASSERT(zn > 0);
+    fl_base64_encode(z, (size_t)zn, b64, sizeof(b64));
+
+    const char* open_argv[] = {"fl", "--cmd", "fopen", "--path", test_file, "--mode", "rw"};
+    fl_exec_cmd(&test_ctx, 7, open_argv);
+
+    mock_output_reset();
+    const char* write_argv[] = {"fl", "--cmd", "fwrite", "--data", b64, "--z"};
+    fl_exec_cmd(&test_ctx, 6, write_argv);
+    TEST_ASSERT(mock_output_contains("FWRITE 200 bytes"));
+
+    const char* seek_argv[] = {"fl", "--cmd", "fseek", "--addr", "0"};
+    fl_exec_cmd(&test_ctx, 5, seek_argv);
+
+    mock_output_reset();
+    const char* read_argv[] = {"fl", "--cmd", "fread", "--len", "200", "--z"};
+    fl_exec_cmd(&test_ctx, 6, read_argv);
+    TEST_ASSERT(mock_output_contains("FREAD 200 bytes"));
+    TEST_ASSERT(mock_output_contains("z="));
+
+    uint8_t back[200];
+    zn = read_output_data(z, sizeof(z));
+    TEST_ASSERT(zn > 0);
+    TEST_ASSERT_EQUAL(200, fl_lz_decompress(z, (size_t)zn, back, sizeof(back)));
+    TEST_ASSERT_EQUAL_MEMORY(raw, back, sizeof(raw));
+
+    const char* close_argv[] = {"fl", "--cmd", "fclose"};
+    fl_exec_cmd(&test_ctx, 3, close_argv);
+    unlink(test_file);
+}
+
+void test_loader_cmd_hash(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    static uint8_t src[150];
+    for (size_t i = 0; i < sizeof(src); i++)
+        src[i] = (uint8_t)(i * 7);
+
+    char addr_str[32];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)(uintptr_t)src);
+    const char* argv[] = {"fl", "--cmd", "hash", "--addr", addr_str, "--len", "150"};
+    fl_exec_cmd(&test_ctx, 7, argv);
+
+    /* 64 + 64 + 22 byte blocks, one CRC-16 each */
+    TEST_ASSERT(mock_output_contains("HASH 3 blocks bs=64"));
+
+    uint8_t got[6], expect[6];
+    for (int i = 0; i < 3; i++) {
+        size_t n = i < 2 ? 64 : 22;
+        uint16_t crc = fl_crc16_update(0xFFFF, src + i * 64, n);
+        expect[i * 2] = (uint8_t)crc;
+        expect[i * 2 + 1] = (uint8_t)(crc >> 8);
+    }
+    TEST_ASSERT_EQUAL(6, read_output_data(got, sizeof(got)));
+    TEST_ASSERT_EQUAL_MEMORY(expect, got, sizeof(expect));
+
+    /* Response CRC covers addr + len + the CRC array */
+    const uint32_t hdr[2] = {(uint32_t)(uintptr_t)src, sizeof(src)};
+    uint16_t crc = fl_crc16_update(0xFFFF, hdr, sizeof(hdr));
+    crc = fl_crc16_update(crc, expect, sizeof(expect));
+    char crc_str[24];
+    snprintf(crc_str, sizeof(crc_str), "crc=0x%04X", crc);
+    TEST_ASSERT(mock_output_contains(crc_str));
+}
+
+void test_loader_cmd_hash_crc32(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    static uint8_t src[32] = {1, 2, 3};
+    char addr_str[32];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)(uintptr_t)src);
+    const char* argv[] = {"fl", "--cmd", "hash", "--addr", addr_str, "--len", "32", "--size", "16", "--crc32"};
+    fl_exec_cmd(&test_ctx, 10, argv);
+
+    TEST_ASSERT(mock_output_contains("HASH 2 blocks bs=16"));
+    uint8_t got[8];
+    TEST_ASSERT_EQUAL(8, read_output_data(got, sizeof(got)));
+    uint32_t crc = fl_crc32_update(0, src + 16, 16);
+    TEST_ASSERT_EQUAL(crc, (uint32_t)got[4] | (uint32_t)got[5] << 8 | (uint32_t)got[6] << 16 | (uint32_t)got[7] << 24);
+}
+
+void test_loader_cmd_hash_invalid(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    const char* argv[] = {"fl", "--cmd", "hash", "--addr", "0x20000000", "--len", "0"};
+    fl_exec_cmd(&test_ctx, 7, argv);
+    TEST_ASSERT(mock_output_contains("Invalid length"));
+
+    /* 2-byte CRCs: FL_BUF_SIZE / 2 blocks at most */
+    mock_output_reset();
+    const char* big_argv[] = {"fl", "--cmd", "hash", "--addr", "0x20000000", "--len", "1000000", "--size", "1"};
+    fl_exec_cmd(&test_ctx, 9, big_argv);
+    TEST_ASSERT(mock_output_contains("Too many blocks"));
+
+    /* len + bs - 1 past INT_MAX */
+    mock_output_reset();
+    const char* wrap_argv[] = {"fl", "--cmd", "hash", "--addr", "0x20000000", "--len", "0x7FFFFFF0", "--size", "0x20"};
+    fl_exec_cmd(&test_ctx, 9, wrap_argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] Too many blocks 67108864"));
+
+    mock_output_reset();
+    const char* zero_argv[] = {"fl", "--cmd", "hash", "--addr", "0", "--len", "64"};
+    fl_exec_cmd(&test_ctx, 7, zero_argv);
+    TEST_ASSERT(mock_output_contains("Invalid address range"));
+}
+
+static int s_crc32_cb_calls;
+
+static uint32_t counting_crc32_cb(uint32_t crc, const void* data, size_t len) {
+    s_crc32_cb_calls++;
+    return fl_crc32_update(crc, data, len);
+}
+
+void test_loader_cmd_crc32_cb(void) {
+    setup_loader();
+    test_ctx.crc32_cb = counting_crc32_cb;
+    fl_init(&test_ctx);
+    s_crc32_cb_calls = 0;
+
+    /* Pattern {0x00}: CRC-32 of a single zero byte */
+    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "1", "--crc32"};
+    fl_exec_cmd(&test_ctx, 6, argv);
+    TEST_ASSERT(mock_output_contains("crc=0xD202EF8D"));
+    TEST_ASSERT_EQUAL(1, s_crc32_cb_calls);
+
+    /* CRC-16 never goes to the callback */
+    const char* argv16[] = {"fl", "--cmd", "echoback", "--len", "1"};
+    fl_exec_cmd(&test_ctx, 5, argv16);
+    TEST_ASSERT_EQUAL(1, s_crc32_cb_calls);
+}
+
+void test_loader_cmd_invalid_crc(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    const char* argv[] = {"fl", "--cmd", "read", "--addr", "0x1000", "--crc", "0x12zz"};
+    int result = fl_exec_cmd(&test_ctx, 7, argv);
+    TEST_ASSERT_EQUAL(-1, result);
+    TEST_ASSERT(mock_output_contains("Invalid --crc: 0x12zz"));
+}
+
+void test_loader_cmd_tpatch_valid(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Allocate memory first */
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+
+    mock_output_reset();
+
+    /* Try tpatch - may be disabled with FPB_NO_TRAMPOLINE */
+    const char* argv[] = {"fl", "--cmd", "tpatch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20002000"};
+    fl_exec_cmd(&test_ctx, 9, argv);
+
+    /* Should either succeed or say trampoline disabled */
+    const char* output = mock_output_get();
+    TEST_ASSERT(output != NULL);
+}
+
+void test_loader_cmd_dpatch_valid(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Allocate memory first */
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+
+    mock_output_reset();
+
+    /* Try dpatch - may be disabled with FPB_NO_DEBUGMON */
+    const char* argv[] = {"fl", "--cmd", "dpatch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20002000"};
+    fl_exec_cmd(&test_ctx, 9, argv);
+
+    /* Should either succeed or say debugmon disabled */
+    const char* output = mock_output_get();
+    TEST_ASSERT(output != NULL);
+}
+
+void test_loader_cmd_run(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Allocate memory first */
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+
+    mock_output_reset();
+
+    /* Try run command */
+    const char* argv[] = {"fl", "--cmd", "run", "--entry", "0"};
+    fl_exec_cmd(&test_ctx, 5, argv);
+
+    /* May fail due to no valid code, but shouldn't crash */
+    const char* output = mock_output_get();
+    TEST_ASSERT(output != NULL);
+}
+
+void test_loader_cmd_read(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Allocate memory first */
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+
+    /* Write known data to allocated memory */
+    uintptr_t alloc_addr = test_ctx.last_alloc;
+    uint8_t* ptr = (uint8_t*)alloc_addr;
+    for (int i = 0; i < 16; i++) {
+        ptr[i] = (uint8_t)(0xA0 + i);
+    }
+
+    mock_output_reset();
+
+    /* Read back via read command */
+    char addr_str[32];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)alloc_addr);
+    const char* argv[] = {"fl", "--cmd", "read", "--addr", addr_str, "--len", "16"};
+    fl_exec_cmd(&test_ctx, 7, argv);
+
+    /* Should return FLOK with base64 data and CRC */
+    const char* output = mock_output_get();
+    TEST_ASSERT(output != NULL);
+    TEST_ASSERT(mock_output_contains("FLOK"));
+    TEST_ASSERT(mock_output_contains("READ 16 bytes"));
+    TEST_ASSERT(mock_output_contains("crc=0x"));
+    TEST_ASSERT(mock_output_contains("data="));
+}
+
+void test_loader_cmd_upload_invalid_data(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Allocate memory first */
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+
+    mock_output_reset();
+
+    /* Upload invalid data (not valid hex or base64) */
+    const char* argv[] = {"fl", "--cmd", "upload", "--addr", "0", "--data", "ZZZZ!!!"};
+    fl_exec_cmd(&test_ctx, 7, argv);
+
+    /* Should fail with invalid encoding error */
+    TEST_ASSERT(mock_output_contains("FLERR") || mock_output_contains("Invalid"));
+}
+
+void test_loader_cmd_fwrite_hex_data(void) {
+    setup_loader_with_file();
+
+    char test_file[256];
+    snprintf(test_file, sizeof(test_file), "/tmp/fl_test_fwrite_hex_%d.txt", getpid());
+
+    /* Open file */
+    const char* open_argv[] = {"fl", "--cmd", "fopen", "--path", test_file, "--mode", "w"};
+    fl_exec_cmd(&test_ctx, 7, open_argv);
+
+    mock_output_reset();
+
+    /* Write base64 data (SGVsbG8= = "Hello") */
+    const char* argv[] = {"fl", "--cmd", "fwrite", "--data", "SGVsbG8="};
+    fl_exec_cmd(&test_ctx, 5, argv);
+
+    TEST_ASSERT(mock_output_contains("FWRITE") || mock_output_contains("FLOK"));
+
+    /* Close file */
+    const char* close_argv[] = {"fl", "--cmd", "fclose"};
+    fl_exec_cmd(&test_ctx, 3, close_argv);
+
+    /* Cleanup */
+    unlink(test_file);
+}
+
+void test_loader_cmd_fwrite_with_crc(void) {
+    setup_loader_with_file();
+
+    char test_file[256];
+    snprintf(test_file, sizeof(test_file), "/tmp/fl_test_fwrite_crc_%d.txt", getpid());
+
+    /* Open file */
+    const char* open_argv[] = {"fl", "--cmd", "fopen", "--path", test_file, "--mode", "w"};
+    fl_exec_cmd(&test_ctx, 7, open_argv);
+
+    mock_output_reset();
+
+    /* Write data with CRC (SGVsbG8= = "Hello") */
+    const char* argv[] = {"fl", "--cmd", "fwrite", "--data", "SGVsbG8=", "--crc", "0x1234"};
+    fl_exec_cmd(&test_ctx, 7, argv);
+
+    /* May fail CRC check, just verify no crash */
+    const char* output = mock_output_get();
+    TEST_ASSERT(output != NULL);
+
+    /* Close file */
+    const char* close_argv[] = {"fl", "--cmd", "fclose"};
+    fl_exec_cmd(&test_ctx, 3, close_argv);
+
+    /* Cleanup */
+    unlink(test_file);
+}
+
+void test_loader_cmd_fread_large(void) {
+    setup_loader_with_file();
+
+    char test_file[256];
+    snprintf(test_file, sizeof(test_file), "/tmp/fl_test_fread_large_%d.txt", getpid());
+
+    /* Create a file with content */
+    FILE* f = fopen(test_file, "w");
+    if (f) {
+        for (int i = 0; i < 100; i++) {
+            fprintf(f, "Line %d of test data\n", i);
+        }
+        fclose(f);
+    }
+
+    /* Open file for reading */
+    const char* open_argv[] = {"fl", "--cmd", "fopen", "--path", test_file, "--mode", "r"};
+    fl_exec_cmd(&test_ctx, 7, open_argv);
+
+    mock_output_reset();
+
+    /* Read data without specifying len (should use default) */
+    const char* argv[] = {"fl", "--cmd", "fread"};
+    fl_exec_cmd(&test_ctx, 3, argv);
+
+    TEST_ASSERT(mock_output_contains("FREAD") || mock_output_contains("FLOK"));
+
+    /* Close file */
+    const char* close_argv[] = {"fl", "--cmd", "fclose"};
+    fl_exec_cmd(&test_ctx, 3, close_argv);
+
+    /* Cleanup */
+    unlink(test_file);
+}
+
+void test_loader_cmd_fclose_no_file(void) {
+    setup_loader_with_file();
+
+    /* Try to close without opening */
+    const char* argv[] = {"fl", "--cmd", "fclose"};
+    fl_exec_cmd(&test_ctx, 3, argv);
+
+    /* Should report error or succeed gracefully */
+    const char* output = mock_output_get();
+    TEST_ASSERT(output != NULL);
+}
+
+void test_loader_cmd_fseek_no_file(void) {
+    setup_loader_with_file();
+
+    /* Try to seek without opening */
+    const char* argv[] = {"fl", "--cmd", "fseek", "--addr", "0x10"};
+    fl_exec_cmd(&test_ctx, 5, argv);
+
+    TEST_ASSERT(mock_output_contains("FLERR") || mock_output_contains("No file"));
+}
+
+void test_loader_cmd_fstat_no_path(void) {
+    setup_loader_with_file();
+
+    /* Try fstat without path */
+    const char* argv[] = {"fl", "--cmd", "fstat"};
     fl_exec_cmd(&test_ctx, 3, argv);
 
-    TEST_ASSERT(mock_output_contains("FLERR") || mock_output_contains("Missing"));
+    TEST_ASSERT(mock_output_contains("FLERR") || mock_output_contains("Missing"));
+}
+
+void test_loader_cmd_read_no_alloc(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Read from a stack-local buffer without alloc — should still work */
+    static uint8_t local_buf[16] = {0x01, 0x02, 0x03, 0x04};
+    char addr_str[32];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)(uintptr_t)local_buf);
+    const char* argv[] = {"fl", "--cmd", "read", "--addr", addr_str, "--len", "4"};
+    fl_exec_cmd(&test_ctx, 7, argv);
+
+    const char* output = mock_output_get();
+    TEST_ASSERT(output != NULL);
+    TEST_ASSERT(mock_output_contains("FLOK"));
+    TEST_ASSERT(mock_output_contains("READ 4 bytes"));
+}
+
+void test_loader_cmd_read_invalid_len(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Read with length 0 — should fail */
+    const char* argv[] = {"fl", "--cmd", "read", "--addr", "0x1000", "--len", "0"};
+    fl_exec_cmd(&test_ctx, 7, argv);
+
+    TEST_ASSERT(mock_output_contains("FLERR"));
+    TEST_ASSERT(mock_output_contains("Invalid length"));
+}
+
+void test_loader_cmd_write(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Allocate a buffer to write into */
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+
+    uintptr_t alloc_addr = test_ctx.last_alloc;
+    mock_output_reset();
+
+    /* Write base64 data "AQIDBA==" = {0x01, 0x02, 0x03, 0x04} */
+    char addr_str[32];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)alloc_addr);
+    const char* argv[] = {"fl", "--cmd", "write", "--addr", addr_str, "--data", "AQIDBA=="};
+    fl_exec_cmd(&test_ctx, 7, argv);
+
+    TEST_ASSERT(mock_output_contains("FLOK"));
+    TEST_ASSERT(mock_output_contains("WRITE 4 bytes"));
+
+    /* Verify memory contents */
+    uint8_t* ptr = (uint8_t*)alloc_addr;
+    TEST_ASSERT_EQUAL(0x01, ptr[0]);
+    TEST_ASSERT_EQUAL(0x02, ptr[1]);
+    TEST_ASSERT_EQUAL(0x03, ptr[2]);
+    TEST_ASSERT_EQUAL(0x04, ptr[3]);
+}
+
+void test_loader_cmd_write_with_crc(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+
+    uintptr_t alloc_addr = test_ctx.last_alloc;
+    mock_output_reset();
+
+    /* Write with valid CRC — "AQIDBA==" = {0x01, 0x02, 0x03, 0x04}, CRC pre-computed */
+    char addr_str[32];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)alloc_addr);
+
+    /* Write base64 data (AQIDBA== = 0x01 0x02 0x03 0x04) */
+    const char* argv[] = {"fl", "--cmd", "write", "--addr", addr_str, "--data", "AQIDBA=="};
+    fl_exec_cmd(&test_ctx, 7, argv);
+
+    TEST_ASSERT(mock_output_contains("FLOK"));
+    TEST_ASSERT(mock_output_contains("WRITE 4 bytes"));
+}
+
+void test_loader_cmd_write_crc_mismatch(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+
+    uintptr_t alloc_addr = test_ctx.last_alloc;
+    mock_output_reset();
+
+    /* Write with wrong CRC */
+    char addr_str[32];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)alloc_addr);
+    const char* argv[] = {"fl", "--cmd", "write", "--addr", addr_str, "--data", "AQIDBA==", "--crc", "0xFFFF"};
+    fl_exec_cmd(&test_ctx, 9, argv);
+
+    TEST_ASSERT(mock_output_contains("FLERR"));
+    TEST_ASSERT(mock_output_contains("CRC mismatch"));
+}
+
+void test_loader_cmd_write_no_data(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Write without --data should fail */
+    const char* argv[] = {"fl", "--cmd", "write", "--addr", "0x1000"};
+    fl_exec_cmd(&test_ctx, 5, argv);
+
+    TEST_ASSERT(mock_output_contains("FLERR") || mock_output_contains("Missing"));
+}
+
+void test_loader_cmd_write_zero_addr(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Write to address 0 should fail */
+    const char* argv[] = {"fl", "--cmd", "write", "--addr", "0x0", "--data", "AQIDBA=="};
+    fl_exec_cmd(&test_ctx, 7, argv);
+
+    TEST_ASSERT(mock_output_contains("FLERR"));
+    TEST_ASSERT(mock_output_contains("Invalid address"));
+}
+
+void test_loader_cmd_read_zero_addr(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Read from address 0 should fail */
+    const char* argv[] = {"fl", "--cmd", "read", "--addr", "0x0", "--len", "4"};
+    fl_exec_cmd(&test_ctx, 7, argv);
+
+    TEST_ASSERT(mock_output_contains("FLERR"));
+    TEST_ASSERT(mock_output_contains("Invalid address range"));
+}
+
+void test_loader_cmd_read_zero_addr_force(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Read from address 0 with --force should bypass the check.
+     * Note: actual memcpy from 0x0 may segfault on host, so we use
+     * a valid address but verify the --force flag is accepted.
+     */
+    static uint8_t local_buf[4] = {0x11, 0x22, 0x33, 0x44};
+    char addr_str[32];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)(uintptr_t)local_buf);
+
+    /* First verify it works without --force */
+    const char* argv1[] = {"fl", "--cmd", "read", "--addr", addr_str, "--len", "4"};
+    fl_exec_cmd(&test_ctx, 7, argv1);
+    TEST_ASSERT(mock_output_contains("FLOK"));
+
+    mock_output_reset();
+
+    /* Now with --force, should also work */
+    const char* argv2[] = {"fl", "--cmd", "read", "--addr", addr_str, "--len", "4", "--force"};
+    fl_exec_cmd(&test_ctx, 8, argv2);
+    TEST_ASSERT(mock_output_contains("FLOK"));
+    TEST_ASSERT(mock_output_contains("READ 4 bytes"));
+}
+
+void test_loader_cmd_write_zero_addr_force(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Allocate a buffer and use --force to write */
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+
+    uintptr_t alloc_addr = test_ctx.last_alloc;
+    char addr_str[32];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)alloc_addr);
+
+    mock_output_reset();
+
+    /* Write with --force should succeed */
+    const char* argv[] = {"fl", "--cmd", "write", "--addr", addr_str, "--data", "AQIDBA==", "--force"};
+    fl_exec_cmd(&test_ctx, 8, argv);
+
+    TEST_ASSERT(mock_output_contains("FLOK"));
+    TEST_ASSERT(mock_output_contains("WRITE 4 bytes"));
+}
+
+void test_loader_cmd_write_overflow_addr(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Write to 0xFFFFFFFF with 3 bytes: addr+len-1 wraps past 0xFFFFFFFF */
+    const char* argv[] = {"fl", "--cmd", "write", "--addr", "0xFFFFFFFF", "--data", "AQID"};
+    fl_exec_cmd(&test_ctx, 7, argv);
+
+    TEST_ASSERT(mock_output_contains("FLERR"));
+    TEST_ASSERT(mock_output_contains("Invalid address range"));
+}
+
+void test_loader_cmd_read_overflow_addr(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Read from 0xFFFFFFFF with len=2: addr+len-1 wraps past 0xFFFFFFFF */
+    const char* argv[] = {"fl", "--cmd", "read", "--addr", "0xFFFFFFFF", "--len", "2"};
+    fl_exec_cmd(&test_ctx, 7, argv);
+
+    TEST_ASSERT(mock_output_contains("FLERR"));
+    TEST_ASSERT(mock_output_contains("Invalid address range"));
+}
+
+void test_loader_cmd_write_force_hint_in_error(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Error message should hint about --force */
+    const char* argv[] = {"fl", "--cmd", "write", "--addr", "0x0", "--data", "AQIDBA=="};
+    fl_exec_cmd(&test_ctx, 7, argv);
+
+    TEST_ASSERT(mock_output_contains("--force"));
+}
+
+void test_loader_cmd_read_write_roundtrip(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Allocate buffer */
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+
+    uintptr_t alloc_addr = test_ctx.last_alloc;
+    char addr_str[32];
+    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)alloc_addr);
+
+    mock_output_reset();
+
+    /* Write known data (3q2+7w== = 0xDE 0xAD 0xBE 0xEF) */
+    const char* write_argv[] = {"fl", "--cmd", "write", "--addr", addr_str, "--data", "3q2+7w=="};
+    fl_exec_cmd(&test_ctx, 7, write_argv);
+    TEST_ASSERT(mock_output_contains("FLOK"));
+
+    mock_output_reset();
+
+    /* Read it back */
+    const char* read_argv[] = {"fl", "--cmd", "read", "--addr", addr_str, "--len", "4"};
+    fl_exec_cmd(&test_ctx, 7, read_argv);
+    TEST_ASSERT(mock_output_contains("FLOK"));
+    TEST_ASSERT(mock_output_contains("READ 4 bytes"));
+
+    /* Verify memory directly */
+    uint8_t* ptr = (uint8_t*)alloc_addr;
+    TEST_ASSERT_EQUAL(0xDE, ptr[0]);
+    TEST_ASSERT_EQUAL(0xAD, ptr[1]);
+    TEST_ASSERT_EQUAL(0xBE, ptr[2]);
+    TEST_ASSERT_EQUAL(0xEF, ptr[3]);
+}
+
+void test_loader_cmd_run_no_alloc(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Try run without alloc */
+    const char* argv[] = {"fl", "--cmd", "run", "--entry", "0"};
+    fl_exec_cmd(&test_ctx, 5, argv);
+
+    /* Should fail */
+    const char* output = mock_output_get();
+    TEST_ASSERT(output != NULL);
+}
+
+/* ============================================================================
+ * fl_exec_cmd Tests - Enable Command
+ * ============================================================================ */
+
+void test_loader_cmd_enable_missing_arg(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* enable command without --enable argument should fail */
+    const char* argv[] = {"fl", "--cmd", "enable", "--comp", "0"};
+    int result = fl_exec_cmd(&test_ctx, 5, argv);
+
+    TEST_ASSERT(result != 0);
+    TEST_ASSERT(mock_output_contains("Missing --enable"));
+}
+
+void test_loader_cmd_enable_single_disable(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* First set up a patch */
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+
+    const char* patch_argv[]
+        = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000100"};
+    fl_exec_cmd(&test_ctx, 9, patch_argv);
+
+    mock_output_reset();
+
+    /* Disable the patch */
+    const char* argv[] = {"fl", "--cmd", "enable", "--comp", "0", "--enable", "0"};
+    int result = fl_exec_cmd(&test_ctx, 7, argv);
+
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("Disabled patch 0"));
+}
+
+void test_loader_cmd_enable_single_enable(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* First set up a patch */
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+
+    const char* patch_argv[]
+        = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000100"};
+    fl_exec_cmd(&test_ctx, 9, patch_argv);
+
+    /* Disable first */
+    const char* disable_argv[] = {"fl", "--cmd", "enable", "--comp", "0", "--enable", "0"};
+    fl_exec_cmd(&test_ctx, 7, disable_argv);
+
+    mock_output_reset();
+
+    /* Re-enable the patch */
+    const char* argv[] = {"fl", "--cmd", "enable", "--comp", "0", "--enable", "1"};
+    int result = fl_exec_cmd(&test_ctx, 7, argv);
+
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("Enabled patch 0"));
+}
+
+void test_loader_cmd_enable_all_disable(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Set up multiple patches */
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+
+    const char* patch0_argv[]
+        = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000100"};
+    fl_exec_cmd(&test_ctx, 9, patch0_argv);
+
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    const char* patch1_argv[]
+        = {"fl", "--cmd", "patch", "--comp", "1", "--orig", "0x08002000", "--target", "0x20000200"};
+    fl_exec_cmd(&test_ctx, 9, patch1_argv);
+
+    mock_output_reset();
+
+    /* Disable all patches */
+    const char* argv[] = {"fl", "--cmd", "enable", "--enable", "0", "--all"};
+    int result = fl_exec_cmd(&test_ctx, 6, argv);
+
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("Disabled"));
+    TEST_ASSERT(mock_output_contains("patches"));
+}
+
+void test_loader_cmd_enable_all_enable(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Set up multiple patches */
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+
+    const char* patch0_argv[]
+        = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000100"};
+    fl_exec_cmd(&test_ctx, 9, patch0_argv);
+
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    const char* patch1_argv[]
+        = {"fl", "--cmd", "patch", "--comp", "1", "--orig", "0x08002000", "--target", "0x20000200"};
+    fl_exec_cmd(&test_ctx, 9, patch1_argv);
+
+    /* Disable all first */
+    const char* disable_argv[] = {"fl", "--cmd", "enable", "--enable", "0", "--all"};
+    fl_exec_cmd(&test_ctx, 6, disable_argv);
+
+    mock_output_reset();
+
+    /* Re-enable all patches */
+    const char* argv[] = {"fl", "--cmd", "enable", "--enable", "1", "--all"};
+    int result = fl_exec_cmd(&test_ctx, 6, argv);
+
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("Enabled"));
+    TEST_ASSERT(mock_output_contains("patches"));
+}
+
+void test_loader_cmd_enable_invalid_comp(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Try to enable invalid comparator */
+    const char* argv[] = {"fl", "--cmd", "enable", "--comp", "99", "--enable", "1"};
+    int result = fl_exec_cmd(&test_ctx, 7, argv);
+
+    TEST_ASSERT(result != 0 || mock_output_contains("Invalid"));
+}
+
+void test_loader_cmd_enable_unset_patch(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Try to enable a patch that was never set - should succeed but report 0 changed */
+    const char* argv[] = {"fl", "--cmd", "enable", "--comp", "0", "--enable", "1"};
+    int result = fl_exec_cmd(&test_ctx, 7, argv);
+
+    /* fpb_enable_patch returns FPB_ERR_NOT_SET for unset patches, so changed=0 */
+    TEST_ASSERT_EQUAL(0, result);
+}
+
+/* ============================================================================
+ * fl_exec_cmd Tests - Echoback Command
+ * ============================================================================ */
+
+void test_loader_cmd_echoback_basic(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "16"};
+    int result = fl_exec_cmd(&test_ctx, 5, argv);
+
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("FLOK"));
+    TEST_ASSERT(mock_output_contains("ECHOBACK 16 bytes"));
+    TEST_ASSERT(mock_output_contains("crc=0x"));
+    TEST_ASSERT(mock_output_contains("data="));
+}
+
+void test_loader_cmd_echoback_verify_pattern(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Request 4 bytes: pattern is {0x00, 0x01, 0x02, 0x03} */
+    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "4"};
+    int result = fl_exec_cmd(&test_ctx, 5, argv);
+
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("ECHOBACK 4 bytes"));
+
+    /* Verify the base64 data: {0x00, 0x01, 0x02, 0x03} -> "AAECAw==" */
+    TEST_ASSERT(mock_output_contains("AAECAw=="));
+}
+
+void test_loader_cmd_echoback_verify_crc(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Request 1 byte: pattern is {0x00}, CRC16 of {0x00} with init 0xFFFF */
+    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "1"};
+    int result = fl_exec_cmd(&test_ctx, 5, argv);
+
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("ECHOBACK 1 bytes"));
+    TEST_ASSERT(mock_output_contains("crc=0x"));
+}
+
+void test_loader_cmd_echoback_max_len(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Request FL_BUF_SIZE (1024) bytes — should succeed */
+    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "1024"};
+    int result = fl_exec_cmd(&test_ctx, 5, argv);
+
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("ECHOBACK 1024 bytes"));
+}
+
+void test_loader_cmd_echoback_zero_len(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "0"};
+    int result = fl_exec_cmd(&test_ctx, 5, argv);
+
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("FLERR"));
+    TEST_ASSERT(mock_output_contains("Invalid length"));
+}
+
+void test_loader_cmd_echoback_negative_len(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "-1"};
+    int result = fl_exec_cmd(&test_ctx, 5, argv);
+
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("FLERR"));
+    TEST_ASSERT(mock_output_contains("Invalid length"));
+}
+
+void test_loader_cmd_echoback_over_max(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Request FL_BUF_SIZE + 1 (1025) bytes — should fail */
+    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "1025"};
+    int result = fl_exec_cmd(&test_ctx, 5, argv);
+
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("FLERR"));
+    TEST_ASSERT(mock_output_contains("Invalid length"));
 }
 
-void test_loader_cmd_read_no_alloc(void) {
+void test_loader_cmd_echoback_default_len(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Read from a stack-local buffer without alloc — should still work */
-    static uint8_t local_buf[16] = {0x01, 0x02, 0x03, 0x04};
-    char addr_str[32];
-    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)(uintptr_t)local_buf);
-    const char* argv[] = {"fl", "--cmd", "read", "--addr", addr_str, "--len", "4"};
-    fl_exec_cmd(&test_ctx, 7, argv);
+    /* Without --len, default is 64 */
+    const char* argv[] = {"fl", "--cmd", "echoback"};
+    int result = fl_exec_cmd(&test_ctx, 3, argv);
 
-    const char* output = mock_output_get();
-    TEST_ASSERT(output != NULL);
-    TEST_ASSERT(mock_output_contains("FLOK"));
-    TEST_ASSERT(mock_output_contains("READ 4 bytes"));
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("ECHOBACK 64 bytes"));
 }
 
-void test_loader_cmd_read_invalid_len(void) {
+/* ============================================================================
+ * fl_exec_frame Tests - Binary Frame Dispatch
+ * ============================================================================ */
+
+static size_t frame_tlv(uint8_t* buf, size_t pos, uint8_t tag, const void* val, size_t len) {
+    buf[pos++] = tag;
+    buf[pos++] = (uint8_t)(len & 0xFF);
+    buf[pos++] = (uint8_t)(len >> 8);
+    memcpy(buf + pos, val, len);
+    return pos + len;
+}
+
+static size_t frame_tlv_u32(uint8_t* buf, size_t pos, uint8_t tag, uint32_t v) {
+    uint8_t le[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)};
+    return frame_tlv(buf, pos, tag, le, sizeof(le));
+}
+
+void test_loader_frame_ping(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Read with length 0 — should fail */
-    const char* argv[] = {"fl", "--cmd", "read", "--addr", "0x1000", "--len", "0"};
-    fl_exec_cmd(&test_ctx, 7, argv);
+    int result = fl_exec_frame(&test_ctx, FL_OP_PING, NULL, 0);
 
-    TEST_ASSERT(mock_output_contains("FLERR"));
-    TEST_ASSERT(mock_output_contains("Invalid length"));
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("[FLOK] PONG"));
 }
 
-void test_loader_cmd_write(void) {
+void test_loader_frame_unknown_op(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Allocate a buffer to write into */
-    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
-    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    int result = fl_exec_frame(&test_ctx, 0xEE, NULL, 0);
 
-    uintptr_t alloc_addr = test_ctx.last_alloc;
-    mock_output_reset();
+    TEST_ASSERT_EQUAL(-1, result);
+    TEST_ASSERT(mock_output_contains("Unknown op 0xEE"));
+}
 
-    /* Write base64 data "AQIDBA==" = {0x01, 0x02, 0x03, 0x04} */
-    char addr_str[32];
-    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)alloc_addr);
-    const char* argv[] = {"fl", "--cmd", "write", "--addr", addr_str, "--data", "AQIDBA=="};
-    fl_exec_cmd(&test_ctx, 7, argv);
+void test_loader_frame_upload_raw(void) {
+    setup_loader();
+    fl_init(&test_ctx);
 
-    TEST_ASSERT(mock_output_contains("FLOK"));
-    TEST_ASSERT(mock_output_contains("WRITE 4 bytes"));
+    uint8_t payload[64];
+    size_t plen = frame_tlv_u32(payload, 0, FL_TAG_SIZE, 16);
+    fl_exec_frame(&test_ctx, FL_OP_ALLOC, payload, plen);
+    TEST_ASSERT(test_ctx.last_alloc != 0);
 
-    /* Verify memory contents */
-    uint8_t* ptr = (uint8_t*)alloc_addr;
-    TEST_ASSERT_EQUAL(0x01, ptr[0]);
-    TEST_ASSERT_EQUAL(0x02, ptr[1]);
-    TEST_ASSERT_EQUAL(0x03, ptr[2]);
-    TEST_ASSERT_EQUAL(0x04, ptr[3]);
+    /* Raw bytes, no base64; CRC covers offset + len + data */
+    const uint8_t data[] = {0xDE, 0xAD, 0xBE, 0xEF};
+    uint32_t hdr[2] = {4, sizeof(data)};
+    uint16_t crc = fl_crc16_update(0xFFFF, hdr, sizeof(hdr));
+    crc = fl_crc16_update(crc, data, sizeof(data));
+
+    plen = frame_tlv_u32(payload, 0, FL_TAG_ADDR, 4);
+    plen = frame_tlv(payload, plen, FL_TAG_BIN, data, sizeof(data));
+    plen = frame_tlv_u32(payload, plen, FL_TAG_CRC, crc);
+    mock_output_reset();
+    int result = fl_exec_frame(&test_ctx, FL_OP_UPLOAD, payload, plen);
+
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("Uploaded 4 bytes"));
+    TEST_ASSERT_EQUAL_MEMORY(data, (uint8_t*)test_ctx.last_alloc + 4, sizeof(data));
 }
 
-void test_loader_cmd_write_with_crc(void) {
+void test_loader_frame_upload_crc32(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
-    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uint8_t payload[64];
+    size_t plen = frame_tlv_u32(payload, 0, FL_TAG_SIZE, 16);
+    fl_exec_frame(&test_ctx, FL_OP_ALLOC, payload, plen);
 
-    uintptr_t alloc_addr = test_ctx.last_alloc;
+    const uint8_t data[] = {0xDE, 0xAD, 0xBE, 0xEF};
+    uint32_t hdr[2] = {0, sizeof(data)};
+    uint32_t crc = fl_crc32_update(0, hdr, sizeof(hdr));
+    crc = fl_crc32_update(crc, data, sizeof(data));
+
+    plen = frame_tlv_u32(payload, 0, FL_TAG_ADDR, 0);
+    plen = frame_tlv(payload, plen, FL_TAG_BIN, data, sizeof(data));
+    plen = frame_tlv(payload, plen, FL_TAG_CRC32, "", 0);
+    plen = frame_tlv_u32(payload, plen, FL_TAG_CRC, crc);
     mock_output_reset();
+    int result = fl_exec_frame(&test_ctx, FL_OP_UPLOAD, payload, plen);
 
-    /* Write with valid CRC — "AQIDBA==" = {0x01, 0x02, 0x03, 0x04}, CRC pre-computed */
-    char addr_str[32];
-    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)alloc_addr);
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("Uploaded 4 bytes"));
+}
 
-    /* Write base64 data (AQIDBA== = 0x01 0x02 0x03 0x04) */
-    const char* argv[] = {"fl", "--cmd", "write", "--addr", addr_str, "--data", "AQIDBA=="};
-    fl_exec_cmd(&test_ctx, 7, argv);
+void test_loader_frame_string_arg(void) {
+    setup_loader();
+    fl_init(&test_ctx);
 
-    TEST_ASSERT(mock_output_contains("FLOK"));
-    TEST_ASSERT(mock_output_contains("WRITE 4 bytes"));
+    uint8_t payload[32];
+    size_t plen = frame_tlv(payload, 0, FL_TAG_DATA, "0011", 5);
+    int result = fl_exec_frame(&test_ctx, FL_OP_ECHO, payload, plen);
+
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("ECHO 2 Bytes"));
 }
 
-void test_loader_cmd_write_crc_mismatch(void) {
+void test_loader_frame_string_no_nul(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
-    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uint8_t payload[32];
+    size_t plen = frame_tlv(payload, 0, FL_TAG_DATA, "0011", 4);
+    int result = fl_exec_frame(&test_ctx, FL_OP_ECHO, payload, plen);
 
-    uintptr_t alloc_addr = test_ctx.last_alloc;
-    mock_output_reset();
+    TEST_ASSERT_EQUAL(-1, result);
+    TEST_ASSERT(mock_output_contains("Invalid argument tag 0x03"));
+}
 
-    /* Write with wrong CRC */
-    char addr_str[32];
-    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)alloc_addr);
-    const char* argv[] = {"fl", "--cmd", "write", "--addr", addr_str, "--data", "AQIDBA==", "--crc", "0xFFFF"};
-    fl_exec_cmd(&test_ctx, 9, argv);
+void test_loader_frame_truncated(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Declares 4 value bytes but only carries 2 */
+    uint8_t payload[] = {FL_TAG_LEN, 4, 0, 0x10, 0x00};
+    int result = fl_exec_frame(&test_ctx, FL_OP_ECHOBACK, payload, sizeof(payload));
+
+    TEST_ASSERT_EQUAL(-1, result);
+    TEST_ASSERT(mock_output_contains("Truncated argument"));
+}
+
+void test_loader_frame_bad_int_size(void) {
+    setup_loader();
+    fl_init(&test_ctx);
 
+    uint8_t payload[] = {FL_TAG_LEN, 2, 0, 0x10, 0x00};
+    int result = fl_exec_frame(&test_ctx, FL_OP_ECHOBACK, payload, sizeof(payload));
+
+    TEST_ASSERT_EQUAL(-1, result);
     TEST_ASSERT(mock_output_contains("FLERR"));
-    TEST_ASSERT(mock_output_contains("CRC mismatch"));
 }
 
-void test_loader_cmd_write_no_data(void) {
+/* Append a batch record: op + 2-byte LE length + TLV payload */
+static size_t batch_rec(uint8_t* buf, size_t pos, uint8_t op, const uint8_t* tlv, size_t len) {
+    buf[pos++] = op;
+    buf[pos++] = (uint8_t)(len & 0xFF);
+    buf[pos++] = (uint8_t)(len >> 8);
+    memcpy(buf + pos, tlv, len);
+    return pos + len;
+}
+
+static int count_occurrences(const char* str, const char* sub) {
+    int n = 0;
+    for (const char* p = strstr(str, sub); p; p = strstr(p + 1, sub))
+        n++;
+    return n;
+}
+
+/* alloc(16) + upload 4 bytes at offset 0 (CRC-16, optionally corrupted) + echo */
+static size_t build_upload_batch(uint8_t* recs, bool bad_crc) {
+    uint8_t tlv[64];
+    size_t rlen = frame_tlv_u32(tlv, 0, FL_TAG_SIZE, 16);
+    size_t n = batch_rec(recs, 0, FL_OP_ALLOC, tlv, rlen);
+
+    const uint8_t data[] = {0xDE, 0xAD, 0xBE, 0xEF};
+    uint32_t hdr[2] = {0, sizeof(data)};
+    uint16_t crc = fl_crc16_update(0xFFFF, hdr, sizeof(hdr));
+    crc = fl_crc16_update(crc, data, sizeof(data));
+    rlen = frame_tlv_u32(tlv, 0, FL_TAG_ADDR, 0);
+    rlen = frame_tlv(tlv, rlen, FL_TAG_BIN, data, sizeof(data));
+    rlen = frame_tlv_u32(tlv, rlen, FL_TAG_CRC, bad_crc ? crc ^ 1 : crc);
+    n = batch_rec(recs, n, FL_OP_UPLOAD, tlv, rlen);
+
+    rlen = frame_tlv(tlv, 0, FL_TAG_DATA, "0011", 5);
+    return batch_rec(recs, n, FL_OP_ECHO, tlv, rlen);
+}
+
+void test_loader_frame_batch(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Write without --data should fail */
-    const char* argv[] = {"fl", "--cmd", "write", "--addr", "0x1000"};
-    fl_exec_cmd(&test_ctx, 5, argv);
+    uint8_t recs[128];
+    size_t rlen = build_upload_batch(recs, false);
+    uint8_t payload[160];
+    size_t plen = frame_tlv(payload, 0, FL_TAG_BIN, recs, rlen);
+    int result = fl_exec_frame(&test_ctx, FL_OP_BATCH, payload, plen);
 
-    TEST_ASSERT(mock_output_contains("FLERR") || mock_output_contains("Missing"));
+    TEST_ASSERT_EQUAL(0, result);
+    TEST_ASSERT(mock_output_contains("Allocated 16"));
+    TEST_ASSERT(mock_output_contains("Uploaded 4 bytes"));
+    TEST_ASSERT(mock_output_contains("ECHO 2 Bytes"));
+    TEST_ASSERT(mock_output_contains("[FLOK] BATCH 3/3"));
+    /* One response: sub-commands share the final [FLEND] */
+    TEST_ASSERT_EQUAL(1, count_occurrences(mock_output_get(), "[FLEND]"));
+    const uint8_t data[] = {0xDE, 0xAD, 0xBE, 0xEF};
+    TEST_ASSERT_EQUAL_MEMORY(data, (uint8_t*)test_ctx.last_alloc, sizeof(data));
 }
 
-void test_loader_cmd_write_zero_addr(void) {
+void test_loader_batch_stop_on_error(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Write to address 0 should fail */
-    const char* argv[] = {"fl", "--cmd", "write", "--addr", "0x0", "--data", "AQIDBA=="};
-    fl_exec_cmd(&test_ctx, 7, argv);
+    uint8_t recs[128];
+    size_t rlen = build_upload_batch(recs, true);
+    uint8_t payload[160];
+    size_t plen = frame_tlv(payload, 0, FL_TAG_BIN, recs, rlen);
+    fl_exec_frame(&test_ctx, FL_OP_BATCH, payload, plen);
 
-    TEST_ASSERT(mock_output_contains("FLERR"));
-    TEST_ASSERT(mock_output_contains("Invalid address"));
+    TEST_ASSERT(mock_output_contains("CRC mismatch"));
+    TEST_ASSERT(mock_output_contains("[FLERR] BATCH 1/3"));
+    TEST_ASSERT(!mock_output_contains("ECHO"));
+    TEST_ASSERT_EQUAL(1, count_occurrences(mock_output_get(), "[FLEND]"));
 }
 
-void test_loader_cmd_read_zero_addr(void) {
+void test_loader_batch_text(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Read from address 0 should fail */
-    const char* argv[] = {"fl", "--cmd", "read", "--addr", "0x0", "--len", "4"};
-    fl_exec_cmd(&test_ctx, 7, argv);
+    uint8_t recs[128];
+    size_t rlen = build_upload_batch(recs, false);
+    char b64[256];
+    fl_base64_encode(recs, rlen, b64, sizeof(b64));
 
-    TEST_ASSERT(mock_output_contains("FLERR"));
-    TEST_ASSERT(mock_output_contains("Invalid address range"));
+    const char* argv[] = {"fl", "--cmd", "batch", "--data", b64};
+    fl_exec_cmd(&test_ctx, 5, argv);
+
+    TEST_ASSERT(mock_output_contains("Uploaded 4 bytes"));
+    TEST_ASSERT(mock_output_contains("[FLOK] BATCH 3/3"));
 }
 
-void test_loader_cmd_read_zero_addr_force(void) {
+void test_loader_batch_invalid(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Read from address 0 with --force should bypass the check.
-     * Note: actual memcpy from 0x0 may segfault on host, so we use
-     * a valid address but verify the --force flag is accepted.
-     */
-    static uint8_t local_buf[4] = {0x11, 0x22, 0x33, 0x44};
-    char addr_str[32];
-    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)(uintptr_t)local_buf);
+    /* Data commands, nesting and --z in text mode are rejected before anything runs */
+    uint8_t tlv[16];
+    size_t tlen = frame_tlv_u32(tlv, 0, FL_TAG_SIZE, 16);
+    uint8_t recs[64];
+    size_t rlen = batch_rec(recs, 0, FL_OP_ALLOC, tlv, tlen);
+    rlen = batch_rec(recs, rlen, FL_OP_READ, NULL, 0);
+    uint8_t payload[96];
+    size_t plen = frame_tlv(payload, 0, FL_TAG_BIN, recs, rlen);
+    fl_exec_frame(&test_ctx, FL_OP_BATCH, payload, plen);
+    TEST_ASSERT(mock_output_contains("Op 0x07 not allowed in batch"));
+    TEST_ASSERT(!mock_output_contains("Allocated"));
 
-    /* First verify it works without --force */
-    const char* argv1[] = {"fl", "--cmd", "read", "--addr", addr_str, "--len", "4"};
-    fl_exec_cmd(&test_ctx, 7, argv1);
-    TEST_ASSERT(mock_output_contains("FLOK"));
+    mock_output_reset();
+    rlen = batch_rec(recs, 0, FL_OP_BATCH, NULL, 0);
+    plen = frame_tlv(payload, 0, FL_TAG_BIN, recs, rlen);
+    fl_exec_frame(&test_ctx, FL_OP_BATCH, payload, plen);
+    TEST_ASSERT(mock_output_contains("Op 0x10 not allowed in batch"));
 
     mock_output_reset();
+    tlen = frame_tlv(tlv, 0, FL_TAG_Z, "", 0);
+    rlen = batch_rec(recs, 0, FL_OP_UPLOAD, tlv, tlen);
+    char b64[64];
+    fl_base64_encode(recs, rlen, b64, sizeof(b64));
+    const char* argv[] = {"fl", "--cmd", "batch", "--data", b64};
+    fl_exec_cmd(&test_ctx, 5, argv);
+    TEST_ASSERT(mock_output_contains("--z not allowed in text batch"));
 
-    /* Now with --force, should also work */
-    const char* argv2[] = {"fl", "--cmd", "read", "--addr", addr_str, "--len", "4", "--force"};
-    fl_exec_cmd(&test_ctx, 8, argv2);
-    TEST_ASSERT(mock_output_contains("FLOK"));
-    TEST_ASSERT(mock_output_contains("READ 4 bytes"));
+    /* Record header claims more bytes than present */
+    mock_output_reset();
+    const uint8_t trunc[] = {FL_OP_PING, 8, 0, 0};
+    plen = frame_tlv(payload, 0, FL_TAG_BIN, trunc, sizeof(trunc));
+    fl_exec_frame(&test_ctx, FL_OP_BATCH, payload, plen);
+    TEST_ASSERT(mock_output_contains("Truncated batch record 0"));
 }
 
-void test_loader_cmd_write_zero_addr_force(void) {
+static uint32_t s_irq_saves;
+static uint32_t s_irq_restored;
+
+static uint32_t test_irq_save(void) {
+    s_irq_saves++;
+    return 0x5A;
+}
+
+static void test_irq_restore(uint32_t state) {
+    s_irq_restored = state;
+}
+
+void test_loader_stage_commit(void) {
     setup_loader();
     fl_init(&test_ctx);
+    test_ctx.irq_save_cb = test_irq_save;
+    test_ctx.irq_restore_cb = test_irq_restore;
+    s_irq_saves = 0;
+    s_irq_restored = 0;
 
-    /* Allocate a buffer and use --force to write */
     const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
     fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uintptr_t code0 = test_ctx.last_alloc;
+    const char* argv0[] = {"fl",         "--cmd",    "tpatch",     "--comp", "0", "--orig",
+                           "0x08001000", "--target", "0x20002000", "--stage"};
+    fl_exec_cmd(&test_ctx, 10, argv0);
+    TEST_ASSERT(mock_output_contains("Staged 0: 0x08001000 -> 0x20002000"));
 
-    uintptr_t alloc_addr = test_ctx.last_alloc;
-    char addr_str[32];
-    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)alloc_addr);
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    const char* argv1[] = {"fl",         "--cmd",    "patch",      "--comp", "1", "--orig",
+                           "0x08002000", "--target", "0x20003000", "--stage"};
+    fl_exec_cmd(&test_ctx, 10, argv1);
+
+    /* Nothing armed yet, allocations owned by the stage */
+    TEST_ASSERT_FALSE(mock_fpb_comp_is_enabled(0));
+    TEST_ASSERT_FALSE(mock_fpb_comp_is_enabled(1));
+    TEST_ASSERT_FALSE(test_ctx.slots[0].active);
+    TEST_ASSERT_EQUAL(FL_OP_TPATCH, test_ctx.stage[0].op);
+    TEST_ASSERT_EQUAL(code0, test_ctx.stage[0].slot.alloc_addr);
+    TEST_ASSERT_EQUAL(0, test_ctx.last_alloc);
 
     mock_output_reset();
+    uint32_t dsb0 = mock_dsb_count;
+    const char* commit_argv[] = {"fl", "--cmd", "commit"};
+    fl_exec_cmd(&test_ctx, 3, commit_argv);
+
+    TEST_ASSERT(mock_output_contains("[FLOK] Committed 2"));
+    TEST_ASSERT_TRUE(mock_fpb_comp_is_enabled(0));
+    TEST_ASSERT_TRUE(mock_fpb_comp_is_enabled(1));
+    TEST_ASSERT_TRUE(test_ctx.slots[0].active);
+    TEST_ASSERT_EQUAL(code0, test_ctx.slots[0].alloc_addr);
+    TEST_ASSERT_EQUAL(0x20003000, test_ctx.slots[1].target_addr);
+    TEST_ASSERT_EQUAL(0, test_ctx.stage[0].op);
+    TEST_ASSERT_EQUAL(0, test_ctx.stage[1].op);
+    /* One critical section, one barrier */
+    TEST_ASSERT_EQUAL(1, s_irq_saves);
+    TEST_ASSERT_EQUAL(0x5A, s_irq_restored);
+    TEST_ASSERT_EQUAL(dsb0 + 1, mock_dsb_count);
 
-    /* Write with --force should succeed */
-    const char* argv[] = {"fl", "--cmd", "write", "--addr", addr_str, "--data", "AQIDBA==", "--force"};
-    fl_exec_cmd(&test_ctx, 8, argv);
-
-    TEST_ASSERT(mock_output_contains("FLOK"));
-    TEST_ASSERT(mock_output_contains("WRITE 4 bytes"));
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 3, commit_argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] Nothing staged"));
 }
 
-void test_loader_cmd_write_overflow_addr(void) {
+void test_loader_stage_replace_active(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Write to 0xFFFFFFFF with 3 bytes: addr+len-1 wraps past 0xFFFFFFFF */
-    const char* argv[] = {"fl", "--cmd", "write", "--addr", "0xFFFFFFFF", "--data", "AQID"};
-    fl_exec_cmd(&test_ctx, 7, argv);
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "32"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    const char* argv[] = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000100"};
+    fl_exec_cmd(&test_ctx, 9, argv);
 
-    TEST_ASSERT(mock_output_contains("FLERR"));
-    TEST_ASSERT(mock_output_contains("Invalid address range"));
+    /* Staged replacement leaves the live patch untouched until commit */
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uintptr_t code1 = test_ctx.last_alloc;
+    uint32_t frees = mock_get_call_stats()->free_count;
+    uint8_t payload[64];
+    size_t plen = frame_tlv_u32(payload, 0, FL_TAG_COMP, 0);
+    plen = frame_tlv_u32(payload, plen, FL_TAG_ORIG, 0x08001000);
+    plen = frame_tlv_u32(payload, plen, FL_TAG_TARGET, 0x20000200);
+    plen = frame_tlv(payload, plen, FL_TAG_STAGE, "", 0);
+    fl_exec_frame(&test_ctx, FL_OP_PATCH, payload, plen);
+    TEST_ASSERT_EQUAL(0x20000100, test_ctx.slots[0].target_addr);
+
+    fl_exec_frame(&test_ctx, FL_OP_COMMIT, NULL, 0);
+    TEST_ASSERT(mock_output_contains("[FLOK] Committed 1"));
+    TEST_ASSERT_EQUAL(0x20000200, test_ctx.slots[0].target_addr);
+    TEST_ASSERT_EQUAL(code1, test_ctx.slots[0].alloc_addr);
+    /* Replaced code freed */
+    TEST_ASSERT_EQUAL(frees + 1, mock_get_call_stats()->free_count);
+    TEST_ASSERT_TRUE(mock_fpb_comp_is_enabled(0));
 }
 
-void test_loader_cmd_read_overflow_addr(void) {
+void test_loader_stage_abort(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Read from 0xFFFFFFFF with len=2: addr+len-1 wraps past 0xFFFFFFFF */
-    const char* argv[] = {"fl", "--cmd", "read", "--addr", "0xFFFFFFFF", "--len", "2"};
-    fl_exec_cmd(&test_ctx, 7, argv);
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "32"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    const char* argv[] = {"fl",         "--cmd",    "patch",      "--comp", "2", "--orig",
+                          "0x08001000", "--target", "0x20000100", "--stage"};
+    fl_exec_cmd(&test_ctx, 10, argv);
 
-    TEST_ASSERT(mock_output_contains("FLERR"));
-    TEST_ASSERT(mock_output_contains("Invalid address range"));
+    mock_output_reset();
+    uint32_t frees = mock_get_call_stats()->free_count;
+    const char* abort_argv[] = {"fl", "--cmd", "abort"};
+    fl_exec_cmd(&test_ctx, 3, abort_argv);
+
+    TEST_ASSERT(mock_output_contains("[FLOK] Aborted 1"));
+    TEST_ASSERT_EQUAL(frees + 1, mock_get_call_stats()->free_count);
+    TEST_ASSERT_EQUAL(0, test_ctx.stage[2].op);
+    TEST_ASSERT_FALSE(test_ctx.slots[2].active);
+    TEST_ASSERT_FALSE(mock_fpb_comp_is_enabled(2));
 }
 
-void test_loader_cmd_write_force_hint_in_error(void) {
+void test_loader_stage_invalid(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Error message should hint about --force */
-    const char* argv[] = {"fl", "--cmd", "write", "--addr", "0x0", "--data", "AQIDBA=="};
-    fl_exec_cmd(&test_ctx, 7, argv);
+    /* Checked like a live patch: a staged entry cannot fail on commit for these */
+    const char* ram[] = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x20001000", "--target", "0x20000100",
+                         "--stage"};
+    fl_exec_cmd(&test_ctx, 10, ram);
+    TEST_ASSERT(mock_output_contains("[FLERR] fpb_set_patch failed: -4"));
+    TEST_ASSERT_EQUAL(0, test_ctx.stage[0].op);
 
-    TEST_ASSERT(mock_output_contains("--force"));
+    /* Trampoline 6 exists, FPB comparator 6 does not (6 code comparators) */
+    mock_output_reset();
+    const char* comp[] = {"fl", "--cmd", "tpatch", "--comp", "6", "--orig", "0x08001000", "--target", "0x20000100",
+                          "--stage"};
+    fl_exec_cmd(&test_ctx, 10, comp);
+    TEST_ASSERT(mock_output_contains("[FLERR] fpb_set_patch failed: -3"));
+    TEST_ASSERT_EQUAL(0, test_ctx.stage[6].op);
 }
 
-void test_loader_cmd_read_write_roundtrip(void) {
+void test_loader_stage_commit_rollback(void) {
     setup_loader();
     fl_init(&test_ctx);
+    fpb_debugmon_deinit();
+    fpb_mock_configure_dwt(2);
 
-    /* Allocate buffer */
-    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "32"};
     fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uintptr_t code0 = test_ctx.last_alloc;
+    const char* live[] = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000100"};
+    fl_exec_cmd(&test_ctx, 9, live);
+    uint32_t comp0 = mock_fpb_comp[0];
+    uint32_t remap0 = fpb_test_get_remap_table()[0];
 
-    uintptr_t alloc_addr = test_ctx.last_alloc;
-    char addr_str[32];
-    snprintf(addr_str, sizeof(addr_str), "0x%lX", (unsigned long)alloc_addr);
-
-    mock_output_reset();
-
-    /* Write known data (3q2+7w== = 0xDE 0xAD 0xBE 0xEF) */
-    const char* write_argv[] = {"fl", "--cmd", "write", "--addr", addr_str, "--data", "3q2+7w=="};
-    fl_exec_cmd(&test_ctx, 7, write_argv);
-    TEST_ASSERT(mock_output_contains("FLOK"));
+    /* Replace slot 0 and add a DWT redirect whose comparator a debugger takes before commit */
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    const char* repl[] = {"fl",         "--cmd",    "patch",      "--comp", "0", "--orig",
+                          "0x08001000", "--target", "0x20000200", "--stage"};
+    fl_exec_cmd(&test_ctx, 10, repl);
+    const char* dwt[] = {"fl",         "--cmd",    "dpatch",     "--comp", "7", "--orig",
+                         "0x20010000", "--target", "0x20000301", "--stage"};
+    fl_exec_cmd(&test_ctx, 10, dwt);
+    TEST_ASSERT(mock_output_contains("Staged 7"));
+    mock_dwt_function[1] = 5;
 
     mock_output_reset();
+    uint32_t frees = mock_get_call_stats()->free_count;
+    const char* commit_argv[] = {"fl", "--cmd", "commit"};
+    fl_exec_cmd(&test_ctx, 3, commit_argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] Commit slot 7 failed: -2 (rolled back)"));
+
+    /* Slot 0 still runs the old patch, only the staged code was freed */
+    TEST_ASSERT_TRUE(test_ctx.slots[0].active);
+    TEST_ASSERT_EQUAL(0x20000100, test_ctx.slots[0].target_addr);
+    TEST_ASSERT_EQUAL(code0, test_ctx.slots[0].alloc_addr);
+    TEST_ASSERT_EQUAL_HEX(comp0, mock_fpb_comp[0]);
+    TEST_ASSERT_EQUAL_HEX(remap0, fpb_test_get_remap_table()[0]);
+    TEST_ASSERT_FALSE(test_ctx.slots[7].active);
+    TEST_ASSERT_EQUAL(5, mock_dwt_function[1]);
+    TEST_ASSERT_EQUAL(0, test_ctx.stage[0].op);
+    TEST_ASSERT_EQUAL(0, test_ctx.stage[7].op);
+    TEST_ASSERT_EQUAL(frees + 1, mock_get_call_stats()->free_count);
+
+    mock_dwt_function[1] = 0;
+    fpb_debugmon_deinit();
+}
+
+void test_loader_stage_commit_in_batch(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Stage two patches and commit them in one round trip */
+    uint8_t recs[128];
+    size_t n = 0;
+    for (uint32_t comp = 0; comp < 2; comp++) {
+        uint8_t tlv[48];
+        size_t tlen = frame_tlv_u32(tlv, 0, FL_TAG_COMP, comp);
+        tlen = frame_tlv_u32(tlv, tlen, FL_TAG_ORIG, 0x08001000 + comp * 0x100);
+        tlen = frame_tlv_u32(tlv, tlen, FL_TAG_TARGET, 0x20000100 + comp * 0x100);
+        tlen = frame_tlv(tlv, tlen, FL_TAG_STAGE, "", 0);
+        n = batch_rec(recs, n, FL_OP_PATCH, tlv, tlen);
+    }
+    n = batch_rec(recs, n, FL_OP_COMMIT, NULL, 0);
+    uint8_t payload[160];
+    size_t plen = frame_tlv(payload, 0, FL_TAG_BIN, recs, n);
+    fl_exec_frame(&test_ctx, FL_OP_BATCH, payload, plen);
 
-    /* Read it back */
-    const char* read_argv[] = {"fl", "--cmd", "read", "--addr", addr_str, "--len", "4"};
-    fl_exec_cmd(&test_ctx, 7, read_argv);
-    TEST_ASSERT(mock_output_contains("FLOK"));
-    TEST_ASSERT(mock_output_contains("READ 4 bytes"));
-
-    /* Verify memory directly */
-    uint8_t* ptr = (uint8_t*)alloc_addr;
-    TEST_ASSERT_EQUAL(0xDE, ptr[0]);
-    TEST_ASSERT_EQUAL(0xAD, ptr[1]);
-    TEST_ASSERT_EQUAL(0xBE, ptr[2]);
-    TEST_ASSERT_EQUAL(0xEF, ptr[3]);
+    TEST_ASSERT(mock_output_contains("Committed 2"));
+    TEST_ASSERT(mock_output_contains("[FLOK] BATCH 3/3"));
+    TEST_ASSERT_TRUE(mock_fpb_comp_is_enabled(0));
+    TEST_ASSERT_TRUE(mock_fpb_comp_is_enabled(1));
 }
 
-void test_loader_cmd_run_no_alloc(void) {
+/* ============================================================================
+ * Retarget
+ * ============================================================================ */
+
+void test_loader_retarget_tpatch(void) {
+    extern uint32_t fpb_trampoline_get_target(uint32_t comp);
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Try run without alloc */
-    const char* argv[] = {"fl", "--cmd", "run", "--entry", "0"};
-    fl_exec_cmd(&test_ctx, 5, argv);
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "32"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uintptr_t code0 = test_ctx.last_alloc;
+    const char* tpatch[] = {"fl", "--cmd", "tpatch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000101"};
+    fl_exec_cmd(&test_ctx, 9, tpatch);
+    uint32_t comp0 = mock_fpb_comp[0];
 
-    /* Should fail */
-    const char* output = mock_output_get();
-    TEST_ASSERT(output != NULL);
-}
+    /* New code uploaded into a fresh allocation, old one retired after the switch */
+    test_ctx.grace_free = true;
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uintptr_t code1 = test_ctx.last_alloc;
+    uint32_t frees = mock_get_call_stats()->free_count;
+    char target[32], expect[96];
+    snprintf(target, sizeof(target), "0x%lX", (unsigned long)(code1 + 1));
+    snprintf(expect, sizeof(expect), "[FLOK] Retarget 0: 0x08001000 -> 0x%08lX (was 0x20000101)",
+             (unsigned long)(code1 + 1));
+    mock_output_reset();
+    const char* argv[] = {"fl", "--cmd", "retarget", "--comp", "0", "--target", target, "--mode", "tpatch"};
+    TEST_ASSERT_EQUAL(0, fl_exec_cmd(&test_ctx, 9, argv));
 
-/* ============================================================================
- * fl_exec_cmd Tests - Enable Command
- * ============================================================================ */
+    TEST_ASSERT(mock_output_contains(expect));
+    TEST_ASSERT_EQUAL((uint32_t)(code1 + 1), fpb_trampoline_get_target(0));
+    TEST_ASSERT_EQUAL(comp0, mock_fpb_comp[0]);
+    TEST_ASSERT_TRUE(mock_fpb_comp_is_enabled(0));
+    TEST_ASSERT_EQUAL(code1, test_ctx.slots[0].alloc_addr);
+    TEST_ASSERT_EQUAL((uint32_t)(code1 + 1), test_ctx.slots[0].target_addr);
+    TEST_ASSERT_EQUAL(0, test_ctx.last_alloc);
+    TEST_ASSERT_EQUAL(frees, mock_get_call_stats()->free_count);
+    TEST_ASSERT_EQUAL(code0, test_ctx.retired[0].addr);
+    TEST_ASSERT(code0 != code1);
+}
 
-void test_loader_cmd_enable_missing_arg(void) {
+void test_loader_retarget_dpatch(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* enable command without --enable argument should fail */
-    const char* argv[] = {"fl", "--cmd", "enable", "--comp", "0"};
-    int result = fl_exec_cmd(&test_ctx, 5, argv);
+    test_ctx.grace_free = true;
+    const char* dpatch[] = {"fl", "--cmd", "dpatch", "--comp", "1", "--orig", "0x08002000", "--target", "0x20000101"};
+    fl_exec_cmd(&test_ctx, 9, dpatch);
 
-    TEST_ASSERT(result != 0);
-    TEST_ASSERT(mock_output_contains("Missing --enable"));
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "32"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uintptr_t code = test_ctx.last_alloc;
+    char target[32];
+    snprintf(target, sizeof(target), "0x%lX", (unsigned long)(code + 0x10));
+    mock_output_reset();
+    const char* argv[] = {"fl", "--cmd", "retarget", "--comp", "1", "--orig", "0x08002001", "--target", target};
+    fl_exec_cmd(&test_ctx, 9, argv);
+    TEST_ASSERT(mock_output_contains("[FLOK] Retarget 1: 0x08002000 -> "));
+    TEST_ASSERT_EQUAL((uint32_t)(code + 0x11), fpb_debugmon_get_redirect(0x08002000));
+    TEST_ASSERT_EQUAL(FL_OP_DPATCH, test_ctx.slots[1].op);
+    TEST_ASSERT_EQUAL(code, test_ctx.slots[1].alloc_addr);
+
+    /* Mode mismatch: the caller falls back to unpatch + tpatch */
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    snprintf(target, sizeof(target), "0x%lX", (unsigned long)(test_ctx.last_alloc + 1));
+    mock_output_reset();
+    const char* wrong[] = {"fl", "--cmd", "retarget", "--comp", "1", "--target", target, "--mode", "tpatch"};
+    fl_exec_cmd(&test_ctx, 9, wrong);
+    TEST_ASSERT(mock_output_contains("[FLERR] Slot 1 not armed by tpatch"));
+    TEST_ASSERT_EQUAL((uint32_t)(code + 0x11), fpb_debugmon_get_redirect(0x08002000));
+    fpb_debugmon_clear_redirect(1);
 }
 
-void test_loader_cmd_enable_single_disable(void) {
+void test_loader_retarget_errors(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* First set up a patch */
-    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
-    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    const char* missing[] = {"fl", "--cmd", "retarget", "--comp", "0"};
+    TEST_ASSERT_EQUAL(-1, fl_exec_cmd(&test_ctx, 5, missing));
+    TEST_ASSERT(mock_output_contains("Missing --target"));
 
-    const char* patch_argv[]
-        = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000100"};
-    fl_exec_cmd(&test_ctx, 9, patch_argv);
+    mock_output_reset();
+    const char* bad_mode[] = {"fl", "--cmd", "retarget", "--comp", "0", "--target", "0x20000100", "--mode", "x"};
+    TEST_ASSERT_EQUAL(-1, fl_exec_cmd(&test_ctx, 9, bad_mode));
+    TEST_ASSERT(mock_output_contains("Invalid mode 'x' (tpatch, dpatch)"));
 
     mock_output_reset();
+    const char* argv[] = {"fl", "--cmd", "retarget", "--comp", "0", "--target", "0x20000200"};
+    fl_exec_cmd(&test_ctx, 7, argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] Slot 0 not patched"));
 
-    /* Disable the patch */
-    const char* argv[] = {"fl", "--cmd", "enable", "--comp", "0", "--enable", "0"};
-    int result = fl_exec_cmd(&test_ctx, 7, argv);
+    /* A REMAP patch points straight at the code */
+    const char* patch[] = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000100"};
+    fl_exec_cmd(&test_ctx, 9, patch);
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 7, argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] Slot 0 is not a tpatch/dpatch slot"));
+    TEST_ASSERT_EQUAL(0x20000100, test_ctx.slots[0].target_addr);
 
-    TEST_ASSERT_EQUAL(0, result);
-    TEST_ASSERT(mock_output_contains("Disabled patch 0"));
+    mock_output_reset();
+    const char* other[] = {"fl", "--cmd", "retarget", "--comp", "0", "--orig", "0x08003000", "--target", "0x20000200"};
+    fl_exec_cmd(&test_ctx, 9, other);
+    TEST_ASSERT(mock_output_contains("[FLERR] Slot 0 patches 0x08001000"));
 }
 
-void test_loader_cmd_enable_single_enable(void) {
+void test_loader_retarget_target_checks(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* First set up a patch */
-    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "32"};
     fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    const char* tpatch[] = {"fl", "--cmd", "tpatch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000101"};
+    fl_exec_cmd(&test_ctx, 9, tpatch);
+    uintptr_t code0 = test_ctx.slots[0].alloc_addr;
 
-    const char* patch_argv[]
-        = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000100"};
-    fl_exec_cmd(&test_ctx, 9, patch_argv);
+    /* No allocation to take over */
+    test_ctx.grace_free = true;
+    mock_output_reset();
+    const char* argv[] = {"fl", "--cmd", "retarget", "--comp", "0", "--target", "0x20000201"};
+    fl_exec_cmd(&test_ctx, 7, argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] Target 0x20000201 not in the last allocation"));
 
-    /* Disable first */
-    const char* disable_argv[] = {"fl", "--cmd", "enable", "--comp", "0", "--enable", "0"};
-    fl_exec_cmd(&test_ctx, 7, disable_argv);
+    /* Just past the end of the allocation */
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uintptr_t code1 = test_ctx.last_alloc;
+    char target[32];
+    snprintf(target, sizeof(target), "0x%lX", (unsigned long)(code1 + 32 + 1));
+    argv[6] = target;
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 7, argv);
+    TEST_ASSERT(mock_output_contains("not in the last allocation"));
+    TEST_ASSERT_EQUAL(code0, test_ctx.slots[0].alloc_addr);
+    TEST_ASSERT_EQUAL(code1, test_ctx.last_alloc);
 
+    /* Without quiescent reports the old code would be freed while possibly running */
+    test_ctx.grace_free = false;
+    snprintf(target, sizeof(target), "0x%lX", (unsigned long)(code1 + 1));
     mock_output_reset();
+    fl_exec_cmd(&test_ctx, 7, argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] Retarget needs grace periods"));
+    TEST_ASSERT_EQUAL(0x20000101, test_ctx.slots[0].target_addr);
+    TEST_ASSERT_EQUAL(code0, test_ctx.slots[0].alloc_addr);
+}
 
-    /* Re-enable the patch */
-    const char* argv[] = {"fl", "--cmd", "enable", "--comp", "0", "--enable", "1"};
-    int result = fl_exec_cmd(&test_ctx, 7, argv);
+/* ============================================================================
+ * DWT Redirect Slots
+ * ============================================================================ */
 
-    TEST_ASSERT_EQUAL(0, result);
-    TEST_ASSERT(mock_output_contains("Enabled patch 0"));
+void test_loader_dpatch_dwt_slot(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+    fpb_debugmon_deinit(); /* Re-probe the comparators on the next dpatch */
+    fpb_mock_configure_dwt(2);
+
+    /* Slots 6-7 follow the 6 FPB comparators and use DWT comparators 0-1 */
+    const char* dpatch[] = {"fl", "--cmd", "dpatch", "--comp", "7", "--orig", "0x20010000", "--target", "0x20000101"};
+    fl_exec_cmd(&test_ctx, 9, dpatch);
+    TEST_ASSERT(mock_output_contains("[FLOK] DebugMon 7: 0x20010000 -> 0x20000101"));
+    TEST_ASSERT_EQUAL_HEX(0x20010000, mock_dwt_comp[1]);
+    TEST_ASSERT_EQUAL(0x20000101, fpb_debugmon_get_redirect(0x20010000));
+
+    mock_output_reset();
+    const char* info[] = {"fl", "--cmd", "info"};
+    fl_exec_cmd(&test_ctx, 3, info);
+    TEST_ASSERT(mock_output_contains("Slots: 1/8"));
+    TEST_ASSERT(mock_output_contains("Slot[6]: empty (debugmon)"));
+    TEST_ASSERT(mock_output_contains("Slot[7]: 0x20010000 -> 0x20000101, 0 bytes (debugmon, on)"));
+
+    mock_output_reset();
+    const char* over[] = {"fl", "--cmd", "dpatch", "--comp", "8", "--orig", "0x20010100", "--target", "0x20000101"};
+    fl_exec_cmd(&test_ctx, 9, over);
+    TEST_ASSERT(mock_output_contains("[FLERR] Invalid comp 8 (8 redirect slots)"));
+
+    /* unpatch --all covers the whole pool */
+    mock_output_reset();
+    const char* unpatch[] = {"fl", "--cmd", "unpatch", "--all"};
+    fl_exec_cmd(&test_ctx, 4, unpatch);
+    TEST_ASSERT(mock_output_contains("Cleared all 8 slots"));
+    TEST_ASSERT_FALSE(test_ctx.slots[7].active);
+    TEST_ASSERT_EQUAL(0, mock_dwt_function[1]);
+
+    fpb_debugmon_deinit();
 }
 
-void test_loader_cmd_enable_all_disable(void) {
+/* ============================================================================
+ * Instruction Patch
+ * ============================================================================ */
+
+void test_loader_ipatch(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Set up multiple patches */
-    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    /* An earlier alloc stays with the host: ipatch has no code */
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "32"};
     fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uintptr_t code = test_ctx.last_alloc;
 
-    const char* patch0_argv[]
-        = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000100"};
-    fl_exec_cmd(&test_ctx, 9, patch0_argv);
-
-    fl_exec_cmd(&test_ctx, 5, alloc_argv);
-    const char* patch1_argv[]
-        = {"fl", "--cmd", "patch", "--comp", "1", "--orig", "0x08002000", "--target", "0x20000200"};
-    fl_exec_cmd(&test_ctx, 9, patch1_argv);
+    mock_output_reset();
+    const char* argv[] = {"fl", "--cmd", "ipatch", "--comp", "0", "--addr", "0x08001003", "--insn", "0x2801"};
+    TEST_ASSERT_EQUAL(0, fl_exec_cmd(&test_ctx, 9, argv));
+    TEST_ASSERT(mock_output_contains("[FLOK] IPatch 0: 0x08001003 insn 0x00002801"));
+    TEST_ASSERT_EQUAL(0x28011000U, fpb_test_get_remap_table()[0]);
+    TEST_ASSERT_TRUE(mock_fpb_comp_is_enabled(0));
+    TEST_ASSERT_EQUAL(FL_OP_IPATCH, test_ctx.slots[0].op);
+    TEST_ASSERT_EQUAL(0, test_ctx.slots[0].alloc_addr);
+    TEST_ASSERT_EQUAL(code, test_ctx.last_alloc);
 
     mock_output_reset();
+    const char* info[] = {"fl", "--cmd", "info"};
+    fl_exec_cmd(&test_ctx, 3, info);
+    TEST_ASSERT(mock_output_contains("Slot[0]: 0x08001003 insn 0x00002801 (COMP=0x08001001, remap, on)"));
 
-    /* Disable all patches */
-    const char* argv[] = {"fl", "--cmd", "enable", "--enable", "0", "--all"};
-    int result = fl_exec_cmd(&test_ctx, 6, argv);
+    /* Nothing to retarget */
+    mock_output_reset();
+    const char* retarget[] = {"fl", "--cmd", "retarget", "--comp", "0", "--target", "0x20000200"};
+    fl_exec_cmd(&test_ctx, 7, retarget);
+    TEST_ASSERT(mock_output_contains("[FLERR] Slot 0 is not a tpatch/dpatch slot"));
 
-    TEST_ASSERT_EQUAL(0, result);
-    TEST_ASSERT(mock_output_contains("Disabled"));
-    TEST_ASSERT(mock_output_contains("patches"));
+    const char* unpatch[] = {"fl", "--cmd", "unpatch", "--comp", "0"};
+    fl_exec_cmd(&test_ctx, 5, unpatch);
+    TEST_ASSERT_FALSE(mock_fpb_comp_is_enabled(0));
+    TEST_ASSERT_EQUAL(0U, fpb_test_get_remap_table()[0]);
+    TEST_ASSERT_FALSE(test_ctx.slots[0].active);
 }
 
-void test_loader_cmd_enable_all_enable(void) {
+void test_loader_ipatch_replace_tpatch(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Set up multiple patches */
-    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "64"};
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "32"};
     fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    const char* tpatch[] = {"fl", "--cmd", "tpatch", "--comp", "1", "--orig", "0x08001000", "--target", "0x20000101"};
+    fl_exec_cmd(&test_ctx, 9, tpatch);
 
-    const char* patch0_argv[]
-        = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000100"};
-    fl_exec_cmd(&test_ctx, 9, patch0_argv);
+    /* The trampoline slot is disarmed and its code freed */
+    uint32_t frees = mock_get_call_stats()->free_count;
+    const char* argv[] = {"fl", "--cmd", "ipatch", "--comp", "1", "--addr", "0x08001004", "--insn", "0xF1B00F01"};
+    fl_exec_cmd(&test_ctx, 9, argv);
+    TEST_ASSERT_EQUAL(frees + 1, mock_get_call_stats()->free_count);
+    TEST_ASSERT_EQUAL(0x0F01F1B0U, fpb_test_get_remap_table()[1]);
+    TEST_ASSERT_EQUAL(FL_OP_IPATCH, test_ctx.slots[1].op);
+    TEST_ASSERT_EQUAL(0xF1B00F01U, test_ctx.slots[1].target_addr);
+}
+
+void test_loader_ipatch_bad_insn_keeps_slot(void) {
+    setup_loader();
+    fl_init(&test_ctx);
 
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "32"};
     fl_exec_cmd(&test_ctx, 5, alloc_argv);
-    const char* patch1_argv[]
-        = {"fl", "--cmd", "patch", "--comp", "1", "--orig", "0x08002000", "--target", "0x20000200"};
-    fl_exec_cmd(&test_ctx, 9, patch1_argv);
+    const char* tpatch[] = {"fl", "--cmd", "tpatch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000101"};
+    fl_exec_cmd(&test_ctx, 9, tpatch);
+    uintptr_t alloc = test_ctx.slots[0].alloc_addr;
 
-    /* Disable all first */
-    const char* disable_argv[] = {"fl", "--cmd", "enable", "--enable", "0", "--all"};
-    fl_exec_cmd(&test_ctx, 6, disable_argv);
+    /* 0xF1B0 is the first halfword of a 32-bit instruction: rejected before the tpatch is touched */
+    uint32_t frees = mock_get_call_stats()->free_count;
+    mock_output_reset();
+    const char* argv[] = {"fl", "--cmd", "ipatch", "--comp", "0", "--addr", "0x08001000", "--insn", "0xF1B0"};
+    fl_exec_cmd(&test_ctx, 9, argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] fpb_set_insn_patch failed: -2"));
+    TEST_ASSERT_TRUE(test_ctx.slots[0].active);
+    TEST_ASSERT_EQUAL(FL_OP_TPATCH, test_ctx.slots[0].op);
+    TEST_ASSERT_EQUAL(0x20000101U, test_ctx.slots[0].target_addr);
+    TEST_ASSERT_EQUAL(alloc, test_ctx.slots[0].alloc_addr);
+    TEST_ASSERT_EQUAL(frees, mock_get_call_stats()->free_count);
+    TEST_ASSERT_TRUE(mock_fpb_comp_is_enabled(0));
+}
+
+void test_loader_ipatch_word_conflicts(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+
+    /* Every patch path refuses a word a live ipatch remaps */
+    const char* ipatch[] = {"fl", "--cmd", "ipatch", "--comp", "1", "--addr", "0x08001000", "--insn", "0x2801"};
+    fl_exec_cmd(&test_ctx, 9, ipatch);
+    const char* patch[] = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x08001003", "--target", "0x20000101"};
+    const char* tpatch[] = {"fl", "--cmd", "tpatch", "--comp", "0", "--orig", "0x08001001", "--target", "0x20000101"};
+    const char* dpatch[] = {"fl",         "--cmd",    "dpatch",     "--comp", "2", "--orig",
+                            "0x08001003", "--target", "0x20000101", "--stage"};
+    const char** conflicts[] = {patch, tpatch, dpatch};
+    const int argcs[] = {9, 9, 10};
+    for (size_t i = 0; i < sizeof(argcs) / sizeof(argcs[0]); i++) {
+        mock_output_reset();
+        fl_exec_cmd(&test_ctx, argcs[i], conflicts[i]);
+        TEST_ASSERT(mock_output_contains("[FLERR] Slot 1 already patches 0x08001000"));
+    }
+    TEST_ASSERT_FALSE(test_ctx.slots[0].active);
+    TEST_ASSERT_EQUAL(0, test_ctx.stage[2].op);
+    TEST_ASSERT_EQUAL(FL_OP_IPATCH, test_ctx.slots[1].op);
+    TEST_ASSERT_EQUAL(0x2801U, fpb_test_get_remap_table()[1] & 0xFFFFU);
 
+    /* The next word is free */
+    const char* next[] = {"fl", "--cmd", "patch", "--comp", "0", "--orig", "0x08001005", "--target", "0x20000101"};
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 9, next);
+    TEST_ASSERT(mock_output_contains("[FLOK] Patch 0"));
+
+    /* A staged ipatch owns its word too */
+    const char* unpatch[] = {"fl", "--cmd", "unpatch", "--comp", "1"};
+    fl_exec_cmd(&test_ctx, 5, unpatch);
+    const char* staged[] = {"fl",         "--cmd",  "ipatch", "--comp", "1", "--addr",
+                            "0x08001000", "--insn", "0x2801", "--stage"};
+    fl_exec_cmd(&test_ctx, 10, staged);
     mock_output_reset();
+    fl_exec_cmd(&test_ctx, 9, tpatch);
+    TEST_ASSERT(mock_output_contains("[FLERR] Slot 1 stages 0x08001000"));
+    TEST_ASSERT_EQUAL(FL_OP_PATCH, test_ctx.slots[0].op);
+}
 
-    /* Re-enable all patches */
-    const char* argv[] = {"fl", "--cmd", "enable", "--enable", "1", "--all"};
-    int result = fl_exec_cmd(&test_ctx, 6, argv);
+void test_loader_ipatch_zero_insn(void) {
+    setup_loader();
+    fl_init(&test_ctx);
 
-    TEST_ASSERT_EQUAL(0, result);
-    TEST_ASSERT(mock_output_contains("Enabled"));
-    TEST_ASSERT(mock_output_contains("patches"));
+    /* 0x0000 is "movs r0, r0", not a missing --insn */
+    const char* argv[] = {"fl", "--cmd", "ipatch", "--comp", "0", "--addr", "0x08001000", "--insn", "0x0"};
+    TEST_ASSERT_EQUAL(0, fl_exec_cmd(&test_ctx, 9, argv));
+    TEST_ASSERT(mock_output_contains("[FLOK] IPatch 0: 0x08001000 insn 0x00000000"));
+    TEST_ASSERT_EQUAL(0U, fpb_test_get_remap_table()[0] & 0xFFFFU);
+    TEST_ASSERT_TRUE(mock_fpb_comp_is_enabled(0));
 }
 
-void test_loader_cmd_enable_invalid_comp(void) {
+void test_loader_ipatch_stage(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Try to enable invalid comparator */
-    const char* argv[] = {"fl", "--cmd", "enable", "--comp", "99", "--enable", "1"};
-    int result = fl_exec_cmd(&test_ctx, 7, argv);
+    const uint32_t hdr[3] = {2, 0x08001000, 0x2801};
+    uint16_t crc = fl_crc16_update(0xFFFF, hdr, sizeof(hdr));
+    char crc_str[16];
+    snprintf(crc_str, sizeof(crc_str), "0x%04X", crc);
+    const char* argv[] = {"fl",         "--cmd",  "ipatch", "--comp",  "2",     "--addr",
+                          "0x08001000", "--insn", "0x2801", "--stage", "--crc", crc_str};
+    fl_exec_cmd(&test_ctx, 12, argv);
+    TEST_ASSERT(mock_output_contains("[FLOK] Staged 2: 0x08001000 insn 0x00002801"));
+    TEST_ASSERT_FALSE(mock_fpb_comp_is_enabled(2));
 
-    TEST_ASSERT(result != 0 || mock_output_contains("Invalid"));
+    mock_output_reset();
+    const char* commit[] = {"fl", "--cmd", "commit"};
+    fl_exec_cmd(&test_ctx, 3, commit);
+    TEST_ASSERT(mock_output_contains("[FLOK] Committed 1"));
+    TEST_ASSERT_TRUE(mock_fpb_comp_is_enabled(2));
+    TEST_ASSERT_EQUAL(0x10022801U, fpb_test_get_remap_table()[2]);
+    TEST_ASSERT_EQUAL(FL_OP_IPATCH, test_ctx.slots[2].op);
 }
 
-void test_loader_cmd_enable_unset_patch(void) {
+void test_loader_ipatch_errors(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Try to enable a patch that was never set - should succeed but report 0 changed */
-    const char* argv[] = {"fl", "--cmd", "enable", "--comp", "0", "--enable", "1"};
-    int result = fl_exec_cmd(&test_ctx, 7, argv);
+    const char* missing[] = {"fl", "--cmd", "ipatch", "--comp", "0", "--addr", "0x08001000"};
+    TEST_ASSERT_EQUAL(-1, fl_exec_cmd(&test_ctx, 7, missing));
+    TEST_ASSERT(mock_output_contains("Missing --addr/--insn"));
 
-    /* fpb_enable_patch returns FPB_ERR_NOT_SET for unset patches, so changed=0 */
-    TEST_ASSERT_EQUAL(0, result);
+    mock_output_reset();
+    const char* bad_crc[] = {"fl",         "--cmd",  "ipatch", "--comp", "0",      "--addr",
+                             "0x08001000", "--insn", "0x2801", "--crc",  "0x1234"};
+    fl_exec_cmd(&test_ctx, 11, bad_crc);
+    TEST_ASSERT(mock_output_contains("[FLERR] CRC mismatch"));
+
+    mock_output_reset();
+    const char* bad_comp[] = {"fl", "--cmd", "ipatch", "--comp", "6", "--addr", "0x08001000", "--insn", "0x2801"};
+    fl_exec_cmd(&test_ctx, 9, bad_comp);
+    TEST_ASSERT(mock_output_contains("[FLERR] Invalid comp 6"));
+
+    /* Another slot already remaps the word */
+    const char* first[] = {"fl", "--cmd", "ipatch", "--comp", "1", "--addr", "0x08001000", "--insn", "0x2801"};
+    fl_exec_cmd(&test_ctx, 9, first);
+    mock_output_reset();
+    const char* same_word[] = {"fl", "--cmd", "ipatch", "--comp", "0", "--addr", "0x08001002", "--insn", "0x2802"};
+    fl_exec_cmd(&test_ctx, 9, same_word);
+    TEST_ASSERT(mock_output_contains("[FLERR] Slot 1 already patches 0x08001000"));
+    const char* unpatch[] = {"fl", "--cmd", "unpatch", "--comp", "1"};
+    fl_exec_cmd(&test_ctx, 5, unpatch);
+
+    /* ...or will once commit arms its staged patch */
+    const char* staged[] = {"fl",         "--cmd",  "ipatch", "--comp", "1", "--addr",
+                            "0x08001000", "--insn", "0x2801", "--stage"};
+    fl_exec_cmd(&test_ctx, 10, staged);
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 9, same_word);
+    TEST_ASSERT(mock_output_contains("[FLERR] Slot 1 stages 0x08001000"));
+    TEST_ASSERT_FALSE(test_ctx.slots[0].active);
+    const char* abort_argv[] = {"fl", "--cmd", "abort"};
+    fl_exec_cmd(&test_ctx, 3, abort_argv);
+
+    /* 32-bit instruction across two remap words */
+    mock_output_reset();
+    const char* split[] = {"fl", "--cmd", "ipatch", "--comp", "0", "--addr", "0x08001002", "--insn", "0xF1B00F01"};
+    fl_exec_cmd(&test_ctx, 9, split);
+    TEST_ASSERT(mock_output_contains("[FLERR] fpb_set_insn_patch failed: -4"));
+    TEST_ASSERT_FALSE(test_ctx.slots[0].active);
+
+    /* FPB without remap */
+    fpb_deinit();
+    mock_fpb_remap = 0;
+    fl_init(&test_ctx);
+    mock_output_reset();
+    const char* argv[] = {"fl", "--cmd", "ipatch", "--comp", "0", "--addr", "0x08001000", "--insn", "0x2801"};
+    fl_exec_cmd(&test_ctx, 9, argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] ipatch needs FPB remap (FPBv1)"));
+    fpb_deinit(); /* Re-read FP_REMAP on the next fl_init */
 }
 
 /* ============================================================================
- * fl_exec_cmd Tests - Echoback Command
+ * Grace-Period Reclamation
  * ============================================================================ */
 
-void test_loader_cmd_echoback_basic(void) {
+/* Patch slot 0 with a fresh allocation, return the allocation */
+static uintptr_t grace_patch(void) {
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "32"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uintptr_t code = test_ctx.last_alloc;
+    const char* argv[] = {"fl", "--cmd", "tpatch", "--comp", "0", "--orig", "0x08001000", "--target", "0x20000101"};
+    fl_exec_cmd(&test_ctx, 9, argv);
+    return code;
+}
+
+void test_loader_grace_unpatch(void) {
     setup_loader();
     fl_init(&test_ctx);
+    test_ctx.grace_free = true;
+    uintptr_t code = grace_patch();
 
-    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "16"};
-    int result = fl_exec_cmd(&test_ctx, 5, argv);
+    const char* unpatch[] = {"fl", "--cmd", "unpatch", "--comp", "0"};
+    const char* ping[] = {"fl", "--cmd", "ping"};
+    uint32_t frees = mock_get_call_stats()->free_count;
+    fl_exec_cmd(&test_ctx, 5, unpatch);
+    TEST_ASSERT_FALSE(test_ctx.slots[0].active);
+    TEST_ASSERT_EQUAL(code, test_ctx.retired[0].addr);
+    TEST_ASSERT_EQUAL(frees, mock_get_call_stats()->free_count);
 
-    TEST_ASSERT_EQUAL(0, result);
-    TEST_ASSERT(mock_output_contains("FLOK"));
-    TEST_ASSERT(mock_output_contains("ECHOBACK 16 bytes"));
-    TEST_ASSERT(mock_output_contains("crc=0x"));
-    TEST_ASSERT(mock_output_contains("data="));
+    /* The first report may predate the unpatch: still held */
+    fl_quiescent(&test_ctx);
+    fl_exec_cmd(&test_ctx, 3, ping);
+    TEST_ASSERT_EQUAL(frees, mock_get_call_stats()->free_count);
+
+    /* Freed by the next command after the second report */
+    fl_quiescent(&test_ctx);
+    TEST_ASSERT_EQUAL(frees, mock_get_call_stats()->free_count);
+    fl_exec_cmd(&test_ctx, 3, ping);
+    TEST_ASSERT_EQUAL(frees + 1, mock_get_call_stats()->free_count);
+    TEST_ASSERT_EQUAL(0, test_ctx.retired[0].addr);
 }
 
-void test_loader_cmd_echoback_verify_pattern(void) {
+void test_loader_grace_retarget(void) {
     setup_loader();
     fl_init(&test_ctx);
+    test_ctx.grace_free = true;
+    uintptr_t code0 = grace_patch();
 
-    /* Request 4 bytes: pattern is {0x00, 0x01, 0x02, 0x03} */
-    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "4"};
-    int result = fl_exec_cmd(&test_ctx, 5, argv);
-
-    TEST_ASSERT_EQUAL(0, result);
-    TEST_ASSERT(mock_output_contains("ECHOBACK 4 bytes"));
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "32"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    uint32_t frees = mock_get_call_stats()->free_count;
+    char target[32];
+    snprintf(target, sizeof(target), "0x%lX", (unsigned long)(test_ctx.last_alloc + 1));
+    const char* argv[] = {"fl", "--cmd", "retarget", "--comp", "0", "--target", target};
+    fl_exec_cmd(&test_ctx, 7, argv);
+    TEST_ASSERT(mock_output_contains("[FLOK] Retarget 0"));
+    TEST_ASSERT_EQUAL(code0, test_ctx.retired[0].addr);
+    TEST_ASSERT_EQUAL(frees, mock_get_call_stats()->free_count);
 
-    /* Verify the base64 data: {0x00, 0x01, 0x02, 0x03} -> "AAECAw==" */
-    TEST_ASSERT(mock_output_contains("AAECAw=="));
+    fl_quiescent(&test_ctx);
+    fl_quiescent(&test_ctx);
+    const char* ping[] = {"fl", "--cmd", "ping"};
+    fl_exec_cmd(&test_ctx, 3, ping);
+    TEST_ASSERT_EQUAL(frees + 1, mock_get_call_stats()->free_count);
 }
 
-void test_loader_cmd_echoback_verify_crc(void) {
+void test_loader_grace_list_full(void) {
     setup_loader();
     fl_init(&test_ctx);
+    test_ctx.grace_free = true;
 
-    /* Request 1 byte: pattern is {0x00}, CRC16 of {0x00} with init 0xFFFF */
-    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "1"};
-    int result = fl_exec_cmd(&test_ctx, 5, argv);
+    const char* unpatch[] = {"fl", "--cmd", "unpatch", "--comp", "0"};
+    uintptr_t first = grace_patch();
+    fl_exec_cmd(&test_ctx, 5, unpatch);
+    for (uint32_t i = 1; i < FL_RETIRE_MAX; i++) {
+        grace_patch();
+        fl_exec_cmd(&test_ctx, 5, unpatch);
+    }
 
-    TEST_ASSERT_EQUAL(0, result);
-    TEST_ASSERT(mock_output_contains("ECHOBACK 1 bytes"));
-    TEST_ASSERT(mock_output_contains("crc=0x"));
+    /* No reports: nothing is freed early, so the unpatch is refused and the patch stays armed */
+    uint32_t frees = mock_get_call_stats()->free_count;
+    uintptr_t last = grace_patch();
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 5, unpatch);
+    TEST_ASSERT(mock_output_contains("[FLERR] Retire list full: 8/8 blocks wait for a grace period"));
+    TEST_ASSERT_EQUAL(frees, mock_get_call_stats()->free_count);
+    TEST_ASSERT_EQUAL(first, test_ctx.retired[0].addr);
+    TEST_ASSERT_TRUE(test_ctx.slots[0].active);
+    TEST_ASSERT_EQUAL(last, test_ctx.slots[0].alloc_addr);
+    TEST_ASSERT_TRUE(mock_fpb_comp_is_enabled(0));
+
+    /* Retarget and commit would retire the live code too */
+    const char* alloc_argv[] = {"fl", "--cmd", "alloc", "--size", "32"};
+    fl_exec_cmd(&test_ctx, 5, alloc_argv);
+    char target[32];
+    snprintf(target, sizeof(target), "0x%lX", (unsigned long)(test_ctx.last_alloc + 1));
+    const char* retarget[] = {"fl", "--cmd", "retarget", "--comp", "0", "--target", target};
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 7, retarget);
+    TEST_ASSERT(mock_output_contains("[FLERR] Retire list full"));
+    TEST_ASSERT_EQUAL(last, test_ctx.slots[0].alloc_addr);
+
+    const char* stage[] = {"fl",         "--cmd",    "tpatch",   "--comp", "0", "--orig",
+                           "0x08001000", "--target", "0x20000101", "--stage"};
+    fl_exec_cmd(&test_ctx, 10, stage);
+    const char* commit[] = {"fl", "--cmd", "commit"};
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 3, commit);
+    TEST_ASSERT(mock_output_contains("[FLERR] Retire list full"));
+    TEST_ASSERT_EQUAL(last, test_ctx.slots[0].alloc_addr);
+    TEST_ASSERT_EQUAL(FL_OP_TPATCH, test_ctx.stage[0].op);
+    TEST_ASSERT_EQUAL(frees, mock_get_call_stats()->free_count);
+
+    /* Staged code was never armed: abort frees it at once */
+    const char* abort_argv[] = {"fl", "--cmd", "abort"};
+    fl_exec_cmd(&test_ctx, 3, abort_argv);
+    TEST_ASSERT_EQUAL(frees + 1, mock_get_call_stats()->free_count);
+
+    /* A grace period drains the list, and the unpatch goes through */
+    fl_quiescent(&test_ctx);
+    fl_quiescent(&test_ctx);
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 5, unpatch);
+    TEST_ASSERT(mock_output_contains("[FLOK] Cleared slot 0"));
+    TEST_ASSERT_EQUAL(frees + 1 + FL_RETIRE_MAX, mock_get_call_stats()->free_count);
+    TEST_ASSERT_EQUAL(last, test_ctx.retired[0].addr);
+    TEST_ASSERT_FALSE(test_ctx.slots[0].active);
 }
 
-void test_loader_cmd_echoback_max_len(void) {
+static uint32_t s_yields;
+
+static void test_yield(void) {
+    s_yields++;
+}
+
+void test_loader_memcrc(void) {
     setup_loader();
     fl_init(&test_ctx);
+    test_ctx.yield_cb = test_yield;
+    s_yields = 0;
 
-    /* Request FL_BUF_SIZE (1024) bytes — should succeed */
-    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "1024"};
-    int result = fl_exec_cmd(&test_ctx, 5, argv);
+    /* Spans three slices: yields between them */
+    static uint8_t mem[2 * FL_MEM_SLICE_SIZE + 100];
+    for (size_t i = 0; i < sizeof(mem); i++)
+        mem[i] = (uint8_t)(i * 7);
+    char addr[24], len[16], expect[64];
+    snprintf(addr, sizeof(addr), "0x%lX", (unsigned long)(uintptr_t)mem);
+    snprintf(len, sizeof(len), "%u", (unsigned)sizeof(mem));
+    snprintf(expect, sizeof(expect), "[FLOK] MEMCRC 0x%08lX len=%u crc=0x%08lX", (unsigned long)(uintptr_t)mem,
+             (unsigned)sizeof(mem), (unsigned long)fl_crc32_update(0, mem, sizeof(mem)));
 
-    TEST_ASSERT_EQUAL(0, result);
-    TEST_ASSERT(mock_output_contains("ECHOBACK 1024 bytes"));
+    const char* argv[] = {"fl", "--cmd", "memcrc", "--addr", addr, "--len", len};
+    fl_exec_cmd(&test_ctx, 7, argv);
+    TEST_ASSERT(mock_output_contains(expect));
+    TEST_ASSERT_EQUAL(2, s_yields);
+
+    mock_output_reset();
+    const char* bad[] = {"fl", "--cmd", "memcrc", "--addr", addr, "--len", "0"};
+    fl_exec_cmd(&test_ctx, 7, bad);
+    TEST_ASSERT(mock_output_contains("[FLERR] Invalid length 0"));
 }
 
-void test_loader_cmd_echoback_zero_len(void) {
+void test_loader_memcmp(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "0"};
-    int result = fl_exec_cmd(&test_ctx, 5, argv);
+    static uint8_t a[FL_MEM_SLICE_SIZE + 64], b[FL_MEM_SLICE_SIZE + 64];
+    memset(a, 0x5A, sizeof(a));
+    memset(b, 0x5A, sizeof(b));
+    char addr_a[24], addr_b[24], len[16];
+    snprintf(addr_a, sizeof(addr_a), "0x%lX", (unsigned long)(uintptr_t)a);
+    snprintf(addr_b, sizeof(addr_b), "0x%lX", (unsigned long)(uintptr_t)b);
+    snprintf(len, sizeof(len), "%u", (unsigned)sizeof(a));
+    const char* argv[] = {"fl", "--cmd", "memcmp", "--addr", addr_a, "--target", addr_b, "--len", len};
 
-    TEST_ASSERT_EQUAL(0, result);
-    TEST_ASSERT(mock_output_contains("FLERR"));
-    TEST_ASSERT(mock_output_contains("Invalid length"));
+    fl_exec_cmd(&test_ctx, 9, argv);
+    TEST_ASSERT(mock_output_contains("[FLOK] MEMCMP 4160 bytes equal"));
+
+    /* First difference in the second slice */
+    b[FL_MEM_SLICE_SIZE + 3] = 0;
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 9, argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] MEMCMP differ at +0x1003"));
+
+    mock_output_reset();
+    const char* missing[] = {"fl", "--cmd", "memcmp", "--addr", addr_a, "--len", len};
+    TEST_ASSERT_EQUAL(-1, fl_exec_cmd(&test_ctx, 7, missing));
+    TEST_ASSERT(mock_output_contains("Missing --target"));
 }
 
-void test_loader_cmd_echoback_negative_len(void) {
+static void fmt_addr(char* out, size_t size, const void* p) {
+    snprintf(out, size, "0x%lX", (unsigned long)(uintptr_t)p);
+}
+
+void test_loader_memset(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "-1"};
-    int result = fl_exec_cmd(&test_ctx, 5, argv);
+    /* Unaligned start and odd length: byte head, word body, byte tail */
+    static uint8_t mem[FL_MEM_SLICE_SIZE + 64];
+    memset(mem, 0xEE, sizeof(mem));
+    char addr[24];
+    fmt_addr(addr, sizeof(addr), mem + 1);
+    const char* argv[] = {"fl", "--cmd", "memset", "--addr", addr, "--len", "4150", "--value", "0xA5"};
+    fl_exec_cmd(&test_ctx, 9, argv);
+    TEST_ASSERT(mock_output_contains("len=4150 value=0xA5"));
+    TEST_ASSERT_EQUAL_HEX(0xEE, mem[0]);
+    static uint8_t expect[4150];
+    memset(expect, 0xA5, sizeof(expect));
+    TEST_ASSERT_EQUAL_MEMORY(expect, mem + 1, sizeof(expect));
+    TEST_ASSERT_EQUAL_HEX(0xEE, mem[4151]);
 
-    TEST_ASSERT_EQUAL(0, result);
-    TEST_ASSERT(mock_output_contains("FLERR"));
-    TEST_ASSERT(mock_output_contains("Invalid length"));
+    mock_output_reset();
+    const char* bad[] = {"fl", "--cmd", "memset", "--addr", addr, "--value", "256"};
+    fl_exec_cmd(&test_ctx, 7, bad);
+    TEST_ASSERT(mock_output_contains("[FLERR] Invalid value 256"));
 }
 
-void test_loader_cmd_echoback_over_max(void) {
+void test_loader_memcpy(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Request FL_BUF_SIZE + 1 (1025) bytes — should fail */
-    const char* argv[] = {"fl", "--cmd", "echoback", "--len", "1025"};
-    int result = fl_exec_cmd(&test_ctx, 5, argv);
+    static uint8_t mem[2 * FL_MEM_SLICE_SIZE + 64];
+    static uint8_t ref[sizeof(mem)];
+    for (size_t i = 0; i < sizeof(mem); i++)
+        mem[i] = (uint8_t)(i * 13 + 1);
+    memcpy(ref, mem, sizeof(mem));
 
-    TEST_ASSERT_EQUAL(0, result);
-    TEST_ASSERT(mock_output_contains("FLERR"));
-    TEST_ASSERT(mock_output_contains("Invalid length"));
+    /* Overlapping, dst above src and crossing a slice: must copy back to front */
+    char src[24], dst[24];
+    fmt_addr(src, sizeof(src), mem + 2);
+    fmt_addr(dst, sizeof(dst), mem + 7);
+    const char* argv[] = {"fl", "--cmd", "memcpy", "--addr", src, "--target", dst, "--len", "5000"};
+    fl_exec_cmd(&test_ctx, 9, argv);
+    TEST_ASSERT(mock_output_contains("[FLOK] MEMCPY"));
+    memmove(ref + 7, ref + 2, 5000);
+    TEST_ASSERT_EQUAL_MEMORY(ref, mem, sizeof(mem));
+
+    /* Forward overlap (dst below src), word aligned */
+    fmt_addr(src, sizeof(src), mem + 3000);
+    fmt_addr(dst, sizeof(dst), mem + 4);
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 9, argv);
+    memmove(ref + 4, ref + 3000, 5000);
+    TEST_ASSERT_EQUAL_MEMORY(ref, mem, sizeof(mem));
 }
 
-void test_loader_cmd_echoback_default_len(void) {
+void test_loader_memfind(void) {
     setup_loader();
     fl_init(&test_ctx);
 
-    /* Without --len, default is 64 */
-    const char* argv[] = {"fl", "--cmd", "echoback"};
-    int result = fl_exec_cmd(&test_ctx, 3, argv);
+    /* The magic straddles the first slice boundary */
+    static uint8_t mem[FL_MEM_SLICE_SIZE + 64];
+    memset(mem, 0xDE, sizeof(mem));
+    static const uint8_t magic[] = {0xDE, 0xAD, 0xBE, 0xEF};
+    memcpy(mem + FL_MEM_SLICE_SIZE - 2, magic, sizeof(magic));
+    char addr[24], len[16], expect[48];
+    fmt_addr(addr, sizeof(addr), mem);
+    snprintf(len, sizeof(len), "%u", (unsigned)sizeof(mem));
+    snprintf(expect, sizeof(expect), "[FLOK] MEMFIND 0x%08lX",
+             (unsigned long)(uintptr_t)(mem + FL_MEM_SLICE_SIZE - 3));
 
-    TEST_ASSERT_EQUAL(0, result);
-    TEST_ASSERT(mock_output_contains("ECHOBACK 64 bytes"));
+    /* 3rd byte before the magic is 0xDE too: the match starts there */
+    const char* argv[] = {"fl", "--cmd", "memfind", "--addr", addr, "--len", len, "--data", "3t6tvg=="};
+    fl_exec_cmd(&test_ctx, 9, argv);
+    TEST_ASSERT(mock_output_contains(expect));
+
+    /* Pattern ending past --len is not a match */
+    snprintf(len, sizeof(len), "%u", (unsigned)FL_MEM_SLICE_SIZE);
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 9, argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] MEMFIND not found"));
 }
 
 /* ============================================================================
  * Test Runner
  * ============================================================================ */
 
+/* ============================================================================
+ * Trampoline Stats
+ * ============================================================================ */
+
+void test_loader_slotstats(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+    const char* tpatch[] = {"fl", "--cmd", "tpatch", "--comp", "1", "--orig", "0x08001000", "--target", "0x20002001"};
+    fl_exec_cmd(&test_ctx, 9, tpatch);
+
+    /* Patched but never called: no line */
+    mock_output_reset();
+    const char* argv[] = {"fl", "--cmd", "slotstats"};
+    TEST_ASSERT_EQUAL(0, fl_exec_cmd(&test_ctx, 3, argv));
+    TEST_ASSERT(mock_output_contains("[FLOK] SLOTSTATS slots=0"));
+    TEST_ASSERT(!mock_output_contains("Slot[1]"));
+
+    /* Two calls through the trampoline, 100 and 300 cycles */
+    mock_dwt_cyccnt = 0;
+    fpb_trampoline_stats_enter(1, 0x08000101);
+    mock_dwt_cyccnt = 100;
+    fpb_trampoline_stats_exit(1);
+    fpb_trampoline_stats_enter(1, 0x08000101);
+    mock_dwt_cyccnt = 400;
+    fpb_trampoline_stats_exit(1);
+
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 3, argv);
+    TEST_ASSERT(mock_output_contains("Slot[1]: calls=2 timed=2 avg=200 max=300"));
+    TEST_ASSERT(mock_output_contains("[FLOK] SLOTSTATS slots=1"));
+
+    mock_output_reset();
+    const char* reset[] = {"fl", "--cmd", "slotstats", "--mode", "reset"};
+    fl_exec_cmd(&test_ctx, 5, reset);
+    TEST_ASSERT(mock_output_contains("[FLOK] SLOTSTATS reset"));
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, 3, argv);
+    TEST_ASSERT(mock_output_contains("[FLOK] SLOTSTATS slots=0"));
+}
+
+void test_loader_slotstats_invalid_mode(void) {
+    setup_loader();
+    fl_init(&test_ctx);
+    const char* argv[] = {"fl", "--cmd", "slotstats", "--mode", "bogus"};
+    TEST_ASSERT_EQUAL(-1, fl_exec_cmd(&test_ctx, 5, argv));
+    TEST_ASSERT(mock_output_contains("Invalid mode 'bogus' (reset)"));
+}
+
 void run_loader_tests(void) {
     TEST_SUITE_BEGIN("func_loader - Initialization");
     RUN_TEST(test_loader_init_default);
@@ -1516,6 +3479,10 @@ void run_loader_tests(void) {
     RUN_TEST(test_loader_cmd_info);
     RUN_TEST(test_loader_cmd_unknown);
     RUN_TEST(test_loader_cmd_empty);
+    RUN_TEST(test_loader_cmd_lookup_all);
+    RUN_TEST(test_loader_cmd_option_forms);
+    RUN_TEST(test_loader_cmd_invalid_option);
+    RUN_TEST(test_loader_cmd_invalid_number);
     TEST_SUITE_END();
 
     TEST_SUITE_BEGIN("func_loader - Core Commands");
@@ -1540,6 +3507,7 @@ void run_loader_tests(void) {
     RUN_TEST(test_loader_cmd_upload_no_alloc);
     RUN_TEST(test_loader_cmd_upload_no_data);
     RUN_TEST(test_loader_cmd_upload_with_data);
+    RUN_TEST(test_loader_cmd_upload_out_of_bounds);
     TEST_SUITE_END();
 
     TEST_SUITE_BEGIN("func_loader - Slot Commands");
@@ -1575,11 +3543,31 @@ void run_loader_tests(void) {
     RUN_TEST(test_loader_cmd_fcrc);
     RUN_TEST(test_loader_cmd_fcrc_no_file);
     RUN_TEST(test_loader_cmd_flist);
+    RUN_TEST(test_loader_cmd_dump);
+    RUN_TEST(test_loader_cmd_dump_no_fs);
     TEST_SUITE_END();
 
     TEST_SUITE_BEGIN("func_loader - Advanced Commands");
     RUN_TEST(test_loader_cmd_upload_hex_data);
     RUN_TEST(test_loader_cmd_upload_with_crc);
+    RUN_TEST(test_loader_cmd_upload_ack_offset);
+    RUN_TEST(test_loader_cmd_ping_caps);
+    RUN_TEST(test_loader_cmd_upload_crc32);
+    RUN_TEST(test_loader_cmd_read_crc32);
+    RUN_TEST(test_loader_cmd_readv);
+    RUN_TEST(test_loader_cmd_read_stream);
+    RUN_TEST(test_loader_cmd_readv_invalid);
+    RUN_TEST(test_loader_cmd_upload_z);
+    RUN_TEST(test_loader_cmd_upload_z_invalid);
+    RUN_TEST(test_loader_cmd_write_z);
+    RUN_TEST(test_loader_cmd_read_z);
+    RUN_TEST(test_loader_cmd_read_z_incompressible);
+    RUN_TEST(test_loader_cmd_fwrite_fread_z);
+    RUN_TEST(test_loader_cmd_hash);
+    RUN_TEST(test_loader_cmd_hash_crc32);
+    RUN_TEST(test_loader_cmd_hash_invalid);
+    RUN_TEST(test_loader_cmd_crc32_cb);
+    RUN_TEST(test_loader_cmd_invalid_crc);
     RUN_TEST(test_loader_cmd_upload_invalid_data);
     RUN_TEST(test_loader_cmd_tpatch_valid);
     RUN_TEST(test_loader_cmd_dpatch_valid);
@@ -1625,4 +3613,68 @@ void run_loader_tests(void) {
     RUN_TEST(test_loader_cmd_echoback_over_max);
     RUN_TEST(test_loader_cmd_echoback_default_len);
     TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader - Binary Frame Dispatch");
+    RUN_TEST(test_loader_frame_ping);
+    RUN_TEST(test_loader_frame_unknown_op);
+    RUN_TEST(test_loader_frame_upload_raw);
+    RUN_TEST(test_loader_frame_upload_crc32);
+    RUN_TEST(test_loader_frame_string_arg);
+    RUN_TEST(test_loader_frame_string_no_nul);
+    RUN_TEST(test_loader_frame_truncated);
+    RUN_TEST(test_loader_frame_bad_int_size);
+    RUN_TEST(test_loader_frame_batch);
+    RUN_TEST(test_loader_batch_stop_on_error);
+    RUN_TEST(test_loader_batch_text);
+    RUN_TEST(test_loader_batch_invalid);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader - Staged Commit");
+    RUN_TEST(test_loader_stage_commit);
+    RUN_TEST(test_loader_stage_replace_active);
+    RUN_TEST(test_loader_stage_abort);
+    RUN_TEST(test_loader_stage_invalid);
+    RUN_TEST(test_loader_stage_commit_rollback);
+    RUN_TEST(test_loader_stage_commit_in_batch);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader - Retarget");
+    RUN_TEST(test_loader_retarget_tpatch);
+    RUN_TEST(test_loader_retarget_dpatch);
+    RUN_TEST(test_loader_retarget_errors);
+    RUN_TEST(test_loader_retarget_target_checks);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader - DWT Redirect Slots");
+    RUN_TEST(test_loader_dpatch_dwt_slot);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader - Instruction Patch");
+    RUN_TEST(test_loader_ipatch);
+    RUN_TEST(test_loader_ipatch_replace_tpatch);
+    RUN_TEST(test_loader_ipatch_bad_insn_keeps_slot);
+    RUN_TEST(test_loader_ipatch_zero_insn);
+    RUN_TEST(test_loader_ipatch_word_conflicts);
+    RUN_TEST(test_loader_ipatch_stage);
+    RUN_TEST(test_loader_ipatch_errors);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader - Grace-Period Reclamation");
+    RUN_TEST(test_loader_grace_unpatch);
+    RUN_TEST(test_loader_grace_retarget);
+    RUN_TEST(test_loader_grace_list_full);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader - Memory Scan");
+    RUN_TEST(test_loader_memcrc);
+    RUN_TEST(test_loader_memcmp);
+    RUN_TEST(test_loader_memset);
+    RUN_TEST(test_loader_memcpy);
+    RUN_TEST(test_loader_memfind);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader - Trampoline Stats");
+    RUN_TEST(test_loader_slotstats);
+    RUN_TEST(test_loader_slotstats_invalid_mode);
+    TEST_SUITE_END();
 }
@@ -0,0 +1,274 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 VIFEX
+ *
+ * Tests for fl_codec.c - Base64, CRC and LZ kernels
+ */
+
+#include "test_framework.h"
+#include "fl_codec.h"
+#include <string.h>
+
+/* ============================================================================
+ * CRC-16 Tests
+ * ============================================================================ */
+
+void test_codec_crc16_check_value(void) {
+    /* CRC-16/CCITT-FALSE check value, same as utils/crc.py */
+    TEST_ASSERT_EQUAL_HEX(0x29B1, fl_crc16_update(0xFFFF, "123456789", 9));
+    TEST_ASSERT_EQUAL_HEX(0xFFFF, fl_crc16_update(0xFFFF, "", 0));
+}
+
+void test_codec_crc16_slices_match_bytewise(void) {
+    uint8_t buf[80];
+    for (size_t i = 0; i < sizeof(buf); i++)
+        buf[i] = (uint8_t)(i * 37 + 11);
+
+    /* Every alignment and tail length: block path == byte-at-a-time path */
+    for (size_t off = 0; off < 4; off++) {
+        for (size_t len = 0; len + off <= sizeof(buf); len++) {
+            uint16_t ref = 0xFFFF;
+            for (size_t i = 0; i < len; i++)
+                ref = fl_crc16_update(ref, buf + off + i, 1);
+            TEST_ASSERT_EQUAL_HEX(ref, fl_crc16_update(0xFFFF, buf + off, len));
+        }
+    }
+}
+
+void test_codec_crc16_incremental(void) {
+    const char* msg = "The quick brown fox jumps over the lazy dog";
+    size_t len = strlen(msg);
+    uint16_t whole = fl_crc16_update(0xFFFF, msg, len);
+    uint16_t part = fl_crc16_update(0xFFFF, msg, 7);
+    part = fl_crc16_update(part, msg + 7, len - 7);
+    TEST_ASSERT_EQUAL_HEX(whole, part);
+}
+
+/* ============================================================================
+ * CRC-32 Tests
+ * ============================================================================ */
+
+void test_codec_crc32_check_value(void) {
+    /* CRC-32/ISO-HDLC check value, same as zlib.crc32() */
+    TEST_ASSERT_EQUAL_HEX(0xCBF43926, fl_crc32_update(0, "123456789", 9));
+    TEST_ASSERT_EQUAL_HEX(0x00000000, fl_crc32_update(0, "", 0));
+    TEST_ASSERT_EQUAL_HEX(0x414FA339, fl_crc32_update(0, "The quick brown fox jumps over the lazy dog", 43));
+}
+
+void test_codec_crc32_slices_match_bytewise(void) {
+    uint8_t buf[80];
+    for (size_t i = 0; i < sizeof(buf); i++)
+        buf[i] = (uint8_t)(i * 37 + 11);
+
+    for (size_t off = 0; off < 4; off++) {
+        for (size_t len = 0; len + off <= sizeof(buf); len++) {
+            uint32_t ref = 0;
+            for (size_t i = 0; i < len; i++)
+                ref = fl_crc32_update(ref, buf + off + i, 1);
+            TEST_ASSERT_EQUAL_HEX(ref, fl_crc32_update(0, buf + off, len));
+        }
+    }
+}
+
+void test_codec_crc32_incremental(void) {
+    const char* msg = "123456789";
+    uint32_t part = fl_crc32_update(0, msg, 5);
+    part = fl_crc32_update(part, msg + 5, 4);
+    TEST_ASSERT_EQUAL_HEX(0xCBF43926, part);
+}
+
+/* ============================================================================
+ * Base64 Tests
+ * ============================================================================ */
+
+void test_codec_base64_rfc4648(void) {
+    static const char* const vectors[][2] = {
+        {"f", "Zg=="},         {"fo", "Zm8="},         {"foo", "Zm9v"},
+        {"foob", "Zm9vYg=="},  {"fooba", "Zm9vYmE="},  {"foobar", "Zm9vYmFy"},
+        {"foobarbazqux", "Zm9vYmFyYmF6cXV4"},
+    };
+    char enc[32];
+    uint8_t dec[32];
+
+    for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        const char* plain = vectors[i][0];
+        const char* b64 = vectors[i][1];
+        int n = fl_base64_encode((const uint8_t*)plain, strlen(plain), enc, sizeof(enc));
+        TEST_ASSERT_EQUAL((int)strlen(b64), n);
+        TEST_ASSERT_STR_EQUAL(b64, enc);
+
+        n = fl_base64_decode(b64, strlen(b64), dec, sizeof(dec));
+        TEST_ASSERT_EQUAL((int)strlen(plain), n);
+        TEST_ASSERT_EQUAL_MEMORY(plain, dec, strlen(plain));
+    }
+}
+
+void test_codec_base64_roundtrip(void) {
+    uint8_t data[100];
+    char enc[140];
+    uint8_t dec[100];
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i * 151 + 7);
+
+    for (size_t len = 1; len <= sizeof(data); len++) {
+        int n = fl_base64_encode(data, len, enc, sizeof(enc));
+        TEST_ASSERT_EQUAL((int)((len + 2) / 3 * 4), n);
+        TEST_ASSERT_EQUAL((int)len, fl_base64_decode(enc, (size_t)n, dec, sizeof(dec)));
+        TEST_ASSERT_EQUAL_MEMORY(data, dec, len);
+    }
+}
+
+void test_codec_base64_invalid(void) {
+    uint8_t out[16];
+    TEST_ASSERT_EQUAL(-1, fl_base64_decode("", 0, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, fl_base64_decode("Zm9", 3, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, fl_base64_decode("Zm9*", 4, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, fl_base64_decode("Z===", 4, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, fl_base64_decode("Zg==Zg==", 8, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, fl_base64_decode("Zm=v", 4, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, fl_base64_decode("Zm9\xC3", 4, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, fl_base64_decode(NULL, 4, out, sizeof(out)));
+}
+
+void test_codec_base64_bounds(void) {
+    uint8_t out[2];
+    char enc[8];
+    TEST_ASSERT_EQUAL(-1, fl_base64_decode("Zm9v", 4, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(2, fl_base64_decode("Zm8=", 4, out, sizeof(out)));
+    /* Needs 4 chars + NUL */
+    TEST_ASSERT_EQUAL(-1, fl_base64_encode((const uint8_t*)"foo", 3, enc, 4));
+    TEST_ASSERT_EQUAL(4, fl_base64_encode((const uint8_t*)"foo", 3, enc, 5));
+}
+
+void test_codec_base64_quad(void) {
+    uint8_t out[3];
+    TEST_ASSERT_EQUAL(3, fl_base64_decode_quad((const uint8_t*)"Zm9v", out));
+    TEST_ASSERT_EQUAL_MEMORY("foo", out, 3);
+    TEST_ASSERT_EQUAL(2, fl_base64_decode_quad((const uint8_t*)"Zm8=", out));
+    TEST_ASSERT_EQUAL(1, fl_base64_decode_quad((const uint8_t*)"Zg==", out));
+    TEST_ASSERT_EQUAL(-1, fl_base64_decode_quad((const uint8_t*)"Z===", out));
+    TEST_ASSERT_EQUAL(-1, fl_base64_decode_quad((const uint8_t*)"Zm=v", out));
+}
+
+/* ============================================================================
+ * LZ Tests
+ * ============================================================================ */
+
+/* bytes(range(16)) * 4 + b"Hello, Hello, Hello, FPBInject!" + bytes(40) */
+static size_t lz_vector(uint8_t* out) {
+    size_t n = 0;
+    for (int i = 0; i < 64; i++)
+        out[n++] = (uint8_t)(i % 16);
+    memcpy(out + n, "Hello, Hello, Hello, FPBInject!", 31);
+    n += 31;
+    memset(out + n, 0, 40);
+    return n + 40;
+}
+
+void test_codec_lz_vector(void) {
+    /* Same block as utils/lz.py compress() */
+    static const uint8_t expected[] = {
+        0xFF, 0x01, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D,
+        0x0E, 0x0F, 0x10, 0x00, 0x1D, 0x7A, 0x48, 0x65, 0x6C, 0x6C, 0x6F, 0x2C, 0x20, 0x07, 0x00, 0xBF,
+        0x46, 0x50, 0x42, 0x49, 0x6E, 0x6A, 0x65, 0x63, 0x74, 0x21, 0x00, 0x01, 0x00, 0x0F, 0x50, 0x00,
+        0x00, 0x00, 0x00, 0x00,
+    };
+    uint8_t in[160], out[160], dec[160];
+    size_t len = lz_vector(in);
+
+    int n = fl_lz_compress(in, len, out, sizeof(out));
+    TEST_ASSERT_EQUAL((int)sizeof(expected), n);
+    TEST_ASSERT_EQUAL_MEMORY(expected, out, sizeof(expected));
+    TEST_ASSERT_EQUAL((int)len, fl_lz_decompress(out, (size_t)n, dec, sizeof(dec)));
+    TEST_ASSERT_EQUAL_MEMORY(in, dec, len);
+}
+
+void test_codec_lz_roundtrip(void) {
+    static uint8_t data[1024], comp[1100], dec[1024];
+    /* Thumb-like code: repeated idioms, a zero-filled tail */
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = (i < 700) ? (uint8_t)((i % 8 < 4) ? 0x47 + (i % 3) : i * 151) : 0;
+
+    for (size_t len = 0; len <= sizeof(data); len += (len < 32 ? 1 : 97)) {
+        int n = fl_lz_compress(data, len, comp, sizeof(comp));
+        TEST_ASSERT(n > 0);
+        TEST_ASSERT_EQUAL((int)len, fl_lz_decompress(comp, (size_t)n, dec, sizeof(dec)));
+        TEST_ASSERT_EQUAL_MEMORY(data, dec, len);
+    }
+
+    /* Zero fill compresses to almost nothing */
+    memset(data, 0, sizeof(data));
+    int n = fl_lz_compress(data, sizeof(data), comp, sizeof(comp));
+    TEST_ASSERT(n > 0 && n < 32);
+    TEST_ASSERT_EQUAL((int)sizeof(data), fl_lz_decompress(comp, (size_t)n, dec, sizeof(dec)));
+    TEST_ASSERT_EQUAL_MEMORY(data, dec, sizeof(data));
+}
+
+void test_codec_lz_bounds(void) {
+    uint8_t data[64], comp[80], dec[64];
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i * 151 + 7);
+
+    /* Incompressible data does not fit in less than its own size */
+    TEST_ASSERT_EQUAL(-1, fl_lz_compress(data, sizeof(data), comp, sizeof(data) - 1));
+    int n = fl_lz_compress(data, sizeof(data), comp, sizeof(comp));
+    TEST_ASSERT(n > (int)sizeof(data));
+
+    /* Output limit */
+    TEST_ASSERT_EQUAL(-1, fl_lz_decompress(comp, (size_t)n, dec, sizeof(dec) - 1));
+    TEST_ASSERT_EQUAL((int)sizeof(dec), fl_lz_decompress(comp, (size_t)n, dec, sizeof(dec)));
+}
+
+void test_codec_lz_invalid(void) {
+    uint8_t out[32];
+    static const uint8_t zero_offset[] = {0x14, 'a', 0x00, 0x00, 0x10, 'b'};
+    static const uint8_t far_offset[] = {0x14, 'a', 0x02, 0x00, 0x10, 'b'};
+    static const uint8_t short_literals[] = {0x30, 'a', 'b'};
+    static const uint8_t short_offset[] = {0x10, 'a', 0x01};
+    static const uint8_t short_ext[] = {0xF0, 0xFF};
+    static const uint8_t run[] = {0x1B, 'a', 0x01, 0x00, 0x50, 'b', 'b', 'b', 'b', 'b'};
+
+    TEST_ASSERT_EQUAL(-1, fl_lz_decompress(zero_offset, sizeof(zero_offset), out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, fl_lz_decompress(far_offset, sizeof(far_offset), out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, fl_lz_decompress(short_literals, sizeof(short_literals), out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, fl_lz_decompress(short_offset, sizeof(short_offset), out, sizeof(out)));
+    TEST_ASSERT_EQUAL(-1, fl_lz_decompress(short_ext, sizeof(short_ext), out, sizeof(out)));
+
+    /* Overlapping match expands a run: 'a' + 15 x 'a' + "bbbbb" */
+    TEST_ASSERT_EQUAL(21, fl_lz_decompress(run, sizeof(run), out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY("aaaaaaaaaaaaaaaabbbbb", out, 21);
+    TEST_ASSERT_EQUAL(-1, fl_lz_decompress(run, sizeof(run), out, 20));
+}
+
+/* ============================================================================
+ * Test Runner
+ * ============================================================================ */
+
+void run_codec_tests(void) {
+    TEST_SUITE_BEGIN("func_loader_codec - CRC-16");
+    RUN_TEST(test_codec_crc16_check_value);
+    RUN_TEST(test_codec_crc16_slices_match_bytewise);
+    RUN_TEST(test_codec_crc16_incremental);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader_codec - CRC-32");
+    RUN_TEST(test_codec_crc32_check_value);
+    RUN_TEST(test_codec_crc32_slices_match_bytewise);
+    RUN_TEST(test_codec_crc32_incremental);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader_codec - Base64");
+    RUN_TEST(test_codec_base64_rfc4648);
+    RUN_TEST(test_codec_base64_roundtrip);
+    RUN_TEST(test_codec_base64_invalid);
+    RUN_TEST(test_codec_base64_bounds);
+    RUN_TEST(test_codec_base64_quad);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader_codec - LZ");
+    RUN_TEST(test_codec_lz_vector);
+    RUN_TEST(test_codec_lz_roundtrip);
+    RUN_TEST(test_codec_lz_bounds);
+    RUN_TEST(test_codec_lz_invalid);
+    TEST_SUITE_END();
+}
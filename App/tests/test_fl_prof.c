@@ -0,0 +1,221 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 VIFEX
+ *
+ * Tests for fl_prof.c - PC-sampling profiler
+ */
+
+#include "test_framework.h"
+#include "mock_hardware.h"
+#include "fpb_mock_regs.h"
+#include "fl.h"
+#include "fl_log.h"
+#include "fl_prof.h"
+
+/* Test context */
+static fl_context_t test_ctx;
+
+/* Fake sample timer */
+static uint32_t s_timer_hz;
+static int s_timer_calls;
+static uint32_t s_timer_max_hz;
+
+static bool fake_timer(uint32_t hz) {
+    s_timer_calls++;
+    if (hz > s_timer_max_hz)
+        return false;
+    s_timer_hz = hz;
+    return true;
+}
+
+/* ============================================================================
+ * Setup/Teardown
+ * ============================================================================ */
+
+static void setup_prof(void) {
+    mock_output_reset();
+    mock_heap_reset();
+    mock_fpb_reset();
+    memset(&test_ctx, 0, sizeof(test_ctx));
+
+    test_ctx.output_cb = mock_output_cb;
+    test_ctx.output_user = NULL;
+    test_ctx.malloc_cb = mock_malloc;
+    test_ctx.free_cb = mock_free;
+    test_ctx.prof_timer_cb = fake_timer;
+
+    fl_log_tx_init(NULL, 0, NULL, NULL);
+    fl_init(&test_ctx);
+
+    s_timer_hz = 0;
+    s_timer_calls = 0;
+    s_timer_max_hz = 10000;
+}
+
+static void exec(int argc, const char** argv) {
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, argc, argv);
+}
+
+static void prof_mode(const char* mode) {
+    const char* argv[] = {"fl", "--cmd", "prof", "--mode", mode};
+    exec(5, argv);
+}
+
+/* Sampling interrupt with an exception frame whose stacked PC is pc */
+static void fake_isr(uint32_t pc) {
+    uint32_t frame[8] = {0};
+    frame[FL_PROF_FRAME_PC] = pc;
+    fl_prof_isr(&test_ctx.prof, frame);
+}
+
+/* ============================================================================
+ * Command Tests
+ * ============================================================================ */
+
+void test_prof_cmd_no_timer(void) {
+    setup_prof();
+    test_ctx.prof_timer_cb = NULL;
+    prof_mode("start");
+    TEST_ASSERT(mock_output_contains("[FLERR] No sample timer"));
+    TEST_ASSERT_FALSE(test_ctx.prof.running);
+
+    /* Capability follows the timer */
+    const char* ping[] = {"fl", "--cmd", "ping"};
+    exec(3, ping);
+    TEST_ASSERT(mock_output_contains("PONG caps=0x0002AFFA"));
+    test_ctx.prof_timer_cb = fake_timer;
+    exec(3, ping);
+    TEST_ASSERT(mock_output_contains("PONG caps=0x0002EFFA"));
+}
+
+void test_prof_cmd_start_default_rate(void) {
+    setup_prof();
+    prof_mode("start");
+    TEST_ASSERT(mock_output_contains("[FLOK] PROF start hz=997 slots=256"));
+    TEST_ASSERT_TRUE(test_ctx.prof.running);
+    TEST_ASSERT_EQUAL(FL_PROF_DEFAULT_HZ, s_timer_hz);
+}
+
+void test_prof_cmd_start_rate(void) {
+    setup_prof();
+    const char* argv[] = {"fl", "--cmd", "prof", "--mode", "start", "--value", "5000"};
+    exec(7, argv);
+    TEST_ASSERT(mock_output_contains("[FLOK] PROF start hz=5000"));
+    TEST_ASSERT_EQUAL(5000, s_timer_hz);
+
+    const char* fast[] = {"fl", "--cmd", "prof", "--mode", "start", "--value", "50000"};
+    exec(7, fast);
+    TEST_ASSERT(mock_output_contains("[FLERR] Unsupported rate 50000 Hz"));
+    TEST_ASSERT_FALSE(test_ctx.prof.running);
+}
+
+void test_prof_cmd_lifecycle(void) {
+    setup_prof();
+    prof_mode("start");
+    fake_isr(0x08000101);
+    fake_isr(0x08000101);
+    fake_isr(0x08000200);
+
+    const char* status[] = {"fl", "--cmd", "prof"};
+    exec(3, status);
+    TEST_ASSERT(mock_output_contains("[FLOK] PROF running hz=997 samples=3 overflow=0 buckets=2"));
+
+    prof_mode("stop");
+    TEST_ASSERT(mock_output_contains("[FLOK] PROF stop samples=3"));
+    TEST_ASSERT_EQUAL(0, s_timer_hz);
+    TEST_ASSERT_FALSE(test_ctx.prof.running);
+
+    /* A late interrupt after stop is not counted */
+    fake_isr(0x08000200);
+    prof_mode("dump");
+    TEST_ASSERT(mock_output_contains("0x08000100 2\n"));
+    TEST_ASSERT(mock_output_contains("0x08000200 1\n"));
+    TEST_ASSERT(mock_output_contains("[FLOK] PROF stopped hz=997 samples=3 overflow=0 buckets=2"));
+
+    /* Restart clears the previous profile */
+    prof_mode("start");
+    prof_mode("dump");
+    TEST_ASSERT_FALSE(mock_output_contains("0x08000100"));
+    TEST_ASSERT(mock_output_contains("samples=0 overflow=0 buckets=0"));
+}
+
+void test_prof_cmd_invalid_mode(void) {
+    setup_prof();
+    const char* argv[] = {"fl", "--cmd", "prof", "--mode", "bogus"};
+    mock_output_reset();
+    TEST_ASSERT_EQUAL(-1, fl_exec_cmd(&test_ctx, 5, argv));
+    TEST_ASSERT(mock_output_contains("[FLERR] Invalid mode 'bogus'"));
+}
+
+/* ============================================================================
+ * Histogram Tests
+ * ============================================================================ */
+
+void test_prof_histogram_counts(void) {
+    fl_prof_t p;
+    fl_prof_reset(&p);
+    p.running = true;
+    for (uint32_t i = 0; i < 64; i++) {
+        for (uint32_t n = 0; n <= i % 4; n++)
+            fl_prof_record(&p, 0x08001000 + i * 2);
+    }
+    TEST_ASSERT_EQUAL(64, p.used);
+    TEST_ASSERT_EQUAL(0, p.overflow);
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < FL_PROF_SLOTS; i++) {
+        const fl_prof_bucket_t* b = &p.buckets[i];
+        if (b->count == 0)
+            continue;
+        TEST_ASSERT_EQUAL((b->pc - 0x08001000) / 2 % 4 + 1, b->count);
+        total += b->count;
+    }
+    TEST_ASSERT_EQUAL(p.samples, total);
+}
+
+void test_prof_histogram_overflow(void) {
+    /* More distinct PCs than buckets: nothing is evicted, the rest is overflow */
+    fl_prof_t p;
+    fl_prof_reset(&p);
+    p.running = true;
+    for (uint32_t i = 0; i < FL_PROF_SLOTS * 2; i++)
+        fl_prof_record(&p, 0x08000000 + i * 4);
+
+    TEST_ASSERT(p.used <= FL_PROF_SLOTS);
+    TEST_ASSERT(p.overflow > 0);
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < FL_PROF_SLOTS; i++)
+        total += p.buckets[i].count;
+    TEST_ASSERT_EQUAL(p.used, total);
+    TEST_ASSERT_EQUAL(p.samples, total + p.overflow);
+}
+
+void test_prof_histogram_stopped(void) {
+    fl_prof_t p;
+    fl_prof_reset(&p);
+    fl_prof_record(&p, 0x08000000);
+    TEST_ASSERT_EQUAL(0, p.samples);
+    TEST_ASSERT_EQUAL(0, p.used);
+}
+
+/* ============================================================================
+ * Test Runner
+ * ============================================================================ */
+
+void run_prof_tests(void) {
+    TEST_SUITE_BEGIN("func_loader_prof - Commands");
+    RUN_TEST(test_prof_cmd_no_timer);
+    RUN_TEST(test_prof_cmd_start_default_rate);
+    RUN_TEST(test_prof_cmd_start_rate);
+    RUN_TEST(test_prof_cmd_lifecycle);
+    RUN_TEST(test_prof_cmd_invalid_mode);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader_prof - Histogram");
+    RUN_TEST(test_prof_histogram_counts);
+    RUN_TEST(test_prof_histogram_overflow);
+    RUN_TEST(test_prof_histogram_stopped);
+    TEST_SUITE_END();
+}
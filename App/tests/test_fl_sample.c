@@ -0,0 +1,351 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 VIFEX
+ *
+ * Tests for fl_sample.c - Periodic variable sampler
+ */
+
+#include "test_framework.h"
+#include "mock_hardware.h"
+#include "fpb_mock_regs.h"
+#include "fl.h"
+#include "fl_codec.h"
+#include "fl_log.h"
+#include "fl_sample.h"
+
+/* Test context */
+static fl_context_t test_ctx;
+
+/* Sampled variables */
+static volatile uint32_t s_var_a;
+static volatile uint16_t s_var_b;
+
+/* Fake timestamp */
+static uint32_t s_now;
+
+static uint32_t fake_timestamp(void) {
+    return s_now;
+}
+
+/* ============================================================================
+ * Setup/Teardown
+ * ============================================================================ */
+
+static void setup_sample(void) {
+    mock_output_reset();
+    mock_heap_reset();
+    mock_fpb_reset();
+    memset(&test_ctx, 0, sizeof(test_ctx));
+
+    test_ctx.output_cb = mock_output_cb;
+    test_ctx.output_user = NULL;
+    test_ctx.malloc_cb = mock_malloc;
+    test_ctx.free_cb = mock_free;
+
+    fl_log_tx_init(NULL, 0, NULL, NULL);
+    fl_init(&test_ctx);
+
+    s_var_a = 0x11223344;
+    s_var_b = 0x5566;
+    s_now = 0;
+}
+
+static void exec(int argc, const char** argv) {
+    mock_output_reset();
+    fl_exec_cmd(&test_ctx, argc, argv);
+}
+
+static void add_probe(const volatile void* addr, size_t len) {
+    char a[24], l[8];
+    snprintf(a, sizeof(a), "0x%lX", (unsigned long)(uintptr_t)addr);
+    snprintf(l, sizeof(l), "%u", (unsigned)len);
+    const char* argv[] = {"fl", "--cmd", "sample", "--mode", "add", "--addr", a, "--len", l};
+    exec(9, argv);
+}
+
+static void start_sampler(const char* period_us) {
+    const char* argv[] = {"fl", "--cmd", "sample", "--mode", "start", "--value", period_us};
+    exec(7, argv);
+}
+
+/* Decode the records of the [FLSMP] lines in the output, returns the byte count */
+static size_t decode_lines(uint8_t* out, size_t max) {
+    size_t n = 0;
+    const char* p = mock_output_get();
+    while ((p = strstr(p, "[FLSMP] ")) != NULL) {
+        p += 8;
+        const char* end = strchr(p, '\n');
+        int len = fl_base64_decode(p, (size_t)(end - p), out + n, max - n);
+        TEST_ASSERT(len > 0);
+        n += (size_t)len;
+        p = end;
+    }
+    return n;
+}
+
+static uint32_t rec_ts(const uint8_t* rec) {
+    return (uint32_t)rec[1] | ((uint32_t)rec[2] << 8) | ((uint32_t)rec[3] << 16) | ((uint32_t)rec[4] << 24);
+}
+
+/* ============================================================================
+ * Command Tests
+ * ============================================================================ */
+
+void test_sample_cmd_add(void) {
+    setup_sample();
+    add_probe(&s_var_a, 4);
+    TEST_ASSERT(mock_output_contains("[FLOK] SAMPLE probe=0"));
+    add_probe(&s_var_b, 2);
+    TEST_ASSERT(mock_output_contains("[FLOK] SAMPLE probe=1"));
+    TEST_ASSERT_EQUAL(2, test_ctx.sample.count);
+
+    add_probe(&s_var_a, FL_SAMPLE_PROBE_SIZE + 1);
+    TEST_ASSERT(mock_output_contains("[FLERR] Invalid probe"));
+    TEST_ASSERT_EQUAL(2, test_ctx.sample.count);
+}
+
+void test_sample_cmd_add_full(void) {
+    setup_sample();
+    for (int i = 0; i < FL_SAMPLE_MAX_PROBES; i++)
+        add_probe(&s_var_a, 4);
+    add_probe(&s_var_a, 4);
+    TEST_ASSERT(mock_output_contains("[FLERR] Invalid probe"));
+    TEST_ASSERT_EQUAL(FL_SAMPLE_MAX_PROBES, test_ctx.sample.count);
+}
+
+void test_sample_cmd_start_no_probes(void) {
+    setup_sample();
+    start_sampler("0");
+    TEST_ASSERT(mock_output_contains("[FLERR] No probes"));
+    TEST_ASSERT_FALSE(test_ctx.sample.running);
+}
+
+void test_sample_cmd_lifecycle(void) {
+    setup_sample();
+    add_probe(&s_var_a, 4);
+    start_sampler("0");
+    TEST_ASSERT(mock_output_contains("[FLOK] SAMPLE start probes=1"));
+    TEST_ASSERT_TRUE(test_ctx.sample.running);
+
+    /* Probes are fixed while running */
+    add_probe(&s_var_b, 2);
+    TEST_ASSERT(mock_output_contains("[FLERR] Sampler running"));
+
+    const char* status[] = {"fl", "--cmd", "sample"};
+    exec(3, status);
+    TEST_ASSERT(mock_output_contains("[FLOK] SAMPLE running probes=1"));
+
+    const char* stop[] = {"fl", "--cmd", "sample", "--mode", "stop"};
+    exec(5, stop);
+    TEST_ASSERT(mock_output_contains("[FLOK] SAMPLE stop records=0 dropped=0"));
+    TEST_ASSERT_FALSE(test_ctx.sample.running);
+
+    const char* clear[] = {"fl", "--cmd", "sample", "--mode", "clear"};
+    exec(5, clear);
+    TEST_ASSERT(mock_output_contains("[FLOK] SAMPLE clear"));
+    TEST_ASSERT_EQUAL(0, test_ctx.sample.count);
+}
+
+void test_sample_cmd_invalid_mode(void) {
+    setup_sample();
+    const char* argv[] = {"fl", "--cmd", "sample", "--mode", "bogus"};
+    exec(5, argv);
+    TEST_ASSERT(mock_output_contains("[FLERR] Invalid mode 'bogus'"));
+}
+
+void test_sample_cmd_period(void) {
+    setup_sample();
+    test_ctx.timestamp_cb = fake_timestamp;
+    test_ctx.timestamp_hz = 72000000;
+    add_probe(&s_var_a, 4);
+    start_sampler("1000");
+    TEST_ASSERT(mock_output_contains("period=72000 hz=72000000"));
+    TEST_ASSERT_EQUAL(72000, test_ctx.sample.period);
+}
+
+/* ============================================================================
+ * Record Tests
+ * ============================================================================ */
+
+void test_sample_key_then_delta(void) {
+    setup_sample();
+    add_probe(&s_var_a, 4);
+    add_probe(&s_var_b, 2);
+    start_sampler("0");
+
+    /* First record is a key record with every probe */
+    mock_output_reset();
+    fl_sample_poll(&test_ctx);
+    uint8_t buf[256];
+    size_t n = decode_lines(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(FL_SAMPLE_REC_HDR_SIZE + 6, n);
+    TEST_ASSERT_EQUAL(0, buf[0]);
+    TEST_ASSERT_EQUAL(0x03, buf[5]);
+    TEST_ASSERT_EQUAL(0x44, buf[6]);
+    TEST_ASSERT_EQUAL(0x11, buf[9]);
+    TEST_ASSERT_EQUAL(0x66, buf[10]);
+    TEST_ASSERT_EQUAL(0x55, buf[11]);
+
+    /* Unchanged: no record */
+    mock_output_reset();
+    fl_sample_poll(&test_ctx);
+    TEST_ASSERT_FALSE(mock_output_contains("[FLSMP]"));
+
+    /* Only the changed probe is sent */
+    s_var_b = 0x7788;
+    mock_output_reset();
+    fl_sample_poll(&test_ctx);
+    n = decode_lines(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(FL_SAMPLE_REC_HDR_SIZE + 2, n);
+    TEST_ASSERT_EQUAL(1, buf[0]);
+    TEST_ASSERT_EQUAL(0x02, buf[5]);
+    TEST_ASSERT_EQUAL(0x88, buf[6]);
+    TEST_ASSERT_EQUAL(0x77, buf[7]);
+}
+
+void test_sample_period_gating(void) {
+    setup_sample();
+    test_ctx.timestamp_cb = fake_timestamp;
+    test_ctx.timestamp_hz = 1000000;
+    add_probe(&s_var_a, 4);
+    s_now = 5000;
+    start_sampler("100");
+
+    uint8_t buf[256];
+    for (uint32_t i = 0; i < 10; i++) {
+        s_var_a = i;
+        s_now = 5000 + i * 50;
+        mock_output_reset();
+        fl_sample_poll(&test_ctx);
+        size_t n = decode_lines(buf, sizeof(buf));
+        /* Sampled at 5000, 5100, 5200, ... */
+        if (i % 2 == 0) {
+            TEST_ASSERT_EQUAL(FL_SAMPLE_REC_HDR_SIZE + 4, n);
+            TEST_ASSERT_EQUAL(s_now, rec_ts(buf));
+            TEST_ASSERT_EQUAL(i, buf[6]);
+        } else {
+            TEST_ASSERT_EQUAL(0, n);
+        }
+    }
+
+    /* A stall skips the missed periods instead of bursting */
+    s_now += 1000;
+    s_var_a = 100;
+    fl_sample_poll(&test_ctx);
+    s_var_a = 101;
+    s_now += 50;
+    mock_output_reset();
+    fl_sample_poll(&test_ctx);
+    TEST_ASSERT_FALSE(mock_output_contains("[FLSMP]"));
+}
+
+void test_sample_ring_drop_resyncs(void) {
+    setup_sample();
+    test_ctx.sample.isr_tick = true;
+    add_probe(&s_var_a, 4);
+    start_sampler("0");
+
+    /* Tick without draining until the ring is full */
+    uint32_t ticks = FL_SAMPLE_RING_SIZE / (FL_SAMPLE_REC_HDR_SIZE + 4) + 4;
+    for (uint32_t i = 0; i < ticks; i++) {
+        s_var_a = i;
+        fl_sample_tick(&test_ctx);
+    }
+    TEST_ASSERT(test_ctx.sample.dropped > 0);
+    TEST_ASSERT_TRUE(test_ctx.sample.key);
+    TEST_ASSERT_EQUAL(ticks, test_ctx.sample.records + test_ctx.sample.dropped);
+
+    /* isr_tick: poll only drains */
+    uint32_t records = test_ctx.sample.records;
+    while (test_ctx.sample.head != test_ctx.sample.tail)
+        fl_sample_poll(&test_ctx);
+    TEST_ASSERT_EQUAL(records, test_ctx.sample.records);
+
+    /* Next record is a key record */
+    mock_output_reset();
+    fl_sample_tick(&test_ctx);
+    fl_sample_drain(&test_ctx);
+    uint8_t buf[64];
+    size_t n = decode_lines(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(FL_SAMPLE_REC_HDR_SIZE + 4, n);
+    TEST_ASSERT_EQUAL(0x01, buf[5]);
+    TEST_ASSERT_FALSE(test_ctx.sample.key);
+}
+
+void test_sample_key_interval(void) {
+    setup_sample();
+    test_ctx.sample.isr_tick = true;
+    add_probe(&s_var_a, 4);
+    add_probe(&s_var_b, 2);
+    start_sampler("0");
+
+    uint8_t buf[64];
+    int keys = 0;
+    for (uint32_t i = 0; i <= FL_SAMPLE_KEY_INTERVAL + 1; i++) {
+        s_var_a = i;
+        mock_output_reset();
+        fl_sample_tick(&test_ctx);
+        fl_sample_drain(&test_ctx);
+        decode_lines(buf, sizeof(buf));
+        if (buf[5] == 0x03)
+            keys++;
+    }
+    TEST_ASSERT_EQUAL(2, keys);
+}
+
+void test_sample_line_whole_records(void) {
+    setup_sample();
+    test_ctx.sample.isr_tick = true;
+    add_probe(&s_var_a, 4);
+    start_sampler("0");
+
+    /* More records than fit one line: split on record boundaries */
+    for (uint32_t i = 0; i < 20; i++) {
+        s_var_a = i;
+        fl_sample_tick(&test_ctx);
+    }
+    mock_output_reset();
+    while (test_ctx.sample.head != test_ctx.sample.tail)
+        fl_sample_drain(&test_ctx);
+
+    uint8_t buf[512];
+    size_t n = decode_lines(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(20 * (FL_SAMPLE_REC_HDR_SIZE + 4), n);
+    for (uint32_t i = 0; i < 20; i++) {
+        const uint8_t* rec = buf + i * (FL_SAMPLE_REC_HDR_SIZE + 4);
+        TEST_ASSERT_EQUAL(i, rec[0]);
+        TEST_ASSERT_EQUAL(i, rec[6]);
+    }
+}
+
+void test_sample_stopped_no_tick(void) {
+    setup_sample();
+    add_probe(&s_var_a, 4);
+    fl_sample_poll(&test_ctx);
+    TEST_ASSERT_EQUAL(0, test_ctx.sample.records);
+    TEST_ASSERT_FALSE(mock_output_contains("[FLSMP]"));
+}
+
+/* ============================================================================
+ * Test Runner
+ * ============================================================================ */
+
+void run_sample_tests(void) {
+    TEST_SUITE_BEGIN("func_loader_sample - Commands");
+    RUN_TEST(test_sample_cmd_add);
+    RUN_TEST(test_sample_cmd_add_full);
+    RUN_TEST(test_sample_cmd_start_no_probes);
+    RUN_TEST(test_sample_cmd_lifecycle);
+    RUN_TEST(test_sample_cmd_invalid_mode);
+    RUN_TEST(test_sample_cmd_period);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader_sample - Records");
+    RUN_TEST(test_sample_key_then_delta);
+    RUN_TEST(test_sample_period_gating);
+    RUN_TEST(test_sample_ring_drop_resyncs);
+    RUN_TEST(test_sample_key_interval);
+    RUN_TEST(test_sample_line_whole_records);
+    RUN_TEST(test_sample_stopped_no_tick);
+    TEST_SUITE_END();
+}
@@ -9,6 +9,7 @@
 #include "mock_hardware.h"
 #include "fpb_mock_regs.h"
 #include "fl.h"
+#include "fl_frame.h"
 #include "fl_stream.h"
 
 /* Test context and stream */
@@ -42,6 +43,7 @@ static void setup_stream(void) {
     test_serial.write_cb = mock_serial_write;
     test_serial.available_cb = mock_serial_available;
 
+    fl_log_tx_init(NULL, 0, NULL, NULL);
     fl_init(&test_ctx);
     fl_stream_init(&test_stream, &test_ctx, &test_serial, line_buf, sizeof(line_buf));
 }
@@ -243,6 +245,633 @@ void test_stream_process_buffer_full(void) {
     /* Should not crash */
 }
 
+/* ============================================================================
+ * Binary Frame Tests
+ * ============================================================================ */
+
+/* Build "\n" + frame (the leading newline is how the host resyncs) */
+static size_t build_frame(uint8_t* out, uint8_t seq, uint8_t op, const uint8_t* payload, size_t plen) {
+    size_t pos = 0;
+    out[pos++] = '\n';
+    uint8_t* frame = out + pos;
+    frame[0] = FL_FRAME_SOF;
+    frame[1] = 0;
+    frame[2] = seq;
+    frame[3] = op;
+    frame[4] = (uint8_t)(plen & 0xFF);
+    frame[5] = (uint8_t)(plen >> 8);
+    if (plen > 0) {
+        memcpy(frame + FL_FRAME_HDR_SIZE, payload, plen);
+    }
+    uint16_t crc = fl_crc16_update(0xFFFF, frame + 1, FL_FRAME_HDR_SIZE - 1 + plen);
+    frame[FL_FRAME_HDR_SIZE + plen] = (uint8_t)(crc & 0xFF);
+    frame[FL_FRAME_HDR_SIZE + plen + 1] = (uint8_t)(crc >> 8);
+    return pos + FL_FRAME_OVERHEAD + plen;
+}
+
+/* Reassembled response: text and data collected from all frames */
+typedef struct {
+    int frames;
+    bool complete;
+    uint8_t seq;
+    uint8_t op;
+    char text[512];
+    size_t text_len;
+    uint8_t data[256];
+    size_t data_len;
+} frame_resp_t;
+
+static bool parse_frames(frame_resp_t* r) {
+    const uint8_t* p = (const uint8_t*)g_mock_serial.tx_buffer;
+    size_t len = g_mock_serial.tx_len;
+    size_t pos = 0;
+
+    memset(r, 0, sizeof(*r));
+    while (pos + FL_FRAME_OVERHEAD <= len) {
+        if (p[pos] != FL_FRAME_SOF)
+            return false;
+        size_t plen = (size_t)(p[pos + 4] | (p[pos + 5] << 8));
+        if (pos + FL_FRAME_OVERHEAD + plen > len)
+            return false;
+        uint16_t crc = fl_crc16_update(0xFFFF, p + pos + 1, FL_FRAME_HDR_SIZE - 1 + plen);
+        const uint8_t* tail = p + pos + FL_FRAME_HDR_SIZE + plen;
+        if (crc != (uint16_t)(tail[0] | (tail[1] << 8)))
+            return false;
+
+        uint8_t flags = p[pos + 1];
+        const uint8_t* payload = p + pos + FL_FRAME_HDR_SIZE;
+        r->seq = p[pos + 2];
+        r->op = p[pos + 3];
+        if (flags & FL_FRAME_F_DATA) {
+            memcpy(r->data + r->data_len, payload, plen);
+            r->data_len += plen;
+        } else {
+            memcpy(r->text + r->text_len, payload, plen);
+            r->text_len += plen;
+        }
+        r->frames++;
+        r->complete = !(flags & FL_FRAME_F_MORE);
+        pos += FL_FRAME_OVERHEAD + plen;
+    }
+    return pos == len;
+}
+
+static size_t tlv_int(uint8_t* buf, size_t pos, uint8_t tag, uint64_t v, size_t size) {
+    buf[pos++] = tag;
+    buf[pos++] = (uint8_t)size;
+    buf[pos++] = 0;
+    for (size_t i = 0; i < size; i++) {
+        buf[pos++] = (uint8_t)(v >> (8 * i));
+    }
+    return pos;
+}
+
+static int tx_count(const char* needle) {
+    size_t n = strlen(needle);
+    int count = 0;
+    for (size_t i = 0; i + n <= g_mock_serial.tx_len; i++) {
+        if (memcmp(g_mock_serial.tx_buffer + i, needle, n) == 0)
+            count++;
+    }
+    return count;
+}
+
+void test_stream_frame_caps(void) {
+    setup_stream();
+    TEST_ASSERT(test_ctx.caps & FL_CAP_FRAME);
+}
+
+void test_stream_frame_ping(void) {
+    setup_stream();
+    uint8_t in[32];
+    size_t n = build_frame(in, 0x42, FL_OP_PING, NULL, 0);
+    mock_serial_set_input_bin(in, n);
+    fl_stream_process(&test_stream);
+
+    frame_resp_t r;
+    TEST_ASSERT(parse_frames(&r));
+    TEST_ASSERT(r.complete);
+    TEST_ASSERT_EQUAL(0x42, r.seq);
+    TEST_ASSERT_EQUAL(FL_OP_PING, r.op);
+    r.text[r.text_len] = '\0';
+    TEST_ASSERT(strstr(r.text, "[FLOK] PONG caps=0x0002AFFF") != NULL);
+    TEST_ASSERT(strstr(r.text, "[FLEND]") != NULL);
+}
+
+void test_stream_frame_read_raw(void) {
+    setup_stream();
+    static const uint8_t src[48] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+
+    uint8_t payload[32];
+    size_t plen = tlv_int(payload, 0, FL_TAG_ADDR, (uintptr_t)src, sizeof(uintptr_t));
+    plen = tlv_int(payload, plen, FL_TAG_LEN, sizeof(src), 4);
+
+    uint8_t in[64];
+    size_t n = build_frame(in, 7, FL_OP_READ, payload, plen);
+    mock_serial_set_input_bin(in, n);
+    fl_stream_process(&test_stream);
+
+    frame_resp_t r;
+    TEST_ASSERT(parse_frames(&r));
+    TEST_ASSERT(r.complete);
+    TEST_ASSERT_EQUAL(3, r.frames); /* header text, data, trailer */
+    TEST_ASSERT_EQUAL(sizeof(src), r.data_len);
+    TEST_ASSERT_EQUAL_MEMORY(src, r.data, sizeof(src));
+    r.text[r.text_len] = '\0';
+    TEST_ASSERT(strstr(r.text, "READ 48 bytes") != NULL);
+}
+
+void test_stream_frame_echoback_raw(void) {
+    setup_stream();
+    uint8_t payload[16];
+    size_t plen = tlv_int(payload, 0, FL_TAG_LEN, 4, 4);
+
+    uint8_t in[32];
+    size_t n = build_frame(in, 1, FL_OP_ECHOBACK, payload, plen);
+    mock_serial_set_input_bin(in, n);
+    fl_stream_process(&test_stream);
+
+    frame_resp_t r;
+    TEST_ASSERT(parse_frames(&r));
+    TEST_ASSERT_EQUAL(4, r.data_len);
+    static const uint8_t expected[] = {0, 1, 2, 3};
+    TEST_ASSERT_EQUAL_MEMORY(expected, r.data, 4);
+}
+
+void test_stream_frame_bad_crc_resync(void) {
+    setup_stream();
+    uint8_t in[64];
+    size_t n = build_frame(in, 1, FL_OP_PING, NULL, 0);
+    in[n - 1] ^= 0xFF; /* Corrupt CRC */
+    n += build_frame(in + n, 2, FL_OP_PING, NULL, 0);
+    mock_serial_set_input_bin(in, n);
+    fl_stream_process(&test_stream);
+
+    TEST_ASSERT_EQUAL(1, tx_count("Frame CRC mismatch"));
+    TEST_ASSERT_EQUAL(1, tx_count("PONG"));
+    TEST_ASSERT_EQUAL(FL_STREAM_RX_LINE, test_stream.rx_state);
+}
+
+void test_stream_frame_too_large(void) {
+    setup_stream();
+    uint8_t in[16];
+    build_frame(in, 3, FL_OP_PING, NULL, 0);
+    /* Claim a payload far beyond line_buf; header is all that is sent */
+    in[1 + 4] = 0xFF;
+    in[1 + 5] = 0x0F;
+    mock_serial_set_input_bin(in, 1 + FL_FRAME_HDR_SIZE);
+    fl_stream_process(&test_stream);
+
+    frame_resp_t r;
+    TEST_ASSERT(parse_frames(&r));
+    r.text[r.text_len] = '\0';
+    TEST_ASSERT(strstr(r.text, "Frame too large") != NULL);
+    TEST_ASSERT_EQUAL(FL_STREAM_RX_DISCARD, test_stream.rx_state);
+}
+
+void test_stream_frame_then_text(void) {
+    setup_stream();
+    uint8_t in[64];
+    size_t n = build_frame(in, 9, FL_OP_PING, NULL, 0);
+    memcpy(in + n, "\nfl --cmd ping\n", 15);
+    n += 15;
+    mock_serial_set_input_bin(in, n);
+    fl_stream_process(&test_stream);
+
+    /* Text command still answered (unframed) after a frame */
+    TEST_ASSERT_EQUAL(2, tx_count("[FLOK] PONG"));
+    TEST_ASSERT(strcmp(g_mock_serial.tx_buffer + g_mock_serial.tx_len - 8, "[FLEND]\n") == 0);
+    TEST_ASSERT(test_ctx.output_data_cb == NULL);
+}
+
+void test_stream_frame_split_reads(void) {
+    setup_stream();
+    uint8_t in[32];
+    size_t n = build_frame(in, 5, FL_OP_PING, NULL, 0);
+
+    /* Deliver the frame in two parts */
+    mock_serial_set_input_bin(in, 4);
+    fl_stream_process(&test_stream);
+    TEST_ASSERT_EQUAL(0, g_mock_serial.tx_len);
+    TEST_ASSERT_EQUAL(FL_STREAM_RX_FRAME, test_stream.rx_state);
+
+    mock_serial_set_input_bin(in + 4, n - 4);
+    fl_stream_process(&test_stream);
+
+    frame_resp_t r;
+    TEST_ASSERT(parse_frames(&r));
+    TEST_ASSERT(r.complete);
+    TEST_ASSERT_EQUAL(5, r.seq);
+}
+
+/* ============================================================================
+ * Streamed Data Tests - upload/write with --len decode --data as it arrives
+ * ============================================================================ */
+
+static size_t b64_encode(const uint8_t* data, size_t len, char* out) {
+    static const char enc[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t j = 0;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < len)
+            v |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < len)
+            v |= data[i + 2];
+        out[j++] = enc[(v >> 18) & 0x3F];
+        out[j++] = enc[(v >> 12) & 0x3F];
+        out[j++] = (i + 1 < len) ? enc[(v >> 6) & 0x3F] : '=';
+        out[j++] = (i + 2 < len) ? enc[v & 0x3F] : '=';
+    }
+    out[j] = '\0';
+    return j;
+}
+
+static uint16_t xfer_crc(uint32_t addr, const uint8_t* data, size_t len) {
+    uint32_t hdr[2] = {addr, (uint32_t)len};
+    uint16_t crc = fl_crc16_update(0xFFFF, hdr, sizeof(hdr));
+    return fl_crc16_update(crc, data, len);
+}
+
+/* Feed a long input through the mock serial in pieces */
+static void stream_feed(const char* str) {
+    size_t len = strlen(str);
+    while (len > 0) {
+        size_t n = len > 200 ? 200 : len;
+        mock_serial_set_input_bin((const uint8_t*)str, n);
+        fl_stream_process(&test_stream);
+        str += n;
+        len -= n;
+    }
+}
+
+static void stream_alloc(unsigned size) {
+    char line[48];
+    snprintf(line, sizeof(line), "fl -c alloc -s %u", size);
+    fl_stream_exec_line(&test_stream, line);
+    TEST_ASSERT(test_ctx.last_alloc != 0);
+    mock_output_reset();
+}
+
+void test_stream_data_caps(void) {
+    setup_stream();
+    TEST_ASSERT(test_ctx.caps & FL_CAP_STREAM_DATA);
+}
+
+void test_stream_data_upload_large(void) {
+    setup_stream();
+    stream_alloc(600);
+
+    /* Far more than line_buf (256) and FL_BUF_SIZE-independent */
+    static uint8_t data[600];
+    static char b64[820];
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i * 7 + 3);
+    b64_encode(data, sizeof(data), b64);
+
+    char hdr[80];
+    snprintf(hdr, sizeof(hdr), "fl -c upload -a 0x0 -l %u -r 0x%04X -d ", (unsigned)sizeof(data),
+             xfer_crc(0, data, sizeof(data)));
+    stream_feed(hdr);
+    TEST_ASSERT_EQUAL(FL_STREAM_RX_DATA, test_stream.rx_state);
+    stream_feed(b64);
+    stream_feed("\n");
+
+    TEST_ASSERT_EQUAL(FL_STREAM_RX_LINE, test_stream.rx_state);
+    TEST_ASSERT(mock_output_contains("Uploaded 600 bytes off=0x0"));
+    TEST_ASSERT_EQUAL_MEMORY(data, (uint8_t*)test_ctx.last_alloc, sizeof(data));
+}
+
+void test_stream_data_write(void) {
+    setup_stream();
+    static uint8_t target[8];
+    const uint8_t data[5] = {1, 2, 3, 4, 5};
+    char b64[16];
+    b64_encode(data, sizeof(data), b64);
+    uint32_t addr32 = (uint32_t)(uintptr_t)target;
+
+    char line[160];
+    snprintf(line, sizeof(line), "fl --cmd write --addr 0x%lX --len 5 --crc 0x%04X --data %s\n",
+             (unsigned long)(uintptr_t)target, xfer_crc(addr32, data, sizeof(data)), b64);
+    stream_feed(line);
+
+    TEST_ASSERT(mock_output_contains("WRITE 5 bytes"));
+    TEST_ASSERT_EQUAL_MEMORY(data, target, sizeof(data));
+}
+
+void test_stream_data_upload_crc32(void) {
+    setup_stream();
+    stream_alloc(64);
+
+    uint8_t data[48];
+    char b64[80];
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i * 13 + 5);
+    b64_encode(data, sizeof(data), b64);
+
+    uint32_t hdr[2] = {0x8, sizeof(data)};
+    uint32_t crc = fl_crc32_update(0, hdr, sizeof(hdr));
+    crc = fl_crc32_update(crc, data, sizeof(data));
+
+    char line[160];
+    snprintf(line, sizeof(line), "fl -c upload -a 0x8 -l %u --crc32 -r 0x%08lX -d %s\n", (unsigned)sizeof(data),
+             (unsigned long)crc, b64);
+    stream_feed(line);
+
+    TEST_ASSERT(mock_output_contains("Uploaded 48 bytes off=0x8"));
+    TEST_ASSERT_EQUAL_MEMORY(data, (uint8_t*)test_ctx.last_alloc + 0x8, sizeof(data));
+}
+
+void test_stream_data_crc_mismatch(void) {
+    setup_stream();
+    stream_alloc(16);
+    stream_feed("fl -c upload -a 0x4 -l 4 -r 0x1234 -d AQIDBA==\n");
+    TEST_ASSERT(mock_output_contains("CRC mismatch off=0x4"));
+    TEST_ASSERT_EQUAL(FL_STREAM_RX_LINE, test_stream.rx_state);
+}
+
+void test_stream_data_length_mismatch(void) {
+    setup_stream();
+    stream_alloc(16);
+    stream_feed("fl -c upload -a 0 -l 8 -d AQIDBA==\n");
+    TEST_ASSERT(mock_output_contains("Length mismatch: 4 != 8"));
+}
+
+void test_stream_data_invalid(void) {
+    setup_stream();
+    stream_alloc(16);
+    stream_feed("fl -c upload -a 0 -l 4 -d AQ*DBA==\n");
+    TEST_ASSERT(mock_output_contains("Invalid base64 data"));
+
+    /* Data after padding is rejected too */
+    mock_output_reset();
+    stream_feed("fl -c upload -a 0 -l 4 -d AQ==AQ==\n");
+    TEST_ASSERT(mock_output_contains("Invalid base64 data"));
+}
+
+void test_stream_data_exceeds_alloc(void) {
+    setup_stream();
+    stream_alloc(4);
+    stream_feed("fl -c upload -a 0x2 -l 4 -d AQIDBA==\n");
+    TEST_ASSERT(mock_output_contains("Upload exceeds allocation"));
+    /* Rest of the line is discarded, next command works */
+    TEST_ASSERT_EQUAL(FL_STREAM_RX_LINE, test_stream.rx_state);
+    stream_feed("fl -c ping\n");
+    TEST_ASSERT(mock_output_contains("PONG"));
+}
+
+void test_stream_data_without_len(void) {
+    setup_stream();
+    stream_alloc(16);
+    /* No --len: buffered path, as before */
+    stream_feed("fl -c upload -a 0 -d AQIDBA==");
+    TEST_ASSERT_EQUAL(FL_STREAM_RX_LINE, test_stream.rx_state);
+    stream_feed("\n");
+    TEST_ASSERT(mock_output_contains("Uploaded 4 bytes off=0x0"));
+}
+
+/* ============================================================================
+ * Zero-copy RX Tests - peek_cb/consume_cb spans and fl_stream_feed
+ * ============================================================================ */
+
+static void setup_stream_peek(size_t span_max) {
+    setup_stream();
+    test_serial.peek_cb = mock_serial_peek;
+    test_serial.consume_cb = mock_serial_consume;
+    g_mock_serial.span_max = span_max;
+}
+
+void test_stream_peek_lines(void) {
+    setup_stream_peek(0);
+    mock_serial_set_input("fl --cmd ping\nfl --cmd info\n");
+    fl_stream_process(&test_stream);
+
+    TEST_ASSERT(mock_output_contains("PONG"));
+    TEST_ASSERT(mock_output_contains("FPBInject"));
+    TEST_ASSERT_EQUAL(g_mock_serial.rx_len, g_mock_serial.rx_pos);
+    test_serial.peek_cb = NULL;
+    test_serial.consume_cb = NULL;
+}
+
+void test_stream_peek_wrapped_spans(void) {
+    /* Short spans split tokens, frame headers and base64 quads */
+    setup_stream_peek(5);
+    stream_alloc(600);
+
+    static uint8_t data[600];
+    static char b64[820];
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i * 11 + 1);
+    b64_encode(data, sizeof(data), b64);
+
+    char hdr[80];
+    snprintf(hdr, sizeof(hdr), "fl -c upload -a 0x0 -l %u -r 0x%04X -d ", (unsigned)sizeof(data),
+             xfer_crc(0, data, sizeof(data)));
+    stream_feed(hdr);
+    stream_feed(b64);
+    stream_feed("\n");
+    TEST_ASSERT(mock_output_contains("Uploaded 600 bytes off=0x0"));
+    TEST_ASSERT_EQUAL_MEMORY(data, (uint8_t*)test_ctx.last_alloc, sizeof(data));
+
+    uint8_t in[32];
+    size_t n = build_frame(in, 0x11, FL_OP_PING, NULL, 0);
+    mock_serial_set_input_bin(in, n);
+    fl_stream_process(&test_stream);
+
+    frame_resp_t r;
+    TEST_ASSERT(parse_frames(&r));
+    TEST_ASSERT(r.complete);
+    TEST_ASSERT_EQUAL(0x11, r.seq);
+    test_serial.peek_cb = NULL;
+    test_serial.consume_cb = NULL;
+}
+
+void test_stream_feed_mixed(void) {
+    setup_stream();
+    uint8_t in[96];
+    size_t n = build_frame(in, 3, FL_OP_PING, NULL, 0);
+    memcpy(in + n, "\nfl --cmd ping\n", 15);
+    n += 15;
+    n += build_frame(in + n, 4, FL_OP_PING, NULL, 0);
+
+    /* One span holding frame, text line and frame */
+    fl_stream_feed(&test_stream, in, n);
+    TEST_ASSERT_EQUAL(3, tx_count("[FLOK] PONG"));
+    TEST_ASSERT_EQUAL(FL_STREAM_RX_LINE, test_stream.rx_state);
+}
+
+void test_stream_feed_bytewise(void) {
+    setup_stream();
+    stream_alloc(16);
+
+    const char* line = "fl -c upload -a 0 -l 4 -d AQ ID\tBA==\n";
+    for (const char* p = line; *p; p++) {
+        fl_stream_feed(&test_stream, (const uint8_t*)p, 1);
+    }
+
+    /* Whitespace inside streamed data is skipped, as before */
+    TEST_ASSERT(mock_output_contains("Uploaded 4 bytes off=0x0"));
+    static const uint8_t expected[] = {1, 2, 3, 4};
+    TEST_ASSERT_EQUAL_MEMORY(expected, (uint8_t*)test_ctx.last_alloc, 4);
+}
+
+void test_stream_feed_line_overflow(void) {
+    setup_stream();
+    char big[400];
+    memset(big, 'x', sizeof(big));
+    memcpy(big, "fl --cmd ping ", 14);
+
+    /* Oversized line is truncated, not overrun; the next line still works */
+    fl_stream_feed(&test_stream, (const uint8_t*)big, sizeof(big));
+    TEST_ASSERT_EQUAL(sizeof(line_buf) - 1, test_stream.line_pos);
+    mock_output_reset();
+    fl_stream_feed(&test_stream, (const uint8_t*)"\nfl --cmd ping\n", 15);
+    TEST_ASSERT(mock_output_contains("PONG"));
+}
+
+/* ============================================================================
+ * TX Ring Tests
+ * ============================================================================ */
+
+static uint8_t tx_ring[128];
+static size_t tx_kick_max_span;
+
+/* Output goes through the TX ring to serial TX (fl_init picks up the ring output) */
+static void setup_stream_tx(size_t ring_size, fl_log_tx_kick_cb_t kick_cb) {
+    setup_stream();
+    tx_kick_max_span = 0;
+    fl_stream_tx_init(&test_stream, tx_ring, ring_size, kick_cb, NULL);
+    fl_init(&test_ctx);
+}
+
+/* Drains everything, recording the longest span handed out */
+static void tx_kick_record(void* user) {
+    (void)user;
+    size_t len;
+    const uint8_t* span;
+    while ((span = fl_log_tx_peek(&len)) != NULL && len > 0) {
+        if (len > tx_kick_max_span)
+            tx_kick_max_span = len;
+        fl_log_tx_consume((size_t)mock_serial_write(span, len));
+    }
+}
+
+void test_stream_tx_ring_deferred(void) {
+    setup_stream_tx(sizeof(tx_ring), NULL);
+    TEST_ASSERT(fl_log_tx_enabled());
+
+    /* UART busy: the command completes, its response stays queued */
+    g_mock_serial.tx_busy = true;
+    mock_serial_set_input("fl --cmd echoback --len 16\n");
+    fl_stream_process(&test_stream);
+    TEST_ASSERT_EQUAL(0, g_mock_serial.tx_len);
+    TEST_ASSERT(fl_log_tx_pending() > 0);
+
+    g_mock_serial.tx_busy = false;
+    fl_stream_process(&test_stream);
+    TEST_ASSERT_EQUAL(0, fl_log_tx_pending());
+    TEST_ASSERT_EQUAL(1, tx_count("[FLOK] ECHOBACK 16 bytes"));
+    TEST_ASSERT_EQUAL(1, tx_count("data=AAECAwQFBgcICQoLDA0ODw==\n[FLEND]\n"));
+    fl_log_tx_init(NULL, 0, NULL, NULL);
+}
+
+void test_stream_tx_ring_ref(void) {
+    setup_stream_tx(64, tx_kick_record);
+
+    /* 256 bytes encode to 344 base64 chars: only possible by reference in a 64 B ring */
+    mock_serial_set_input("fl --cmd echoback --len 256\n");
+    fl_stream_process(&test_stream);
+    TEST_ASSERT_EQUAL(0, fl_log_tx_pending());
+    TEST_ASSERT(tx_kick_max_span >= 344);
+    TEST_ASSERT_EQUAL(1, tx_count("[FLOK] ECHOBACK 256 bytes"));
+    TEST_ASSERT_EQUAL(1, tx_count("[FLEND]"));
+    fl_log_tx_init(NULL, 0, NULL, NULL);
+}
+
+void test_stream_tx_ring_backpressure(void) {
+    /* Responses larger than the ring, drained 5 bytes per write */
+    setup_stream_tx(24, NULL);
+    g_mock_serial.tx_max = 5;
+    mock_serial_set_input("fl --cmd echoback --len 16\nfl --cmd ping\nfl --cmd echoback --len 16\n");
+    fl_stream_process(&test_stream);
+
+    TEST_ASSERT_EQUAL(0, fl_log_tx_pending());
+    TEST_ASSERT_EQUAL(2, tx_count("[FLOK] ECHOBACK 16 bytes crc=0x"));
+    TEST_ASSERT_EQUAL(2, tx_count("data=AAECAwQFBgcICQoLDA0ODw==\n[FLEND]\n"));
+    TEST_ASSERT_EQUAL(1, tx_count("[FLOK] PONG caps=0x0002AFFF\n[FLEND]\n"));
+    TEST_ASSERT_EQUAL(3, tx_count("[FLEND]"));
+    fl_log_tx_init(NULL, 0, NULL, NULL);
+}
+
+void test_stream_tx_ring_frame(void) {
+    setup_stream_tx(sizeof(tx_ring), NULL);
+    static const uint8_t src[48] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+
+    uint8_t payload[32];
+    size_t plen = tlv_int(payload, 0, FL_TAG_ADDR, (uintptr_t)src, sizeof(uintptr_t));
+    plen = tlv_int(payload, plen, FL_TAG_LEN, sizeof(src), 4);
+
+    uint8_t in[64];
+    size_t n = build_frame(in, 9, FL_OP_READ, payload, plen);
+    g_mock_serial.tx_busy = true;
+    mock_serial_set_input_bin(in, n);
+    fl_stream_process(&test_stream);
+    TEST_ASSERT_EQUAL(0, g_mock_serial.tx_len);
+
+    g_mock_serial.tx_busy = false;
+    fl_stream_process(&test_stream);
+
+    frame_resp_t r;
+    TEST_ASSERT(parse_frames(&r));
+    TEST_ASSERT(r.complete);
+    TEST_ASSERT_EQUAL(9, r.seq);
+    TEST_ASSERT_EQUAL(sizeof(src), r.data_len);
+    TEST_ASSERT_EQUAL_MEMORY(src, r.data, sizeof(src));
+    fl_log_tx_init(NULL, 0, NULL, NULL);
+}
+
+static char tx_drained[64];
+static size_t tx_drained_len;
+
+/* Sends only the oldest segment, like a UART DMA completing one span */
+static void tx_kick_one(void* user) {
+    (void)user;
+    size_t len;
+    const uint8_t* span = fl_log_tx_peek(&len);
+    if (span && len > 0) {
+        memcpy(tx_drained + tx_drained_len, span, len);
+        tx_drained_len += len;
+        fl_log_tx_consume(len);
+    }
+}
+
+void test_stream_tx_ring_wrap(void) {
+    static const char ref[] = "R";
+    tx_drained_len = 0;
+    fl_log_tx_init(tx_ring, 10, tx_kick_one, NULL);
+
+    fl_log_tx_write("AAAAAAAA", 8);
+    fl_log_tx_write_ref(ref, 1);
+    fl_log_tx_write("BB", 2); /* Ends exactly at the end of the ring */
+    tx_kick_one(NULL);         /* AAAAAAAA */
+    fl_log_tx_write("DDD", 3); /* Wraps to the start */
+    tx_kick_one(NULL);         /* R */
+    tx_kick_one(NULL);         /* BB: the tail reaches the end of the ring */
+    TEST_ASSERT_EQUAL(3, fl_log_tx_pending());
+
+    /* Fills the rest of the ring; the next write must wait for DDD to go out */
+    fl_log_tx_write("EEEEEEE", 7);
+    TEST_ASSERT_EQUAL(10, fl_log_tx_pending());
+    fl_log_tx_write("FFFF", 4);
+    TEST_ASSERT(fl_log_tx_pending() <= 10);
+
+    while (fl_log_tx_pending() > 0) {
+        tx_kick_one(NULL);
+    }
+    TEST_ASSERT_EQUAL(25, tx_drained_len);
+    TEST_ASSERT_EQUAL_MEMORY("AAAAAAAARBBDDDEEEEEEEFFFF", tx_drained, 25);
+    fl_log_tx_init(NULL, 0, NULL, NULL);
+}
+
 /* ============================================================================
  * Test Runner
  * ============================================================================ */
@@ -278,4 +907,43 @@ void run_stream_tests(void) {
     RUN_TEST(test_stream_output_via_serial);
     RUN_TEST(test_stream_process_buffer_full);
     TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader_stream - Binary Frames");
+    RUN_TEST(test_stream_frame_caps);
+    RUN_TEST(test_stream_frame_ping);
+    RUN_TEST(test_stream_frame_read_raw);
+    RUN_TEST(test_stream_frame_echoback_raw);
+    RUN_TEST(test_stream_frame_bad_crc_resync);
+    RUN_TEST(test_stream_frame_too_large);
+    RUN_TEST(test_stream_frame_then_text);
+    RUN_TEST(test_stream_frame_split_reads);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader_stream - Streamed Data");
+    RUN_TEST(test_stream_data_caps);
+    RUN_TEST(test_stream_data_upload_large);
+    RUN_TEST(test_stream_data_write);
+    RUN_TEST(test_stream_data_upload_crc32);
+    RUN_TEST(test_stream_data_crc_mismatch);
+    RUN_TEST(test_stream_data_length_mismatch);
+    RUN_TEST(test_stream_data_invalid);
+    RUN_TEST(test_stream_data_exceeds_alloc);
+    RUN_TEST(test_stream_data_without_len);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader_stream - Zero-copy RX");
+    RUN_TEST(test_stream_peek_lines);
+    RUN_TEST(test_stream_peek_wrapped_spans);
+    RUN_TEST(test_stream_feed_mixed);
+    RUN_TEST(test_stream_feed_bytewise);
+    RUN_TEST(test_stream_feed_line_overflow);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("func_loader_stream - TX Ring");
+    RUN_TEST(test_stream_tx_ring_deferred);
+    RUN_TEST(test_stream_tx_ring_ref);
+    RUN_TEST(test_stream_tx_ring_backpressure);
+    RUN_TEST(test_stream_tx_ring_frame);
+    RUN_TEST(test_stream_tx_ring_wrap);
+    TEST_SUITE_END();
 }
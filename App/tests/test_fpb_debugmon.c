@@ -7,7 +7,7 @@
 
 #include "test_framework.h"
 #include "fpb_debugmon.h"
-#include "fpb_mock_regs.h"
+#include "fpb_regs.h"
 
 /* ============================================================================
  * Test Setup/Teardown
@@ -226,6 +226,43 @@ static void test_debugmon_clear_redirect_clears_fpb_comp(void) {
     teardown_debugmon();
 }
 
+/* ============================================================================
+ * Retarget Tests
+ * ============================================================================ */
+
+static void test_debugmon_retarget_basic(void) {
+    setup_debugmon();
+    fpb_debugmon_init();
+
+    fpb_debugmon_set_redirect(0, 0x08001000, 0x20001000);
+    uint32_t comp = mock_fpb_comp[0];
+    int ret = fpb_debugmon_retarget(0, 0x20002000);
+
+    TEST_ASSERT_EQUAL(0, ret);
+    TEST_ASSERT_EQUAL(0x20002001, fpb_debugmon_get_redirect(0x08001000));
+    /* Breakpoint stays armed */
+    TEST_ASSERT_EQUAL(comp, mock_fpb_comp[0]);
+
+    uint32_t stack_frame[8] = {0, 0, 0, 0, 0, 0, 0x08001000, 0};
+    fpb_mock_set_dfsr(1UL << 1);
+    fpb_debugmon_handler(stack_frame);
+    TEST_ASSERT_EQUAL(0x20002001, stack_frame[6]);
+
+    teardown_debugmon();
+}
+
+static void test_debugmon_retarget_no_redirect(void) {
+    setup_debugmon();
+
+    TEST_ASSERT_EQUAL(-1, fpb_debugmon_retarget(0, 0x20002000));
+
+    fpb_debugmon_init();
+    TEST_ASSERT_EQUAL(-1, fpb_debugmon_retarget(0, 0x20002000));
+    TEST_ASSERT_EQUAL(-1, fpb_debugmon_retarget(10, 0x20002000));
+
+    teardown_debugmon();
+}
+
 /* ============================================================================
  * Get Redirect Tests
  * ============================================================================ */
@@ -325,6 +362,194 @@ static void test_debugmon_handler_not_breakpoint(void) {
     teardown_debugmon();
 }
 
+/* ============================================================================
+ * Lookup Table Tests
+ * ============================================================================ */
+
+/* These addresses share one bucket of the handler's direct-mapped table */
+#define COLLIDE_A 0x08001000
+#define COLLIDE_B 0x08001084
+#define COLLIDE_C 0x08001108
+
+static uint32_t handler_pc(uint32_t pc) {
+    uint32_t stack_frame[8] = {0, 0, 0, 0, 0, 0, pc, 0};
+    fpb_mock_set_dfsr(1UL << 1);
+    fpb_debugmon_handler(stack_frame);
+    return stack_frame[6];
+}
+
+static void test_debugmon_lookup_collision(void) {
+    setup_debugmon();
+    fpb_debugmon_init();
+
+    fpb_debugmon_set_redirect(0, COLLIDE_A, 0x20001000);
+    fpb_debugmon_set_redirect(1, COLLIDE_B, 0x20002000);
+    fpb_debugmon_set_redirect(2, COLLIDE_C, 0x20003000);
+
+    TEST_ASSERT_EQUAL(0x20001001, handler_pc(COLLIDE_A));
+    TEST_ASSERT_EQUAL(0x20002001, handler_pc(COLLIDE_B));
+    TEST_ASSERT_EQUAL(0x20003001, handler_pc(COLLIDE_C));
+    TEST_ASSERT_EQUAL(0x20002001, fpb_debugmon_get_redirect(COLLIDE_B));
+
+    teardown_debugmon();
+}
+
+static void test_debugmon_lookup_clear_bucket_owner(void) {
+    setup_debugmon();
+    fpb_debugmon_init();
+
+    fpb_debugmon_set_redirect(0, COLLIDE_A, 0x20001000);
+    fpb_debugmon_set_redirect(1, COLLIDE_B, 0x20002000);
+    fpb_debugmon_clear_redirect(0);
+
+    /* The bucket passes to the remaining redirect, the cleared one is gone */
+    TEST_ASSERT_EQUAL(COLLIDE_A, handler_pc(COLLIDE_A));
+    TEST_ASSERT_EQUAL(0x20002001, handler_pc(COLLIDE_B));
+
+    fpb_debugmon_set_redirect(0, COLLIDE_A, 0x20004000);
+    TEST_ASSERT_EQUAL(0x20004001, handler_pc(COLLIDE_A));
+
+    teardown_debugmon();
+}
+
+static void test_debugmon_lookup_reuse_comp(void) {
+    setup_debugmon();
+    fpb_debugmon_init();
+
+    /* Re-arming a comparator at another address drops the old mapping */
+    fpb_debugmon_set_redirect(3, 0x08005000, 0x20001000);
+    fpb_debugmon_set_redirect(3, 0x08006000, 0x20002000);
+
+    TEST_ASSERT_EQUAL(0x08005000, handler_pc(0x08005000));
+    TEST_ASSERT_EQUAL(0x20002001, handler_pc(0x08006000));
+    TEST_ASSERT_EQUAL(0, fpb_debugmon_get_redirect(0x08005000));
+
+    teardown_debugmon();
+}
+
+static void test_debugmon_lookup_all_comps(void) {
+    setup_debugmon();
+    fpb_debugmon_init();
+
+    for (uint8_t i = 0; i < 6; i++) {
+        fpb_debugmon_set_redirect(i, 0x08010000 + i * 0x40, 0x20010000 + i * 0x100U);
+    }
+    for (uint8_t i = 0; i < 6; i++) {
+        TEST_ASSERT_EQUAL(0x20010001 + i * 0x100U, handler_pc(0x08010000 + i * 0x40U));
+    }
+
+    teardown_debugmon();
+}
+
+/* ============================================================================
+ * DWT Redirect Tests
+ * ============================================================================ */
+
+static void setup_debugmon_dwt(uint8_t num_dwt) {
+    setup_debugmon();
+    fpb_mock_configure_dwt(num_dwt);
+}
+
+static void test_debugmon_capacity(void) {
+    setup_debugmon_dwt(2);
+    TEST_ASSERT_EQUAL(8, fpb_debugmon_get_capacity());
+    teardown_debugmon();
+
+    /* Capped at FPB_DEBUGMON_MAX_DWT */
+    setup_debugmon_dwt(15);
+    fpb_debugmon_init();
+    TEST_ASSERT_EQUAL(6 + FPB_DEBUGMON_MAX_DWT, fpb_debugmon_get_capacity());
+    teardown_debugmon();
+
+    fpb_mock_configure(0, 0);
+    fpb_mock_configure_dwt(4);
+    TEST_ASSERT_EQUAL(0, fpb_debugmon_get_capacity());
+    teardown_debugmon();
+}
+
+static void test_debugmon_dwt_set_redirect(void) {
+    setup_debugmon_dwt(4);
+    fpb_debugmon_init();
+
+    /* Slot 6 is the first one past the 6 FPB comparators */
+    int ret = fpb_debugmon_set_redirect(6, 0x20010001, 0x20002000);
+
+    TEST_ASSERT_EQUAL(0, ret);
+    TEST_ASSERT_EQUAL_HEX(0x20010000, mock_dwt_comp[0]);
+    TEST_ASSERT_EQUAL_HEX(0, mock_dwt_mask[0]);
+    TEST_ASSERT_EQUAL_HEX(DWT_FUNCTION_PC_MATCH, mock_dwt_function[0]);
+    for (int i = 0; i < 6; i++) {
+        TEST_ASSERT_EQUAL_HEX(0, mock_fpb_comp[i]);
+    }
+    TEST_ASSERT_EQUAL(0x20002001, fpb_debugmon_get_redirect(0x20010000));
+
+    TEST_ASSERT_EQUAL(-1, fpb_debugmon_set_redirect(10, 0x20010100, 0x20002000));
+
+    teardown_debugmon();
+}
+
+static void test_debugmon_dwt_handler(void) {
+    setup_debugmon_dwt(4);
+    fpb_debugmon_init();
+
+    fpb_debugmon_set_redirect(9, 0x20010000, 0x20002000);
+
+    uint32_t stack_frame[8] = {0, 0, 0, 0, 0, 0, 0x20010000, 0};
+    fpb_mock_set_dfsr(DFSR_DWTTRAP);
+
+    fpb_debugmon_handler(stack_frame);
+
+    TEST_ASSERT_EQUAL(0x20002001, stack_frame[6]);
+    TEST_ASSERT_EQUAL_HEX(DFSR_DWTTRAP, mock_dfsr); /* Written back to clear */
+
+    teardown_debugmon();
+}
+
+static void test_debugmon_dwt_clear_redirect(void) {
+    setup_debugmon_dwt(4);
+    fpb_debugmon_init();
+
+    fpb_debugmon_set_redirect(7, 0x20010000, 0x20002000);
+    TEST_ASSERT_EQUAL(0, fpb_debugmon_clear_redirect(7));
+
+    TEST_ASSERT_EQUAL_HEX(0, mock_dwt_function[1]);
+    TEST_ASSERT_EQUAL(0, fpb_debugmon_get_redirect(0x20010000));
+
+    teardown_debugmon();
+}
+
+static void test_debugmon_dwt_in_use(void) {
+    setup_debugmon_dwt(4);
+    fpb_debugmon_init();
+
+    /* A debugger watchpoint on DWT comparator 1 */
+    mock_dwt_function[1] = 0x5;
+
+    TEST_ASSERT_EQUAL(-2, fpb_debugmon_set_redirect(7, 0x20010000, 0x20002000));
+    TEST_ASSERT_EQUAL(0, fpb_debugmon_get_redirect(0x20010000));
+
+    /* Neither clearing the free slot nor deinit touches it */
+    fpb_debugmon_clear_redirect(7);
+    fpb_debugmon_deinit();
+    TEST_ASSERT_EQUAL_HEX(0x5, mock_dwt_function[1]);
+
+    teardown_debugmon();
+}
+
+static void test_debugmon_dwt_deinit(void) {
+    setup_debugmon_dwt(4);
+    fpb_debugmon_init();
+
+    fpb_debugmon_set_redirect(6, 0x20010000, 0x20002000);
+    fpb_debugmon_set_redirect(8, 0x20010100, 0x20002100);
+    fpb_debugmon_deinit();
+
+    TEST_ASSERT_EQUAL_HEX(0, mock_dwt_function[0]);
+    TEST_ASSERT_EQUAL_HEX(0, mock_dwt_function[2]);
+
+    teardown_debugmon();
+}
+
 /* ============================================================================
  * Test Registration
  * ============================================================================ */
@@ -358,6 +583,11 @@ void run_fpb_debugmon_tests(void) {
     RUN_TEST(test_debugmon_clear_redirect_clears_fpb_comp);
     TEST_SUITE_END();
 
+    TEST_SUITE_BEGIN("fpb_debugmon - Retarget");
+    RUN_TEST(test_debugmon_retarget_basic);
+    RUN_TEST(test_debugmon_retarget_no_redirect);
+    TEST_SUITE_END();
+
     TEST_SUITE_BEGIN("fpb_debugmon - Get Redirect");
     RUN_TEST(test_debugmon_get_redirect_found);
     RUN_TEST(test_debugmon_get_redirect_not_found);
@@ -369,4 +599,20 @@ void run_fpb_debugmon_tests(void) {
     RUN_TEST(test_debugmon_handler_no_redirect);
     RUN_TEST(test_debugmon_handler_not_breakpoint);
     TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("fpb_debugmon - Lookup Table");
+    RUN_TEST(test_debugmon_lookup_collision);
+    RUN_TEST(test_debugmon_lookup_clear_bucket_owner);
+    RUN_TEST(test_debugmon_lookup_reuse_comp);
+    RUN_TEST(test_debugmon_lookup_all_comps);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("fpb_debugmon - DWT Redirects");
+    RUN_TEST(test_debugmon_capacity);
+    RUN_TEST(test_debugmon_dwt_set_redirect);
+    RUN_TEST(test_debugmon_dwt_handler);
+    RUN_TEST(test_debugmon_dwt_clear_redirect);
+    RUN_TEST(test_debugmon_dwt_in_use);
+    RUN_TEST(test_debugmon_dwt_deinit);
+    TEST_SUITE_END();
 }
@@ -101,6 +101,11 @@ static void test_nuttx_debugmon_set_redirect_invalid_comp_id(void) {
     int ret = fpb_debugmon_set_redirect(FPB_DEBUGMON_MAX_REDIRECTS, 0x08001000, 0x08002001);
     TEST_ASSERT_EQUAL(-1, ret);
 
+    /* No DWT slots: up_debugpoint_add() cannot tell how many comparators are left */
+    ret = fpb_debugmon_set_redirect(FPB_DEBUGMON_MAX_FPB, 0x08001000, 0x08002001);
+    TEST_ASSERT_EQUAL(-1, ret);
+    TEST_ASSERT_EQUAL(FPB_DEBUGMON_MAX_FPB, fpb_debugmon_get_capacity());
+
     teardown_nuttx_debugmon();
 }
 
@@ -577,6 +577,136 @@ void test_fpb_remap_table_all_slots_v2(void) {
     }
 }
 
+/* ============================================================================
+ * fpb_set_insn_patch Tests
+ *
+ * Mock Code region halfwords read as the low 16 bits of their address.
+ * ============================================================================ */
+
+void test_fpb_insn_patch_16bit_lower(void) {
+    setup_fpb();
+    fpb_init();
+
+    /* CMP r0, #1 in the lower halfword: upper halfword kept from Flash */
+    TEST_ASSERT_EQUAL(FPB_OK, fpb_set_insn_patch(0, 0x08001000, 0x2801));
+    TEST_ASSERT_EQUAL(0x10022801U, fpb_test_get_remap_table()[0]);
+    TEST_ASSERT_EQUAL(0x08001000U | 1U, mock_fpb_get_comp(0)); /* REMAP, enabled */
+    TEST_ASSERT_EQUAL(0x08001000U, fpb_get_state()->comp[0].original_addr);
+}
+
+void test_fpb_insn_patch_16bit_upper(void) {
+    setup_fpb();
+    fpb_init();
+
+    /* Upper halfword: the comparator still matches the word, lower halfword kept */
+    TEST_ASSERT_EQUAL(FPB_OK, fpb_set_insn_patch(1, 0x08001002 | 1, 0x2801));
+    TEST_ASSERT_EQUAL(0x28011000U, fpb_test_get_remap_table()[1]);
+    TEST_ASSERT_EQUAL(0x08001000U | 1U, mock_fpb_get_comp(1));
+    TEST_ASSERT_EQUAL(0x08001002U, fpb_get_state()->comp[1].original_addr);
+}
+
+void test_fpb_insn_patch_32bit(void) {
+    setup_fpb();
+    fpb_init();
+
+    /* CMP.W r0, #1 (objdump: f1b0 0f01): first halfword in the low half of the word */
+    TEST_ASSERT_EQUAL(FPB_OK, fpb_set_insn_patch(2, 0x08001004, 0xF1B00F01));
+    TEST_ASSERT_EQUAL(0x0F01F1B0U, fpb_test_get_remap_table()[2]);
+    TEST_ASSERT_EQUAL(0x08001004U | 1U, mock_fpb_get_comp(2));
+}
+
+void test_fpb_insn_patch_32bit_unaligned(void) {
+    setup_fpb();
+    fpb_init();
+
+    /* Would span two remap words */
+    TEST_ASSERT_EQUAL(FPB_ERR_INVALID_ADDR, fpb_set_insn_patch(0, 0x08001002, 0xF1B00F01));
+    TEST_ASSERT_FALSE(mock_fpb_comp_is_enabled(0));
+}
+
+void test_fpb_insn_patch_width_mismatch(void) {
+    setup_fpb();
+    fpb_init();
+
+    /* First halfword of a 32-bit instruction alone, and a 16-bit one padded to 32 bits */
+    TEST_ASSERT_EQUAL(FPB_ERR_INVALID_PARAM, fpb_set_insn_patch(0, 0x08001000, 0xF1B0));
+    TEST_ASSERT_EQUAL(FPB_ERR_INVALID_PARAM, fpb_set_insn_patch(0, 0x08001000, 0x28010000));
+    TEST_ASSERT_FALSE(mock_fpb_comp_is_enabled(0));
+}
+
+void test_fpb_insn_patch_invalid(void) {
+    setup_fpb();
+    TEST_ASSERT_EQUAL(FPB_ERR_NOT_INIT, fpb_set_insn_patch(0, 0x08001000, 0x2801));
+
+    fpb_init();
+    TEST_ASSERT_EQUAL(FPB_ERR_INVALID_COMP, fpb_set_insn_patch(6, 0x08001000, 0x2801));
+    TEST_ASSERT_EQUAL(FPB_ERR_INVALID_ADDR, fpb_set_insn_patch(0, 0x20001000, 0x2801));
+}
+
+void test_fpb_insn_patch_no_remap(void) {
+    setup_fpb();
+    mock_fpb_remap = 0; /* RMPSPT clear */
+    fpb_init();
+
+    TEST_ASSERT_FALSE(fpb_get_state()->remap_supported);
+    TEST_ASSERT_EQUAL(FPB_ERR_NOT_SUPPORTED, fpb_set_insn_patch(0, 0x08001000, 0x2801));
+}
+
+void test_fpb_insn_patch_clear(void) {
+    setup_fpb();
+    fpb_init();
+
+    fpb_set_insn_patch(0, 0x08001000, 0x2801);
+    TEST_ASSERT_EQUAL(FPB_OK, fpb_clear_patch(0));
+    TEST_ASSERT_EQUAL(0U, fpb_test_get_remap_table()[0]);
+    TEST_ASSERT_FALSE(mock_fpb_comp_is_enabled(0));
+}
+
+/* ============================================================================
+ * fpb_begin_update / fpb_end_update Tests
+ * ============================================================================ */
+
+void test_fpb_update_single_barrier(void) {
+    setup_fpb();
+    fpb_init();
+
+    uint32_t dsb0 = mock_dsb_count;
+    uint32_t isb0 = mock_isb_count;
+    fpb_begin_update();
+    TEST_ASSERT_EQUAL(FPB_OK, fpb_set_patch(0, 0x08001000, 0x20002000));
+    TEST_ASSERT_EQUAL(FPB_OK, fpb_set_patch(1, 0x08002000, 0x20003000));
+    TEST_ASSERT_EQUAL(FPB_OK, fpb_clear_patch(2));
+    fpb_barrier();
+    TEST_ASSERT_EQUAL(dsb0, mock_dsb_count);
+    fpb_end_update();
+
+    /* One DSB/ISB for the whole batch, comparators programmed */
+    TEST_ASSERT_EQUAL(dsb0 + 1, mock_dsb_count);
+    TEST_ASSERT_EQUAL(isb0 + 1, mock_isb_count);
+    TEST_ASSERT_TRUE(mock_fpb_comp_is_enabled(0));
+    TEST_ASSERT_TRUE(mock_fpb_comp_is_enabled(1));
+}
+
+void test_fpb_update_nested(void) {
+    setup_fpb();
+    fpb_init();
+
+    uint32_t dsb0 = mock_dsb_count;
+    fpb_begin_update();
+    fpb_begin_update();
+    fpb_set_patch(0, 0x08001000, 0x20002000);
+    fpb_end_update();
+    TEST_ASSERT_EQUAL(dsb0, mock_dsb_count);
+    fpb_end_update();
+    TEST_ASSERT_EQUAL(dsb0 + 1, mock_dsb_count);
+
+    /* Unbalanced end is ignored, barriers are immediate again */
+    fpb_end_update();
+    TEST_ASSERT_EQUAL(dsb0 + 1, mock_dsb_count);
+    fpb_set_patch(1, 0x08002000, 0x20003000);
+    TEST_ASSERT_EQUAL(dsb0 + 2, mock_dsb_count);
+}
+
 /* ============================================================================
  * Test Runner
  * ============================================================================ */
@@ -650,4 +780,20 @@ void run_fpb_tests(void) {
     RUN_TEST(test_fpb_remap_table_all_slots);
     RUN_TEST(test_fpb_remap_table_all_slots_v2);
     TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("fpb_inject - Instruction Patch");
+    RUN_TEST(test_fpb_insn_patch_16bit_lower);
+    RUN_TEST(test_fpb_insn_patch_16bit_upper);
+    RUN_TEST(test_fpb_insn_patch_32bit);
+    RUN_TEST(test_fpb_insn_patch_32bit_unaligned);
+    RUN_TEST(test_fpb_insn_patch_width_mismatch);
+    RUN_TEST(test_fpb_insn_patch_invalid);
+    RUN_TEST(test_fpb_insn_patch_no_remap);
+    RUN_TEST(test_fpb_insn_patch_clear);
+    TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("fpb_inject - Batched Update");
+    RUN_TEST(test_fpb_update_single_barrier);
+    RUN_TEST(test_fpb_update_nested);
+    TEST_SUITE_END();
 }
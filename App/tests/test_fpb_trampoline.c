@@ -6,6 +6,8 @@
  */
 
 #include "test_framework.h"
+#include "fpb_mock_regs.h"
+#include "fpb_regs.h"
 #include "fpb_trampoline.h"
 
 /* ============================================================================
@@ -220,6 +222,114 @@ static void test_trampoline_boundary_comp_ids(void) {
     TEST_ASSERT_EQUAL(0, fpb_trampoline_get_target(8));
 }
 
+/* ============================================================================
+ * Call and Cycle Accounting Tests
+ * ============================================================================ */
+
+static void test_trampoline_stats_no_target(void) {
+    setup_trampoline();
+    fpb_trampoline_reset_stats(0);
+
+    /* No target: the trampoline returns straight to the caller, uncounted */
+    uint64_t ret = fpb_trampoline_stats_enter(0, 0x08000201);
+    TEST_ASSERT_EQUAL(0, (uint32_t)ret);
+    TEST_ASSERT_EQUAL(0x08000201, (uint32_t)(ret >> 32));
+
+    fpb_trampoline_stats_t st;
+    TEST_ASSERT(fpb_trampoline_get_stats(0, &st));
+    TEST_ASSERT_EQUAL(0, st.calls);
+}
+
+static void test_trampoline_stats_timed_call(void) {
+    setup_trampoline();
+    fpb_mock_reset();
+
+    fpb_trampoline_set_target(2, 0x20001001);
+    TEST_ASSERT(mock_demcr & DEMCR_TRCENA);
+    TEST_ASSERT(mock_dwt_ctrl & DWT_CTRL_CYCCNTENA);
+
+    /* Entry hands out the target and the exit shim as its return address */
+    mock_dwt_cyccnt = 1000;
+    uint64_t ret = fpb_trampoline_stats_enter(2, 0x08000201);
+    TEST_ASSERT_EQUAL(0x20001001, (uint32_t)ret);
+    TEST_ASSERT_EQUAL(0x080010A1, (uint32_t)(ret >> 32));
+
+    /* Exit accounts the call and returns to the original caller */
+    mock_dwt_cyccnt = 1250;
+    TEST_ASSERT_EQUAL(0x08000201, fpb_trampoline_stats_exit(2));
+
+    fpb_trampoline_stats_t st;
+    TEST_ASSERT(fpb_trampoline_get_stats(2, &st));
+    TEST_ASSERT_EQUAL(1, st.calls);
+    TEST_ASSERT_EQUAL(1, st.timed);
+    TEST_ASSERT_EQUAL(250, (uint32_t)st.cycles);
+    TEST_ASSERT_EQUAL(250, st.max);
+}
+
+static void test_trampoline_stats_nested_call(void) {
+    setup_trampoline();
+    fpb_trampoline_set_target(3, 0x20001001);
+
+    /* A second call while the first is timed is only counted */
+    mock_dwt_cyccnt = 0;
+    fpb_trampoline_stats_enter(3, 0x08000301);
+    uint64_t inner = fpb_trampoline_stats_enter(3, 0x08000401);
+    TEST_ASSERT_EQUAL(0x20001001, (uint32_t)inner);
+    TEST_ASSERT_EQUAL(0x08000401, (uint32_t)(inner >> 32));
+    mock_dwt_cyccnt = 40;
+    TEST_ASSERT_EQUAL(0x08000301, fpb_trampoline_stats_exit(3));
+
+    /* The slot is free again afterwards */
+    mock_dwt_cyccnt = 100;
+    uint64_t next = fpb_trampoline_stats_enter(3, 0x08000501);
+    TEST_ASSERT_EQUAL(0x080010B1, (uint32_t)(next >> 32));
+    mock_dwt_cyccnt = 110;
+    fpb_trampoline_stats_exit(3);
+
+    fpb_trampoline_stats_t st;
+    fpb_trampoline_get_stats(3, &st);
+    TEST_ASSERT_EQUAL(3, st.calls);
+    TEST_ASSERT_EQUAL(2, st.timed);
+    TEST_ASSERT_EQUAL(50, (uint32_t)st.cycles);
+    TEST_ASSERT_EQUAL(40, st.max);
+}
+
+static void test_trampoline_stats_cyccnt_wrap(void) {
+    setup_trampoline();
+    fpb_trampoline_set_target(1, 0x20001001);
+
+    mock_dwt_cyccnt = 0xFFFFFF00;
+    fpb_trampoline_stats_enter(1, 0x08000101);
+    mock_dwt_cyccnt = 0x100;
+    fpb_trampoline_stats_exit(1);
+
+    fpb_trampoline_stats_t st;
+    fpb_trampoline_get_stats(1, &st);
+    TEST_ASSERT_EQUAL(0x200, st.max);
+}
+
+static void test_trampoline_stats_reset(void) {
+    setup_trampoline();
+    fpb_trampoline_set_target(4, 0x20001001);
+    fpb_trampoline_stats_enter(4, 0x08000101);
+    fpb_trampoline_stats_exit(4);
+
+    fpb_trampoline_stats_t st;
+    fpb_trampoline_reset_stats(4);
+    fpb_trampoline_get_stats(4, &st);
+    TEST_ASSERT_EQUAL(0, st.calls);
+    TEST_ASSERT_EQUAL(0, st.timed);
+
+    /* A new target starts from zero as well */
+    fpb_trampoline_stats_enter(4, 0x08000101);
+    fpb_trampoline_stats_exit(4);
+    fpb_trampoline_set_target(4, 0x20002001);
+    fpb_trampoline_get_stats(4, &st);
+    TEST_ASSERT_EQUAL(0, st.calls);
+
+    TEST_ASSERT(!fpb_trampoline_get_stats(FPB_TRAMPOLINE_COUNT, &st));
+}
+
 /* ============================================================================
  * Test Registration
  * ============================================================================ */
@@ -251,4 +361,12 @@ void run_fpb_trampoline_tests(void) {
     RUN_TEST(test_trampoline_workflow);
     RUN_TEST(test_trampoline_boundary_comp_ids);
     TEST_SUITE_END();
+
+    TEST_SUITE_BEGIN("fpb_trampoline - Call Stats");
+    RUN_TEST(test_trampoline_stats_no_target);
+    RUN_TEST(test_trampoline_stats_timed_call);
+    RUN_TEST(test_trampoline_stats_nested_call);
+    RUN_TEST(test_trampoline_stats_cyccnt_wrap);
+    RUN_TEST(test_trampoline_stats_reset);
+    TEST_SUITE_END();
 }
@@ -407,11 +407,11 @@ void TIM3_IRQHandler(void)
 }
 
 /**
- * @brief  定时中断入口，定时器4
+ * @brief  定时中断入口，定时器4 (弱定义，可由应用接管，如 PC 采样分析器)
  * @param  无
  * @retval 无
  */
-void TIM4_IRQHandler(void)
+__attribute__((weak)) void TIM4_IRQHandler(void)
 {
     TIMx_IRQHANDLER(4);
 }
@@ -0,0 +1,202 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 _VIFEXTech
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "usart_dma.h"
+
+/**
+ * @brief  获取 DMA 当前写位置
+ * @param  Rx: 接收缓冲区对象
+ * @retval 写位置 (0 ~ Size-1)
+ */
+static uint16_t USART_DMA_RxHead(USART_DMA_Rx_TypeDef* Rx)
+{
+    /* 循环模式下 CNDTR 在 Size ~ 1 之间递减, 到 0 时自动重载 */
+    uint16_t head = Rx->Size - DMA_GetCurrDataCounter(Rx->DMA_Channel);
+    return head < Rx->Size ? head : 0;
+}
+
+/**
+ * @brief  串口接收 DMA 初始化 (串口需先由 HardwareSerial::begin 配置)
+ * @param  Rx: 接收缓冲区对象
+ * @param  USARTx: 串口外设 (USART1/2/3)
+ * @param  Buffer: 环形缓冲区
+ * @param  Size: 缓冲区大小
+ * @retval 0: 成功, -1: 不支持的串口
+ */
+int USART_DMA_RxInit(USART_DMA_Rx_TypeDef* Rx, USART_TypeDef* USARTx, uint8_t* Buffer, uint16_t Size)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+    DMA_Channel_TypeDef* DMA_Channel;
+
+    /* STM32F10x 固定映射: USART1_RX->CH5, USART2_RX->CH6, USART3_RX->CH3 */
+    if (USARTx == USART1) {
+        DMA_Channel = DMA1_Channel5;
+    } else if (USARTx == USART2) {
+        DMA_Channel = DMA1_Channel6;
+    } else if (USARTx == USART3) {
+        DMA_Channel = DMA1_Channel3;
+    } else {
+        return -1;
+    }
+
+    Rx->USARTx = USARTx;
+    Rx->DMA_Channel = DMA_Channel;
+    Rx->Buffer = Buffer;
+    Rx->Size = Size;
+    Rx->Tail = 0;
+
+    // 打开DMA时钟
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+    // 复位DMA通道
+    DMA_DeInit(DMA_Channel);
+
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)(&(USARTx->DR));
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)Buffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = Size;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(DMA_Channel, &DMA_InitStructure);
+
+    // 接收改由DMA完成: 关闭RXNE中断, 打开串口DMA接收请求
+    USART_ITConfig(USARTx, USART_IT_RXNE, DISABLE);
+    USART_DMACmd(USARTx, USART_DMAReq_Rx, ENABLE);
+    DMA_Cmd(DMA_Channel, ENABLE);
+
+    return 0;
+}
+
+/**
+ * @brief  获取可读取的字节数
+ * @param  Rx: 接收缓冲区对象
+ * @retval 可读取的字节数
+ */
+uint16_t USART_DMA_RxAvailable(USART_DMA_Rx_TypeDef* Rx)
+{
+    return (uint16_t)((Rx->Size + USART_DMA_RxHead(Rx) - Rx->Tail) % Rx->Size);
+}
+
+/**
+ * @brief  获取下一段连续的已接收数据 (不移动读位置)
+ * @param  Rx: 接收缓冲区对象
+ * @param  Len: 输出数据段长度 (0: 无数据), 回绕时只返回到缓冲区末尾的部分
+ * @retval 数据段起始地址
+ */
+const uint8_t* USART_DMA_RxPeek(USART_DMA_Rx_TypeDef* Rx, size_t* Len)
+{
+    uint16_t head = USART_DMA_RxHead(Rx);
+    *Len = (head >= Rx->Tail) ? (size_t)(head - Rx->Tail) : (size_t)(Rx->Size - Rx->Tail);
+    return Rx->Buffer + Rx->Tail;
+}
+
+/**
+ * @brief  释放已处理的数据
+ * @param  Rx: 接收缓冲区对象
+ * @param  Len: 字节数 (不超过 USART_DMA_RxPeek 返回的长度)
+ * @retval 无
+ */
+void USART_DMA_RxConsume(USART_DMA_Rx_TypeDef* Rx, size_t Len)
+{
+    Rx->Tail = (uint16_t)((Rx->Tail + Len) % Rx->Size);
+}
+
+/**
+ * @brief  串口发送 DMA 初始化 (串口需先由 HardwareSerial::begin 配置)
+ * @param  Tx: 发送对象
+ * @param  USARTx: 串口外设 (USART1/2/3)
+ * @retval 0: 成功, -1: 不支持的串口
+ */
+int USART_DMA_TxInit(USART_DMA_Tx_TypeDef* Tx, USART_TypeDef* USARTx)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+    DMA_Channel_TypeDef* DMA_Channel;
+
+    /* STM32F10x 固定映射: USART1_TX->CH4, USART2_TX->CH7, USART3_TX->CH2 */
+    if (USARTx == USART1) {
+        DMA_Channel = DMA1_Channel4;
+    } else if (USARTx == USART2) {
+        DMA_Channel = DMA1_Channel7;
+    } else if (USARTx == USART3) {
+        DMA_Channel = DMA1_Channel2;
+    } else {
+        return -1;
+    }
+
+    Tx->USARTx = USARTx;
+    Tx->DMA_Channel = DMA_Channel;
+
+    // 打开DMA时钟
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+    // 复位DMA通道
+    DMA_DeInit(DMA_Channel);
+
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)(&(USARTx->DR));
+    DMA_InitStructure.DMA_MemoryBaseAddr = 0;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = 0;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(DMA_Channel, &DMA_InitStructure);
+
+    // 打开串口DMA发送请求
+    USART_DMACmd(USARTx, USART_DMAReq_Tx, ENABLE);
+
+    return 0;
+}
+
+/**
+ * @brief  查询发送是否进行中
+ * @param  Tx: 发送对象
+ * @retval true: 发送中
+ */
+bool USART_DMA_TxBusy(USART_DMA_Tx_TypeDef* Tx)
+{
+    return (Tx->DMA_Channel->CCR & DMA_CCR1_EN) && DMA_GetCurrDataCounter(Tx->DMA_Channel) > 0;
+}
+
+/**
+ * @brief  启动一段发送 (需在 TxBusy 返回 false 后调用)
+ * @param  Tx: 发送对象
+ * @param  Data: 数据, 传输完成前必须保持不变
+ * @param  Len: 字节数
+ * @retval 无
+ */
+void USART_DMA_TxStart(USART_DMA_Tx_TypeDef* Tx, const uint8_t* Data, uint16_t Len)
+{
+    // 通道关闭后才能修改地址和长度
+    DMA_Cmd(Tx->DMA_Channel, DISABLE);
+    Tx->DMA_Channel->CMAR = (uint32_t)Data;
+    DMA_SetCurrDataCounter(Tx->DMA_Channel, Len);
+    DMA_Cmd(Tx->DMA_Channel, ENABLE);
+}
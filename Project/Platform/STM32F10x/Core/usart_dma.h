@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ * Copyright (c) 2026 _VIFEXTech
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef __USART_DMA_H
+#define __USART_DMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "mcu_type.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * USART 接收 DMA 环形缓冲区
+ *
+ * DMA 以循环模式把 DR 搬运到 Buffer, 写位置由 CNDTR 推出, 无需接收中断.
+ * 读取方通过 Peek/Consume 直接访问缓冲区中的连续数据段 (零拷贝).
+ * 注意: DMA 不检查读位置, 两次读取之间收到的数据不能超过 Size 字节.
+ */
+typedef struct {
+    USART_TypeDef* USARTx;
+    DMA_Channel_TypeDef* DMA_Channel;
+    uint8_t* Buffer;
+    uint16_t Size;
+    uint16_t Tail; /* 读位置 */
+} USART_DMA_Rx_TypeDef;
+
+/*
+ * USART 发送 DMA
+ *
+ * 每次启动一段发送, 传输期间数据必须保持不变; 通过 TxBusy 轮询完成状态.
+ */
+typedef struct {
+    USART_TypeDef* USARTx;
+    DMA_Channel_TypeDef* DMA_Channel;
+} USART_DMA_Tx_TypeDef;
+
+int USART_DMA_RxInit(USART_DMA_Rx_TypeDef* Rx, USART_TypeDef* USARTx, uint8_t* Buffer, uint16_t Size);
+uint16_t USART_DMA_RxAvailable(USART_DMA_Rx_TypeDef* Rx);
+const uint8_t* USART_DMA_RxPeek(USART_DMA_Rx_TypeDef* Rx, size_t* Len);
+void USART_DMA_RxConsume(USART_DMA_Rx_TypeDef* Rx, size_t Len);
+
+int USART_DMA_TxInit(USART_DMA_Tx_TypeDef* Tx, USART_TypeDef* USARTx);
+bool USART_DMA_TxBusy(USART_DMA_Tx_TypeDef* Tx);
+void USART_DMA_TxStart(USART_DMA_Tx_TypeDef* Tx, const uint8_t* Data, uint16_t Len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USART_DMA_H */
@@ -47,6 +47,7 @@
  */
 
 #include "fpb_debugmon.h"
+#include "fpb_inject.h"
 #include "fpb_regs.h"
 
 /* NuttX uses fpb_debugmon_nuttx.c instead */
@@ -55,8 +56,11 @@
 #include <string.h>
 #include <stdio.h>
 
-/* Debug logging - uses simple UART polling to avoid dependencies */
+/* Debug logging - uses simple UART polling to avoid dependencies.
+ * Off by default: the handler then contains no logging code at all. */
+#ifndef FPB_DEBUGMON_LOG
 #define FPB_DEBUGMON_LOG 0
+#endif
 
 #if FPB_DEBUGMON_LOG
 
@@ -106,12 +110,70 @@ typedef struct {
     uint32_t redirect_addr; /* Redirect target address (with Thumb bit) */
 } debugmon_redirect_t;
 
+/* Direct-mapped handler lookup: 4 buckets per redirect keeps collisions rare */
+#define DEBUGMON_HASH_BITS 5
+#define DEBUGMON_HASH_SIZE (1U << DEBUGMON_HASH_BITS)
+
 static struct {
     bool initialized;
-    uint8_t num_comp;
+    uint8_t num_comp;      /* FPB code comparators: redirects 0 ~ num_comp-1 */
+    uint8_t num_redirects; /* num_comp + DWT comparators used as redirects */
     debugmon_redirect_t redirects[FPB_DEBUGMON_MAX_REDIRECTS];
+    uint8_t bucket[DEBUGMON_HASH_SIZE]; /* comp_id + 1 of the redirect owning the bucket, 0 = empty */
 } g_debugmon_state;
 
+/* Fold the matched address bits (bit 0 is always clear) down to a bucket index.
+ * Shifts and XORs only: no multiplier needed on Baseline cores. */
+static inline uint32_t debugmon_hash(uint32_t match_addr) {
+    return ((match_addr >> 1) ^ (match_addr >> 6) ^ (match_addr >> 11) ^ (match_addr >> 16)) &
+           (DEBUGMON_HASH_SIZE - 1);
+}
+
+/* Give a bucket to the first redirect hashing to it. A redirect that lost its
+ * bucket to a collision is still found by the linear scan in the slow path. */
+static void debugmon_rehash(uint32_t bucket) {
+    g_debugmon_state.bucket[bucket] = 0;
+    for (uint8_t i = 0; i < g_debugmon_state.num_redirects; i++) {
+        uint32_t addr = g_debugmon_state.redirects[i].original_addr;
+        if (addr != 0 && debugmon_hash(addr) == bucket) {
+            g_debugmon_state.bucket[bucket] = i + 1;
+            return;
+        }
+    }
+}
+
+static uint32_t debugmon_lookup_slow(uint32_t match_addr) {
+    for (uint8_t i = 0; i < g_debugmon_state.num_redirects; i++) {
+        if (g_debugmon_state.redirects[i].original_addr == match_addr) {
+            return g_debugmon_state.redirects[i].redirect_addr;
+        }
+    }
+
+    return 0;
+}
+
+static uint8_t debugmon_count_fpb(void) {
+    uint32_t n = (FPB_CTRL & FPB_CTRL_NUM_CODE_MASK) >> FPB_CTRL_NUM_CODE_SHIFT;
+    return n > FPB_DEBUGMON_MAX_FPB ? FPB_DEBUGMON_MAX_FPB : (uint8_t)n;
+}
+
+/* DWT registers read as zero on some cores until DEMCR.TRCENA is set */
+static uint8_t debugmon_count_dwt(void) {
+    uint32_t n = (DWT_CTRL & DWT_CTRL_NUMCOMP_MASK) >> DWT_CTRL_NUMCOMP_SHIFT;
+    return n > FPB_DEBUGMON_MAX_DWT ? FPB_DEBUGMON_MAX_DWT : (uint8_t)n;
+}
+
+/* Arm DWT comparator n as an exact instruction address match. Unlike FPBv1
+ * comparators it matches any address, including code in SRAM or PSRAM. */
+static void debugmon_set_dwt(uint8_t n, uint32_t match_addr) {
+    DWT_FUNCTION(n) = 0;
+    DWT_COMP(n) = match_addr;
+#ifdef DWT_MASK
+    DWT_MASK(n) = 0;
+#endif
+    DWT_FUNCTION(n) = DWT_FUNCTION_PC_MATCH;
+}
+
 /* ============================================================================
  * Implementation
  * ============================================================================ */
@@ -122,8 +184,7 @@ int fpb_debugmon_init(void) {
     memset(&g_debugmon_state, 0, sizeof(g_debugmon_state));
 
     /* Check FPB availability */
-    uint32_t ctrl = FPB_CTRL;
-    g_debugmon_state.num_comp = (ctrl & FPB_CTRL_NUM_CODE_MASK) >> FPB_CTRL_NUM_CODE_SHIFT;
+    g_debugmon_state.num_comp = debugmon_count_fpb();
 
     dbg_puts("[DBGMON] FPB comps: ");
     dbg_hex32(g_debugmon_state.num_comp);
@@ -133,13 +194,12 @@ int fpb_debugmon_init(void) {
         return -1; /* No FPB */
     }
 
-    if (g_debugmon_state.num_comp > FPB_DEBUGMON_MAX_REDIRECTS) {
-        g_debugmon_state.num_comp = FPB_DEBUGMON_MAX_REDIRECTS;
-    }
-
     /* Enable trace (required for some debug features) */
     DEMCR |= DEMCR_TRCENA;
 
+    /* DWT comparators extend the redirect pool past the FPB comparators */
+    g_debugmon_state.num_redirects = g_debugmon_state.num_comp + debugmon_count_dwt();
+
     /* Try to enable debug if not already enabled
      * Note: On Cortex-M3, C_DEBUGEN can only be set by external debugger
      * This write may be ignored, but we try anyway
@@ -199,6 +259,13 @@ void fpb_debugmon_deinit(void) {
         FPB_COMP(i) = 0;
     }
 
+    /* DWT comparators are shared with debuggers: only disable the ones we armed */
+    for (uint8_t i = g_debugmon_state.num_comp; i < g_debugmon_state.num_redirects; i++) {
+        if (g_debugmon_state.redirects[i].original_addr != 0) {
+            DWT_FUNCTION(i - g_debugmon_state.num_comp) = 0;
+        }
+    }
+
     /* Disable DebugMonitor */
     DEMCR &= ~DEMCR_MON_EN;
 
@@ -222,11 +289,18 @@ int fpb_debugmon_set_redirect(uint8_t comp_id, uint32_t original_addr, uint32_t
         return -1;
     }
 
-    if (comp_id >= g_debugmon_state.num_comp) {
+    if (comp_id >= g_debugmon_state.num_redirects) {
         dbg_puts("[DBGMON] ERROR: invalid comp_id\r\n");
         return -1;
     }
 
+    /* Leave a DWT comparator alone if a debugger (or the application) uses it */
+    if (comp_id >= g_debugmon_state.num_comp && g_debugmon_state.redirects[comp_id].original_addr == 0 &&
+        (DWT_FUNCTION(comp_id - g_debugmon_state.num_comp) & DWT_FUNCTION_MODE_MASK) != 0) {
+        dbg_puts("[DBGMON] ERROR: DWT comparator in use\r\n");
+        return -2;
+    }
+
     /* Note: Traditional FPB (FPBv1) only supports Code region (0x00000000-0x1FFFFFFF).
      * However, FPBv2 on ARMv8-M supports wider address ranges.
      * Some platforms may execute code from PSRAM or external memory.
@@ -236,11 +310,27 @@ int fpb_debugmon_set_redirect(uint8_t comp_id, uint32_t original_addr, uint32_t
 
     /* Strip Thumb bit for comparison */
     uint32_t match_addr = original_addr & ~1UL;
+    uint32_t old_addr = g_debugmon_state.redirects[comp_id].original_addr;
 
     /* Store redirect info */
     g_debugmon_state.redirects[comp_id].original_addr = match_addr;
     g_debugmon_state.redirects[comp_id].redirect_addr = redirect_addr | 1; /* Ensure Thumb bit */
 
+    /* Entry first, bucket second: the handler checks the entry it is pointed at */
+    if (old_addr != 0) {
+        debugmon_rehash(debugmon_hash(old_addr));
+    }
+    if (g_debugmon_state.bucket[debugmon_hash(match_addr)] == 0) {
+        g_debugmon_state.bucket[debugmon_hash(match_addr)] = comp_id + 1;
+    }
+
+    if (comp_id >= g_debugmon_state.num_comp) {
+        debugmon_set_dwt(comp_id - g_debugmon_state.num_comp, match_addr);
+        fpb_barrier();
+        dbg_puts("[DBGMON] set_redirect OK (DWT)\r\n");
+        return 0;
+    }
+
     /* Configure FPB comparator for breakpoint
      *
      * On Cortex-M3/M4 (FPBv1), REPLACE bits [31:30]:
@@ -265,8 +355,7 @@ int fpb_debugmon_set_redirect(uint8_t comp_id, uint32_t original_addr, uint32_t
     dbg_hex32(FPB_COMP(comp_id));
     dbg_puts("\r\n");
 
-    dsb();
-    isb();
+    fpb_barrier();
 
     dbg_puts("[DBGMON] set_redirect OK\r\n");
     return 0;
@@ -277,75 +366,87 @@ int fpb_debugmon_clear_redirect(uint8_t comp_id) {
         return -1;
     }
 
-    if (comp_id >= g_debugmon_state.num_comp) {
+    if (comp_id >= g_debugmon_state.num_redirects) {
         return -1;
     }
 
-    /* Disable FPB comparator */
-    FPB_COMP(comp_id) = 0;
+    /* Disable the comparator (a DWT one only if this redirect armed it) */
+    if (comp_id < g_debugmon_state.num_comp) {
+        FPB_COMP(comp_id) = 0;
+    } else if (g_debugmon_state.redirects[comp_id].original_addr != 0) {
+        DWT_FUNCTION(comp_id - g_debugmon_state.num_comp) = 0;
+    }
 
     /* Clear redirect entry */
+    uint32_t old_addr = g_debugmon_state.redirects[comp_id].original_addr;
     g_debugmon_state.redirects[comp_id].original_addr = 0;
     g_debugmon_state.redirects[comp_id].redirect_addr = 0;
 
-    dsb();
-    isb();
+    if (old_addr != 0) {
+        debugmon_rehash(debugmon_hash(old_addr));
+    }
+
+    fpb_barrier();
 
     return 0;
 }
 
-uint32_t fpb_debugmon_get_redirect(uint32_t original_addr) {
-    uint32_t match_addr = original_addr & ~1UL;
+int fpb_debugmon_retarget(uint8_t comp_id, uint32_t redirect_addr) {
+    if (!g_debugmon_state.initialized || comp_id >= g_debugmon_state.num_redirects) {
+        return -1;
+    }
 
-    for (uint8_t i = 0; i < g_debugmon_state.num_comp; i++) {
-        if (g_debugmon_state.redirects[i].original_addr == match_addr) {
-            return g_debugmon_state.redirects[i].redirect_addr;
-        }
+    if (g_debugmon_state.redirects[comp_id].original_addr == 0) {
+        return -1;
     }
 
+    /* Comparator and original address unchanged: only the target word moves */
+    g_debugmon_state.redirects[comp_id].redirect_addr = redirect_addr | 1;
+
     return 0;
 }
 
-bool fpb_debugmon_is_active(void) {
-    return g_debugmon_state.initialized;
-}
+uint32_t fpb_debugmon_get_redirect(uint32_t original_addr) {
+    uint32_t match_addr = original_addr & ~1UL;
+    uint8_t slot = g_debugmon_state.bucket[debugmon_hash(match_addr)];
 
-void fpb_debugmon_handler(uint32_t* stack_frame) {
-    dbg_puts("[DBGMON] *** HANDLER CALLED ***\r\n");
+    if (slot != 0 && g_debugmon_state.redirects[slot - 1].original_addr == match_addr) {
+        return g_debugmon_state.redirects[slot - 1].redirect_addr;
+    }
 
-    /* Check if this was a breakpoint */
-    uint32_t dfsr = DFSR;
-    dbg_puts("[DBGMON] DFSR=");
-    dbg_hex32(dfsr);
-    dbg_puts("\r\n");
+    return debugmon_lookup_slow(match_addr);
+}
 
-    if (!(dfsr & DFSR_BKPT)) {
-        /* Not a breakpoint - shouldn't happen in our setup */
-        dbg_puts("[DBGMON] Not a BKPT, returning\r\n");
-        return;
+uint8_t fpb_debugmon_get_capacity(void) {
+    if (g_debugmon_state.initialized) {
+        return g_debugmon_state.num_redirects;
     }
 
-    /* Clear breakpoint flag */
-    DFSR = DFSR_BKPT;
+    uint8_t num_comp = debugmon_count_fpb();
+    if (num_comp == 0) {
+        return 0;
+    }
 
-    /* Get the faulting PC (address that triggered breakpoint) */
-    uint32_t faulting_pc = stack_frame[STACK_PC];
-    dbg_puts("[DBGMON] faulting_pc=");
-    dbg_hex32(faulting_pc);
-    dbg_puts("\r\n");
+    DEMCR |= DEMCR_TRCENA;
+    return num_comp + debugmon_count_dwt();
+}
 
-    /* Look up redirect target */
-    uint32_t redirect = fpb_debugmon_get_redirect(faulting_pc);
-    dbg_puts("[DBGMON] redirect=");
+bool fpb_debugmon_is_active(void) {
+    return g_debugmon_state.initialized;
+}
+
+/* Bucket collision or unknown address: kept out of line so the fast path
+ * in fpb_debugmon_handler() stays a leaf with no stack frame */
+static __attribute__((noinline)) void debugmon_handler_slow(uint32_t* stack_frame, uint32_t pc) {
+    uint32_t redirect = debugmon_lookup_slow(pc);
+    dbg_puts("[DBGMON] faulting_pc=");
+    dbg_hex32(pc);
+    dbg_puts(" redirect=");
     dbg_hex32(redirect);
     dbg_puts("\r\n");
 
     if (redirect != 0) {
-        /* Modify stacked PC to redirect execution */
         stack_frame[STACK_PC] = redirect;
-        dbg_puts("[DBGMON] PC redirected!\r\n");
-    } else {
-        dbg_puts("[DBGMON] WARNING: no redirect found!\r\n");
     }
     /* If no redirect found, execution continues at original address
      * This will immediately trigger another breakpoint - infinite loop!
@@ -358,6 +459,30 @@ void fpb_debugmon_handler(uint32_t* stack_frame) {
      */
 }
 
+void fpb_debugmon_handler(uint32_t* stack_frame) {
+    /* Check if this was an FPB breakpoint or a DWT match */
+    uint32_t dfsr = DFSR & (DFSR_BKPT | DFSR_DWTTRAP);
+    if (dfsr == 0) {
+        /* Not a redirect event - shouldn't happen in our setup */
+        return;
+    }
+
+    /* Clear the flags (write-one-to-clear) */
+    DFSR = dfsr;
+
+    /* Stacked PC is the address that triggered the breakpoint (bit 0 clear) */
+    uint32_t pc = stack_frame[STACK_PC];
+    uint8_t slot = g_debugmon_state.bucket[debugmon_hash(pc)];
+
+    if (slot != 0 && g_debugmon_state.redirects[slot - 1].original_addr == pc) {
+        /* Modify stacked PC to redirect execution */
+        stack_frame[STACK_PC] = g_debugmon_state.redirects[slot - 1].redirect_addr;
+        return;
+    }
+
+    debugmon_handler_slow(stack_frame, pc);
+}
+
 /* ============================================================================
  * DebugMonitor Handler (weak, for platforms without attach callback)
  * ============================================================================ */
@@ -376,20 +501,16 @@ __attribute__((weak, naked)) void DebugMon_Handler(void) {
     /* Use naked to avoid compiler-generated prologue/epilogue
      * which might corrupt the stack frame we need to read */
     __asm volatile(
-        /* Quick debug output - toggle a GPIO or similar could be added here */
-
         /* Determine which stack pointer was used */
         "tst lr, #4\n"    /* Test bit 2 of EXC_RETURN */
         "ite eq\n"        /* If equal (bit 2 = 0, using MSP) */
         "mrseq r0, msp\n" /* Use MSP */
         "mrsne r0, psp\n" /* Else use PSP */
 
-        /* r0 now contains stack_frame pointer */
-        /* Call the C handler */
-        "push {lr}\n"
-        "bl fpb_debugmon_handler\n"
-        "pop {lr}\n"
-        "bx lr\n");
+        /* r0 now contains stack_frame pointer. Tail-call the C handler with
+         * EXC_RETURN still in lr, so its own return ends the exception and
+         * the stack stays 8-byte aligned as the hardware left it */
+        "b fpb_debugmon_handler\n");
 }
 #endif /* !FPB_DEBUGMON_NO_DEFAULT_HANDLER && !FPB_HOST_TESTING */
 
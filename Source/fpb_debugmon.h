@@ -45,6 +45,10 @@
  * - DebugMonitor has lower priority than some exceptions
  * - Cannot redirect code in exception handlers with same/higher priority
  *
+ * Redirect slots: the FPB code comparators, then DWT comparators set to
+ * instruction address match. Both raise DebugMonitor, so DWT comparators add
+ * redirects on cores without an RTOS debugpoint API.
+ *
  * Usage:
  * 1. Call fpb_debugmon_init() to enable DebugMonitor
  * 2. Use fpb_debugmon_set_redirect() to configure redirections
@@ -65,8 +69,16 @@ extern "C" {
 #include <stdbool.h>
 #include <stdint.h>
 
-/* Maximum number of redirects (same as FPB code comparators) */
-#define FPB_DEBUGMON_MAX_REDIRECTS 8
+/* Maximum number of redirects backed by FPB code comparators */
+#define FPB_DEBUGMON_MAX_FPB 8
+
+/* Maximum number of redirects backed by DWT comparators (PC match) */
+#ifndef FPB_DEBUGMON_MAX_DWT
+#define FPB_DEBUGMON_MAX_DWT 4
+#endif
+
+/* Maximum number of redirects: FPB comparators first, then DWT comparators */
+#define FPB_DEBUGMON_MAX_REDIRECTS (FPB_DEBUGMON_MAX_FPB + FPB_DEBUGMON_MAX_DWT)
 
 /**
  * @brief  Initialize DebugMonitor-based redirection
@@ -80,9 +92,16 @@ int fpb_debugmon_init(void);
  */
 void fpb_debugmon_deinit(void);
 
+/**
+ * @brief  Number of redirect slots (FPB code comparators, then DWT comparators)
+ * @note   Slot N >= FPB code comparator count uses DWT comparator N - count
+ * @return Slot count, 0 if no FPB
+ */
+uint8_t fpb_debugmon_get_capacity(void);
+
 /**
  * @brief  Set a function redirect via DebugMonitor
- * @param  comp_id: FPB comparator ID (0 ~ FPB_DEBUGMON_MAX_REDIRECTS-1)
+ * @param  comp_id: Redirect slot (0 ~ fpb_debugmon_get_capacity()-1)
  * @param  original_addr: Original function address (in Flash/Code region)
  * @param  redirect_addr: New function address (can be in RAM)
  * @retval 0: Success, -1: Invalid parameter, -2: Comparator unavailable
@@ -96,6 +115,15 @@ int fpb_debugmon_set_redirect(uint8_t comp_id, uint32_t original_addr, uint32_t
  */
 int fpb_debugmon_clear_redirect(uint8_t comp_id);
 
+/**
+ * @brief  Point an active redirect at new code, leaving the breakpoint armed
+ * @note   A single word store: the handler sees either the old or the new target
+ * @param  comp_id: FPB comparator ID
+ * @param  redirect_addr: New function address (can be in RAM)
+ * @retval 0: Success, -1: Invalid parameter or no redirect on comp_id
+ */
+int fpb_debugmon_retarget(uint8_t comp_id, uint32_t redirect_addr);
+
 /**
  * @brief  Get redirect target for an address
  * @param  original_addr: Address to look up
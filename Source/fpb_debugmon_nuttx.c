@@ -86,6 +86,13 @@ extern int arm_dbgmonitor(int irq, void* context, void* arg);
  * State
  * ============================================================================ */
 
+/*
+ * up_debugpoint_add() picks the FPB or DWT comparator itself and cannot
+ * report how many are left: keep one redirect per FPB code comparator, as
+ * before DWT slots were added to the bare-metal backend.
+ */
+#define DEBUGMON_MAX_REDIRECTS FPB_DEBUGMON_MAX_FPB
+
 typedef struct {
     uint32_t original_addr; /* Original function address (without Thumb bit), 0 = not used */
     uint32_t redirect_addr; /* Redirect target address (with Thumb bit) */
@@ -93,7 +100,7 @@ typedef struct {
 
 static struct {
     bool initialized;
-    debugmon_redirect_t redirects[FPB_DEBUGMON_MAX_REDIRECTS];
+    debugmon_redirect_t redirects[DEBUGMON_MAX_REDIRECTS];
 } g_debugmon_state;
 
 /* ============================================================================
@@ -173,7 +180,7 @@ void fpb_debugmon_deinit(void) {
     }
 
     /* Remove all debugpoints */
-    for (int i = 0; i < FPB_DEBUGMON_MAX_REDIRECTS; i++) {
+    for (int i = 0; i < DEBUGMON_MAX_REDIRECTS; i++) {
         if (g_debugmon_state.redirects[i].original_addr != 0) {
             fpb_debugmon_clear_redirect(i);
         }
@@ -191,7 +198,7 @@ int fpb_debugmon_set_redirect(uint8_t comp_id, uint32_t original_addr, uint32_t
         return -1;
     }
 
-    if (comp_id >= FPB_DEBUGMON_MAX_REDIRECTS) {
+    if (comp_id >= DEBUGMON_MAX_REDIRECTS) {
         syslog(LOG_ERR, "[DBGMON] invalid comp_id %d\n", comp_id);
         return -1;
     }
@@ -251,7 +258,7 @@ int fpb_debugmon_clear_redirect(uint8_t comp_id) {
         return -1;
     }
 
-    if (comp_id >= FPB_DEBUGMON_MAX_REDIRECTS) {
+    if (comp_id >= DEBUGMON_MAX_REDIRECTS) {
         return -1;
     }
 
@@ -275,10 +282,25 @@ int fpb_debugmon_clear_redirect(uint8_t comp_id) {
     return 0;
 }
 
+int fpb_debugmon_retarget(uint8_t comp_id, uint32_t redirect_addr) {
+    if (!g_debugmon_state.initialized || comp_id >= DEBUGMON_MAX_REDIRECTS) {
+        return -1;
+    }
+
+    if (g_debugmon_state.redirects[comp_id].original_addr == 0) {
+        return -1;
+    }
+
+    /* Comparator and original address unchanged: only the target word moves */
+    g_debugmon_state.redirects[comp_id].redirect_addr = redirect_addr | 1;
+
+    return 0;
+}
+
 uint32_t fpb_debugmon_get_redirect(uint32_t original_addr) {
     uint32_t match_addr = original_addr & ~1UL;
 
-    for (int i = 0; i < FPB_DEBUGMON_MAX_REDIRECTS; i++) {
+    for (int i = 0; i < DEBUGMON_MAX_REDIRECTS; i++) {
         if (g_debugmon_state.redirects[i].original_addr == match_addr) {
             return g_debugmon_state.redirects[i].redirect_addr;
         }
@@ -287,6 +309,10 @@ uint32_t fpb_debugmon_get_redirect(uint32_t original_addr) {
     return 0;
 }
 
+uint8_t fpb_debugmon_get_capacity(void) {
+    return DEBUGMON_MAX_REDIRECTS;
+}
+
 bool fpb_debugmon_is_active(void) {
     return g_debugmon_state.initialized;
 }
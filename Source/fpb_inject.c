@@ -64,6 +64,9 @@ static uint32_t g_fpb_remap_table[FPB_REMAP_TABLE_SIZE];
 __attribute__((aligned(32), section(".data"))) static uint32_t g_fpb_remap_table[FPB_REMAP_TABLE_SIZE];
 #endif
 
+/* Nesting depth of fpb_begin_update(): barriers are deferred while > 0 */
+static uint32_t g_fpb_update_depth;
+
 /**
  * @brief Generate Thumb-2 B.W instruction (unconditional branch)
  */
@@ -90,6 +93,22 @@ static uint32_t generate_b_w_instruction(uint32_t from_addr, uint32_t target_add
     return ((uint32_t)hw2 << 16) | hw1;
 }
 
+/**
+ * @brief Point comparator comp_id at the word at addr and fetch it from remap_table[comp_id]
+ */
+static void remap_word(uint8_t comp_id, uint32_t addr, uint32_t word) {
+    /* Store the word at correct index for this comparator */
+    g_fpb_remap_table[comp_id] = word;
+
+    /* Set remap base - bits[28:5] of the table address */
+    uint32_t remap_base = (uint32_t)(uintptr_t)g_fpb_remap_table;
+    /* FP_REMAP stores bits[28:5], bits[31:29] are hardwired to 0b001 (SRAM) */
+    FPB_REMAP = remap_base & 0x1FFFFFE0UL;
+
+    /* Configure comparator for REMAP mode (REPLACE=00) */
+    FPB_COMP(comp_id) = (addr & FPB_COMP_ADDR_MASK) | FPB_REPLACE_REMAP | FPB_COMP_ENABLE;
+}
+
 fpb_result_t fpb_init(void) {
     /* If already initialized, return success (idempotent) */
     if (g_fpb_state.initialized) {
@@ -107,6 +126,7 @@ fpb_result_t fpb_init(void) {
 
     g_fpb_state.num_code_comp = info.num_code_comp;
     g_fpb_state.num_lit_comp = info.num_lit_comp;
+    g_fpb_state.remap_supported = info.rev == 0 && info.remap_supported;
 
     if (g_fpb_state.num_code_comp > FPB_MAX_CODE_COMP) {
         g_fpb_state.num_code_comp = FPB_MAX_CODE_COMP;
@@ -139,7 +159,7 @@ void fpb_deinit(void) {
     isb();
 }
 
-fpb_result_t fpb_set_patch(uint8_t comp_id, uint32_t original_addr, uint32_t patch_addr) {
+fpb_result_t fpb_check_patch(uint8_t comp_id, uint32_t original_addr) {
     if (!g_fpb_state.initialized) {
         return FPB_ERR_NOT_INIT;
     }
@@ -152,6 +172,15 @@ fpb_result_t fpb_set_patch(uint8_t comp_id, uint32_t original_addr, uint32_t pat
         return FPB_ERR_INVALID_ADDR;
     }
 
+    return FPB_OK;
+}
+
+fpb_result_t fpb_set_patch(uint8_t comp_id, uint32_t original_addr, uint32_t patch_addr) {
+    fpb_result_t ret = fpb_check_patch(comp_id, original_addr);
+    if (ret != FPB_OK) {
+        return ret;
+    }
+
     original_addr &= ~1UL;
     patch_addr &= ~1UL;
 
@@ -211,23 +240,71 @@ fpb_result_t fpb_set_patch(uint8_t comp_id, uint32_t original_addr, uint32_t pat
      *   - So actual remap address = 0x20000000 | (FP_REMAP & 0x1FFFFFE0)
      */
 
-    /* Store jump instruction at correct index for this comparator */
-    g_fpb_remap_table[comp_id] = jump_instr;
-
-    /* Set remap base - bits[28:5] of the table address */
-    uint32_t remap_base = (uint32_t)(uintptr_t)g_fpb_remap_table;
-    /* FP_REMAP stores bits[28:5], bits[31:29] are hardwired to 0b001 (SRAM) */
-    FPB_REMAP = remap_base & 0x1FFFFFE0UL;
-
-    /* Configure comparator for REMAP mode (REPLACE=00) */
-    uint32_t comp_val = (original_addr & FPB_COMP_ADDR_MASK) | FPB_REPLACE_REMAP | FPB_COMP_ENABLE;
-    FPB_COMP(comp_id) = comp_val;
+    remap_word(comp_id, original_addr, jump_instr);
 
     g_fpb_state.comp[comp_id].original_addr = original_addr;
     g_fpb_state.comp[comp_id].patch_addr = patch_addr;
 
-    dsb();
-    isb();
+    fpb_barrier();
+
+    return FPB_OK;
+}
+
+/**
+ * @brief Thumb: first halfwords 0b11101/0b11110/0b11111 start a 32-bit instruction
+ */
+static bool thumb_is_32bit(uint16_t hw1) {
+    return (hw1 >> 11) >= 0x1D;
+}
+
+fpb_result_t fpb_check_insn_patch(uint8_t comp_id, uint32_t addr, uint32_t insn) {
+    fpb_result_t ret = fpb_check_patch(comp_id, addr);
+    if (ret != FPB_OK) {
+        return ret;
+    }
+
+    if (!g_fpb_state.remap_supported) {
+        return FPB_ERR_NOT_SUPPORTED;
+    }
+
+    bool wide = insn > 0xFFFFUL;
+    if (thumb_is_32bit((uint16_t)(wide ? insn >> 16 : insn)) != wide) {
+        return FPB_ERR_INVALID_PARAM;
+    }
+
+    if (wide && (addr & 2)) {
+        return FPB_ERR_INVALID_ADDR;
+    }
+
+    return FPB_OK;
+}
+
+fpb_result_t fpb_set_insn_patch(uint8_t comp_id, uint32_t addr, uint32_t insn) {
+    fpb_result_t ret = fpb_check_insn_patch(comp_id, addr, insn);
+    if (ret != FPB_OK) {
+        return ret;
+    }
+
+    addr &= ~1UL;
+    bool wide = insn > 0xFFFFUL;
+    uint16_t hw1 = (uint16_t)(wide ? insn >> 16 : insn);
+
+    /* The remap word replaces both halfwords at addr & ~3 */
+    uint32_t word_addr = addr & ~3UL;
+    uint32_t word;
+    if (wide) {
+        word = ((insn & 0xFFFFUL) << 16) | hw1;
+    } else {
+        uint32_t orig = FPB_CODE_WORD(word_addr);
+        word = (addr & 2) ? ((orig & 0xFFFFUL) | ((uint32_t)hw1 << 16)) : ((orig & 0xFFFF0000UL) | hw1);
+    }
+
+    remap_word(comp_id, word_addr, word);
+
+    g_fpb_state.comp[comp_id].original_addr = addr;
+    g_fpb_state.comp[comp_id].patch_addr = 0;
+
+    fpb_barrier();
 
     return FPB_OK;
 }
@@ -249,8 +326,7 @@ fpb_result_t fpb_clear_patch(uint8_t comp_id) {
     g_fpb_state.comp[comp_id].original_addr = 0;
     g_fpb_state.comp[comp_id].patch_addr = 0;
 
-    dsb();
-    isb();
+    fpb_barrier();
 
     return FPB_OK;
 }
@@ -280,12 +356,33 @@ fpb_result_t fpb_enable_patch(uint8_t comp_id, bool enable) {
     }
     FPB_COMP(comp_id) = comp_val;
 
-    dsb();
-    isb();
+    fpb_barrier();
 
     return FPB_OK;
 }
 
+void fpb_begin_update(void) {
+    g_fpb_update_depth++;
+}
+
+void fpb_end_update(void) {
+    if (g_fpb_update_depth == 0) {
+        return;
+    }
+
+    if (--g_fpb_update_depth == 0) {
+        dsb();
+        isb();
+    }
+}
+
+void fpb_barrier(void) {
+    if (g_fpb_update_depth == 0) {
+        dsb();
+        isb();
+    }
+}
+
 const fpb_state_t* fpb_get_state(void) {
     return &g_fpb_state;
 }
@@ -89,6 +89,7 @@ typedef struct {
     bool initialized;
     uint8_t num_code_comp;
     uint8_t num_lit_comp;
+    bool remap_supported; /* FPBv1 with FP_REMAP: fpb_set_insn_patch() available */
     fpb_comp_state_t comp[FPB_MAX_CODE_COMP];
 } fpb_state_t;
 
@@ -145,6 +146,42 @@ void fpb_deinit(void);
  */
 fpb_result_t fpb_set_patch(uint8_t comp_id, uint32_t original_addr, uint32_t patch_addr);
 
+/**
+ * @brief  Check a code patch without arming it
+ * @note   Performs the same checks as fpb_set_patch(), which then cannot fail,
+ *         so patches can be validated up front and armed together later.
+ * @retval Same as fpb_set_patch()
+ */
+fpb_result_t fpb_check_patch(uint8_t comp_id, uint32_t original_addr);
+
+/**
+ * @brief  Replace a single Thumb instruction in place
+ * @param  comp_id: Comparator ID (0 ~ FPB_MAX_CODE_COMP-1)
+ * @param  addr: Instruction address (halfword aligned, in Code region)
+ * @param  insn: Replacement in objdump order: a 16-bit instruction, or
+ *               (first halfword << 16) | second halfword for a 32-bit one
+ * @retval FPB_OK: Success
+ * @retval FPB_ERR_NOT_INIT: FPB not initialized
+ * @retval FPB_ERR_INVALID_COMP: Invalid comparator ID
+ * @retval FPB_ERR_INVALID_ADDR: Address not in Code region, or a 32-bit
+ *         instruction that is not word aligned (it would span two remap words)
+ * @retval FPB_ERR_INVALID_PARAM: insn width does not match its encoding
+ * @retval FPB_ERR_NOT_SUPPORTED: No remap (FPBv2 or RMPSPT clear)
+ *
+ * The comparator remaps the whole word at addr & ~3: the other halfword of
+ * that word is copied from Flash. PC-relative instructions execute at addr,
+ * so they must be encoded for that address.
+ */
+fpb_result_t fpb_set_insn_patch(uint8_t comp_id, uint32_t addr, uint32_t insn);
+
+/**
+ * @brief  Check an instruction patch without arming it
+ * @note   Performs the same checks as fpb_set_insn_patch(), which then cannot
+ *         fail, so a live slot need not be released for a bad patch.
+ * @retval Same as fpb_set_insn_patch()
+ */
+fpb_result_t fpb_check_insn_patch(uint8_t comp_id, uint32_t addr, uint32_t insn);
+
 /**
  * @brief  Clear code patch
  * @param  comp_id: Comparator ID
@@ -164,6 +201,26 @@ fpb_result_t fpb_clear_patch(uint8_t comp_id);
  */
 fpb_result_t fpb_enable_patch(uint8_t comp_id, bool enable);
 
+/**
+ * @brief  Begin a batch of comparator updates
+ *
+ * Until the matching fpb_end_update(), fpb_set_patch(), fpb_set_insn_patch(),
+ * fpb_clear_patch(), fpb_enable_patch() and fpb_barrier() skip their DSB/ISB;
+ * fpb_end_update() issues a single one. Calls nest. The caller masks
+ * interrupts if the batch must appear atomic to running code.
+ */
+void fpb_begin_update(void);
+
+/**
+ * @brief  End a batch of comparator updates (DSB/ISB when the outermost ends)
+ */
+void fpb_end_update(void);
+
+/**
+ * @brief  DSB/ISB after a comparator write, deferred inside fpb_begin_update()
+ */
+void fpb_barrier(void);
+
 /**
  * @brief  Get FPB state information
  * @return Pointer to FPB state structure
@@ -18,10 +18,23 @@
 extern uint32_t mock_dhcsr;
 extern uint32_t mock_demcr;
 extern uint32_t mock_dfsr;
+extern uint32_t mock_dwt_ctrl;
+extern uint32_t mock_dwt_cyccnt;
+extern uint32_t mock_dwt_comp[16];
+extern uint32_t mock_dwt_mask[16];
+extern uint32_t mock_dwt_function[16];
 
 #define DHCSR mock_dhcsr
 #define DEMCR mock_demcr
 #define DFSR mock_dfsr
+#define DWT_CTRL mock_dwt_ctrl
+#define DWT_CYCCNT mock_dwt_cyccnt
+#define DWT_COMP(n) mock_dwt_comp[n]
+#define DWT_MASK(n) mock_dwt_mask[n]
+#define DWT_FUNCTION(n) mock_dwt_function[n]
+
+/* Mock Code region: see fpb_mock_code_word() */
+#define FPB_CODE_WORD(addr) fpb_mock_code_word(addr)
 
 #else /* !FPB_HOST_TESTING */
 
@@ -53,6 +66,21 @@ extern uint32_t mock_dfsr;
 /* Debug Fault Status Register */
 #define DFSR (*(volatile uint32_t*)0xE000ED30)
 
+/* DWT Control Register and cycle counter */
+#define DWT_CTRL (*(volatile uint32_t*)0xE0001000)
+#define DWT_CYCCNT (*(volatile uint32_t*)0xE0001004)
+
+/* DWT comparator n (0 ~ NUMCOMP-1) */
+#define DWT_COMP(n) (*(volatile uint32_t*)(0xE0001020UL + ((n)*16)))
+#define DWT_FUNCTION(n) (*(volatile uint32_t*)(0xE0001028UL + ((n)*16)))
+#if !defined(__ARM_ARCH_8M_MAIN__) && !defined(__ARM_ARCH_8M_BASE__) && !defined(__ARM_ARCH_8_1M_MAIN__)
+/* ARMv8-M has no DWT_MASK (ranges use linked comparators instead) */
+#define DWT_MASK(n) (*(volatile uint32_t*)(0xE0001024UL + ((n)*16)))
+#endif
+
+/* Data read of a word in the Code region (FPB code comparators only match fetches) */
+#define FPB_CODE_WORD(addr) (*(const volatile uint32_t*)(uintptr_t)(addr))
+
 #endif /* FPB_HOST_TESTING */
 
 /* ============================================================================
@@ -106,7 +134,23 @@ extern uint32_t mock_dfsr;
 #define DEMCR_MON_REQ (1UL << 19)  /* DebugMonitor semaphore */
 
 /* DFSR bits */
-#define DFSR_BKPT (1UL << 1) /* Breakpoint flag */
+#define DFSR_BKPT (1UL << 1)    /* Breakpoint flag */
+#define DFSR_DWTTRAP (1UL << 2) /* DWT match flag */
+
+/* DWT_CTRL bits */
+#define DWT_CTRL_CYCCNTENA (1UL << 0) /* Enable the cycle counter */
+#define DWT_CTRL_NUMCOMP_MASK (0xFUL << 28)
+#define DWT_CTRL_NUMCOMP_SHIFT 28
+
+/* DWT_FUNCTION bits: [3:0] is FUNCTION (ARMv7-M) or MATCH (ARMv8-M), 0 = disabled */
+#define DWT_FUNCTION_MODE_MASK 0xFUL
+#if defined(__ARM_ARCH_8M_MAIN__) || defined(__ARM_ARCH_8M_BASE__) || defined(__ARM_ARCH_8_1M_MAIN__)
+/* MATCH = instruction address, ACTION = debug event, DATAVSIZE = halfword */
+#define DWT_FUNCTION_PC_MATCH ((1UL << 10) | (1UL << 4) | 0x2UL)
+#else
+/* FUNCTION = PC watchpoint debug event, MASK = 0 for an exact match */
+#define DWT_FUNCTION_PC_MATCH 0x4UL
+#endif
 
 /* ============================================================================
  * Exception Stack Frame Offsets
@@ -36,10 +36,16 @@
  * Configuration macros (defined via CMake options):
  *   FPB_NO_TRAMPOLINE    - Disable trampoline entirely (when FPB can REMAP to RAM directly)
  *   FPB_TRAMPOLINE_NO_ASM - Use simple C instead of assembly (no argument preservation)
+ *   FPB_TRAMPOLINE_STATS - Instrumented trampolines: per-slot call counter and
+ *                          DWT cycle accounting (needs LDREX/STREX, ARMv7-M)
  */
 
 #include "fpb_trampoline.h"
 
+#ifdef FPB_TRAMPOLINE_STATS
+#include "fpb_regs.h"
+#endif
+
 #ifndef FPB_NO_TRAMPOLINE
 
 /**
@@ -68,6 +74,88 @@ static const uint32_t fpb_trampoline_table[FPB_TRAMPOLINE_COUNT] = {
     0x08001000, 0x08001010, 0x08001020, 0x08001030, 0x08001040, 0x08001050, 0x08001060, 0x08001070,
 };
 
+#ifdef FPB_TRAMPOLINE_STATS
+/* Mock exit shim addresses */
+static const uint32_t fpb_trampoline_exit_table[FPB_TRAMPOLINE_COUNT] = {
+    0x08001080, 0x08001090, 0x080010A0, 0x080010B0, 0x080010C0, 0x080010D0, 0x080010E0, 0x080010F0,
+};
+#endif
+
+#elif !defined(FPB_TRAMPOLINE_NO_ASM) && defined(FPB_TRAMPOLINE_STATS)
+/*============================================================================
+ * Instrumented assembly trampolines (preserve R0-R3, clobber R12)
+ *============================================================================*/
+
+/**
+ * Shared entry: R12 = trampoline index. The hook counts the call and, when
+ * the call is timed, returns the exit shim as the target's return address,
+ * so the target returns through fpb_trampoline_stats_return. Nothing is
+ * pushed across the call, so stacked arguments stay where the target expects
+ * them. R12 (IP) is scratch at any call boundary under the AAPCS.
+ */
+static __attribute__((naked, used, section(".trampoline"))) void fpb_trampoline_stats_entry(void) {
+    __asm volatile("push {r0-r3}\n"                  /* Keep arguments (SP stays 8-byte aligned) */
+                   "mov r0, r12\n"                   /* comp */
+                   "mov r1, lr\n"                    /* Caller return address */
+                   "bl fpb_trampoline_stats_enter\n" /* r0 = target, r1 = return address */
+                   "mov r12, r0\n"
+                   "mov lr, r1\n"
+                   "pop {r0-r3}\n"
+                   "cmp r12, #0\n"
+                   "it eq\n"
+                   "bxeq lr\n" /* No target: return */
+                   "bx r12\n"  /* Jump to target */
+    );
+}
+
+/**
+ * Shared exit: R12 = trampoline index, R0-R1 = target return value.
+ */
+static __attribute__((naked, used, section(".trampoline"))) void fpb_trampoline_stats_return(void) {
+    __asm volatile("push {r0-r3}\n"                 /* Keep return value (SP stays 8-byte aligned) */
+                   "mov r0, r12\n"                  /* comp */
+                   "bl fpb_trampoline_stats_exit\n" /* r0 = caller return address */
+                   "mov r12, r0\n"
+                   "pop {r0-r3}\n"
+                   "bx r12\n" /* Return to caller */
+    );
+}
+
+/**
+ * Macro to define an instrumented trampoline and its exit shim.
+ *
+ * @param n  Trampoline index (0-7)
+ */
+#define DEFINE_TRAMPOLINE_STATS_ASM(n)                                                        \
+    __attribute__((naked, section(".trampoline"))) void fpb_trampoline_##n(void) {            \
+        __asm volatile("mov r12, %0\n"                    /* Trampoline index */              \
+                       "b fpb_trampoline_stats_entry\n" /* Count, time, jump */              \
+                       :                                                                      \
+                       : "i"(n));                                                             \
+    }                                                                                         \
+    __attribute__((naked, section(".trampoline"))) void fpb_trampoline_exit_##n(void) {       \
+        __asm volatile("mov r12, %0\n"                     /* Trampoline index */             \
+                       "b fpb_trampoline_stats_return\n" /* Account, return to caller */    \
+                       :                                                                      \
+                       : "i"(n));                                                             \
+    }
+
+/* Generate all 8 trampolines (FPB v2 support) */
+DEFINE_TRAMPOLINE_STATS_ASM(0)
+DEFINE_TRAMPOLINE_STATS_ASM(1)
+DEFINE_TRAMPOLINE_STATS_ASM(2)
+DEFINE_TRAMPOLINE_STATS_ASM(3)
+DEFINE_TRAMPOLINE_STATS_ASM(4)
+DEFINE_TRAMPOLINE_STATS_ASM(5)
+DEFINE_TRAMPOLINE_STATS_ASM(6)
+DEFINE_TRAMPOLINE_STATS_ASM(7)
+
+/* Exit shim address table (in Flash, for lookup) */
+static void (*const fpb_trampoline_exit_table[FPB_TRAMPOLINE_COUNT])(void) = {
+    fpb_trampoline_exit_0, fpb_trampoline_exit_1, fpb_trampoline_exit_2, fpb_trampoline_exit_3,
+    fpb_trampoline_exit_4, fpb_trampoline_exit_5, fpb_trampoline_exit_6, fpb_trampoline_exit_7,
+};
+
 #elif !defined(FPB_TRAMPOLINE_NO_ASM)
 /*============================================================================
  * Assembly-based trampolines (preserve function arguments in R0-R3)
@@ -119,12 +207,26 @@ typedef void (*fpb_trampoline_func_t)(void);
  *
  * @param n  Trampoline index (0-5)
  */
+#ifndef FPB_TRAMPOLINE_STATS
 #define DEFINE_TRAMPOLINE_C(n)                                              \
     __attribute__((section(".trampoline"))) void fpb_trampoline_##n(void) { \
         if (fpb_trampoline_targets[n]) {                                    \
             ((fpb_trampoline_func_t)(fpb_trampoline_targets[n] & ~1u))();   \
         }                                                                   \
     }
+#else
+/* Instrumented: a nonzero return address from the hook marks a timed call */
+#define DEFINE_TRAMPOLINE_C(n)                                              \
+    __attribute__((section(".trampoline"))) void fpb_trampoline_##n(void) { \
+        uint64_t ret = fpb_trampoline_stats_enter(n, 0);                    \
+        if ((uint32_t)ret) {                                                \
+            ((fpb_trampoline_func_t)((uint32_t)ret & ~1u))();               \
+            if (ret >> 32) {                                                \
+                fpb_trampoline_stats_exit(n);                               \
+            }                                                               \
+        }                                                                   \
+    }
+#endif
 
 /* Generate all 8 trampolines (FPB v2 support) */
 DEFINE_TRAMPOLINE_C(0)
@@ -148,8 +250,91 @@ static void (*const fpb_trampoline_table[FPB_TRAMPOLINE_COUNT])(void) = {
 
 #endif /* !FPB_HOST_TESTING */
 
+#ifdef FPB_TRAMPOLINE_STATS
+/*============================================================================
+ * Call and cycle accounting
+ *============================================================================*/
+
+typedef struct {
+    fpb_trampoline_stats_t stats;
+    volatile uint32_t busy; /* A timed call is in flight */
+    uint32_t lr;            /* Its caller return address */
+    uint32_t start;         /* Its entry DWT_CYCCNT */
+} fpb_trampoline_slot_stats_t;
+
+static fpb_trampoline_slot_stats_t fpb_trampoline_stats[FPB_TRAMPOLINE_COUNT];
+
+static uint32_t fpb_trampoline_exit_address(uint32_t comp) {
+#if defined(FPB_HOST_TESTING) || !defined(FPB_TRAMPOLINE_NO_ASM)
+    return (uint32_t)fpb_trampoline_exit_table[comp] | 1; /* Add Thumb bit */
+#else
+    (void)comp;
+    return 1; /* C trampolines call the exit hook themselves */
+#endif
+}
+
+uint64_t fpb_trampoline_stats_enter(uint32_t comp, uint32_t lr) {
+    uint32_t target = fpb_trampoline_targets[comp];
+    if (target == 0) {
+        return (uint64_t)lr << 32;
+    }
+
+    fpb_trampoline_slot_stats_t* s = &fpb_trampoline_stats[comp];
+    __atomic_fetch_add(&s->stats.calls, 1, __ATOMIC_RELAXED);
+
+    /* Nested or concurrent call of the same slot: count only */
+    if (__atomic_exchange_n(&s->busy, 1, __ATOMIC_ACQUIRE)) {
+        return ((uint64_t)lr << 32) | target;
+    }
+
+    s->lr = lr;
+    s->start = DWT_CYCCNT;
+    return ((uint64_t)fpb_trampoline_exit_address(comp) << 32) | target;
+}
+
+uint32_t fpb_trampoline_stats_exit(uint32_t comp) {
+    fpb_trampoline_slot_stats_t* s = &fpb_trampoline_stats[comp];
+    uint32_t cycles = DWT_CYCCNT - s->start;
+    uint32_t lr = s->lr;
+
+    s->stats.timed++;
+    s->stats.cycles += cycles;
+    if (cycles > s->stats.max) {
+        s->stats.max = cycles;
+    }
+
+    __atomic_store_n(&s->busy, 0, __ATOMIC_RELEASE);
+    return lr;
+}
+
+bool fpb_trampoline_get_stats(uint32_t comp, fpb_trampoline_stats_t* stats) {
+    if (comp >= FPB_TRAMPOLINE_COUNT || !stats) {
+        return false;
+    }
+    *stats = fpb_trampoline_stats[comp].stats;
+    return true;
+}
+
+void fpb_trampoline_reset_stats(uint32_t comp) {
+    if (comp < FPB_TRAMPOLINE_COUNT) {
+        fpb_trampoline_stats_t* stats = &fpb_trampoline_stats[comp].stats;
+        stats->calls = 0;
+        stats->timed = 0;
+        stats->cycles = 0;
+        stats->max = 0;
+    }
+}
+
+#endif /* FPB_TRAMPOLINE_STATS */
+
 void fpb_trampoline_set_target(uint32_t comp, uint32_t target) {
     if (comp < FPB_TRAMPOLINE_COUNT) {
+#ifdef FPB_TRAMPOLINE_STATS
+        /* A new target starts from zero; make sure the cycle counter runs */
+        fpb_trampoline_reset_stats(comp);
+        DEMCR |= DEMCR_TRCENA;
+        DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#endif
         fpb_trampoline_targets[comp] = target;
     }
 }
@@ -28,11 +28,13 @@
  * Configuration macros:
  *   FPB_NO_TRAMPOLINE    - Disable trampoline (for cores that can REMAP to RAM)
  *   FPB_TRAMPOLINE_NO_ASM - Use C instead of assembly (no argument preservation)
+ *   FPB_TRAMPOLINE_STATS - Count calls and DWT cycles per trampoline
  */
 
 #ifndef __FPB_TRAMPOLINE_H
 #define __FPB_TRAMPOLINE_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -63,6 +65,52 @@ void fpb_trampoline_clear_target(uint32_t comp);
  */
 uint32_t fpb_trampoline_get_address(uint32_t comp);
 
+#ifdef FPB_TRAMPOLINE_STATS
+
+/**
+ * Per-trampoline counters. A call is timed from trampoline entry to the
+ * target's return, measured with DWT_CYCCNT. Only one call per slot is timed
+ * at a time; nested, concurrent or never-returning calls are only counted.
+ */
+typedef struct {
+    uint32_t calls;  /* Calls forwarded to the target */
+    uint32_t timed;  /* Calls whose duration was measured */
+    uint64_t cycles; /* Sum of timed call durations */
+    uint32_t max;    /* Longest timed call */
+} fpb_trampoline_stats_t;
+
+/**
+ * @brief  Snapshot the counters of a trampoline (reset by set_target)
+ * @param  comp: Comparator index (0-7)
+ * @param  stats: Output counters
+ * @return false if comp is out of range
+ */
+bool fpb_trampoline_get_stats(uint32_t comp, fpb_trampoline_stats_t* stats);
+
+/**
+ * @brief  Zero the counters of a trampoline
+ * @param  comp: Comparator index (0-7)
+ */
+void fpb_trampoline_reset_stats(uint32_t comp);
+
+/**
+ * @brief  Trampoline entry hook (called by the instrumented trampolines)
+ * @param  comp: Comparator index
+ * @param  lr: Caller return address
+ * @return Target in the low word (0 = none), return address for the target
+ *         in the high word: the exit shim when the call is timed, else lr
+ */
+uint64_t fpb_trampoline_stats_enter(uint32_t comp, uint32_t lr);
+
+/**
+ * @brief  Exit shim hook: account a timed call
+ * @param  comp: Comparator index
+ * @return Caller return address saved by fpb_trampoline_stats_enter()
+ */
+uint32_t fpb_trampoline_stats_exit(uint32_t comp);
+
+#endif /* FPB_TRAMPOLINE_STATS */
+
 #else /* FPB_NO_TRAMPOLINE */
 
 /* Stub functions when trampoline is disabled */
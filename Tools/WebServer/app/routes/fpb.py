@@ -18,6 +18,7 @@ import threading
 from flask import Blueprint, jsonify, request
 
 from app.utils.sse import sse_response
+from core.profile import FunctionIndex, flat_profile
 from core.state import state
 from services.device_worker import run_in_device_worker
 
@@ -303,6 +304,119 @@ def api_fpb_enable():
         return jsonify({"success": False, "message": str(e)})
 
 
+# FunctionIndex of the loaded symbol table, rebuilt when state.symbols changes
+_prof_index = (None, None)
+
+
+def _prof_function_index():
+    """Function index over the nm symbols (loaded on first use)."""
+    global _prof_index
+    from app.routes.symbols import _ensure_symbols_loaded
+
+    _ensure_symbols_loaded()
+    symbols = state.symbols or {}
+    if _prof_index[0] is not symbols:
+        _prof_index = (symbols, FunctionIndex(symbols))
+    return _prof_index[1]
+
+
+def _prof_patch_regions(index):
+    """(start, size, name) of injected code, which the ELF does not describe."""
+    info = state.device.device_info or {}
+    regions = []
+    for slot in info.get("slots", []):
+        if not slot.get("occupied") or not slot.get("code_size"):
+            continue
+        func = index.lookup(slot["orig_addr"] & ~1)
+        name = func[0] if func else f"0x{slot['orig_addr']:08X}"
+        regions.append(
+            (slot["target_addr"] & ~1, slot["code_size"], f"{name} [patch]")
+        )
+    return regions
+
+
+@bp.route("/fpb/prof/start", methods=["POST"])
+def api_fpb_prof_start():
+    """Clear the device profile and start PC sampling.
+
+    JSON body: hz (optional, 0 = device default rate).
+    """
+    _, _, _, _, get_fpb_inject, _ = _get_helpers()
+    data = request.json or {}
+    try:
+        hz = int(data.get("hz", 0))
+    except (TypeError, ValueError):
+        return jsonify({"success": False, "error": "Invalid hz"})
+
+    fpb = get_fpb_inject()
+    result = _run_serial_op(lambda: fpb.prof_start(hz), timeout=5.0)
+    if isinstance(result, dict) and result.get("error"):
+        return jsonify({"success": False, "error": result["error"]})
+    info, msg = result
+    if info is None:
+        return jsonify({"success": False, "error": msg})
+    return jsonify({"success": True, **info})
+
+
+@bp.route("/fpb/prof/stop", methods=["POST"])
+def api_fpb_prof_stop():
+    """Stop PC sampling; the profile stays on the device until the next start."""
+    _, _, _, _, get_fpb_inject, _ = _get_helpers()
+    fpb = get_fpb_inject()
+    result = _run_serial_op(fpb.prof_stop, timeout=5.0)
+    if isinstance(result, dict) and result.get("error"):
+        return jsonify({"success": False, "error": result["error"]})
+    samples, msg = result
+    if samples is None:
+        return jsonify({"success": False, "error": msg})
+    return jsonify({"success": True, "samples": samples})
+
+
+@bp.route("/fpb/prof", methods=["GET"])
+def api_fpb_prof():
+    """Read the device PC histogram as a flat profile by function.
+
+    Query: limit (functions returned, default 50, 0 = all).
+    """
+    _, _, _, _, get_fpb_inject, _ = _get_helpers()
+    try:
+        limit = int(request.args.get("limit", 50))
+    except ValueError:
+        limit = 50
+
+    fpb = get_fpb_inject()
+    result = _run_serial_op(fpb.prof_dump, timeout=10.0)
+    if isinstance(result, dict) and result.get("error"):
+        return jsonify({"success": False, "error": result["error"]})
+    dump, msg = result
+    if dump is None:
+        return jsonify({"success": False, "error": msg})
+
+    index = _prof_function_index()
+    profile = flat_profile(dump, index, _prof_patch_regions(index))
+    functions = profile["functions"][:limit] if limit else profile["functions"]
+    return jsonify(
+        {
+            "success": True,
+            "running": profile["running"],
+            "hz": profile["hz"],
+            "samples": profile["samples"],
+            "overflow": profile["overflow"],
+            "total_functions": len(profile["functions"]),
+            "functions": [
+                {
+                    "name": f["name"],
+                    "addr": f"0x{f['addr']:08X}",
+                    "samples": f["samples"],
+                    "percent": round(f["percent"], 2),
+                    "pcs": [[f"0x{pc:08X}", n] for pc, n in f["pcs"]],
+                }
+                for f in functions
+            ],
+        }
+    )
+
+
 @bp.route("/fpb/inject", methods=["POST"])
 def api_fpb_inject():
     """Perform code injection."""
@@ -11,9 +11,12 @@ pointer dereference, and watch list management.
 """
 
 import logging
+import queue
 
 from flask import Blueprint, jsonify, request
 
+from app.utils.sse import sse_response
+from core.sample_stream import SAMPLE_MAX_PROBES, SAMPLE_PROBE_SIZE, SampleSession
 from core.state import state
 from core.watch_evaluator import WatchEvaluator
 
@@ -25,6 +28,9 @@ bp = Blueprint("watch_expr", __name__)
 _watch_list = []
 _watch_next_id = 1
 
+# Running device sampler feeding /watch_expr/sample/stream
+_sample_session = None
+
 
 def _get_evaluator():
     """Create a WatchEvaluator if GDB is available."""
@@ -50,6 +56,44 @@ def _read_device_memory(addr, size):
     return raw_data.hex(), None
 
 
+def _read_device_ranges(ranges):
+    """Read several (addr, size) ranges in one coalesced pass.
+
+    Returns (list of hex strings, None) or (None, error).
+    """
+    from app.routes.symbols import _dynamic_timeout, _get_fpb_inject, _run_serial_op
+
+    fpb = _get_fpb_inject()
+    timeout = _dynamic_timeout(sum(size for _, size in ranges))
+    result = _run_serial_op(lambda: fpb.read_memory_multi(ranges), timeout=timeout)
+    if isinstance(result, dict) and "error" in result:
+        return None, result["error"]
+    chunks, msg = result
+    if chunks is None:
+        return None, msg
+    return [c.hex() for c in chunks], None
+
+
+def _evaluate_expr(evaluator, expr):
+    """Evaluate one expression into an evaluate response (without device data)."""
+    result = evaluator.evaluate(expr)
+    if result.get("error"):
+        return {"success": False, "expr": expr, "error": result["error"]}
+
+    return {
+        "success": True,
+        "expr": expr,
+        "addr": f"0x{result['addr']:08X}",
+        "size": result["size"],
+        "type_name": result["type_name"],
+        "is_pointer": result["is_pointer"],
+        "is_aggregate": result["is_aggregate"],
+        "struct_layout": result.get("struct_layout"),
+        "hex_data": None,
+        "source": None,
+    }
+
+
 @bp.route("/watch_expr/evaluate", methods=["POST"])
 def api_watch_evaluate():
     """Evaluate a watch expression.
@@ -71,25 +115,12 @@ def api_watch_evaluate():
     if evaluator is None:
         return jsonify({"success": False, "error": "GDB not available"})
 
-    result = evaluator.evaluate(expr)
-    if result.get("error"):
-        return jsonify({"success": False, "error": result["error"]})
+    response = _evaluate_expr(evaluator, expr)
+    if not response["success"]:
+        return jsonify({"success": False, "error": response["error"]})
 
-    response = {
-        "success": True,
-        "expr": expr,
-        "addr": f"0x{result['addr']:08X}",
-        "size": result["size"],
-        "type_name": result["type_name"],
-        "is_pointer": result["is_pointer"],
-        "is_aggregate": result["is_aggregate"],
-        "struct_layout": result.get("struct_layout"),
-        "hex_data": None,
-        "source": None,
-    }
-
-    if read_device and result["size"] > 0:
-        hex_data, err = _read_device_memory(result["addr"], result["size"])
+    if read_device and response["size"] > 0:
+        hex_data, err = _read_device_memory(int(response["addr"], 16), response["size"])
         if hex_data:
             response["hex_data"] = hex_data
             response["source"] = "device"
@@ -99,6 +130,49 @@ def api_watch_evaluate():
     return jsonify(response)
 
 
+@bp.route("/watch_expr/evaluate_batch", methods=["POST"])
+def api_watch_evaluate_batch():
+    """Evaluate several watch expressions, reading their memory in one pass.
+
+    JSON body:
+        exprs: list of C/C++ expression strings
+        read_device: bool (default true) - whether to read device memory
+
+    Returns results in request order, each shaped like /watch_expr/evaluate.
+    The device reads are coalesced (readv), so refreshing a watch list costs
+    one round trip instead of one per expression.
+    """
+    data = request.get_json() or {}
+    exprs = [str(e).strip() for e in data.get("exprs", [])]
+    read_device = data.get("read_device", True)
+
+    evaluator = _get_evaluator()
+    if evaluator is None:
+        return jsonify({"success": False, "error": "GDB not available"})
+
+    results = []
+    for expr in exprs:
+        if not expr:
+            results.append(
+                {"success": False, "expr": expr, "error": "Expression is empty"}
+            )
+            continue
+        results.append(_evaluate_expr(evaluator, expr))
+
+    readable = [r for r in results if r["success"] and r["size"] > 0]
+    if read_device and readable:
+        ranges = [(int(r["addr"], 16), r["size"]) for r in readable]
+        hex_list, err = _read_device_ranges(ranges)
+        for i, r in enumerate(readable):
+            if hex_list:
+                r["hex_data"] = hex_list[i]
+                r["source"] = "device"
+            else:
+                r["read_error"] = err
+
+    return jsonify({"success": True, "results": results})
+
+
 @bp.route("/watch_expr/deref", methods=["POST"])
 def api_watch_deref():
     """Dereference a pointer: read pointer value from device, resolve target type.
@@ -165,6 +239,154 @@ def api_watch_deref():
     )
 
 
+def _stop_sampler():
+    """Stop the device sampler and end its streams. Returns (stats, error)."""
+    global _sample_session
+    from app.routes.symbols import _get_fpb_inject, _run_serial_op
+
+    session = _sample_session
+    if session is None:
+        return None, "Sampler not running"
+    _sample_session = None
+
+    fpb = _get_fpb_inject()
+
+    def stop():
+        state.device.worker.set_sample_sink(None)
+        return fpb.sample_stop()
+
+    result = _run_serial_op(stop, timeout=5.0)
+    session.close()
+    if isinstance(result, dict) and "error" in result:
+        return None, result["error"]
+    info, msg = result
+    if info is None:
+        return None, msg
+    info.update(session.stats())
+    return info, None
+
+
+@bp.route("/watch_expr/sample/start", methods=["POST"])
+def api_watch_sample_start():
+    """Stream watch values from the device sampler instead of polling.
+
+    JSON body:
+        exprs: list of C/C++ expression strings
+        period_us: sample period in microseconds (default 1000,
+                   0 = every device loop pass)
+
+    Expressions of 1..8 bytes become probes (at most 8, in order); the others
+    are returned in "skipped". Values then arrive on /watch_expr/sample/stream.
+    """
+    global _sample_session
+    from app.routes.symbols import _get_fpb_inject, _run_serial_op
+
+    data = request.get_json() or {}
+    exprs = [str(e).strip() for e in data.get("exprs", [])]
+    try:
+        period_us = max(0, int(data.get("period_us", 1000)))
+    except (TypeError, ValueError):
+        return jsonify({"success": False, "error": "Invalid period_us"})
+
+    evaluator = _get_evaluator()
+    if evaluator is None:
+        return jsonify({"success": False, "error": "GDB not available"})
+
+    probes = []
+    skipped = []
+    for expr in exprs:
+        result = _evaluate_expr(evaluator, expr) if expr else None
+        if result is None or not result["success"]:
+            error = result["error"] if result else "Expression is empty"
+            skipped.append({"expr": expr, "error": error})
+        elif not 0 < result["size"] <= SAMPLE_PROBE_SIZE:
+            skipped.append({"expr": expr, "error": "Too large to sample"})
+        elif len(probes) >= SAMPLE_MAX_PROBES:
+            skipped.append({"expr": expr, "error": "Too many probes"})
+        else:
+            probes.append(
+                {
+                    "expr": expr,
+                    "addr": int(result["addr"], 16),
+                    "size": result["size"],
+                    "type_name": result["type_name"],
+                }
+            )
+    if not probes:
+        return jsonify({"success": False, "error": "No sampleable expressions"})
+
+    fpb = _get_fpb_inject()
+    if not fpb.sample_supported():
+        return jsonify({"success": False, "error": "Device has no sampler"})
+
+    if _sample_session is not None:
+        _stop_sampler()
+
+    session = SampleSession(probes)
+
+    def start():
+        info, msg = fpb.sample_start(
+            [(p["addr"], p["size"]) for p in probes], period_us
+        )
+        if info is not None:
+            session.decoder.hz = info["hz"]
+            state.device.worker.set_sample_sink(session.on_payload)
+        return info, msg
+
+    result = _run_serial_op(start, timeout=5.0 + len(probes))
+    if isinstance(result, dict) and "error" in result:
+        return jsonify({"success": False, "error": result["error"]})
+    info, msg = result
+    if info is None:
+        return jsonify({"success": False, "error": msg})
+    _sample_session = session
+
+    return jsonify(
+        {
+            "success": True,
+            "probes": [
+                {**p, "index": i, "addr": f"0x{p['addr']:08X}"}
+                for i, p in enumerate(probes)
+            ],
+            "skipped": skipped,
+            "period": info["period"],
+            "hz": info["hz"],
+        }
+    )
+
+
+@bp.route("/watch_expr/sample/stream", methods=["GET"])
+def api_watch_sample_stream():
+    """SSE stream of sampler values.
+
+    Events: {"type": "samples", "lost", "samples": [{seq, ts, time,
+    values: {probe index: hex}}]}; the stream ends when the sampler stops.
+    """
+    session = _sample_session
+    if session is None:
+        q = queue.Queue()
+        q.put({"type": "result", "success": False, "error": "Sampler not running"})
+        q.put(None)
+        return sse_response(q)
+
+    q = session.subscribe()
+    return sse_response(
+        q,
+        on_close=lambda: session.unsubscribe(q),
+        poll_interval=2.0,
+        inactivity_timeout=float("inf"),
+    )
+
+
+@bp.route("/watch_expr/sample/stop", methods=["POST"])
+def api_watch_sample_stop():
+    """Stop the device sampler."""
+    info, err = _stop_sampler()
+    if info is None:
+        return jsonify({"success": False, "error": err})
+    return jsonify({"success": True, **info})
+
+
 @bp.route("/watch_expr/list", methods=["GET"])
 def api_watch_list():
     """Get all watch expressions."""
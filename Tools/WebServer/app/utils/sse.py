@@ -68,13 +68,23 @@ def sse_generator(
             yield f"data: {json.dumps({'type': 'heartbeat'})}\n\n"
 
 
-def sse_response(progress_queue, **kwargs):
+def sse_response(progress_queue, on_close=None, **kwargs):
     """Build a Flask :class:`Response` wrapping :func:`sse_generator`.
 
     Accepts the same keyword arguments as :func:`sse_generator`.
+    *on_close* is called once the stream ends, including when the client
+    disconnects.
     """
+
+    def stream():
+        try:
+            yield from sse_generator(progress_queue, **kwargs)
+        finally:
+            if on_close is not None:
+                on_close()
+
     return Response(
-        sse_generator(progress_queue, **kwargs),
+        stream(),
         mimetype="text/event-stream",
         headers=_SSE_HEADERS,
     )
@@ -11,6 +11,7 @@ Usage:
   fpb_cli.py compile <source_file> [--output <out>]
   fpb_cli.py inject <elf_path> <comp_num> <source_file> [--verify]
   fpb_cli.py unpatch <elf_path> <comp_num>
+  fpb_cli.py ipatch <addr> <insn> [--comp <n>]
   fpb_cli.py --version
   fpb_cli.py --help
 
@@ -22,12 +23,16 @@ import json
 import logging
 import os
 import sys
+import time
 from pathlib import Path
-from typing import Any, Dict, Optional
+from typing import Any, Dict, Optional, Tuple
 
 # Import from existing WebServer modules
 sys.path.insert(0, str(Path(__file__).parent))
+from core.profile import FunctionIndex, flat_profile, format_flat_profile  # noqa: E402
 from fpb_inject import FPBInject  # noqa: E402
+from utils import lz  # noqa: E402
+from utils.crc import crc32  # noqa: E402
 
 try:
     import serial
@@ -57,6 +62,7 @@ class DeviceState:
         self.cached_slots = None  # Cache for slot state
         self.slot_update_id = 0
         self.upload_chunk_size = 128  # Default chunk size for upload
+        self.upload_window = 4  # Upload chunks in flight (1 = stop-and-wait)
         self.download_chunk_size = 1024  # Default chunk size for download
         self.serial_tx_fragment_size = 0  # 0 = disabled, >0 = fragment size for TX
         self.serial_tx_fragment_delay = 0.002  # Delay between TX fragments (seconds)
@@ -451,6 +457,32 @@ class FPBCLI:
         except Exception as e:
             self.output_error(f"Unpatch failed: {str(e)}", e)
 
+    def ipatch(
+        self, addr: int, insn: str, comp: int = -1, force: bool = False
+    ) -> None:
+        """Replace one instruction in Flash through the FPB remap table.
+
+        insn is objdump-style hex or one line of assembly (assembled at addr).
+        """
+        try:
+            if not self._device_state.connected:
+                raise FPBCLIError(
+                    "No device connected. Use --port to specify serial port."
+                )
+
+            self._fpb.enter_fl_mode()
+            try:
+                success, msg = self._fpb.ipatch(addr, insn, comp=comp, force=force)
+            finally:
+                self._fpb.exit_fl_mode()
+
+            self.output_json(
+                {"success": success, "message": msg, "addr": f"0x{addr:08X}"}
+            )
+
+        except Exception as e:
+            self.output_error(f"Instruction patch failed: {str(e)}", e)
+
     def info(self) -> None:
         """Get device FPB info"""
         try:
@@ -681,8 +713,95 @@ class FPBCLI:
         except Exception as e:
             self.output_error(f"Memory write failed: {str(e)}", e)
 
-    def mem_dump(self, addr: int, length: int, output_file: str) -> None:
-        """Dump memory region to binary file"""
+    def _mem_op(self, op, *args):
+        """Run one on-device memory command inside fl mode."""
+        if not self._device_state.connected:
+            raise FPBCLIError("No device connected. Use --port to specify serial port.")
+
+        self._fpb.enter_fl_mode()
+        try:
+            return op(*args)
+        finally:
+            self._fpb.exit_fl_mode()
+
+    def mem_set(self, addr: int, length: int, value: int = 0) -> None:
+        """Fill a device memory region with a byte value"""
+        try:
+            success, msg = self._mem_op(self._fpb.mem_set, addr, length, value)
+            if not success:
+                raise FPBCLIError(f"Memory set failed: {msg}")
+
+            self.output_json(
+                {
+                    "success": True,
+                    "addr": f"0x{addr:08X}",
+                    "length": length,
+                    "value": f"0x{value & 0xFF:02X}",
+                    "message": f"Filled {length} bytes at 0x{addr:08X}",
+                }
+            )
+
+        except Exception as e:
+            self.output_error(f"Memory set failed: {str(e)}", e)
+
+    def mem_copy(self, src: int, dst: int, length: int) -> None:
+        """Copy a device memory region on the device"""
+        try:
+            success, msg = self._mem_op(self._fpb.mem_copy, src, dst, length)
+            if not success:
+                raise FPBCLIError(f"Memory copy failed: {msg}")
+
+            self.output_json(
+                {
+                    "success": True,
+                    "src": f"0x{src:08X}",
+                    "dst": f"0x{dst:08X}",
+                    "length": length,
+                    "message": f"Copied {length} bytes to 0x{dst:08X}",
+                }
+            )
+
+        except Exception as e:
+            self.output_error(f"Memory copy failed: {str(e)}", e)
+
+    def mem_find(self, addr: int, length: int, pattern_hex: str) -> None:
+        """Find a byte pattern in a device memory region"""
+        try:
+            try:
+                pattern = bytes.fromhex(pattern_hex)
+            except ValueError:
+                raise FPBCLIError(f"Invalid hex pattern: '{pattern_hex}'.")
+            if not pattern:
+                raise FPBCLIError("Empty pattern")
+
+            found, msg = self._mem_op(self._fpb.mem_find, addr, length, pattern)
+            if found is None and "not found" not in msg:
+                raise FPBCLIError(f"Memory find failed: {msg}")
+
+            self.output_json(
+                {
+                    "success": True,
+                    "found": found is not None,
+                    "addr": f"0x{found:08X}" if found is not None else None,
+                    "message": (
+                        f"Pattern found at 0x{found:08X}"
+                        if found is not None
+                        else "Pattern not found"
+                    ),
+                }
+            )
+
+        except Exception as e:
+            self.output_error(f"Memory find failed: {str(e)}", e)
+
+    def prof(
+        self, action: str, hz: int = 0, duration: float = 0.0, limit: int = 20
+    ) -> None:
+        """Control the device PC-sampling profiler and print a flat profile.
+
+        start clears the profile; with duration it samples that long, then
+        stops and dumps. dump maps PCs to functions with the ELF symbols.
+        """
         try:
             if not self._device_state.connected:
                 raise FPBCLIError(
@@ -691,12 +810,200 @@ class FPBCLI:
 
             self._fpb.enter_fl_mode()
             try:
-                data, msg = self._fpb.read_memory(addr, length)
+                if action == "start":
+                    info, msg = self._fpb.prof_start(hz)
+                    if info is None:
+                        raise FPBCLIError(f"Profiler start failed: {msg}")
+                    if not duration:
+                        self.output_json(
+                            {
+                                "success": True,
+                                "hz": info["hz"],
+                                "message": f"Profiling at {info['hz']} Hz",
+                            }
+                        )
+                        return
+                    time.sleep(duration)
+                    action = "stop"
+                if action == "stop":
+                    samples, msg = self._fpb.prof_stop()
+                    if samples is None:
+                        raise FPBCLIError(f"Profiler stop failed: {msg}")
+                    if not duration:
+                        self.output_json(
+                            {
+                                "success": True,
+                                "samples": samples,
+                                "message": f"Profiler stopped, {samples} samples",
+                            }
+                        )
+                        return
+                dump, msg = self._fpb.prof_dump()
+                if dump is None:
+                    raise FPBCLIError(f"Profiler dump failed: {msg}")
+            finally:
+                self._fpb.exit_fl_mode()
+
+            symbols = {}
+            elf_path = self._device_state.elf_path
+            if elf_path and os.path.exists(elf_path):
+                symbols = self._fpb.get_symbols(elf_path)
+            profile = flat_profile(dump, FunctionIndex(symbols))
+            functions = profile["functions"][:limit] if limit else profile["functions"]
+            self.output_json(
+                {
+                    "success": True,
+                    "running": profile["running"],
+                    "hz": profile["hz"],
+                    "samples": profile["samples"],
+                    "overflow": profile["overflow"],
+                    "functions": [
+                        {
+                            "name": f["name"],
+                            "addr": f"0x{f['addr']:08X}",
+                            "samples": f["samples"],
+                            "percent": round(f["percent"], 2),
+                        }
+                        for f in functions
+                    ],
+                    "table": format_flat_profile(profile, limit),
+                }
+            )
+
+        except Exception as e:
+            self.output_error(f"Profiler failed: {str(e)}", e)
+
+    def slotstats(self, reset: bool = False) -> None:
+        """Print the call and cycle counters of the device trampolines.
+
+        Needs firmware built with FPB_TRAMPOLINE_STATS. Cycles are core clocks
+        from trampoline entry to return; reset zeroes every slot.
+        """
+        try:
+            if not self._device_state.connected:
+                raise FPBCLIError(
+                    "No device connected. Use --port to specify serial port."
+                )
+
+            self._fpb.enter_fl_mode()
+            try:
+                if reset:
+                    ok, msg = self._fpb.slot_stats_reset()
+                    if not ok:
+                        raise FPBCLIError(f"Reset failed: {msg}")
+                    self.output_json(
+                        {"success": True, "message": "Slot counters reset"}
+                    )
+                    return
+                stats, msg = self._fpb.slot_stats()
+                if stats is None:
+                    raise FPBCLIError(msg)
             finally:
                 self._fpb.exit_fl_mode()
 
+            self.output_json(
+                {
+                    "success": True,
+                    "slots": [
+                        {"slot": slot, **counters}
+                        for slot, counters in sorted(stats.items())
+                    ],
+                }
+            )
+
+        except Exception as e:
+            self.output_error(f"Slot stats failed: {str(e)}", e)
+
+    def _dump_on_device(
+        self, addr: int, length: int, device_path: str, fetch: bool
+    ) -> Tuple[Optional[bytes], dict]:
+        """Snapshot memory to a device file with "dump", then optionally fetch it.
+
+        Returns (data or None if not fetched, dump info). The fetched data is
+        inflated and checked against the CRC-32 taken at snapshot time.
+        """
+        if not self._fpb.dump_supported():
+            raise FPBCLIError("Device cannot dump to a file (no filesystem)")
+        info, msg = self._fpb.dump_memory(addr, length, device_path)
+        if info is None:
+            raise FPBCLIError(f"Memory dump failed: {msg}")
+        if not fetch:
+            return None, info
+
+        from core.file_transfer import FileTransfer
+
+        ft = FileTransfer(
+            self._fpb,
+            upload_chunk_size=self._device_state.upload_chunk_size,
+            download_chunk_size=self._device_state.download_chunk_size,
+            max_retries=self._device_state.transfer_max_retries,
+        )
+        success, data, msg = ft.download(device_path)
+        if not success:
+            raise FPBCLIError(f"Dump download failed: {msg}")
+        if info["compressed"]:
+            data = lz.unpack_dump(data)
+        if len(data) != length or crc32(data) != info["crc"]:
+            raise FPBCLIError(
+                f"Memory dump verify failed: CRC mismatch in {device_path}"
+            )
+        return data, info
+
+    def mem_dump(
+        self,
+        addr: int,
+        length: int,
+        output_file: Optional[str],
+        device_path: Optional[str] = None,
+        fetch: bool = True,
+    ) -> None:
+        """Dump memory region to binary file.
+
+        With device_path the range is first saved to that file on the device
+        (fast, does not hold the link); fetch=False leaves it there.
+        """
+        try:
+            if not self._device_state.connected:
+                raise FPBCLIError(
+                    "No device connected. Use --port to specify serial port."
+                )
+            if output_file is None and (fetch or not device_path):
+                raise FPBCLIError("Output file required")
+
+            self._fpb.enter_fl_mode()
+            try:
+                if device_path:
+                    data, info = self._dump_on_device(
+                        addr, length, device_path, fetch
+                    )
+                    verified = data is not None
+                else:
+                    data, msg = self._fpb.read_memory(addr, length)
+                    verified = None
+                    if data is not None:
+                        # One device-side CRC covers the whole dump end to end
+                        verified, vmsg = self._fpb.verify_memory(addr, data)
+            finally:
+                self._fpb.exit_fl_mode()
+
+            if device_path and data is None:
+                self.output_json(
+                    {
+                        "success": True,
+                        "addr": f"0x{addr:08X}",
+                        "length": length,
+                        "device_path": device_path,
+                        "device_size": info["size"],
+                        "crc": f"0x{info['crc']:08X}",
+                        "compressed": info["compressed"],
+                        "message": f"Dumped {length} bytes to {device_path} on device",
+                    }
+                )
+                return
             if data is None:
                 raise FPBCLIError(f"Memory read failed: {msg}")
+            if verified is False:
+                raise FPBCLIError(f"Memory dump verify failed: {vmsg}")
 
             out_dir = os.path.dirname(output_file)
             if out_dir:
@@ -711,6 +1018,7 @@ class FPBCLI:
                     "addr": f"0x{addr:08X}",
                     "length": len(data),
                     "output_file": output_file,
+                    "verified": bool(verified),
                     "message": f"Dumped {len(data)} bytes to {output_file}",
                 }
             )
@@ -897,6 +1205,23 @@ Examples:
     )
     unpatch_parser.add_argument("--all", action="store_true", help="Remove all patches")
 
+    # ipatch command (requires device)
+    ipatch_parser = subparsers.add_parser(
+        "ipatch", help="Replace one instruction in place (requires --port)"
+    )
+    ipatch_parser.add_argument(
+        "addr", type=lambda x: int(x, 0), help="Instruction address (hex)"
+    )
+    ipatch_parser.add_argument(
+        "insn", help='Replacement: objdump hex ("f1b0 0f01") or assembly ("cmp r0, #2")'
+    )
+    ipatch_parser.add_argument(
+        "--comp", type=int, default=-1, help="FPB comparator slot (-1 for auto)"
+    )
+    ipatch_parser.add_argument(
+        "--force", action="store_true", help="Allow a width change"
+    )
+
     # mem-read command (requires device)
     memread_parser = subparsers.add_parser(
         "mem-read", help="Read memory from device (requires --port)"
@@ -935,7 +1260,82 @@ Examples:
     memdump_parser.add_argument(
         "length", type=lambda x: int(x, 0), help="Number of bytes to dump"
     )
-    memdump_parser.add_argument("output", help="Output binary file path")
+    memdump_parser.add_argument("output", nargs="?", help="Output binary file path")
+    memdump_parser.add_argument(
+        "--device-path",
+        help="Snapshot to this file on the device first (needs a filesystem)",
+    )
+    memdump_parser.add_argument(
+        "--no-fetch",
+        action="store_true",
+        help="Leave the --device-path snapshot on the device",
+    )
+
+    # mem-set command (requires device)
+    memset_parser = subparsers.add_parser(
+        "mem-set", help="Fill memory on the device (requires --port)"
+    )
+    memset_parser.add_argument(
+        "addr", type=lambda x: int(x, 0), help="Start address (hex: 0x20000000)"
+    )
+    memset_parser.add_argument(
+        "length", type=lambda x: int(x, 0), help="Number of bytes to fill"
+    )
+    memset_parser.add_argument(
+        "value", type=lambda x: int(x, 0), nargs="?", default=0, help="Fill byte"
+    )
+
+    # mem-copy command (requires device)
+    memcopy_parser = subparsers.add_parser(
+        "mem-copy", help="Copy memory on the device (requires --port)"
+    )
+    memcopy_parser.add_argument(
+        "src", type=lambda x: int(x, 0), help="Source address (hex: 0x20000000)"
+    )
+    memcopy_parser.add_argument(
+        "dst", type=lambda x: int(x, 0), help="Destination address"
+    )
+    memcopy_parser.add_argument(
+        "length", type=lambda x: int(x, 0), help="Number of bytes to copy"
+    )
+
+    # mem-find command (requires device)
+    memfind_parser = subparsers.add_parser(
+        "mem-find", help="Search memory for a byte pattern (requires --port)"
+    )
+    memfind_parser.add_argument(
+        "addr", type=lambda x: int(x, 0), help="Start address (hex: 0x20000000)"
+    )
+    memfind_parser.add_argument(
+        "length", type=lambda x: int(x, 0), help="Number of bytes to search"
+    )
+    memfind_parser.add_argument("pattern", help="Hex bytes to find (e.g., EFBEADDE)")
+
+    # prof command (requires device)
+    prof_parser = subparsers.add_parser(
+        "prof", help="PC-sampling profiler: start, stop, dump (requires --port)"
+    )
+    prof_parser.add_argument("action", choices=["start", "stop", "dump"])
+    prof_parser.add_argument(
+        "--hz", type=int, default=0, help="Sample rate (default: device default)"
+    )
+    prof_parser.add_argument(
+        "--duration",
+        type=float,
+        default=0.0,
+        help="With start: sample this many seconds, then stop and dump",
+    )
+    prof_parser.add_argument(
+        "--limit", type=int, default=20, help="Functions to list (0 = all)"
+    )
+
+    # slotstats command (requires device)
+    slotstats_parser = subparsers.add_parser(
+        "slotstats", help="Trampoline call and cycle counters (requires --port)"
+    )
+    slotstats_parser.add_argument(
+        "--reset", action="store_true", help="Zero the counters of every slot"
+    )
 
     args = parser.parse_args()
 
@@ -989,6 +1389,8 @@ Examples:
                 args.comp,
                 args.verify,
             )
+        elif args.command == "ipatch":
+            cli.ipatch(args.addr, args.insn, args.comp, args.force)
         elif args.command == "unpatch":
             cli.unpatch(args.comp, args.all)
         elif args.command == "mem-read":
@@ -996,7 +1398,23 @@ Examples:
         elif args.command == "mem-write":
             cli.mem_write(args.addr, args.data)
         elif args.command == "mem-dump":
-            cli.mem_dump(args.addr, args.length, args.output)
+            cli.mem_dump(
+                args.addr,
+                args.length,
+                args.output,
+                args.device_path,
+                not args.no_fetch,
+            )
+        elif args.command == "mem-set":
+            cli.mem_set(args.addr, args.length, args.value)
+        elif args.command == "mem-copy":
+            cli.mem_copy(args.src, args.dst, args.length)
+        elif args.command == "mem-find":
+            cli.mem_find(args.addr, args.length, args.pattern)
+        elif args.command == "prof":
+            cli.prof(args.action, args.hz, args.duration, args.limit)
+        elif args.command == "slotstats":
+            cli.slotstats(args.reset)
     except FPBCLIError as e:
         cli.output_error(str(e))
         sys.exit(1)
@@ -251,6 +251,20 @@ CONFIG_SCHEMA: List[ConfigItem] = [
         unit="Bytes",
         order=15,
     ),
+    ConfigItem(
+        key="upload_window",
+        label="Upload Window",
+        group=ConfigGroup.TRANSFER,
+        config_type=ConfigType.NUMBER,
+        default=4,
+        tooltip="Upload chunks kept in flight before waiting for acks. "
+        "1 = stop-and-wait. Reduced automatically when chunks are lost.",
+        min_value=1,
+        max_value=16,
+        step=1,
+        unit="chunks",
+        order=17,
+    ),
     ConfigItem(
         key="serial_tx_fragment_size",
         label="TX Fragment",
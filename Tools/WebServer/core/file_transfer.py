@@ -15,7 +15,9 @@ import logging
 import re
 from typing import Callable, Optional, Tuple, List, Dict, Any
 
-from utils.crc import crc16
+from core.serial_protocol import CAP_CRC32, CAP_LZ
+from utils import lz
+from utils.crc import crc16, crc32
 
 logger = logging.getLogger(__name__)
 
@@ -72,6 +74,8 @@ class FileTransfer:
             "crc_errors": 0,
             "timeout_errors": 0,
             "other_errors": 0,
+            "raw_bytes": 0,
+            "wire_bytes": 0,
         }
 
     def _log(self, message: str):
@@ -88,6 +92,8 @@ class FileTransfer:
             "crc_errors": 0,
             "timeout_errors": 0,
             "other_errors": 0,
+            "raw_bytes": 0,
+            "wire_bytes": 0,
         }
 
     def get_stats(self) -> dict:
@@ -100,8 +106,25 @@ class FileTransfer:
             stats["packet_loss_rate"] = round(retries / (total + retries) * 100, 2)
         else:
             stats["packet_loss_rate"] = 0.0
+        z = lz.transfer_stats(stats["raw_bytes"], stats["wire_bytes"])
+        stats["compression_ratio"] = round(z["ratio"], 3)
+        stats["compression_gain"] = round(z["gain"], 2)
         return stats
 
+    def _lz_mode(self) -> bool:
+        """fwrite/fread data travels LZ-compressed (--z) when supported."""
+        caps = getattr(self.fpb, "device_caps", 0)
+        return isinstance(caps, int) and bool(caps & CAP_LZ)
+
+    def _crc32_mode(self) -> bool:
+        """CRCs are CRC-32 (with --crc32) when the device supports it."""
+        caps = getattr(self.fpb, "device_caps", 0)
+        return isinstance(caps, int) and bool(caps & CAP_CRC32)
+
+    def _crc(self, data: bytes, crc32_mode: bool) -> int:
+        """CRC of a chunk or a whole file, in the given width."""
+        return crc32(data) if crc32_mode else crc16(data)
+
     def _send_cmd(
         self, cmd: str, timeout: float = 2.0, no_protocol_retry: bool = False
     ) -> Tuple[bool, str]:
@@ -152,10 +175,21 @@ class FileTransfer:
         if max_retries is None:
             max_retries = self.max_retries
 
-        b64_data = base64.b64encode(data).decode("ascii")
-        crc = crc16(data)
-        cmd = f"fl -c fwrite --data {b64_data} --crc {crc}"
+        # Compressed only if it shrinks; the CRC covers the raw bytes
+        payload = lz.compress(data) if self._lz_mode() else data
+        z_opt = ""
+        if len(payload) < len(data):
+            z_opt = " --z"
+        else:
+            payload = data
+        b64_data = base64.b64encode(payload).decode("ascii")
+        if self._crc32_mode():
+            cmd = f"fl -c fwrite --data {b64_data}{z_opt} --crc32 --crc 0x{crc32(data):08X}"
+        else:
+            cmd = f"fl -c fwrite --data {b64_data}{z_opt} --crc {crc16(data)}"
         self.stats["total_chunks"] += 1
+        self.stats["raw_bytes"] += len(data)
+        self.stats["wire_bytes"] += len(payload)
         data_len = len(data)
 
         for attempt in range(max_retries + 1):
@@ -214,7 +248,12 @@ class FileTransfer:
         if max_retries is None:
             max_retries = self.max_retries
 
+        crc32_mode = self._crc32_mode()
         cmd = f"fl -c fread --len {size}"
+        if crc32_mode:
+            cmd += " --crc32"
+        if self._lz_mode():
+            cmd += " --z"
         self.stats["total_chunks"] += 1
 
         for attempt in range(max_retries + 1):
@@ -243,10 +282,11 @@ class FileTransfer:
                     continue
                 return False, b"", response
 
-            # Parse response: [FLOK] FREAD <n> bytes crc=0x<crc> data=<base64>
+            # Parse response: [FLOK] FREAD <n> bytes crc=0x<crc> [z=<m>] data=<base64>
             # or: [FLOK] FREAD 0 bytes EOF
             match = re.search(
-                r"FREAD\s+(\d+)\s+bytes(?:\s+crc=0x([0-9A-Fa-f]+)\s+data=(\S+))?",
+                r"FREAD\s+(\d+)\s+bytes"
+                r"(?:\s+crc=0x([0-9A-Fa-f]+)(?:\s+z=(\d+))?\s+data=(\S+))?",
                 response,
             )
             if not match:
@@ -265,7 +305,7 @@ class FileTransfer:
                 return True, b"", "EOF"
 
             crc_str = match.group(2)
-            b64_data = match.group(3)
+            b64_data = match.group(4)
 
             if not b64_data:
                 if attempt < max_retries:
@@ -285,10 +325,23 @@ class FileTransfer:
                     continue
                 return False, b"", f"Base64 decode error: {e}"
 
+            wire_len = len(data)
+            if match.group(3) is not None:
+                try:
+                    data = lz.decompress(data, nbytes)
+                except ValueError as e:
+                    if attempt < max_retries:
+                        logger.warning(
+                            f"fread decompress error, retry {attempt + 1}/{max_retries}: {e}"
+                        )
+                        self.stats["other_errors"] += 1
+                        continue
+                    return False, b"", f"Decompress error: {e}"
+
             # Verify CRC
             if crc_str:
                 expected_crc = int(crc_str, 16)
-                actual_crc = crc16(data)
+                actual_crc = self._crc(data, crc32_mode)
                 if expected_crc != actual_crc:
                     if attempt < max_retries:
                         log_msg = f"fread CRC mismatch: expected 0x{expected_crc:04X}, got 0x{actual_crc:04X}, at offset={current_offset}, len={len(data)}, retry {attempt + 1}/{max_retries}"
@@ -302,6 +355,8 @@ class FileTransfer:
                         f"CRC mismatch: expected 0x{expected_crc:04X}, got 0x{actual_crc:04X}",
                     )
 
+            self.stats["raw_bytes"] += len(data)
+            self.stats["wire_bytes"] += wire_len
             return True, data, f"Read {len(data)} bytes"
 
         return False, b"", "Max retries exceeded"
@@ -315,17 +370,20 @@ class FileTransfer:
         """
         return self._send_cmd("fl -c fclose")
 
-    def fcrc(self, size: int = 0) -> Tuple[bool, int, int]:
+    def fcrc(self, size: int = 0, crc32_mode: bool = False) -> Tuple[bool, int, int]:
         """
         Calculate CRC of open file on device.
 
         Args:
             size: Number of bytes to calculate CRC for (0 = entire file)
+            crc32_mode: Ask for a CRC-32 instead of a CRC-16
 
         Returns:
             Tuple of (success, size, crc)
         """
         cmd = f"fl -c fcrc --len {size}" if size > 0 else "fl -c fcrc"
+        if crc32_mode:
+            cmd += " --crc32"
         success, response = self._send_cmd(cmd)
 
         if not success:
@@ -511,8 +569,9 @@ class FileTransfer:
             # Verify entire file CRC before closing
             # Always verify entire file CRC before closing
             if total_size > 0:
-                expected_crc = crc16(local_data)
-                success, dev_size, dev_crc = self.fcrc(total_size)
+                crc32_mode = self._crc32_mode()
+                expected_crc = self._crc(local_data, crc32_mode)
+                success, dev_size, dev_crc = self.fcrc(total_size, crc32_mode)
                 if not success:
                     self._log(
                         "[WARN] upload: CRC verification failed: could not get device CRC"
@@ -601,8 +660,9 @@ class FileTransfer:
             # Verify entire file CRC before closing
             # Always verify entire file CRC before closing
             if len(data) > 0:
-                local_crc = crc16(data)
-                success, dev_size, dev_crc = self.fcrc(len(data))
+                crc32_mode = self._crc32_mode()
+                local_crc = self._crc(data, crc32_mode)
+                success, dev_size, dev_crc = self.fcrc(len(data), crc32_mode)
                 if not success:
                     self._log(
                         "[WARN] download: CRC verification failed: could not get device CRC"
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2025 - 2026 _VIFEXTech
+
+"""
+Flat profile for the device PC-sampling profiler ("prof" command).
+
+The device only counts interrupted PCs (see App/func_loader/fl_prof.h).
+Here they are mapped to functions with the nm symbol table from
+elf_utils.get_symbols(): a PC belongs to the function with the highest
+start address at or below it. nm gives no sizes, so a PC further than
+FUNC_MAX_SPAN past that start is reported by address instead.
+"""
+
+import bisect
+from typing import Dict, Iterable, List, Optional, Tuple
+
+# Largest distance from a function start still attributed to that function
+FUNC_MAX_SPAN = 0x10000
+
+
+class FunctionIndex:
+    """Sorted function start addresses for PC -> function lookups."""
+
+    def __init__(self, symbols: Dict[str, dict]):
+        by_addr: Dict[int, str] = {}
+        for name, info in symbols.items():
+            if not isinstance(info, dict) or info.get("sym_type") != "function":
+                continue
+            addr = info.get("addr", 0) & ~1
+            # nm lists C++ functions mangled and demangled: keep the readable name
+            if addr not in by_addr or by_addr[addr].startswith("_Z"):
+                by_addr[addr] = name
+        self._addrs = sorted(by_addr)
+        self._names = [by_addr[a] for a in self._addrs]
+
+    def __len__(self):
+        return len(self._addrs)
+
+    def lookup(self, pc: int) -> Optional[Tuple[str, int]]:
+        """Return (name, start) of the function containing pc, or None."""
+        i = bisect.bisect_right(self._addrs, pc) - 1
+        if i < 0 or pc - self._addrs[i] >= FUNC_MAX_SPAN:
+            return None
+        return self._names[i], self._addrs[i]
+
+
+def flat_profile(
+    dump: dict,
+    index: FunctionIndex,
+    regions: Iterable[Tuple[int, int, str]] = (),
+) -> dict:
+    """Group a prof_dump() histogram by function.
+
+    regions are (start, size, name) ranges checked before the symbol table,
+    e.g. injected patch code, which lives in RAM outside the ELF.
+    Returns {"hz", "samples", "overflow", "running", "functions"} where
+    functions are {"name", "addr", "samples", "percent", "pcs"} dicts sorted
+    by samples, pcs being the hottest (pc, count) pairs of the function.
+    """
+    regions = list(regions)
+    total = dump.get("samples", 0)
+    groups: Dict[Tuple[str, int], List[Tuple[int, int]]] = {}
+    for pc, count in dump.get("pcs", []):
+        key = None
+        for start, size, name in regions:
+            if start <= pc < start + size:
+                key = (name, start)
+                break
+        if key is None:
+            key = index.lookup(pc) or (f"0x{pc:08X}", pc)
+        groups.setdefault(key, []).append((pc, count))
+
+    functions = []
+    for (name, addr), pcs in groups.items():
+        samples = sum(count for _, count in pcs)
+        pcs.sort(key=lambda item: -item[1])
+        functions.append(
+            {
+                "name": name,
+                "addr": addr,
+                "samples": samples,
+                "percent": 100.0 * samples / total if total else 0.0,
+                "pcs": pcs[:8],
+            }
+        )
+    functions.sort(key=lambda f: (-f["samples"], f["addr"]))
+
+    return {
+        "hz": dump.get("hz", 0),
+        "samples": total,
+        "overflow": dump.get("overflow", 0),
+        "running": dump.get("running", False),
+        "functions": functions,
+    }
+
+
+def format_flat_profile(profile: dict, limit: int = 0) -> str:
+    """Render a flat_profile() result as a text table."""
+    functions = profile["functions"]
+    if limit:
+        functions = functions[:limit]
+    lines = [
+        f"{profile['samples']} samples at {profile['hz']} Hz"
+        + (f", {profile['overflow']} unbinned" if profile["overflow"] else ""),
+        f"{'%':>6}  {'samples':>8}  {'address':<10}  function",
+    ]
+    for f in functions:
+        lines.append(
+            f"{f['percent']:5.1f}%  {f['samples']:>8}  0x{f['addr']:08X}  {f['name']}"
+        )
+    return "\n".join(lines)
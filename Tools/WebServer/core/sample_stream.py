@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2025 - 2026 _VIFEXTech
+
+"""
+Host side of the device variable sampler ("sample" command).
+
+Mirrors App/func_loader/fl_sample.h. The device sends records as text lines
+between command responses:
+
+    [FLSMP] <base64 of whole records>
+
+Record: seq (1B), ts (4B LE), mask (1B), then the value of each probe whose
+mask bit is set, in probe order. Unchanged probes are omitted except in key
+records, which carry all of them.
+"""
+
+import base64
+import binascii
+import logging
+import queue
+import threading
+from typing import Dict, List, Optional, Tuple
+
+logger = logging.getLogger(__name__)
+
+SAMPLE_PREFIX = "[FLSMP] "
+SAMPLE_REC_HDR_SIZE = 6
+SAMPLE_MAX_PROBES = 8
+SAMPLE_PROBE_SIZE = 8
+
+# Events queued per SSE client; a client this far behind misses newer events
+_LISTENER_QUEUE_SIZE = 256
+
+
+class SampleLineFilter:
+    """Split [FLSMP] lines out of received serial text.
+
+    Text arrives in arbitrary pieces; a trailing partial line that may still
+    become a sample line is held back until its newline arrives.
+    """
+
+    def __init__(self):
+        self._pending = ""
+
+    def feed(self, text: str) -> Tuple[str, List[bytes]]:
+        """Return (text without sample lines, decoded sample payloads)."""
+        text = self._pending + text
+        self._pending = ""
+        out = []
+        payloads = []
+        for line in text.splitlines(keepends=True):
+            if not line.endswith("\n"):
+                if line.startswith(SAMPLE_PREFIX) or SAMPLE_PREFIX.startswith(line):
+                    self._pending = line
+                else:
+                    out.append(line)
+                continue
+            if not line.startswith(SAMPLE_PREFIX):
+                out.append(line)
+                continue
+            try:
+                b64 = line[len(SAMPLE_PREFIX) :].strip()
+                payloads.append(base64.b64decode(b64, validate=True))
+            except (binascii.Error, ValueError):
+                logger.debug(f"Bad sample line: {line!r}")
+        return "".join(out), payloads
+
+
+class SampleDecoder:
+    """Decode sample records into full snapshots of every probe.
+
+    Each decoded sample is a dict: seq, ts (unwrapped timestamp ticks),
+    time (seconds since the first sample, when hz is known), key, and
+    values (probe index -> bytes, every probe once a key record was seen).
+    """
+
+    def __init__(self, sizes: List[int], hz: int = 0):
+        self.sizes = list(sizes)
+        self.hz = hz
+        self.values: List[Optional[bytes]] = [None] * len(sizes)
+        self.lost = 0  # Records missing from the seq sequence
+        self.errors = 0  # Undecodable payloads
+        self._seq = None
+        self._ts = None
+        self._ts0 = None
+        self._synced = False
+
+    def feed(self, payload: bytes) -> List[dict]:
+        """Decode one [FLSMP] payload; records before the first key are skipped."""
+        samples = []
+        pos = 0
+        while pos < len(payload):
+            if len(payload) - pos < SAMPLE_REC_HDR_SIZE:
+                self.errors += 1
+                break
+            seq = payload[pos]
+            ts = int.from_bytes(payload[pos + 1 : pos + 5], "little")
+            mask = payload[pos + 5]
+            pos += SAMPLE_REC_HDR_SIZE
+
+            if mask >> len(self.sizes):
+                self.errors += 1
+                break
+            changed = {}
+            for i, size in enumerate(self.sizes):
+                if mask & (1 << i):
+                    changed[i] = bytes(payload[pos : pos + size])
+                    pos += size
+            if pos > len(payload):
+                self.errors += 1
+                break
+
+            key = mask == (1 << len(self.sizes)) - 1
+            if self._seq is not None:
+                gap = (seq - self._seq - 1) & 0xFF
+                if gap:
+                    self.lost += gap
+                    # Missed deltas: values are stale until the next key record
+                    self._synced = False
+            self._seq = seq
+
+            if key:
+                self._synced = True
+            for i, value in changed.items():
+                self.values[i] = value
+            if not self._synced:
+                continue
+
+            samples.append(
+                {
+                    "seq": seq,
+                    "ts": self._unwrap(ts),
+                    "time": self._seconds(),
+                    "key": key,
+                    "values": dict(enumerate(self.values)),
+                }
+            )
+        return samples
+
+    def _unwrap(self, ts: int) -> int:
+        if self._ts is None:
+            self._ts = ts
+            self._ts0 = ts
+        else:
+            # Key records keep consecutive timestamps under half the 32-bit range
+            self._ts += (ts - self._ts) & 0xFFFFFFFF
+        return self._ts
+
+    def _seconds(self) -> Optional[float]:
+        if not self.hz:
+            return None
+        return (self._ts - self._ts0) / self.hz
+
+
+class SampleSession:
+    """A running sampler: decodes payloads and fans samples out to listeners.
+
+    on_payload() is called from the device worker thread; listeners are
+    SSE queues (see app.utils.sse) receiving {"type": "samples", ...} dicts
+    and a None sentinel on close().
+    """
+
+    def __init__(self, probes: List[dict], hz: int = 0):
+        self.probes = probes
+        self.decoder = SampleDecoder([p["size"] for p in probes], hz)
+        self._listeners: List[queue.Queue] = []
+        self._lock = threading.Lock()
+
+    def subscribe(self) -> queue.Queue:
+        q = queue.Queue(maxsize=_LISTENER_QUEUE_SIZE)
+        with self._lock:
+            self._listeners.append(q)
+        return q
+
+    def unsubscribe(self, q: queue.Queue):
+        with self._lock:
+            if q in self._listeners:
+                self._listeners.remove(q)
+
+    def on_payload(self, payload: bytes):
+        samples = self.decoder.feed(payload)
+        if not samples:
+            return
+        event = {
+            "type": "samples",
+            "lost": self.decoder.lost,
+            "samples": [
+                {
+                    "seq": s["seq"],
+                    "ts": s["ts"],
+                    "time": s["time"],
+                    "values": {
+                        str(i): v.hex() for i, v in s["values"].items() if v is not None
+                    },
+                }
+                for s in samples
+            ],
+        }
+        with self._lock:
+            listeners = list(self._listeners)
+        for q in listeners:
+            try:
+                q.put_nowait(event)
+            except queue.Full:
+                pass
+
+    def close(self):
+        with self._lock:
+            listeners = self._listeners
+            self._listeners = []
+        for q in listeners:
+            try:
+                q.put_nowait(None)
+            except queue.Full:
+                # Make room for the sentinel so the stream ends
+                try:
+                    q.get_nowait()
+                except queue.Empty:
+                    pass
+                q.put_nowait(None)
+
+    def stats(self) -> Dict[str, int]:
+        return {"lost": self.decoder.lost, "errors": self.decoder.errors}
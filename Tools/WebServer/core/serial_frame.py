@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2025 - 2026 _VIFEXTech
+
+"""
+Binary frame transport for the func_loader wire protocol.
+
+Mirrors App/func_loader/fl_frame.h:
+
+    [SOF 0xA5] [flags] [seq] [op] [len (2B LE)] [payload] [crc16 (2B LE)]
+
+The CRC-16-CCITT covers flags..payload. Request payloads are TLV argument
+lists (tag, 2-byte LE length, value). Response frames echo seq/op; text
+output is carried verbatim, raw data (read/fread/echoback) in DATA frames.
+"""
+
+import base64
+import shlex
+import struct
+from dataclasses import dataclass
+from typing import Iterator, List, Optional, Tuple
+
+from utils.crc import crc16_update
+
+FRAME_SOF = 0xA5
+FRAME_HDR_SIZE = 6
+FRAME_CRC_SIZE = 2
+FRAME_OVERHEAD = FRAME_HDR_SIZE + FRAME_CRC_SIZE
+
+FRAME_F_RESP = 0x01
+FRAME_F_MORE = 0x02
+FRAME_F_DATA = 0x04
+
+# Capability bits reported by "PONG caps=0x..."
+CAP_FRAME = 1 << 0
+
+# Argument tags
+TAG_SIZE = 0x01
+TAG_ADDR = 0x02
+TAG_DATA = 0x03
+TAG_CRC = 0x04
+TAG_LEN = 0x05
+TAG_COMP = 0x06
+TAG_ORIG = 0x07
+TAG_TARGET = 0x08
+TAG_ALL = 0x09
+TAG_ENABLE = 0x0A
+TAG_FORCE = 0x0B
+TAG_PATH = 0x0C
+TAG_NEWPATH = 0x0D
+TAG_MODE = 0x0E
+TAG_BIN = 0x0F
+TAG_CRC32 = 0x10
+TAG_Z = 0x11
+TAG_STAGE = 0x12
+TAG_VALUE = 0x13
+TAG_STREAM = 0x14
+TAG_INSN = 0x15
+
+OPCODES = {
+    "ping": 0x01,
+    "echo": 0x02,
+    "echoback": 0x03,
+    "info": 0x04,
+    "alloc": 0x05,
+    "upload": 0x06,
+    "read": 0x07,
+    "write": 0x08,
+    "patch": 0x09,
+    "tpatch": 0x0A,
+    "dpatch": 0x0B,
+    "unpatch": 0x0C,
+    "enable": 0x0D,
+    "hello": 0x0E,
+    "hash": 0x0F,
+    "batch": 0x10,
+    "commit": 0x11,
+    "abort": 0x12,
+    "memcrc": 0x13,
+    "memcmp": 0x14,
+    "memset": 0x15,
+    "memcpy": 0x16,
+    "memfind": 0x17,
+    "readv": 0x18,
+    "sample": 0x19,
+    "prof": 0x1A,
+    "slotstats": 0x1B,
+    "retarget": 0x1C,
+    "ipatch": 0x1D,
+    "fopen": 0x20,
+    "fwrite": 0x21,
+    "fread": 0x22,
+    "fclose": 0x23,
+    "fcrc": 0x24,
+    "fseek": 0x25,
+    "fstat": 0x26,
+    "flist": 0x27,
+    "fremove": 0x28,
+    "fmkdir": 0x29,
+    "frename": 0x2A,
+    "dump": 0x2B,
+}
+
+# Option -> (tag, kind); kind is "int", "str" or "flag"
+OPTIONS = {
+    "-s": (TAG_SIZE, "int"),
+    "--size": (TAG_SIZE, "int"),
+    "-a": (TAG_ADDR, "int"),
+    "--addr": (TAG_ADDR, "int"),
+    "-d": (TAG_DATA, "str"),
+    "--data": (TAG_DATA, "str"),
+    "-r": (TAG_CRC, "int"),
+    "--crc": (TAG_CRC, "int"),
+    "-l": (TAG_LEN, "int"),
+    "--len": (TAG_LEN, "int"),
+    "--comp": (TAG_COMP, "int"),
+    "--orig": (TAG_ORIG, "int"),
+    "--target": (TAG_TARGET, "int"),
+    "--all": (TAG_ALL, "flag"),
+    "--enable": (TAG_ENABLE, "int"),
+    "--force": (TAG_FORCE, "flag"),
+    "--path": (TAG_PATH, "str"),
+    "--newpath": (TAG_NEWPATH, "str"),
+    "-m": (TAG_MODE, "str"),
+    "--mode": (TAG_MODE, "str"),
+    "--crc32": (TAG_CRC32, "flag"),
+    "--z": (TAG_Z, "flag"),
+    "--stage": (TAG_STAGE, "flag"),
+    "--value": (TAG_VALUE, "int"),
+    "--stream": (TAG_STREAM, "flag"),
+    "--insn": (TAG_INSN, "int"),
+}
+
+# Commands whose --data is base64 and travels as raw bytes in a frame
+BINARY_DATA_COMMANDS = ("upload", "write", "fwrite", "batch", "memfind", "readv")
+
+
+@dataclass
+class Frame:
+    """A decoded frame."""
+
+    flags: int
+    seq: int
+    op: int
+    payload: bytes
+
+
+def frame_crc(body: bytes) -> int:
+    """CRC-16-CCITT over flags..payload."""
+    return crc16_update(0xFFFF, body)
+
+
+def encode_frame(seq: int, op: int, payload: bytes = b"", flags: int = 0) -> bytes:
+    """Build one frame."""
+    body = struct.pack("<BBBH", flags, seq & 0xFF, op, len(payload)) + payload
+    return bytes([FRAME_SOF]) + body + struct.pack("<H", frame_crc(body))
+
+
+def tlv(tag: int, value: bytes) -> bytes:
+    """Encode one TLV argument."""
+    return struct.pack("<BH", tag, len(value)) + value
+
+
+def command_to_request(cmd: str) -> Optional[Tuple[int, bytes]]:
+    """Translate a text command ("-c read --addr 0x100 ...") to (op, payload).
+
+    Returns None when the command cannot be expressed as a frame (unknown
+    command or option), so the caller can fall back to the text protocol.
+    """
+    try:
+        tokens = shlex.split(cmd)
+    except ValueError:
+        return None
+    if tokens and tokens[0] == "fl":
+        tokens = tokens[1:]
+
+    name = None
+    args: List[Tuple[str, Optional[str]]] = []
+    i = 0
+    while i < len(tokens):
+        opt = tokens[i]
+        if opt in ("-c", "--cmd"):
+            if i + 1 >= len(tokens):
+                return None
+            name = tokens[i + 1]
+            i += 2
+            continue
+        spec = OPTIONS.get(opt)
+        if spec is None:
+            return None
+        if spec[1] == "flag":
+            args.append((opt, None))
+            i += 1
+        else:
+            if i + 1 >= len(tokens):
+                return None
+            args.append((opt, tokens[i + 1]))
+            i += 2
+
+    if name not in OPCODES:
+        return None
+
+    payload = bytearray()
+    for opt, value in args:
+        tag, kind = OPTIONS[opt]
+        try:
+            if kind == "flag":
+                payload += tlv(tag, b"")
+            elif kind == "int":
+                payload += tlv(tag, struct.pack("<I", int(value, 0) & 0xFFFFFFFF))
+            elif tag == TAG_DATA and name in BINARY_DATA_COMMANDS:
+                payload += tlv(TAG_BIN, base64.b64decode(value, validate=True))
+            else:
+                payload += tlv(tag, value.encode("utf-8") + b"\0")
+        except (ValueError, TypeError):
+            return None
+
+    if len(payload) > 0xFFFF:
+        return None
+    return OPCODES[name], bytes(payload)
+
+
+def batch_record(cmd: str) -> Optional[bytes]:
+    """Encode a command as a batch record: op, 2-byte LE length, TLV payload.
+
+    Returns None when the command has no frame encoding.
+    """
+    request = command_to_request(cmd)
+    if request is None:
+        return None
+    op, payload = request
+    return struct.pack("<BH", op, len(payload)) + payload
+
+
+class FrameDecoder:
+    """Incremental frame parser; bytes outside valid frames are skipped."""
+
+    def __init__(self):
+        self._buf = bytearray()
+
+    def feed(self, data: bytes) -> Iterator[Frame]:
+        """Add received bytes and yield every complete, CRC-valid frame."""
+        self._buf += data
+        buf = self._buf
+        while True:
+            start = buf.find(FRAME_SOF)
+            if start < 0:
+                buf.clear()
+                return
+            if start > 0:
+                del buf[:start]
+            if len(buf) < FRAME_HDR_SIZE:
+                return
+            plen = buf[4] | (buf[5] << 8)
+            total = FRAME_OVERHEAD + plen
+            if len(buf) < total:
+                return
+            body = bytes(buf[1 : FRAME_HDR_SIZE + plen])
+            (rx_crc,) = struct.unpack_from("<H", buf, FRAME_HDR_SIZE + plen)
+            if rx_crc != frame_crc(body):
+                # Not a frame start (or corrupted): resync on the next SOF
+                del buf[:1]
+                continue
+            del buf[:total]
+            yield Frame(body[0], body[1], body[2], body[FRAME_HDR_SIZE - 1 :])
+
+
+def assemble_response(frames: List[Frame]) -> str:
+    """Join response frames into the equivalent text response.
+
+    Raw DATA payloads are rendered back as base64 in place, so the text
+    parsers (READ/FREAD/ECHOBACK) work unchanged on frame responses.
+    """
+    out = []
+    data = bytearray()
+    for frame in frames:
+        if frame.flags & FRAME_F_DATA:
+            data += frame.payload
+            continue
+        if data:
+            out.append(base64.b64encode(bytes(data)).decode("ascii"))
+            data.clear()
+        out.append(frame.payload.decode("utf-8", errors="replace"))
+    if data:
+        out.append(base64.b64encode(bytes(data)).decode("ascii"))
+    return "".join(out)
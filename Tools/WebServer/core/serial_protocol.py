@@ -10,18 +10,88 @@ Provides low-level serial communication with FPB loader firmware.
 """
 
 import base64
+import bisect
 import logging
 import re
 import struct
 import time
+from collections import OrderedDict, deque
 from enum import Enum
-from typing import Dict, Optional, Tuple
+from typing import Dict, List, Optional, Tuple
 
-from utils.crc import crc16, crc16_update
+from utils import lz
+from utils.crc import crc16, crc16_update, crc32, crc32_update
+from core import serial_frame
 from core.state import tool_log
 
 logger = logging.getLogger(__name__)
 
+# Capability bit: upload acks carry "off=0x..", so chunks can be pipelined
+CAP_UPLOAD_ACK = 1 << 1
+# Capability bit: upload/write with --len decode --data as it arrives
+CAP_STREAM_DATA = 1 << 2
+# Capability bit: --crc32 switches request/response CRCs to CRC-32
+CAP_CRC32 = 1 << 3
+# Capability bit: upload/write/read/fwrite/fread accept --z (LZ-compressed data)
+CAP_LZ = 1 << 4
+# Capability bit: "hash" returns per-block CRCs over a memory range
+CAP_HASH = 1 << 5
+# Capability bit: "batch" runs several commands in one request
+CAP_BATCH = 1 << 6
+# Capability bit: patch commands accept --stage, armed together by "commit"
+CAP_STAGE = 1 << 7
+# Capability bit: "memcrc"/"memcmp" checksum and compare ranges on the device
+CAP_MEMCRC = 1 << 8
+# Capability bit: "memset"/"memcpy"/"memfind" fill, copy and search on the device
+CAP_MEMOPS = 1 << 9
+# Capability bit: "readv" returns several memory ranges in one response
+CAP_READV = 1 << 10
+# Capability bit: "read --stream" returns any length as base64 lines with SYNC markers
+CAP_READ_STREAM = 1 << 11
+# Capability bit: "dump" saves a memory range to a file on the device
+CAP_DUMP = 1 << 12
+# Capability bit: "sample" streams probe values as [FLSMP] lines
+CAP_SAMPLE = 1 << 13
+# Capability bit: "prof" samples the interrupted PC into a histogram
+CAP_PROF = 1 << 14
+# Capability bit: "slotstats" reports trampoline call and cycle counters
+CAP_SLOTSTATS = 1 << 15
+# Capability bit: "retarget" moves a live tpatch/dpatch slot to new code
+CAP_RETARGET = 1 << 16
+# Capability bit: "ipatch" replaces one Thumb instruction through the remap table
+CAP_IPATCH = 1 << 17
+
+# Bytes per streamed upload command (bounds retransmit cost, paces progress)
+STREAM_SEGMENT_SIZE = 4096
+
+# Largest span sent as one --z chunk: the device inflates into FL_BUF_SIZE
+LZ_CHUNK_SIZE = 1024
+# Compressed chunks only beat streamed upload below this wire/raw ratio
+LZ_STREAM_RATIO = 0.75
+
+# Delta upload block size (FL_HASH_BLOCK_SIZE) and CRC bytes per hash response
+HASH_BLOCK_SIZE = 64
+HASH_MAX_BYTES = 1024
+
+# readv: ranges closer than this are read as one span
+READV_COALESCE_GAP = 16
+
+# read --stream: a transfer that is silent this long resumes at the last SYNC
+READ_STREAM_IDLE_TIMEOUT = 2.0
+
+# dump: slowest expected file write rate (SD card / flash), bytes per second
+DUMP_WRITE_RATE = 100_000
+
+
+def _varint(v: int) -> bytes:
+    """Unsigned LEB128 encoding (readv range lists)."""
+    out = bytearray()
+    while v >= 0x80:
+        out.append((v & 0x7F) | 0x80)
+        v >>= 7
+    out.append(v)
+    return bytes(out)
+
 
 class Platform(Enum):
     """Platform types for FPB communication."""
@@ -44,6 +114,124 @@ class FPBProtocolError(Exception):
     pass
 
 
+class _ResponseReader:
+    """Split a stream of pipelined responses into individual responses."""
+
+    def __init__(self, ser, frames: bool):
+        self._ser = ser
+        self._frames = frames
+        self._text = ""
+        self._decoder = serial_frame.FrameDecoder()
+        self._partial = []
+        self._ready = deque()
+
+    def read(self, timeout: float) -> Optional[str]:
+        """Return the next complete raw response, or None after timeout."""
+        start = time.time()
+        while not self._ready:
+            if time.time() - start >= timeout:
+                return None
+            if not self._ser.in_waiting:
+                time.sleep(0.0001)
+                continue
+            data = self._ser.read(self._ser.in_waiting)
+            if self._frames:
+                self._feed_frames(data)
+            else:
+                self._feed_text(data.decode("utf-8", errors="replace"))
+        return self._ready.popleft()
+
+    def _feed_text(self, text: str):
+        self._text += text
+        while "[FLEND]" in self._text:
+            resp, self._text = self._text.split("[FLEND]", 1)
+            self._ready.append(resp + "[FLEND]")
+
+    def _feed_frames(self, data: bytes):
+        for frame in self._decoder.feed(data):
+            if not frame.flags & serial_frame.FRAME_F_RESP:
+                continue
+            if self._partial and self._partial[0].seq != frame.seq:
+                # Tail of the previous response was lost
+                self._partial = []
+            self._partial.append(frame)
+            if not frame.flags & serial_frame.FRAME_F_MORE:
+                self._ready.append(serial_frame.assemble_response(self._partial))
+                self._partial = []
+
+
+class _ReadStream:
+    """Incremental parser of a "read --stream" response.
+
+    Data between SYNC markers is held back until the marker's offset and
+    rolling CRC check out, so `data` only ever holds verified bytes and a
+    broken transfer can resume at len(data). Lines that are not base64
+    (e.g. interleaved device logs) are skipped; lost data fails the SYNC.
+    """
+
+    def __init__(self, frames: bool, crc: int, crc_update):
+        self.data = bytearray()
+        self.done = False
+        self.error = ""  # [FLERR] from the device: retrying will not help
+        self.broken = ""  # Transfer error: resume at len(data)
+        self._frames = frames
+        self._decoder = serial_frame.FrameDecoder()
+        self._crc = crc
+        self._crc_update = crc_update
+        self._pending = bytearray()
+        self._text = ""
+
+    def feed(self, data: bytes):
+        """Add received bytes."""
+        if not self._frames:
+            self._feed_text(data.decode("utf-8", errors="replace"))
+            return
+        for frame in self._decoder.feed(data):
+            if not frame.flags & serial_frame.FRAME_F_RESP:
+                continue
+            if frame.op != serial_frame.OPCODES["read"]:
+                continue
+            if frame.flags & serial_frame.FRAME_F_DATA:
+                if not self.broken:
+                    self._pending += frame.payload
+            else:
+                self._feed_text(frame.payload.decode("utf-8", errors="replace"))
+
+    def _feed_text(self, text: str):
+        self._text += text
+        *lines, self._text = self._text.split("\n")
+        for line in lines:
+            self._line(line.strip())
+
+    def _line(self, line: str):
+        if not line or self.done:
+            return
+        if line.startswith("[FLEND]"):
+            self.done = True
+        elif line.startswith("[FLERR]"):
+            self.error = line[len("[FLERR]") :].strip()
+        elif self.broken or line.startswith("[FLOK]"):
+            pass
+        elif line.startswith("SYNC "):
+            self._sync(line)
+        elif not self._frames:
+            try:
+                self._pending += base64.b64decode(line, validate=True)
+            except ValueError:
+                logger.debug(f"read --stream: skipped line {line[:40]!r}")
+
+    def _sync(self, line: str):
+        match = re.fullmatch(r"SYNC (\d+) crc=0x([0-9A-Fa-f]+)", line)
+        off = len(self.data) + len(self._pending)
+        crc = self._crc_update(self._crc, bytes(self._pending))
+        if not match or int(match.group(1)) != off or int(match.group(2), 16) != crc:
+            self.broken = f"SYNC mismatch after offset {len(self.data)}: {line}"
+            return
+        self.data += self._pending
+        self._pending.clear()
+        self._crc = crc
+
+
 class FPBProtocol:
     """FPB serial protocol handler."""
 
@@ -52,6 +240,11 @@ class FPBProtocol:
         self.device = device_state
         self._in_fl_mode = False
         self._platform = Platform.UNKNOWN
+        self.caps = 0  # Capability bits from the last ping
+        self._frame_ser = None  # Serial port on which binary frames were negotiated
+        self._frame_seq = 0
+        self._read_wire_bytes = 0  # Payload bytes received by read_memory()
+        self._alloc_base = None  # Base of the last alloc, upload offsets are from it
 
     def get_platform(self) -> Platform:
         """Get detected platform type."""
@@ -167,20 +360,128 @@ class FPBProtocol:
             logger.error(f"Error exiting fl mode: {e}")
             return False
 
+    def _write_bytes(self, data_bytes: bytes):
+        """Write to serial, fragmenting for slow drivers if configured."""
+        ser = self.device.ser
+        tx_fragment_size = getattr(self.device, "serial_tx_fragment_size", 0)
+        tx_fragment_delay = getattr(self.device, "serial_tx_fragment_delay", 0.002)
+        if tx_fragment_size > 0 and len(data_bytes) > tx_fragment_size:
+            for i in range(0, len(data_bytes), tx_fragment_size):
+                chunk = data_bytes[i : i + tx_fragment_size]
+                ser.write(chunk)
+                ser.flush()
+                if i + tx_fragment_size < len(data_bytes):
+                    time.sleep(tx_fragment_delay)
+        else:
+            ser.write(data_bytes)
+        ser.flush()
+
+    def frame_mode_active(self) -> bool:
+        """True when binary frames were negotiated on the current port."""
+        return (
+            self._frame_ser is not None
+            and self._frame_ser is self.device.ser
+            and bool(getattr(self.device, "binary_transport", True))
+        )
+
+    def _update_caps(self, msg: str):
+        """Record capabilities from a PONG and switch transport if possible."""
+        match = re.search(r"caps=0x([0-9A-Fa-f]+)", msg)
+        self.caps = int(match.group(1), 16) if match else 0
+        if self.caps & serial_frame.CAP_FRAME:
+            if not self.frame_mode_active():
+                logger.info("Device supports binary frames, switching transport")
+            self._frame_ser = self.device.ser
+        else:
+            self._frame_ser = None
+
+    def _send_frame(
+        self, cmd: str, op: int, payload: bytes, timeout: float, max_retries: int
+    ) -> Optional[str]:
+        """Send one request as a binary frame.
+
+        Returns the response rendered as text (data frames as base64), or
+        None if no valid response arrived after all retries.
+        """
+        ser = self.device.ser
+        for attempt in range(max_retries + 1):
+            if attempt > 0:
+                logger.warning(
+                    f"Retry {attempt}/{max_retries} for frame command: {cmd[:50]}..."
+                )
+                tool_log(
+                    self.device,
+                    "WARN",
+                    f"Retry attempt {attempt}/{max_retries}",
+                )
+                time.sleep(0.05)
+
+            self._frame_seq = (self._frame_seq + 1) & 0xFF
+            seq = self._frame_seq
+            logger.debug(f"TX frame seq={seq} op=0x{op:02X}: {cmd}")
+            self._log_raw(LogDirection.TX, f"fl {cmd}")
+
+            ser.reset_input_buffer()
+            # Leading newline terminates any partial line and resyncs the device
+            self._write_bytes(b"\n" + serial_frame.encode_frame(seq, op, payload))
+
+            decoder = serial_frame.FrameDecoder()
+            frames = []
+            start = time.time()
+            while time.time() - start < timeout:
+                if not ser.in_waiting:
+                    time.sleep(0.0001)
+                    continue
+                done = False
+                for frame in decoder.feed(ser.read(ser.in_waiting)):
+                    if not frame.flags & serial_frame.FRAME_F_RESP:
+                        continue
+                    if frame.seq != seq or frame.op != op:
+                        continue
+                    frames.append(frame)
+                    if not frame.flags & serial_frame.FRAME_F_MORE:
+                        done = True
+                        break
+                if done:
+                    response = serial_frame.assemble_response(frames).strip()
+                    logger.debug(f"RX: {response}")
+                    self._log_raw(LogDirection.RX, response)
+                    response = response.replace("[FLEND]", "").strip()
+                    if "[FLOK]" in response or "[FLERR]" in response:
+                        return response
+                    break
+
+        return None
+
     def send_cmd(
         self,
         cmd: str,
         timeout: float = 0.5,
         retry_on_missing_cmd: bool = True,
         max_retries: int = 3,
+        allow_frame: bool = True,
     ) -> str:
-        """Send command and get response with automatic retry."""
+        """Send command and get response with automatic retry.
+
+        allow_frame=False forces the text protocol, e.g. for streamed data
+        that would not fit in a single frame.
+        """
         ser = self.device.ser
         if not ser:
             raise FPBProtocolError("Serial port not connected")
 
         self.try_enter_fl_mode()
 
+        if allow_frame and self.frame_mode_active():
+            request = serial_frame.command_to_request(cmd)
+            if request is not None:
+                response = self._send_frame(cmd, *request, timeout, max_retries)
+                if response is not None:
+                    return response
+                logger.warning("No frame response, falling back to text protocol")
+                tool_log(self.device, "WARN", "Binary frames failed, using text")
+                self._frame_ser = None
+
         full_cmd = f"fl {cmd}" if not cmd.strip().startswith("fl ") else cmd
 
         last_response = ""
@@ -200,20 +501,7 @@ class FPBProtocol:
             self._log_raw(LogDirection.TX, full_cmd)
 
             ser.reset_input_buffer()
-
-            data_bytes = (full_cmd + "\n").encode()
-            tx_fragment_size = getattr(self.device, "serial_tx_fragment_size", 0)
-            tx_fragment_delay = getattr(self.device, "serial_tx_fragment_delay", 0.002)
-            if tx_fragment_size > 0 and len(data_bytes) > tx_fragment_size:
-                for i in range(0, len(data_bytes), tx_fragment_size):
-                    chunk = data_bytes[i : i + tx_fragment_size]
-                    ser.write(chunk)
-                    ser.flush()
-                    if i + tx_fragment_size < len(data_bytes):
-                        time.sleep(tx_fragment_delay)
-            else:
-                ser.write(data_bytes)
-            ser.flush()
+            self._write_bytes((full_cmd + "\n").encode())
 
             response = ""
             start = time.time()
@@ -265,7 +553,11 @@ class FPBProtocol:
             tool_log(self.device, "INFO", "Entering fl interactive mode...")
             if self.enter_fl_mode():
                 return self.send_cmd(
-                    cmd, timeout, retry_on_missing_cmd=False, max_retries=max_retries
+                    cmd,
+                    timeout,
+                    retry_on_missing_cmd=False,
+                    max_retries=max_retries,
+                    allow_frame=allow_frame,
                 )
 
         return last_response
@@ -361,6 +653,8 @@ class FPBProtocol:
         try:
             resp = self.send_cmd("-c ping")
             result = self.parse_response(resp)
+            if result.get("ok", False):
+                self._update_caps(result.get("msg", ""))
             return result.get("ok", False), result.get("msg", "")
         except Exception as e:
             return False, str(e)
@@ -418,8 +712,28 @@ class FPBProtocol:
                                         "orig_addr": orig_addr,
                                         "target_addr": target_addr,
                                         "code_size": code_size,
+                                        "debugmon_only": "(debugmon" in line,
                                     }
                                 )
+                            elif " insn " in line:
+                                # ipatch slot: one instruction, no code
+                                match = re.match(
+                                    r"Slot\[(\d+)\]:\s*(0x[0-9A-Fa-f]+)\s+insn\s+(0x[0-9A-Fa-f]+).*\(.*,\s*(on|off)\)",
+                                    line,
+                                )
+                                if match:
+                                    info["slots"].append(
+                                        {
+                                            "id": int(match.group(1)),
+                                            "occupied": True,
+                                            "enabled": match.group(4) == "on",
+                                            "orig_addr": int(match.group(2), 16),
+                                            "target_addr": 0,
+                                            "code_size": 0,
+                                            "insn": int(match.group(3), 16),
+                                            "debugmon_only": False,
+                                        }
+                                    )
                             elif "empty" not in line:
                                 # Try simple format without (COMP=..., on|off)
                                 match = re.match(
@@ -453,6 +767,8 @@ class FPBProtocol:
                                             "orig_addr": 0,
                                             "target_addr": 0,
                                             "code_size": 0,
+                                            # Past the FPB comparators: dpatch only
+                                            "debugmon_only": "(debugmon" in line,
                                         }
                                     )
                         except (ValueError, AttributeError):
@@ -462,51 +778,91 @@ class FPBProtocol:
         except Exception as e:
             return None, str(e)
 
-    def alloc(self, size: int) -> Tuple[Optional[int], str]:
-        """Allocate memory buffer."""
+    def alloc(
+        self, size: int, unpatch_comp: Optional[int] = None
+    ) -> Tuple[Optional[int], str]:
+        """Allocate memory buffer.
+
+        unpatch_comp clears that slot first, in the same batch when the
+        device supports it, so its freed memory can be handed back.
+        """
         try:
-            resp = self.send_cmd(f"-c alloc -s {size}")
+            cmd = f"-c alloc -s {size}"
+            if unpatch_comp is not None:
+                pre = self.unpatch_cmd(unpatch_comp)
+                if self.batch_supported():
+                    ok, results, msg = self.batch([pre, cmd])
+                    if not ok:
+                        return None, results[-1]["msg"] if results else msg
+                    return self._parse_alloc(results[-1], size)
+                self.send_cmd(pre)
+            resp = self.send_cmd(cmd)
             logger.debug(f"Alloc response: {resp}")
             result = self.parse_response(resp)
             logger.debug(f"Alloc parsed result: {result}")
-            if result.get("ok"):
-                msg = result.get("msg", "")
-                match = re.search(r"0x([0-9A-Fa-f]+)", msg)
-                if match:
-                    base = int(match.group(1), 16)
-                    logger.info(f"Alloc successful: size={size}, base=0x{base:08X}")
-                    return base, ""
-                else:
-                    logger.warning(f"Alloc: Could not parse address from msg: {msg}")
-            return None, result.get("msg", "Alloc failed")
+            return self._parse_alloc(result, size)
         except Exception as e:
             logger.exception(f"Alloc exception: {e}")
             return None, str(e)
 
+    def _parse_alloc(self, result: dict, size: int) -> Tuple[Optional[int], str]:
+        """Extract the base address from a parsed alloc response."""
+        if result.get("ok"):
+            msg = result.get("msg", "")
+            match = re.search(r"0x([0-9A-Fa-f]+)", msg)
+            if match:
+                base = int(match.group(1), 16)
+                logger.info(f"Alloc successful: size={size}, base=0x{base:08X}")
+                self._alloc_base = base
+                return base, ""
+            else:
+                logger.warning(f"Alloc: Could not parse address from msg: {msg}")
+        self._alloc_base = None
+        return None, result.get("msg", "Alloc failed")
+
     def upload(
         self, data: bytes, start_offset: int = 0, progress_callback=None
     ) -> Tuple[bool, dict]:
-        """Upload binary data in chunks using base64 encoding."""
+        """Upload binary data in chunks using base64 encoding.
+
+        With CAP_MEMCRC the uploaded range is verified end to end by one
+        memcrc (result["verified"]), once the alloc base is known.
+        """
+        ok, result = self._upload(data, start_offset, progress_callback)
+        if ok and data and self._alloc_base is not None:
+            verified, msg = self.verify_memory(self._alloc_base + start_offset, data)
+            if verified is False:
+                return False, {"error": f"Upload verify failed: {msg}"}
+            result["verified"] = bool(verified)
+        return ok, result
+
+    def _upload(
+        self, data: bytes, start_offset: int, progress_callback
+    ) -> Tuple[bool, dict]:
+        """Upload without end-to-end verification."""
         total = len(data)
         data_offset = 0
         bytes_per_chunk = (
             self.device.upload_chunk_size if self.device.upload_chunk_size > 0 else 128
         )
 
-        upload_start = time.time()
-        chunk_count = 0
+        stream = bool(self.caps & CAP_STREAM_DATA)
+        if stream and not self.caps & CAP_LZ:
+            return self._upload_streamed(data, start_offset, progress_callback)
 
-        while data_offset < total:
-            chunk = data[data_offset : data_offset + bytes_per_chunk]
-            b64_data = base64.b64encode(chunk).decode("ascii")
+        chunks = self._upload_chunks(data, start_offset, bytes_per_chunk)
+        wire = sum(c[2] for c in chunks)
+        if stream and wire >= total * LZ_STREAM_RATIO:
+            return self._upload_streamed(data, start_offset, progress_callback)
 
-            device_offset = start_offset + data_offset
-            # CRC covers: offset(4B LE) + len(4B LE) + data payload
-            crc = crc16_update(0xFFFF, struct.pack("<II", device_offset, len(chunk)))
-            crc = crc16_update(crc, chunk)
+        window = self._upload_window()
+        if window > 1:
+            return self._upload_pipelined(chunks, total, window, progress_callback)
 
-            cmd = f"-c upload -a 0x{device_offset:X} -d {b64_data} -r 0x{crc:04X}"
+        upload_start = time.time()
+        chunk_count = 0
 
+        for device_offset, raw_len, _, cmd in chunks:
             try:
                 resp = self.send_cmd(cmd)
                 result = self.parse_response(resp)
@@ -518,6 +874,123 @@ class FPBProtocol:
             except Exception as e:
                 return False, {"error": str(e)}
 
+            data_offset += raw_len
+            chunk_count += 1
+
+            if progress_callback:
+                progress_callback(data_offset, total)
+
+        upload_time = time.time() - upload_start
+        speed = total / upload_time if upload_time > 0 else 0
+
+        return True, {
+            "bytes": total,
+            "chunks": chunk_count,
+            "time": upload_time,
+            "speed": speed,
+            **lz.transfer_stats(total, wire),
+        }
+
+    def _upload_chunks(
+        self, data: bytes, start_offset: int, bytes_per_chunk: int
+    ) -> List[Tuple[int, int, int, str]]:
+        """Split an upload into (device_offset, raw_len, wire_len, cmd) chunks.
+
+        With CAP_LZ, spans of up to LZ_CHUNK_SIZE go out as one --z chunk
+        when they compress to a chunk's worth of bytes; anything else is sent
+        raw. The CRC always covers the uncompressed bytes.
+        """
+        use_lz = bool(self.caps & CAP_LZ)
+        span_size = max(LZ_CHUNK_SIZE, bytes_per_chunk) if use_lz else bytes_per_chunk
+        chunks = []
+        data_offset = 0
+        while data_offset < len(data):
+            span = data[data_offset : data_offset + span_size]
+            packed = lz.compress(span) if use_lz else span
+            if len(packed) < len(span) and len(packed) <= bytes_per_chunk:
+                parts = [(span, packed)]
+            else:
+                parts = [
+                    (span[i : i + bytes_per_chunk], None)
+                    for i in range(0, len(span), bytes_per_chunk)
+                ]
+
+            for raw, packed in parts:
+                device_offset = start_offset + data_offset
+                # CRC covers: offset(4B LE) + len(4B LE) + data payload
+                crc = self._request_crc(
+                    struct.pack("<II", device_offset, len(raw)), raw
+                )
+                payload = raw if packed is None else packed
+                b64_data = base64.b64encode(payload).decode("ascii")
+                z_opt = "" if packed is None else " --z"
+                cmd = f"-c upload -a 0x{device_offset:X} -d {b64_data}{z_opt} {self._crc_opt(crc)}"
+                chunks.append((device_offset, len(raw), len(payload), cmd))
+                data_offset += len(raw)
+        return chunks
+
+    def upload_commands(
+        self, data: bytes, start_offset: int = 0
+    ) -> Tuple[List[str], int]:
+        """Upload commands for data (e.g. to batch them) and their wire bytes."""
+        bytes_per_chunk = (
+            self.device.upload_chunk_size if self.device.upload_chunk_size > 0 else 128
+        )
+        chunks = self._upload_chunks(data, start_offset, bytes_per_chunk)
+        return [c[3] for c in chunks], sum(c[2] for c in chunks)
+
+    def _upload_streamed(
+        self, data: bytes, start_offset: int = 0, progress_callback=None
+    ) -> Tuple[bool, dict]:
+        """Upload in large segments streamed straight into device memory.
+
+        Each segment is one command with --len and --crc ahead of --data.
+        The device decodes the base64 as it arrives, so segments are not
+        limited by its line buffer or transfer buffer.
+        """
+        try:
+            max_retries = int(getattr(self.device, "transfer_max_retries", 3))
+        except (TypeError, ValueError):
+            max_retries = 3
+
+        total = len(data)
+        data_offset = 0
+        chunk_count = 0
+        retransmits = 0
+        upload_start = time.time()
+
+        while data_offset < total:
+            chunk = data[data_offset : data_offset + STREAM_SEGMENT_SIZE]
+            device_offset = start_offset + data_offset
+            # CRC covers: offset(4B LE) + len(4B LE) + data payload
+            crc = self._request_crc(
+                struct.pack("<II", device_offset, len(chunk)), chunk
+            )
+            b64_data = base64.b64encode(chunk).decode("ascii")
+            cmd = (
+                f"-c upload -a 0x{device_offset:X} -l {len(chunk)} "
+                f"{self._crc_opt(crc)} -d {b64_data}"
+            )
+
+            for attempt in range(max_retries + 1):
+                try:
+                    resp = self.send_cmd(cmd, timeout=1.0, allow_frame=False)
+                except Exception as e:
+                    return False, {"error": str(e)}
+                result = self.parse_response(resp)
+                if result.get("ok") or "CRC mismatch" not in result.get("msg", ""):
+                    break
+                retransmits += 1
+                logger.warning(
+                    f"Upload CRC mismatch at 0x{device_offset:X}, "
+                    f"retry {attempt + 1}/{max_retries}"
+                )
+
+            if not result.get("ok"):
+                return False, {
+                    "error": f"Upload failed at offset 0x{device_offset:X}: {result.get('msg')}"
+                }
+
             data_offset += len(chunk)
             chunk_count += 1
 
@@ -532,17 +1005,179 @@ class FPBProtocol:
             "chunks": chunk_count,
             "time": upload_time,
             "speed": speed,
+            "retransmits": retransmits,
+            **lz.transfer_stats(total, total),
         }
 
-    def _parse_read_response(self, resp: str, addr: int = 0) -> Optional[bytes]:
+    def _upload_window(self) -> int:
+        """Number of upload chunks that may be in flight (1 = stop-and-wait)."""
+        if not self.caps & CAP_UPLOAD_ACK:
+            return 1
+        try:
+            return max(1, int(getattr(self.device, "upload_window", 1)))
+        except (TypeError, ValueError):
+            return 1
+
+    def _pipeline_write(self, cmd: str):
+        """Send a command without waiting for its response."""
+        if self.frame_mode_active():
+            request = serial_frame.command_to_request(cmd)
+            if request is not None:
+                self._frame_seq = (self._frame_seq + 1) & 0xFF
+                self._log_raw(LogDirection.TX, f"fl {cmd}")
+                frame = serial_frame.encode_frame(self._frame_seq, *request)
+                self._write_bytes(b"\n" + frame)
+                return
+        full_cmd = f"fl {cmd}"
+        self._log_raw(LogDirection.TX, full_cmd)
+        self._write_bytes((full_cmd + "\n").encode())
+
+    def _upload_pipelined(
+        self,
+        chunks: List[Tuple[int, int, int, str]],
+        total: int,
+        window: int,
+        progress_callback=None,
+        timeout: float = 0.5,
+    ) -> Tuple[bool, dict]:
+        """Upload with up to `window` chunks in flight.
+
+        Acks carry the chunk offset. The device answers in order, so an ack
+        for a later chunk means the earlier in-flight ones were lost; those
+        and CRC failures are retransmitted selectively. A timeout resends
+        everything in flight and halves the window. Chunks are idempotent,
+        so a duplicate caused by a late ack is harmless.
+        """
+        ser = self.device.ser
+        if not ser:
+            return False, {"error": "Serial port not connected"}
+        try:
+            max_retries = int(getattr(self.device, "transfer_max_retries", 3))
+        except (TypeError, ValueError):
+            max_retries = 3
+
+        cmds = {off: cmd for off, _, _, cmd in chunks}
+        sizes = {off: raw_len for off, raw_len, _, _ in chunks}
+
+        queue = deque(cmds)
+        inflight = OrderedDict()
+        retries = {}
+        retransmits = 0
+        acked = 0
+        last_error = "no response"
+
+        def requeue(offsets, reason):
+            nonlocal retransmits, last_error
+            last_error = reason
+            for off in reversed(offsets):
+                retries[off] = retries.get(off, 0) + 1
+                if retries[off] > max_retries:
+                    return off
+                queue.appendleft(off)
+            retransmits += len(offsets)
+            return None
+
+        try:
+            self.try_enter_fl_mode()
+            ser.reset_input_buffer()
+            reader = _ResponseReader(ser, self.frame_mode_active())
+            upload_start = time.time()
+
+            while queue or inflight:
+                while queue and len(inflight) < window:
+                    off = queue.popleft()
+                    self._pipeline_write(cmds[off])
+                    inflight[off] = True
+
+                raw = reader.read(timeout)
+                if raw is None:
+                    window = max(1, window // 2)
+                    lost = list(inflight)
+                    inflight.clear()
+                    logger.warning(
+                        f"Upload timeout, resending {len(lost)} chunk(s), window={window}"
+                    )
+                    failed = requeue(lost, "timeout")
+                    if failed is not None:
+                        break
+                    continue
+
+                raw = raw.strip()
+                logger.debug(f"RX: {raw}")
+                self._log_raw(LogDirection.RX, raw)
+                result = self.parse_response(raw.replace("[FLEND]", "").strip())
+                msg = result.get("msg", "")
+                match = re.search(r"off=0x([0-9A-Fa-f]+)", msg)
+                off = int(match.group(1), 16) if match else None
+                if off not in inflight:
+                    # Garbled line or a late duplicate; timeouts cover the rest
+                    if not result.get("ok"):
+                        last_error = msg
+                    continue
+
+                lost = []
+                for pending in inflight:
+                    if pending == off:
+                        break
+                    lost.append(pending)
+                for pending in lost:
+                    del inflight[pending]
+                del inflight[off]
+                if lost:
+                    window = max(1, window // 2)
+                    failed = requeue(lost, "chunk lost")
+                    if failed is not None:
+                        break
+
+                if result.get("ok"):
+                    acked += sizes[off]
+                    if progress_callback:
+                        progress_callback(acked, total)
+                elif "CRC mismatch" in msg:
+                    failed = requeue([off], msg)
+                    if failed is not None:
+                        break
+                else:
+                    failed, last_error = off, msg
+                    break
+            else:
+                failed = None
+        except Exception as e:
+            return False, {"error": str(e)}
+
+        if failed is not None:
+            return False, {
+                "error": f"Upload failed at offset 0x{failed:X}: {last_error}"
+            }
+
+        upload_time = time.time() - upload_start
+        speed = total / upload_time if upload_time > 0 else 0
+
+        return True, {
+            "bytes": total,
+            "chunks": len(cmds),
+            "time": upload_time,
+            "speed": speed,
+            "window": window,
+            "retransmits": retransmits,
+            **lz.transfer_stats(total, sum(c[2] for c in chunks)),
+        }
+
+    def _parse_read_response(
+        self, resp: str, addr: int = 0, crc_prefix: Optional[bytes] = None
+    ) -> Optional[bytes]:
         """Parse READ response to extract binary data.
 
-        Expected format: [FLOK] READ <n> bytes crc=0x<XXXX> data=<base64>
-        CRC covers: addr(4B LE) + len(4B LE) + data payload.
+        Expected format: [FLOK] READ <n> bytes crc=0x<XXXX> [z=<m>] data=<base64>
+        With z=, data is an m-byte LZ block that inflates to n bytes.
+        CRC covers: addr(4B LE) + len(4B LE) + data payload, CRC-32 when the
+        request carried --crc32. READV responses ("READV <k> ranges <n> bytes")
+        parse alike, their CRC covers crc_prefix + data payload instead.
         Returns decoded bytes if CRC matches, None on error.
         """
         match = re.search(
-            r"\[FLOK\]\s+READ\s+(\d+)\s+bytes\s+crc=0x([0-9A-Fa-f]+)\s+data=(\S+)",
+            r"\[FLOK\]\s+READV?\s+(?:\d+\s+ranges\s+)?(\d+)\s+bytes\s+"
+            r"crc=0x([0-9A-Fa-f]+)(?:\s+z=(\d+))?\s+data=(\S+)",
             resp,
         )
         if not match:
@@ -550,7 +1185,7 @@ class FPBProtocol:
 
         expected_len = int(match.group(1))
         expected_crc = int(match.group(2), 16)
-        b64_data = match.group(3)
+        b64_data = match.group(4)
 
         try:
             raw = base64.b64decode(b64_data)
@@ -558,18 +1193,25 @@ class FPBProtocol:
             logger.error("Failed to decode base64 from read response")
             return None
 
+        self._read_wire_bytes += len(raw)
+        if match.group(3) is not None:
+            try:
+                raw = lz.decompress(raw, expected_len)
+            except ValueError as e:
+                logger.error(f"Failed to decompress read response: {e}")
+                return None
+
         if len(raw) != expected_len:
             logger.error(
                 f"Read length mismatch: got {len(raw)}, expected {expected_len}"
             )
             return None
 
-        actual_crc = crc16_update(0xFFFF, struct.pack("<II", addr, len(raw)))
-        actual_crc = crc16_update(actual_crc, raw)
+        if crc_prefix is None:
+            crc_prefix = struct.pack("<II", addr, len(raw))
+        actual_crc = self._request_crc(crc_prefix, raw)
         if actual_crc != expected_crc:
-            logger.error(
-                f"Read CRC mismatch: 0x{actual_crc:04X} != 0x{expected_crc:04X}"
-            )
+            logger.error(f"Read CRC mismatch: 0x{actual_crc:X} != 0x{expected_crc:X}")
             return None
 
         return raw
@@ -579,6 +1221,8 @@ class FPBProtocol:
     ) -> Tuple[Optional[bytes], str]:
         """Read memory from device in chunks with retry support.
 
+        Ranges longer than one chunk are streamed in a single request when
+        the device supports "read --stream".
         Returns (data_bytes, message) on success, (None, error_msg) on failure.
         """
         bytes_per_chunk = (
@@ -586,15 +1230,20 @@ class FPBProtocol:
             if self.device.download_chunk_size > 0
             else 1024
         )
+        if self.caps & CAP_READ_STREAM and length > bytes_per_chunk:
+            return self._read_stream(addr, length, progress_callback, max_retries)
+
         buf = bytearray()
         offset = 0
+        z_opt = " --z" if self.caps & CAP_LZ else ""
+        self._read_wire_bytes = 0
 
         while offset < length:
             n = min(bytes_per_chunk, length - offset)
             chunk_addr = addr + offset
             # CRC covers: addr(4B LE) + len(4B LE) for request verification
-            crc_val = crc16_update(0xFFFF, struct.pack("<II", chunk_addr, n))
-            cmd = f"-c read --addr 0x{chunk_addr:X} --len {n} --crc 0x{crc_val:04X}"
+            crc_val = self._request_crc(struct.pack("<II", chunk_addr, n))
+            cmd = f"-c read --addr 0x{chunk_addr:X} --len {n} {self._crc_opt(crc_val, '--crc')}{z_opt}"
             last_error = ""
 
             for attempt in range(max_retries + 1):
@@ -619,8 +1268,255 @@ class FPBProtocol:
             if progress_callback:
                 progress_callback(offset, length)
 
+        if z_opt and self._read_wire_bytes:
+            stats = lz.transfer_stats(length, self._read_wire_bytes)
+            return (
+                bytes(buf),
+                f"Read {length} bytes OK (ratio {stats['ratio']:.2f}, gain x{stats['gain']:.2f})",
+            )
         return bytes(buf), f"Read {length} bytes OK"
 
+    def _read_stream(
+        self, addr: int, length: int, progress_callback=None, max_retries: int = 3
+    ) -> Tuple[Optional[bytes], str]:
+        """Read any length with one "read --stream" request.
+
+        The response is parsed as it arrives, so progress follows the
+        SYNC markers. A SYNC mismatch or a stalled link re-requests the rest
+        from the last verified SYNC offset.
+        """
+        ser = self.device.ser
+        if not ser:
+            return None, "Serial port not connected"
+        self.try_enter_fl_mode()
+
+        buf = bytearray()
+        resumes = 0
+        start = time.time()
+        while len(buf) < length:
+            chunk_addr = addr + len(buf)
+            n = length - len(buf)
+            crc = self._request_crc(struct.pack("<II", chunk_addr, n))
+            cmd = (
+                f"-c read --addr 0x{chunk_addr:X} --len {n} --stream "
+                f"{self._crc_opt(crc, '--crc')}"
+            )
+            stream = _ReadStream(self.frame_mode_active(), crc, self._crc_update)
+            ser.reset_input_buffer()
+            self._pipeline_write(cmd)
+
+            verified = 0
+            last_rx = time.time()
+            while not stream.done:
+                if not ser.in_waiting:
+                    if time.time() - last_rx >= READ_STREAM_IDLE_TIMEOUT:
+                        stream.broken = stream.broken or "timeout"
+                        break
+                    time.sleep(0.0001)
+                    continue
+                stream.feed(ser.read(ser.in_waiting))
+                last_rx = time.time()
+                if progress_callback and len(stream.data) != verified:
+                    verified = len(stream.data)
+                    progress_callback(len(buf) + verified, length)
+
+            buf += stream.data
+            if stream.error:
+                self._log_raw(LogDirection.RX, f"[FLERR] {stream.error}")
+                return None, f"Read failed at 0x{chunk_addr:X}: {stream.error}"
+            if len(buf) >= length:
+                break
+            # Only attempts that verified nothing count against max_retries
+            resumes = 1 if stream.data else resumes + 1
+            reason = stream.broken or "incomplete response"
+            logger.warning(
+                f"read --stream resume {resumes}/{max_retries} at offset "
+                f"0x{len(buf):X}: {reason}"
+            )
+            if resumes > max_retries:
+                return None, f"Read failed at offset 0x{len(buf):X}: {reason}"
+
+        elapsed = time.time() - start
+        self._log_raw(LogDirection.RX, f"[FLOK] READ {length} bytes stream")
+        speed = length / elapsed / 1024 if elapsed > 0 else 0
+        return bytes(buf), f"Read {length} bytes OK (streamed, {speed:.1f} KB/s)"
+
+    @staticmethod
+    def _coalesce_ranges(ranges: List[Tuple[int, int]], limit: int) -> List[List[int]]:
+        """Merge overlapping or nearby ranges into sorted [start, end) spans.
+
+        Spans grow up to limit bytes; a single larger range stays one span.
+        """
+        spans = []
+        for addr, length in sorted(r for r in ranges if r[1] > 0):
+            end = addr + length
+            if spans and addr <= spans[-1][1] + READV_COALESCE_GAP:
+                start, last_end = spans[-1]
+                if end <= last_end or end - start <= limit:
+                    spans[-1][1] = max(last_end, end)
+                    continue
+            spans.append([addr, end])
+        return spans
+
+    def _readv(self, spans: List[List[int]], max_retries: int) -> Optional[bytes]:
+        """Read spans with one readv request, data concatenated in span order."""
+        base = spans[0][0]
+        ranges = b"".join(
+            _varint(a - prev) + _varint(e - a)
+            for (a, e), prev in zip(spans, [base] + [e for _, e in spans])
+        )
+        prefix = struct.pack("<II", base, len(ranges)) + ranges
+        crc_val = self._request_crc(prefix)
+        b64 = base64.b64encode(ranges).decode("ascii")
+        z_opt = " --z" if self.caps & CAP_LZ else ""
+        cmd = (
+            f"-c readv --addr 0x{base:X} --data {b64} "
+            f"{self._crc_opt(crc_val, '--crc')}{z_opt}"
+        )
+        for attempt in range(max_retries + 1):
+            if attempt > 0:
+                logger.warning(f"readv retry {attempt}/{max_retries} at 0x{base:X}")
+            try:
+                data = self._parse_read_response(
+                    self.send_cmd(cmd, timeout=2.0), crc_prefix=prefix
+                )
+                if data is not None:
+                    return data
+            except Exception as e:
+                logger.warning(f"readv exception at 0x{base:X}: {e}")
+        return None
+
+    def read_memory_multi(
+        self, ranges: List[Tuple[int, int]], max_retries: int = 3
+    ) -> Tuple[Optional[List[bytes]], str]:
+        """Read several (addr, length) ranges in as few round trips as possible.
+
+        Nearby ranges are coalesced into spans. With CAP_READV the spans go
+        out as "readv" requests, each filling at most one device transfer
+        buffer; larger spans (or all spans without CAP_READV) use read_memory.
+        Returns (data per range, message) on success, (None, error_msg) on
+        failure.
+        """
+        budget = (
+            self.device.download_chunk_size
+            if self.device.download_chunk_size > 0
+            else 1024
+        )
+        # The range list travels as --data: keep it within one upload chunk
+        list_budget = (
+            self.device.upload_chunk_size
+            if self.device.upload_chunk_size > 0
+            else 128
+        )
+        spans = self._coalesce_ranges(ranges, budget)
+
+        # Pack spans into readv requests; oversized spans are read alone.
+        # Group: [spans, data bytes, list bytes]
+        groups, direct = [], []
+        for span in spans:
+            size = span[1] - span[0]
+            if not self.caps & CAP_READV or size > budget:
+                direct.append(span)
+                continue
+            gap = span[0] - groups[-1][0][-1][1] if groups else 0
+            entry = len(_varint(gap)) + len(_varint(size))
+            if (
+                not groups
+                or groups[-1][1] + size > budget
+                or groups[-1][2] + entry > list_budget
+            ):
+                groups.append([[], 0, 0])
+                entry = 1 + len(_varint(size))  # First range: gap 0 from --addr
+            groups[-1][0].append(span)
+            groups[-1][1] += size
+            groups[-1][2] += entry
+
+        span_data = {}
+        for group, _, _ in groups:
+            data = self._readv(group, max_retries)
+            if data is None:
+                return None, f"readv failed at 0x{group[0][0]:X}"
+            pos = 0
+            for start, end in group:
+                span_data[start] = data[pos : pos + end - start]
+                pos += end - start
+        for start, end in direct:
+            data, msg = self.read_memory(start, end - start, max_retries=max_retries)
+            if data is None:
+                return None, msg
+            span_data[start] = data
+        requests = len(groups) + sum(-(-(e - a) // budget) for a, e in direct)
+
+        out = []
+        starts = [a for a, _ in spans]
+        for addr, length in ranges:
+            if length <= 0:
+                out.append(b"")
+                continue
+            start = starts[bisect.bisect_right(starts, addr) - 1]
+            out.append(span_data[start][addr - start : addr - start + length])
+        return out, f"Read {len(ranges)} ranges in {requests} requests"
+
+    def hash_blocks(
+        self, addr: int, length: int, block_size: int = HASH_BLOCK_SIZE
+    ) -> Tuple[Optional[List[int]], str]:
+        """Per-block CRCs of a device memory range (CAP_HASH).
+
+        Block CRCs use the negotiated width and start from the CRC init
+        value, so they match block_crc() of the same bytes. Large ranges
+        are split so each response fits the device transfer buffer.
+        Returns (crcs, message) on success, (None, error_msg) on failure.
+        """
+        width = 4 if self._crc32_mode() else 2
+        span = (HASH_MAX_BYTES // width) * block_size
+        crcs = []
+        offset = 0
+
+        while offset < length:
+            n = min(span, length - offset)
+            chunk_addr = addr + offset
+            crc_val = self._request_crc(struct.pack("<II", chunk_addr, n))
+            cmd = (
+                f"-c hash --addr 0x{chunk_addr:X} --len {n} --size {block_size} "
+                f"{self._crc_opt(crc_val, '--crc')}"
+            )
+            try:
+                resp = self.send_cmd(cmd, timeout=2.0)
+            except Exception as e:
+                return None, f"Hash exception at 0x{chunk_addr:X}: {e}"
+
+            match = re.search(
+                r"\[FLOK\]\s+HASH\s+(\d+)\s+blocks\s+bs=(\d+)\s+"
+                r"crc=0x([0-9A-Fa-f]+)\s+data=(\S+)",
+                resp,
+            )
+            if not match:
+                result = self.parse_response(resp)
+                return None, f"Hash failed at 0x{chunk_addr:X}: {result.get('msg')}"
+
+            blocks = int(match.group(1))
+            try:
+                raw = base64.b64decode(match.group(4))
+            except Exception:
+                return None, f"Hash response not base64 at 0x{chunk_addr:X}"
+            if len(raw) != blocks * width or blocks != -(-n // block_size):
+                return None, f"Hash length mismatch at 0x{chunk_addr:X}"
+            # Response CRC covers: addr(4B LE) + len(4B LE) + CRC array
+            if self._request_crc(struct.pack("<II", chunk_addr, n), raw) != int(
+                match.group(3), 16
+            ):
+                return None, f"Hash CRC mismatch at 0x{chunk_addr:X}"
+
+            fmt = "<I" if width == 4 else "<H"
+            crcs.extend(v for (v,) in struct.iter_unpack(fmt, raw))
+            offset += n
+
+        return crcs, f"Hashed {len(crcs)} blocks"
+
+    def block_crc(self, block: bytes) -> int:
+        """Host-side CRC of one block, comparable with hash_blocks()."""
+        return self._request_crc(b"", block)
+
     def write_memory(
         self, addr: int, data: bytes, progress_callback=None, max_retries: int = 3
     ) -> Tuple[bool, str]:
@@ -639,9 +1535,10 @@ class FPBProtocol:
             b64 = base64.b64encode(chunk).decode("ascii")
             chunk_addr = addr + offset
             # CRC covers: addr(4B LE) + len(4B LE) + data payload
-            crc_val = crc16_update(0xFFFF, struct.pack("<II", chunk_addr, len(chunk)))
-            crc_val = crc16_update(crc_val, chunk)
-            cmd = f"-c write --addr 0x{chunk_addr:X} --data {b64} --crc 0x{crc_val:04X}"
+            crc_val = self._request_crc(
+                struct.pack("<II", chunk_addr, len(chunk)), chunk
+            )
+            cmd = f"-c write --addr 0x{chunk_addr:X} --data {b64} {self._crc_opt(crc_val, '--crc')}"
             last_error = ""
 
             for attempt in range(max_retries + 1):
@@ -667,53 +1564,393 @@ class FPBProtocol:
             if progress_callback:
                 progress_callback(offset, total)
 
-        return True, f"Write {total} bytes OK"
+        verified, msg = self.verify_memory(addr, data) if total else (None, "")
+        if verified is False:
+            return False, f"Write verify failed: {msg}"
+        return True, f"Write {total} bytes OK" + (" (verified)" if verified else "")
 
-    def _patch_crc(self, comp: int, orig: int, target: int) -> int:
-        """Compute CRC for patch commands: comp(4B LE) + orig(4B LE) + target(4B LE)."""
-        return crc16_update(0xFFFF, struct.pack("<III", comp, orig, target))
+    # ========== On-device Memory Commands ==========
 
-    def patch(self, comp: int, orig: int, target: int) -> Tuple[bool, str]:
-        """Set FPB patch (direct mode)."""
+    @staticmethod
+    def _scan_timeout(length: int) -> float:
+        """Response timeout for a memory command over length bytes."""
+        # The device scans several MB/s: allow for large ranges
+        return 2.0 + length / 1e6
+
+    def mem_crc(self, addr: int, length: int) -> Tuple[Optional[int], str]:
+        """CRC-32 of a device memory range, computed on the device (CAP_MEMCRC)."""
         try:
-            crc_val = self._patch_crc(comp, orig, target)
-            cmd = f"-c patch --comp {comp} --orig 0x{orig:X} --target 0x{target:X} --crc 0x{crc_val:04X}"
-            resp = self.send_cmd(cmd)
+            resp = self.send_cmd(
+                f"-c memcrc --addr 0x{addr:X} --len {length}",
+                timeout=self._scan_timeout(length),
+            )
             result = self.parse_response(resp)
-            return result.get("ok", False), result.get("msg", "")
         except Exception as e:
-            return False, str(e)
+            return None, str(e)
+        msg = result.get("msg", "")
+        m = re.search(r"MEMCRC 0x([0-9A-Fa-f]+) len=(\d+) crc=0x([0-9A-Fa-f]+)", msg)
+        if not result.get("ok") or not m:
+            return None, msg or "memcrc failed"
+        if int(m.group(1), 16) != addr or int(m.group(2)) != length:
+            return None, f"memcrc answered for another range: {msg}"
+        return int(m.group(3), 16), ""
+
+    def mem_cmp(self, addr_a: int, addr_b: int, length: int) -> Tuple[bool, str]:
+        """Compare two device memory ranges on the device (CAP_MEMCRC)."""
+        return self._simple_cmd(
+            f"-c memcmp --addr 0x{addr_a:X} --target 0x{addr_b:X} --len {length}",
+            self._scan_timeout(length),
+        )
 
-    def tpatch(self, comp: int, orig: int, target: int) -> Tuple[bool, str]:
-        """Set trampoline patch."""
+    def mem_set(self, addr: int, length: int, value: int = 0) -> Tuple[bool, str]:
+        """Fill a device memory range with a byte value (CAP_MEMOPS)."""
+        return self._simple_cmd(
+            f"-c memset --addr 0x{addr:X} --len {length} --value {value & 0xFF}",
+            self._scan_timeout(length),
+        )
+
+    def mem_copy(self, src: int, dst: int, length: int) -> Tuple[bool, str]:
+        """Copy a device memory range, ranges may overlap (CAP_MEMOPS)."""
+        return self._simple_cmd(
+            f"-c memcpy --addr 0x{src:X} --target 0x{dst:X} --len {length}",
+            self._scan_timeout(length),
+        )
+
+    def mem_find(
+        self, addr: int, length: int, pattern: bytes
+    ) -> Tuple[Optional[int], str]:
+        """Address of the first occurrence of pattern in a device range (CAP_MEMOPS).
+
+        Returns (None, msg) when the pattern is not found or the command fails.
+        """
+        b64 = base64.b64encode(pattern).decode("ascii")
+        ok, msg = self._simple_cmd(
+            f"-c memfind --addr 0x{addr:X} --len {length} --data {b64}",
+            self._scan_timeout(length),
+        )
+        m = re.search(r"MEMFIND 0x([0-9A-Fa-f]+)", msg) if ok else None
+        if not m:
+            return None, msg or "memfind failed"
+        return int(m.group(1), 16), ""
+
+    def dump_supported(self) -> bool:
+        """True when the device can save memory to its filesystem (CAP_DUMP)."""
+        return bool(self.caps & CAP_DUMP)
+
+    def dump_memory(
+        self, addr: int, length: int, path: str, compress: bool = True
+    ) -> Tuple[Optional[dict], str]:
+        """Save a memory range to a file on the device with "dump".
+
+        With compress (and CAP_LZ) the file holds LZ records, see
+        utils.lz.unpack_dump(). The returned CRC-32 covers the raw range.
+        Returns (info, msg), info None on failure.
+        """
+        z_opt = " --z" if compress and self.caps & CAP_LZ else ""
+        ok, msg = self._simple_cmd(
+            f"-c dump --addr 0x{addr:X} --len {length} --path {path}{z_opt}",
+            2.0 + length / DUMP_WRITE_RATE,
+        )
+        m = (
+            re.search(
+                r"DUMP 0x([0-9A-Fa-f]+) len=(\d+) crc=0x([0-9A-Fa-f]+) "
+                r"size=(\d+)( z)? path=(\S+)",
+                msg,
+            )
+            if ok
+            else None
+        )
+        if not m:
+            return None, msg or "dump failed"
+        return {
+            "addr": int(m.group(1), 16),
+            "length": int(m.group(2)),
+            "crc": int(m.group(3), 16),
+            "size": int(m.group(4)),
+            "compressed": m.group(5) is not None,
+            "path": m.group(6),
+        }, msg
+
+    # ========== Variable Sampler ==========
+
+    def sample_supported(self) -> bool:
+        """True when the device can stream probe values (CAP_SAMPLE)."""
+        return bool(self.caps & CAP_SAMPLE)
+
+    def sample_start(
+        self, probes: List[Tuple[int, int]], period_us: int = 0
+    ) -> Tuple[Optional[dict], str]:
+        """Register (addr, size) probes and start the device sampler.
+
+        period_us 0 samples on every device loop pass. Records then arrive as
+        [FLSMP] lines between responses (see core.sample_stream).
+        Returns ({"probes", "period", "hz"}, msg), info None on failure.
+        """
+        ok, msg = self._simple_cmd("-c sample --mode clear")
+        if not ok:
+            return None, msg or "sample clear failed"
+        for addr, size in probes:
+            ok, msg = self._simple_cmd(
+                f"-c sample --mode add --addr 0x{addr:X} --len {size}"
+            )
+            if not ok:
+                return None, msg or "sample add failed"
+        ok, msg = self._simple_cmd(f"-c sample --mode start --value {int(period_us)}")
+        m = (
+            re.search(r"SAMPLE start probes=(\d+) period=(\d+) hz=(\d+)", msg)
+            if ok
+            else None
+        )
+        if not m:
+            return None, msg or "sample start failed"
+        return {
+            "probes": int(m.group(1)),
+            "period": int(m.group(2)),
+            "hz": int(m.group(3)),
+        }, msg
+
+    def sample_stop(self) -> Tuple[Optional[dict], str]:
+        """Stop the device sampler; returns ({"records", "dropped"}, msg)."""
+        ok, msg = self._simple_cmd("-c sample --mode stop")
+        m = re.search(r"SAMPLE stop records=(\d+) dropped=(\d+)", msg) if ok else None
+        if not m:
+            return None, msg or "sample stop failed"
+        return {"records": int(m.group(1)), "dropped": int(m.group(2))}, msg
+
+    # ========== PC-Sampling Profiler ==========
+
+    def prof_supported(self) -> bool:
+        """True when the device has a profiler sample timer (CAP_PROF)."""
+        return bool(self.caps & CAP_PROF)
+
+    def prof_start(self, hz: int = 0) -> Tuple[Optional[dict], str]:
+        """Clear the device profile and start sampling at hz (0 = device default).
+
+        Returns ({"hz", "slots"}, msg), info None on failure.
+        """
+        ok, msg = self._simple_cmd(f"-c prof --mode start --value {int(hz)}")
+        m = re.search(r"PROF start hz=(\d+) slots=(\d+)", msg) if ok else None
+        if not m:
+            return None, msg or "prof start failed"
+        return {"hz": int(m.group(1)), "slots": int(m.group(2))}, msg
+
+    def prof_stop(self) -> Tuple[Optional[int], str]:
+        """Stop sampling; returns (sample count, msg), None on failure."""
+        ok, msg = self._simple_cmd("-c prof --mode stop")
+        m = re.search(r"PROF stop samples=(\d+)", msg) if ok else None
+        if not m:
+            return None, msg or "prof stop failed"
+        return int(m.group(1)), msg
+
+    def prof_dump(self) -> Tuple[Optional[dict], str]:
+        """Read the device PC histogram with "prof --mode dump".
+
+        Returns ({"running", "hz", "samples", "overflow", "pcs"}, msg) where
+        pcs is a list of (pc, count), or (None, msg) on failure.
+        """
         try:
-            crc_val = self._patch_crc(comp, orig, target)
-            cmd = f"-c tpatch --comp {comp} --orig 0x{orig:X} --target 0x{target:X} --crc 0x{crc_val:04X}"
-            resp = self.send_cmd(cmd)
+            resp = self.send_cmd("-c prof --mode dump", timeout=5.0)
             result = self.parse_response(resp)
-            return result.get("ok", False), result.get("msg", "")
         except Exception as e:
-            return False, str(e)
+            return None, str(e)
+        msg = result.get("msg", "")
+        m = (
+            re.search(
+                r"PROF (running|stopped) hz=(\d+) samples=(\d+) overflow=(\d+)", msg
+            )
+            if result.get("ok")
+            else None
+        )
+        if not m:
+            return None, msg or "prof dump failed"
+        pcs = []
+        for line in result.get("raw", "").split("\n"):
+            pm = re.match(r"\s*0x([0-9A-Fa-f]{1,8}) (\d+)\s*$", line)
+            if pm:
+                pcs.append((int(pm.group(1), 16), int(pm.group(2))))
+        return {
+            "running": m.group(1) == "running",
+            "hz": int(m.group(2)),
+            "samples": int(m.group(3)),
+            "overflow": int(m.group(4)),
+            "pcs": pcs,
+        }, msg
+
+    def slot_stats_supported(self) -> bool:
+        """True when the device has instrumented trampolines (CAP_SLOTSTATS)."""
+        return bool(self.caps & CAP_SLOTSTATS)
+
+    def slot_stats(self) -> Tuple[Optional[Dict[int, dict]], str]:
+        """Read the trampoline counters with "slotstats".
+
+        Returns ({slot: {"calls", "timed", "avg", "max"}}, msg) for the slots
+        called since their tpatch, cycles in core clocks, or (None, msg).
+        """
+        try:
+            resp = self.send_cmd("-c slotstats")
+            result = self.parse_response(resp)
+        except Exception as e:
+            return None, str(e)
+        msg = result.get("msg", "")
+        if not result.get("ok") or not msg.startswith("SLOTSTATS"):
+            return None, msg or "slotstats failed"
+        stats = {}
+        for line in result.get("raw", "").split("\n"):
+            m = re.match(
+                r"\s*Slot\[(\d+)\]: calls=(\d+) timed=(\d+) avg=(\d+) max=(\d+)", line
+            )
+            if m:
+                calls, timed, avg, max_ = (int(g) for g in m.groups()[1:])
+                stats[int(m.group(1))] = {
+                    "calls": calls,
+                    "timed": timed,
+                    "avg": avg,
+                    "max": max_,
+                }
+        return stats, msg
+
+    def slot_stats_reset(self) -> Tuple[bool, str]:
+        """Zero the trampoline counters of every slot."""
+        return self._simple_cmd("-c slotstats --mode reset")
+
+    def verify_memory(self, addr: int, data: bytes) -> Tuple[Optional[bool], str]:
+        """Check device memory against data with one memcrc.
+
+        Returns (None, msg) when the device cannot checksum (no CAP_MEMCRC).
+        """
+        if not self.caps & CAP_MEMCRC:
+            return None, "memcrc not supported"
+        crc, msg = self.mem_crc(addr, len(data))
+        if crc is None:
+            return False, msg
+        expect = crc32(data)
+        if crc != expect:
+            return False, (
+                f"CRC 0x{crc:08X} != 0x{expect:08X} over 0x{addr:X}+{len(data)}"
+            )
+        return True, ""
+
+    def _crc32_mode(self) -> bool:
+        """CRCs are CRC-32 (with --crc32) when the device supports it."""
+        return bool(self.caps & CAP_CRC32)
+
+    def _request_crc(self, header: bytes, data: bytes = b"") -> int:
+        """CRC over a request header and payload, in the negotiated width."""
+        if self._crc32_mode():
+            return crc32_update(crc32_update(0, header), data)
+        return crc16_update(crc16_update(0xFFFF, header), data)
+
+    def _crc_update(self, crc: int, data: bytes) -> int:
+        """Continue a request/response CRC over more data."""
+        if self._crc32_mode():
+            return crc32_update(crc, data)
+        return crc16_update(crc, data)
+
+    def _crc_opt(self, crc: int, opt: str = "-r") -> str:
+        """Format the CRC option of a command, announcing CRC-32 with --crc32."""
+        if self._crc32_mode():
+            return f"--crc32 {opt} 0x{crc:08X}"
+        return f"{opt} 0x{crc:04X}"
 
-    def dpatch(self, comp: int, orig: int, target: int) -> Tuple[bool, str]:
-        """Set DebugMonitor patch."""
+    def _patch_crc(self, comp: int, orig: int, target: int) -> int:
+        """Compute CRC for patch commands: comp(4B LE) + orig(4B LE) + target(4B LE)."""
+        return self._request_crc(struct.pack("<III", comp, orig, target))
+
+    def patch_cmd(
+        self, name: str, comp: int, orig: int, target: int, stage: bool = False
+    ) -> str:
+        """Command string for patch/tpatch/dpatch, with its request CRC.
+
+        With stage, the device records the patch and arms it on commit().
+        """
+        crc_val = self._patch_crc(comp, orig, target)
+        return (
+            f"-c {name} --comp {comp} --orig 0x{orig:X} --target 0x{target:X} "
+            f"{self._crc_opt(crc_val, '--crc')}" + (" --stage" if stage else "")
+        )
+
+    def _simple_cmd(self, cmd: str, timeout: float = None) -> Tuple[bool, str]:
+        """Send a command, return (ok, msg)."""
         try:
-            crc_val = self._patch_crc(comp, orig, target)
-            cmd = f"-c dpatch --comp {comp} --orig 0x{orig:X} --target 0x{target:X} --crc 0x{crc_val:04X}"
-            resp = self.send_cmd(cmd)
+            if timeout is None:
+                resp = self.send_cmd(cmd)
+            else:
+                resp = self.send_cmd(cmd, timeout=timeout)
             result = self.parse_response(resp)
             return result.get("ok", False), result.get("msg", "")
         except Exception as e:
             return False, str(e)
 
+    def patch(
+        self, comp: int, orig: int, target: int, stage: bool = False
+    ) -> Tuple[bool, str]:
+        """Set FPB patch (direct mode)."""
+        return self._simple_cmd(self.patch_cmd("patch", comp, orig, target, stage))
+
+    def tpatch(
+        self, comp: int, orig: int, target: int, stage: bool = False
+    ) -> Tuple[bool, str]:
+        """Set trampoline patch."""
+        return self._simple_cmd(self.patch_cmd("tpatch", comp, orig, target, stage))
+
+    def dpatch(
+        self, comp: int, orig: int, target: int, stage: bool = False
+    ) -> Tuple[bool, str]:
+        """Set DebugMonitor patch."""
+        return self._simple_cmd(self.patch_cmd("dpatch", comp, orig, target, stage))
+
+    def retarget_supported(self) -> bool:
+        """True when live tpatch/dpatch slots can be retargeted (CAP_RETARGET)."""
+        return bool(self.caps & CAP_RETARGET)
+
+    def retarget_cmd(self, comp: int, orig: int, target: int, mode: str = "") -> str:
+        """Command string for retarget, with its request CRC.
+
+        mode ("tpatch"/"dpatch") makes the device refuse a slot armed another
+        way, so the caller can fall back to unpatch + patch.
+        """
+        crc_val = self._patch_crc(comp, orig, target)
+        return (
+            f"-c retarget --comp {comp} --orig 0x{orig:X} --target 0x{target:X} "
+            f"{self._crc_opt(crc_val, '--crc')}" + (f" --mode {mode}" if mode else "")
+        )
+
+    def retarget(
+        self, comp: int, orig: int, target: int, mode: str = ""
+    ) -> Tuple[bool, str]:
+        """Switch a live slot to the code in last_alloc, freeing the old code."""
+        return self._simple_cmd(self.retarget_cmd(comp, orig, target, mode))
+
+    def ipatch_supported(self) -> bool:
+        """True when single instructions can be patched in place (CAP_IPATCH)."""
+        return bool(self.caps & CAP_IPATCH)
+
+    def ipatch_cmd(self, comp: int, addr: int, insn: int, stage: bool = False) -> str:
+        """Command string for ipatch, with its request CRC.
+
+        insn is in objdump order: a 16-bit instruction, or the first
+        halfword in the upper 16 bits of a 32-bit one.
+        """
+        crc_val = self._patch_crc(comp, addr, insn)
+        return (
+            f"-c ipatch --comp {comp} --addr 0x{addr:X} --insn 0x{insn:X} "
+            f"{self._crc_opt(crc_val, '--crc')}" + (" --stage" if stage else "")
+        )
+
+    def ipatch(
+        self, comp: int, addr: int, insn: int, stage: bool = False
+    ) -> Tuple[bool, str]:
+        """Replace the instruction at addr (remap table, no trampoline or RAM code)."""
+        return self._simple_cmd(self.ipatch_cmd(comp, addr, insn, stage))
+
+    def unpatch_cmd(self, comp: int = 0, all: bool = False) -> str:
+        """Command string for unpatch."""
+        return "-c unpatch --all" if all else f"-c unpatch --comp {comp}"
+
     def unpatch(self, comp: int = 0, all: bool = False) -> Tuple[bool, str]:
         """Clear FPB patch."""
         try:
-            if all:
-                cmd = "-c unpatch --all"
-            else:
-                cmd = f"-c unpatch --comp {comp}"
-            resp = self.send_cmd(cmd)
+            resp = self.send_cmd(self.unpatch_cmd(comp, all))
             result = self.parse_response(resp)
             return result.get("ok", False), result.get("msg", "")
         except Exception as e:
@@ -735,6 +1972,82 @@ class FPBProtocol:
         except Exception as e:
             return False, str(e)
 
+    # ========== Staged Commit ==========
+
+    def stage_supported(self) -> bool:
+        """True when patch commands accept --stage (CAP_STAGE)."""
+        return bool(self.caps & CAP_STAGE)
+
+    def commit(self) -> Tuple[bool, str]:
+        """Arm every staged patch at once."""
+        return self._simple_cmd("-c commit")
+
+    def abort(self) -> Tuple[bool, str]:
+        """Discard every staged patch, freeing its code."""
+        return self._simple_cmd("-c abort")
+
+    # ========== Batch ==========
+
+    def batch_supported(self) -> bool:
+        """True when the device runs batch requests (CAP_BATCH)."""
+        return bool(self.caps & CAP_BATCH)
+
+    def _batch_records(self, cmds: List[str]) -> Optional[bytes]:
+        """Pack commands into batch records, None if one has no frame encoding."""
+        records = []
+        for cmd in cmds:
+            record = serial_frame.batch_record(cmd)
+            if record is None:
+                return None
+            records.append(record)
+        return b"".join(records)
+
+    def batch_fits(self, cmds: List[str]) -> bool:
+        """True if cmds can run as one batch request.
+
+        Records are bounded like one upload chunk (upload_chunk_size), which
+        the device receive buffer accepts on either transport.
+        """
+        if not self.batch_supported():
+            return False
+        records = self._batch_records(cmds)
+        limit = (
+            self.device.upload_chunk_size if self.device.upload_chunk_size > 0 else 128
+        )
+        return records is not None and len(records) <= limit
+
+    def batch(
+        self, cmds: List[str], timeout: float = 2.0
+    ) -> Tuple[bool, List[dict], str]:
+        """Run commands in one round trip (CAP_BATCH).
+
+        The device stops at the first failing command. Returns (ok, results,
+        msg): results holds the parsed response of each command that ran,
+        the failing one last; msg is the "BATCH done/total" summary, or why
+        the batch was rejected before running.
+        """
+        records = self._batch_records(cmds)
+        if records is None:
+            return False, [], "Command cannot be batched"
+        data = base64.b64encode(records).decode("ascii")
+        try:
+            resp = self.send_cmd(f"-c batch --data {data}", timeout=timeout)
+        except Exception as e:
+            return False, [], str(e)
+
+        # One [FLOK]/[FLERR] line per command, output lines before it included
+        results = []
+        lines = []
+        for line in resp.split("\n"):
+            lines.append(line)
+            if "[FLOK]" in line or "[FLERR]" in line:
+                results.append(self.parse_response("\n".join(lines)))
+                lines = []
+        if not results or not results[-1].get("msg", "").startswith("BATCH "):
+            return False, [], self.parse_response(resp).get("msg", "Batch failed")
+        summary = results.pop()
+        return summary["ok"], results, summary["msg"]
+
     def _probe_echo(self, test_size: int, timeout: float = 2.0) -> Dict:
         """Send an echo command of given size and verify CRC.
 
@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2025 - 2026 _VIFEXTech
+
+"""
+Single Thumb instructions for the device "ipatch" command.
+
+An instruction is passed around as one int in objdump order: a 16-bit
+instruction as is, a 32-bit one with its first halfword in the upper 16
+bits ("f1b0 0f01" -> 0xF1B00F01). It is given either as objdump-style hex
+or as one line of assembly, assembled at the patched address so that
+PC-relative branches and literal loads resolve as they will run.
+"""
+
+import os
+import re
+import subprocess
+import tempfile
+from typing import Optional, Tuple
+
+from utils.toolchain import get_subprocess_env, get_tool_path
+
+DEFAULT_CPU = "cortex-m4"
+
+_HEX_HALFWORDS = re.compile(r"^(?:0x)?([0-9a-fA-F]{4})(?:\s*([0-9a-fA-F]{4}))?$")
+
+
+def is_32bit(hw1: int) -> bool:
+    """True when hw1 is the first halfword of a 32-bit Thumb instruction."""
+    return (hw1 >> 11) >= 0x1D
+
+
+def insn_size(insn: int) -> int:
+    """Size in bytes of an instruction in objdump order."""
+    return 4 if insn > 0xFFFF else 2
+
+
+def parse_insn_hex(text: str) -> Optional[int]:
+    """Parse objdump-style hex ("2801", "f1b0 0f01", "0xF1B00F01").
+
+    Returns the instruction, or None if text is not hex or its width does
+    not match its first halfword.
+    """
+    match = _HEX_HALFWORDS.match(text.strip())
+    if not match:
+        return None
+    hw1 = int(match.group(1), 16)
+    if match.group(2) is None:
+        return None if is_32bit(hw1) else hw1
+    if not is_32bit(hw1):
+        return None
+    return (hw1 << 16) | int(match.group(2), 16)
+
+
+def insn_from_bytes(data: bytes) -> Optional[int]:
+    """Decode the single instruction in data (little-endian halfwords)."""
+    if len(data) < 2:
+        return None
+    hw1 = int.from_bytes(data[0:2], "little")
+    if not is_32bit(hw1):
+        return hw1 if len(data) == 2 else None
+    if len(data) != 4:
+        return None
+    return (hw1 << 16) | int.from_bytes(data[2:4], "little")
+
+
+def read_insn(data: bytes) -> Optional[int]:
+    """The instruction at the start of data (at least 4 bytes of code)."""
+    if len(data) < 4:
+        return None
+    hw1 = int.from_bytes(data[0:2], "little")
+    return insn_from_bytes(data[0:4] if is_32bit(hw1) else data[0:2])
+
+
+def assemble_insn(
+    text: str,
+    addr: int,
+    toolchain_path: Optional[str] = None,
+    elf_path: Optional[str] = None,
+    cpu: str = DEFAULT_CPU,
+) -> Tuple[Optional[int], str]:
+    """Assemble one instruction as located at addr.
+
+    text is objdump-style hex or one line of unified-syntax assembly. With
+    elf_path, branch targets may name firmware symbols.
+    Returns (insn, "") or (None, error).
+    """
+    insn = parse_insn_hex(text)
+    if insn is not None:
+        return insn, ""
+
+    line = text.strip()
+    if not line or "\n" in line or ";" in line:
+        return None, "Expected one instruction"
+
+    addr &= ~1
+    with tempfile.TemporaryDirectory() as tmpdir:
+        asm_file = os.path.join(tmpdir, "insn.s")
+        obj_file = os.path.join(tmpdir, "insn.o")
+        elf_file = os.path.join(tmpdir, "insn.elf")
+        bin_file = os.path.join(tmpdir, "insn.bin")
+        with open(asm_file, "w") as f:
+            f.write(f"\t.syntax unified\n\t.thumb\n\t.text\n\t{line}\n")
+
+        env = get_subprocess_env(toolchain_path)
+        link_cmd = [
+            get_tool_path("arm-none-eabi-ld", toolchain_path),
+            f"-Ttext=0x{addr:X}",
+            "-e",
+            "0",
+            "-o",
+            elf_file,
+            obj_file,
+        ]
+        if elf_path and os.path.exists(elf_path):
+            link_cmd.append(f"--just-symbols={elf_path}")
+        steps = [
+            (
+                "Assemble",
+                [
+                    get_tool_path("arm-none-eabi-as", toolchain_path),
+                    f"-mcpu={cpu}",
+                    "-mthumb",
+                    "-o",
+                    obj_file,
+                    asm_file,
+                ],
+            ),
+            ("Link", link_cmd),
+            (
+                "Objcopy",
+                [
+                    get_tool_path("arm-none-eabi-objcopy", toolchain_path),
+                    "-O",
+                    "binary",
+                    "-j",
+                    ".text",
+                    elf_file,
+                    bin_file,
+                ],
+            ),
+        ]
+        for name, cmd in steps:
+            try:
+                result = subprocess.run(
+                    cmd, capture_output=True, text=True, env=env, timeout=30
+                )
+            except (OSError, subprocess.TimeoutExpired) as e:
+                return None, f"{name} error: {e}"
+            if result.returncode != 0:
+                return None, f"{name} error:\n{result.stderr.strip()}"
+
+        with open(bin_file, "rb") as f:
+            data = f.read()
+
+    insn = insn_from_bytes(data)
+    if insn is None:
+        return None, f"'{line}' assembles to {len(data)} bytes, not one instruction"
+    return insn, ""
+
+
+def format_insn(insn: int) -> str:
+    """objdump-style hex of an instruction."""
+    if insn > 0xFFFF:
+        return f"{insn >> 16:04x} {insn & 0xFFFF:04x}"
+    return f"{insn:04x}"
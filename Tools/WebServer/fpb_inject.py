@@ -12,15 +12,31 @@ Provides injection operations based on fpb_loader.py but adapted for web server
 import logging
 import os
 import time
-from typing import Dict, Optional, Tuple
+from typing import Dict, List, Optional, Tuple
 
 from core import elf_utils
 from core import compiler as compiler_utils
-from core.serial_protocol import FPBProtocol, FPBProtocolError, Platform
+from core import thumb_asm
+from core.serial_protocol import (
+    CAP_BATCH,
+    CAP_STAGE,
+    CAP_CRC32,
+    CAP_HASH,
+    CAP_IPATCH,
+    CAP_RETARGET,
+    HASH_BLOCK_SIZE,
+    FPBProtocol,
+    FPBProtocolError,
+    Platform,
+)
+from utils import lz
 from utils.serial import scan_serial_ports, serial_open
 
 logger = logging.getLogger(__name__)
 
+# Patch modes whose slot can be retargeted, and the command that arms them
+_RETARGET_MODES = {"trampoline": "tpatch", "debugmon": "dpatch"}
+
 
 # Re-export for backward compatibility
 FPBInjectError = FPBProtocolError
@@ -84,6 +100,11 @@ class FPBInject:
         """Get detected platform type."""
         return self._protocol.get_platform()
 
+    @property
+    def device_caps(self) -> int:
+        """Capability bits reported by the last ping."""
+        return self._protocol.caps
+
     def exit_fl_mode(self, timeout: float = 1.0) -> bool:
         """Exit fl interactive mode."""
         return self._protocol.exit_fl_mode(timeout)
@@ -165,11 +186,38 @@ class FPBInject:
         info, error = self._protocol.info()
         if info:
             self._update_slot_state(info)
+            if self.slot_stats_supported():
+                # Trampoline call counters go with the slot they measure
+                stats, _ = self._protocol.slot_stats()
+                for slot in info["slots"]:
+                    if stats and slot.get("id") in stats:
+                        slot["stats"] = stats[slot["id"]]
         return info, error
 
-    def alloc(self, size: int) -> Tuple[Optional[int], str]:
-        """Allocate memory buffer."""
-        return self._protocol.alloc(size)
+    def alloc(
+        self, size: int, unpatch_comp: Optional[int] = None
+    ) -> Tuple[Optional[int], str]:
+        """Allocate memory buffer, clearing slot unpatch_comp first if given."""
+        return self._protocol.alloc(size, unpatch_comp)
+
+    def batch(self, cmds: List[str]) -> Tuple[bool, List[dict], str]:
+        """Run commands in one round trip (see FPBProtocol.batch)."""
+        return self._protocol.batch(cmds)
+
+    def _batch_supported(self) -> bool:
+        """True when the device runs batch requests."""
+        caps = self.device_caps
+        return isinstance(caps, int) and bool(caps & CAP_BATCH)
+
+    def _stage_supported(self) -> bool:
+        """True when patches can be staged and armed by one commit."""
+        caps = self.device_caps
+        return isinstance(caps, int) and bool(caps & CAP_STAGE)
+
+    def _retarget_supported(self) -> bool:
+        """True when a live tpatch/dpatch slot can switch to new code in place."""
+        caps = self.device_caps
+        return isinstance(caps, int) and bool(caps & CAP_RETARGET)
 
     def upload(
         self, data: bytes, start_offset: int = 0, progress_callback=None
@@ -177,17 +225,257 @@ class FPBInject:
         """Upload binary data in chunks."""
         return self._protocol.upload(data, start_offset, progress_callback)
 
-    def patch(self, comp: int, orig: int, target: int) -> Tuple[bool, str]:
+    def upload_delta(
+        self,
+        data: bytes,
+        base_addr: int,
+        start_offset: int = 0,
+        progress_callback=None,
+        then_cmd: Optional[str] = None,
+    ) -> Tuple[bool, dict]:
+        """Upload only the blocks that differ from device memory, rsync-style.
+
+        base_addr is where data lands (last_alloc + start_offset). After a
+        re-inject the allocator usually hands back the freed slot memory, so
+        it still holds the previous image: the device hashes it per block,
+        and only changed runs are uploaded. Runs closer than one block are
+        merged, since a round trip costs more than a block. Needs CRC-32
+        block hashes; otherwise this is a full upload.
+
+        then_cmd (e.g. the patch) runs once the data is in place. With batch
+        support it shares one round trip with the upload when both fit one
+        batch. Its (ok, msg) is returned as stats["then"].
+        """
+        start = time.time()
+        runs = self._delta_runs(data, base_addr)
+
+        if then_cmd:
+            batched = self._upload_batched(data, runs, start_offset, then_cmd, start)
+            if batched is not None:
+                if progress_callback and batched[0]:
+                    progress_callback(len(data), len(data))
+                return batched
+
+        if runs is None:
+            success, stats = self.upload(data, start_offset, progress_callback)
+        else:
+            success, stats = self._upload_runs(
+                data, runs, start_offset, progress_callback, start
+            )
+        if success and then_cmd:
+            try:
+                result = self._protocol.parse_response(
+                    self._protocol.send_cmd(then_cmd)
+                )
+                stats["then"] = (result.get("ok", False), result.get("msg", ""))
+            except Exception as e:
+                stats["then"] = (False, str(e))
+        return success, stats
+
+    def _delta_runs(self, data: bytes, base_addr: int) -> Optional[List[List[int]]]:
+        """Changed [start, end) runs versus device memory, None if not hashable."""
+        caps = self.device_caps
+        if (
+            not isinstance(caps, int)
+            or not caps & CAP_HASH
+            or not caps & CAP_CRC32
+            or len(data) < 2 * HASH_BLOCK_SIZE
+        ):
+            return None
+
+        crcs, msg = self._protocol.hash_blocks(base_addr, len(data))
+        if crcs is None:
+            logger.warning(f"Delta upload unavailable, full upload: {msg}")
+            return None
+
+        runs = []
+        for i, dev_crc in enumerate(crcs):
+            off = i * HASH_BLOCK_SIZE
+            block = data[off : off + HASH_BLOCK_SIZE]
+            if self._protocol.block_crc(block) == dev_crc:
+                continue
+            if runs and off - runs[-1][1] <= HASH_BLOCK_SIZE:
+                runs[-1][1] = off + len(block)
+            else:
+                runs.append([off, off + len(block)])
+        return runs
+
+    def _upload_runs(
+        self,
+        data: bytes,
+        runs: List[List[int]],
+        start_offset: int,
+        progress_callback,
+        start: float,
+    ) -> Tuple[bool, dict]:
+        """Upload the changed runs of data, one upload() per run."""
+        total = len(data)
+        changed = sum(end - off for off, end in runs)
+        done = total - changed
+        wire = 0
+        if progress_callback:
+            progress_callback(done, total)
+
+        for off, end in runs:
+            base = done
+            cb = None
+            if progress_callback:
+
+                def cb(n, _total, base=base):
+                    progress_callback(base + n, total)
+
+            success, res = self.upload(data[off:end], start_offset + off, cb)
+            if not success:
+                return False, res
+            wire += res.get("wire_bytes", end - off)
+            done += end - off
+
+        elapsed = time.time() - start
+        logger.info(
+            f"Delta upload: {changed}/{total} bytes in {len(runs)} run(s), "
+            f"{elapsed:.2f}s"
+        )
+        return True, {
+            "bytes": total,
+            "chunks": len(runs),
+            "time": elapsed,
+            "speed": total / elapsed if elapsed > 0 else 0,
+            "delta_bytes": changed,
+            "delta_runs": len(runs),
+            **lz.transfer_stats(total, wire),
+        }
+
+    def _upload_batched(
+        self,
+        data: bytes,
+        runs: Optional[List[List[int]]],
+        start_offset: int,
+        then_cmd: str,
+        start: float,
+    ) -> Optional[Tuple[bool, dict]]:
+        """Upload runs (all of data if None) and then_cmd as one batch.
+
+        Returns None when the device has no batch support or the commands
+        do not fit one batch request.
+        """
+        if not self._batch_supported():
+            return None
+        if runs is None:
+            runs = [[0, len(data)]]
+
+        cmds = []
+        wire = 0
+        for off, end in runs:
+            run_cmds, run_wire = self._protocol.upload_commands(
+                data[off:end], start_offset + off
+            )
+            cmds += run_cmds
+            wire += run_wire
+        cmds.append(then_cmd)
+        if not self._protocol.batch_fits(cmds):
+            return None
+
+        ok, results, msg = self._protocol.batch(cmds)
+        if len(results) < len(cmds):
+            # Stopped (or rejected) before then_cmd: an upload failed
+            err = results[-1].get("msg") if results else msg
+            return False, {"error": f"Upload failed: {err}"}
+
+        total = len(data)
+        changed = sum(end - off for off, end in runs)
+        elapsed = time.time() - start
+        logger.info(
+            f"Batched upload: {changed}/{total} bytes in {len(runs)} run(s) "
+            f"+ 1 command, {elapsed:.2f}s"
+        )
+        last = results[-1]
+        return True, {
+            "bytes": total,
+            "chunks": len(cmds) - 1,
+            "time": elapsed,
+            "speed": total / elapsed if elapsed > 0 else 0,
+            "delta_bytes": changed,
+            "delta_runs": len(runs),
+            "then": (last.get("ok", False), last.get("msg", "")),
+            **lz.transfer_stats(total, wire),
+        }
+
+    def patch(
+        self, comp: int, orig: int, target: int, stage: bool = False
+    ) -> Tuple[bool, str]:
         """Set FPB patch (direct mode)."""
-        return self._protocol.patch(comp, orig, target)
+        return self._protocol.patch(comp, orig, target, stage)
 
-    def tpatch(self, comp: int, orig: int, target: int) -> Tuple[bool, str]:
+    def tpatch(
+        self, comp: int, orig: int, target: int, stage: bool = False
+    ) -> Tuple[bool, str]:
         """Set trampoline patch."""
-        return self._protocol.tpatch(comp, orig, target)
+        return self._protocol.tpatch(comp, orig, target, stage)
 
-    def dpatch(self, comp: int, orig: int, target: int) -> Tuple[bool, str]:
+    def dpatch(
+        self, comp: int, orig: int, target: int, stage: bool = False
+    ) -> Tuple[bool, str]:
         """Set DebugMonitor patch."""
-        return self._protocol.dpatch(comp, orig, target)
+        return self._protocol.dpatch(comp, orig, target, stage)
+
+    def retarget(
+        self, comp: int, orig: int, target: int, mode: str = ""
+    ) -> Tuple[bool, str]:
+        """Point a live tpatch/dpatch slot at newly uploaded code."""
+        return self._protocol.retarget(comp, orig, target, mode)
+
+    def ipatch_supported(self) -> bool:
+        """True when single instructions can be patched in place."""
+        caps = self.device_caps
+        return isinstance(caps, int) and bool(caps & CAP_IPATCH)
+
+    def ipatch(
+        self,
+        addr: int,
+        insn_text: str,
+        comp: int = -1,
+        stage: bool = False,
+        force: bool = False,
+    ) -> Tuple[bool, str]:
+        """Replace the instruction at addr through the remap table.
+
+        insn_text is objdump-style hex or one line of assembly, assembled at
+        addr. The replacement must be as wide as the instruction it replaces
+        (use .n/.w, or pad with a nop) unless force is set; the width of the
+        original is read from the device. comp -1 picks a slot.
+        """
+        addr &= ~1
+        elf_path = getattr(self.device, "elf_path", None)
+        insn, error = thumb_asm.assemble_insn(
+            insn_text, addr, self._toolchain_path, elf_path
+        )
+        if insn is None:
+            return False, error
+
+        if not force:
+            data, error = self.read_memory(addr, 4)
+            orig = thumb_asm.read_insn(data) if data else None
+            if orig is None:
+                return False, f"Cannot read instruction at 0x{addr:08X}: {error}"
+            if thumb_asm.insn_size(orig) != thumb_asm.insn_size(insn):
+                return False, (
+                    f"Width mismatch at 0x{addr:08X}: "
+                    f"{thumb_asm.format_insn(orig)} -> {thumb_asm.format_insn(insn)}"
+                )
+
+        if comp < 0:
+            comp, _ = self.find_slot_for_target(addr)
+            if comp < 0:
+                return False, "No free slot"
+        return self._protocol.ipatch(comp, addr, insn, stage)
+
+    def commit(self) -> Tuple[bool, str]:
+        """Arm all staged patches at once."""
+        return self._protocol.commit()
+
+    def abort(self) -> Tuple[bool, str]:
+        """Discard all staged patches."""
+        return self._protocol.abort()
 
     def unpatch(self, comp: int = 0, all: bool = False) -> Tuple[bool, str]:
         """Clear FPB patch."""
@@ -199,13 +487,20 @@ class FPBInject:
         """Enable or disable FPB patch without clearing it."""
         return self._protocol.enable_patch(comp, enable, all)
 
-    def find_slot_for_target(self, target_addr: int) -> Tuple[int, bool]:
+    def find_slot_for_target(
+        self,
+        target_addr: int,
+        reserved: Tuple[int, ...] = (),
+        debugmon: bool = False,
+    ) -> Tuple[int, bool]:
         """
         Find a suitable slot for the target address.
 
         Strategy (B - Smart Reuse):
         1. If target_addr is already patched in some slot, reuse that slot
-        2. Otherwise find first empty slot
+        2. Otherwise find first empty slot not in reserved (staged slots).
+           Slots backed by DWT comparators only take DebugMonitor patches,
+           so they are skipped unless debugmon is set.
         3. If no empty slot, return -1
 
         Returns:
@@ -226,8 +521,8 @@ class FPBInject:
             if occupied:
                 if orig_addr == target_addr or orig_addr == (target_addr & ~1):
                     return slot_id, True
-            else:
-                if first_empty < 0:
+            elif first_empty < 0 and slot_id not in reserved:
+                if debugmon or not slot.get("debugmon_only", False):
                     first_empty = slot_id
 
         if first_empty >= 0:
@@ -335,12 +630,96 @@ class FPBInject:
         """Read memory from device."""
         return self._protocol.read_memory(addr, length, progress_callback)
 
+    def read_memory_multi(
+        self, ranges: List[Tuple[int, int]]
+    ) -> Tuple[Optional[List[bytes]], str]:
+        """Read several (addr, length) ranges, coalesced into few round trips."""
+        return self._protocol.read_memory_multi(ranges)
+
     def write_memory(
         self, addr: int, data: bytes, progress_callback=None
     ) -> Tuple[bool, str]:
         """Write data to device memory."""
         return self._protocol.write_memory(addr, data, progress_callback)
 
+    def mem_crc(self, addr: int, length: int) -> Tuple[Optional[int], str]:
+        """CRC-32 of a device memory range, computed on the device."""
+        return self._protocol.mem_crc(addr, length)
+
+    def mem_cmp(self, addr_a: int, addr_b: int, length: int) -> Tuple[bool, str]:
+        """Compare two device memory ranges on the device."""
+        return self._protocol.mem_cmp(addr_a, addr_b, length)
+
+    def verify_memory(self, addr: int, data: bytes) -> Tuple[Optional[bool], str]:
+        """Check device memory against data; None without device memcrc."""
+        return self._protocol.verify_memory(addr, data)
+
+    def mem_set(self, addr: int, length: int, value: int = 0) -> Tuple[bool, str]:
+        """Fill a device memory range with a byte value."""
+        return self._protocol.mem_set(addr, length, value)
+
+    def mem_copy(self, src: int, dst: int, length: int) -> Tuple[bool, str]:
+        """Copy a device memory range on the device."""
+        return self._protocol.mem_copy(src, dst, length)
+
+    def mem_find(
+        self, addr: int, length: int, pattern: bytes
+    ) -> Tuple[Optional[int], str]:
+        """Find a byte pattern in a device memory range."""
+        return self._protocol.mem_find(addr, length, pattern)
+
+    def dump_supported(self) -> bool:
+        """True when the device can save memory to its filesystem."""
+        return self._protocol.dump_supported()
+
+    def dump_memory(
+        self, addr: int, length: int, path: str, compress: bool = True
+    ) -> Tuple[Optional[dict], str]:
+        """Save a memory range to a file on the device."""
+        return self._protocol.dump_memory(addr, length, path, compress)
+
+    def sample_supported(self) -> bool:
+        """True when the device can stream probe values."""
+        return self._protocol.sample_supported()
+
+    def sample_start(
+        self, probes: List[Tuple[int, int]], period_us: int = 0
+    ) -> Tuple[Optional[dict], str]:
+        """Start the device sampler on (addr, size) probes."""
+        return self._protocol.sample_start(probes, period_us)
+
+    def sample_stop(self) -> Tuple[Optional[dict], str]:
+        """Stop the device sampler."""
+        return self._protocol.sample_stop()
+
+    def prof_supported(self) -> bool:
+        """True when the device can run the PC-sampling profiler."""
+        return self._protocol.prof_supported()
+
+    def prof_start(self, hz: int = 0) -> Tuple[Optional[dict], str]:
+        """Clear the device profile and start sampling."""
+        return self._protocol.prof_start(hz)
+
+    def prof_stop(self) -> Tuple[Optional[int], str]:
+        """Stop the profiler."""
+        return self._protocol.prof_stop()
+
+    def prof_dump(self) -> Tuple[Optional[dict], str]:
+        """Read the device PC histogram."""
+        return self._protocol.prof_dump()
+
+    def slot_stats_supported(self) -> bool:
+        """True when the device counts calls through its trampolines."""
+        return self._protocol.slot_stats_supported()
+
+    def slot_stats(self) -> Tuple[Optional[Dict[int, dict]], str]:
+        """Read per-slot trampoline call and cycle counters."""
+        return self._protocol.slot_stats()
+
+    def slot_stats_reset(self) -> Tuple[bool, str]:
+        """Zero the trampoline counters."""
+        return self._protocol.slot_stats_reset()
+
     # ========== Compiler Utilities ==========
 
     def parse_dep_file_for_compile_command(
@@ -409,7 +788,9 @@ class FPBInject:
         }
 
         if comp < 0:
-            slot_id, needs_unpatch = self.find_slot_for_target(target_addr)
+            slot_id, needs_unpatch = self.find_slot_for_target(
+                target_addr, debugmon=patch_mode == "debugmon"
+            )
             if slot_id < 0:
                 return False, {"error": "No available FPB slots"}
 
@@ -431,6 +812,8 @@ class FPBInject:
             return False, {"error": upload_result.get("error", "Upload failed")}
 
         result["upload_time"] = round(upload_result.get("time", 0), 2)
+        result["upload_ratio"] = round(upload_result.get("ratio", 1.0), 3)
+        result["upload_gain"] = round(upload_result.get("gain", 1.0), 2)
 
         patch_addr = inject_addr | 1
 
@@ -447,18 +830,23 @@ class FPBInject:
             )
             patch_mode = "debugmon"
 
-        if patch_mode == "trampoline":
-            success, msg = self.tpatch(comp, target_addr, patch_addr)
-        elif patch_mode == "debugmon":
-            success, msg = self.dpatch(comp, target_addr, patch_addr)
-        else:
-            success, msg = self.patch(comp, target_addr, patch_addr)
+        success, msg = self._arm_patch(patch_mode, comp, target_addr, patch_addr)
 
         if not success:
             return False, {"error": f"Patch failed: {msg}"}
 
         return True, result
 
+    def _arm_patch(
+        self, patch_mode: str, comp: int, orig: int, target: int, stage: bool = False
+    ) -> Tuple[bool, str]:
+        """Patch comp with the command of patch_mode."""
+        if patch_mode == "trampoline":
+            return self.tpatch(comp, orig, target, stage)
+        if patch_mode == "debugmon":
+            return self.dpatch(comp, orig, target, stage)
+        return self.patch(comp, orig, target, stage)
+
     def inject(
         self,
         source_content: str = None,
@@ -472,8 +860,15 @@ class FPBInject:
         source_file: str = None,
         inject_functions: list = None,
         inject_marker_lines: list = None,
+        stage: bool = False,
+        reserved_slots: Tuple[int, ...] = (),
     ) -> Tuple[bool, dict]:
-        """Perform full injection workflow."""
+        """Perform full injection workflow.
+
+        With stage, the patch is only staged on the device: commit() arms it
+        (replacing a live patch of the same target), abort() drops it. Slots
+        in reserved_slots (staged by earlier calls) are not picked.
+        """
         result = {
             "compile_time": 0,
             "upload_time": 0,
@@ -497,17 +892,34 @@ class FPBInject:
 
         result["target_addr"] = f"0x{target_addr:08X}"
 
+        # With batch support, unpatch + alloc and upload + patch each take
+        # one round trip
+        batch = self._batch_supported()
+        pending_unpatch = None
+        retarget = False
+
         actual_comp = comp
         if comp < 0:
-            slot_id, needs_unpatch = self.find_slot_for_target(target_addr)
+            slot_id, needs_unpatch = self.find_slot_for_target(
+                target_addr, reserved_slots, debugmon=patch_mode == "debugmon"
+            )
             if slot_id < 0:
                 return False, {"error": "No available FPB slots"}
 
-            if needs_unpatch:
-                logger.info(
-                    f"Reusing slot {slot_id} for target 0x{target_addr:08X}, unpatch first"
-                )
-                self.unpatch(comp=slot_id)
+            # A staged patch replaces the live one of this slot on commit
+            if needs_unpatch and not stage:
+                if patch_mode in _RETARGET_MODES and self._retarget_supported():
+                    # The live patch keeps running until retarget switches it
+                    logger.info(f"Retargeting slot {slot_id} to the new code")
+                    retarget = True
+                else:
+                    logger.info(
+                        f"Reusing slot {slot_id} for target 0x{target_addr:08X}, unpatch first"
+                    )
+                    if batch:
+                        pending_unpatch = slot_id
+                    else:
+                        self.unpatch(comp=slot_id)
 
             actual_comp = slot_id
 
@@ -536,7 +948,10 @@ class FPBInject:
         code_size = len(data)
         alloc_size = code_size + 8
 
-        raw_addr, error = self.alloc(alloc_size)
+        if pending_unpatch is not None:
+            raw_addr, error = self.alloc(alloc_size, unpatch_comp=pending_unpatch)
+        else:
+            raw_addr, error = self.alloc(alloc_size)
         if error or raw_addr is None:
             return False, {"error": f"Alloc failed: {error or 'No address returned'}"}
 
@@ -605,29 +1020,60 @@ class FPBInject:
         result["inject_func"] = found_inject_func[0]
         result["inject_addr"] = f"0x{found_inject_func[1]:08X}"
 
+        patch_addr = found_inject_func[1] | 1
+        patch_cmd = None
+        if retarget:
+            patch_cmd = self._protocol.retarget_cmd(
+                actual_comp, target_addr, patch_addr, _RETARGET_MODES[patch_mode]
+            )
+        elif batch:
+            patch_name = {"trampoline": "tpatch", "debugmon": "dpatch"}
+            patch_cmd = self._protocol.patch_cmd(
+                patch_name.get(patch_mode, "patch"),
+                actual_comp,
+                target_addr,
+                patch_addr,
+                stage,
+            )
+
         upload_start = align_offset
-        success, upload_result = self.upload(
-            data, start_offset=upload_start, progress_callback=progress_callback
+        success, upload_result = self.upload_delta(
+            data,
+            base_addr,
+            start_offset=upload_start,
+            progress_callback=progress_callback,
+            then_cmd=patch_cmd,
         )
         if not success:
             return False, {"error": upload_result.get("error", "Upload failed")}
 
         result["upload_time"] = round(upload_result.get("time", 0), 2)
+        result["upload_ratio"] = round(upload_result.get("ratio", 1.0), 3)
+        result["upload_gain"] = round(upload_result.get("gain", 1.0), 2)
+        result["delta_bytes"] = upload_result.get("delta_bytes", len(data))
 
-        patch_addr = found_inject_func[1] | 1
-
-        if patch_mode == "trampoline":
-            success, msg = self.tpatch(actual_comp, target_addr, patch_addr)
-        elif patch_mode == "debugmon":
-            success, msg = self.dpatch(actual_comp, target_addr, patch_addr)
+        if not patch_cmd:
+            success, msg = self._arm_patch(
+                patch_mode, actual_comp, target_addr, patch_addr, stage
+            )
         else:
-            success, msg = self.patch(actual_comp, target_addr, patch_addr)
+            success, msg = upload_result["then"]
+            if retarget and not success:
+                # Slot armed in another mode: replace it the slow way
+                logger.info(f"Retarget failed ({msg}), unpatch and patch instead")
+                self.unpatch(comp=actual_comp)
+                success, msg = self._arm_patch(
+                    patch_mode, actual_comp, target_addr, patch_addr
+                )
 
         if not success:
             return False, {"error": f"Patch failed: {msg}"}
 
         result["total_time"] = round(time.time() - total_start, 2)
         result["patch_mode"] = patch_mode
+        if stage:
+            result["staged"] = True
+            return True, result
 
         self.device.inject_active = True
         self.device.last_inject_target = target_func
@@ -655,6 +1101,10 @@ class FPBInject:
         1. Content mode (legacy): source_content contains the patch code.
         2. In-place mode: source_file + inject_functions for direct compilation.
 
+        When the device supports staging, every patch is staged and armed by
+        a single commit once all functions are uploaded, so the target never
+        runs with only part of the set patched; any failure drops the lot.
+
         Args:
             status_callback: Optional callback(event_dict) for per-function
                 status events.  Called with ``{"stage": ..., "index": ...,
@@ -730,6 +1180,8 @@ class FPBInject:
         total_compile_time = 0
         total_upload_time = 0
         total_code_size = 0
+        stage = self._stage_supported()
+        staged_slots = []
 
         for idx, (target_func, inject_func) in enumerate(injection_targets):
             logger.info(f"Injecting {target_func} -> {inject_func}")
@@ -756,6 +1208,8 @@ class FPBInject:
                 source_file=source_file,
                 inject_functions=inject_functions,
                 inject_marker_lines=inject_marker_lines,
+                stage=stage,
+                reserved_slots=tuple(staged_slots),
             )
 
             injection_entry = {
@@ -777,6 +1231,8 @@ class FPBInject:
                     f"Inject failed for {target_func}: {inj_result.get('error')}"
                 )
             else:
+                if stage:
+                    staged_slots.append(inj_result.get("slot", -1))
                 total_compile_time += inj_result.get("compile_time", 0)
                 total_upload_time += inj_result.get("upload_time", 0)
                 total_code_size += inj_result.get("code_size", 0)
@@ -786,6 +1242,9 @@ class FPBInject:
 
             result["injections"].append(injection_entry)
 
+        if staged_slots:
+            self._commit_staged(result, staged_slots)
+
         result["compile_time"] = round(total_compile_time, 2)
         result["upload_time"] = round(total_upload_time, 2)
         result["code_size"] = total_code_size
@@ -801,3 +1260,23 @@ class FPBInject:
             self.device.last_inject_time = time.time()
 
         return successful > 0, result
+
+    def _commit_staged(self, result: dict, staged_slots: List[int]):
+        """Arm the patches staged by inject_multi, or drop them all."""
+        if result["errors"]:
+            reason = "Aborted: another function failed"
+            self.abort()
+        else:
+            ok, msg = self.commit()
+            if ok:
+                logger.info(f"Committed {len(staged_slots)} staged patches")
+                return
+            # The device rolls a failed commit back: the live slots are unchanged
+            reason = f"Commit failed: {msg}"
+            result["errors"].append(reason)
+
+        logger.error(f"Staged patches dropped: {reason}")
+        for entry in result["injections"]:
+            if entry["success"]:
+                entry["success"] = False
+                entry["error"] = reason
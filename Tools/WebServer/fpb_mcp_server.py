@@ -558,7 +558,9 @@ def mem_write(
 def mem_dump(
     addr: str,
     length: int,
-    local_path: str,
+    local_path: Optional[str] = None,
+    device_path: Optional[str] = None,
+    fetch: bool = True,
     port: Optional[str] = None,
 ) -> dict:
     """Dump memory region to local binary file.
@@ -567,10 +569,117 @@ def mem_dump(
         addr: Memory address (hex string, e.g. "0x2001E000")
         length: Number of bytes to dump
         local_path: Destination path on local machine (e.g., "/tmp/mem.bin")
+        device_path: Snapshot to this file on the device first (e.g. "/sd/ram.bin"),
+            fast and consistent; needs a device filesystem
+        fetch: Download the device_path snapshot to local_path (False: leave it
+            on the device for file_download later)
+        port: Serial port (uses existing connection if omitted)
+    """
+    cli = _get_cli(port=port)
+    return _capture_cli_output(
+        cli.mem_dump, int(addr, 0), length, local_path, device_path, fetch
+    )
+
+
+@mcp.tool()
+def mem_set(
+    addr: str,
+    length: int,
+    value: int = 0,
+    port: Optional[str] = None,
+) -> dict:
+    """Fill a device memory region with a byte value, on the device.
+
+    Args:
+        addr: Memory address (hex string, e.g. "0x2001E000")
+        length: Number of bytes to fill
+        value: Fill byte (default: 0)
         port: Serial port (uses existing connection if omitted)
     """
     cli = _get_cli(port=port)
-    return _capture_cli_output(cli.mem_dump, int(addr, 0), length, local_path)
+    return _capture_cli_output(cli.mem_set, int(addr, 0), length, value)
+
+
+@mcp.tool()
+def mem_copy(
+    src: str,
+    dst: str,
+    length: int,
+    port: Optional[str] = None,
+) -> dict:
+    """Copy a device memory region on the device (ranges may overlap).
+
+    Args:
+        src: Source address (hex string, e.g. "0x2001E000")
+        dst: Destination address (hex string)
+        length: Number of bytes to copy
+        port: Serial port (uses existing connection if omitted)
+    """
+    cli = _get_cli(port=port)
+    return _capture_cli_output(cli.mem_copy, int(src, 0), int(dst, 0), length)
+
+
+@mcp.tool()
+def mem_find(
+    addr: str,
+    length: int,
+    pattern_hex: str,
+    port: Optional[str] = None,
+) -> dict:
+    """Find the first occurrence of a byte pattern in device memory.
+
+    Args:
+        addr: Start address (hex string, e.g. "0x2001E000")
+        length: Number of bytes to search
+        pattern_hex: Hex string of the bytes to find (e.g. "EFBEADDE")
+        port: Serial port (uses existing connection if omitted)
+    """
+    cli = _get_cli(port=port)
+    return _capture_cli_output(cli.mem_find, int(addr, 0), length, pattern_hex)
+
+
+
+@mcp.tool()
+def profile(
+    action: str = "dump",
+    hz: int = 0,
+    duration: float = 0.0,
+    limit: int = 20,
+    port: Optional[str] = None,
+    elf_path: Optional[str] = None,
+) -> dict:
+    """PC-sampling profiler: find where the device spends its CPU time.
+
+    Args:
+        action: "start" (clears the profile), "stop" or "dump" (flat profile)
+        hz: Sample rate for start (0 = device default)
+        duration: With start, sample this many seconds, then stop and dump
+        limit: Functions listed in the flat profile (0 = all)
+        port: Serial port (uses existing connection if omitted)
+        elf_path: ELF used to map sampled PCs to function names
+    """
+    cli = _get_cli(port=port, elf_path=elf_path)
+    return _capture_cli_output(cli.prof, action, hz, duration, limit)
+
+
+@mcp.tool()
+def slot_stats(
+    reset: bool = False,
+    port: Optional[str] = None,
+    elf_path: Optional[str] = None,
+) -> dict:
+    """Call and cycle counters of patched functions (trampoline mode).
+
+    Proves a tpatch replacement is being called and how long it takes.
+    Needs firmware built with FPB_TRAMPOLINE_STATS.
+
+    Args:
+        reset: Zero the counters of every slot instead of reading them
+        port: Serial port (uses existing connection if omitted)
+        elf_path: Path to ELF file
+    """
+    cli = _get_cli(port=port, elf_path=elf_path)
+    return _capture_cli_output(cli.slotstats, reset)
 
 
 if __name__ == "__main__":
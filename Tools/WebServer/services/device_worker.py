@@ -15,6 +15,7 @@ import queue
 import threading
 import time
 
+from core.sample_stream import SampleLineFilter
 from services.timer import TimerManager
 
 
@@ -29,6 +30,8 @@ class DeviceWorker:
         self._worker_thread = None
         self._worker_running = False
         self._timer_manager = None
+        self._sample_filter = None
+        self._sample_sink = None
         self._logger = logging.getLogger(__name__)
 
     def start(self):
@@ -101,6 +104,14 @@ class DeviceWorker:
         if self._wake_event is not None:
             self._wake_event.set()
 
+    def set_sample_sink(self, sink):
+        """Route [FLSMP] sampler lines to sink(payload) instead of the logs.
+
+        None restores plain logging. Call from the worker thread.
+        """
+        self._sample_sink = sink
+        self._sample_filter = SampleLineFilter() if sink else None
+
     def wait_for_data(self, timeout=1.0):
         """Wait for new serial data (for SSE)."""
         if self._data_event is None:
@@ -193,6 +204,12 @@ class DeviceWorker:
                 raw_data = ser.read(available)
                 if raw_data:
                     data_str = raw_data.decode(errors="replace")
+                    if self._sample_filter is not None:
+                        data_str, payloads = self._sample_filter.feed(data_str)
+                        for payload in payloads:
+                            self._sample_sink(payload)
+                        if not data_str:
+                            return
                     # Add to raw serial log for terminal display
                     self._add_raw_serial_log(data_str)
                     # Add formatted log entries
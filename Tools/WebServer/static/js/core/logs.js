@@ -128,9 +128,10 @@ function processLogData(data) {
         state.fpbVersion = data.slot_data.fpb_version;
       }
       if (data.slot_data.slots) {
+        state.slotCount = data.slot_data.slots.length;
         data.slot_data.slots.forEach((slot) => {
           const slotId = slot.id !== undefined ? slot.id : 0;
-          if (slotId < 8) {
+          if (slotId < state.slotStates.length) {
             state.slotStates[slotId] = {
               occupied: slot.occupied || false,
               enabled: slot.enabled !== undefined ? slot.enabled : true,
@@ -138,6 +139,7 @@ function processLogData(data) {
               orig_addr: slot.orig_addr || '',
               target_addr: slot.target_addr || '',
               code_size: slot.code_size || 0,
+              stats: slot.stats || null,
             };
           }
         });
@@ -5,18 +5,26 @@
 /* ===========================
    SLOT MANAGEMENT
    =========================== */
+// FPB comparators of this version, or more when DWT redirects are reported
+function getMaxSlots() {
+  const state = window.FPBState;
+  return Math.max(state.fpbVersion >= 2 ? 8 : 6, state.slotCount || 0);
+}
+
 function updateSlotUI() {
   const state = window.FPBState;
   let activeCount = 0;
-  const maxSlots = state.fpbVersion >= 2 ? 8 : 6;
+  const maxSlots = getMaxSlots();
 
-  for (let i = 0; i < 8; i++) {
+  for (let i = 0; i < state.slotStates.length; i++) {
     const slotItem = document.querySelector(`.slot-item[data-slot="${i}"]`);
     const funcSpan = document.getElementById(`slot${i}Func`);
     const slotState = state.slotStates[i];
     const isDisabled = i >= maxSlots;
 
     if (slotItem) {
+      // Slots past the FPBv2 comparators exist only when the device has them
+      slotItem.style.display = i >= 8 && isDisabled ? 'none' : '';
       slotItem.classList.toggle('occupied', slotState.occupied && !isDisabled);
       slotItem.classList.toggle(
         'active',
@@ -58,8 +66,19 @@ function updateSlotUI() {
           ? `, ${slotState.code_size} ${t('device.bytes', 'Bytes')}`
           : '';
         const enabledInfo = slotState.enabled ? '' : ' [OFF]';
-        funcSpan.textContent = `${slotState.orig_addr}${funcName} → ${slotState.target_addr}${sizeInfo}${enabledInfo}`;
+        const stats = slotState.stats;
+        let callsInfo = '';
+        if (stats) {
+          const calls = t('device.slot_calls', `${stats.calls} calls`, {
+            n: stats.calls,
+          });
+          callsInfo = `, ${calls}`;
+        }
+        funcSpan.textContent = `${slotState.orig_addr}${funcName} → ${slotState.target_addr}${sizeInfo}${callsInfo}${enabledInfo}`;
         funcSpan.title = `${t('tooltips.slot_original', 'Original')}: ${slotState.orig_addr}${funcName}\n${t('tooltips.slot_target', 'Target')}: ${slotState.target_addr}\n${t('tooltips.slot_code_size', 'Code size')}: ${slotState.code_size || 0} ${t('device.bytes', 'Bytes')}\n${t('tooltips.slot_status', 'Status')}: ${slotState.enabled ? 'ON' : 'OFF'}`;
+        if (stats) {
+          funcSpan.title += `\n${t('tooltips.slot_calls', 'Calls')}: ${stats.calls}\n${t('tooltips.slot_avg_cycles', 'Avg cycles')}: ${stats.avg}\n${t('tooltips.slot_max_cycles', 'Max cycles')}: ${stats.max}`;
+        }
       } else {
         funcSpan.textContent = state.isConnected
           ? t('panels.slot_empty', 'Empty')
@@ -92,12 +111,13 @@ function updateSlotUI() {
     const option = slotSelect.options[i];
     const slotId = parseInt(option.value);
     option.disabled = slotId >= maxSlots;
+    option.hidden = slotId >= 8 && slotId >= maxSlots;
   }
 }
 
 function selectSlot(slotId) {
   const state = window.FPBState;
-  const maxSlots = state.fpbVersion >= 2 ? 8 : 6;
+  const maxSlots = getMaxSlots();
 
   if (slotId >= maxSlots) {
     log.warn(`Slot ${slotId} requires FPB v2 hardware`);
@@ -191,7 +211,7 @@ async function fpbUnpatchAll() {
     const data = await res.json();
 
     if (data.success) {
-      state.slotStates = Array(8)
+      state.slotStates = Array(state.slotStates.length)
         .fill()
         .map(() => ({
           occupied: false,
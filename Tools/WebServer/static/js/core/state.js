@@ -17,7 +17,8 @@ let lastAutoInjectStatus = 'idle';
 let autoInjectProgressHideTimer = null;
 let selectedSlot = 0;
 let fpbVersion = 1; // 1=FPB v1 (6 slots), 2=FPB v2 (8 slots)
-let slotStates = Array(8)
+let slotCount = 0; // Slots reported by the device, incl. DWT redirects (0=unknown)
+let slotStates = Array(12) // FL_MAX_SLOTS
   .fill()
   .map(() => ({
     occupied: false,
@@ -129,6 +130,12 @@ window.FPBState = {
   set fpbVersion(v) {
     fpbVersion = v;
   },
+  get slotCount() {
+    return slotCount;
+  },
+  set slotCount(v) {
+    slotCount = v;
+  },
   get slotStates() {
     return slotStates;
   },
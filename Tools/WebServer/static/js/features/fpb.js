@@ -199,9 +199,10 @@ async function fpbInfo(showPopup = false) {
       }
 
       if (data.slots) {
+        state.slotCount = data.slots.length;
         data.slots.forEach((slot) => {
           const slotId = slot.id !== undefined ? slot.id : 0;
-          if (slotId < 8) {
+          if (slotId < state.slotStates.length) {
             state.slotStates[slotId] = {
               occupied: slot.occupied || false,
               enabled: slot.enabled !== undefined ? slot.enabled : true,
@@ -209,6 +210,7 @@ async function fpbInfo(showPopup = false) {
               orig_addr: slot.orig_addr || '',
               target_addr: slot.target_addr || '',
               code_size: slot.code_size || 0,
+              stats: slot.stats || null,
             };
           }
         });
@@ -407,8 +409,118 @@ async function fpbInjectMulti() {
   }
 }
 
+/* ===========================
+   PC-SAMPLING PROFILER
+   =========================== */
+const PROF_REFRESH_MS = 2000;
+let profRefreshTimer = null;
+
+function profStopRefresh() {
+  if (profRefreshTimer) {
+    clearInterval(profRefreshTimer);
+    profRefreshTimer = null;
+  }
+}
+
+async function fpbProfStart() {
+  const state = window.FPBState;
+  if (!state.isConnected) {
+    log.error('Not connected');
+    return;
+  }
+
+  try {
+    const res = await fetch('/api/fpb/prof/start', {
+      method: 'POST',
+      headers: { 'Content-Type': 'application/json' },
+      body: JSON.stringify({ hz: 0 }),
+    });
+    const data = await res.json();
+    if (!data.success) {
+      log.error(`Profiler start failed: ${data.error || 'Unknown error'}`);
+      return;
+    }
+    log.info(`Profiling at ${data.hz} Hz`);
+    profStopRefresh();
+    profRefreshTimer = setInterval(fpbProfRefresh, PROF_REFRESH_MS);
+  } catch (e) {
+    log.error(`Profiler start error: ${e}`);
+  }
+}
+
+async function fpbProfStop() {
+  profStopRefresh();
+  const state = window.FPBState;
+  if (!state.isConnected) return;
+
+  try {
+    const res = await fetch('/api/fpb/prof/stop', { method: 'POST' });
+    const data = await res.json();
+    if (!data.success) {
+      log.error(`Profiler stop failed: ${data.error || 'Unknown error'}`);
+      return;
+    }
+    log.info(`Profiler stopped, ${data.samples} samples`);
+    await fpbProfRefresh();
+  } catch (e) {
+    log.error(`Profiler stop error: ${e}`);
+  }
+}
+
+async function fpbProfRefresh() {
+  const state = window.FPBState;
+  if (!state.isConnected) {
+    profStopRefresh();
+    return;
+  }
+
+  try {
+    const res = await fetch('/api/fpb/prof?limit=30');
+    const data = await res.json();
+    if (!data.success) {
+      profStopRefresh();
+      log.error(`Profiler read failed: ${data.error || 'Unknown error'}`);
+      return;
+    }
+    if (!data.running) profStopRefresh();
+    renderProfile(data);
+  } catch (e) {
+    profStopRefresh();
+    log.error(`Profiler read error: ${e}`);
+  }
+}
+
+function renderProfile(data) {
+  const el = document.getElementById('profList');
+  if (!el) return;
+
+  const functions = data.functions || [];
+  if (!functions.length) {
+    el.innerHTML = `<div style="font-size: 10px; opacity: 0.7">${t('device.prof_empty', 'No samples')}</div>`;
+    return;
+  }
+
+  const overflow = data.overflow
+    ? `, ${data.overflow} ${t('device.prof_unbinned', 'unbinned')}`
+    : '';
+  let html = `<div style="font-size: 10px; color: var(--vscode-descriptionForeground); margin-bottom: 4px">${data.samples} ${t('device.prof_samples', 'samples')} @ ${data.hz} Hz${overflow}</div>`;
+  for (const f of functions) {
+    const pcs = (f.pcs || []).map(([pc, n]) => `${pc}: ${n}`).join('\n');
+    html +=
+      `<div style="display: flex; gap: 6px; font-size: 11px; font-family: var(--vscode-editor-font-family)" title="${escapeHtml(`${f.addr}\n${pcs}`)}">` +
+      `<span style="min-width: 44px; text-align: right">${f.percent.toFixed(1)}%</span>` +
+      `<span style="overflow: hidden; text-overflow: ellipsis; white-space: nowrap">${escapeHtml(f.name)}</span>` +
+      `</div>`;
+  }
+  el.innerHTML = html;
+}
+
 // Export for global access
 window.fpbPing = fpbPing;
 window.fpbTestSerial = fpbTestSerial;
 window.fpbInfo = fpbInfo;
 window.fpbInjectMulti = fpbInjectMulti;
+window.fpbProfStart = fpbProfStart;
+window.fpbProfStop = fpbProfStop;
+window.fpbProfRefresh = fpbProfRefresh;
+window.renderProfile = renderProfile;
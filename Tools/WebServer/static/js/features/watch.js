@@ -11,6 +11,13 @@ const _watchPrevValues = new Map(); // For value change highlighting
 const _watchExpandedState = new Map(); // Track expanded/collapsed state
 let _watchAutoRefreshInterval = 0;
 let _watchAutoRefreshTimer = null;
+let _watchLiveAbort = null; // Live sampling stream (auto-refresh "Live")
+const _watchLiveHistory = new Map(); // id -> [{t, hex}] of live samples
+
+// Live sampling: device sample period, redraw rate and history kept per watch
+const WATCH_LIVE_PERIOD_US = 1000;
+const WATCH_LIVE_RENDER_MS = 100;
+const WATCH_LIVE_HISTORY = 2000;
 
 const WATCH_STORAGE_KEY = 'fpbinject_watch_expressions';
 
@@ -87,6 +94,20 @@ async function watchEvaluate(expr, readDevice) {
   }
 }
 
+async function watchEvaluateBatch(exprs, readDevice) {
+  if (readDevice === undefined) readDevice = true;
+  try {
+    const res = await fetch('/api/watch_expr/evaluate_batch', {
+      method: 'POST',
+      headers: { 'Content-Type': 'application/json' },
+      body: JSON.stringify({ exprs: exprs, read_device: readDevice }),
+    });
+    return await res.json();
+  } catch (e) {
+    return { success: false, error: e.message };
+  }
+}
+
 async function watchDeref(addr, typeName, maxSize) {
   try {
     const res = await fetch('/api/watch_expr/deref', {
@@ -453,6 +474,10 @@ async function watchRenderAll() {
 
 async function watchRefreshOne(id, expr) {
   const data = await watchEvaluate(expr, true);
+  _watchApplyData(id, expr, data);
+}
+
+function _watchApplyData(id, expr, data) {
   const oldData = _watchDataCache.get(id);
 
   // Check for value changes and highlight
@@ -661,11 +686,22 @@ async function watchAddFromInput() {
 
 async function watchRefreshAll() {
   const listResult = await watchGetList();
-  if (!listResult.success) return;
+  if (!listResult.success || listResult.watches.length === 0) return;
 
-  for (const w of listResult.watches) {
-    await watchRefreshOne(w.id, w.expr);
+  // One request (and one coalesced device read) for the whole list
+  const batch = await watchEvaluateBatch(
+    listResult.watches.map((w) => w.expr),
+    true,
+  );
+  if (!batch.success) {
+    for (const w of listResult.watches) {
+      await watchRefreshOne(w.id, w.expr);
+    }
+    return;
   }
+  listResult.watches.forEach((w, i) => {
+    _watchApplyData(w.id, w.expr, batch.results[i]);
+  });
 }
 
 async function watchClearAll() {
@@ -682,6 +718,7 @@ async function watchClearAll() {
         : 'No watch expressions';
     panel.innerHTML = '<div class="watch-empty">' + noWatchesText + '</div>';
   }
+  watchStopLive();
   // Stop all auto-refresh timers
   for (const [id, timerId] of _watchAutoTimers) {
     clearInterval(timerId);
@@ -701,10 +738,14 @@ function watchSetAutoRefresh(intervalMs) {
     clearInterval(_watchAutoRefreshTimer);
     _watchAutoRefreshTimer = null;
   }
+  watchStopLive();
 
   _watchAutoRefreshInterval = intervalMs;
 
-  if (intervalMs > 0) {
+  if (intervalMs < 0) {
+    // "Live": values streamed by the device sampler instead of polling
+    watchStartLive();
+  } else if (intervalMs > 0) {
     _watchAutoRefreshTimer = setInterval(watchRefreshAll, intervalMs);
     if (typeof log !== 'undefined') {
       log.info(`Watch auto-refresh enabled: ${intervalMs}ms`);
@@ -720,6 +761,145 @@ function watchGetAutoRefreshInterval() {
   return _watchAutoRefreshInterval;
 }
 
+/* ===========================
+   LIVE SAMPLING
+   =========================== */
+
+async function watchStartLive(periodUs = WATCH_LIVE_PERIOD_US) {
+  watchStopLive();
+  const listResult = await watchGetList();
+  if (!listResult.success || listResult.watches.length === 0) return false;
+
+  let res;
+  try {
+    const response = await fetch('/api/watch_expr/sample/start', {
+      method: 'POST',
+      headers: { 'Content-Type': 'application/json' },
+      body: JSON.stringify({
+        exprs: listResult.watches.map((w) => w.expr),
+        period_us: periodUs,
+      }),
+    });
+    res = await response.json();
+  } catch (e) {
+    res = { success: false, error: e.message };
+  }
+  if (!res.success) {
+    if (typeof log !== 'undefined') {
+      log.warn(`Watch live sampling unavailable: ${res.error}`);
+    }
+    return false;
+  }
+
+  const byExpr = new Map(listResult.watches.map((w) => [w.expr, w]));
+  const probes = res.probes
+    .map((p) => ({ ...p, watch: byExpr.get(p.expr) }))
+    .filter((p) => p.watch);
+  _watchLiveHistory.clear();
+
+  const abortCtrl = new AbortController();
+  _watchLiveAbort = abortCtrl;
+  _watchLiveRun(probes, abortCtrl);
+
+  if (typeof log !== 'undefined') {
+    const skipped = res.skipped.length
+      ? ` (${res.skipped.map((s) => s.expr).join(', ')} not sampled)`
+      : '';
+    log.info(`Watch live sampling: ${probes.length} probes${skipped}`);
+  }
+  return true;
+}
+
+async function _watchLiveRun(probes, abortCtrl) {
+  // Samples arrive much faster than the panel can redraw: keep the history,
+  // render only the latest values
+  let latest = null;
+  const renderTimer = setInterval(() => {
+    if (latest) _watchLiveApply(probes, latest);
+    latest = null;
+  }, WATCH_LIVE_RENDER_MS);
+
+  try {
+    await consumeSSEStream(
+      '/api/watch_expr/sample/stream',
+      { method: 'GET' },
+      {
+        onOther: (data) => {
+          if (data.type !== 'samples' || data.samples.length === 0) return;
+          for (const sample of data.samples) _watchLiveRecord(probes, sample);
+          latest = data.samples[data.samples.length - 1];
+        },
+        onResult: (data) => {
+          if (!data.success && typeof log !== 'undefined') {
+            log.warn(`Watch live sampling stopped: ${data.error}`);
+          }
+        },
+      },
+      abortCtrl,
+    );
+  } catch (e) {
+    if (e.name !== 'AbortError' && typeof log !== 'undefined') {
+      log.warn(`Watch live sampling stream error: ${e.message}`);
+    }
+  } finally {
+    clearInterval(renderTimer);
+    if (latest) _watchLiveApply(probes, latest);
+    if (_watchLiveAbort === abortCtrl) _watchLiveAbort = null;
+  }
+}
+
+function _watchLiveRecord(probes, sample) {
+  for (const p of probes) {
+    const hex = sample.values[p.index];
+    if (hex === undefined) continue;
+    let history = _watchLiveHistory.get(p.watch.id);
+    if (!history) {
+      history = [];
+      _watchLiveHistory.set(p.watch.id, history);
+    }
+    history.push({ t: sample.time, hex });
+    if (history.length > WATCH_LIVE_HISTORY) history.shift();
+  }
+}
+
+function _watchLiveApply(probes, sample) {
+  for (const p of probes) {
+    const hex = sample.values[p.index];
+    if (hex === undefined) continue;
+    const cached = _watchDataCache.get(p.watch.id);
+    const base =
+      cached && cached.data && cached.data.success
+        ? cached.data
+        : {
+            success: true,
+            expr: p.expr,
+            addr: p.addr,
+            size: p.size,
+            type_name: p.type_name,
+            is_pointer: false,
+            is_aggregate: false,
+            struct_layout: null,
+          };
+    if (base.hex_data === hex) continue;
+    _watchApplyData(p.watch.id, p.watch.expr, {
+      ...base,
+      hex_data: hex,
+      source: 'device',
+    });
+  }
+}
+
+function watchStopLive() {
+  if (!_watchLiveAbort) return;
+  _watchLiveAbort.abort();
+  _watchLiveAbort = null;
+  fetch('/api/watch_expr/sample/stop', { method: 'POST' }).catch(() => {});
+}
+
+function watchGetLiveHistory(id) {
+  return _watchLiveHistory.get(id) || [];
+}
+
 /* ===========================
    COLLAPSE/EXPAND ALL
    =========================== */
@@ -785,6 +965,7 @@ function watchExpandAll() {
    EXPORTS
    =========================== */
 window.watchEvaluate = watchEvaluate;
+window.watchEvaluateBatch = watchEvaluateBatch;
 window.watchDeref = watchDeref;
 window.watchAdd = watchAdd;
 window.watchRemove = watchRemove;
@@ -801,6 +982,9 @@ window.watchToggleExpand = watchToggleExpand;
 window.watchDerefField = watchDerefField;
 window.watchSetAutoRefresh = watchSetAutoRefresh;
 window.watchGetAutoRefreshInterval = watchGetAutoRefreshInterval;
+window.watchStartLive = watchStartLive;
+window.watchStopLive = watchStopLive;
+window.watchGetLiveHistory = watchGetLiveHistory;
 window.watchCollapseAll = watchCollapseAll;
 window.watchExpandAll = watchExpandAll;
 window.watchRestoreFromStorage = watchRestoreFromStorage;
@@ -34,6 +34,7 @@ window.i18nResources['en'] = {
         watch_dirs: 'Watch Directories',
         upload_chunk_size: 'Upload Chunk Size',
         download_chunk_size: 'Download Chunk Size',
+        upload_window: 'Upload Window',
         serial_tx_fragment_size: 'TX Fragment',
         serial_tx_fragment_delay: 'TX Fragment Delay',
         transfer_max_retries: 'Max Retries',
@@ -167,6 +168,7 @@ window.i18nResources['en'] = {
       clear_all: 'Clear All',
       collapse_all: 'Collapse All',
       auto_off: 'Off',
+      auto_live: 'Live',
       no_watches: 'No watch expressions',
       add_tooltip: 'Add',
       refresh_tooltip: 'Refresh',
@@ -394,6 +396,13 @@ window.i18nResources['en'] = {
       fpb_v2_required: 'This slot requires FPB v2 hardware',
       bytes: 'Bytes',
       used: 'Used',
+      prof_start: 'Profile',
+      prof_stop: 'Stop',
+      prof_refresh: 'Refresh',
+      prof_empty: 'No samples',
+      prof_samples: 'samples',
+      prof_unbinned: 'unbinned',
+      slot_calls: '{{n}} calls',
     },
 
     // Tooltips
@@ -414,6 +423,9 @@ window.i18nResources['en'] = {
       reinject: 'Re-inject all cached files',
       clear_all: 'Clear all FPB slots',
       clear_slot: 'Clear slot',
+      prof_start: 'Sample the running PC to find hot functions',
+      prof_stop: 'Stop sampling and show the profile',
+      prof_refresh: 'Read the profile from the device',
       click_to_disable: 'Click to disable patch',
       click_to_enable: 'Click to enable patch',
       toggle_enable: 'Toggle patch enable/disable',
@@ -421,6 +433,9 @@ window.i18nResources['en'] = {
       slot_original: 'Original',
       slot_target: 'Target',
       slot_code_size: 'Code size',
+      slot_calls: 'Calls',
+      slot_avg_cycles: 'Avg cycles',
+      slot_max_cycles: 'Max cycles',
       // Terminal
       pause: 'Pause',
       resume: 'Resume',
@@ -452,6 +467,8 @@ window.i18nResources['en'] = {
         'Size of each uploaded data block. Smaller values are more stable but slower.',
       download_chunk_size:
         'Size of each downloaded data block. Larger values are faster.',
+      upload_window:
+        'Upload chunks kept in flight before waiting for acks. 1 = stop-and-wait.',
       serial_tx_fragment_size:
         'TX fragment size for serial commands (bytes). 0 = disabled. Workaround for slow serial drivers.',
       serial_tx_fragment_delay:
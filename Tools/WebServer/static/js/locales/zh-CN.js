@@ -34,6 +34,7 @@ window.i18nResources['zh-CN'] = {
         watch_dirs: '监视目录',
         upload_chunk_size: '上传块大小',
         download_chunk_size: '下载块大小',
+        upload_window: '上传窗口',
         serial_tx_fragment_size: '发送分片大小',
         serial_tx_fragment_delay: '发送分片延迟',
         transfer_max_retries: '最大重试次数',
@@ -167,6 +168,7 @@ window.i18nResources['zh-CN'] = {
       clear_all: '全部清除',
       collapse_all: '全部折叠',
       auto_off: '关闭',
+      auto_live: '实时',
       no_watches: '无监视表达式',
       add_tooltip: '添加',
       refresh_tooltip: '刷新',
@@ -388,6 +390,13 @@ window.i18nResources['zh-CN'] = {
       fpb_v2_required: '此补丁需要 FPB v2 硬件',
       bytes: '字节',
       used: '已用',
+      prof_start: '性能分析',
+      prof_stop: '停止',
+      prof_refresh: '刷新',
+      prof_empty: '无采样数据',
+      prof_samples: '个采样',
+      prof_unbinned: '未归类',
+      slot_calls: '{{n}} 次调用',
     },
 
     // 提示
@@ -408,6 +417,9 @@ window.i18nResources['zh-CN'] = {
       reinject: '重新注入所有缓存的文件',
       clear_all: '清除所有 FPB 槽位',
       clear_slot: '清除槽位',
+      prof_start: '采样运行中的 PC 以找出热点函数',
+      prof_stop: '停止采样并显示分析结果',
+      prof_refresh: '从设备读取分析结果',
       click_to_disable: '点击禁用补丁',
       click_to_enable: '点击启用补丁',
       toggle_enable: '切换补丁启用/禁用',
@@ -415,6 +427,9 @@ window.i18nResources['zh-CN'] = {
       slot_original: '劫持地址',
       slot_target: '跳转地址',
       slot_code_size: '代码大小',
+      slot_calls: '调用次数',
+      slot_avg_cycles: '平均周期',
+      slot_max_cycles: '最大周期',
       // 终端
       pause: '暂停',
       resume: '继续',
@@ -441,6 +456,7 @@ window.i18nResources['zh-CN'] = {
       watch_dirs: '监视文件变化的目录',
       upload_chunk_size: '每个上传数据块的大小。较小的值更稳定但更慢。',
       download_chunk_size: '每个下载数据块的大小。较大的值更快。',
+      upload_window: '等待确认前可同时发送的上传块数。1 = 逐块等待。',
       serial_tx_fragment_size:
         '串口命令的发送分片大小（字节）。0 = 禁用。用于解决慢速串口驱动问题。',
       serial_tx_fragment_delay:
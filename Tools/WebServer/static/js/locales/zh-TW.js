@@ -34,6 +34,7 @@ window.i18nResources['zh-TW'] = {
         watch_dirs: '監視目錄',
         upload_chunk_size: '上傳區塊大小',
         download_chunk_size: '下載區塊大小',
+        upload_window: '上傳視窗',
         serial_tx_fragment_size: '傳送分片大小',
         serial_tx_fragment_delay: '傳送分片延遲',
         transfer_max_retries: '最大重試次數',
@@ -167,6 +168,7 @@ window.i18nResources['zh-TW'] = {
       clear_all: '全部清除',
       collapse_all: '全部摺疊',
       auto_off: '關閉',
+      auto_live: '即時',
       no_watches: '無監視表達式',
       add_tooltip: '新增',
       refresh_tooltip: '重新整理',
@@ -388,6 +390,13 @@ window.i18nResources['zh-TW'] = {
       fpb_v2_required: '此補丁需要 FPB v2 硬體',
       bytes: '位元組',
       used: '已用',
+      prof_start: '效能分析',
+      prof_stop: '停止',
+      prof_refresh: '重新整理',
+      prof_empty: '無取樣資料',
+      prof_samples: '個取樣',
+      prof_unbinned: '未歸類',
+      slot_calls: '{{n}} 次呼叫',
     },
 
     // 提示
@@ -408,6 +417,9 @@ window.i18nResources['zh-TW'] = {
       reinject: '重新注入所有快取的檔案',
       clear_all: '清除所有 FPB 槽位',
       clear_slot: '清除槽位',
+      prof_start: '取樣執行中的 PC 以找出熱點函式',
+      prof_stop: '停止取樣並顯示分析結果',
+      prof_refresh: '從裝置讀取分析結果',
       click_to_disable: '點擊停用補丁',
       click_to_enable: '點擊啟用補丁',
       toggle_enable: '切換補丁啟用/停用',
@@ -415,6 +427,9 @@ window.i18nResources['zh-TW'] = {
       slot_original: '劫持地址',
       slot_target: '跳轉地址',
       slot_code_size: '程式碼大小',
+      slot_calls: '呼叫次數',
+      slot_avg_cycles: '平均週期',
+      slot_max_cycles: '最大週期',
       // 終端
       pause: '暫停',
       resume: '繼續',
@@ -441,6 +456,7 @@ window.i18nResources['zh-TW'] = {
       watch_dirs: '監視檔案變化的目錄',
       upload_chunk_size: '每個上傳資料區塊的大小。較小的值更穩定但更慢。',
       download_chunk_size: '每個下載資料區塊的大小。較大的值更快。',
+      upload_window: '等待確認前可同時傳送的上傳區塊數。1 = 逐區塊等待。',
       serial_tx_fragment_size:
         '串列埠命令的傳送分片大小（位元組）。0 = 停用。用於解決慢速串列埠驅動問題。',
       serial_tx_fragment_delay:
@@ -207,6 +207,8 @@ module.exports = function (w) {
       await w.fpbInfo();
       assertTrue(w.FPBState.slotStates[0].occupied);
       assertEqual(w.FPBState.slotStates[0].func, 'test_func');
+      assertEqual(w.FPBState.slotCount, 6);
+      w.FPBState.slotCount = 0;
       w.FPBState.toolTerminal = null;
       w.FPBState.isConnected = false;
     });
@@ -363,6 +365,80 @@ module.exports = function (w) {
     });
   });
 
+  describe('Profiler Functions (features/fpb.js)', () => {
+    const profile = {
+      success: true,
+      running: false,
+      hz: 997,
+      samples: 200,
+      overflow: 0,
+      functions: [
+        {
+          name: 'busy_loop',
+          addr: '0x08000100',
+          samples: 150,
+          percent: 75,
+          pcs: [['0x08000104', 150]],
+        },
+        {
+          name: 'operator<<',
+          addr: '0x08000200',
+          samples: 50,
+          percent: 25,
+          pcs: [],
+        },
+      ],
+    };
+
+    it('start posts to /api/fpb/prof/start', async () => {
+      resetMocks();
+      w.FPBState.isConnected = true;
+      setFetchResponse('/api/fpb/prof/start', { success: true, hz: 997 });
+      await w.fpbProfStart();
+      const call = getFetchCalls().find(
+        (c) => c.url === '/api/fpb/prof/start',
+      );
+      assertTrue(call !== undefined);
+      assertEqual(call.options.method, 'POST');
+      w.FPBState.isConnected = false;
+    });
+
+    it('start does nothing when not connected', async () => {
+      resetMocks();
+      w.FPBState.isConnected = false;
+      await w.fpbProfStart();
+      assertEqual(getFetchCalls().length, 0);
+    });
+
+    it('stop posts stop then reads the profile', async () => {
+      resetMocks();
+      w.FPBState.isConnected = true;
+      setFetchResponse('/api/fpb/prof/stop', { success: true, samples: 200 });
+      setFetchResponse('/api/fpb/prof?limit=30', profile);
+      await w.fpbProfStop();
+      const urls = getFetchCalls().map((c) => c.url);
+      assertEqual(urls[0], '/api/fpb/prof/stop');
+      assertEqual(urls[1], '/api/fpb/prof?limit=30');
+      const list = browserGlobals.document.getElementById('profList');
+      assertContains(list.innerHTML, 'busy_loop');
+      assertContains(list.innerHTML, '75.0%');
+      w.FPBState.isConnected = false;
+    });
+
+    it('renders escaped names and the sample count', () => {
+      w.renderProfile(profile);
+      const list = browserGlobals.document.getElementById('profList');
+      assertContains(list.innerHTML, 'operator&lt;&lt;');
+      assertContains(list.innerHTML, '200 samples @ 997 Hz');
+    });
+
+    it('renders an empty profile', () => {
+      w.renderProfile({ ...profile, samples: 0, functions: [] });
+      const list = browserGlobals.document.getElementById('profList');
+      assertContains(list.innerHTML, 'No samples');
+    });
+  });
+
   describe('fpbInjectMulti Function', () => {
     it('is async function', () =>
       assertTrue(w.fpbInjectMulti.constructor.name === 'AsyncFunction'));
@@ -447,6 +447,26 @@ module.exports = function (w) {
       assertTrue(funcSpan.textContent.includes('256'));
     });
 
+    it('shows trampoline call counters when present', () => {
+      w.FPBState.slotStates = Array(8)
+        .fill()
+        .map(() => ({ occupied: false }));
+      w.FPBState.slotStates[0] = {
+        occupied: true,
+        enabled: true,
+        func: 'hot_func',
+        orig_addr: '0x1000',
+        target_addr: '0x2000',
+        code_size: 64,
+        stats: { calls: 1234, timed: 1200, avg: 56, max: 90 },
+      };
+      w.updateSlotUI();
+      const funcSpan = browserGlobals.document.getElementById('slot0Func');
+      assertTrue(funcSpan.textContent.includes('1234 calls'));
+      assertTrue(funcSpan.title.includes('56'));
+      assertTrue(funcSpan.title.includes('90'));
+    });
+
     it('sets empty text for unoccupied slots', () => {
       w.FPBState.isConnected = true;
       w.FPBState.slotStates = Array(8)
@@ -667,6 +687,35 @@ module.exports = function (w) {
       w.FPBState.toolTerminal = null;
     });
 
+    it('counts DWT redirect slots the device reports', () => {
+      w.FPBState.fpbVersion = 1;
+      w.FPBState.slotCount = 10;
+      w.FPBState.slotStates = Array(12)
+        .fill()
+        .map((_, i) => ({ occupied: i === 9, func: i === 9 ? 'dwt' : '' }));
+      w.updateSlotUI();
+      const countEl = browserGlobals.document.getElementById('activeSlotCount');
+      assertEqual(countEl.textContent, '1/10');
+      w.FPBState.slotCount = 0;
+    });
+
+    it('selectSlot allows reported slots past 8', () => {
+      w.FPBState.fpbVersion = 2;
+      w.FPBState.slotCount = 12;
+      w.FPBState.selectedSlot = 0;
+      w.FPBState.toolTerminal = new MockTerminal();
+      w.FPBState.slotStates = Array(12)
+        .fill()
+        .map(() => ({ occupied: false }));
+      w.selectSlot(11);
+      assertEqual(w.FPBState.selectedSlot, 11);
+      w.FPBState.slotCount = 0;
+      w.selectSlot(0);
+      w.selectSlot(11);
+      assertEqual(w.FPBState.selectedSlot, 0);
+      w.FPBState.toolTerminal = null;
+    });
+
     it('fpbUnpatchAll resets to 8 slots', async () => {
       w.FPBState.isConnected = true;
       w.FPBState.fpbVersion = 2;
@@ -48,6 +48,12 @@ module.exports = function (w) {
       assertEqual(w.FPBState.fpbVersion, 2);
       w.FPBState.fpbVersion = 1;
     });
+    it('slotCount defaults to 0', () => assertEqual(w.FPBState.slotCount, 0));
+    it('can set slotCount', () => {
+      w.FPBState.slotCount = 10;
+      assertEqual(w.FPBState.slotCount, 10);
+      w.FPBState.slotCount = 0;
+    });
     it('can set currentTerminalTab', () => {
       w.FPBState.currentTerminalTab = 'raw';
       assertEqual(w.FPBState.currentTerminalTab, 'raw');
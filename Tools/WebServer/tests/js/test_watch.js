@@ -8,12 +8,19 @@ const {
   assertTrue,
   assertContains,
 } = require('./framework');
-const { resetMocks, setFetchResponse, browserGlobals } = require('./mocks');
+const {
+  resetMocks,
+  setFetchResponse,
+  getFetchCalls,
+  browserGlobals,
+} = require('./mocks');
 
 module.exports = function (w) {
   describe('Watch Module Exports', () => {
     it('watchEvaluate is a function', () =>
       assertTrue(typeof w.watchEvaluate === 'function'));
+    it('watchEvaluateBatch is a function', () =>
+      assertTrue(typeof w.watchEvaluateBatch === 'function'));
     it('watchDeref is a function', () =>
       assertTrue(typeof w.watchDeref === 'function'));
     it('watchAdd is a function', () =>
@@ -262,6 +269,33 @@ module.exports = function (w) {
     it('watchClearAll is async', () =>
       assertTrue(w.watchClearAll.constructor.name === 'AsyncFunction'));
 
+    it('watchRefreshAll evaluates the list in one batch request', async () => {
+      resetMocks();
+      setFetchResponse('/api/watch_expr/list', {
+        success: true,
+        watches: [
+          { id: 1, expr: 'g_a' },
+          { id: 2, expr: 'g_b' },
+        ],
+      });
+      setFetchResponse('/api/watch_expr/evaluate_batch', {
+        success: true,
+        results: [
+          { success: true, expr: 'g_a', hex_data: '01' },
+          { success: true, expr: 'g_b', hex_data: '02' },
+        ],
+      });
+      await w.watchRefreshAll();
+      const calls = getFetchCalls().map((c) => c.url);
+      assertTrue(calls.includes('/api/watch_expr/evaluate_batch'));
+      assertTrue(!calls.includes('/api/watch_expr/evaluate'));
+      const body = JSON.parse(
+        getFetchCalls().find((c) => c.url.includes('evaluate_batch')).options
+          .body,
+      );
+      assertEqual(body.exprs.length, 2);
+    });
+
     it('watchClearAll clears auto timers', async () => {
       w._watchAutoTimers.set(99, 12345);
       setFetchResponse('/api/watch_expr/clear', { success: true });
@@ -551,6 +585,74 @@ module.exports = function (w) {
     });
   });
 
+  describe('Live Sampling', () => {
+    const flush = async () => {
+      for (let i = 0; i < 50; i++) await Promise.resolve();
+    };
+
+    it('streams sampled values into the watch cache', async () => {
+      setFetchResponse('/api/watch_expr/list', {
+        success: true,
+        watches: [{ id: 77, expr: 'g_live' }],
+      });
+      setFetchResponse('/api/watch_expr/sample/start', {
+        success: true,
+        probes: [
+          {
+            expr: 'g_live',
+            index: 0,
+            addr: '0x20001000',
+            size: 4,
+            type_name: 'uint32_t',
+          },
+        ],
+        skipped: [],
+        period: 72000,
+        hz: 72000000,
+      });
+      setFetchResponse('/api/watch_expr/sample/stream', {
+        _stream: [
+          'data: {"type":"samples","lost":0,"samples":[' +
+            '{"seq":0,"ts":0,"time":0,"values":{"0":"01000000"}},' +
+            '{"seq":1,"ts":72,"time":0.001,"values":{"0":"02000000"}}]}\n\n',
+        ],
+      });
+      const started = await w.watchStartLive();
+      await flush();
+      assertTrue(started);
+      assertEqual(w._watchDataCache.get(77).data.hex_data, '02000000');
+      assertEqual(w._watchDataCache.get(77).data.type_name, 'uint32_t');
+      const history = w.watchGetLiveHistory(77);
+      assertEqual(history.length, 2);
+      assertEqual(history[1].t, 0.001);
+      const start = getFetchCalls().find((c) =>
+        c.url.includes('/api/watch_expr/sample/start'),
+      );
+      assertContains(start.options.body, '"period_us":1000');
+      w._watchDataCache.delete(77);
+    });
+
+    it('returns false when the device has no sampler', async () => {
+      setFetchResponse('/api/watch_expr/list', {
+        success: true,
+        watches: [{ id: 78, expr: 'g_live' }],
+      });
+      setFetchResponse('/api/watch_expr/sample/start', {
+        success: false,
+        error: 'Device has no sampler',
+      });
+      assertEqual(await w.watchStartLive(), false);
+      assertEqual(w.watchGetLiveHistory(78).length, 0);
+    });
+
+    it('is selected by a negative auto-refresh interval', () => {
+      w.watchSetAutoRefresh(-1);
+      assertEqual(w.watchGetAutoRefreshInterval(), -1);
+      w.watchSetAutoRefresh(0);
+      assertEqual(w.watchGetAutoRefreshInterval(), 0);
+    });
+  });
+
   describe('watchRenderAll Function', () => {
     it('is async function', () =>
       assertTrue(w.watchRenderAll.constructor.name === 'AsyncFunction'));
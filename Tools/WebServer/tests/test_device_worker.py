@@ -239,6 +239,30 @@ class TestSerialOperations(unittest.TestCase):
         # Should have log records
         self.assertTrue(len(self.device.serial_log) > 0)
 
+    def test_serial_read_sample_sink(self):
+        """[FLSMP] lines go to the sample sink, not the logs"""
+        type(self.mock_ser).in_waiting = PropertyMock(return_value=10)
+        self.device.raw_serial_log = []
+        self.device.raw_log_next_id = 0
+        self.device.raw_log_max_size = 1000
+        self.device.log_file_enabled = False
+        payloads = []
+        self.worker.set_sample_sink(payloads.append)
+
+        self.mock_ser.read.return_value = b"[FLSMP] AQID\nlog\n"
+        self.worker._process_serial_rx()
+        self.assertEqual(payloads, [b"\x01\x02\x03"])
+        self.assertEqual([e["data"] for e in self.device.serial_log], ["log\n"])
+
+        self.mock_ser.read.return_value = b"[FLSMP] BAUG\n"
+        self.worker._process_serial_rx()
+        self.assertEqual(len(self.device.raw_serial_log), 1)
+
+        self.worker.set_sample_sink(None)
+        self.worker._process_serial_rx()
+        self.assertEqual(len(payloads), 2)
+        self.assertEqual(len(self.device.serial_log), 2)
+
     def test_serial_log_overflow(self):
         """Test serial log overflow"""
         self.device.log_max_size = 5
@@ -10,6 +10,7 @@ Tests for core/file_transfer.py (unittest format)
 
 import base64
 import os
+import re
 import sys
 import unittest
 from unittest.mock import Mock
@@ -17,7 +18,8 @@ from unittest.mock import Mock
 sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
 
 from core.file_transfer import FileTransfer  # noqa: E402
-from utils.crc import crc16  # noqa: E402
+from utils import lz  # noqa: E402
+from utils.crc import crc16, crc32  # noqa: E402
 
 
 class TestCRC16(unittest.TestCase):
@@ -458,6 +460,119 @@ class TestFileTransferCRC(unittest.TestCase):
         self.assertEqual(crc_val, 0)
 
 
+class TestFileTransferCRC32(unittest.TestCase):
+    """Tests for CRC-32 mode (device reports CAP_CRC32)."""
+
+    def setUp(self):
+        """Set up mock FPB reporting CAP_CRC32."""
+        self.mock_fpb = Mock()
+        self.mock_fpb.device_caps = 0x8
+        self.mock_fpb.send_fl_cmd = Mock(return_value=(True, "[FLOK] Test"))
+        self.ft = FileTransfer(
+            self.mock_fpb, upload_chunk_size=256, download_chunk_size=256
+        )
+
+    def test_fwrite_crc32(self):
+        """fwrite sends --crc32 with a CRC-32 of the chunk."""
+        self.mock_fpb.send_fl_cmd.return_value = (True, "[FLOK] FWRITE 5 bytes")
+        success, _ = self.ft.fwrite(b"hello")
+        self.assertTrue(success)
+        cmd = self.mock_fpb.send_fl_cmd.call_args[0][0]
+        self.assertIn(f"--crc32 --crc 0x{crc32(b'hello'):08X}", cmd)
+
+    def test_fread_crc32(self):
+        """fread asks for and verifies a CRC-32."""
+        data = b"hello world"
+        b64_data = base64.b64encode(data).decode("ascii")
+        self.mock_fpb.send_fl_cmd.return_value = (
+            True,
+            f"[FLOK] FREAD {len(data)} bytes crc=0x{crc32(data):08X} data={b64_data}",
+        )
+        success, result, _ = self.ft.fread(256)
+        self.assertTrue(success)
+        self.assertEqual(result, data)
+        self.assertIn("--crc32", self.mock_fpb.send_fl_cmd.call_args[0][0])
+
+    def test_upload_verifies_file_crc32(self):
+        """Whole-file verification uses fcrc --crc32."""
+        data = b"x" * 300
+
+        def respond(cmd, **kwargs):
+            if "fcrc" in cmd:
+                self.assertIn("--crc32", cmd)
+                return True, f"[FLOK] FCRC size=300 crc=0x{crc32(data):08X}"
+            return True, "[FLOK] OK"
+
+        self.mock_fpb.send_fl_cmd.side_effect = respond
+        success, msg = self.ft.upload(data, "/data/x.bin")
+        self.assertTrue(success, msg)
+
+
+class TestFileTransferLZ(unittest.TestCase):
+    """Tests for --z transfers (device reports CAP_LZ)."""
+
+    def setUp(self):
+        """Set up mock FPB reporting CAP_LZ."""
+        self.mock_fpb = Mock()
+        self.mock_fpb.device_caps = 0x10
+        self.mock_fpb.send_fl_cmd = Mock(return_value=(True, "[FLOK] FWRITE"))
+        self.ft = FileTransfer(
+            self.mock_fpb, upload_chunk_size=256, download_chunk_size=256
+        )
+
+    def test_fwrite_compressed(self):
+        """Compressible chunks are sent with --z, CRC over the raw bytes."""
+        data = bytes(256)
+        success, _ = self.ft.fwrite(data)
+        self.assertTrue(success)
+        cmd = self.mock_fpb.send_fl_cmd.call_args[0][0]
+        m = re.search(r"--data (\S+) --z --crc (\d+)", cmd)
+        self.assertIsNotNone(m)
+        self.assertEqual(lz.decompress(base64.b64decode(m.group(1))), data)
+        self.assertEqual(int(m.group(2)), crc16(data))
+
+        stats = self.ft.get_stats()
+        self.assertEqual(stats["raw_bytes"], 256)
+        self.assertLess(stats["compression_ratio"], 0.1)
+        self.assertGreater(stats["compression_gain"], 10)
+
+    def test_fwrite_incompressible_raw(self):
+        """Chunks that do not shrink are sent without --z."""
+        data = b"hello"
+        self.ft.fwrite(data)
+        cmd = self.mock_fpb.send_fl_cmd.call_args[0][0]
+        self.assertNotIn("--z", cmd)
+        self.assertIn(base64.b64encode(data).decode("ascii"), cmd)
+        self.assertEqual(self.ft.get_stats()["compression_ratio"], 1.0)
+
+    def test_fread_compressed(self):
+        """fread asks for --z and inflates z= responses."""
+        data = b"\x00" * 200 + b"tail"
+        packed = lz.compress(data)
+        b64_data = base64.b64encode(packed).decode("ascii")
+        self.mock_fpb.send_fl_cmd.return_value = (
+            True,
+            f"[FLOK] FREAD {len(data)} bytes crc=0x{crc16(data):04X} "
+            f"z={len(packed)} data={b64_data}",
+        )
+        success, result, _ = self.ft.fread(256)
+        self.assertTrue(success)
+        self.assertEqual(result, data)
+        self.assertIn("--z", self.mock_fpb.send_fl_cmd.call_args[0][0])
+        self.assertEqual(self.ft.stats["wire_bytes"], len(packed))
+
+    def test_fread_bad_block_retried(self):
+        """A z= payload that does not inflate counts as an error."""
+        self.mock_fpb.send_fl_cmd.return_value = (
+            True,
+            "[FLOK] FREAD 4 bytes crc=0x0000 z=1 data=8A==",
+        )
+        success, _, msg = self.ft.fread(4, max_retries=1)
+        self.assertFalse(success)
+        self.assertIn("Decompress", msg)
+        self.assertEqual(self.ft.stats["other_errors"], 1)
+
+
 class TestFileTransferUpload(unittest.TestCase):
     """Tests for FileTransfer upload operations."""
 
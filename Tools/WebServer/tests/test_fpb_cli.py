@@ -6,6 +6,7 @@ Test cases for fpb_cli.py - Comprehensive test suite
 import io
 import json
 import os
+import struct
 import subprocess
 import sys
 import tempfile
@@ -1840,6 +1841,159 @@ class TestFPBCLIClass(unittest.TestCase):
             data = json.loads(output)
             self.assertFalse(data["success"])
 
+    def _mem_dump_on_device(self, fetch, downloaded):
+        from utils.crc import crc32
+
+        mem = bytes(range(256)) * 4
+        self.cli._device_state.connected = True
+        fpb = self.cli._fpb
+        info = {"size": 300, "crc": crc32(mem), "compressed": True}
+        with patch.object(fpb, "enter_fl_mode"), patch.object(
+            fpb, "exit_fl_mode"
+        ), patch.object(fpb, "dump_supported", return_value=True), patch.object(
+            fpb, "dump_memory", return_value=(info, "")
+        ) as dump, patch(
+            "core.file_transfer.FileTransfer.download",
+            return_value=(True, downloaded(mem), "ok"),
+        ) as download, tempfile.TemporaryDirectory() as tmp, patch(
+            "sys.stdout", new_callable=io.StringIO
+        ) as mock_stdout:
+            out = os.path.join(tmp, "ram.bin")
+            self.cli.mem_dump(0x20000000, len(mem), out, "/sd/ram.bin", fetch)
+            saved = open(out, "rb").read() if os.path.exists(out) else None
+        dump.assert_called_once_with(0x20000000, len(mem), "/sd/ram.bin")
+        return json.loads(mock_stdout.getvalue()), download, saved, mem
+
+    def test_mem_dump_on_device(self):
+        """mem_dump --device-path snapshots on the device, then fetches and inflates"""
+        from utils import lz
+
+        def records(mem):
+            block = lz.compress(mem)
+            return struct.pack("<HH", len(mem), len(block)) + block
+
+        data, download, saved, mem = self._mem_dump_on_device(True, records)
+        self.assertTrue(data["success"])
+        self.assertTrue(data["verified"])
+        download.assert_called_once_with("/sd/ram.bin")
+        self.assertEqual(saved, mem)
+
+        # A fetched file that does not match the snapshot CRC fails
+        data, _, _, _ = self._mem_dump_on_device(True, lambda mem: b"")
+        self.assertFalse(data["success"])
+
+        # Without fetch the snapshot stays on the device
+        data, download, saved, _ = self._mem_dump_on_device(False, records)
+        self.assertTrue(data["success"])
+        self.assertEqual(data["device_path"], "/sd/ram.bin")
+        download.assert_not_called()
+        self.assertIsNone(saved)
+
+
+    def test_prof_start_duration_dumps_flat_profile(self):
+        """prof start --duration samples, stops and maps PCs to functions"""
+        self.cli._device_state.connected = True
+        self.cli._device_state.elf_path = __file__
+        fpb = self.cli._fpb
+        dump = {
+            "running": False,
+            "hz": 997,
+            "samples": 4,
+            "overflow": 0,
+            "pcs": [(0x08000104, 3), (0x08000200, 1)],
+        }
+        symbols = {
+            "main": {"addr": 0x08000101, "sym_type": "function"},
+            "work": {"addr": 0x08000201, "sym_type": "function"},
+        }
+        with patch.object(fpb, "enter_fl_mode"), patch.object(
+            fpb, "exit_fl_mode"
+        ), patch.object(
+            fpb, "prof_start", return_value=({"hz": 997, "slots": 256}, "")
+        ), patch.object(
+            fpb, "prof_stop", return_value=(4, "")
+        ) as stop, patch.object(
+            fpb, "prof_dump", return_value=(dump, "")
+        ), patch.object(
+            fpb, "get_symbols", return_value=symbols
+        ), patch(
+            "cli.fpb_cli.time.sleep"
+        ) as sleep, patch(
+            "sys.stdout", new_callable=io.StringIO
+        ) as mock_stdout:
+            self.cli.prof("start", duration=0.5)
+        data = json.loads(mock_stdout.getvalue())
+        sleep.assert_called_once_with(0.5)
+        stop.assert_called_once()
+        self.assertTrue(data["success"])
+        self.assertEqual(
+            [(f["name"], f["percent"]) for f in data["functions"]],
+            [("main", 75.0), ("work", 25.0)],
+        )
+        self.assertIn("main", data["table"])
+
+    def test_prof_start_error(self):
+        self.cli._device_state.connected = True
+        fpb = self.cli._fpb
+        with patch.object(fpb, "enter_fl_mode"), patch.object(
+            fpb, "exit_fl_mode"
+        ), patch.object(
+            fpb, "prof_start", return_value=(None, "No sample timer")
+        ), patch(
+            "sys.stdout", new_callable=io.StringIO
+        ) as mock_stdout:
+            self.cli.prof("start")
+        data = json.loads(mock_stdout.getvalue())
+        self.assertFalse(data["success"])
+        self.assertIn("No sample timer", data["error"])
+
+    def test_slotstats(self):
+        self.cli._device_state.connected = True
+        fpb = self.cli._fpb
+        stats = {2: {"calls": 10, "timed": 9, "avg": 120, "max": 300}}
+        with patch.object(fpb, "enter_fl_mode"), patch.object(
+            fpb, "exit_fl_mode"
+        ), patch.object(fpb, "slot_stats", return_value=(stats, "")), patch(
+            "sys.stdout", new_callable=io.StringIO
+        ) as mock_stdout:
+            self.cli.slotstats()
+        data = json.loads(mock_stdout.getvalue())
+        self.assertTrue(data["success"])
+        self.assertEqual(
+            data["slots"],
+            [{"slot": 2, "calls": 10, "timed": 9, "avg": 120, "max": 300}],
+        )
+
+    def test_slotstats_reset(self):
+        self.cli._device_state.connected = True
+        fpb = self.cli._fpb
+        with patch.object(fpb, "enter_fl_mode"), patch.object(
+            fpb, "exit_fl_mode"
+        ), patch.object(
+            fpb, "slot_stats_reset", return_value=(True, "SLOTSTATS reset")
+        ) as reset, patch(
+            "sys.stdout", new_callable=io.StringIO
+        ) as mock_stdout:
+            self.cli.slotstats(reset=True)
+        reset.assert_called_once_with()
+        self.assertTrue(json.loads(mock_stdout.getvalue())["success"])
+
+    def test_ipatch(self):
+        self.cli._device_state.connected = True
+        fpb = self.cli._fpb
+        with patch.object(fpb, "enter_fl_mode"), patch.object(
+            fpb, "exit_fl_mode"
+        ), patch.object(
+            fpb, "ipatch", return_value=(True, "IPatch 0: 0x08001000 insn 0x00002802")
+        ) as ipatch, patch(
+            "sys.stdout", new_callable=io.StringIO
+        ) as mock_stdout:
+            self.cli.ipatch(0x08001000, "cmp r0, #2", comp=0)
+        ipatch.assert_called_once_with(0x08001000, "cmp r0, #2", comp=0, force=False)
+        data = json.loads(mock_stdout.getvalue())
+        self.assertTrue(data["success"])
+        self.assertEqual(data["addr"], "0x08001000")
+
 
 class TestDeviceStateCLI(unittest.TestCase):
     """Test DeviceState class from CLI"""
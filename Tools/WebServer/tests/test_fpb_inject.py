@@ -1816,6 +1816,24 @@ class TestFPBInjectCommands(unittest.TestCase):
         self.assertEqual(info["used"], 100)
         self.assertEqual(info["build_time"], "Jan 30 2026 10:00:00")
 
+    def test_info_slot_stats(self):
+        """Trampoline counters are attached to their slot when supported"""
+        self.fpb._protocol.caps = 0x8000  # CAP_SLOTSTATS
+        self.fpb._protocol.send_cmd = Mock(
+            side_effect=[
+                "Slots: 1/6\nSlot[1]: 0x08001000 -> 0x20001000, 64 bytes\n"
+                "[FLOK] Info complete",
+                "Slot[1]: calls=5 timed=5 avg=80 max=95\n[FLOK] SLOTSTATS slots=1",
+            ]
+        )
+
+        info, _ = self.fpb.info()
+
+        self.assertEqual(
+            info["slots"][0]["stats"],
+            {"calls": 5, "timed": 5, "avg": 80, "max": 95},
+        )
+
     def test_info_failure(self):
         """Test info failure"""
         self.fpb._protocol.send_cmd = Mock(return_value="[FLERR] Device not ready")
@@ -2115,6 +2133,49 @@ Slot[3]: 0x08004000 -> 0x200011C0, 64 bytes
         self.assertEqual(slot3["orig_addr"], 0x08004000)
         self.assertEqual(slot3["target_addr"], 0x200011C0)
 
+    DWT_INFO = """FPBInject v1.0
+Used: 64
+Slots: 1/8
+FPB: v1, 6 code + 2 lit = 8 total, enabled
+Slot[0]: 0x08001000 -> 0x20001000, 64 bytes (COMP=0xC8001001, bp_both, on)
+Slot[1]: empty (COMP=0x00000000, off)
+Slot[2]: empty (COMP=0x00000000, off)
+Slot[3]: empty (COMP=0x00000000, off)
+Slot[4]: empty (COMP=0x00000000, off)
+Slot[5]: empty (COMP=0x00000000, off)
+Slot[6]: empty (debugmon)
+Slot[7]: 0x20010000 -> 0x20001040, 32 bytes (debugmon, on)
+[FLOK] Info complete"""
+
+    def test_info_dwt_slots(self):
+        """Slots past the FPB comparators are marked DebugMonitor-only"""
+        self.fpb._protocol.send_cmd = Mock(return_value=self.DWT_INFO)
+
+        info, error = self.fpb.info()
+
+        self.assertEqual(info["total_slots"], 8)
+        slots = {s["id"]: s for s in info["slots"]}
+        self.assertFalse(slots[0]["debugmon_only"])
+        self.assertTrue(slots[6]["debugmon_only"])
+        self.assertTrue(slots[7]["occupied"])
+        self.assertTrue(slots[7]["debugmon_only"])
+        self.assertEqual(slots[7]["orig_addr"], 0x20010000)
+
+    def test_find_slot_skips_dwt_slots(self):
+        """DWT-backed slots are only handed out for debugmon patches"""
+        self.fpb._protocol.send_cmd = Mock(return_value=self.DWT_INFO)
+        reserved = (1, 2, 3, 4, 5)
+
+        self.assertEqual(
+            self.fpb.find_slot_for_target(0x08005000, reserved), (-1, False)
+        )
+        self.assertEqual(
+            self.fpb.find_slot_for_target(0x08005000, reserved, debugmon=True),
+            (6, False),
+        )
+        # A patched DWT slot is still reused for its own target
+        self.assertEqual(self.fpb.find_slot_for_target(0x20010000), (7, True))
+
     @patch("subprocess.run")
     def test_get_elf_build_time_found(self, mock_run):
         """Test getting build time from ELF file"""
@@ -2333,6 +2394,162 @@ class TestCompileInjectObjcopyError(unittest.TestCase):
         self.assertIn("Link error", error)
 
 
+class TestDeltaUpload(unittest.TestCase):
+    """Test rsync-style delta upload against device block hashes"""
+
+    BASE = 0x20001000
+
+    def setUp(self):
+        self.device = DeviceState()
+        self.device.ser = Mock()
+        self.fpb = FPBInject(self.device)
+        self.fpb._protocol.caps = 0x28  # CAP_HASH | CAP_CRC32
+        self.memory = bytearray(1024)
+        self.uploads = []
+        self.fpb._protocol.send_cmd = Mock(side_effect=self._device_cmd)
+        patcher = patch.object(self.fpb, "upload", side_effect=self._upload)
+        patcher.start()
+        self.addCleanup(patcher.stop)
+
+    def _device_cmd(self, cmd, **kwargs):
+        """Emulate the hash command over self.memory"""
+        import base64
+        import re
+        import struct
+        from utils.crc import crc32_update
+
+        m = re.search(r"--addr 0x([0-9A-F]+) --len (\d+) --size (\d+)", cmd)
+        addr, n, bs = int(m.group(1), 16), int(m.group(2)), int(m.group(3))
+        off = addr - self.BASE
+        data = bytes(self.memory[off : off + n])
+        raw = b"".join(
+            struct.pack("<I", crc32_update(0, data[i : i + bs]))
+            for i in range(0, n, bs)
+        )
+        crc = crc32_update(crc32_update(0, struct.pack("<II", addr, n)), raw)
+        b64 = base64.b64encode(raw).decode()
+        blocks = len(raw) // 4
+        return f"[FLOK] HASH {blocks} blocks bs={bs} crc=0x{crc:08X} data={b64}"
+
+    def _upload(self, data, start_offset=0, progress_callback=None):
+        self.uploads.append((start_offset, len(data)))
+        self.memory[start_offset : start_offset + len(data)] = data
+        if progress_callback:
+            progress_callback(len(data), len(data))
+        return True, {"time": 0.01, "wire_bytes": len(data)}
+
+    def test_only_changed_blocks_uploaded(self):
+        """An edit in one block re-uploads just that block"""
+        image = bytes(i & 0xFF for i in range(640))
+        self.memory[: len(image)] = image
+        edited = bytearray(image)
+        edited[300] ^= 0xFF
+
+        progress = Mock()
+        ok, result = self.fpb.upload_delta(bytes(edited), self.BASE, 0, progress)
+        self.assertTrue(ok)
+        self.assertEqual(self.uploads, [(256, 64)])
+        self.assertEqual(bytes(self.memory[:640]), bytes(edited))
+        self.assertEqual(result["delta_bytes"], 64)
+        self.assertAlmostEqual(result["ratio"], 0.1)
+        progress.assert_called_with(640, 640)
+
+    def test_nearby_runs_merged(self):
+        """Changes one block apart go out in a single upload"""
+        image = bytearray(640)
+        image[10] = 1
+        image[140] = 1
+        image[600] = 1
+        ok, result = self.fpb.upload_delta(bytes(image), self.BASE, 8)
+        self.assertTrue(ok)
+        self.assertEqual(self.uploads, [(8, 192), (8 + 576, 64)])
+        self.assertEqual(result["delta_runs"], 2)
+
+    def test_unchanged_image_skipped(self):
+        """Re-injecting the same image uploads nothing"""
+        ok, result = self.fpb.upload_delta(bytes(640), self.BASE)
+        self.assertTrue(ok)
+        self.assertEqual(self.uploads, [])
+        self.assertEqual(result["delta_bytes"], 0)
+
+    def test_full_upload_without_cap(self):
+        """Without CAP_HASH (or CRC-32) the whole image is uploaded"""
+        for caps in (0, 0x20, 0x8):
+            self.uploads.clear()
+            self.fpb._protocol.caps = caps
+            self.fpb.upload_delta(bytes(640), self.BASE)
+            self.assertEqual(self.uploads, [(0, 640)])
+
+    def test_hash_failure_falls_back(self):
+        """A failed hash command degrades to a full upload"""
+        self.fpb._protocol.send_cmd = Mock(return_value="[FLERR] Unknown: hash")
+        ok, _ = self.fpb.upload_delta(bytes(640), self.BASE)
+        self.assertTrue(ok)
+        self.assertEqual(self.uploads, [(0, 640)])
+
+    def test_batched_with_patch(self):
+        """With CAP_BATCH a small delta and the patch share one round trip"""
+        self.fpb._protocol.caps |= 0x40
+        self.fpb._protocol.batch = Mock(
+            return_value=(
+                True,
+                [{"ok": True, "msg": "Uploaded"}, {"ok": True, "msg": "Patched"}],
+                "BATCH 2/2",
+            )
+        )
+        patch_cmd = self.fpb._protocol.patch_cmd("tpatch", 1, 0x08001000, 0x20001001)
+        edited = bytearray(640)
+        edited[300] = 1
+        ok, result = self.fpb.upload_delta(
+            bytes(edited), self.BASE, then_cmd=patch_cmd
+        )
+
+        self.assertTrue(ok)
+        self.assertEqual(result["then"], (True, "Patched"))
+        self.assertEqual(result["delta_bytes"], 64)
+        self.assertEqual(self.uploads, [])
+        cmds = self.fpb._protocol.batch.call_args.args[0]
+        self.assertEqual(len(cmds), 2)
+        self.assertIn("-c upload -a 0x100 ", cmds[0])
+        self.assertEqual(cmds[1], patch_cmd)
+
+    def test_batched_upload_failure(self):
+        """A failed upload inside the batch fails the transfer"""
+        self.fpb._protocol.caps |= 0x40
+        self.fpb._protocol.batch = Mock(
+            return_value=(False, [{"ok": False, "msg": "CRC mismatch"}], "BATCH 0/2")
+        )
+        edited = bytearray(640)
+        edited[300] = 1
+        ok, result = self.fpb.upload_delta(bytes(edited), self.BASE, then_cmd="-c ping")
+        self.assertFalse(ok)
+        self.assertIn("CRC mismatch", result["error"])
+
+    def test_large_delta_runs_patch_after(self):
+        """Runs that do not fit one batch are uploaded, then the patch is sent"""
+        self.fpb._protocol.caps |= 0x40
+        self.fpb._protocol.batch = Mock()
+        edited = bytearray(640)
+        edited[0] = 1
+        edited[400] = 1
+        sent = []
+
+        def device_cmd(cmd, **kwargs):
+            if "-c hash" in cmd:
+                return self._device_cmd(cmd)
+            sent.append(cmd)
+            return "[FLOK] Patched"
+
+        self.fpb._protocol.send_cmd = Mock(side_effect=device_cmd)
+        ok, result = self.fpb.upload_delta(bytes(edited), self.BASE, then_cmd="-c ping")
+
+        self.assertTrue(ok)
+        self.fpb._protocol.batch.assert_not_called()
+        self.assertEqual(self.uploads, [(0, 64), (384, 64)])
+        self.assertEqual(sent, ["-c ping"])
+        self.assertEqual(result["then"], (True, "Patched"))
+
+
 class TestInjectMulti(unittest.TestCase):
     """Test inject_multi function with new design (no inject_ prefix)"""
 
@@ -2429,6 +2646,185 @@ class TestInjectMulti(unittest.TestCase):
                 os.remove(self.device.elf_path)
 
 
+    def _run_staged(self, inject_results, commit=(True, "Committed 2")):
+        """inject_multi on a CAP_STAGE device with two targets."""
+        self.fpb._protocol.caps = 0x80  # CAP_STAGE
+        syms = {"funcA": 0x20001000, "funcB": 0x20001050}
+        with tempfile.NamedTemporaryFile(delete=False) as f:
+            self.device.elf_path = f.name
+        try:
+            with patch.object(
+                self.fpb, "compile_inject", return_value=(b"\x00" * 8, syms, "")
+            ), patch.object(
+                self.fpb, "_resolve_symbol_addr", return_value=0x08000100
+            ), patch.object(
+                self.fpb, "inject", side_effect=inject_results
+            ) as mock_inject, patch.object(
+                self.fpb, "commit", return_value=commit
+            ) as mock_commit, patch.object(
+                self.fpb, "abort", return_value=(True, "Aborted 1")
+            ) as mock_abort, patch.object(
+                self.fpb, "unpatch", return_value=(True, "")
+            ) as mock_unpatch:
+                success, result = self.fpb.inject_multi("source")
+                return (
+                    success, result, mock_inject, mock_commit, mock_abort, mock_unpatch
+                )
+        finally:
+            os.remove(self.device.elf_path)
+
+    def test_inject_multi_staged_single_commit(self):
+        """With CAP_STAGE all patches are staged, then armed by one commit"""
+        success, result, mock_inject, mock_commit, mock_abort, _ = self._run_staged(
+            [(True, {"slot": 0}), (True, {"slot": 1})]
+        )
+        self.assertTrue(success)
+        self.assertEqual(result["successful_count"], 2)
+        calls = mock_inject.call_args_list
+        self.assertTrue(all(c.kwargs["stage"] for c in calls))
+        # The second function must not reuse the slot staged by the first
+        self.assertEqual(calls[0].kwargs["reserved_slots"], ())
+        self.assertEqual(calls[1].kwargs["reserved_slots"], (0,))
+        mock_commit.assert_called_once()
+        mock_abort.assert_not_called()
+
+    def test_inject_multi_staged_failure_aborts(self):
+        """One failing function drops every staged patch"""
+        success, result, _, mock_commit, mock_abort, _ = self._run_staged(
+            [(True, {"slot": 0}), (False, {"error": "Upload failed"})]
+        )
+        self.assertFalse(success)
+        mock_commit.assert_not_called()
+        mock_abort.assert_called_once()
+        self.assertIn("Aborted", result["injections"][0]["error"])
+
+    def test_inject_multi_staged_commit_failure(self):
+        """A failed commit is rolled back on the device and fails every function"""
+        success, result, _, _, _, mock_unpatch = self._run_staged(
+            [(True, {"slot": 0}), (True, {"slot": 1})],
+            commit=(False, "Commit slot 1 failed: -2 (rolled back)"),
+        )
+        self.assertFalse(success)
+        # Unpatching would drop the live patches the rollback kept
+        mock_unpatch.assert_not_called()
+        self.assertIn("Commit failed", result["errors"][-1])
+
+
+class TestInjectRetarget(unittest.TestCase):
+    """Test re-inject of a live slot through retarget"""
+
+    def setUp(self):
+        self.device = DeviceState()
+        self.device.ser = Mock()
+        self.fpb = FPBInject(self.device)
+        self.fpb._protocol.caps = 0x10000  # CAP_RETARGET
+        with tempfile.NamedTemporaryFile(delete=False) as f:
+            self.device.elf_path = f.name
+        self.addCleanup(os.remove, self.device.elf_path)
+
+        patches = {
+            "_resolve_symbol_addr": Mock(return_value=0x08001000),
+            "find_slot_for_target": Mock(return_value=(2, True)),
+            "info": Mock(return_value=({}, "")),
+            "compile_inject": Mock(return_value=(b"\x00" * 8, {"f": 0x20000100}, "")),
+            "alloc": Mock(return_value=(0x20000100, "")),
+            "upload_delta": Mock(),
+            "unpatch": Mock(return_value=(True, "")),
+            "tpatch": Mock(return_value=(True, "")),
+        }
+        for name, mock in patches.items():
+            patcher = patch.object(self.fpb, name, mock)
+            patcher.start()
+            self.addCleanup(patcher.stop)
+        self.mocks = patches
+
+    def _inject(self, then):
+        self.mocks["upload_delta"].return_value = (True, {"then": then})
+        return self.fpb.inject("source", "f", patch_mode="trampoline")
+
+    def test_live_slot_retargeted(self):
+        """The old patch stays armed until the new code is uploaded"""
+        success, result = self._inject((True, "Retarget 2"))
+        self.assertTrue(success)
+        self.assertEqual(result["slot"], 2)
+        self.mocks["unpatch"].assert_not_called()
+        self.mocks["tpatch"].assert_not_called()
+        self.mocks["alloc"].assert_called_once_with(16)
+        cmd = self.mocks["upload_delta"].call_args.kwargs["then_cmd"]
+        self.assertTrue(cmd.startswith("-c retarget --comp 2 --orig 0x8001000 "))
+        self.assertTrue(cmd.endswith(" --mode tpatch"))
+
+    def test_retarget_refused_falls_back(self):
+        """A slot armed in another mode is unpatched and patched again"""
+        success, _ = self._inject((False, "Slot 2 not armed by tpatch"))
+        self.assertTrue(success)
+        self.mocks["unpatch"].assert_called_once_with(comp=2)
+        self.mocks["tpatch"].assert_called_once_with(2, 0x08001000, 0x20000101, False)
+
+    def test_without_cap_unpatches_first(self):
+        self.fpb._protocol.caps = 0
+        self.mocks["upload_delta"].return_value = (True, {})
+        success, _ = self.fpb.inject("source", "f", patch_mode="trampoline")
+        self.assertTrue(success)
+        self.mocks["unpatch"].assert_called_once_with(comp=2)
+        self.assertIsNone(self.mocks["upload_delta"].call_args.kwargs["then_cmd"])
+
+    def test_direct_mode_unpatches_first(self):
+        """REMAP patches have no target word to swap"""
+        self.mocks["upload_delta"].return_value = (True, {})
+        with patch.object(self.fpb, "patch", return_value=(True, "")):
+            success, _ = self.fpb.inject("source", "f", patch_mode="direct")
+        self.assertTrue(success)
+        self.mocks["unpatch"].assert_called_once_with(comp=2)
+
+
+class TestIPatch(unittest.TestCase):
+    """Test single-instruction patching"""
+
+    def setUp(self):
+        self.device = DeviceState()
+        self.device.ser = Mock()
+        self.fpb = FPBInject(self.device)
+        self.fpb._protocol.caps = 0x20000  # CAP_IPATCH
+        self.fpb._protocol.ipatch = Mock(return_value=(True, "IPatch 3"))
+        # cmp r0, #1 at 0x08001000, then a 32-bit cmp.w r0, #1
+        code = bytes.fromhex("0128b0f1010f")
+        self.fpb.read_memory = Mock(
+            side_effect=lambda addr, n: (code[addr - 0x08001000 :][:n], "")
+        )
+        self.fpb.find_slot_for_target = Mock(return_value=(3, False))
+
+    def test_ipatch_hex(self):
+        """objdump hex goes straight to the device, in a free slot"""
+        self.assertTrue(self.fpb.ipatch_supported())
+        ok, msg = self.fpb.ipatch(0x08001001, "2802")
+        self.assertEqual((ok, msg), (True, "IPatch 3"))
+        self.fpb._protocol.ipatch.assert_called_once_with(3, 0x08001000, 0x2802, False)
+
+        self.fpb.ipatch(0x08001002, "f1b0 0f02", comp=1, stage=True)
+        self.fpb._protocol.ipatch.assert_called_with(1, 0x08001002, 0xF1B00F02, True)
+
+    def test_ipatch_width_mismatch(self):
+        """A 16-bit instruction cannot replace half of a 32-bit one"""
+        ok, msg = self.fpb.ipatch(0x08001002, "2802")
+        self.assertFalse(ok)
+        self.assertIn("Width mismatch at 0x08001002: f1b0 0f01 -> 2802", msg)
+        self.fpb._protocol.ipatch.assert_not_called()
+
+        self.assertTrue(self.fpb.ipatch(0x08001002, "2802", force=True)[0])
+
+    @patch("core.thumb_asm.assemble_insn", return_value=(None, "Assemble error"))
+    def test_ipatch_assemble_error(self, mock_asm):
+        """Assembly is done at the patched address"""
+        ok, msg = self.fpb.ipatch(0x08001000, "cmp r0, #2")
+        self.assertEqual((ok, msg), (False, "Assemble error"))
+        self.assertEqual(mock_asm.call_args.args[:2], ("cmp r0, #2", 0x08001000))
+
+    def test_ipatch_no_slot(self):
+        self.fpb.find_slot_for_target.return_value = (-1, False)
+        self.assertEqual(self.fpb.ipatch(0x08001000, "2802"), (False, "No free slot"))
+
+
 if __name__ == "__main__":
     unittest.main(verbosity=2)
 
@@ -371,6 +371,103 @@ class TestFPBEnableRoute(TestFPBRoutesBase):
         mock_fpb.enable_patch.assert_called_once_with(comp=0, enable=True, all=False)
 
 
+class TestFPBProfRoute(TestFPBRoutesBase):
+    """PC-sampling profiler route tests"""
+
+    SYMBOLS = {
+        "main": {"addr": 0x08000101, "sym_type": "function"},
+        "work": {"addr": 0x08000201, "sym_type": "function"},
+    }
+
+    @patch("app.routes.fpb._get_helpers")
+    def test_prof_start(self, mock_helpers):
+        mock_fpb = Mock()
+        mock_fpb.prof_start.return_value = ({"hz": 500, "slots": 256}, "")
+        mock_helpers.return_value = make_mock_helpers(mock_fpb)
+
+        response = self.client.post("/api/fpb/prof/start", json={"hz": 500})
+        data = json.loads(response.data)
+
+        self.assertEqual(data, {"success": True, "hz": 500, "slots": 256})
+        mock_fpb.prof_start.assert_called_once_with(500)
+
+    @patch("app.routes.fpb._get_helpers")
+    def test_prof_start_error(self, mock_helpers):
+        mock_fpb = Mock()
+        mock_fpb.prof_start.return_value = (None, "No sample timer")
+        mock_helpers.return_value = make_mock_helpers(mock_fpb)
+
+        response = self.client.post("/api/fpb/prof/start", json={})
+        data = json.loads(response.data)
+
+        self.assertFalse(data["success"])
+        self.assertEqual(data["error"], "No sample timer")
+        mock_fpb.prof_start.assert_called_once_with(0)
+
+    @patch("app.routes.fpb._get_helpers")
+    def test_prof_stop(self, mock_helpers):
+        mock_fpb = Mock()
+        mock_fpb.prof_stop.return_value = (321, "")
+        mock_helpers.return_value = make_mock_helpers(mock_fpb)
+
+        data = json.loads(self.client.post("/api/fpb/prof/stop").data)
+
+        self.assertEqual(data, {"success": True, "samples": 321})
+
+    @patch("app.routes.fpb._prof_function_index")
+    @patch("app.routes.fpb._get_helpers")
+    def test_prof_flat_profile(self, mock_helpers, mock_index):
+        """PCs are grouped by function, injected code by its patch slot"""
+        from core.profile import FunctionIndex
+
+        mock_fpb = Mock()
+        mock_fpb.prof_dump.return_value = (
+            {
+                "running": True,
+                "hz": 997,
+                "samples": 10,
+                "overflow": 0,
+                "pcs": [(0x08000204, 6), (0x08000110, 1), (0x20001004, 3)],
+            },
+            "",
+        )
+        mock_helpers.return_value = make_mock_helpers(mock_fpb)
+        mock_index.return_value = FunctionIndex(self.SYMBOLS)
+        state.device.device_info = {
+            "slots": [
+                {
+                    "occupied": True,
+                    "orig_addr": 0x08000201,
+                    "target_addr": 0x20001001,
+                    "code_size": 32,
+                }
+            ]
+        }
+
+        data = json.loads(self.client.get("/api/fpb/prof?limit=2").data)
+
+        self.assertTrue(data["success"])
+        self.assertTrue(data["running"])
+        self.assertEqual(data["total_functions"], 3)
+        self.assertEqual(
+            [(f["name"], f["samples"]) for f in data["functions"]],
+            [("work", 6), ("work [patch]", 3)],
+        )
+        self.assertEqual(data["functions"][0]["addr"], "0x08000200")
+        self.assertEqual(data["functions"][0]["percent"], 60.0)
+
+    @patch("app.routes.fpb._get_helpers")
+    def test_prof_dump_error(self, mock_helpers):
+        mock_fpb = Mock()
+        mock_fpb.prof_dump.return_value = (None, "Unknown: prof")
+        mock_helpers.return_value = make_mock_helpers(mock_fpb)
+
+        data = json.loads(self.client.get("/api/fpb/prof").data)
+
+        self.assertFalse(data["success"])
+        self.assertEqual(data["error"], "Unknown: prof")
+
+
 class TestFPBInjectRoute(TestFPBRoutesBase):
     """FPB inject route tests"""
 
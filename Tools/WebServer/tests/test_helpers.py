@@ -74,6 +74,27 @@ class TestBuildSlotResponse(unittest.TestCase):
         self.assertEqual(result["slots"][0]["func"], "main")
         self.assertEqual(result["slots"][0]["code_size"], 64)
 
+    def test_slot_stats_passed_through(self):
+        """Trampoline counters from info reach the slot response"""
+        device = DeviceState()
+        stats = {"calls": 3, "timed": 3, "avg": 40, "max": 50}
+        device.device_info = {
+            "slots": [
+                {
+                    "id": 1,
+                    "occupied": True,
+                    "orig_addr": 0x08000100,
+                    "target_addr": 0x20001000,
+                    "code_size": 16,
+                    "stats": stats,
+                }
+            ],
+        }
+
+        result = build_slot_response(device, AppState(), lambda: Mock())
+
+        self.assertEqual(result["slots"][1]["stats"], stats)
+
     def test_no_symbols_loaded_still_works(self):
         """Test that build_slot_response works without preloaded symbols"""
         device = DeviceState()
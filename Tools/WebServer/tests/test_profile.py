@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2025 - 2026 _VIFEXTech
+
+"""
+Tests for the flat profile builder of the PC-sampling profiler.
+"""
+
+import os
+import sys
+import unittest
+
+# Add parent directory to path
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from core.profile import (  # noqa: E402
+    FUNC_MAX_SPAN,
+    FunctionIndex,
+    flat_profile,
+    format_flat_profile,
+)
+
+SYMBOLS = {
+    "main": {"addr": 0x08000101, "sym_type": "function"},
+    "_Z4workv": {"addr": 0x08000201, "sym_type": "function"},
+    "work()": {"addr": 0x08000201, "sym_type": "function"},
+    "g_counter": {"addr": 0x08000180, "sym_type": "variable"},
+    "ram_func": {"addr": 0x20000001, "sym_type": "function"},
+}
+
+
+class TestFunctionIndex(unittest.TestCase):
+    """Tests for PC -> function lookups."""
+
+    def setUp(self):
+        self.index = FunctionIndex(SYMBOLS)
+
+    def test_lookup(self):
+        self.assertEqual(self.index.lookup(0x08000100), ("main", 0x08000100))
+        # Variables do not split functions
+        self.assertEqual(self.index.lookup(0x080001F0), ("main", 0x08000100))
+        self.assertEqual(self.index.lookup(0x20000010), ("ram_func", 0x20000000))
+
+    def test_demangled_name_preferred(self):
+        self.assertEqual(self.index.lookup(0x08000204)[0], "work()")
+        self.assertEqual(len(self.index), 3)
+
+    def test_outside_functions(self):
+        self.assertIsNone(self.index.lookup(0x08000000))
+        self.assertIsNone(self.index.lookup(0x08000200 + FUNC_MAX_SPAN))
+
+
+class TestFlatProfile(unittest.TestCase):
+    """Tests for grouping the device histogram by function."""
+
+    DUMP = {
+        "running": False,
+        "hz": 1000,
+        "samples": 100,
+        "overflow": 5,
+        "pcs": [
+            (0x08000104, 10),
+            (0x08000204, 40),
+            (0x08000208, 30),
+            (0x2000F000, 5),
+            (0x10000000, 10),
+        ],
+    }
+
+    def test_grouping(self):
+        profile = flat_profile(self.DUMP, FunctionIndex(SYMBOLS))
+        names = [f["name"] for f in profile["functions"]]
+        self.assertEqual(names, ["work()", "main", "0x10000000", "ram_func"])
+        work = profile["functions"][0]
+        self.assertEqual(work["samples"], 70)
+        self.assertAlmostEqual(work["percent"], 70.0)
+        self.assertEqual(work["pcs"], [(0x08000204, 40), (0x08000208, 30)])
+        self.assertEqual(profile["overflow"], 5)
+
+    def test_regions_first(self):
+        """Injected code is attributed before the symbol lookup"""
+        profile = flat_profile(
+            self.DUMP,
+            FunctionIndex(SYMBOLS),
+            [(0x2000F000, 0x40, "work() [patch]")],
+        )
+        names = {f["name"]: f["samples"] for f in profile["functions"]}
+        self.assertEqual(names["work() [patch]"], 5)
+        self.assertNotIn("ram_func", names)
+
+    def test_empty(self):
+        profile = flat_profile({"samples": 0, "pcs": []}, FunctionIndex({}))
+        self.assertEqual(profile["functions"], [])
+        self.assertIn("0 samples", format_flat_profile(profile))
+
+    def test_format(self):
+        profile = flat_profile(self.DUMP, FunctionIndex(SYMBOLS))
+        text = format_flat_profile(profile, limit=2)
+        lines = text.splitlines()
+        self.assertEqual(lines[0], "100 samples at 1000 Hz, 5 unbinned")
+        self.assertEqual(len(lines), 4)
+        self.assertIn(" 70.0%", lines[2])
+        self.assertTrue(lines[2].endswith("0x08000200  work()"))
+
+
+if __name__ == "__main__":
+    unittest.main()
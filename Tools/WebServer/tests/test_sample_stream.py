@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2025 - 2026 _VIFEXTech
+
+"""
+Tests for the device sampler record decoder.
+"""
+
+import base64
+import os
+import struct
+import sys
+import unittest
+
+# Add parent directory to path
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from core.sample_stream import (  # noqa: E402
+    SampleDecoder,
+    SampleLineFilter,
+    SampleSession,
+)
+
+
+def record(seq, ts, mask, *values):
+    """One record as fl_sample_tick() queues it."""
+    return struct.pack("<BIB", seq, ts, mask) + b"".join(values)
+
+
+class TestSampleLineFilter(unittest.TestCase):
+    """Tests for splitting [FLSMP] lines out of serial text."""
+
+    def test_split(self):
+        f = SampleLineFilter()
+        b64 = base64.b64encode(b"\x01\x02\x03").decode()
+        text, payloads = f.feed(f"log line\n[FLSMP] {b64}\nnsh> ")
+        self.assertEqual(text, "log line\nnsh> ")
+        self.assertEqual(payloads, [b"\x01\x02\x03"])
+
+    def test_partial_line_held(self):
+        """A sample line split across reads is reassembled"""
+        f = SampleLineFilter()
+        b64 = base64.b64encode(b"abcdef").decode()
+        line = f"[FLSMP] {b64}\n"
+        text, payloads = f.feed(line[:3])
+        self.assertEqual((text, payloads), ("", []))
+        text, payloads = f.feed(line[3:12])
+        self.assertEqual((text, payloads), ("", []))
+        text, payloads = f.feed(line[12:] + "ok\n")
+        self.assertEqual(text, "ok\n")
+        self.assertEqual(payloads, [b"abcdef"])
+
+    def test_other_partial_passes(self):
+        f = SampleLineFilter()
+        self.assertEqual(f.feed("[FLOK] REA"), ("[FLOK] REA", []))
+
+    def test_bad_base64_dropped(self):
+        f = SampleLineFilter()
+        self.assertEqual(f.feed("[FLSMP] !!!\n"), ("", []))
+
+
+class TestSampleDecoder(unittest.TestCase):
+    """Tests for record decoding (layout of App/tests/test_fl_sample.c)."""
+
+    A = struct.pack("<I", 0x11223344)
+    B = struct.pack("<H", 0x5566)
+
+    def test_key_then_delta(self):
+        d = SampleDecoder([4, 2], hz=1000)
+        samples = d.feed(
+            record(0, 1000, 0x03, self.A, self.B)
+            + record(1, 1500, 0x02, struct.pack("<H", 0x7788))
+        )
+        self.assertEqual(len(samples), 2)
+        self.assertTrue(samples[0]["key"])
+        self.assertEqual(samples[0]["values"], {0: self.A, 1: self.B})
+        self.assertEqual(samples[0]["time"], 0.0)
+        self.assertFalse(samples[1]["key"])
+        self.assertEqual(samples[1]["values"], {0: self.A, 1: b"\x88\x77"})
+        self.assertEqual(samples[1]["time"], 0.5)
+        self.assertEqual(d.lost, 0)
+
+    def test_delta_before_key_skipped(self):
+        d = SampleDecoder([4, 2])
+        self.assertEqual(d.feed(record(5, 0, 0x01, self.A)), [])
+        samples = d.feed(record(6, 1, 0x03, self.A, self.B))
+        self.assertEqual(len(samples), 1)
+        self.assertIsNone(samples[0]["time"])
+
+    def test_seq_gap_waits_for_key(self):
+        """Deltas after lost records are stale until the next key record"""
+        d = SampleDecoder([4, 2])
+        d.feed(record(254, 0, 0x03, self.A, self.B))
+        self.assertEqual(d.feed(record(1, 10, 0x01, self.A)), [])
+        self.assertEqual(d.lost, 2)
+        self.assertEqual(len(d.feed(record(2, 20, 0x03, self.A, self.B))), 1)
+
+    def test_timestamp_unwrap(self):
+        d = SampleDecoder([4])
+        d.feed(record(0, 0xFFFFFF00, 0x01, self.A))
+        samples = d.feed(record(1, 0x100, 0x01, self.A))
+        self.assertEqual(samples[0]["ts"], 0x100000100)
+
+    def test_truncated(self):
+        d = SampleDecoder([4, 2])
+        self.assertEqual(d.feed(record(0, 0, 0x03, self.A)), [])
+        self.assertEqual(d.errors, 1)
+        self.assertEqual(d.feed(record(0, 0, 0x04)), [])
+        self.assertEqual(d.errors, 2)
+
+
+class TestSampleSession(unittest.TestCase):
+    """Tests for sample fan-out to SSE listeners."""
+
+    def test_fan_out_and_close(self):
+        session = SampleSession([{"expr": "g_a", "addr": 0x100, "size": 4}])
+        q = session.subscribe()
+        session.on_payload(record(0, 7, 0x01, b"\x01\x00\x00\x00"))
+        event = q.get_nowait()
+        self.assertEqual(event["type"], "samples")
+        self.assertEqual(event["samples"][0]["values"], {"0": "01000000"})
+        self.assertEqual(event["samples"][0]["ts"], 7)
+
+        session.unsubscribe(q)
+        session.on_payload(record(1, 8, 0x01, b"\x02\x00\x00\x00"))
+        self.assertTrue(q.empty())
+
+        q = session.subscribe()
+        session.close()
+        self.assertIsNone(q.get_nowait())
+
+
+if __name__ == "__main__":
+    unittest.main()
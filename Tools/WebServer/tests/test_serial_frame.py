@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2025 - 2026 _VIFEXTech
+
+"""
+Tests for the binary frame codec.
+"""
+
+import base64
+import os
+import struct
+import sys
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from core import serial_frame as sf
+
+
+class TestEncodeFrame(unittest.TestCase):
+    """Tests for encode_frame."""
+
+    def test_layout(self):
+        """Header fields and CRC land where the firmware expects them."""
+        frame = sf.encode_frame(0x42, sf.OPCODES["ping"], b"\x01\x02")
+        self.assertEqual(frame[0], sf.FRAME_SOF)
+        self.assertEqual(frame[1], 0)
+        self.assertEqual(frame[2], 0x42)
+        self.assertEqual(frame[3], 0x01)
+        self.assertEqual(struct.unpack_from("<H", frame, 4)[0], 2)
+        self.assertEqual(frame[6:8], b"\x01\x02")
+        crc = struct.unpack_from("<H", frame, 8)[0]
+        self.assertEqual(crc, sf.frame_crc(frame[1:8]))
+        self.assertEqual(len(frame), sf.FRAME_OVERHEAD + 2)
+
+    def test_seq_wraps(self):
+        """Sequence numbers are truncated to one byte."""
+        frame = sf.encode_frame(0x1FF, 1)
+        self.assertEqual(frame[2], 0xFF)
+
+
+class TestCommandToRequest(unittest.TestCase):
+    """Tests for command_to_request."""
+
+    def test_upload_data_is_raw(self):
+        """Upload --data is decoded from base64 and sent as TAG_BIN."""
+        data = bytes(range(10))
+        b64 = base64.b64encode(data).decode()
+        op, payload = sf.command_to_request(f"-c upload -a 0x10 -d {b64} -r 0x1234")
+        self.assertEqual(op, sf.OPCODES["upload"])
+        expected = (
+            sf.tlv(sf.TAG_ADDR, struct.pack("<I", 0x10))
+            + sf.tlv(sf.TAG_BIN, data)
+            + sf.tlv(sf.TAG_CRC, struct.pack("<I", 0x1234))
+        )
+        self.assertEqual(payload, expected)
+
+    def test_crc32_flag(self):
+        """--crc32 is an empty TLV, a CRC-32 value fills the 4-byte CRC tag."""
+        _, payload = sf.command_to_request(
+            "-c read -a 0x0 -l 4 --crc32 --crc 0xCBF43926"
+        )
+        self.assertIn(sf.tlv(sf.TAG_CRC32, b""), payload)
+        self.assertIn(sf.tlv(sf.TAG_CRC, struct.pack("<I", 0xCBF43926)), payload)
+
+    def test_z_flag(self):
+        """--z is an empty TLV; the compressed --data still travels raw."""
+        _, payload = sf.command_to_request("-c upload -a 0x0 -d AAEC --z")
+        self.assertIn(sf.tlv(sf.TAG_Z, b""), payload)
+        self.assertIn(sf.tlv(sf.TAG_BIN, b"\x00\x01\x02"), payload)
+
+    def test_batch_record(self):
+        """A batch record is op + 2-byte LE length + the frame payload."""
+        op, payload = sf.command_to_request("-c alloc -s 64")
+        record = sf.batch_record("-c alloc -s 64")
+        self.assertEqual(record, struct.pack("<BH", op, len(payload)) + payload)
+        self.assertIsNone(sf.batch_record("-c bogus"))
+        # Batch records travel raw in a frame
+        op, payload = sf.command_to_request("-c batch --data AAEC")
+        self.assertEqual(op, sf.OPCODES["batch"])
+        self.assertEqual(payload, sf.tlv(sf.TAG_BIN, b"\x00\x01\x02"))
+
+    def test_stage_commit(self):
+        """--stage is a flag; commit/abort carry no arguments."""
+        op, payload = sf.command_to_request("-c patch --comp 1 --stage")
+        self.assertEqual(op, sf.OPCODES["patch"])
+        self.assertEqual(
+            payload,
+            sf.tlv(sf.TAG_COMP, struct.pack("<I", 1)) + sf.tlv(sf.TAG_STAGE, b""),
+        )
+        for name in ("commit", "abort"):
+            self.assertEqual(sf.command_to_request(f"-c {name}"), (sf.OPCODES[name], b""))
+
+    def test_memfind_pattern_is_raw(self):
+        """memfind --data travels as raw bytes, --value as an int."""
+        _, payload = sf.command_to_request("-c memfind --addr 0x100 --data 3q2+7w==")
+        self.assertTrue(payload.endswith(sf.tlv(sf.TAG_BIN, b"\xde\xad\xbe\xef")))
+        _, payload = sf.command_to_request("-c memset --value 255")
+        self.assertEqual(payload, sf.tlv(sf.TAG_VALUE, struct.pack("<I", 255)))
+
+    def test_echo_data_is_string(self):
+        """Echo --data stays a NUL-terminated string."""
+        op, payload = sf.command_to_request("-c echo -d 00FF")
+        self.assertEqual(op, sf.OPCODES["echo"])
+        self.assertEqual(payload, sf.tlv(sf.TAG_DATA, b"00FF\0"))
+
+    def test_flags_and_negative(self):
+        """Boolean options are empty TLVs, negative ints are two's complement."""
+        _, payload = sf.command_to_request("-c enable --enable -1 --all")
+        self.assertEqual(
+            payload,
+            sf.tlv(sf.TAG_ENABLE, b"\xff\xff\xff\xff") + sf.tlv(sf.TAG_ALL, b""),
+        )
+
+    def test_fl_prefix_and_quoted_path(self):
+        """A leading 'fl' is ignored and quoted paths keep their spaces."""
+        op, payload = sf.command_to_request('fl -c fopen --path "/a b.txt" --mode r')
+        self.assertEqual(op, sf.OPCODES["fopen"])
+        self.assertIn(b"/a b.txt\0", payload)
+
+    def test_unknown_command_falls_back(self):
+        """Unknown commands cannot be framed."""
+        self.assertIsNone(sf.command_to_request("-c nosuchcmd"))
+
+    def test_unknown_option_falls_back(self):
+        """Unknown options cannot be framed."""
+        self.assertIsNone(sf.command_to_request("-c read --bogus 1"))
+
+    def test_invalid_base64_falls_back(self):
+        """Malformed base64 is left for the device to reject in text mode."""
+        self.assertIsNone(sf.command_to_request("-c upload -a 0 -d !!!!"))
+
+
+class TestFrameDecoder(unittest.TestCase):
+    """Tests for FrameDecoder."""
+
+    def test_split_feed(self):
+        """Frames split across reads are reassembled."""
+        frame = sf.encode_frame(3, 4, b"hello", sf.FRAME_F_RESP)
+        dec = sf.FrameDecoder()
+        self.assertEqual(list(dec.feed(frame[:5])), [])
+        frames = list(dec.feed(frame[5:]))
+        self.assertEqual(len(frames), 1)
+        self.assertEqual(frames[0].seq, 3)
+        self.assertEqual(frames[0].op, 4)
+        self.assertEqual(frames[0].payload, b"hello")
+
+    def test_skips_noise_and_bad_crc(self):
+        """Log text and corrupted frames are skipped."""
+        good = sf.encode_frame(1, 1, b"ok", sf.FRAME_F_RESP)
+        bad = bytearray(sf.encode_frame(2, 1, b"xx", sf.FRAME_F_RESP))
+        bad[-1] ^= 0xFF
+        dec = sf.FrameDecoder()
+        frames = list(dec.feed(b"[I] app log\n" + bytes(bad) + good))
+        self.assertEqual([f.seq for f in frames], [1])
+
+
+class TestAssembleResponse(unittest.TestCase):
+    """Tests for assemble_response."""
+
+    def test_data_rendered_as_base64(self):
+        """Consecutive data frames are joined and base64-encoded in place."""
+        frames = [
+            sf.Frame(sf.FRAME_F_RESP | sf.FRAME_F_MORE, 1, 7, b"[FLOK] READ 4 bytes data="),
+            sf.Frame(sf.FRAME_F_RESP | sf.FRAME_F_MORE | sf.FRAME_F_DATA, 1, 7, b"\x00\x01"),
+            sf.Frame(sf.FRAME_F_RESP | sf.FRAME_F_MORE | sf.FRAME_F_DATA, 1, 7, b"\x02\x03"),
+            sf.Frame(sf.FRAME_F_RESP, 1, 7, b"\n[FLEND]\n"),
+        ]
+        text = sf.assemble_response(frames)
+        self.assertEqual(text, "[FLOK] READ 4 bytes data=AAECAw==\n[FLEND]\n")
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -4,14 +4,18 @@
 Serial protocol tests
 """
 
+import base64
 import os
+import struct
 import sys
 import unittest
 from unittest.mock import MagicMock, patch, call
 
 sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
 
+from core import serial_frame
 from core.serial_protocol import FPBProtocol, Platform
+from utils.crc import crc32, crc32_update
 
 
 class TestFPBProtocolWakeupShell(unittest.TestCase):
@@ -623,5 +627,1418 @@ class TestEnablePatch(unittest.TestCase):
         self.protocol.send_cmd.assert_called_once_with("-c enable --comp 0 --enable 1")
 
 
+class FakeFrameSerial:
+    """Serial stub that answers binary frames via a handler(op, payload)."""
+
+    def __init__(self, handler):
+        self.handler = handler
+        self.rx = bytearray()
+        self.written = []
+        self._decoder = serial_frame.FrameDecoder()
+
+    @property
+    def in_waiting(self):
+        return len(self.rx)
+
+    def read(self, n):
+        data = bytes(self.rx[:n])
+        del self.rx[:n]
+        return data
+
+    def write(self, data):
+        self.written.append(bytes(data))
+        for frame in self._decoder.feed(data):
+            chunks = self.handler(frame.op, frame.payload)
+            for i, (flags, chunk) in enumerate(chunks):
+                flags |= serial_frame.FRAME_F_RESP
+                if i < len(chunks) - 1:
+                    flags |= serial_frame.FRAME_F_MORE
+                self.rx += serial_frame.encode_frame(frame.seq, frame.op, chunk, flags)
+
+    def flush(self):
+        pass
+
+    def reset_input_buffer(self):
+        self.rx.clear()
+
+
+class TestBinaryFrames(unittest.TestCase):
+    """Test binary frame negotiation and transport"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.device.raw_serial_log = []
+        self.device.raw_log_next_id = 0
+        self.device.raw_log_max_size = 5000
+        self.device.serial_tx_fragment_size = 0
+        self.protocol = FPBProtocol(self.device)
+        self.protocol._platform = Platform.BARE_METAL
+        self.requests = []
+
+    def _handler(self, op, payload):
+        self.requests.append((op, payload))
+        if op == serial_frame.OPCODES["ping"]:
+            return [(0, b"[FLOK] PONG caps=0x00000001\n[FLEND]\n")]
+        if op == serial_frame.OPCODES["read"]:
+            return [
+                (0, b"[FLOK] READ 4 bytes crc=0x0000 data="),
+                (serial_frame.FRAME_F_DATA, b"\x01\x02\x03\x04"),
+                (0, b"\n[FLEND]\n"),
+            ]
+        return [(0, b"[FLOK] OK\n[FLEND]\n")]
+
+    def test_ping_without_caps_keeps_text(self):
+        """A PONG without caps leaves the text transport selected"""
+        self.device.ser = MagicMock()
+        with patch.object(self.protocol, "send_cmd", return_value="[FLOK] PONG"):
+            ok, _ = self.protocol.ping()
+        self.assertTrue(ok)
+        self.assertEqual(self.protocol.caps, 0)
+        self.assertFalse(self.protocol.frame_mode_active())
+
+    def test_ping_negotiates_frames(self):
+        """PONG caps with CAP_FRAME switches to binary frames"""
+        self.device.ser = FakeFrameSerial(self._handler)
+        with patch.object(
+            self.protocol, "send_cmd", return_value="[FLOK] PONG caps=0x00000001"
+        ):
+            self.protocol.ping()
+        self.assertTrue(self.protocol.frame_mode_active())
+
+        # A new port must be renegotiated
+        self.device.ser = FakeFrameSerial(self._handler)
+        self.assertFalse(self.protocol.frame_mode_active())
+
+    def test_send_cmd_uses_frames(self):
+        """Commands travel as frames and data comes back as base64 text"""
+        self.device.ser = FakeFrameSerial(self._handler)
+        self.protocol._frame_ser = self.device.ser
+
+        resp = self.protocol.send_cmd("-c read --addr 0x1000 --len 4")
+
+        self.assertEqual(resp, "[FLOK] READ 4 bytes crc=0x0000 data=AQIDBA==")
+        self.assertEqual(len(self.requests), 1)
+        op, payload = self.requests[0]
+        self.assertEqual(op, serial_frame.OPCODES["read"])
+        self.assertIn(serial_frame.tlv(serial_frame.TAG_LEN, b"\x04\0\0\0"), payload)
+        self.assertTrue(self.device.ser.written[0].startswith(b"\n\xa5"))
+
+    def test_upload_sends_raw_bytes(self):
+        """Upload data is carried raw, not as base64"""
+        self.device.ser = FakeFrameSerial(self._handler)
+        self.protocol._frame_ser = self.device.ser
+
+        self.protocol.send_cmd("-c upload --addr 0 --data AAECAw== --crc 0x1")
+
+        _, payload = self.requests[0]
+        self.assertIn(serial_frame.tlv(serial_frame.TAG_BIN, b"\0\1\2\3"), payload)
+
+    def test_fallback_to_text(self):
+        """No frame response disables frames and retries as text"""
+        ser = FakeFrameSerial(lambda op, payload: [])
+        self.device.ser = ser
+        self.protocol._frame_ser = ser
+
+        with patch.object(
+            self.protocol, "_send_frame", return_value=None
+        ) as send_frame, patch("time.sleep"):
+            ser.write = MagicMock(
+                side_effect=lambda data: ser.rx.extend(b"[FLOK] PONG\n[FLEND]\n")
+            )
+            resp = self.protocol.send_cmd("-c ping", timeout=0.5, max_retries=0)
+
+        send_frame.assert_called_once()
+        self.assertIn("PONG", resp)
+        self.assertFalse(self.protocol.frame_mode_active())
+        ser.write.assert_called_with(b"fl -c ping\n")
+
+
+class FakeUploadSerial:
+    """Serial stub emulating text-mode upload handling on the device."""
+
+    def __init__(self, drop=(), corrupt=(), fail=(), sticky=False):
+        self.memory = {}
+        self.sticky = sticky
+        self.drop = set(drop)
+        self.corrupt = set(corrupt)
+        self.fail = set(fail)
+        self.rx = bytearray()
+        self.lines = []
+        self._line = b""
+
+    @property
+    def in_waiting(self):
+        return len(self.rx)
+
+    def read(self, n):
+        data = bytes(self.rx[:n])
+        del self.rx[:n]
+        return data
+
+    def write(self, data):
+        self._line += data
+        while b"\n" in self._line:
+            line, self._line = self._line.split(b"\n", 1)
+            if line:
+                self._handle(line.decode())
+
+    def _handle(self, line):
+        import base64
+        import re
+
+        self.lines.append(line)
+        off = int(re.search(r"-a 0x([0-9A-F]+)", line).group(1), 16)
+        if off in self.drop:
+            self.drop.discard(off)
+            return
+        if off in self.corrupt:
+            if not self.sticky:
+                self.corrupt.discard(off)
+            resp = f"[FLERR] CRC mismatch off=0x{off:X}: 0x0000 != 0x1111"
+        elif off in self.fail:
+            resp = f"[FLERR] No allocation off=0x{off:X}, call alloc first"
+        else:
+            data = base64.b64decode(re.search(r"-d (\S+)", line).group(1))
+            for i, b in enumerate(data):
+                self.memory[off + i] = b
+            resp = f"[FLOK] Uploaded {len(data)} bytes off=0x{off:X} to 0x{0x20000000 + off:X}"
+        self.rx += (resp + "\n[FLEND]\n").encode()
+
+    def flush(self):
+        pass
+
+    def reset_input_buffer(self):
+        self.rx.clear()
+
+
+class TestUploadPipelined(unittest.TestCase):
+    """Test sliding-window upload"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.device.raw_serial_log = []
+        self.device.raw_log_next_id = 0
+        self.device.raw_log_max_size = 5000
+        self.device.serial_tx_fragment_size = 0
+        self.device.upload_chunk_size = 16
+        self.device.upload_window = 4
+        self.device.transfer_max_retries = 2
+        self.protocol = FPBProtocol(self.device)
+        self.protocol._platform = Platform.BARE_METAL
+        self.protocol.caps = 0x2
+        self.data = bytes(range(100))
+
+    def _uploaded(self, ser, base=0):
+        return bytes(ser.memory.get(base + i, 0xEE) for i in range(len(self.data)))
+
+    def test_stop_and_wait_without_cap(self):
+        """Old firmware without offset acks keeps one chunk in flight"""
+        self.protocol.caps = 0
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] Uploaded")
+        ok, result = self.protocol.upload(self.data)
+        self.assertTrue(ok)
+        self.assertEqual(self.protocol.send_cmd.call_count, 7)
+        self.assertNotIn("window", result)
+
+    def test_window_one_uses_stop_and_wait(self):
+        """upload_window=1 disables pipelining"""
+        self.device.upload_window = 1
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] Uploaded")
+        ok, _ = self.protocol.upload(self.data)
+        self.assertTrue(ok)
+        self.assertEqual(self.protocol.send_cmd.call_count, 7)
+
+    def test_pipelined_upload(self):
+        """All chunks are uploaded once with progress reported"""
+        ser = FakeUploadSerial()
+        self.device.ser = ser
+        progress = MagicMock()
+        ok, result = self.protocol.upload(self.data, 0x40, progress)
+        self.assertTrue(ok)
+        self.assertEqual(self._uploaded(ser, 0x40), self.data)
+        self.assertEqual(len(ser.lines), 7)
+        self.assertEqual(result["chunks"], 7)
+        self.assertEqual(result["retransmits"], 0)
+        self.assertEqual(result["window"], 4)
+        progress.assert_called_with(100, 100)
+
+    def test_lost_chunk_retransmitted(self):
+        """A missing ack before a later one triggers a selective resend"""
+        ser = FakeUploadSerial(drop=[16])
+        self.device.ser = ser
+        ok, result = self.protocol.upload(self.data)
+        self.assertTrue(ok)
+        self.assertEqual(self._uploaded(ser), self.data)
+        self.assertEqual(result["retransmits"], 1)
+        self.assertEqual(len(ser.lines), 8)
+        self.assertLess(result["window"], 4)
+
+    def test_crc_mismatch_retransmitted(self):
+        """CRC failures are resent without aborting the upload"""
+        ser = FakeUploadSerial(corrupt=[32])
+        self.device.ser = ser
+        ok, result = self.protocol.upload(self.data)
+        self.assertTrue(ok)
+        self.assertEqual(self._uploaded(ser), self.data)
+        self.assertEqual(result["retransmits"], 1)
+
+    def test_tail_loss_recovered_by_timeout(self):
+        """Losing the last chunk in flight is recovered after a timeout"""
+        ser = FakeUploadSerial(drop=[96])
+        self.device.ser = ser
+        ok, result = self.protocol.upload(self.data)
+        self.assertTrue(ok)
+        self.assertEqual(self._uploaded(ser), self.data)
+        self.assertEqual(result["retransmits"], 1)
+
+    def test_device_error_aborts(self):
+        """Non-CRC errors are not retried"""
+        ser = FakeUploadSerial(fail=[48])
+        self.device.ser = ser
+        ok, result = self.protocol.upload(self.data)
+        self.assertFalse(ok)
+        self.assertIn("0x30", result["error"])
+        self.assertIn("No allocation", result["error"])
+
+    def test_retries_exhausted(self):
+        """A chunk that keeps failing aborts after transfer_max_retries"""
+        ser = FakeUploadSerial(corrupt=[0], sticky=True)
+        self.device.ser = ser
+        ok, result = self.protocol.upload(self.data)
+        self.assertFalse(ok)
+        self.assertIn("offset 0x0", result["error"])
+        self.assertIn("CRC mismatch", result["error"])
+
+
+class TestCRC32Mode(unittest.TestCase):
+    """Test CRC-32 requests when the device reports CAP_CRC32"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.device.upload_chunk_size = 128
+        self.device.download_chunk_size = 128
+        self.protocol = FPBProtocol(self.device)
+        self.protocol.caps = 0x8
+
+    def test_upload_sends_crc32(self):
+        """upload announces --crc32 and sends an 8-digit CRC"""
+        import re
+        import struct
+        from utils.crc import crc32_update
+
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] Uploaded 4 bytes")
+        data = b"\x01\x02\x03\x04"
+        self.protocol.upload(data, start_offset=0x40)
+
+        cmd_str = self.protocol.send_cmd.call_args[0][0]
+        m = re.search(r"--crc32 -r 0x([0-9A-F]{8})$", cmd_str)
+        self.assertIsNotNone(m)
+        expected = crc32_update(0, struct.pack("<II", 0x40, len(data)))
+        self.assertEqual(int(m.group(1), 16), crc32_update(expected, data))
+
+    def test_read_verifies_crc32(self):
+        """read_memory requests and verifies CRC-32"""
+        import base64
+        import struct
+        from utils.crc import crc32_update
+
+        addr = 0x20000000
+        raw = b"\xaa\xbb\xcc\xdd"
+        hdr_crc = crc32_update(0, struct.pack("<II", addr, len(raw)))
+        resp_crc = crc32_update(hdr_crc, raw)
+        b64 = base64.b64encode(raw).decode()
+        self.protocol.send_cmd = MagicMock(
+            return_value=f"[FLOK] READ 4 bytes crc=0x{resp_crc:08X} data={b64}"
+        )
+
+        data, _ = self.protocol.read_memory(addr, 4)
+        self.assertEqual(data, raw)
+        cmd_str = self.protocol.send_cmd.call_args[0][0]
+        self.assertIn(f"--crc32 --crc 0x{hdr_crc:08X}", cmd_str)
+
+        # A CRC-16 of the same data is rejected
+        self.protocol.caps = 0
+        self.assertIsNone(
+            self.protocol._parse_read_response(
+                f"[FLOK] READ 4 bytes crc=0x{resp_crc:08X} data={b64}", addr=addr
+            )
+        )
+
+    def test_patch_crc32(self):
+        """Patch commands carry a CRC-32 of comp/orig/target"""
+        import struct
+        from utils.crc import crc32
+
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] Patch 0")
+        self.protocol.patch(0, 0x08001000, 0x20001000)
+        cmd_str = self.protocol.send_cmd.call_args[0][0]
+        crc = crc32(struct.pack("<III", 0, 0x08001000, 0x20001000))
+        self.assertIn(f"--crc32 --crc 0x{crc:08X}", cmd_str)
+
+    def test_without_cap_keeps_crc16(self):
+        """Older firmware keeps getting CRC-16"""
+        self.protocol.caps = 0x2
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] WRITE 4 bytes")
+        self.protocol.write_memory(0x20001000, b"\x00" * 4)
+        cmd_str = self.protocol.send_cmd.call_args[0][0]
+        self.assertNotIn("--crc32", cmd_str)
+        self.assertRegex(cmd_str, r"--crc 0x[0-9A-F]{4}$")
+
+
+class TestUploadStreamed(unittest.TestCase):
+    """Test streamed upload (data decoded on the device as it arrives)"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.device.upload_chunk_size = 128
+        self.device.transfer_max_retries = 2
+        self.protocol = FPBProtocol(self.device)
+        self.protocol.caps = 0x7
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] Uploaded")
+
+    def test_large_segments(self):
+        """Data goes out in STREAM_SEGMENT_SIZE commands, --len before --data"""
+        import base64
+        import re
+        import struct
+        from core.serial_protocol import STREAM_SEGMENT_SIZE
+        from utils.crc import crc16_update
+
+        data = bytes(i & 0xFF for i in range(STREAM_SEGMENT_SIZE * 2 + 100))
+        progress = MagicMock()
+        ok, result = self.protocol.upload(data, 0x10, progress)
+
+        self.assertTrue(ok)
+        self.assertEqual(result["chunks"], 3)
+        calls = self.protocol.send_cmd.call_args_list
+        self.assertEqual(len(calls), 3)
+        for c in calls:
+            self.assertFalse(c.kwargs["allow_frame"])
+
+        cmd = calls[1].args[0]
+        m = re.fullmatch(
+            r"-c upload -a 0x([0-9A-F]+) -l (\d+) -r 0x([0-9A-F]{4}) -d (\S+)", cmd
+        )
+        self.assertIsNotNone(m)
+        off = int(m.group(1), 16)
+        self.assertEqual(off, 0x10 + STREAM_SEGMENT_SIZE)
+        self.assertEqual(int(m.group(2)), STREAM_SEGMENT_SIZE)
+        chunk = base64.b64decode(m.group(4))
+        self.assertEqual(chunk, data[STREAM_SEGMENT_SIZE : STREAM_SEGMENT_SIZE * 2])
+        crc = crc16_update(0xFFFF, struct.pack("<II", off, len(chunk)))
+        self.assertEqual(int(m.group(3), 16), crc16_update(crc, chunk))
+        progress.assert_called_with(len(data), len(data))
+
+    def test_crc_mismatch_retried(self):
+        """A corrupted segment is resent"""
+        self.protocol.send_cmd.side_effect = [
+            "[FLERR] CRC mismatch off=0x0: 0x1234 != 0x5678",
+            "[FLOK] Uploaded 10 bytes off=0x0",
+        ]
+        ok, result = self.protocol.upload(b"\x00" * 10)
+        self.assertTrue(ok)
+        self.assertEqual(result["retransmits"], 1)
+
+    def test_error_aborts(self):
+        """Other errors and exhausted retries fail the upload"""
+        self.protocol.send_cmd.return_value = "[FLERR] Upload exceeds allocation"
+        ok, result = self.protocol.upload(b"\x00" * 10)
+        self.assertFalse(ok)
+        self.assertIn("exceeds allocation", result["error"])
+        self.assertEqual(self.protocol.send_cmd.call_count, 1)
+
+        self.protocol.send_cmd.reset_mock()
+        self.protocol.send_cmd.return_value = "[FLERR] CRC mismatch off=0x0"
+        ok, _ = self.protocol.upload(b"\x00" * 10)
+        self.assertFalse(ok)
+        self.assertEqual(self.protocol.send_cmd.call_count, 3)
+
+
+class TestLZTransfer(unittest.TestCase):
+    """Test --z transfers when the device reports CAP_LZ"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.device.upload_chunk_size = 128
+        self.device.download_chunk_size = 1024
+        self.device.upload_window = 1
+        self.device.transfer_max_retries = 2
+        self.protocol = FPBProtocol(self.device)
+        self.protocol.caps = 0x10
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] Uploaded")
+
+    def _sent_data(self):
+        """Reassemble uploaded bytes from the sent commands."""
+        import base64
+        import re
+        from utils import lz
+
+        out = {}
+        for c in self.protocol.send_cmd.call_args_list:
+            cmd = c.args[0]
+            off = int(re.search(r"-a 0x([0-9A-F]+)", cmd).group(1), 16)
+            data = base64.b64decode(re.search(r"-d (\S+)", cmd).group(1))
+            if " --z" in cmd:
+                data = lz.decompress(data)
+            for i, b in enumerate(data):
+                out[off + i] = b
+        return bytes(out[i] for i in sorted(out))
+
+    def test_upload_compressed(self):
+        """Compressible data goes out in large --z chunks"""
+        import re
+        import struct
+        from utils.crc import crc16_update
+
+        data = bytes(3000) + bytes(range(256)) * 4
+        ok, result = self.protocol.upload(data)
+        self.assertTrue(ok)
+        self.assertEqual(self._sent_data(), data)
+        self.assertLess(result["chunks"], len(data) // 128)
+        self.assertLess(result["ratio"], 0.5)
+        self.assertGreater(result["gain"], 2.0)
+        self.assertEqual(result["wire_bytes"], round(len(data) * result["ratio"]))
+
+        # CRC covers the uncompressed chunk
+        cmd = self.protocol.send_cmd.call_args_list[0].args[0]
+        self.assertIn(" --z ", cmd)
+        crc = crc16_update(0xFFFF, struct.pack("<II", 0, 1024))
+        crc = crc16_update(crc, data[:1024])
+        self.assertEqual(int(re.search(r"-r 0x([0-9A-F]+)", cmd).group(1), 16), crc)
+
+    def test_upload_incompressible_raw(self):
+        """Data that does not shrink is sent raw"""
+        import random
+
+        data = random.Random(1).randbytes(600)
+        ok, result = self.protocol.upload(data)
+        self.assertTrue(ok)
+        self.assertEqual(self._sent_data(), data)
+        for c in self.protocol.send_cmd.call_args_list:
+            self.assertNotIn("--z", c.args[0])
+        self.assertEqual(result["chunks"], 5)
+        self.assertEqual(result["ratio"], 1.0)
+
+    def test_upload_prefers_stream_unless_compressible(self):
+        """With streaming, only well-compressed data takes the --z path"""
+        import random
+
+        self.protocol.caps = 0x14
+        self.protocol.upload(random.Random(2).randbytes(600))
+        self.assertIn(" -l ", self.protocol.send_cmd.call_args.args[0])
+
+        self.protocol.send_cmd.reset_mock()
+        self.protocol.upload(bytes(2048))
+        self.assertIn(" --z ", self.protocol.send_cmd.call_args.args[0])
+
+    def test_read_compressed(self):
+        """read_memory asks for --z and inflates z= responses"""
+        import base64
+        import struct
+        from utils import lz
+        from utils.crc import crc16_update
+
+        addr = 0x20000000
+        raw = bytes(200) + b"\x01\x02" * 28
+        packed = lz.compress(raw)
+        crc = crc16_update(0xFFFF, struct.pack("<II", addr, len(raw)))
+        crc = crc16_update(crc, raw)
+        b64 = base64.b64encode(packed).decode()
+        self.protocol.send_cmd.return_value = (
+            f"[FLOK] READ {len(raw)} bytes crc=0x{crc:04X} z={len(packed)} data={b64}"
+        )
+
+        data, msg = self.protocol.read_memory(addr, len(raw))
+        self.assertEqual(data, raw)
+        self.assertTrue(self.protocol.send_cmd.call_args.args[0].endswith(" --z"))
+        self.assertIn("ratio", msg)
+        self.assertIn("gain", msg)
+
+    def test_read_bad_block_rejected(self):
+        """A z= payload that does not inflate is a failed read"""
+        resp = "[FLOK] READ 4 bytes crc=0x0000 z=1 data=8A=="
+        self.assertIsNone(self.protocol._parse_read_response(resp))
+
+
+class TestHashBlocks(unittest.TestCase):
+    """Test hash_blocks (per-block CRCs for delta upload)"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.protocol = FPBProtocol(self.device)
+        self.protocol.caps = 0x28
+        self.memory = bytes(i * 3 & 0xFF for i in range(40000))
+        self.protocol.send_cmd = MagicMock(side_effect=self._device_cmd)
+
+    def _device_cmd(self, cmd, **kwargs):
+        import base64
+        import re
+        import struct
+        from utils.crc import crc32_update
+
+        m = re.search(r"--addr 0x([0-9A-F]+) --len (\d+) --size (\d+)", cmd)
+        addr, n, bs = int(m.group(1), 16), int(m.group(2)), int(m.group(3))
+        data = self.memory[addr : addr + n]
+        raw = b"".join(
+            struct.pack("<I", crc32_update(0, data[i : i + bs]))
+            for i in range(0, n, bs)
+        )
+        crc = crc32_update(crc32_update(0, struct.pack("<II", addr, n)), raw)
+        b64 = base64.b64encode(raw).decode()
+        return f"[FLOK] HASH {len(raw) // 4} blocks bs={bs} crc=0x{crc:08X} data={b64}"
+
+    def test_split_and_match(self):
+        """Large ranges are split; CRCs match block_crc()"""
+        crcs, _ = self.protocol.hash_blocks(0x10, 20000)
+        self.assertEqual(len(crcs), (20000 + 63) // 64)
+        # 256 CRC-32s per response
+        self.assertEqual(self.protocol.send_cmd.call_count, 2)
+        cmd = self.protocol.send_cmd.call_args_list[1].args[0]
+        self.assertIn(f"--addr 0x{0x10 + 256 * 64:X}", cmd)
+        self.assertIn("--crc32", cmd)
+        self.assertEqual(crcs[5], self.protocol.block_crc(self.memory[0x150:0x190]))
+        self.assertEqual(
+            crcs[-1], self.protocol.block_crc(self.memory[0x10 + 19968 : 0x10 + 20000])
+        )
+
+    def test_corrupt_response(self):
+        """A response CRC mismatch fails the hash"""
+        self.protocol.send_cmd = MagicMock(
+            return_value="[FLOK] HASH 1 blocks bs=64 crc=0x00000000 data=AAAAAA=="
+        )
+        crcs, msg = self.protocol.hash_blocks(0x20000000, 64)
+        self.assertIsNone(crcs)
+        self.assertIn("CRC mismatch", msg)
+
+    def test_error(self):
+        """Device errors are reported"""
+        self.protocol.send_cmd = MagicMock(return_value="[FLERR] Unknown: hash")
+        crcs, msg = self.protocol.hash_blocks(0x20000000, 64)
+        self.assertIsNone(crcs)
+        self.assertIn("Unknown", msg)
+
+
+class TestBatch(unittest.TestCase):
+    """Test the batch builder and its per-command results"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.device.upload_chunk_size = 128
+        self.protocol = FPBProtocol(self.device)
+        self.protocol.caps = 0x48  # CAP_BATCH | CAP_CRC32
+
+    def test_records_and_results(self):
+        """Commands travel as frame records; each gets its own result"""
+        self.protocol.send_cmd = MagicMock(
+            return_value="[FLOK] Unpatched slot 0\n"
+            "[FLOK] Allocated 64 at 0x20001000\n"
+            "[FLOK] BATCH 2/2"
+        )
+        ok, results, msg = self.protocol.batch(["-c unpatch --comp 0", "-c alloc -s 64"])
+
+        self.assertTrue(ok)
+        self.assertEqual(msg, "BATCH 2/2")
+        self.assertEqual([r["msg"][:9] for r in results], ["Unpatched", "Allocated"])
+        cmd = self.protocol.send_cmd.call_args.args[0]
+        self.assertTrue(cmd.startswith("-c batch --data "))
+        records = base64.b64decode(cmd.split()[-1])
+        self.assertEqual(
+            records,
+            serial_frame.batch_record("-c unpatch --comp 0")
+            + serial_frame.batch_record("-c alloc -s 64"),
+        )
+
+    def test_stop_on_error(self):
+        """The failing command is the last result"""
+        self.protocol.send_cmd = MagicMock(
+            return_value="[FLOK] Uploaded 4 bytes\n"
+            "[FLERR] CRC mismatch\n"
+            "[FLERR] BATCH 1/3"
+        )
+        ok, results, msg = self.protocol.batch(["-c ping"] * 3)
+        self.assertFalse(ok)
+        self.assertEqual(msg, "BATCH 1/3")
+        self.assertEqual(len(results), 2)
+        self.assertFalse(results[-1]["ok"])
+
+    def test_rejected(self):
+        """A batch rejected before running has no results"""
+        self.protocol.send_cmd = MagicMock(
+            return_value="[FLERR] Op 0x07 not allowed in batch"
+        )
+        ok, results, msg = self.protocol.batch(["-c read --addr 0x0 --len 4"])
+        self.assertFalse(ok)
+        self.assertEqual(results, [])
+        self.assertIn("not allowed", msg)
+
+    def test_fits(self):
+        """Batches need CAP_BATCH and must fit one upload chunk"""
+        self.assertTrue(self.protocol.batch_fits(["-c alloc -s 64"]))
+        self.assertFalse(self.protocol.batch_fits(["-c alloc -s 64"] * 20))
+        self.assertFalse(self.protocol.batch_fits(["-c bogus"]))
+        self.protocol.caps = 0x08
+        self.assertFalse(self.protocol.batch_fits(["-c alloc -s 64"]))
+
+    def test_alloc_with_unpatch(self):
+        """alloc(unpatch_comp=) clears the slot in the same round trip"""
+        self.protocol.send_cmd = MagicMock(
+            return_value="[FLOK] Unpatched slot 2\n"
+            "[FLOK] Allocated 64 at 0x20001000\n"
+            "[FLOK] BATCH 2/2"
+        )
+        addr, err = self.protocol.alloc(64, unpatch_comp=2)
+        self.assertEqual(addr, 0x20001000)
+        self.assertEqual(err, "")
+        self.protocol.send_cmd.assert_called_once()
+
+        self.protocol.caps = 0
+        self.protocol.send_cmd = MagicMock(
+            side_effect=["[FLOK] Unpatched", "[FLOK] Allocated 64 at 0x20002000"]
+        )
+        addr, _ = self.protocol.alloc(64, unpatch_comp=2)
+        self.assertEqual(addr, 0x20002000)
+        self.assertEqual(
+            self.protocol.send_cmd.call_args_list[0].args[0], "-c unpatch --comp 2"
+        )
+
+
+class TestStage(unittest.TestCase):
+    """Test staged patches and commit/abort"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.device.upload_chunk_size = 128
+        self.protocol = FPBProtocol(self.device)
+        self.protocol.caps = 0xC0  # CAP_STAGE | CAP_BATCH
+
+    def test_stage_flag(self):
+        """stage=True appends --stage after the request CRC"""
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] Staged 1")
+        ok, msg = self.protocol.tpatch(1, 0x08002000, 0x20003000, stage=True)
+        self.assertTrue(ok)
+        cmd = self.protocol.send_cmd.call_args.args[0]
+        self.assertTrue(cmd.startswith("-c tpatch --comp 1 "))
+        self.assertTrue(cmd.endswith(" --stage"))
+        self.assertNotIn("--stage", self.protocol.patch_cmd("patch", 0, 0x100, 0x200))
+        # Staged patches can be batched with the commit
+        self.assertTrue(self.protocol.batch_fits([cmd, "-c commit"]))
+
+    def test_commit_abort(self):
+        """commit/abort report the device result"""
+        self.assertTrue(self.protocol.stage_supported())
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] Committed 2")
+        self.assertEqual(self.protocol.commit(), (True, "Committed 2"))
+        self.protocol.send_cmd.assert_called_with("-c commit")
+
+        self.protocol.send_cmd = MagicMock(return_value="[FLERR] Nothing staged")
+        self.assertEqual(self.protocol.commit(), (False, "Nothing staged"))
+
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] Aborted 1")
+        self.assertTrue(self.protocol.abort()[0])
+        self.protocol.send_cmd.assert_called_with("-c abort")
+
+        self.protocol.caps = 0x40
+        self.assertFalse(self.protocol.stage_supported())
+
+
+class TestRetarget(unittest.TestCase):
+    """Test retarget of a live tpatch/dpatch slot"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.device.upload_chunk_size = 128
+        self.protocol = FPBProtocol(self.device)
+        self.protocol.caps = 0x10040  # CAP_RETARGET | CAP_BATCH
+
+    def test_retarget(self):
+        """retarget carries the patch CRC and the expected mode"""
+        self.assertTrue(self.protocol.retarget_supported())
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] Retarget 1")
+        ok, msg = self.protocol.retarget(1, 0x08002000, 0x20003001, "dpatch")
+        self.assertEqual((ok, msg), (True, "Retarget 1"))
+        cmd = self.protocol.send_cmd.call_args.args[0]
+        crc = self.protocol.patch_cmd("dpatch", 1, 0x08002000, 0x20003001).split()[-1]
+        self.assertEqual(
+            cmd,
+            f"-c retarget --comp 1 --orig 0x8002000 --target 0x20003001 "
+            f"--crc {crc} --mode dpatch",
+        )
+        # Batched behind the upload of the new code
+        self.assertTrue(self.protocol.batch_fits([cmd]))
+
+        self.protocol.caps = 0x40
+        self.assertFalse(self.protocol.retarget_supported())
+
+
+class TestIPatch(unittest.TestCase):
+    """Test single-instruction patch commands"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.device.upload_chunk_size = 128
+        self.protocol = FPBProtocol(self.device)
+        self.protocol.caps = 0x20000  # CAP_IPATCH
+
+    def test_ipatch(self):
+        """ipatch carries comp/addr/insn under the patch CRC"""
+        self.assertTrue(self.protocol.ipatch_supported())
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] IPatch 2")
+        ok, msg = self.protocol.ipatch(2, 0x08001004, 0xF1B00F01)
+        self.assertEqual((ok, msg), (True, "IPatch 2"))
+        cmd = self.protocol.send_cmd.call_args.args[0]
+        crc = self.protocol.patch_cmd("patch", 2, 0x08001004, 0xF1B00F01).split()[-1]
+        self.assertEqual(
+            cmd, f"-c ipatch --comp 2 --addr 0x8001004 --insn 0xF1B00F01 --crc {crc}"
+        )
+        self.assertTrue(
+            self.protocol.ipatch_cmd(0, 0x100, 0x2801, stage=True).endswith(" --stage")
+        )
+
+        self.protocol.caps = 0x10000
+        self.assertFalse(self.protocol.ipatch_supported())
+
+    def test_info_ipatch_slot(self):
+        """ipatch slots are listed with their instruction and no code"""
+        self.protocol.send_cmd = MagicMock(
+            return_value="""FPBInject v1.0
+Used: 0
+Slots: 1/6
+Slot[0]: 0x08001002 insn 0x00002801 (COMP=0x08001001, remap, on)
+Slot[1]: empty (COMP=0x00000000, off)
+[FLOK] Info complete"""
+        )
+        info, error = self.protocol.info()
+        self.assertEqual(error, "")
+        slot = info["slots"][0]
+        self.assertTrue(slot["occupied"])
+        self.assertTrue(slot["enabled"])
+        self.assertEqual(slot["orig_addr"], 0x08001002)
+        self.assertEqual(slot["insn"], 0x2801)
+        self.assertEqual(slot["code_size"], 0)
+        self.assertFalse(info["slots"][1]["occupied"])
+
+
+class TestMemCrc(unittest.TestCase):
+    """Test on-device memcrc/memcmp verification"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.device.upload_chunk_size = 128
+        self.protocol = FPBProtocol(self.device)
+        self.protocol.caps = 0x100  # CAP_MEMCRC
+
+    def crc_resp(self, addr, data, crc=None):
+        crc = crc32(data) if crc is None else crc
+        return f"[FLOK] MEMCRC 0x{addr:08X} len={len(data)} crc=0x{crc:08X}"
+
+    def test_mem_crc(self):
+        """mem_crc parses the CRC and checks the echoed range"""
+        data = b"\x11" * 300
+        self.protocol.send_cmd = MagicMock(
+            return_value=self.crc_resp(0x20001000, data)
+        )
+        self.assertEqual(self.protocol.mem_crc(0x20001000, 300), (crc32(data), ""))
+        cmd = self.protocol.send_cmd.call_args.args[0]
+        self.assertEqual(cmd, "-c memcrc --addr 0x20001000 --len 300")
+        # A reply for another range is not trusted
+        self.assertIsNone(self.protocol.mem_crc(0x20001000, 299)[0])
+
+        self.protocol.send_cmd = MagicMock(return_value="[FLERR] Invalid length 0")
+        self.assertEqual(
+            self.protocol.mem_crc(0x20001000, 0), (None, "Invalid length 0")
+        )
+
+    def test_mem_cmp(self):
+        """mem_cmp reports the first difference as a failure"""
+        self.protocol.send_cmd = MagicMock(
+            return_value="[FLERR] MEMCMP differ at +0x10"
+        )
+        self.assertEqual(
+            self.protocol.mem_cmp(0x100, 0x200, 64), (False, "MEMCMP differ at +0x10")
+        )
+        self.assertEqual(
+            self.protocol.send_cmd.call_args.args[0],
+            "-c memcmp --addr 0x100 --target 0x200 --len 64",
+        )
+
+    def test_verify_memory(self):
+        """verify_memory compares the device CRC with the local one"""
+        data = bytes(range(64))
+        self.protocol.send_cmd = MagicMock(return_value=self.crc_resp(0x100, data))
+        self.assertEqual(self.protocol.verify_memory(0x100, data), (True, ""))
+
+        self.protocol.send_cmd = MagicMock(return_value=self.crc_resp(0x100, data, 1))
+        ok, msg = self.protocol.verify_memory(0x100, data)
+        self.assertFalse(ok)
+        self.assertIn("CRC 0x00000001", msg)
+
+        self.protocol.caps = 0
+        self.protocol.send_cmd = MagicMock()
+        self.assertIsNone(self.protocol.verify_memory(0x100, data)[0])
+        self.protocol.send_cmd.assert_not_called()
+
+    def test_write_memory_verified(self):
+        """write_memory verifies the written range once at the end"""
+        data = bytes(range(200))
+        replies = ["[FLOK] WRITE 128 bytes", "[FLOK] WRITE 72 bytes"]
+        self.protocol.send_cmd = MagicMock(
+            side_effect=replies + [self.crc_resp(0x20000000, data)]
+        )
+        ok, msg = self.protocol.write_memory(0x20000000, data)
+        self.assertTrue(ok)
+        self.assertIn("verified", msg)
+        self.assertIn("memcrc", self.protocol.send_cmd.call_args.args[0])
+
+        self.protocol.send_cmd = MagicMock(
+            side_effect=replies + [self.crc_resp(0x20000000, data, 0)]
+        )
+        ok, msg = self.protocol.write_memory(0x20000000, data)
+        self.assertFalse(ok)
+        self.assertIn("verify failed", msg)
+
+    def test_upload_verified(self):
+        """upload verifies at alloc base + offset"""
+        data = bytes(range(100))
+        self.protocol._alloc_base = 0x20004000
+        self.protocol._upload = MagicMock(side_effect=lambda *a: (True, {"bytes": 100}))
+        self.protocol.send_cmd = MagicMock(
+            return_value=self.crc_resp(0x20004010, data)
+        )
+        ok, result = self.protocol.upload(data, start_offset=0x10)
+        self.assertTrue(ok)
+        self.assertTrue(result["verified"])
+        self.assertIn("--addr 0x20004010", self.protocol.send_cmd.call_args.args[0])
+
+        # Unknown base: nothing to verify against
+        self.protocol._alloc_base = None
+        self.protocol.send_cmd = MagicMock()
+        ok, result = self.protocol.upload(data)
+        self.assertTrue(ok)
+        self.assertNotIn("verified", result)
+        self.protocol.send_cmd.assert_not_called()
+
+
+class TestMemOps(unittest.TestCase):
+    """Test on-device memset/memcpy/memfind"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.protocol = FPBProtocol(self.device)
+
+    def test_mem_set_copy(self):
+        """mem_set/mem_copy send one command with a length-scaled timeout"""
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] MEMSET done")
+        self.assertTrue(self.protocol.mem_set(0x20000000, 65536, 0x1A5)[0])
+        self.protocol.send_cmd.assert_called_once()
+        call_args = self.protocol.send_cmd.call_args
+        self.assertEqual(
+            call_args.args[0], "-c memset --addr 0x20000000 --len 65536 --value 165"
+        )
+        self.assertGreater(call_args.kwargs["timeout"], 2.0)
+
+        self.protocol.send_cmd = MagicMock(return_value="[FLERR] Invalid address")
+        ok, msg = self.protocol.mem_copy(0x100, 0x200, 16)
+        self.assertFalse(ok)
+        self.assertEqual(msg, "Invalid address")
+        self.assertEqual(
+            self.protocol.send_cmd.call_args.args[0],
+            "-c memcpy --addr 0x100 --target 0x200 --len 16",
+        )
+
+    def test_mem_find(self):
+        """mem_find sends the pattern as base64 and parses the address"""
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] MEMFIND 0x20000404")
+        self.assertEqual(
+            self.protocol.mem_find(0x20000000, 4096, b"\xef\xbe\xad\xde"),
+            (0x20000404, ""),
+        )
+        self.assertIn("--data 776t3g==", self.protocol.send_cmd.call_args.args[0])
+
+        self.protocol.send_cmd = MagicMock(return_value="[FLERR] MEMFIND not found")
+        self.assertEqual(
+            self.protocol.mem_find(0x20000000, 4096, b"\x00"),
+            (None, "MEMFIND not found"),
+        )
+
+
+class TestReadv(unittest.TestCase):
+    """Test scatter-gather reads (read_memory_multi / readv)"""
+
+    BASE = 0x20000000
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.device.download_chunk_size = 256
+        self.device.upload_chunk_size = 128
+        self.protocol = FPBProtocol(self.device)
+        self.protocol.caps = 0x408  # CAP_READV | CAP_CRC32
+        self.mem = bytes((i * 7) & 0xFF for i in range(4096))
+        self.protocol.send_cmd = MagicMock(side_effect=self.fake_device)
+
+    def fake_device(self, cmd, timeout=0.5):
+        """Answer read/readv like the firmware, from self.mem."""
+        args = cmd.split()
+        addr = int(args[args.index("--addr") + 1], 16)
+        if args[1] == "read":
+            n = int(args[args.index("--len") + 1])
+            data = self.mem[addr - self.BASE : addr - self.BASE + n]
+            crc = crc32(struct.pack("<II", addr, n) + data)
+            b64 = base64.b64encode(data).decode()
+            return f"[FLOK] READ {n} bytes crc=0x{crc:08X} data={b64}"
+        ranges = base64.b64decode(args[args.index("--data") + 1])
+        values, v, shift = [], 0, 0
+        for byte in ranges:
+            v |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                values.append(v)
+                v, shift = 0, 0
+        data = b""
+        pos = addr - self.BASE
+        for gap, n in zip(values[::2], values[1::2]):
+            pos += gap
+            data += self.mem[pos : pos + n]
+            pos += n
+        crc = crc32(struct.pack("<II", addr, len(ranges)) + ranges + data)
+        b64 = base64.b64encode(data).decode()
+        return (
+            f"[FLOK] READV {len(values) // 2} ranges {len(data)} bytes "
+            f"crc=0x{crc:08X} data={b64}"
+        )
+
+    def expect(self, ranges):
+        return [self.mem[a - self.BASE : a - self.BASE + n] for a, n in ranges]
+
+    def test_coalesce(self):
+        """Nearby ranges merge, distant and oversized ones do not"""
+        spans = FPBProtocol._coalesce_ranges(
+            [(0x100, 4), (0x108, 4), (0x104, 2), (0x200, 4), (0x300, 600)], 256
+        )
+        self.assertEqual(spans, [[0x100, 0x10C], [0x200, 0x204], [0x300, 0x558]])
+
+    def test_watch_list_one_round_trip(self):
+        """50 scattered variables are read with a single readv"""
+        ranges = [(self.BASE + i * 64, 4) for i in range(50)]
+        data, msg = self.protocol.read_memory_multi(ranges)
+        self.assertEqual(data, self.expect(ranges))
+        self.assertEqual(self.protocol.send_cmd.call_count, 1)
+        self.assertIn("readv", self.protocol.send_cmd.call_args.args[0])
+        self.assertIn("in 1 requests", msg)
+        # Two varint bytes per range: gap from the previous range, length
+        cmd = self.protocol.send_cmd.call_args.args[0].split()
+        self.assertEqual(len(base64.b64decode(cmd[cmd.index("--data") + 1])), 100)
+
+    def test_list_budget(self):
+        """The range list is split to fit one upload chunk"""
+        self.device.upload_chunk_size = 16
+        ranges = [(self.BASE + i * 64, 4) for i in range(20)]
+        data, _ = self.protocol.read_memory_multi(ranges)
+        self.assertEqual(data, self.expect(ranges))
+        self.assertEqual(self.protocol.send_cmd.call_count, 3)
+
+    def test_split_by_buffer_and_list_size(self):
+        """Requests respect the transfer buffer; oversized spans use read"""
+        ranges = [(self.BASE + i * 64, 40) for i in range(8)] + [
+            (self.BASE + 2048, 600),
+            (self.BASE + 0x10, 0),
+        ]
+        data, _ = self.protocol.read_memory_multi(ranges)
+        self.assertEqual(data, self.expect(ranges))
+        cmds = [c.args[0].split()[1] for c in self.protocol.send_cmd.call_args_list]
+        # 8 * 40 bytes > 256: two readv, then three read chunks for 600 bytes
+        self.assertEqual(cmds, ["readv", "readv", "read", "read", "read"])
+
+    def test_without_cap_falls_back_to_read(self):
+        """Devices without readv get one read per coalesced span"""
+        self.protocol.caps = 0x08
+        ranges = [(self.BASE, 4), (self.BASE + 8, 4), (self.BASE + 512, 4)]
+        data, _ = self.protocol.read_memory_multi(ranges)
+        self.assertEqual(data, self.expect(ranges))
+        self.assertEqual(self.protocol.send_cmd.call_count, 2)
+
+    def test_crc_mismatch_fails(self):
+        """A corrupted readv response is retried, then reported"""
+        self.protocol.send_cmd = MagicMock(
+            return_value="[FLOK] READV 1 ranges 4 bytes crc=0x00000000 data=AAAAAA=="
+        )
+        data, msg = self.protocol.read_memory_multi([(self.BASE, 4)], max_retries=1)
+        self.assertIsNone(data)
+        self.assertIn("readv failed", msg)
+        self.assertEqual(self.protocol.send_cmd.call_count, 2)
+
+
+class TestDump(unittest.TestCase):
+    """Test on-device memory dump to a file"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.protocol = FPBProtocol(self.device)
+        self.protocol.caps = 0x1010  # CAP_DUMP | CAP_LZ
+
+    def test_dump_memory(self):
+        """dump_memory sends one command and parses the file info"""
+        self.assertTrue(self.protocol.dump_supported())
+        self.protocol.send_cmd = MagicMock(
+            return_value="[FLOK] DUMP 0x20000000 len=65536 crc=0x1234ABCD "
+            "size=20480 z path=/sd/ram.bin"
+        )
+        info, _ = self.protocol.dump_memory(0x20000000, 65536, "/sd/ram.bin")
+        self.assertEqual(
+            info,
+            {
+                "addr": 0x20000000,
+                "length": 65536,
+                "crc": 0x1234ABCD,
+                "size": 20480,
+                "compressed": True,
+                "path": "/sd/ram.bin",
+            },
+        )
+        call_args = self.protocol.send_cmd.call_args
+        self.assertEqual(
+            call_args.args[0],
+            "-c dump --addr 0x20000000 --len 65536 --path /sd/ram.bin --z",
+        )
+        self.assertGreater(call_args.kwargs["timeout"], 2.0)
+
+    def test_dump_uncompressed_and_error(self):
+        """No --z without CAP_LZ; [FLERR] returns None"""
+        self.protocol.caps = 0x1000
+        self.protocol.send_cmd = MagicMock(return_value="[FLERR] Failed to open: /x")
+        info, msg = self.protocol.dump_memory(0x100, 16, "/x")
+        self.assertIsNone(info)
+        self.assertEqual(msg, "Failed to open: /x")
+        self.assertNotIn("--z", self.protocol.send_cmd.call_args.args[0])
+        self.protocol.caps = 0
+        self.assertFalse(self.protocol.dump_supported())
+
+
+class TestSample(unittest.TestCase):
+    """Test the device variable sampler commands"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.protocol = FPBProtocol(self.device)
+        self.protocol.caps = 0x2000  # CAP_SAMPLE
+
+    def test_sample_start(self):
+        """clear, one add per probe, then start with the period"""
+        self.assertTrue(self.protocol.sample_supported())
+        self.protocol.send_cmd = MagicMock(
+            side_effect=[
+                "[FLOK] SAMPLE clear",
+                "[FLOK] SAMPLE probe=0 addr=0x20000000 len=4",
+                "[FLOK] SAMPLE probe=1 addr=0x20000010 len=2",
+                "[FLOK] SAMPLE start probes=2 period=72000 hz=72000000",
+            ]
+        )
+        info, _ = self.protocol.sample_start([(0x20000000, 4), (0x20000010, 2)], 1000)
+        self.assertEqual(info, {"probes": 2, "period": 72000, "hz": 72000000})
+        cmds = [c.args[0] for c in self.protocol.send_cmd.call_args_list]
+        self.assertEqual(
+            cmds,
+            [
+                "-c sample --mode clear",
+                "-c sample --mode add --addr 0x20000000 --len 4",
+                "-c sample --mode add --addr 0x20000010 --len 2",
+                "-c sample --mode start --value 1000",
+            ],
+        )
+
+    def test_sample_start_add_error(self):
+        """A rejected probe stops before start"""
+        self.protocol.send_cmd = MagicMock(
+            side_effect=[
+                "[FLOK] SAMPLE clear",
+                "[FLERR] Invalid probe (max 8, 1..8 bytes)",
+            ]
+        )
+        info, msg = self.protocol.sample_start([(0x100, 16)])
+        self.assertIsNone(info)
+        self.assertIn("Invalid probe", msg)
+        self.assertEqual(self.protocol.send_cmd.call_count, 2)
+
+    def test_sample_stop(self):
+        self.protocol.send_cmd = MagicMock(
+            return_value="[FLOK] SAMPLE stop records=1200 dropped=3"
+        )
+        info, _ = self.protocol.sample_stop()
+        self.assertEqual(info, {"records": 1200, "dropped": 3})
+        self.protocol.caps = 0
+        self.assertFalse(self.protocol.sample_supported())
+
+
+class TestProf(unittest.TestCase):
+    """Test the PC-sampling profiler commands"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.protocol = FPBProtocol(self.device)
+        self.protocol.caps = 0x4000  # CAP_PROF
+
+    def test_prof_start(self):
+        self.assertTrue(self.protocol.prof_supported())
+        self.protocol.send_cmd = MagicMock(
+            return_value="[FLOK] PROF start hz=997 slots=256"
+        )
+        info, _ = self.protocol.prof_start()
+        self.assertEqual(info, {"hz": 997, "slots": 256})
+        self.protocol.send_cmd.assert_called_once_with("-c prof --mode start --value 0")
+
+    def test_prof_start_no_timer(self):
+        self.protocol.send_cmd = MagicMock(return_value="[FLERR] No sample timer")
+        info, msg = self.protocol.prof_start(1000)
+        self.assertIsNone(info)
+        self.assertEqual(msg, "No sample timer")
+
+    def test_prof_stop(self):
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] PROF stop samples=4242")
+        self.assertEqual(self.protocol.prof_stop()[0], 4242)
+
+    def test_prof_dump(self):
+        """Bucket lines before the status line become (pc, count) pairs"""
+        self.protocol.send_cmd = MagicMock(
+            return_value="0x08000100 12\n0x08000ABC 3\n"
+            "[FLOK] PROF stopped hz=997 samples=16 overflow=1 buckets=2"
+        )
+        dump, _ = self.protocol.prof_dump()
+        self.assertEqual(
+            dump,
+            {
+                "running": False,
+                "hz": 997,
+                "samples": 16,
+                "overflow": 1,
+                "pcs": [(0x08000100, 12), (0x08000ABC, 3)],
+            },
+        )
+
+    def test_prof_dump_error(self):
+        self.protocol.send_cmd = MagicMock(return_value="[FLERR] Unknown: prof")
+        dump, msg = self.protocol.prof_dump()
+        self.assertIsNone(dump)
+        self.assertIn("Unknown", msg)
+        self.protocol.caps = 0
+        self.assertFalse(self.protocol.prof_supported())
+
+
+class TestSlotStats(unittest.TestCase):
+    """Test the trampoline call counter commands"""
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.protocol = FPBProtocol(self.device)
+        self.protocol.caps = 0x8000  # CAP_SLOTSTATS
+
+    def test_slot_stats(self):
+        self.assertTrue(self.protocol.slot_stats_supported())
+        self.protocol.send_cmd = MagicMock(
+            return_value="Slot[1]: calls=1234 timed=1200 avg=56 max=90\n"
+            "Slot[4]: calls=7 timed=7 avg=1000 max=1500\n"
+            "[FLOK] SLOTSTATS slots=2"
+        )
+        stats, _ = self.protocol.slot_stats()
+        self.assertEqual(
+            stats,
+            {
+                1: {"calls": 1234, "timed": 1200, "avg": 56, "max": 90},
+                4: {"calls": 7, "timed": 7, "avg": 1000, "max": 1500},
+            },
+        )
+
+    def test_slot_stats_none_called(self):
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] SLOTSTATS slots=0")
+        self.assertEqual(self.protocol.slot_stats()[0], {})
+
+    def test_slot_stats_error(self):
+        self.protocol.send_cmd = MagicMock(return_value="[FLERR] Unknown: slotstats")
+        stats, msg = self.protocol.slot_stats()
+        self.assertIsNone(stats)
+        self.assertIn("Unknown", msg)
+        self.protocol.caps = 0
+        self.assertFalse(self.protocol.slot_stats_supported())
+
+    def test_slot_stats_reset(self):
+        self.protocol.send_cmd = MagicMock(return_value="[FLOK] SLOTSTATS reset")
+        ok, _ = self.protocol.slot_stats_reset()
+        self.assertTrue(ok)
+        self.protocol.send_cmd.assert_called_once_with("-c slotstats --mode reset")
+
+
+def read_stream_response(mem, base, addr, n, corrupt_at=None):
+    """Firmware "read --stream" output as ("text" | "data", bytes) items.
+
+    corrupt_at flips a byte of the first segment at or past that offset.
+    """
+    seg_size, sync_size = 510, 4096
+    crc = crc32(struct.pack("<II", addr, n))
+    items = [("text", f"[FLOK] READ {n} bytes stream\n".encode())]
+    off = sync = 0
+    while off < n:
+        raw = mem[addr - base + off : addr - base + min(off + seg_size, n)]
+        crc = crc32_update(crc, raw)
+        if corrupt_at is not None and off >= corrupt_at:
+            raw, corrupt_at = bytes([raw[0] ^ 0xFF]) + raw[1:], None
+        items.append(("data", raw))
+        off += len(raw)
+        if off - sync >= sync_size or off == n:
+            items.append(("text", f"SYNC {off} crc=0x{crc:08X}\n".encode()))
+            sync = off
+    items.append(("text", b"[FLEND]\n"))
+    return items
+
+
+class FakeStreamSerial:
+    """Serial stub answering text-mode "read --stream" from a memory image."""
+
+    def __init__(self, mem, base, corrupt=0, corrupt_at=4096, stall=0):
+        self.mem = mem
+        self.base = base
+        self.corrupt = corrupt  # Responses with one corrupted segment
+        self.corrupt_at = corrupt_at
+        self.stall = stall  # Responses cut off mid-transfer
+        self.rx = bytearray()
+        self.lines = []
+
+    @property
+    def in_waiting(self):
+        # The link delivers the response gradually
+        return min(len(self.rx), 2048)
+
+    def read(self, n):
+        data = bytes(self.rx[:n])
+        del self.rx[:n]
+        return data
+
+    def write(self, data):
+        line = data.decode().strip()
+        self.lines.append(line)
+        args = line.split()
+        addr = int(args[args.index("--addr") + 1], 16)
+        n = int(args[args.index("--len") + 1])
+        corrupt_at = self.corrupt_at if self.corrupt > 0 else None
+        items = read_stream_response(self.mem, self.base, addr, n, corrupt_at)
+        self.corrupt = max(0, self.corrupt - 1)
+        if self.stall:
+            self.stall -= 1
+            items = items[: len(items) // 2]
+        for kind, chunk in items:
+            if kind == "data":
+                chunk = base64.b64encode(chunk) + b"\n"
+            self.rx += chunk
+            if kind == "text" and chunk.startswith(b"SYNC"):
+                self.rx += b"[I] log line from another task\n"
+
+    def flush(self):
+        pass
+
+    def reset_input_buffer(self):
+        self.rx.clear()
+
+
+class TestReadStream(unittest.TestCase):
+    """Test streamed reads (read --stream)"""
+
+    BASE = 0x20000000
+
+    def setUp(self):
+        self.device = MagicMock()
+        self.device.raw_serial_log = []
+        self.device.raw_log_next_id = 0
+        self.device.raw_log_max_size = 5000
+        self.device.serial_tx_fragment_size = 0
+        self.device.download_chunk_size = 1024
+        self.protocol = FPBProtocol(self.device)
+        self.protocol._platform = Platform.BARE_METAL
+        self.protocol.caps = 0x808  # CAP_READ_STREAM | CAP_CRC32
+        self.mem = bytes((i * 13 + (i >> 8)) & 0xFF for i in range(20000))
+
+    def test_one_request(self):
+        """A range of many chunks is read with a single command"""
+        self.device.ser = FakeStreamSerial(self.mem, self.BASE)
+        progress = []
+        data, msg = self.protocol.read_memory(
+            self.BASE + 3, 16000, lambda done, total: progress.append(done)
+        )
+        self.assertEqual(data, self.mem[3:16003])
+        self.assertIn("streamed", msg)
+        self.assertEqual(len(self.device.ser.lines), 1)
+        self.assertIn("--stream --crc32 --crc 0x", self.device.ser.lines[0])
+        # Progress follows the SYNC markers
+        self.assertGreater(len(progress), 2)
+        self.assertEqual(progress[-1], 16000)
+        self.assertEqual(progress, sorted(progress))
+
+    def test_sync_mismatch_resumes(self):
+        """Corrupt data is dropped back to the last SYNC and re-requested"""
+        self.device.ser = FakeStreamSerial(self.mem, self.BASE, corrupt=1)
+        data, _ = self.protocol.read_memory(self.BASE, 12000)
+        self.assertEqual(data, self.mem[:12000])
+        lines = self.device.ser.lines
+        self.assertEqual(len(lines), 2)
+        # The first SYNC (past 4096 bytes) was good, so the retry starts there
+        self.assertIn(f"--addr 0x{self.BASE + 4590:X} --len {12000 - 4590}", lines[1])
+
+    def test_stall_resumes(self):
+        """A transfer that goes silent resumes after the idle timeout"""
+        self.device.ser = FakeStreamSerial(self.mem, self.BASE, stall=1)
+        with patch("core.serial_protocol.READ_STREAM_IDLE_TIMEOUT", 0.01):
+            data, _ = self.protocol.read_memory(self.BASE, 9000)
+        self.assertEqual(data, self.mem[:9000])
+        self.assertEqual(len(self.device.ser.lines), 2)
+
+    def test_gives_up(self):
+        """Corruption before the first SYNC fails after max_retries resumes"""
+        self.device.ser = FakeStreamSerial(
+            self.mem, self.BASE, corrupt=10, corrupt_at=0
+        )
+        data, msg = self.protocol.read_memory(self.BASE, 12000, max_retries=2)
+        self.assertIsNone(data)
+        self.assertIn("SYNC mismatch", msg)
+        self.assertEqual(len(self.device.ser.lines), 3)
+
+    def test_device_error(self):
+        """[FLERR] is reported without retrying"""
+        ser = FakeStreamSerial(self.mem, self.BASE)
+        ser.write = MagicMock(
+            side_effect=lambda data: ser.rx.extend(
+                b"[FLERR] Invalid address range\n[FLEND]\n"
+            )
+        )
+        self.device.ser = ser
+        data, msg = self.protocol.read_memory(self.BASE, 4096)
+        self.assertIsNone(data)
+        self.assertIn("Invalid address range", msg)
+        ser.write.assert_called_once()
+
+    def test_frames(self):
+        """With binary frames the segments arrive as raw DATA frames"""
+
+        def handler(op, payload):
+            args = {}
+            while payload:
+                tag, vlen = struct.unpack_from("<BH", payload)
+                args[tag] = payload[3 : 3 + vlen]
+                payload = payload[3 + vlen :]
+            self.assertIn(serial_frame.TAG_STREAM, args)
+            addr = struct.unpack("<I", args[serial_frame.TAG_ADDR])[0]
+            n = struct.unpack("<I", args[serial_frame.TAG_LEN])[0]
+            return [
+                (serial_frame.FRAME_F_DATA if kind == "data" else 0, chunk)
+                for kind, chunk in read_stream_response(self.mem, self.BASE, addr, n)
+            ]
+
+        self.device.ser = FakeFrameSerial(handler)
+        self.protocol._frame_ser = self.device.ser
+        data, _ = self.protocol.read_memory(self.BASE, 10000)
+        self.assertEqual(data, self.mem[:10000])
+
+    def test_short_read_uses_chunks(self):
+        """Reads that fit one chunk keep the plain read command"""
+        self.protocol.send_cmd = MagicMock(return_value="[FLERR] x")
+        self.protocol.read_memory(self.BASE, 512, max_retries=0)
+        self.assertNotIn("--stream", self.protocol.send_cmd.call_args.args[0])
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2025 - 2026 _VIFEXTech
+
+"""
+Tests for single Thumb instruction parsing and assembly (ipatch).
+"""
+
+import os
+import sys
+import unittest
+from unittest.mock import MagicMock, patch
+
+# Add parent directory to path
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from core.thumb_asm import (  # noqa: E402
+    assemble_insn,
+    format_insn,
+    insn_from_bytes,
+    insn_size,
+    parse_insn_hex,
+    read_insn,
+)
+
+
+def fake_toolchain(output: bytes, fail: str = ""):
+    """subprocess.run stand-in: objcopy writes output, the step named fail errors."""
+    calls = []
+
+    def run(cmd, **kwargs):
+        calls.append(cmd)
+        tool = os.path.basename(cmd[0])
+        if fail and tool.endswith(fail):
+            return MagicMock(returncode=1, stderr="Error: bad instruction")
+        if tool.endswith("objcopy"):
+            with open(cmd[-1], "wb") as f:
+                f.write(output)
+        return MagicMock(returncode=0, stderr="")
+
+    return run, calls
+
+
+class TestParse(unittest.TestCase):
+    def test_parse_insn_hex(self):
+        self.assertEqual(parse_insn_hex("2801"), 0x2801)
+        self.assertEqual(parse_insn_hex("0x2801"), 0x2801)
+        self.assertEqual(parse_insn_hex(" f1b0 0f01 "), 0xF1B00F01)
+        self.assertEqual(parse_insn_hex("F1B00F01"), 0xF1B00F01)
+        # Width must match the first halfword
+        self.assertIsNone(parse_insn_hex("f1b0"))
+        self.assertIsNone(parse_insn_hex("2801 2802"))
+        self.assertIsNone(parse_insn_hex("cmp r0, #1"))
+        self.assertIsNone(parse_insn_hex("add"))
+
+    def test_insn_from_bytes(self):
+        self.assertEqual(insn_from_bytes(bytes.fromhex("0128")), 0x2801)
+        self.assertEqual(insn_from_bytes(bytes.fromhex("b0f1010f")), 0xF1B00F01)
+        # Two 16-bit instructions, truncated 32-bit one
+        self.assertIsNone(insn_from_bytes(bytes.fromhex("01280228")))
+        self.assertIsNone(insn_from_bytes(bytes.fromhex("b0f1")))
+        self.assertIsNone(insn_from_bytes(b""))
+
+    def test_read_insn(self):
+        self.assertEqual(read_insn(bytes.fromhex("01280228")), 0x2801)
+        self.assertEqual(read_insn(bytes.fromhex("b0f1010f")), 0xF1B00F01)
+        self.assertIsNone(read_insn(bytes.fromhex("0128")))
+
+    def test_size_and_format(self):
+        self.assertEqual(insn_size(0x2801), 2)
+        self.assertEqual(insn_size(0xF1B00F01), 4)
+        self.assertEqual(format_insn(0x2801), "2801")
+        self.assertEqual(format_insn(0xF1B00F01), "f1b0 0f01")
+
+
+class TestAssemble(unittest.TestCase):
+    def test_hex_needs_no_toolchain(self):
+        with patch("subprocess.run") as run:
+            insn = assemble_insn("f000 b800", 0x08001000)
+        self.assertEqual(insn, (0xF000B800, ""))
+        run.assert_not_called()
+
+    def test_assemble_at_address(self):
+        """Linked at the patched address so PC-relative targets resolve"""
+        run, calls = fake_toolchain(bytes.fromhex("00f002b8"))
+        with patch("subprocess.run", side_effect=run):
+            insn, error = assemble_insn("b.w 0x08002008", 0x08001001, "/opt/tc")
+        self.assertEqual((insn, error), (0xF000B802, ""))
+        self.assertEqual(
+            [os.path.basename(c[0]) for c in calls],
+            ["arm-none-eabi-as", "arm-none-eabi-ld", "arm-none-eabi-objcopy"],
+        )
+        self.assertIn("-Ttext=0x8001000", calls[1])
+
+    def test_assemble_error(self):
+        run, _ = fake_toolchain(b"", fail="as")
+        with patch("subprocess.run", side_effect=run):
+            insn, error = assemble_insn("cmp r0, r99", 0x08001000)
+        self.assertIsNone(insn)
+        self.assertIn("Assemble error", error)
+        self.assertIn("bad instruction", error)
+
+    def test_not_one_instruction(self):
+        run, _ = fake_toolchain(bytes.fromhex("01280228"))
+        with patch("subprocess.run", side_effect=run):
+            insn, error = assemble_insn("ldr r0, =0x12345678", 0x08001000)
+        self.assertIsNone(insn)
+        self.assertIn("assembles to 4 bytes, not one instruction", error)
+
+        for text in ("nop\nnop", "nop; nop"):
+            self.assertEqual(assemble_insn(text, 0), (None, "Expected one instruction"))
+
+
+if __name__ == "__main__":
+    unittest.main()
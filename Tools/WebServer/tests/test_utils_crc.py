@@ -14,7 +14,7 @@ import unittest
 # Add parent directory to path
 sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
 
-from utils.crc import crc16
+from utils.crc import crc16, crc32, crc32_update
 
 
 class TestCRC16(unittest.TestCase):
@@ -61,5 +61,19 @@ class TestCRC16(unittest.TestCase):
         self.assertLessEqual(result, 0xFFFF)
 
 
+class TestCRC32(unittest.TestCase):
+    """Tests for CRC-32 (must match fl_crc32_update on the device)."""
+
+    def test_known_values(self):
+        """Check value and empty input."""
+        self.assertEqual(crc32(b"123456789"), 0xCBF43926)
+        self.assertEqual(crc32(b""), 0)
+
+    def test_update_chains(self):
+        """Incremental updates equal one pass."""
+        crc = crc32_update(0, b"12345")
+        self.assertEqual(crc32_update(crc, b"6789"), 0xCBF43926)
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2025 - 2026 _VIFEXTech
+
+"""
+Tests for LZ compression utilities.
+"""
+
+import sys
+import os
+import struct
+import unittest
+
+# Add parent directory to path
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from utils import lz
+
+
+class TestLZ(unittest.TestCase):
+    """Tests for LZ4-block compress/decompress."""
+
+    def test_vector_matches_device(self):
+        """Output is byte-identical to fl_lz_compress (test_codec_lz_vector)."""
+        data = bytes(range(16)) * 4 + b"Hello, Hello, Hello, FPBInject!" + bytes(40)
+        packed = lz.compress(data)
+        self.assertEqual(len(packed), 52)
+        self.assertEqual(lz.decompress(packed), data)
+
+    def test_roundtrip(self):
+        """Various inputs survive a roundtrip."""
+        cases = [
+            b"",
+            b"a",
+            b"abcdefghijkl",
+            bytes(1024),
+            bytes(i & 0xFF for i in range(3000)),
+            b"\x00\xbf\x70\x47" * 300 + bytes(range(256)),
+        ]
+        for data in cases:
+            self.assertEqual(lz.decompress(lz.compress(data)), data)
+
+    def test_zero_fill_compresses(self):
+        """Zero fill shrinks to a few bytes."""
+        self.assertLess(len(lz.compress(bytes(1024))), 16)
+
+    def test_input_too_large(self):
+        """Inputs over 64 KB are rejected."""
+        with self.assertRaises(ValueError):
+            lz.compress(bytes(lz.LZ_MAX_INPUT + 1))
+
+    def test_malformed(self):
+        """Truncated blocks and bad offsets raise ValueError."""
+        bad_blocks = (
+            b"\xf0",
+            b"\x20a",
+            b"\x10a\x05",
+            b"\x10a\x05\x00",
+            b"\x10a\x00\x00",
+        )
+        for bad in bad_blocks:
+            with self.assertRaises(ValueError):
+                lz.decompress(bad)
+
+    def test_max_size(self):
+        """Output beyond max_size is rejected."""
+        packed = lz.compress(bytes(100))
+        self.assertEqual(lz.decompress(packed, 100), bytes(100))
+        with self.assertRaises(ValueError):
+            lz.decompress(packed, 99)
+
+    def test_unpack_dump(self):
+        """dump --z records: LZ blocks, raw blocks where stored_len == raw_len."""
+        ramp = bytes(i % 16 for i in range(512))
+        noise = bytes((i * 2654435761 >> 13) & 0xFF for i in range(100))
+        packed = lz.compress(ramp)
+        data = (
+            struct.pack("<HH", len(ramp), len(packed))
+            + packed
+            + struct.pack("<HH", len(noise), len(noise))
+            + noise
+        )
+        self.assertEqual(lz.unpack_dump(data), ramp + noise)
+        self.assertEqual(lz.unpack_dump(b""), b"")
+        for bad in (data[:2], data[:-1], struct.pack("<HH", 600, 5) + packed[:5]):
+            with self.assertRaises(ValueError):
+                lz.unpack_dump(bad)
+
+    def test_transfer_stats(self):
+        """Ratio is wire/raw, gain raw/wire."""
+        stats = lz.transfer_stats(1000, 250)
+        self.assertEqual(stats["wire_bytes"], 250)
+        self.assertAlmostEqual(stats["ratio"], 0.25)
+        self.assertAlmostEqual(stats["gain"], 4.0)
+        self.assertEqual(lz.transfer_stats(0, 0)["ratio"], 1.0)
+
+
+if __name__ == "__main__":
+    unittest.main()
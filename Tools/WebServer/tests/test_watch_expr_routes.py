@@ -114,6 +114,68 @@ class TestWatchEvaluateEndpoint(WatchExprRoutesBase):
         self.assertIn("Cannot resolve", data["error"])
 
 
+class TestWatchEvaluateBatchEndpoint(WatchExprRoutesBase):
+    """Test /api/watch_expr/evaluate_batch endpoint."""
+
+    @staticmethod
+    def _evaluator():
+        symbols = {"g_a": 0x20001000, "g_b": 0x20001010}
+
+        def evaluate(expr):
+            if expr not in symbols:
+                return {"error": f"Cannot resolve '{expr}'"}
+            return {
+                "addr": symbols[expr],
+                "size": 4,
+                "type_name": "uint32_t",
+                "is_pointer": False,
+                "is_aggregate": False,
+            }
+
+        evaluator = Mock()
+        evaluator.evaluate.side_effect = evaluate
+        return evaluator
+
+    def test_no_gdb(self):
+        response = self.client.post(
+            "/api/watch_expr/evaluate_batch", json={"exprs": ["g_a"]}
+        )
+        self.assertFalse(response.get_json()["success"])
+
+    @patch("app.routes.watch_expr._read_device_ranges")
+    @patch("app.routes.watch_expr._get_evaluator")
+    def test_one_read_for_all(self, mock_get_eval, mock_read):
+        mock_get_eval.return_value = self._evaluator()
+        mock_read.return_value = (["01000000", "02000000"], None)
+
+        response = self.client.post(
+            "/api/watch_expr/evaluate_batch",
+            json={"exprs": ["g_a", "missing", "g_b"]},
+        )
+        data = response.get_json()
+        self.assertTrue(data["success"])
+        mock_read.assert_called_once_with([(0x20001000, 4), (0x20001010, 4)])
+        results = data["results"]
+        self.assertEqual([r["success"] for r in results], [True, False, True])
+        self.assertEqual(results[0]["hex_data"], "01000000")
+        self.assertEqual(results[2]["hex_data"], "02000000")
+        self.assertEqual(results[2]["source"], "device")
+        self.assertIn("Cannot resolve", results[1]["error"])
+
+    @patch("app.routes.watch_expr._read_device_ranges")
+    @patch("app.routes.watch_expr._get_evaluator")
+    def test_read_error(self, mock_get_eval, mock_read):
+        mock_get_eval.return_value = self._evaluator()
+        mock_read.return_value = (None, "Device not connected")
+
+        response = self.client.post(
+            "/api/watch_expr/evaluate_batch", json={"exprs": ["g_a", "g_b"]}
+        )
+        results = response.get_json()["results"]
+        self.assertTrue(all(r["read_error"] == "Device not connected" for r in results))
+        self.assertIsNone(results[0]["hex_data"])
+
+
 class TestWatchDerefEndpoint(WatchExprRoutesBase):
     """Test /api/watch_expr/deref endpoint."""
 
@@ -260,5 +322,91 @@ class TestWatchListEndpoints(WatchExprRoutesBase):
         self.assertEqual(r2.get_json()["id"], 2)
 
 
+
+class TestWatchSampleEndpoints(WatchExprRoutesBase):
+    """Test /api/watch_expr/sample/* endpoints."""
+
+    def setUp(self):
+        super().setUp()
+        self._worker = state.device.worker
+        state.device.worker = Mock()
+        self.fpb = Mock()
+        self.fpb.sample_supported.return_value = True
+        self.fpb.sample_start.return_value = (
+            {"probes": 1, "period": 72000, "hz": 72000000},
+            "",
+        )
+        self.fpb.sample_stop.return_value = ({"records": 10, "dropped": 0}, "")
+        patches = [
+            patch("app.routes.symbols._get_fpb_inject", return_value=self.fpb),
+            patch("app.routes.symbols._run_serial_op", side_effect=lambda f, **k: f()),
+            patch(
+                "app.routes.watch_expr._get_evaluator",
+                return_value=TestWatchEvaluateBatchEndpoint._evaluator(),
+            ),
+        ]
+        for p in patches:
+            p.start()
+            self.addCleanup(p.stop)
+
+    def tearDown(self):
+        import app.routes.watch_expr as we
+
+        we._sample_session = None
+        state.device.worker = self._worker
+        super().tearDown()
+
+    def test_start_stream_stop(self):
+        response = self.client.post(
+            "/api/watch_expr/sample/start",
+            json={"exprs": ["g_a", "missing"], "period_us": 1000},
+        )
+        data = response.get_json()
+        self.assertTrue(data["success"])
+        self.assertEqual(data["probes"][0]["addr"], "0x20001000")
+        self.assertEqual(data["skipped"][0]["expr"], "missing")
+        self.assertEqual(data["hz"], 72000000)
+        self.fpb.sample_start.assert_called_once_with([(0x20001000, 4)], 1000)
+
+        sink = state.device.worker.set_sample_sink.call_args.args[0]
+        sink(bytes([0, 1, 0, 0, 0, 1, 0x2A, 0, 0, 0]))
+
+        response = self.client.post("/api/watch_expr/sample/stop")
+        data = response.get_json()
+        self.assertTrue(data["success"])
+        self.assertEqual(data["records"], 10)
+        state.device.worker.set_sample_sink.assert_called_with(None)
+
+        response = self.client.post("/api/watch_expr/sample/stop")
+        self.assertFalse(response.get_json()["success"])
+
+    def test_stream_events(self):
+        import app.routes.watch_expr as we
+
+        self.client.post("/api/watch_expr/sample/start", json={"exprs": ["g_a"]})
+        session = we._sample_session
+        response = self.client.get("/api/watch_expr/sample/stream")
+        session.on_payload(bytes([0, 1, 0, 0, 0, 1, 0x2A, 0, 0, 0]))
+        session.close()
+        body = response.get_data(as_text=True)
+        self.assertIn('"type": "samples"', body)
+        self.assertIn('"0": "2a000000"', body)
+
+    def test_stream_not_running(self):
+        response = self.client.get("/api/watch_expr/sample/stream")
+        self.assertIn("Sampler not running", response.get_data(as_text=True))
+
+    def test_start_errors(self):
+        response = self.client.post(
+            "/api/watch_expr/sample/start", json={"exprs": ["missing"]}
+        )
+        self.assertIn("No sampleable", response.get_json()["error"])
+
+        self.fpb.sample_supported.return_value = False
+        response = self.client.post(
+            "/api/watch_expr/sample/start", json={"exprs": ["g_a"]}
+        )
+        self.assertIn("no sampler", response.get_json()["error"])
+
 if __name__ == "__main__":
     unittest.main()
@@ -7,6 +7,8 @@
 CRC calculation utilities for FPBInject WebServer.
 """
 
+import zlib
+
 # CRC-16-CCITT Table
 CRC16_TABLE = [
     0x0000,
@@ -297,3 +299,13 @@ def crc16_update(crc: int, data: bytes) -> int:
     for byte in data:
         crc = ((crc << 8) ^ CRC16_TABLE[(crc >> 8) ^ byte]) & 0xFFFF
     return crc
+
+
+def crc32(data: bytes) -> int:
+    """Calculate CRC-32 (IEEE 802.3), matching fl_crc32_update() on the device."""
+    return zlib.crc32(data) & 0xFFFFFFFF
+
+
+def crc32_update(crc: int, data: bytes) -> int:
+    """Update CRC-32 incrementally (use 0 for initial)."""
+    return zlib.crc32(data, crc) & 0xFFFFFFFF
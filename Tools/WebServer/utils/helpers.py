@@ -59,9 +59,9 @@ def build_slot_response(device, app_state, get_fpb_inject):
     # Build slot states from device info
     slots = []
     device_slots = info.get("slots", [])
-    # FPB v2 supports 8 slots, v1 supports 6
+    # FPB v2 supports 8 slots, v1 supports 6; DWT redirects add more
     fpb_version = info.get("fpb_version", 1)
-    max_slots = 8 if fpb_version >= 2 else 6
+    max_slots = max(8 if fpb_version >= 2 else 6, info.get("total_slots", 0))
     for i in range(max_slots):
         slot_data = next((s for s in device_slots if s.get("id") == i), None)
         if slot_data and slot_data.get("occupied"):
@@ -82,6 +82,7 @@ def build_slot_response(device, app_state, get_fpb_inject):
                     "target_addr": f"0x{target_addr:08X}",
                     "func": func_name,
                     "code_size": code_size,
+                    "stats": slot_data.get("stats"),
                 }
             )
         else:
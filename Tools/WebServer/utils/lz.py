@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+
+# MIT License
+# Copyright (c) 2025 - 2026 _VIFEXTech
+
+"""
+LZ compression for --z transfers.
+
+LZ4 block format (no frame header), bit-exact with fl_lz_compress() /
+fl_lz_decompress() in App/func_loader/fl_codec.c: a greedy matcher with a
+single-entry hash table of 2^8 slots, so the output of both sides is
+byte-identical for the same input.
+"""
+
+LZ_MIN_MATCH = 4
+LZ_LAST_LITERALS = 5  # A block ends with at least 5 literals
+LZ_MFLIMIT = 12  # No match starts in the last 12 bytes
+LZ_HASH_BITS = 8  # FL_LZ_HASH_BITS
+LZ_MAX_INPUT = 0xFFFF
+
+
+def _hash(data: bytes, pos: int) -> int:
+    v = int.from_bytes(data[pos : pos + 4], "little")
+    return ((v * 2654435761) & 0xFFFFFFFF) >> (32 - LZ_HASH_BITS)
+
+
+def _put_len(out: bytearray, n: int):
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+
+
+def _emit(out: bytearray, literals: bytes, offset: int = 0, mlen: int = 0):
+    ml = mlen - LZ_MIN_MATCH if mlen else 0
+    out.append((min(len(literals), 15) << 4) | min(ml, 15))
+    if len(literals) >= 15:
+        _put_len(out, len(literals) - 15)
+    out += literals
+    if mlen:
+        out += offset.to_bytes(2, "little")
+        if ml >= 15:
+            _put_len(out, ml - 15)
+
+
+def compress(data: bytes) -> bytes:
+    """Compress up to 64 KB into an LZ4 block."""
+    data = bytes(data)
+    n = len(data)
+    if n > LZ_MAX_INPUT:
+        raise ValueError(f"LZ input too large: {n} > {LZ_MAX_INPUT}")
+
+    out = bytearray()
+    ip = 0
+    anchor = 0
+    if n > LZ_MFLIMIT:
+        table = [0] * (1 << LZ_HASH_BITS)
+        limit = n - LZ_MFLIMIT
+        match_limit = n - LZ_LAST_LITERALS
+        while ip < limit:
+            h = _hash(data, ip)
+            ref = table[h]
+            table[h] = ip + 1
+            if ref == 0 or data[ref - 1 : ref + 3] != data[ip : ip + 4]:
+                ip += 1
+                continue
+            ref -= 1
+            mlen = LZ_MIN_MATCH
+            while ip + mlen < match_limit and data[ref + mlen] == data[ip + mlen]:
+                mlen += 1
+            _emit(out, data[anchor:ip], ip - ref, mlen)
+            ip += mlen
+            anchor = ip
+
+    _emit(out, data[anchor:])
+    return bytes(out)
+
+
+def _get_len(data: bytes, ip: int, n: int):
+    while True:
+        if ip >= len(data):
+            raise ValueError("LZ block truncated")
+        b = data[ip]
+        ip += 1
+        n += b
+        if b != 255:
+            return ip, n
+
+
+def decompress(data: bytes, max_size: int = None) -> bytes:
+    """Decompress an LZ4 block, ValueError on malformed input."""
+    out = bytearray()
+    ip = 0
+    end = len(data)
+    while ip < end:
+        token = data[ip]
+        ip += 1
+
+        n = token >> 4
+        if n == 15:
+            ip, n = _get_len(data, ip, n)
+        if n > end - ip:
+            raise ValueError("LZ literals truncated")
+        out += data[ip : ip + n]
+        ip += n
+        if ip == end:
+            break
+
+        if end - ip < 2:
+            raise ValueError("LZ offset truncated")
+        offset = data[ip] | (data[ip + 1] << 8)
+        ip += 2
+        if offset == 0 or offset > len(out):
+            raise ValueError(f"LZ offset out of range: {offset}")
+
+        n = token & 0x0F
+        if n == 15:
+            ip, n = _get_len(data, ip, n)
+        n += LZ_MIN_MATCH
+        start = len(out) - offset
+        if n <= offset:
+            out += out[start : start + n]
+        else:
+            for i in range(n):
+                out.append(out[start + i])
+
+        if max_size is not None and len(out) > max_size:
+            raise ValueError("LZ output exceeds limit")
+
+    if max_size is not None and len(out) > max_size:
+        raise ValueError("LZ output exceeds limit")
+    return bytes(out)
+
+
+def unpack_dump(data: bytes) -> bytes:
+    """Inflate a "dump --z" file, ValueError on malformed input.
+
+    The file is a sequence of records: raw_len (2B LE), stored_len (2B LE),
+    then an LZ block, or the raw bytes when stored_len == raw_len.
+    """
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        if len(data) - pos < 4:
+            raise ValueError("Dump record header truncated")
+        raw_len = data[pos] | (data[pos + 1] << 8)
+        stored = data[pos + 2] | (data[pos + 3] << 8)
+        pos += 4
+        block = data[pos : pos + stored]
+        if len(block) != stored:
+            raise ValueError("Dump record truncated")
+        if stored != raw_len:
+            block = decompress(block, raw_len)
+            if len(block) != raw_len:
+                raise ValueError("Dump record length mismatch")
+        out += block
+        pos += stored
+    return bytes(out)
+
+
+def transfer_stats(raw_bytes: int, wire_bytes: int) -> dict:
+    """Compression stats for a transfer.
+
+    ratio is wire/raw payload size; gain is the effective-throughput factor
+    (raw bytes moved per wire byte) at a fixed link rate.
+    """
+    return {
+        "wire_bytes": wire_bytes,
+        "ratio": wire_bytes / raw_bytes if raw_bytes else 1.0,
+        "gain": raw_bytes / wire_bytes if wire_bytes else 1.0,
+    }
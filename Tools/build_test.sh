@@ -32,9 +32,11 @@ ALLOC_MODES=("STATIC" "LIBC")
 
 # Trampoline options (only test a subset for now)
 TRAMPOLINE_CONFIGS=(
-    "OFF;OFF" # Default: trampoline enabled, ASM
-    "OFF;ON"  # Trampoline enabled, C implementation
-    "ON;OFF"  # No trampoline (direct remap)
+    "OFF;OFF;OFF" # Default: trampoline enabled, ASM
+    "OFF;ON;OFF"  # Trampoline enabled, C implementation
+    "ON;OFF;OFF"  # No trampoline (direct remap)
+    "OFF;OFF;ON"  # Instrumented ASM trampoline (call/cycle stats)
+    "OFF;ON;ON"   # Instrumented C trampoline
 )
 
 # DebugMonitor options
@@ -84,6 +86,7 @@ build_config() {
     local no_asm="$4"
     local config_name="$5"
     local no_debugmon="${6:-OFF}"
+    local tramp_stats="${7:-OFF}"
 
     local build_subdir="$BUILD_DIR/$config_name"
 
@@ -99,6 +102,7 @@ build_config() {
         -DFPB_NO_TRAMPOLINE="$no_trampoline"
         -DFPB_TRAMPOLINE_NO_ASM="$no_asm"
         -DFPB_NO_DEBUGMON="$no_debugmon"
+        -DFPB_TRAMPOLINE_STATS="$tramp_stats"
     )
 
     # Add alloc mode for func_loader
@@ -255,16 +259,16 @@ run_tests() {
 
     # Test trampoline configurations with FUNC_LOADER + STATIC
     for tramp_config in "${TRAMPOLINE_CONFIGS[@]}"; do
-        IFS=';' read -r no_tramp no_asm <<<"$tramp_config"
+        IFS=';' read -r no_tramp no_asm stats <<<"$tramp_config"
 
-        local config_name="TRAMP_${no_tramp}_${no_asm}"
-        local config_desc="NO_TRAMPOLINE=$no_tramp NO_ASM=$no_asm"
+        local config_name="TRAMP_${no_tramp}_${no_asm}_${stats}"
+        local config_desc="NO_TRAMPOLINE=$no_tramp NO_ASM=$no_asm STATS=$stats"
 
         TOTAL_TESTS=$((TOTAL_TESTS + 1))
 
         local start_time=$(date +%s)
 
-        if build_config "3" "STATIC" "$no_tramp" "$no_asm" "$config_name"; then
+        if build_config "3" "STATIC" "$no_tramp" "$no_asm" "$config_name" "OFF" "$stats"; then
             local end_time=$(date +%s)
             local elapsed=$((end_time - start_time))
 
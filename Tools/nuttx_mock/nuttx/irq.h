@@ -28,4 +28,17 @@ static inline void up_disable_irq(int irq)
     (void)irq;
 }
 
+/* Mock critical section */
+typedef uint32_t irqstate_t;
+
+static inline irqstate_t enter_critical_section(void)
+{
+    return 0;
+}
+
+static inline void leave_critical_section(irqstate_t flags)
+{
+    (void)flags;
+}
+
 #endif /* __NUTTX_IRQ_H */
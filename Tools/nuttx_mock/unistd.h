@@ -21,6 +21,7 @@ static inline ssize_t write(int fd, const void* buf, size_t count) { (void)fd; (
 static inline off_t lseek(int fd, off_t offset, int whence) { (void)fd; (void)offset; (void)whence; return -1; }
 static inline int fsync(int fd) { (void)fd; return 0; }
 static inline int unlink(const char* path) { (void)path; return 0; }
+static inline int usleep(unsigned int usec) { (void)usec; return 0; }
 /* Note: rename is declared in stdio.h, so we don't mock it here */
 
 #endif /* FPB_HOST_TESTING */
@@ -4,8 +4,7 @@
 # Provides: FPBINJECT_SOURCES     - Source files to compile FPBINJECT_INCLUDES -
 # Include directories FPBINJECT_DEFINITIONS - Compile definitions
 #
-# Options (set before including): FL_USE_EXTERNAL_ARGPARSE - Use external
-# argparse library FL_MAX_SLOTS             - Max function loader slots
+# Options (set before including): FL_MAX_SLOTS - Max function loader slots
 # (default: 6) FL_ALLOC_MODE            - STATIC (default) or LIBC
 # FL_FILE_BACKEND          - FATFS, POSIX, LIBC, or NONE (default: NONE)
 # FL_FATFS_USE_MALLOC      - Use malloc for FatFS (default: OFF)
@@ -56,18 +55,11 @@ endif()
 
 list(APPEND FPBINJECT_SOURCES ${_FL_SOURCES})
 
-# Argparse
-if(NOT FL_USE_EXTERNAL_ARGPARSE)
-  file(GLOB _ARGPARSE_SOURCES ${FPBINJECT_ROOT}/App/func_loader/argparse/*.c)
-  list(APPEND FPBINJECT_SOURCES ${_ARGPARSE_SOURCES})
-endif()
-
 # ==============================================================================
 # Include directories
 # ==============================================================================
-set(FPBINJECT_INCLUDES
-    ${FPBINJECT_ROOT}/Source ${FPBINJECT_ROOT}/App/func_loader
-    ${FPBINJECT_ROOT}/App/func_loader/argparse)
+set(FPBINJECT_INCLUDES ${FPBINJECT_ROOT}/Source
+                       ${FPBINJECT_ROOT}/App/func_loader)
 
 # ==============================================================================
 # Compile definitions
@@ -24,8 +24,7 @@
 
 if(CONFIG_FPBINJECT)
   # Collect func_loader sources
-  file(GLOB FL_SOURCES ${CMAKE_CURRENT_LIST_DIR}/../App/func_loader/*.c
-       ${CMAKE_CURRENT_LIST_DIR}/../App/func_loader/argparse/*.c)
+  file(GLOB FL_SOURCES ${CMAKE_CURRENT_LIST_DIR}/../App/func_loader/*.c)
   # Exclude main source file
   list(FILTER FL_SOURCES EXCLUDE REGEX ".*fl_port_nuttx\\.c$")
 
@@ -47,7 +46,6 @@ if(CONFIG_FPBINJECT)
     ${FPB_SOURCES}
     INCLUDE_DIRECTORIES
     ${CMAKE_CURRENT_LIST_DIR}/../App/func_loader
-    ${CMAKE_CURRENT_LIST_DIR}/../App/func_loader/argparse
     ${CMAKE_CURRENT_LIST_DIR}/../Source
     DEFINITIONS
     FL_NUTTX_BUF_SIZE=${CONFIG_FPBINJECT_BUF_SIZE}
@@ -52,6 +52,8 @@ option(FPB_NO_TRAMPOLINE
 option(FPB_TRAMPOLINE_NO_ASM
        "Use C instead of assembly for trampoline (no argument preservation)"
        OFF)
+option(FPB_TRAMPOLINE_STATS
+       "Count calls and DWT cycles per trampoline (slotstats command)" OFF)
 
 # FPB DebugMonitor option (for ARMv8-M where REMAP is removed)
 option(FPB_NO_DEBUGMON "Disable DebugMonitor-based redirection" OFF)
@@ -66,7 +68,7 @@ set_property(CACHE FL_ALLOC_MODE PROPERTY STRINGS "STATIC" "LIBC")
 # Compile definitions
 add_compile_definitions(
   ${STM32_DEVICE} USE_STDPERIPH_DRIVER HSE_VALUE=${HSE_VALUE}
-  APP_SELECT=${APP_SELECT} ARDUINO=111 FL_USE_FILE=0)
+  APP_SELECT=${APP_SELECT} ARDUINO=111 FL_USE_FILE=0 FL_USE_SAMPLE=1 FL_USE_PROF=1)
 
 # Add FPB trampoline options to compile definitions
 if(FPB_NO_TRAMPOLINE)
@@ -77,6 +79,10 @@ if(FPB_TRAMPOLINE_NO_ASM)
   add_compile_definitions(FPB_TRAMPOLINE_NO_ASM)
 endif()
 
+if(FPB_TRAMPOLINE_STATS)
+  add_compile_definitions(FPB_TRAMPOLINE_STATS)
+endif()
+
 # Add DebugMonitor option to compile definitions
 if(FPB_NO_DEBUGMON)
   add_compile_definitions(FPB_NO_DEBUGMON)
@@ -117,7 +123,7 @@ file(GLOB APP_BLINK_SOURCES ${APP_DIR}/blink/*.c ${APP_DIR}/blink/*.cpp)
 file(GLOB APP_TEST_SOURCES ${APP_DIR}/test/*.c ${APP_DIR}/test/*.cpp)
 
 file(GLOB APP_FUNC_LOADER_SOURCES ${APP_DIR}/func_loader/*.c
-     ${APP_DIR}/func_loader/*.cpp ${APP_DIR}/func_loader/argparse/*.c)
+     ${APP_DIR}/func_loader/*.cpp)
 
 # Arduino API
 file(GLOB ARDUINO_SOURCES ${ARDUINO_DIR}/*.c ${ARDUINO_DIR}/*.cpp)
@@ -157,7 +163,6 @@ set(INCLUDE_DIRS
     ${APP_DIR}/blink
     ${APP_DIR}/test
     ${APP_DIR}/func_loader
-    ${APP_DIR}/func_loader/argparse
     ${ARDUINO_DIR}
     ${ARDUINO_DIR}/avr
     ${PLATFORM_DIR}/Config